@@ -87,6 +87,12 @@
 #include <nvocmp.h>
 
 #include <zstack/stack_task/zstackconfig.h>
+#ifdef OSAL_NV_CACHE
+#include <zstack/osal_port/osal_nv.h>
+#ifdef NVOCMP_MIN_VDD_FLASH_MV
+#include <driverlib/aon_batmon.h>
+#endif
+#endif
 
 #ifdef ZSTACK_GPD
 #include "macTask.h"
@@ -128,6 +134,14 @@
 /* Extended Address offset in FCFG (LSB..MSB) */
 #define EXTADDR_OFFSET 0x2F0
 
+#if defined(OSAL_NV_CACHE) && defined(NVOCMP_MIN_VDD_FLASH_MV)
+/* Margin above NVOCMP_MIN_VDD_FLASH_MV at which deferred NV writes are
+ * committed, so that they are written before NV refuses writes */
+#ifndef MAIN_NV_CACHE_VDD_MARGIN_MV
+#define MAIN_NV_CACHE_VDD_MARGIN_MV 200
+#endif
+#endif
+
 
 #define APP_TASK_STACK_SIZE 3000
 
@@ -208,6 +222,13 @@ void Main_assertHandler(uint8_t assertReason)
     Main_assertReason = assertReason;
 
 #if defined(RESET_ASSERT)
+#ifdef OSAL_NV_CACHE
+    /* Keep the deferred NV writes, unless NV may not be used from here */
+    if(assertReason != MAIN_ASSERT_HWI_TIRTOS)
+    {
+        (void)osal_nv_cache_flush();
+    }
+#endif
      /* Pull the plug and start over */
     SysCtrlSystemReset();
 #else
@@ -288,8 +309,30 @@ void assertHandler(void)
 void Main_lowVoltageCb(uint32_t voltage)
 {
     /* Implement any safety precautions for application due to low voltage detected */
+#ifdef OSAL_NV_CACHE
+    /* Stop holding NV writes in RAM, what is still pending can no longer
+     * be written, Main_nvCacheVoltageCheck() commits it earlier */
+    osal_nv_cache_lowVoltage();
+#endif
+}
+
+#ifdef OSAL_NV_CACHE
+/*!
+ * @brief       Early warning supply check of the NV write-back cache
+ *
+ * @return      FALSE when the voltage is within MAIN_NV_CACHE_VDD_MARGIN_MV
+ *              of NVOCMP_MIN_VDD_FLASH_MV
+ */
+static uint8_t Main_nvCacheVoltageCheck(void)
+{
+    uint32_t voltage = AONBatMonBatteryVoltageGet();
+
+    voltage = (voltage * 1000) >> AON_BATMON_BAT_FRAC_W;
+
+    return ((voltage >= NVOCMP_MIN_VDD_FLASH_MV + MAIN_NV_CACHE_VDD_MARGIN_MV) ? TRUE : FALSE);
 }
 #endif
+#endif
 
 /*!
  * @brief       "main()" function - starting point
@@ -357,6 +400,9 @@ int main()
     NVOCMP_loadApiPtrs(&zstack_user0Cfg.nvFps);
 #ifdef NVOCMP_MIN_VDD_FLASH_MV
     NVOCMP_setLowVoltageCb(&Main_lowVoltageCb);
+#ifdef OSAL_NV_CACHE
+    osal_nv_cache_setVoltageCheck(&Main_nvCacheVoltageCheck);
+#endif
 #endif
     if(zstack_user0Cfg.nvFps.initNV)
     {
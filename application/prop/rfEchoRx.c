@@ -61,6 +61,11 @@
 #include <ti_radio_config.h>
 
 #include <ti/sysbios/knl/Task.h>
+#ifdef ECHO_CONTINUOUS_RX
+#include <ti/sysbios/BIOS.h>
+#include <ti/sysbios/knl/Clock.h>
+#include <ti/sysbios/knl/Semaphore.h>
+#endif
 
 /*********************************************************************
  * CONSTANTS
@@ -70,8 +75,17 @@
 #define PAYLOAD_LENGTH         30
 /* Set Transmit (echo) delay to 100ms */
 #define TX_DELAY             (uint32_t)(4000000*0.1f)
+#ifdef ECHO_CONTINUOUS_RX
+/* Echo delay of the continuous RX mode, in Clock ticks */
+#define TX_DELAY_CLOCK_TICKS (100 * (1000 / Clock_tickPeriod))
+/* Ring of data entries, filled while the echoes wait for TX_DELAY */
+#ifndef NUM_DATA_ENTRIES
+#define NUM_DATA_ENTRIES       8
+#endif
+#else
 /* NOTE: Only two data entries supported at the moment */
 #define NUM_DATA_ENTRIES       2
+#endif // ECHO_CONTINUOUS_RX
 /* The Data Entries data field will contain:
  * 1 Header byte (RF_cmdPropRx.rxConf.bIncludeHdr = 0x1)
  * Max 30 payload bytes
@@ -101,7 +115,12 @@ typedef enum {
 /*********************************************************************
  * FUNCTION PROTPTYPES
  */
+#ifndef ECHO_CONTINUOUS_RX
 static void echoCallback(RF_Handle h, RF_CmdHandle ch, RF_EventMask e);
+#else
+static void echoRxCallback(RF_Handle h, RF_CmdHandle ch, RF_EventMask e);
+static void echoContinuous(void);
+#endif
 
 /*********************************************************************
  * GLOBAL VARIABLES
@@ -141,12 +160,20 @@ static rfc_propRxOutput_t rxStatistics;
 
 /* Receive dataQueue for RF Core to fill in data */
 static dataQueue_t dataQueue;
+
+#ifndef ECHO_CONTINUOUS_RX
 static rfc_dataEntryGeneral_t* currentDataEntry;
 static uint8_t packetLength;
 static uint8_t* packetDataPointer;
 
-
 static uint8_t txPacket[PAYLOAD_LENGTH];
+#else
+/* Posted by the RX callback on a received packet or when RX ends */
+static Semaphore_Struct rxSemStruct;
+static Semaphore_Handle rxSemHandle;
+/* Continuous RX command is posted and has not ended yet */
+static volatile bool rxActive = false;
+#endif
 
 #ifdef LOG_RADIO_EVENTS
 static volatile RF_EventMask eventLog[32];
@@ -199,6 +226,14 @@ void *mainThread(void *arg0)
     DMMPolicy_setBlockModeOn(DMMPolicy_StackRole_ZigbeeRouter);
 #endif
 
+#ifdef ECHO_CONTINUOUS_RX
+    Semaphore_Params semParams;
+    Semaphore_Params_init(&semParams);
+    semParams.mode = Semaphore_Mode_BINARY;
+    Semaphore_construct(&rxSemStruct, 0, &semParams);
+    rxSemHandle = Semaphore_handle(&rxSemStruct);
+#endif
+
     /* Modify CMD_PROP_TX and CMD_PROP_RX commands for application needs */
     /* Set the Data Entity queue for received data */
     RF_cmdPropRx.pQueue = &dataQueue;
@@ -218,10 +253,21 @@ void *mainThread(void *arg0)
     RF_cmdPropRx.condition.rule = COND_STOP_ON_FALSE;
     RF_cmdPropRx.pOutput = (uint8_t *)&rxStatistics;
 
+#ifndef ECHO_CONTINUOUS_RX
     RF_cmdPropTx.pktLen = PAYLOAD_LENGTH;
     RF_cmdPropTx.pPkt = txPacket;
     RF_cmdPropTx.startTrigger.triggerType = TRIG_REL_PREVEND;
     RF_cmdPropTx.startTime = TX_DELAY;
+#else
+    /* Keep receiving after every packet into the next free data entry, the
+     * echoes are sent by separate TX commands straight from the queue */
+    RF_cmdPropRx.pktConf.bRepeatOk = 1;
+    RF_cmdPropRx.pNextOp = NULL;
+    RF_cmdPropRx.condition.rule = COND_NEVER;
+
+    RF_cmdPropTx.startTrigger.triggerType = TRIG_NOW;
+    RF_cmdPropTx.startTime = 0;
+#endif
 
 
     /* Request access to the radio */
@@ -250,6 +296,9 @@ void *mainThread(void *arg0)
     RF_runScheduleCmd(rfHandle, (RF_Op*)&RF_cmdFs, &scheduleParams, NULL, 0);
 #endif
 
+#ifdef ECHO_CONTINUOUS_RX
+    echoContinuous();
+#else
     while(1)
     {
         /* Wait for a packet
@@ -352,8 +401,10 @@ void *mainThread(void *arg0)
                 while(1);
         }
     }
+#endif // ECHO_CONTINUOUS_RX
 }
 
+#ifndef ECHO_CONTINUOUS_RX
 static void echoCallback(RF_Handle h, RF_CmdHandle ch, RF_EventMask e)
 {
 #ifdef LOG_RADIO_EVENTS
@@ -401,6 +452,115 @@ static void echoCallback(RF_Handle h, RF_CmdHandle ch, RF_EventMask e)
         GPIO_write(CONFIG_GPIO_RLED, CONFIG_GPIO_LED_OFF);
     }
 }
+#else
+static void echoRxCallback(RF_Handle h, RF_CmdHandle ch, RF_EventMask e)
+{
+#ifdef LOG_RADIO_EVENTS
+    eventLog[evIndex++ & 0x1F] = e;
+#endif// LOG_RADIO_EVENTS
+
+    if (e & RF_EventRxEntryDone)
+    {
+        /* Successful RX */
+        /* Toggle LED2, clear LED1 to indicate RX */
+        GPIO_write(CONFIG_GPIO_GLED, CONFIG_GPIO_LED_OFF);
+        GPIO_toggle(CONFIG_GPIO_RLED);
+    }
+
+    if (e & (RF_EventLastCmdDone | RF_EventCmdAborted | RF_EventCmdStopped |
+             RF_EventCmdCancelled | RF_EventCmdPreempted))
+    {
+        /* RX ended (stopped for an echo burst, queue full or preempted) */
+        rxActive = false;
+    }
+
+    Semaphore_post(rxSemHandle);
+}
+
+/*
+ * Echo loop of the continuous RX mode. The RX command repeats after every
+ * packet and keeps filling the data entry ring while the first echo waits
+ * for TX_DELAY_CLOCK_TICKS. It is then stopped and every finished entry is
+ * sent back straight from the ring before RX is resumed, so packets that
+ * arrive during the echo delay are no longer lost.
+ */
+static void echoContinuous(void)
+{
+    rfc_dataEntryGeneral_t *pEntry;
+    RF_CmdHandle rxHandle = RF_ALLOC_ERROR;
+#ifdef USE_DMM
+    RF_ScheduleCmdParams scheduleParams;
+
+    RF_ScheduleCmdParams_init(&scheduleParams);
+    scheduleParams.startTime    = 0;
+    scheduleParams.startType    = RF_StartNotSpecified;
+    scheduleParams.allowDelay   = RF_AllowDelayAny;
+    scheduleParams.duration     = ~(0);
+    scheduleParams.endTime      = ~(0);
+    scheduleParams.endType      = RF_EndNotSpecified;
+    scheduleParams.activityInfo = GEN_ACTIVITY_TABLE(RfActivity_Rx_Tx, DMM_StackPNormal);
+#endif
+
+    while(1)
+    {
+        if (!rxActive)
+        {
+            rxActive = true;
+#ifndef USE_DMM
+            rxHandle = RF_postCmd(rfHandle, (RF_Op*)&RF_cmdPropRx, RF_PriorityNormal,
+                                  echoRxCallback, RF_EventRxEntryDone);
+#else
+            rxHandle = RF_scheduleCmd(rfHandle, (RF_Op*)&RF_cmdPropRx, &scheduleParams,
+                                      echoRxCallback, RF_EventRxEntryDone);
+#endif
+            if (rxHandle < 0)
+            {
+                // Could not queue the RX command, e.g. the stack is blocked
+                rxActive = false;
+                Task_sleep(TX_DELAY_CLOCK_TICKS);
+                continue;
+            }
+        }
+
+        /* Wait for a packet or for the RX command to end */
+        Semaphore_pend(rxSemHandle, BIOS_WAIT_FOREVER);
+
+        if (RFQueue_getDataEntry()->status != DATA_ENTRY_FINISHED)
+        {
+            continue;
+        }
+
+        /* Keep receiving while the sender switches over to RX */
+        Task_sleep(TX_DELAY_CLOCK_TICKS);
+
+        /* Stop RX gracefully so that a packet being received completes */
+        if (rxActive)
+        {
+            RF_cancelCmd(rfHandle, rxHandle, 1);
+        }
+        RF_pendCmd(rfHandle, rxHandle, 0);
+        rxActive = false;
+
+        /* Echo every finished entry from the queue, without copying it */
+        while ((pEntry = RFQueue_getDataEntry())->status == DATA_ENTRY_FINISHED)
+        {
+            /* Length is the first byte, data starts from the second byte */
+            RF_cmdPropTx.pktLen = *(uint8_t *)(&(pEntry->data));
+            RF_cmdPropTx.pPkt = (uint8_t *)(&(pEntry->data) + 1);
+
+#ifndef USE_DMM
+            RF_runCmd(rfHandle, (RF_Op*)&RF_cmdPropTx, RF_PriorityNormal, NULL, 0);
+#else
+            RF_runScheduleCmd(rfHandle, (RF_Op*)&RF_cmdPropTx, &scheduleParams, NULL, 0);
+#endif
+            /* Echo (TX) done, hand the entry back to the RF core */
+            GPIO_write(CONFIG_GPIO_GLED, CONFIG_GPIO_LED_OFF);
+            GPIO_toggle(CONFIG_GPIO_RLED);
+            RFQueue_nextEntry();
+        }
+    }
+}
+#endif // ECHO_CONTINUOUS_RX
 
 Task_Handle* rfEchoRx_createRadioTask()
 {
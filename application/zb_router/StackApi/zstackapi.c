@@ -85,6 +85,31 @@ typedef struct _genericreqrsp_t
 
 } GenericReqRsp_t;
 
+/**
+ * Request message sent by Zstackapi_sendAsyncReq(). The first fields
+ * match GenericReqRsp_t, which is all the ZStack Thread looks at.
+ */
+typedef struct _asyncreqrsp_t
+{
+    /** message header<br>
+     */
+    zstackmsg_HDR_t hdr;
+
+    /** Message command fields */
+    void *pReq;
+
+    /** Response fields (immediate response) */
+    void *pRsp;
+
+    /** Completion callback and its argument */
+    Zstackapi_AsyncCB_t pfnCB;
+    void *pUserData;
+
+    /** Next outstanding asynchronous request */
+    struct _asyncreqrsp_t *pNext;
+
+} AsyncReqRsp_t;
+
 
 //*****************************************************************************
 // Local variables
@@ -92,10 +117,93 @@ typedef struct _genericreqrsp_t
 
 uint8_t stackServiceTaskId;
 
+// Asynchronous requests sent to the ZStack Thread and not yet completed
+static AsyncReqRsp_t *pAsyncReqList = NULL;
+static uint8_t asyncReqCount = 0;
+
+// Asynchronous responses dequeued while waiting for a synchronous response
+static OsalPort_MsgQ asyncRspDeferQ = NULL;
+
 //*****************************************************************************
 // Local Functions
 //*****************************************************************************
 
+/**
+ * Check if a message is the response to an outstanding asynchronous
+ * request, and unlink it from the outstanding list if so.
+ *
+ * @param pMsg - Pointer to the message
+ *
+ * @return true if pMsg is an asynchronous response
+ */
+static bool asyncRspUnlink(void *pMsg)
+{
+    AsyncReqRsp_t *pLoop;
+    AsyncReqRsp_t *pPrev = NULL;
+    uint32_t key;
+
+    key = OsalPort_enterCS();
+
+    for(pLoop = pAsyncReqList; pLoop != NULL; pLoop = pLoop->pNext)
+    {
+        if(pLoop == pMsg)
+        {
+            if(pPrev == NULL)
+            {
+                pAsyncReqList = pLoop->pNext;
+            }
+            else
+            {
+                pPrev->pNext = pLoop->pNext;
+            }
+            asyncReqCount--;
+            break;
+        }
+        pPrev = pLoop;
+    }
+
+    OsalPort_leaveCS(key);
+
+    return(pLoop != NULL);
+}
+
+/**
+ * Wait for the ZStack Thread to send back a request message. Responses
+ * to asynchronous requests with the same command ID, received in the
+ * meantime, are put back in the task's queue once the response is in.
+ *
+ * @param appServiceTaskId - Application Task ID
+ * @param pMsg - Pointer to the request message sent
+ */
+static void waitRsp(uint8_t appServiceTaskId, void *pMsg)
+{
+    OsalPort_EventHdr *pCmdStatus = NULL;
+    void *pDeferred;
+
+    while(pCmdStatus != pMsg)
+    {
+        // Wait for the response message
+        OsalPort_blockOnEvent(Task_self());
+
+        while((pCmdStatus = OsalPort_msgFindDequeue(appServiceTaskId,
+                              ((OsalPort_EventHdr *)pMsg)->event)) != NULL)
+        {
+            if(pCmdStatus == pMsg)
+            {
+                break;
+            }
+
+            // Asynchronous response, deliver it later
+            OsalPort_msgEnqueue(&asyncRspDeferQ, pCmdStatus);
+        }
+    }
+
+    while((pDeferred = OsalPort_msgDequeue(&asyncRspDeferQ)) != NULL)
+    {
+        OsalPort_msgSend(appServiceTaskId, (uint8_t*)pDeferred);
+    }
+}
+
 /**
  * Generic function to send a request message to the ZStack Thread
  * and wait for a "default" response message.
@@ -142,26 +250,11 @@ static zstack_ZStatusValues sendReqDefaultRsp(uint8_t appServiceTaskId,
         // Was the message sent successfully
         if(msgStatus == OsalPort_SUCCESS)
         {
-            bool gotRsp = false;
-
-            // Return status
-            zstackmsg_genericReq_t *pCmdStatus = NULL;
-
-            while(!gotRsp)
-            {
-                // Wait for the response message
-                OsalPort_blockOnEvent(Task_self());
-
-                pCmdStatus = (zstackmsg_genericReq_t*)OsalPort_msgFindDequeue(appServiceTaskId, pMsg->hdr.event);
-
-                if(pCmdStatus)
-                {
-                  gotRsp = true;
-                }
-            }
+            // Wait for the response message
+            waitRsp(appServiceTaskId, pMsg);
 
              // setup return of
-            status = (zstack_ZStatusValues)pCmdStatus->hdr.status;
+            status = (zstack_ZStatusValues)pMsg->hdr.status;
         }
 
         // pCmdStatus is the same as pMsg
@@ -222,26 +315,11 @@ static zstack_ZStatusValues sendReqRsp(uint8_t appServiceTaskId,
         // Was the message sent successfully
         if(msgStatus == OsalPort_SUCCESS)
         {
-            bool gotRsp = false;
-
-            // Return status
-            GenericReqRsp_t *pCmdStatus = NULL;
-
-            while(!gotRsp)
-            {
-                // Wait for the response message
-                OsalPort_blockOnEvent(Task_self());
-
-                pCmdStatus = (GenericReqRsp_t*)OsalPort_msgFindDequeue(appServiceTaskId, pMsg->hdr.event);
-
-                if(pCmdStatus)
-                {
-                  gotRsp = true;
-                }
-            }
+            // Wait for the response message
+            waitRsp(appServiceTaskId, pMsg);
 
             // setup return of
-            status = (zstack_ZStatusValues)pCmdStatus->hdr.status;
+            status = (zstack_ZStatusValues)pMsg->hdr.status;
         }
 
         // pCmdStatus is the same as pMsg
@@ -266,6 +344,96 @@ void Zstackapi_init(uint8_t stackTaskId)
     stackServiceTaskId = stackTaskId;
 }
 
+/**
+ * Call to send a request to the ZStack Thread without waiting for
+ * its response.
+ *
+ * Public function defined in zstackapi.h
+ */
+zstack_ZStatusValues Zstackapi_sendAsyncReq(uint8_t appServiceTaskId,
+                                            zstack_CmdIDs cmdID, void *pReq,
+                                            void *pRsp,
+                                            Zstackapi_AsyncCB_t pfnCB,
+                                            void *pUserData)
+{
+    zstack_ZStatusValues status = zstack_ZStatusValues_ZMemError;
+    uint32_t key;
+
+    AsyncReqRsp_t *pMsg =
+        (AsyncReqRsp_t *)OsalPort_msgAllocate(sizeof(AsyncReqRsp_t));
+
+    // Make sure the allocation was successful
+    if(pMsg != NULL)
+    {
+        // Fill in the message content
+        pMsg->hdr.event = cmdID;
+        pMsg->hdr.status = 0;
+        pMsg->hdr.srcServiceTask = appServiceTaskId;
+        pMsg->pReq = pReq;
+        pMsg->pRsp = pRsp;
+        pMsg->pfnCB = pfnCB;
+        pMsg->pUserData = pUserData;
+
+        // Track it before the ZStack Thread can answer
+        key = OsalPort_enterCS();
+        pMsg->pNext = pAsyncReqList;
+        pAsyncReqList = pMsg;
+        asyncReqCount++;
+        OsalPort_leaveCS(key);
+
+        // Send the message
+        if(OsalPort_msgSend(stackServiceTaskId, (uint8_t*)pMsg)
+           == OsalPort_SUCCESS)
+        {
+            status = zstack_ZStatusValues_ZSuccess;
+        }
+        else
+        {
+            asyncRspUnlink(pMsg);
+            OsalPort_msgDeallocate((uint8_t*)pMsg);
+            status = zstack_ZStatusValues_ZFailure;
+        }
+    }
+
+    return(status);
+}
+
+/**
+ * Call to complete an asynchronous request when its response is received.
+ *
+ * Public function defined in zstackapi.h
+ */
+bool Zstackapi_processAsyncRsp(void *pMsg)
+{
+    AsyncReqRsp_t *pRsp = (AsyncReqRsp_t *)pMsg;
+
+    if((pMsg == NULL) || !asyncRspUnlink(pMsg))
+    {
+        return(false);
+    }
+
+    if(pRsp->pfnCB != NULL)
+    {
+        pRsp->pfnCB((zstack_CmdIDs)pRsp->hdr.event,
+                    (zstack_ZStatusValues)pRsp->hdr.status,
+                    pRsp->pReq, pRsp->pRsp, pRsp->pUserData);
+    }
+
+    OsalPort_msgDeallocate((uint8_t*)pMsg);
+
+    return(true);
+}
+
+/**
+ * Call to get the number of asynchronous requests not completed yet.
+ *
+ * Public function defined in zstackapi.h
+ */
+uint8_t Zstackapi_pendingAsyncReqs(void)
+{
+    return(asyncReqCount);
+}
+
 /**
  * Call to send a System Reset Request
  *
@@ -1957,6 +2125,19 @@ zstack_ZStatusValues Zstackapi_tlInitiatorNwkJoinRspInd(
                                pReq, sizeof(zstack_pauseResumeDeviceReq_t)) );
  }
 
+/**
+ * Call to send a batch of requests to the ZStack Thread.
+ *
+ * Public function defined in zstackapi.h
+ */
+zstack_ZStatusValues Zstackapi_batchReq(uint8_t appServiceTaskId,
+                                        zstack_batchReq_t *pReq)
+{
+    // Build and send the message, then wait of the response message
+    return( sendReqDefaultRsp(appServiceTaskId, zstackmsg_CmdIDs_BATCH_REQ,
+                              pReq, sizeof(zstackmsg_batchReq_t)) );
+}
+
 
 /**
  * Call to free the memory used by an Indication message, messages
@@ -2190,8 +2371,12 @@ bool Zstackapi_freeIndMsg(void *pMsg)
                 zstackmsg_afIncomingMsgInd_t *pInd =
                     (zstackmsg_afIncomingMsgInd_t *)pMsg;
 
-                // Free the message payload
-                if(pInd->req.pPayload)
+                // Free the message payload, or the AF packet holding it
+                if(pInd->pAfPkt)
+                {
+                    OsalPort_msgDeallocate((uint8_t *)pInd->pAfPkt);
+                }
+                else if(pInd->req.pPayload)
                 {
                     OsalPort_free(pInd->req.pPayload);
                 }
@@ -2244,6 +2429,7 @@ bool Zstackapi_freeIndMsg(void *pMsg)
         case zstackmsg_CmdIDs_GP_DATA_IND:
         case zstackmsg_CmdIDs_GP_SECURITY_REQ:
         case zstackmsg_CmdIDs_PAUSE_DEVICE_REQ:
+        case zstackmsg_CmdIDs_BATCH_REQ:
             // Free the message
             OsalPort_msgDeallocate(pMsg);
             break;
@@ -438,6 +438,65 @@ extern "C"
 
 void Zstackapi_init(uint8_t stackTaskId);
 
+/**
+ * @brief       Completion callback of a request sent with
+ *              Zstackapi_sendAsyncReq().
+ *
+ * @param       cmdID - Command ID of the request
+ * @param       status - Status returned by the ZStack Thread
+ * @param       pReq - Request structure given to Zstackapi_sendAsyncReq()
+ * @param       pRsp - Response structure given to Zstackapi_sendAsyncReq(),
+ *                     filled in by the ZStack Thread
+ * @param       pUserData - Argument given to Zstackapi_sendAsyncReq()
+ */
+typedef void (*Zstackapi_AsyncCB_t)(zstack_CmdIDs cmdID,
+                                    zstack_ZStatusValues status,
+                                    void *pReq, void *pRsp, void *pUserData);
+
+/**
+ * @brief       Call to send a request to the ZStack Thread without waiting
+ *              for its response, so several requests can be outstanding.
+ *              The response message is received by the calling thread like
+ *              an indication, and must be given to
+ *              Zstackapi_processAsyncRsp(), which calls pfnCB.
+ *
+ * @param       appEntity - Calling thread's task ID.
+ * @param       cmdID - Command ID of the request (zstackmsg_CmdIDs_...)
+ * @param       pReq - Pointer to the Request structure. Must stay valid
+ *                     until pfnCB is called.
+ * @param       pRsp - Pointer to the Response structure for requests that
+ *                     have one, else NULL. Must stay valid until pfnCB
+ *                     is called.
+ * @param       pfnCB - Completion callback, may be NULL
+ * @param       pUserData - Argument passed to pfnCB
+ *
+ * @return      zstack_ZStatusValues_ZSuccess if the request was sent
+ */
+extern zstack_ZStatusValues Zstackapi_sendAsyncReq(uint8_t appEntity,
+                                                   zstack_CmdIDs cmdID,
+                                                   void *pReq, void *pRsp,
+                                                   Zstackapi_AsyncCB_t pfnCB,
+                                                   void *pUserData);
+
+/**
+ * @brief       Call with each message received from the ZStack Thread to
+ *              complete the asynchronous request it answers, if any.
+ *
+ * @param       pMsg - Pointer to the received message
+ *
+ * @return      true if pMsg was an asynchronous response (callback called
+ *              and memory freed), false if not processed
+ */
+extern bool Zstackapi_processAsyncRsp(void *pMsg);
+
+/**
+ * @brief       Call to get the number of asynchronous requests sent with
+ *              Zstackapi_sendAsyncReq() and not completed yet.
+ *
+ * @return      number of outstanding asynchronous requests
+ */
+extern uint8_t Zstackapi_pendingAsyncReqs(void);
+
 /**
  * @brief       Call to send a System Reset Request to the ZStack Thread.
  *
@@ -2142,6 +2201,26 @@ zstack_ZStatusValues Zstackapi_tlInitiatorNwkJoinRspInd(
     uint8_t appEntity, zstack_touchlinkNwkJoinRsp_t *pReq);
 #endif
 
+/**
+ * @brief       Call to send several requests to the ZStack Thread in a
+ *              single message exchange. The requests are processed back to
+ *              back; the status of each one is returned in its header.
+ *              Each item is filled in like the message Zstackapi would send
+ *              for it: hdr.event set to the request's command ID, and pReq
+ *              (and pRsp for requests with a response) pointing to the
+ *              request (and response) structures.
+ *              The batch stops at the first request that fails, pReq->numDone
+ *              returns its index.
+ *
+ * @param       appEntity - Calling thread's task ID.
+ * @param       pReq - Pointer to the batch structure.
+ *
+ * @return      zstack_ZStatusValues of the failing request, or of the batch
+ *              itself
+ */
+extern zstack_ZStatusValues Zstackapi_batchReq(uint8_t appEntity,
+                                               zstack_batchReq_t *pReq);
+
 /**
  * @brief       Call to pause/resume the device on the nwk.
  *
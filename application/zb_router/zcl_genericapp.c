@@ -561,11 +561,17 @@ static void zclGenericApp_process_loop( void )
             /* Retrieve the response message */
             if( (pMsg = (zstackmsg_genericReq_t*) OsalPort_msgReceive( appServiceTaskId )) != NULL)
             {
-                /* Process the message from the stack */
-                zclGenericApp_processZStackMsgs(pMsg);
+                // Complete the asynchronous request it answers, if any
+                msgProcessed = Zstackapi_processAsyncRsp(pMsg);
 
-                // Free any separately allocated memory
-                msgProcessed = Zstackapi_freeIndMsg(pMsg);
+                if(msgProcessed == FALSE)
+                {
+                    /* Process the message from the stack */
+                    zclGenericApp_processZStackMsgs(pMsg);
+
+                    // Free any separately allocated memory
+                    msgProcessed = Zstackapi_freeIndMsg(pMsg);
+                }
             }
 
             if((msgProcessed == FALSE) && (pMsg != NULL))
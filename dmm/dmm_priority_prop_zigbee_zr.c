@@ -68,7 +68,9 @@ typedef enum
 } DMMStackActivityZB;
 
 
-/* Global Priority Table: BLE connection is lower than Zigbee data */
+/* Global Priority Table: prop RX/TX is lower than Zigbee data and RXON, so
+ * prop only gets the radio while the Zigbee stack is blocked, as rfEchoRx.c
+ * does 500 ms after it starts (see dmm/host/dmm_sim.c) */
 StackActivity activityPROP_propLzigbeeZrH[ACTIVITY_NUM_PROP*PRIORITY_NUM] =
 {
     /* Activity order matters */
@@ -0,0 +1,1222 @@
+/******************************************************************************
+
+ @file dmm_host.c
+
+ @brief DMM scheduler and policy manager host stand-in
+
+ Group: WCS LPC
+ Target Device: cc13xx_cc26xx
+
+ ******************************************************************************
+ 
+ Copyright (c) 2022, Texas Instruments Incorporated
+
+ All rights reserved not granted herein.
+ Limited License.
+
+ Texas Instruments Incorporated grants a world-wide, royalty-free,
+ non-exclusive license under copyrights and patents it now or hereafter
+ owns or controls to make, have made, use, import, offer to sell and sell
+ ("Utilize") this software subject to the terms herein. With respect to the
+ foregoing patent license, such license is granted solely to the extent that
+ any such patent is necessary to Utilize the software alone. The patent
+ license shall not apply to any combinations which include this software,
+ other than combinations with devices manufactured by or for TI ("TI
+ Devices"). No hardware patent is licensed hereunder.
+
+ Redistributions must preserve existing copyright notices and reproduce
+ this license (including the above copyright notice and the disclaimer and
+ (if applicable) source code license limitations below) in the documentation
+ and/or other materials provided with the distribution.
+
+ Redistribution and use in binary form, without modification, are permitted
+ provided that the following conditions are met:
+
+   * No reverse engineering, decompilation, or disassembly of this software
+     is permitted with respect to any software provided in binary form.
+   * Any redistribution and use are licensed by TI for use only with TI Devices.
+   * Nothing shall obligate TI to provide you with source code for the software
+     licensed and provided to you in object code.
+
+ If software source code is provided to you, modification and redistribution
+ of the source code are permitted provided that the following conditions are
+ met:
+
+   * Any redistribution and use of the source code, including any resulting
+     derivative works, are licensed by TI for use only with TI Devices.
+   * Any redistribution and use of any object code compiled from the source
+     code and any resulting derivative works, are licensed by TI for use
+     only with TI Devices.
+
+ Neither the name of Texas Instruments Incorporated nor the names of its
+ suppliers may be used to endorse or promote products derived from this
+ software without specific prior written permission.
+
+ DISCLAIMER.
+
+ THIS SOFTWARE IS PROVIDED BY TI AND TI'S LICENSORS "AS IS" AND ANY EXPRESS
+ OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ IN NO EVENT SHALL TI AND TI'S LICENSORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ 
+ 
+ *****************************************************************************/
+/*!****************************************************************************
+ *  @file  dmm_host.c
+ *
+ *  @brief      Host stand-in of the DMM scheduler and policy manager
+ *
+ *  See dmm_host.h for the scheduling model.
+ *
+ *********************************************************************************/
+
+#include <string.h>
+
+#include "dmm_host.h"
+#include "dmm_scheduler.h"
+#include "dmm_policy.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+#define DMMSIM_NO_EVENT         UINT64_MAX
+
+/* Command slot states */
+#define DMMSIM_CMD_FREE         0
+#define DMMSIM_CMD_QUEUED       1
+#define DMMSIM_CMD_RUNNING      2
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+typedef struct
+{
+    uint8_t         state;          // DMMSIM_CMD_*
+    bool            allowDelay;     // may start after its start time
+    RF_Handle       h;
+    RF_CmdHandle    ch;
+    RF_Op          *pOp;
+    RF_Callback     pCb;
+    RF_EventMask    bmEvent;
+    RF_EventMask   *pTermEvent;     // set on termination, for the run functions
+    uint32_t        seq;            // submission order
+    uint32_t        activityInfo;
+    uint16_t        priority;       // final priority without balancing
+    uint64_t        submitted;
+    uint64_t        start;          // requested start time
+    uint64_t        end;            // latest end time, DMMSIM_NO_EVENT if none
+    uint64_t        duration;       // 0 = until cancelled or preempted
+    uint64_t        started;
+} DMMSim_Cmd;
+
+typedef struct
+{
+    TaskHandle_t        task;
+    DMMPolicy_StackRole role;
+} DMMSim_Client;
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+static uint64_t dmmSimNow;
+static TaskHandle_t dmmSimCurrentTask;
+static DMMSim_TraceCb dmmSimTraceCb;
+static DMMSim_Timer *dmmSimTimers;
+
+static DMMSim_Cmd dmmSimCmds[DMMSIM_MAX_CMDS];
+static DMMSim_Cmd *dmmSimRunning;
+static RF_CmdHandle dmmSimNextCh;
+static uint32_t dmmSimNextSeq;
+
+/* Airtime of each stack since the policy last changed, for the ratio balanced mode */
+static uint64_t dmmSimAirtime[DMMPOLICY_NUM_STACKS];
+static uint8_t dmmSimRatioFavoured = DMMPOLICY_NUM_STACKS;
+
+static DMMSch_Params dmmSchParams;
+static DMMSch_PreemptionCb dmmSchPreemptionCb;
+static DMMSim_Client dmmSchClients[DMMPOLICY_NUM_STACKS];
+static bool dmmSchBlocked[DMMPOLICY_NUM_STACKS];
+
+static DMMPolicy_Params dmmPolicyParams;
+static DMMPolicy_Policy *dmmPolicyCur;
+static uint32_t dmmPolicyState[DMMPOLICY_NUM_STACKS];
+static DMMPolicy_AppCbs_t dmmPolicyAppCbs[DMMPOLICY_NUM_STACKS];
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+
+/* Stack index of a stack role, DMMPOLICY_NUM_STACKS if not found */
+static uint8_t dmmSimStackIdx(DMMPolicy_StackRole role)
+{
+    uint8_t i;
+
+    for (i = 0; i < DMMPOLICY_NUM_STACKS; i++)
+    {
+        if (dmmPolicyParams.policyTable.stackRole[i] == role)
+        {
+            break;
+        }
+    }
+    return i;
+}
+
+/* Global priority table of a stack, NULL if there is none */
+static GlobalTable *dmmSimGpt(uint8_t stackIdx)
+{
+    uint8_t i;
+
+    if (dmmPolicyParams.globalPriorityTable == NULL)
+    {
+        return NULL;
+    }
+
+    for (i = 0; i < DMMPOLICY_NUM_STACKS; i++)
+    {
+        if (dmmPolicyParams.globalPriorityTable[i].stackRole ==
+            dmmPolicyParams.policyTable.stackRole[stackIdx])
+        {
+            return &dmmPolicyParams.globalPriorityTable[i];
+        }
+    }
+    return NULL;
+}
+
+static void dmmSimTrace(DMMSim_CmdEvent event, DMMSim_Cmd *pCmd)
+{
+    DMMSim_CmdInfo info;
+
+    if (dmmSimTraceCb == NULL)
+    {
+        return;
+    }
+
+    info.h = pCmd->h;
+    info.ch = pCmd->ch;
+    info.stackIdx = pCmd->h->stackIdx;
+    info.activityInfo = pCmd->activityInfo;
+    info.priority = pCmd->priority;
+    info.submitted = pCmd->submitted;
+    info.requested = pCmd->start;
+    info.started = pCmd->started;
+    info.ran = (pCmd->state == DMMSIM_CMD_RUNNING);
+    dmmSimTraceCb(event, &info);
+}
+
+/* Select the policy matching the current application states, the last one by default */
+static void dmmSimSelectPolicy(void)
+{
+    DMMPolicy_Policy *pPrev = dmmPolicyCur;
+    uint32_t i;
+    uint8_t s;
+
+    if (dmmPolicyParams.numPolicyTableEntries == 0)
+    {
+        dmmPolicyCur = NULL;
+        return;
+    }
+
+    dmmPolicyCur = &dmmPolicyParams.policyTable.policy[dmmPolicyParams.numPolicyTableEntries - 1];
+    for (i = 0; i < dmmPolicyParams.numPolicyTableEntries; i++)
+    {
+        DMMPolicy_Policy *pPolicy = &dmmPolicyParams.policyTable.policy[i];
+
+        for (s = 0; s < DMMPOLICY_NUM_STACKS; s++)
+        {
+            if ((pPolicy->appState[s].state & dmmPolicyState[s]) == 0)
+            {
+                break;
+            }
+        }
+        if (s == DMMPOLICY_NUM_STACKS)
+        {
+            dmmPolicyCur = pPolicy;
+            break;
+        }
+    }
+
+    if (dmmPolicyCur != pPrev)
+    {
+        memset(dmmSimAirtime, 0, sizeof(dmmSimAirtime));
+        dmmSimRatioFavoured = DMMPOLICY_NUM_STACKS;
+
+        for (s = 0; s < DMMPOLICY_NUM_STACKS; s++)
+        {
+            uint16_t pause = dmmPolicyCur->appState[s].pause & DMMPOLICY_PAUSED;
+
+            if ((dmmPolicyAppCbs[s].appPauseCb != NULL) &&
+                ((pPrev == NULL) || ((pPrev->appState[s].pause & DMMPOLICY_PAUSED) != pause)))
+            {
+                dmmPolicyAppCbs[s].appPauseCb(pause);
+            }
+        }
+    }
+}
+
+/* Stack favoured by the balanced mode, DMMPOLICY_NUM_STACKS if none */
+static uint8_t dmmSimFavoured(void)
+{
+    uint32_t bm;
+
+    if ((dmmPolicyCur == NULL) || (dmmPolicyCur->balancedMode == DMMPOLICY_BALANCED_NONE))
+    {
+        return DMMPOLICY_NUM_STACKS;
+    }
+
+    bm = dmmPolicyCur->balancedMode;
+    if (bm & DMMPOLICY_BALANCED_TIME_BM_1)
+    {
+        uint64_t on = RF_convertMsToRatTicks(DMMPOLICY_BALANCED_TIME_MODE_1_ON_MIN(bm));
+        uint64_t off = RF_convertMsToRatTicks(DMMPOLICY_BALANCED_TIME_MODE_1_OFF_MAX(bm));
+        uint8_t hi = (DMMPolicy_getDefaultPriority(1) > DMMPolicy_getDefaultPriority(0)) ? 1 : 0;
+
+        if (on + off == 0)
+        {
+            return DMMPOLICY_NUM_STACKS;
+        }
+        return ((dmmSimNow % (on + off)) < on) ? hi : (uint8_t)(1 - hi);
+    }
+    else
+    {
+        int64_t air0 = (int64_t)dmmSimAirtime[0];
+        int64_t air1 = (int64_t)dmmSimAirtime[1];
+        int64_t share0 = (bm >> 8) & 0xFF;
+        int64_t share1 = bm & 0xFF;
+        int64_t error;
+
+        if (dmmSimRunning != NULL)
+        {
+            if (dmmSimRunning->h->stackIdx == 0)
+            {
+                air0 += dmmSimNow - dmmSimRunning->started;
+            }
+            else
+            {
+                air1 += dmmSimNow - dmmSimRunning->started;
+            }
+        }
+
+        /*
+         * air0 : air1 against share0 : share1, scaled to the airtime of the
+         * whole ratio. The favoured stack only changes once the other one
+         * is DMMSIM_BALANCE_WINDOW behind, so that commands are not
+         * preempted at every re-evaluation.
+         */
+        error = air0 * share1 - air1 * share0;
+        if ((dmmSimRatioFavoured != 1) && (error > (int64_t)DMMSIM_BALANCE_WINDOW * (share0 + share1)))
+        {
+            dmmSimRatioFavoured = 1;
+        }
+        else if ((dmmSimRatioFavoured != 0) && (error < -(int64_t)DMMSIM_BALANCE_WINDOW * (share0 + share1)))
+        {
+            dmmSimRatioFavoured = 0;
+        }
+        return dmmSimRatioFavoured;
+    }
+}
+
+/* Final priority of a command, including the balanced mode */
+static uint16_t dmmSimPriority(DMMSim_Cmd *pCmd, uint8_t favoured)
+{
+    if ((pCmd->h->stackIdx == favoured) && (pCmd->priority < DMM_PRIORITY_MAX_CHANGE_LIMIT))
+    {
+        return DMM_PRIORITY_MAX_CHANGE_LIMIT;
+    }
+    return pCmd->priority;
+}
+
+/* true if pA should get the radio before pB */
+static bool dmmSimBefore(DMMSim_Cmd *pA, DMMSim_Cmd *pB, uint8_t favoured)
+{
+    uint16_t prioA = dmmSimPriority(pA, favoured);
+    uint16_t prioB = dmmSimPriority(pB, favoured);
+
+    if (prioA != prioB)
+    {
+        return prioA > prioB;
+    }
+    if (pA->h->stackIdx != pB->h->stackIdx)
+    {
+        uint8_t defA = DMMPolicy_getDefaultPriority(pA->h->stackIdx);
+        uint8_t defB = DMMPolicy_getDefaultPriority(pB->h->stackIdx);
+
+        if (defA != defB)
+        {
+            return defA > defB;
+        }
+    }
+    return (int32_t)(pA->seq - pB->seq) < 0;
+}
+
+/* true if a queued command can no longer start in time */
+static bool dmmSimLate(DMMSim_Cmd *pCmd)
+{
+    if (!pCmd->allowDelay && (dmmSimNow > pCmd->start))
+    {
+        return true;
+    }
+    return (pCmd->end != DMMSIM_NO_EVENT) && (dmmSimNow + pCmd->duration > pCmd->end);
+}
+
+/* Terminate a command, free its slot and call its callback */
+static void dmmSimTerminate(DMMSim_Cmd *pCmd, RF_EventMask event, DMMSim_CmdEvent traceEvent)
+{
+    RF_Handle h = pCmd->h;
+    RF_CmdHandle ch = pCmd->ch;
+    RF_Callback pCb = pCmd->pCb;
+    RF_EventMask bmEvent = pCmd->bmEvent;
+
+    if (pCmd == dmmSimRunning)
+    {
+        dmmSimAirtime[h->stackIdx] += dmmSimNow - pCmd->started;
+        dmmSimRunning = NULL;
+    }
+
+    dmmSimTrace(traceEvent, pCmd);
+
+    if (pCmd->pTermEvent != NULL)
+    {
+        *pCmd->pTermEvent = event;
+    }
+    pCmd->state = DMMSIM_CMD_FREE;
+
+    /* Termination events are always delivered, like in the RF driver */
+    if ((pCb != NULL) &&
+        ((event & bmEvent) || (event & (RF_EventLastCmdDone | RF_EventCmdAborted | RF_EventCmdStopped |
+                                         RF_EventCmdCancelled | RF_EventCmdPreempted))))
+    {
+        pCb(h, ch, event);
+    }
+}
+
+/* Start a command on the radio */
+static void dmmSimStart(DMMSim_Cmd *pCmd)
+{
+    pCmd->state = DMMSIM_CMD_RUNNING;
+    pCmd->started = dmmSimNow;
+    dmmSimRunning = pCmd;
+    dmmSimTrace(DMMSim_CmdStarted, pCmd);
+}
+
+/*
+ * Make one scheduling decision at the current time. Returns true if a
+ * command was started or terminated, in which case callbacks may have
+ * queued new commands and the caller decides again.
+ */
+static bool dmmSimDecide(void)
+{
+    DMMSim_Cmd *pBest = NULL;
+    uint8_t favoured;
+    uint8_t i;
+
+    if ((dmmSimRunning != NULL) && (dmmSimRunning->duration != 0) &&
+        (dmmSimNow >= dmmSimRunning->started + dmmSimRunning->duration))
+    {
+        dmmSimTerminate(dmmSimRunning, RF_EventCmdDone | RF_EventLastCmdDone, DMMSim_CmdDone);
+        return true;
+    }
+
+    for (i = 0; i < DMMSIM_MAX_CMDS; i++)
+    {
+        if ((dmmSimCmds[i].state == DMMSIM_CMD_QUEUED) && dmmSimLate(&dmmSimCmds[i]))
+        {
+            dmmSimTerminate(&dmmSimCmds[i], RF_EventCmdCancelled, DMMSim_CmdRejected);
+            return true;
+        }
+    }
+
+    favoured = dmmSimFavoured();
+    for (i = 0; i < DMMSIM_MAX_CMDS; i++)
+    {
+        DMMSim_Cmd *pCmd = &dmmSimCmds[i];
+
+        if ((pCmd->state == DMMSIM_CMD_QUEUED) && (pCmd->start <= dmmSimNow) &&
+            ((pBest == NULL) || dmmSimBefore(pCmd, pBest, favoured)))
+        {
+            pBest = pCmd;
+        }
+    }
+
+    if (pBest == NULL)
+    {
+        return false;
+    }
+
+    if (dmmSimRunning == NULL)
+    {
+        if ((pBest->end != DMMSIM_NO_EVENT) && (dmmSimNow + pBest->duration > pBest->end))
+        {
+            dmmSimTerminate(pBest, RF_EventCmdCancelled, DMMSim_CmdRejected);
+        }
+        else
+        {
+            dmmSimStart(pBest);
+        }
+        return true;
+    }
+
+    if (dmmSimPriority(pBest, favoured) > dmmSimPriority(dmmSimRunning, favoured))
+    {
+        DMMPolicy_StackRole role = dmmPolicyParams.policyTable.stackRole[dmmSimRunning->h->stackIdx];
+
+        dmmSimTerminate(dmmSimRunning, RF_EventCmdPreempted, DMMSim_CmdPreempted);
+        if (dmmSchPreemptionCb != NULL)
+        {
+            dmmSchPreemptionCb(role);
+        }
+        return true;
+    }
+
+    if (!pBest->allowDelay)
+    {
+        /* The radio is busy at its start time */
+        dmmSimTerminate(pBest, RF_EventCmdCancelled, DMMSim_CmdRejected);
+        return true;
+    }
+
+    return false;
+}
+
+/* Time of the next scheduling event */
+static uint64_t dmmSimNextEvent(void)
+{
+    uint64_t next = DMMSIM_NO_EVENT;
+    uint8_t i;
+
+    if (dmmSimTimers != NULL)
+    {
+        next = dmmSimTimers->due;
+    }
+
+    if ((dmmSimRunning != NULL) && (dmmSimRunning->duration != 0) &&
+        (dmmSimRunning->started + dmmSimRunning->duration < next))
+    {
+        next = dmmSimRunning->started + dmmSimRunning->duration;
+    }
+
+    for (i = 0; i < DMMSIM_MAX_CMDS; i++)
+    {
+        DMMSim_Cmd *pCmd = &dmmSimCmds[i];
+
+        if (pCmd->state != DMMSIM_CMD_QUEUED)
+        {
+            continue;
+        }
+        if ((pCmd->start > dmmSimNow) && (pCmd->start < next))
+        {
+            next = pCmd->start;
+        }
+        /* A waiting command that does not allow delay is rejected just after its start time */
+        if (!pCmd->allowDelay && (pCmd->start + 1 < next))
+        {
+            next = pCmd->start + 1;
+        }
+        if ((pCmd->end != DMMSIM_NO_EVENT) && (pCmd->end >= pCmd->duration) &&
+            (pCmd->end - pCmd->duration + 1 < next))
+        {
+            next = pCmd->end - pCmd->duration + 1;
+        }
+    }
+
+    /* The favoured stack changes over time in balanced mode */
+    if ((dmmPolicyCur != NULL) && (dmmPolicyCur->balancedMode != DMMPOLICY_BALANCED_NONE))
+    {
+        uint32_t bm = dmmPolicyCur->balancedMode;
+        uint64_t step = DMMSIM_BALANCE_TICK;
+
+        if (bm & DMMPOLICY_BALANCED_TIME_BM_1)
+        {
+            uint64_t on = RF_convertMsToRatTicks(DMMPOLICY_BALANCED_TIME_MODE_1_ON_MIN(bm));
+            uint64_t period = on + RF_convertMsToRatTicks(DMMPOLICY_BALANCED_TIME_MODE_1_OFF_MAX(bm));
+
+            if (period != 0)
+            {
+                uint64_t phase = dmmSimNow % period;
+
+                step = (phase < on) ? (on - phase) : (period - phase);
+            }
+        }
+        if (dmmSimNow + step < next)
+        {
+            next = dmmSimNow + step;
+        }
+    }
+
+    return (next > dmmSimNow) ? next : dmmSimNow + 1;
+}
+
+/* Decide until nothing changes, then advance to the next event up to a limit */
+static bool dmmSimStep(uint64_t until)
+{
+    uint64_t next;
+
+    while (dmmSimDecide())
+    {
+    }
+
+    next = dmmSimNextEvent();
+    if ((next == DMMSIM_NO_EVENT) || (next > until))
+    {
+        return false;
+    }
+
+    dmmSimNow = next;
+    while ((dmmSimTimers != NULL) && (dmmSimTimers->due <= dmmSimNow))
+    {
+        DMMSim_Timer *pTimer = dmmSimTimers;
+
+        dmmSimTimers = pTimer->pNext;
+        pTimer->armed = false;
+        pTimer->pfnCb(pTimer->arg);
+    }
+    return true;
+}
+
+/* Convert a 32-bit RAT time to the 64-bit timeline, around the current time */
+static uint64_t dmmSimFromRat(uint32_t ratTime)
+{
+    return dmmSimNow + (int64_t)(int32_t)(ratTime - (uint32_t)dmmSimNow);
+}
+
+static DMMSim_Cmd *dmmSimFind(RF_Handle h, RF_CmdHandle ch)
+{
+    uint8_t i;
+
+    for (i = 0; i < DMMSIM_MAX_CMDS; i++)
+    {
+        if ((dmmSimCmds[i].state != DMMSIM_CMD_FREE) && (dmmSimCmds[i].h == h) && (dmmSimCmds[i].ch == ch))
+        {
+            return &dmmSimCmds[i];
+        }
+    }
+    return NULL;
+}
+
+/* Queue a command, called by the post and schedule functions */
+static RF_CmdHandle dmmSimSubmit(RF_Handle h, RF_Op *pOp, RF_ScheduleCmdParams *pSchParams,
+                                 uint16_t priority, RF_Callback pCb, RF_EventMask bmEvent)
+{
+    DMMSim_Cmd *pCmd = NULL;
+    uint8_t i;
+
+    if ((h == NULL) || (pOp == NULL))
+    {
+        return RF_ALLOC_ERROR;
+    }
+
+    for (i = 0; i < DMMSIM_MAX_CMDS; i++)
+    {
+        if (dmmSimCmds[i].state == DMMSIM_CMD_FREE)
+        {
+            pCmd = &dmmSimCmds[i];
+            break;
+        }
+    }
+    if (pCmd == NULL)
+    {
+        return RF_ALLOC_ERROR;
+    }
+
+    memset(pCmd, 0, sizeof(DMMSim_Cmd));
+    pCmd->h = h;
+    pCmd->pOp = pOp;
+    pCmd->pCb = pCb;
+    pCmd->bmEvent = bmEvent;
+    pCmd->priority = priority;
+    pCmd->submitted = dmmSimNow;
+    pCmd->start = dmmSimNow;
+    pCmd->end = DMMSIM_NO_EVENT;
+    pCmd->allowDelay = true;
+    pCmd->duration = DMMSIM_POST_CMD_DURATION;
+
+    if (pOp->startTrigger.triggerType == TRIG_ABSTIME)
+    {
+        pCmd->start = dmmSimFromRat(pOp->startTime);
+    }
+
+    if (pSchParams != NULL)
+    {
+        pCmd->activityInfo = pSchParams->activityInfo;
+        pCmd->allowDelay = (pSchParams->allowDelay != RF_AllowDelayNone);
+
+        if (pSchParams->startType == RF_StartAbs)
+        {
+            pCmd->start = dmmSimFromRat(pSchParams->startTime);
+        }
+
+        pCmd->duration = pSchParams->duration;
+        if ((pCmd->duration == (uint32_t)~0U) || (pSchParams->endType == RF_EndInfinit))
+        {
+            pCmd->duration = 0;
+        }
+
+        if (pSchParams->endType == RF_EndAbs)
+        {
+            pCmd->end = dmmSimFromRat(pSchParams->endTime);
+        }
+        else if (pSchParams->endType == RF_EndRel)
+        {
+            pCmd->end = pCmd->start + pSchParams->endTime;
+        }
+    }
+
+    if (pCmd->start < dmmSimNow)
+    {
+        pCmd->start = dmmSimNow;
+    }
+
+    /* Handles are positive and increase, like those of the RF driver */
+    pCmd->ch = dmmSimNextCh;
+    dmmSimNextCh = (dmmSimNextCh == INT16_MAX) ? 0 : (RF_CmdHandle)(dmmSimNextCh + 1);
+    pCmd->seq = dmmSimNextSeq++;
+
+    if (dmmSchBlocked[h->stackIdx])
+    {
+        dmmSimTrace(DMMSim_CmdRejected, pCmd);
+        return RF_SCHEDULE_CMD_ERROR;
+    }
+
+    pCmd->state = DMMSIM_CMD_QUEUED;
+    dmmSimTrace(DMMSim_CmdQueued, pCmd);
+
+    return pCmd->ch;
+}
+
+/* Step the timeline until a command terminates, for the run functions */
+static RF_EventMask dmmSimPend(RF_Handle h, RF_CmdHandle ch)
+{
+    DMMSim_Cmd *pCmd = dmmSimFind(h, ch);
+    RF_EventMask event = 0;
+
+    if (pCmd == NULL)
+    {
+        return 0;
+    }
+
+    pCmd->pTermEvent = &event;
+    while ((event == 0) && dmmSimStep(DMMSIM_NO_EVENT - 1))
+    {
+    }
+
+    /* No event left that could end it */
+    if (event == 0)
+    {
+        pCmd->pTermEvent = NULL;
+    }
+    return event;
+}
+
+/*********************************************************************
+ * HOST FUNCTIONS
+ */
+
+uint64_t DMMSim_now(void)
+{
+    return dmmSimNow;
+}
+
+void DMMSim_setCurrentTask(TaskHandle_t task)
+{
+    dmmSimCurrentTask = task;
+}
+
+void DMMSim_registerTraceCb(DMMSim_TraceCb pfnTraceCb)
+{
+    dmmSimTraceCb = pfnTraceCb;
+}
+
+void DMMSim_setTimer(DMMSim_Timer *pTimer, uint64_t due, DMMSim_TimerCb pfnCb, void *arg)
+{
+    DMMSim_Timer **ppNext = &dmmSimTimers;
+
+    DMMSim_stopTimer(pTimer);
+
+    pTimer->due = due;
+    pTimer->pfnCb = pfnCb;
+    pTimer->arg = arg;
+
+    /* Keep the list in expiry order, timers due at the same time in arming order */
+    while ((*ppNext != NULL) && ((*ppNext)->due <= due))
+    {
+        ppNext = &(*ppNext)->pNext;
+    }
+    pTimer->pNext = *ppNext;
+    *ppNext = pTimer;
+    pTimer->armed = true;
+}
+
+void DMMSim_stopTimer(DMMSim_Timer *pTimer)
+{
+    DMMSim_Timer **ppNext = &dmmSimTimers;
+
+    if (!pTimer->armed)
+    {
+        return;
+    }
+
+    while (*ppNext != pTimer)
+    {
+        ppNext = &(*ppNext)->pNext;
+    }
+    *ppNext = pTimer->pNext;
+    pTimer->armed = false;
+}
+
+bool DMMSim_isRunning(RF_Handle h, RF_CmdHandle ch)
+{
+    return (dmmSimRunning != NULL) && (dmmSimRunning->h == h) && (dmmSimRunning->ch == ch);
+}
+
+void DMMSim_run(uint64_t until)
+{
+    while (dmmSimStep(until))
+    {
+    }
+
+    if (dmmSimNow < until)
+    {
+        dmmSimNow = until;
+        while (dmmSimDecide())
+        {
+        }
+    }
+}
+
+/*********************************************************************
+ * RF DRIVER STAND-IN
+ */
+
+void RF_Params_init(RF_Params *params)
+{
+    memset(params, 0, sizeof(RF_Params));
+}
+
+void RF_ScheduleCmdParams_init(RF_ScheduleCmdParams *pSchParams)
+{
+    memset(pSchParams, 0, sizeof(RF_ScheduleCmdParams));
+    pSchParams->startType = RF_StartNotSpecified;
+    pSchParams->allowDelay = RF_AllowDelayAny;
+    pSchParams->endType = RF_EndNotSpecified;
+}
+
+uint32_t RF_getCurrentTime(void)
+{
+    return (uint32_t)dmmSimNow;
+}
+
+/*********************************************************************
+ * DMM SCHEDULER
+ */
+
+void DMMSch_Params_init(DMMSch_Params *params)
+{
+    memset(params, 0, sizeof(DMMSch_Params));
+}
+
+void DMMSch_init(void)
+{
+    memset(dmmSimCmds, 0, sizeof(dmmSimCmds));
+    memset(dmmSchClients, 0, sizeof(dmmSchClients));
+    memset(dmmSchBlocked, 0, sizeof(dmmSchBlocked));
+    memset(dmmSimAirtime, 0, sizeof(dmmSimAirtime));
+    dmmSimRatioFavoured = DMMPOLICY_NUM_STACKS;
+    dmmSimRunning = NULL;
+    dmmSimTimers = NULL;
+    dmmSimNow = 0;
+    dmmSimNextCh = 0;
+    dmmSimNextSeq = 0;
+    dmmSchPreemptionCb = NULL;
+}
+
+void DMMSch_registerPreemptionCb(DMMSch_PreemptionCb dmmSchPreemptionCbIn)
+{
+    dmmSchPreemptionCb = dmmSchPreemptionCbIn;
+}
+
+void DMMSch_open(DMMSch_Params *params)
+{
+    dmmSchParams = *params;
+}
+
+void DMMSch_registerClient(TaskHandle_t pTaskHndl, DMMPolicy_StackRole StackRole)
+{
+    uint8_t i;
+
+    for (i = 0; i < DMMPOLICY_NUM_STACKS; i++)
+    {
+        if ((dmmSchClients[i].task == NULL) || (dmmSchClients[i].task == pTaskHndl))
+        {
+            dmmSchClients[i].task = pTaskHndl;
+            dmmSchClients[i].role = StackRole;
+            break;
+        }
+    }
+}
+
+RF_Handle DMMSch_rfOpen(RF_Object *pObj, RF_Mode *pRfMode, RF_RadioSetup *pOpSetup, RF_Params *params)
+{
+    uint8_t i;
+
+    for (i = 0; i < DMMPOLICY_NUM_STACKS; i++)
+    {
+        if ((dmmSchClients[i].task != NULL) && (dmmSchClients[i].task == dmmSimCurrentTask))
+        {
+            break;
+        }
+    }
+    if ((i == DMMPOLICY_NUM_STACKS) || (dmmSimStackIdx(dmmSchClients[i].role) == DMMPOLICY_NUM_STACKS))
+    {
+        /* Not called from a registered client */
+        return NULL;
+    }
+
+    memset(pObj, 0, sizeof(RF_Object));
+    if (params != NULL)
+    {
+        pObj->params = *params;
+    }
+    pObj->pRfMode = pRfMode;
+    pObj->pOpSetup = pOpSetup;
+    pObj->stackIdx = dmmSimStackIdx(dmmSchClients[i].role);
+
+    return pObj;
+}
+
+RF_CmdHandle DMMSch_rfPostCmd(RF_Handle h, RF_Op* pOp, RF_Priority ePri, RF_Callback pCb, RF_EventMask bmEvent)
+{
+    (void)ePri;
+
+    if (h == NULL)
+    {
+        return RF_ALLOC_ERROR;
+    }
+    return dmmSimSubmit(h, pOp, NULL, DMMPolicy_getDefaultPriority(h->stackIdx), pCb, bmEvent);
+}
+
+RF_CmdHandle DMMSch_rfScheduleCmd(RF_Handle h, RF_Op* pOp, RF_ScheduleCmdParams *pSchParams, RF_Callback pCb, RF_EventMask bmEvent)
+{
+    if ((h == NULL) || (pSchParams == NULL))
+    {
+        return RF_ALLOC_ERROR;
+    }
+    return dmmSimSubmit(h, pOp, pSchParams, DMMPolicy_getGlobalPriority(pSchParams->activityInfo, h->stackIdx),
+                        pCb, bmEvent);
+}
+
+RF_EventMask DMMSch_rfRunCmd(RF_Handle h, RF_Op* pOp, RF_Priority ePri, RF_Callback pCb, RF_EventMask bmEvent)
+{
+    RF_CmdHandle ch = DMMSch_rfPostCmd(h, pOp, ePri, pCb, bmEvent);
+
+    return (ch >= 0) ? dmmSimPend(h, ch) : 0;
+}
+
+RF_EventMask DMMSch_rfRunScheduleCmd(RF_Handle h, RF_Op* pOp, RF_ScheduleCmdParams *pSchParams, RF_Callback pCb, RF_EventMask bmEvent)
+{
+    RF_CmdHandle ch = DMMSch_rfScheduleCmd(h, pOp, pSchParams, pCb, bmEvent);
+
+    return (ch >= 0) ? dmmSimPend(h, ch) : 0;
+}
+
+RF_Stat DMMSch_rfCancelCmd(RF_Handle h, RF_CmdHandle ch, uint8_t mode)
+{
+    DMMSim_Cmd *pCmd = dmmSimFind(h, ch);
+
+    if (pCmd == NULL)
+    {
+        return RF_StatCmdEnded;
+    }
+
+    if (pCmd->state == DMMSIM_CMD_RUNNING)
+    {
+        dmmSimTerminate(pCmd, mode ? RF_EventCmdStopped : RF_EventCmdAborted, DMMSim_CmdCancelled);
+    }
+    else
+    {
+        dmmSimTerminate(pCmd, RF_EventCmdCancelled, DMMSim_CmdCancelled);
+    }
+    return RF_StatSuccess;
+}
+
+RF_Stat DMMSch_rfFlushCmd(RF_Handle h, RF_CmdHandle ch, uint8_t mode)
+{
+    DMMSim_Cmd *pFirst = NULL;
+    uint32_t limit = dmmSimNextSeq;
+    uint8_t i;
+
+    if (ch != RF_CMDHANDLE_FLUSH_ALL)
+    {
+        pFirst = dmmSimFind(h, ch);
+        if (pFirst == NULL)
+        {
+            return RF_StatCmdEnded;
+        }
+    }
+
+    /* Cancel in submission order, keeping commands queued by the callbacks */
+    for (;;)
+    {
+        DMMSim_Cmd *pNext = NULL;
+
+        for (i = 0; i < DMMSIM_MAX_CMDS; i++)
+        {
+            DMMSim_Cmd *pCmd = &dmmSimCmds[i];
+
+            if ((pCmd->state != DMMSIM_CMD_FREE) && (pCmd->h == h) &&
+                ((pFirst == NULL) || ((int32_t)(pCmd->seq - pFirst->seq) >= 0)) &&
+                ((int32_t)(pCmd->seq - limit) < 0) &&
+                ((pNext == NULL) || ((int32_t)(pCmd->seq - pNext->seq) < 0)))
+            {
+                pNext = pCmd;
+            }
+        }
+        if (pNext == NULL)
+        {
+            break;
+        }
+        (void)DMMSch_rfCancelCmd(h, pNext->ch, mode);
+    }
+    return RF_StatSuccess;
+}
+
+RF_Stat DMMSch_rfRunImmediateCmd(RF_Handle h, uint32_t* pCmdStruct)
+{
+    (void)pCmdStruct;
+
+    return ((dmmSimRunning != NULL) && (dmmSimRunning->h == h)) ? RF_StatCmdDoneSuccess : RF_StatRadioInactiveError;
+}
+
+RF_Stat DMMSch_rfRunDirectCmd(RF_Handle h, uint32_t cmd)
+{
+    (void)cmd;
+
+    return ((dmmSimRunning != NULL) && (dmmSimRunning->h == h)) ? RF_StatCmdDoneSuccess : RF_StatRadioInactiveError;
+}
+
+bool DMMSch_setBlockModeOn(DMMPolicy_StackRole stackRole)
+{
+    uint8_t stackIdx = dmmSimStackIdx(stackRole);
+    uint8_t i;
+
+    if (stackIdx == DMMPOLICY_NUM_STACKS)
+    {
+        return false;
+    }
+
+    dmmSchBlocked[stackIdx] = true;
+    for (i = 0; i < DMMSIM_MAX_CMDS; i++)
+    {
+        DMMSim_Cmd *pCmd = &dmmSimCmds[i];
+
+        if ((pCmd->state != DMMSIM_CMD_FREE) && (pCmd->h->stackIdx == stackIdx))
+        {
+            dmmSimTerminate(pCmd, (pCmd->state == DMMSIM_CMD_RUNNING) ? RF_EventCmdAborted : RF_EventCmdCancelled,
+                            DMMSim_CmdRejected);
+        }
+    }
+    return true;
+}
+
+bool DMMSch_setBlockModeOff(DMMPolicy_StackRole stackRole)
+{
+    uint8_t stackIdx = dmmSimStackIdx(stackRole);
+
+    if (stackIdx == DMMPOLICY_NUM_STACKS)
+    {
+        return false;
+    }
+
+    dmmSchBlocked[stackIdx] = false;
+    return true;
+}
+
+bool DMMSch_getBlockModeStatus(DMMPolicy_StackRole stackRole)
+{
+    uint8_t stackIdx = dmmSimStackIdx(stackRole);
+
+    return (stackIdx != DMMPOLICY_NUM_STACKS) && dmmSchBlocked[stackIdx];
+}
+
+RF_Stat DMMSch_rfRequestAccess(RF_Handle h, RF_AccessParams *pParams)
+{
+    (void)h;
+    (void)pParams;
+
+    /* Not available under DMM */
+    return RF_StatInvalidParamsError;
+}
+
+/*********************************************************************
+ * DMM POLICY MANAGER
+ */
+
+void DMMPolicy_Params_init(DMMPolicy_Params *params)
+{
+    memset(params, 0, sizeof(DMMPolicy_Params));
+}
+
+void DMMPolicy_registerAppCbs(DMMPolicy_AppCbs_t AppCbs, DMMPolicy_StackRole StackRole)
+{
+    uint8_t stackIdx = dmmSimStackIdx(StackRole);
+
+    if (stackIdx != DMMPOLICY_NUM_STACKS)
+    {
+        dmmPolicyAppCbs[stackIdx] = AppCbs;
+    }
+}
+
+void DMMPolicy_init(void)
+{
+    memset(&dmmPolicyParams, 0, sizeof(dmmPolicyParams));
+    memset(dmmPolicyState, 0, sizeof(dmmPolicyState));
+    memset(dmmPolicyAppCbs, 0, sizeof(dmmPolicyAppCbs));
+    dmmPolicyCur = NULL;
+}
+
+DMMPolicy_Status DMMPolicy_open(DMMPolicy_Params *params)
+{
+    if (params == NULL)
+    {
+        return DMMPolicy_StatusParamError;
+    }
+    if ((params->numPolicyTableEntries == 0) || (params->policyTable.policy == NULL))
+    {
+        return DMMPolicy_StatusNoPolicyError;
+    }
+
+    dmmPolicyParams = *params;
+    dmmPolicyCur = NULL;
+    dmmSimSelectPolicy();
+
+    return DMMPolicy_StatusSuccess;
+}
+
+DMMPolicy_Status DMMPolicy_updateApplicationState(DMMPolicy_StackRole StackRole, uint32_t newState)
+{
+    uint8_t stackIdx = dmmSimStackIdx(StackRole);
+
+    if (stackIdx == DMMPOLICY_NUM_STACKS)
+    {
+        return DMMPolicy_StatusParamError;
+    }
+    if (dmmPolicyCur == NULL)
+    {
+        return DMMPolicy_StatusNoPolicyError;
+    }
+
+    dmmPolicyState[stackIdx] = newState;
+    dmmSimSelectPolicy();
+
+    return DMMPolicy_StatusSuccess;
+}
+
+uint16_t DMMPolicy_getGlobalPriority(uint32_t activity, uint32_t stackID)
+{
+    GlobalTable *pGpt;
+    uint16_t priority;
+    uint8_t i;
+
+    if (stackID >= DMMPOLICY_NUM_STACKS)
+    {
+        return 0;
+    }
+
+    pGpt = dmmSimGpt((uint8_t)stackID);
+    if (pGpt == NULL)
+    {
+        return DMMPolicy_getDefaultPriority(stackID);
+    }
+
+    for (i = 0; i < pGpt->tableSize; i++)
+    {
+        if (pGpt->globalTableArray[i].activity == activity)
+        {
+            break;
+        }
+    }
+    if (i == pGpt->tableSize)
+    {
+        /* Unknown activity */
+        return DMMPolicy_getDefaultPriority(stackID);
+    }
+
+    priority = pGpt->globalTableArray[i].globalPriority;
+    if ((dmmPolicyCur != NULL) && (priority <= DMM_PRIORITY_MAX_CHANGE_LIMIT))
+    {
+        DMMPolicy_State *pState = &dmmPolicyCur->appState[stackID];
+
+        if ((pState->appliedActivity == DMMPOLICY_APPLIED_ACTIVITY_ALL) ||
+            (pState->appliedActivity & (1UL << (i / PRIORITY_NUM))))
+        {
+            priority += pState->weight;
+            if (priority > DMM_PRIORITY_MAX_CHANGE_LIMIT)
+            {
+                priority = DMM_PRIORITY_MAX_CHANGE_LIMIT;
+            }
+        }
+    }
+    return priority;
+}
+
+uint8_t DMMPolicy_getDefaultPriority(uint32_t stackID)
+{
+    if ((stackID >= DMMPOLICY_NUM_STACKS) || (dmmPolicyParams.numPolicyTableEntries == 0))
+    {
+        return 0;
+    }
+
+    /* The last policy holds the default priority of the stacks */
+    return dmmPolicyParams.policyTable.policy[dmmPolicyParams.numPolicyTableEntries - 1].appState[stackID].weight;
+}
+
+void DMMPolicy_setStackID(uint32_t stackID, DMMPolicy_StackRole StackRole)
+{
+    /* Stack IDs are the stack indexes on the host */
+    (void)stackID;
+    (void)StackRole;
+}
+
+uint16_t DMMPolicy_getPauseValue(uint32_t stackID)
+{
+    if ((stackID >= DMMPOLICY_NUM_STACKS) || (dmmPolicyCur == NULL))
+    {
+        return DMMPOLICY_NOT_PAUSED;
+    }
+    return dmmPolicyCur->appState[stackID].pause;
+}
+
+uint16_t DMMPolicy_getTimeConstraintValue(uint32_t stackID)
+{
+    if ((stackID >= DMMPOLICY_NUM_STACKS) || (dmmPolicyCur == NULL))
+    {
+        return DMMPOLICY_TIME_RESERVED;
+    }
+    return dmmPolicyCur->appState[stackID].timingConstraint;
+}
+
+bool DMMPolicy_getGPTStatus(void)
+{
+    return dmmPolicyParams.globalPriorityTable != NULL;
+}
+
+bool DMMPolicy_setBlockModeOn(DMMPolicy_StackRole StackRole)
+{
+    return DMMSch_setBlockModeOn(StackRole);
+}
+
+bool DMMPolicy_setBlockModeOff(DMMPolicy_StackRole StackRole)
+{
+    return DMMSch_setBlockModeOff(StackRole);
+}
+
+bool DMMPolicy_getBlockModeStatus(DMMPolicy_StackRole StackRole)
+{
+    return DMMSch_getBlockModeStatus(StackRole);
+}
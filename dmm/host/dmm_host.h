@@ -0,0 +1,237 @@
+/******************************************************************************
+
+ @file dmm_host.h
+
+ @brief DMM scheduler and policy manager host stand-in Header
+
+ Group: WCS LPC
+ Target Device: cc13xx_cc26xx
+
+ ******************************************************************************
+ 
+ Copyright (c) 2022, Texas Instruments Incorporated
+
+ All rights reserved not granted herein.
+ Limited License.
+
+ Texas Instruments Incorporated grants a world-wide, royalty-free,
+ non-exclusive license under copyrights and patents it now or hereafter
+ owns or controls to make, have made, use, import, offer to sell and sell
+ ("Utilize") this software subject to the terms herein. With respect to the
+ foregoing patent license, such license is granted solely to the extent that
+ any such patent is necessary to Utilize the software alone. The patent
+ license shall not apply to any combinations which include this software,
+ other than combinations with devices manufactured by or for TI ("TI
+ Devices"). No hardware patent is licensed hereunder.
+
+ Redistributions must preserve existing copyright notices and reproduce
+ this license (including the above copyright notice and the disclaimer and
+ (if applicable) source code license limitations below) in the documentation
+ and/or other materials provided with the distribution.
+
+ Redistribution and use in binary form, without modification, are permitted
+ provided that the following conditions are met:
+
+   * No reverse engineering, decompilation, or disassembly of this software
+     is permitted with respect to any software provided in binary form.
+   * Any redistribution and use are licensed by TI for use only with TI Devices.
+   * Nothing shall obligate TI to provide you with source code for the software
+     licensed and provided to you in object code.
+
+ If software source code is provided to you, modification and redistribution
+ of the source code are permitted provided that the following conditions are
+ met:
+
+   * Any redistribution and use of the source code, including any resulting
+     derivative works, are licensed by TI for use only with TI Devices.
+   * Any redistribution and use of any object code compiled from the source
+     code and any resulting derivative works, are licensed by TI for use
+     only with TI Devices.
+
+ Neither the name of Texas Instruments Incorporated nor the names of its
+ suppliers may be used to endorse or promote products derived from this
+ software without specific prior written permission.
+
+ DISCLAIMER.
+
+ THIS SOFTWARE IS PROVIDED BY TI AND TI'S LICENSORS "AS IS" AND ANY EXPRESS
+ OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ IN NO EVENT SHALL TI AND TI'S LICENSORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ 
+ 
+ *****************************************************************************/
+/*!****************************************************************************
+ *  @file  dmm_host.h
+ *
+ *  @brief      Host stand-in of the DMM scheduler and policy manager
+ *
+ *  dmm_host.c implements the DMMSch_* and DMMPolicy_* functions of
+ *  dmm_scheduler.h and dmm_policy.h on a virtual radio timeline, so that a
+ *  policy table and a global priority table can be exercised on Linux with
+ *  the stacks replaced by traffic generators (see dmm_sim.c).
+ *
+ *  # Scheduling model #
+ *  - One radio, one command running at a time. Time is counted in 64-bit
+ *    RAT ticks and only advances inside DMMSim_run().
+ *  - A command is ready once its start time has come. Of the ready commands
+ *    the one with the highest final priority runs; a tie goes to the stack
+ *    with the higher default priority, then to the earlier submission.
+ *  - A ready command of higher final priority preempts the running one,
+ *    which terminates with RF_EventCmdPreempted. Commands of equal priority
+ *    never preempt each other.
+ *  - A command is rejected (RF_EventCmdCancelled) when it can no longer
+ *    start in time: it does not allow delay and the radio is busy at its
+ *    start time, or it could not end by its end time.
+ *  - Final priority = GPT value of the activity + .weight of the current
+ *    policy, if the activity is in .appliedActivity and the GPT value is
+ *    not above DMM_PRIORITY_MAX_CHANGE_LIMIT, which also caps the sum.
+ *    Bit n of .appliedActivity selects the n-th activity of the stack's
+ *    global priority table, which matches the DMMPOLICY_APPLIED_ACTIVITY_154_*
+ *    bits for the Zigbee table.
+ *  - .balancedMode lifts the favoured stack's adjustable commands to
+ *    DMM_PRIORITY_MAX_CHANGE_LIMIT. In ratio mode (0x0000xxyy) a stack is
+ *    favoured once it is DMMSIM_BALANCE_WINDOW behind its airtime share,
+ *    until the other stack is that far behind. In time mode
+ *    (DMMPOLICY_BALANCED_TIME_MODE_1) the stack with the higher default
+ *    priority is favoured for the first on-min ms of every
+ *    on-min + off-max ms, the other stack for the rest.
+ *  - A stack in block mode has its commands rejected at submission and its
+ *    running command aborted.
+ *
+ *  The policy functions take the stack index (the position of the stack
+ *  role in DMMPolicy_Params.policyTable.stackRole) as stack ID.
+ *
+ *********************************************************************************/
+
+#ifndef DMM_HOST_H_
+#define DMM_HOST_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "stdint.h"
+
+#include <ti/drivers/rf/RF.h>
+#include <FreeRTOS.h>
+#include <task.h>
+
+#include "dmm_policy.h"
+
+//! \brief Number of commands that can be queued or running at the same time
+#ifndef DMMSIM_MAX_CMDS
+#define DMMSIM_MAX_CMDS             32
+#endif
+
+//! \brief Duration of a command posted without schedule parameters
+#ifndef DMMSIM_POST_CMD_DURATION
+#define DMMSIM_POST_CMD_DURATION    RF_convertMsToRatTicks(1)
+#endif
+
+//! \brief Interval at which the ratio balanced mode re-evaluates the favoured stack
+#ifndef DMMSIM_BALANCE_TICK
+#define DMMSIM_BALANCE_TICK         RF_convertMsToRatTicks(1)
+#endif
+
+//! \brief Airtime a stack may fall behind its share before the ratio balanced mode favours it
+#ifndef DMMSIM_BALANCE_WINDOW
+#define DMMSIM_BALANCE_WINDOW       RF_convertMsToRatTicks(20)
+#endif
+
+//! \brief Command events reported to the trace callback
+typedef enum
+{
+    DMMSim_CmdQueued,           ///< accepted by the scheduler
+    DMMSim_CmdStarted,          ///< started on the radio
+    DMMSim_CmdDone,             ///< ran for its duration
+    DMMSim_CmdPreempted,        ///< preempted by a command of higher priority
+    DMMSim_CmdRejected,         ///< could not start in time, or its stack is blocked
+    DMMSim_CmdCancelled,        ///< cancelled, stopped or aborted by its stack
+} DMMSim_CmdEvent;
+
+//! \brief Command information reported to the trace callback
+typedef struct
+{
+    RF_Handle    h;             ///< client of the command
+    RF_CmdHandle ch;            ///< command handle, RF_SCHEDULE_CMD_ERROR if rejected at submission
+    uint8_t      stackIdx;      ///< stack index of the client
+    uint32_t     activityInfo;  ///< activity and priority level, 0 for posted commands
+    uint16_t     priority;      ///< final priority
+    uint64_t     submitted;     ///< time of the post or schedule call
+    uint64_t     requested;     ///< requested start time
+    uint64_t     started;       ///< start time, valid if ran is true
+    bool         ran;           ///< true once it started on the radio
+} DMMSim_CmdInfo;
+
+//! \brief Trace callback, called for every command event
+typedef void (*DMMSim_TraceCb)(DMMSim_CmdEvent event, const DMMSim_CmdInfo *pInfo);
+
+//! \brief Timer callback
+typedef void (*DMMSim_TimerCb)(void *arg);
+
+//! \brief Timer on the virtual timeline, owned by the caller
+typedef struct DMMSim_Timer_s
+{
+    uint64_t               due;         ///< expiry time in RAT ticks
+    DMMSim_TimerCb         pfnCb;       ///< called at expiry
+    void                  *arg;         ///< argument of pfnCb
+    struct DMMSim_Timer_s *pNext;       ///< next armed timer
+    bool                   armed;       ///< true while in the timer list
+} DMMSim_Timer;
+
+/** @brief  Get the virtual time
+ *  @return current time in RAT ticks
+ */
+extern uint64_t DMMSim_now(void);
+
+/** @brief  Set the task handle that identifies the calling stack in
+ *          DMMSch_rfOpen()
+ *  @param  task    handle passed to DMMSch_registerClient() for the stack
+ */
+extern void DMMSim_setCurrentTask(TaskHandle_t task);
+
+/** @brief  Register the trace callback
+ *  @param  pfnTraceCb  callback, NULL to disable
+ */
+extern void DMMSim_registerTraceCb(DMMSim_TraceCb pfnTraceCb);
+
+/** @brief  Arm a timer, re-arming it if it is armed
+ *  @param  pTimer  timer
+ *  @param  due     expiry time in RAT ticks
+ *  @param  pfnCb   called at expiry
+ *  @param  arg     argument of pfnCb
+ */
+extern void DMMSim_setTimer(DMMSim_Timer *pTimer, uint64_t due, DMMSim_TimerCb pfnCb, void *arg);
+
+/** @brief  Disarm a timer
+ *  @param  pTimer  timer
+ */
+extern void DMMSim_stopTimer(DMMSim_Timer *pTimer);
+
+/** @brief  Check whether a command is running on the radio
+ *  @param  h       client of the command
+ *  @param  ch      command handle
+ *  @return true if the command is running
+ */
+extern bool DMMSim_isRunning(RF_Handle h, RF_CmdHandle ch);
+
+/** @brief  Run the virtual timeline, delivering command callbacks and
+ *          timer expiries in time order
+ *  @param  until   time in RAT ticks to stop at
+ */
+extern void DMMSim_run(uint64_t until);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DMM_HOST_H_ */
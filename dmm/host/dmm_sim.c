@@ -0,0 +1,1138 @@
+/******************************************************************************
+
+ @file dmm_sim.c
+
+ @brief DMM coexistence simulator for the prop echo and Zigbee router roles
+
+ Group: WCS LPC
+ Target Device: cc13xx_cc26xx
+
+ ******************************************************************************
+ 
+ Copyright (c) 2022, Texas Instruments Incorporated
+
+ All rights reserved not granted herein.
+ Limited License.
+
+ Texas Instruments Incorporated grants a world-wide, royalty-free,
+ non-exclusive license under copyrights and patents it now or hereafter
+ owns or controls to make, have made, use, import, offer to sell and sell
+ ("Utilize") this software subject to the terms herein. With respect to the
+ foregoing patent license, such license is granted solely to the extent that
+ any such patent is necessary to Utilize the software alone. The patent
+ license shall not apply to any combinations which include this software,
+ other than combinations with devices manufactured by or for TI ("TI
+ Devices"). No hardware patent is licensed hereunder.
+
+ Redistributions must preserve existing copyright notices and reproduce
+ this license (including the above copyright notice and the disclaimer and
+ (if applicable) source code license limitations below) in the documentation
+ and/or other materials provided with the distribution.
+
+ Redistribution and use in binary form, without modification, are permitted
+ provided that the following conditions are met:
+
+   * No reverse engineering, decompilation, or disassembly of this software
+     is permitted with respect to any software provided in binary form.
+   * Any redistribution and use are licensed by TI for use only with TI Devices.
+   * Nothing shall obligate TI to provide you with source code for the software
+     licensed and provided to you in object code.
+
+ If software source code is provided to you, modification and redistribution
+ of the source code are permitted provided that the following conditions are
+ met:
+
+   * Any redistribution and use of the source code, including any resulting
+     derivative works, are licensed by TI for use only with TI Devices.
+   * Any redistribution and use of any object code compiled from the source
+     code and any resulting derivative works, are licensed by TI for use
+     only with TI Devices.
+
+ Neither the name of Texas Instruments Incorporated nor the names of its
+ suppliers may be used to endorse or promote products derived from this
+ software without specific prior written permission.
+
+ DISCLAIMER.
+
+ THIS SOFTWARE IS PROVIDED BY TI AND TI'S LICENSORS "AS IS" AND ANY EXPRESS
+ OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ IN NO EVENT SHALL TI AND TI'S LICENSORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ 
+ 
+ *****************************************************************************/
+/*!****************************************************************************
+ *  @file  dmm_sim.c
+ *
+ *  @brief      DMM coexistence simulator for the prop echo + Zigbee router
+ *              application
+ *
+ *  Runs the DMM policy and the global priority table of this application
+ *  (globalPriorityTable_propLzigbeeZrH) on the host scheduler of dmm_host.c,
+ *  with the two stacks replaced by traffic generators:
+ *
+ *  - Zigbee router: receiver on (RXON) between transmissions, a MAC queue
+ *    of data frames and beacons sent with retries and a deadline, and
+ *    incoming frames that are only heard while RXON runs.
+ *  - Prop echo: the continuous RX mode of rfEchoRx.c. Frequency synthesizer
+ *    programming at start, RX that fills a ring of packets, and an echo of
+ *    every packet in the ring once the first one is TX_DELAY old.
+ *    With -c, the chained RX->TX mode of the default build instead: RX
+ *    stops at the first packet, and the radio waits TX_DELAY for the echo
+ *    before RX starts again. The chain is modelled as an RX command
+ *    followed by a TX command that lasts TX_DELAY plus the packet.
+ *
+ *  Like rfEchoRx.c, the simulation blocks the Zigbee stack 500 ms after the
+ *  start. The application relies on this: in the priority table, prop RX/TX
+ *  at normal priority (30) ranks below Zigbee RXON (80), which the router
+ *  keeps queued whenever it is not transmitting, so without the block the
+ *  prop stack never gets the radio. -U runs without the block to show this;
+ *  the report then flags the starved stack.
+ *
+ *  At the end it reports, per stack and activity, the commands queued,
+ *  preempted and rejected, the airtime share and the start latency
+ *  percentiles, followed by the application level results: the prop echo
+ *  throughput and packet loss, for comparing the two echo modes over -p
+ *  packet rates.
+ *
+ *  # Build and run #
+ *  From the repository root:
+ *
+ *  \code
+ *  cc -O2 -DFREERTOS -Idmm/host -Idmm -I. -o dmm_sim \
+ *      dmm/host/dmm_sim.c dmm/host/dmm_host.c dmm/dmm_priority_prop_zigbee_zr.c -lm
+ *  ./dmm_sim -h
+ *  \endcode
+ *
+ *********************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+
+#include "dmm_host.h"
+#include "dmm_scheduler.h"
+#include "dmm_policy.h"
+#include "dmm_priority_prop_zigbee_zr.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+/* Stack indexes, in the order of the stack roles in zr_genericapp.syscfg */
+#define SIM_PROP_IDX            0
+#define SIM_ZB_IDX              1
+
+/* Application states */
+#define SIM_STATE_ANY           0xFFFFFFFF
+
+#define SIM_MAX_ACTIVITIES      16
+#define SIM_ZB_QUEUE_SIZE       8
+#define SIM_ZB_MAX_RETRIES      3
+#define SIM_ZB_TX_DEADLINE_MS   50
+#define SIM_PROP_RING_SIZE      8
+#define SIM_PROP_FS_US          200
+#define SIM_BLOCK_DELAY_MS      500
+
+/*********************************************************************
+ * MACROS
+ */
+#define GEN_ACTIVITY_TABLE(activity, priority)  (((activity) & 0xFFFF) << 16 | ((priority) & 0xFFFF))
+
+#define SIM_US_TO_TICKS(us)     ((uint64_t)(us) * RF_RAT_TICKS_PER_US)
+#define SIM_MS_TO_TICKS(ms)     ((uint64_t)(ms) * 1000 * RF_RAT_TICKS_PER_US)
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+/* Activities of the global priority table */
+typedef enum
+{
+    SimActivity_PropRxTx    = 0x0A01,
+    SimActivity_PropFs      = 0x0A02,
+    SimActivity_ZbLinkEst   = 0x0001,
+    SimActivity_ZbTxBeacon  = 0x0002,
+    SimActivity_ZbRxBeacon  = 0x0003,
+    SimActivity_ZbFh        = 0x0004,
+    SimActivity_ZbScan      = 0x0005,
+    SimActivity_ZbData      = 0x0006,
+    SimActivity_ZbRxOn      = 0x0007,
+} SimActivity_t;
+
+typedef struct
+{
+    uint32_t *pSamples;     // latencies in us
+    uint32_t count;
+    uint32_t size;
+} SimLatency_t;
+
+typedef struct
+{
+    uint8_t stackIdx;
+    uint32_t activityInfo;
+    uint16_t priority;
+    uint32_t queued;
+    uint32_t started;
+    uint32_t done;
+    uint32_t preempted;
+    uint32_t rejected;
+    uint32_t cancelled;
+    uint64_t airtime;
+    SimLatency_t latency;   // start time - requested start time
+} SimActivityStats_t;
+
+typedef struct
+{
+    double seconds;
+    uint64_t seed;
+    double zbTxRate;        // data frames per second
+    double zbRxRate;        // incoming frames per second
+    double beaconRate;      // beacon requests per second
+    double propRate;        // prop packets per second
+    uint32_t zbTxUs;
+    uint32_t zbRxUs;
+    uint32_t beaconUs;
+    uint32_t propPktUs;
+    uint32_t echoDelayMs;
+    uint8_t zbWeight;
+    uint8_t propWeight;
+    uint32_t zbApplied;
+    uint32_t propApplied;
+    uint32_t balancedMode;
+    bool blockZb;
+    bool propChained;
+    bool verbose;
+} SimConfig_t;
+
+typedef struct
+{
+    uint32_t activityInfo;
+    uint64_t queued;
+    uint8_t retries;
+} SimZbFrame_t;
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+static SimConfig_t simConfig =
+{
+    .seconds = 60.0,
+    .seed = 1,
+    .zbTxRate = 10.0,
+    .zbRxRate = 20.0,
+    .beaconRate = 0.2,
+    .propRate = 2.0,
+    .zbTxUs = 4000,
+    .zbRxUs = 2000,
+    .beaconUs = 1500,
+    .propPktUs = 6560,
+    .echoDelayMs = 100,
+    /* zr_genericapp.syscfg: Zigbee router weight 1, no applied activity */
+    .zbWeight = 1,
+    .propWeight = 0,
+    .zbApplied = DMMPOLICY_APPLIED_ACTIVITY_NONE,
+    .propApplied = DMMPOLICY_APPLIED_ACTIVITY_NONE,
+    .balancedMode = DMMPOLICY_BALANCED_NONE,
+    /* rfEchoRx.c blocks the Zigbee stack */
+    .blockZb = true,
+};
+
+static uint64_t simRandState;
+static bool simStopping;
+
+static SimActivityStats_t simStats[SIM_MAX_ACTIVITIES];
+static uint8_t simNumStats;
+static uint32_t simPreemptions[DMMPOLICY_NUM_STACKS];
+
+static DMMPolicy_Policy simPolicy[1];
+static DMMPolicy_Params simPolicyParams;
+
+/* Task handles only identify the clients */
+static uint8_t simZbTask;
+static uint8_t simPropTask;
+
+/* Zigbee router */
+static RF_Object zbRfObject;
+static RF_Handle zbRfHandle;
+static RF_Mode zbRfMode;
+static RF_RadioSetup zbRfSetup;
+static RF_Op zbRxOp;
+static RF_Op zbTxOp;
+static RF_CmdHandle zbRxHandle = RF_ALLOC_ERROR;
+static bool zbRxActive;
+static bool zbTxBusy;
+static SimZbFrame_t zbQueue[SIM_ZB_QUEUE_SIZE];
+static uint8_t zbQueueHead;
+static uint8_t zbQueueCount;
+static DMMSim_Timer zbTxGenTimer;
+static DMMSim_Timer zbBeaconGenTimer;
+static DMMSim_Timer zbRxGenTimer;
+static DMMSim_Timer zbRxEndTimer;
+static RF_CmdHandle zbRxHeardHandle;
+static uint32_t zbFramesOffered;
+static uint32_t zbFramesSent;
+static uint32_t zbFramesFailed;
+static uint32_t zbFramesDropped;
+static uint32_t zbRetries;
+static uint32_t zbRxHeard;
+static uint32_t zbRxMissed;
+static SimLatency_t zbTxLatency;        // queued until sent
+
+/* Prop echo */
+static RF_Object propRfObject;
+static RF_Handle propRfHandle;
+static RF_Mode propRfMode;
+static RF_RadioSetup propRfSetup;
+static RF_Op propFsOp;
+static RF_Op propRxOp;
+static RF_Op propTxOp;
+static RF_CmdHandle propRxHandle = RF_ALLOC_ERROR;
+static bool propFsDone;
+static bool propRxActive;
+static bool propEchoing;
+static uint64_t propRing[SIM_PROP_RING_SIZE];   // packet end times
+static uint8_t propRingHead;
+static uint8_t propRingCount;
+static DMMSim_Timer propRxGenTimer;
+static DMMSim_Timer propRxEndTimer;
+static DMMSim_Timer propEchoTimer;
+static RF_CmdHandle propRxHeardHandle;
+static uint32_t propRxHeard;
+static uint32_t propRxMissed;
+static uint32_t propRingOverflows;
+static uint32_t propEchoesSent;
+static uint32_t propEchoesFailed;
+static SimLatency_t propEchoLatency;    // packet end until echo end
+
+static DMMSim_Timer simBlockTimer;
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+static void zbRxStart(void);
+static void zbTxNext(void);
+static void propRxStart(void);
+static void propEchoNext(void);
+static void propChainedEcho(void);
+static void zbRxGenCb(void *arg);
+static void propRxGenCb(void *arg);
+
+/* xorshift64* */
+static double simRandom(void)
+{
+    simRandState ^= simRandState >> 12;
+    simRandState ^= simRandState << 25;
+    simRandState ^= simRandState >> 27;
+    return (double)((simRandState * 0x2545F4914F6CDD1DULL) >> 11) / 9007199254740992.0;
+}
+
+/* Exponentially distributed interval of a Poisson process, in ticks */
+static uint64_t simInterval(double ratePerSecond)
+{
+    return (uint64_t)(-log(1.0 - simRandom()) / ratePerSecond * 4000000.0) + 1;
+}
+
+static void simLatencyAdd(SimLatency_t *pLatency, uint64_t ticks)
+{
+    if (pLatency->count == pLatency->size)
+    {
+        pLatency->size = pLatency->size ? pLatency->size * 2 : 1024;
+        pLatency->pSamples = realloc(pLatency->pSamples, pLatency->size * sizeof(uint32_t));
+        if (pLatency->pSamples == NULL)
+        {
+            perror("realloc");
+            exit(1);
+        }
+    }
+    pLatency->pSamples[pLatency->count++] = (uint32_t)(ticks / RF_RAT_TICKS_PER_US);
+}
+
+static int simCompareU32(const void *pA, const void *pB)
+{
+    uint32_t a = *(const uint32_t *)pA;
+    uint32_t b = *(const uint32_t *)pB;
+
+    return (a > b) - (a < b);
+}
+
+/* Nearest-rank percentile of sorted samples */
+static uint32_t simPercentile(SimLatency_t *pLatency, double pct)
+{
+    uint32_t rank;
+
+    if (pLatency->count == 0)
+    {
+        return 0;
+    }
+    rank = (uint32_t)ceil(pct / 100.0 * pLatency->count);
+    return pLatency->pSamples[(rank > 0) ? rank - 1 : 0];
+}
+
+static const char *simActivityName(uint32_t activityInfo)
+{
+    switch (activityInfo >> 16)
+    {
+        case SimActivity_PropRxTx:   return "PROP_RX_TX";
+        case SimActivity_PropFs:     return "PROP_FS";
+        case SimActivity_ZbLinkEst:  return "ZB_LINK_EST";
+        case SimActivity_ZbTxBeacon: return "ZB_TX_BEACON";
+        case SimActivity_ZbRxBeacon: return "ZB_RX_BEACON";
+        case SimActivity_ZbFh:       return "ZB_FH";
+        case SimActivity_ZbScan:     return "ZB_SCAN";
+        case SimActivity_ZbData:     return "ZB_DATA";
+        case SimActivity_ZbRxOn:     return "ZB_RXON";
+        default:                     return "POSTED";
+    }
+}
+
+static const char *simLevelName(uint32_t activityInfo)
+{
+    switch (activityInfo & 0xFFFF)
+    {
+        case DMM_StackPNormal: return "Normal";
+        case DMM_StackPHigh:   return "High";
+        case DMM_StackPUrgent: return "Urgent";
+        default:               return "?";
+    }
+}
+
+static SimActivityStats_t *simFindStats(uint8_t stackIdx, uint32_t activityInfo)
+{
+    uint8_t i;
+
+    for (i = 0; i < simNumStats; i++)
+    {
+        if ((simStats[i].stackIdx == stackIdx) && (simStats[i].activityInfo == activityInfo))
+        {
+            return &simStats[i];
+        }
+    }
+    if (simNumStats == SIM_MAX_ACTIVITIES)
+    {
+        fprintf(stderr, "too many activities\n");
+        exit(1);
+    }
+
+    simStats[simNumStats].stackIdx = stackIdx;
+    simStats[simNumStats].activityInfo = activityInfo;
+    return &simStats[simNumStats++];
+}
+
+static void simTraceCb(DMMSim_CmdEvent event, const DMMSim_CmdInfo *pInfo)
+{
+    static const char * const eventNames[] = { "queued", "started", "done", "preempted", "rejected", "cancelled" };
+    SimActivityStats_t *pStats = simFindStats(pInfo->stackIdx, pInfo->activityInfo);
+
+    pStats->priority = pInfo->priority;
+
+    if (simConfig.verbose)
+    {
+        printf("%12.6f %-6s %-12s %-6s ch %5d prio %3u %s\n", DMMSim_now() / 4000000.0,
+               (pInfo->stackIdx == SIM_ZB_IDX) ? "zigbee" : "prop", simActivityName(pInfo->activityInfo),
+               simLevelName(pInfo->activityInfo), pInfo->ch, pInfo->priority, eventNames[event]);
+    }
+
+    switch (event)
+    {
+        case DMMSim_CmdQueued:
+            pStats->queued++;
+            break;
+        case DMMSim_CmdStarted:
+            pStats->started++;
+            simLatencyAdd(&pStats->latency, pInfo->started - pInfo->requested);
+            break;
+        case DMMSim_CmdDone:
+            pStats->done++;
+            break;
+        case DMMSim_CmdPreempted:
+            pStats->preempted++;
+            break;
+        case DMMSim_CmdRejected:
+            pStats->rejected++;
+            break;
+        case DMMSim_CmdCancelled:
+            pStats->cancelled++;
+            break;
+    }
+
+    if ((event != DMMSim_CmdStarted) && pInfo->ran)
+    {
+        pStats->airtime += DMMSim_now() - pInfo->started;
+    }
+}
+
+static void simPreemptionCb(DMMPolicy_StackRole stackRolePreempted)
+{
+    uint8_t i;
+
+    for (i = 0; i < DMMPOLICY_NUM_STACKS; i++)
+    {
+        if (simPolicyParams.policyTable.stackRole[i] == stackRolePreempted)
+        {
+            simPreemptions[i]++;
+        }
+    }
+}
+
+/*********************************************************************
+ * ZIGBEE ROUTER
+ */
+
+static void zbRxCb(RF_Handle h, RF_CmdHandle ch, RF_EventMask e)
+{
+    (void)h;
+    (void)e;
+
+    if (ch != zbRxHandle)
+    {
+        return;
+    }
+    zbRxActive = false;
+
+    /* The MAC turns the receiver back on unless it is transmitting */
+    zbRxStart();
+}
+
+static void zbRxStart(void)
+{
+    RF_ScheduleCmdParams schParams;
+
+    if (zbRxActive || zbTxBusy || simStopping)
+    {
+        return;
+    }
+
+    RF_ScheduleCmdParams_init(&schParams);
+    schParams.endType = RF_EndInfinit;
+    schParams.activityInfo = GEN_ACTIVITY_TABLE(SimActivity_ZbRxOn, DMM_StackPNormal);
+
+    zbRxHandle = DMMSch_rfScheduleCmd(zbRfHandle, &zbRxOp, &schParams, zbRxCb, RF_EventRxOk);
+    zbRxActive = (zbRxHandle >= 0);
+}
+
+static void zbTxCb(RF_Handle h, RF_CmdHandle ch, RF_EventMask e)
+{
+    SimZbFrame_t *pFrame = &zbQueue[zbQueueHead];
+
+    (void)h;
+    (void)ch;
+
+    if (simStopping)
+    {
+        return;
+    }
+
+    if (e & RF_EventLastCmdDone)
+    {
+        zbFramesSent++;
+        simLatencyAdd(&zbTxLatency, DMMSim_now() - pFrame->queued);
+    }
+    else if (++pFrame->retries <= SIM_ZB_MAX_RETRIES)
+    {
+        zbRetries++;
+        zbTxNext();
+        return;
+    }
+    else
+    {
+        zbFramesFailed++;
+    }
+
+    zbQueueHead = (zbQueueHead + 1) % SIM_ZB_QUEUE_SIZE;
+    zbQueueCount--;
+    zbTxNext();
+}
+
+/* Send the frame at the head of the MAC queue, or go back to RX */
+static void zbTxNext(void)
+{
+    while (zbQueueCount != 0)
+    {
+        SimZbFrame_t *pFrame = &zbQueue[zbQueueHead];
+        RF_ScheduleCmdParams schParams;
+        RF_CmdHandle ch;
+        uint64_t deadline = pFrame->queued + SIM_MS_TO_TICKS(SIM_ZB_TX_DEADLINE_MS);
+
+        zbTxBusy = true;
+        if (zbRxActive)
+        {
+            (void)DMMSch_rfCancelCmd(zbRfHandle, zbRxHandle, 1);
+        }
+
+        if (!simStopping && (DMMSim_now() < deadline))
+        {
+            RF_ScheduleCmdParams_init(&schParams);
+            schParams.duration = (uint32_t)SIM_US_TO_TICKS(
+                (pFrame->activityInfo >> 16 == SimActivity_ZbTxBeacon) ? simConfig.beaconUs : simConfig.zbTxUs);
+            schParams.endType = RF_EndAbs;
+            schParams.endTime = (uint32_t)deadline;
+            schParams.activityInfo = pFrame->activityInfo;
+
+            ch = DMMSch_rfScheduleCmd(zbRfHandle, &zbTxOp, &schParams, zbTxCb, RF_EventLastCmdDone);
+            if (ch >= 0)
+            {
+                return;
+            }
+        }
+
+        /* Could not be queued, e.g. the stack is blocked, or too late */
+        zbFramesFailed++;
+        zbQueueHead = (zbQueueHead + 1) % SIM_ZB_QUEUE_SIZE;
+        zbQueueCount--;
+    }
+
+    zbTxBusy = false;
+    zbRxStart();
+}
+
+static void zbQueueFrame(uint32_t activityInfo)
+{
+    SimZbFrame_t *pFrame;
+
+    zbFramesOffered++;
+    if (zbQueueCount == SIM_ZB_QUEUE_SIZE)
+    {
+        zbFramesDropped++;
+        return;
+    }
+
+    pFrame = &zbQueue[(zbQueueHead + zbQueueCount) % SIM_ZB_QUEUE_SIZE];
+    pFrame->activityInfo = activityInfo;
+    pFrame->queued = DMMSim_now();
+    pFrame->retries = 0;
+    zbQueueCount++;
+
+    if (!zbTxBusy)
+    {
+        zbTxNext();
+    }
+}
+
+static void zbTxGenCb(void *arg)
+{
+    (void)arg;
+
+    zbQueueFrame(GEN_ACTIVITY_TABLE(SimActivity_ZbData, DMM_StackPNormal));
+    DMMSim_setTimer(&zbTxGenTimer, DMMSim_now() + simInterval(simConfig.zbTxRate), zbTxGenCb, NULL);
+}
+
+static void zbBeaconGenCb(void *arg)
+{
+    (void)arg;
+
+    zbQueueFrame(GEN_ACTIVITY_TABLE(SimActivity_ZbTxBeacon, DMM_StackPNormal));
+    DMMSim_setTimer(&zbBeaconGenTimer, DMMSim_now() + simInterval(simConfig.beaconRate), zbBeaconGenCb, NULL);
+}
+
+/* End of an incoming frame: heard if the same RX command ran all along */
+static void zbRxEndCb(void *arg)
+{
+    (void)arg;
+
+    if ((zbRxHeardHandle >= 0) && DMMSim_isRunning(zbRfHandle, zbRxHeardHandle))
+    {
+        zbRxHeard++;
+    }
+    else
+    {
+        zbRxMissed++;
+    }
+
+    DMMSim_setTimer(&zbRxGenTimer, DMMSim_now() + simInterval(simConfig.zbRxRate), zbRxGenCb, NULL);
+}
+
+/* Start of an incoming frame */
+static void zbRxGenCb(void *arg)
+{
+    (void)arg;
+
+    zbRxHeardHandle = (zbRxActive && DMMSim_isRunning(zbRfHandle, zbRxHandle)) ? zbRxHandle : RF_ALLOC_ERROR;
+    DMMSim_setTimer(&zbRxEndTimer, DMMSim_now() + SIM_US_TO_TICKS(simConfig.zbRxUs), zbRxEndCb, NULL);
+}
+
+static void zbStart(void)
+{
+    RF_Params rfParams;
+
+    RF_Params_init(&rfParams);
+    DMMSim_setCurrentTask(&simZbTask);
+    zbRfHandle = DMMSch_rfOpen(&zbRfObject, &zbRfMode, &zbRfSetup, &rfParams);
+
+    (void)DMMPolicy_updateApplicationState(DMMPolicy_StackRole_ZigbeeRouter, SIM_STATE_ANY);
+
+    zbRxStart();
+    if (simConfig.zbTxRate > 0)
+    {
+        DMMSim_setTimer(&zbTxGenTimer, simInterval(simConfig.zbTxRate), zbTxGenCb, NULL);
+    }
+    if (simConfig.beaconRate > 0)
+    {
+        DMMSim_setTimer(&zbBeaconGenTimer, simInterval(simConfig.beaconRate), zbBeaconGenCb, NULL);
+    }
+    if (simConfig.zbRxRate > 0)
+    {
+        DMMSim_setTimer(&zbRxGenTimer, simInterval(simConfig.zbRxRate), zbRxGenCb, NULL);
+    }
+}
+
+/*********************************************************************
+ * PROP ECHO
+ */
+
+static void propRxCb(RF_Handle h, RF_CmdHandle ch, RF_EventMask e)
+{
+    (void)h;
+    (void)e;
+
+    if (ch != propRxHandle)
+    {
+        return;
+    }
+    propRxActive = false;
+
+    /* RX is resumed unless it was stopped for an echo burst */
+    propRxStart();
+}
+
+static void propRxStart(void)
+{
+    RF_ScheduleCmdParams schParams;
+
+    if (propRxActive || propEchoing || !propFsDone || simStopping)
+    {
+        return;
+    }
+
+    /* Schedule parameters of echoContinuous() */
+    RF_ScheduleCmdParams_init(&schParams);
+    schParams.duration = ~(0);
+    schParams.endTime = ~(0);
+    schParams.activityInfo = GEN_ACTIVITY_TABLE(SimActivity_PropRxTx, DMM_StackPNormal);
+
+    propRxHandle = DMMSch_rfScheduleCmd(propRfHandle, &propRxOp, &schParams, propRxCb, RF_EventRxEntryDone);
+    propRxActive = (propRxHandle >= 0);
+}
+
+static void propEchoCb(RF_Handle h, RF_CmdHandle ch, RF_EventMask e)
+{
+    (void)h;
+    (void)ch;
+
+    if (simStopping)
+    {
+        return;
+    }
+
+    if (e & RF_EventLastCmdDone)
+    {
+        propEchoesSent++;
+        simLatencyAdd(&propEchoLatency, DMMSim_now() - propRing[propRingHead]);
+    }
+    else
+    {
+        propEchoesFailed++;
+    }
+
+    /* The entry is handed back to the RF core either way */
+    propRingHead = (propRingHead + 1) % SIM_PROP_RING_SIZE;
+    propRingCount--;
+    propEchoNext();
+}
+
+/* Echo the oldest packet of the ring, or resume RX */
+static void propEchoNext(void)
+{
+    while (propRingCount != 0)
+    {
+        RF_ScheduleCmdParams schParams;
+
+        /*
+         * echoContinuous() sends with the RX schedule parameters, the TX ends
+         * on its own after the packet. The host needs its air time instead.
+         */
+        RF_ScheduleCmdParams_init(&schParams);
+        schParams.duration = (uint32_t)SIM_US_TO_TICKS(simConfig.propPktUs);
+        schParams.activityInfo = GEN_ACTIVITY_TABLE(SimActivity_PropRxTx, DMM_StackPNormal);
+
+        if (!simStopping &&
+            (DMMSch_rfScheduleCmd(propRfHandle, &propTxOp, &schParams, propEchoCb, RF_EventLastCmdDone) >= 0))
+        {
+            return;
+        }
+
+        propEchoesFailed++;
+        propRingHead = (propRingHead + 1) % SIM_PROP_RING_SIZE;
+        propRingCount--;
+    }
+
+    propEchoing = false;
+    propRxStart();
+}
+
+static void propEchoTimerCb(void *arg)
+{
+    (void)arg;
+
+    /* Stop RX gracefully and echo every packet in the ring */
+    propEchoing = true;
+    if (propRxActive)
+    {
+        (void)DMMSch_rfCancelCmd(propRfHandle, propRxHandle, 1);
+    }
+    propEchoNext();
+}
+
+/*
+ * Chained RX->TX: the RX command ends with the packet and the TX command
+ * waits TX_DELAY before sending it back, holding the radio all along.
+ */
+static void propChainedEchoCb(RF_Handle h, RF_CmdHandle ch, RF_EventMask e)
+{
+    (void)h;
+    (void)ch;
+
+    if (simStopping)
+    {
+        return;
+    }
+
+    if (e & RF_EventLastCmdDone)
+    {
+        propEchoesSent++;
+        simLatencyAdd(&propEchoLatency, DMMSim_now() - propRing[propRingHead]);
+    }
+    else
+    {
+        propEchoesFailed++;
+    }
+    propRingCount = 0;
+    propEchoing = false;
+    propRxStart();
+}
+
+static void propChainedEcho(void)
+{
+    RF_ScheduleCmdParams schParams;
+
+    propEchoing = true;
+    propRingHead = 0;
+    propRing[0] = DMMSim_now();
+    propRingCount = 1;
+    (void)DMMSch_rfCancelCmd(propRfHandle, propRxHandle, 1);
+
+    RF_ScheduleCmdParams_init(&schParams);
+    schParams.duration = (uint32_t)SIM_US_TO_TICKS(simConfig.echoDelayMs * 1000 + simConfig.propPktUs);
+    schParams.activityInfo = GEN_ACTIVITY_TABLE(SimActivity_PropRxTx, DMM_StackPNormal);
+    if (DMMSch_rfScheduleCmd(propRfHandle, &propTxOp, &schParams, propChainedEchoCb, RF_EventLastCmdDone) < 0)
+    {
+        propEchoesFailed++;
+        propRingCount = 0;
+        propEchoing = false;
+        propRxStart();
+    }
+}
+
+/* End of an incoming packet: heard if the same RX command ran all along */
+static void propRxEndCb(void *arg)
+{
+    (void)arg;
+
+    if ((propRxHeardHandle >= 0) && DMMSim_isRunning(propRfHandle, propRxHeardHandle))
+    {
+        propRxHeard++;
+        if (simConfig.propChained)
+        {
+            propChainedEcho();
+        }
+        else if (propRingCount == SIM_PROP_RING_SIZE)
+        {
+            propRingOverflows++;
+        }
+        else
+        {
+            propRing[(propRingHead + propRingCount) % SIM_PROP_RING_SIZE] = DMMSim_now();
+            propRingCount++;
+
+            if ((propRingCount == 1) && !propEchoing)
+            {
+                DMMSim_setTimer(&propEchoTimer, DMMSim_now() + SIM_MS_TO_TICKS(simConfig.echoDelayMs),
+                                propEchoTimerCb, NULL);
+            }
+        }
+    }
+    else
+    {
+        propRxMissed++;
+    }
+
+    DMMSim_setTimer(&propRxGenTimer, DMMSim_now() + simInterval(simConfig.propRate), propRxGenCb, NULL);
+}
+
+/* Start of an incoming packet */
+static void propRxGenCb(void *arg)
+{
+    (void)arg;
+
+    propRxHeardHandle = (propRxActive && DMMSim_isRunning(propRfHandle, propRxHandle)) ? propRxHandle : RF_ALLOC_ERROR;
+    DMMSim_setTimer(&propRxEndTimer, DMMSim_now() + SIM_US_TO_TICKS(simConfig.propPktUs), propRxEndCb, NULL);
+}
+
+static void propFsCb(RF_Handle h, RF_CmdHandle ch, RF_EventMask e)
+{
+    (void)h;
+    (void)ch;
+    (void)e;
+
+    propFsDone = true;
+    propRxStart();
+}
+
+static void propStart(void)
+{
+    RF_Params rfParams;
+    RF_ScheduleCmdParams schParams;
+
+    RF_Params_init(&rfParams);
+    rfParams.nID = RF_STACK_ID_CUSTOM;
+    DMMSim_setCurrentTask(&simPropTask);
+    propRfHandle = DMMSch_rfOpen(&propRfObject, &propRfMode, &propRfSetup, &rfParams);
+
+    (void)DMMPolicy_updateApplicationState(DMMPolicy_StackRole_custom1, SIM_STATE_ANY);
+
+    RF_ScheduleCmdParams_init(&schParams);
+    schParams.duration = (uint32_t)SIM_US_TO_TICKS(SIM_PROP_FS_US);
+    schParams.activityInfo = GEN_ACTIVITY_TABLE(SimActivity_PropFs, DMM_StackPNormal);
+    (void)DMMSch_rfScheduleCmd(propRfHandle, &propFsOp, &schParams, propFsCb, RF_EventLastCmdDone);
+
+    if (simConfig.propRate > 0)
+    {
+        DMMSim_setTimer(&propRxGenTimer, simInterval(simConfig.propRate), propRxGenCb, NULL);
+    }
+}
+
+/* rfEchoRx.c blocks the Zigbee stack 500 ms after it starts */
+static void simBlockCb(void *arg)
+{
+    (void)arg;
+
+    (void)DMMPolicy_setBlockModeOn(DMMPolicy_StackRole_ZigbeeRouter);
+}
+
+/*********************************************************************
+ * REPORT
+ */
+
+static void simPrintLatency(const char *pName, SimLatency_t *pLatency)
+{
+    qsort(pLatency->pSamples, pLatency->count, sizeof(uint32_t), simCompareU32);
+    printf("  %-28s n %7u  p50 %8u  p90 %8u  p99 %8u  max %8u us\n", pName, pLatency->count,
+           simPercentile(pLatency, 50), simPercentile(pLatency, 90), simPercentile(pLatency, 99),
+           simPercentile(pLatency, 100));
+}
+
+static void simReport(uint64_t simTicks)
+{
+    uint64_t stackAir[DMMPOLICY_NUM_STACKS] = { 0 };
+    uint64_t busy = 0;
+    double seconds = simTicks / 4000000.0;
+    /* Packets still in the ring or on the air at the end are not counted */
+    uint32_t propOffered = propRxHeard + propRxMissed - propRingCount;
+    uint8_t s;
+    uint8_t i;
+
+    printf("DMM host simulation: %.3f s, seed %llu\n", simTicks / 4000000.0, (unsigned long long)simConfig.seed);
+    printf("policy: prop weight %u applied 0x%04X, zigbee weight %u applied 0x%04X, balancedMode 0x%08X%s\n\n",
+           simConfig.propWeight, simConfig.propApplied, simConfig.zbWeight, simConfig.zbApplied,
+           simConfig.balancedMode, simConfig.blockZb ? ", zigbee blocked after 500 ms" : "");
+
+    printf("%-6s %-12s %-6s %4s %8s %8s %8s %8s %8s %7s %8s %8s %8s %8s\n", "stack", "activity", "level",
+           "prio", "queued", "started", "preempt", "reject", "cancel", "air%", "p50us", "p90us", "p99us", "maxus");
+
+    for (s = 0; s < DMMPOLICY_NUM_STACKS; s++)
+    {
+        for (i = 0; i < simNumStats; i++)
+        {
+            SimActivityStats_t *pStats = &simStats[i];
+
+            if (pStats->stackIdx != s)
+            {
+                continue;
+            }
+
+            qsort(pStats->latency.pSamples, pStats->latency.count, sizeof(uint32_t), simCompareU32);
+            printf("%-6s %-12s %-6s %4u %8u %8u %8u %8u %8u %6.2f%% %8u %8u %8u %8u\n",
+                   (s == SIM_ZB_IDX) ? "zigbee" : "prop", simActivityName(pStats->activityInfo),
+                   simLevelName(pStats->activityInfo), pStats->priority, pStats->queued, pStats->started,
+                   pStats->preempted, pStats->rejected, pStats->cancelled,
+                   100.0 * pStats->airtime / simTicks, simPercentile(&pStats->latency, 50),
+                   simPercentile(&pStats->latency, 90), simPercentile(&pStats->latency, 99),
+                   simPercentile(&pStats->latency, 100));
+            stackAir[s] += pStats->airtime;
+        }
+    }
+
+    printf("\nairtime share:");
+    for (s = 0; s < DMMPOLICY_NUM_STACKS; s++)
+    {
+        printf(" %s %.2f%%", (s == SIM_ZB_IDX) ? "zigbee" : "prop", 100.0 * stackAir[s] / simTicks);
+        busy += stackAir[s];
+    }
+    printf(", idle %.2f%%\n", 100.0 * (simTicks - busy) / simTicks);
+    for (s = 0; s < DMMPOLICY_NUM_STACKS; s++)
+    {
+        /* Below 0.1%, e.g. only the prop FS command at the start */
+        if (stackAir[s] * 1000 < simTicks)
+        {
+            printf("warning: %s got almost no airtime, its commands rank below the %s commands always queued%s\n",
+                   (s == SIM_ZB_IDX) ? "zigbee" : "prop", (s == SIM_ZB_IDX) ? "prop" : "zigbee",
+                   simConfig.blockZb ? "" : " (run without -U to block zigbee like rfEchoRx.c)");
+        }
+    }
+    printf("preemptions:   prop %u, zigbee %u\n\n", simPreemptions[SIM_PROP_IDX], simPreemptions[SIM_ZB_IDX]);
+
+    printf("zigbee router:\n");
+    printf("  tx frames offered %u, sent %u, failed %u, queue full %u, retries %u\n",
+           zbFramesOffered, zbFramesSent, zbFramesFailed, zbFramesDropped, zbRetries);
+    printf("  rx frames heard %u, missed %u\n", zbRxHeard, zbRxMissed);
+    simPrintLatency("tx queued to sent", &zbTxLatency);
+
+    printf("prop echo:\n");
+    printf("  rx packets heard %u, missed %u, ring full %u\n", propRxHeard, propRxMissed, propRingOverflows);
+    printf("  echoes sent %u, failed %u\n", propEchoesSent, propEchoesFailed);
+    printf("  %s echo: %.2f packets/s offered, %.2f echoed/s, loss %.1f%%\n",
+           simConfig.propChained ? "chained" : "continuous", propOffered / seconds, propEchoesSent / seconds,
+           propOffered ? 100.0 * (propOffered - propEchoesSent) / propOffered : 0.0);
+    simPrintLatency("packet end to echo end", &propEchoLatency);
+}
+
+static void simUsage(const char *pName)
+{
+    printf("usage: %s [options]\n"
+           "  -t sec     simulated time (%.0f)\n"
+           "  -s seed    random seed (%llu)\n"
+           "  -z rate    zigbee data frames sent per second (%.1f)\n"
+           "  -r rate    zigbee frames received per second (%.1f)\n"
+           "  -e rate    zigbee beacon requests per second (%.1f)\n"
+           "  -p rate    prop packets received per second (%.1f)\n"
+           "  -d ms      prop echo delay (%u)\n"
+           "  -w weight  zigbee policy weight (%u)\n"
+           "  -W weight  prop policy weight (%u)\n"
+           "  -a mask    zigbee applied activities, hex (0x%X)\n"
+           "  -A mask    prop applied activities, hex (0x%X)\n"
+           "  -b mode    balancedMode, hex (0x%X)\n"
+           "  -B         block zigbee after 500 ms, like rfEchoRx.c (default)\n"
+           "  -U         do not block zigbee, the priority table alone decides\n"
+           "  -c         chained RX->TX prop echo, rfEchoRx.c without ECHO_CONTINUOUS_RX\n"
+           "  -v         trace every command\n",
+           pName, simConfig.seconds, (unsigned long long)simConfig.seed, simConfig.zbTxRate, simConfig.zbRxRate,
+           simConfig.beaconRate, simConfig.propRate, simConfig.echoDelayMs, simConfig.zbWeight,
+           simConfig.propWeight, simConfig.zbApplied, simConfig.propApplied, simConfig.balancedMode);
+}
+
+/*********************************************************************
+ * MAIN
+ */
+
+int main(int argc, char *argv[])
+{
+    DMMSch_Params schParams;
+    uint64_t simTicks;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "t:s:z:r:e:p:d:w:W:a:A:b:BUcvh")) != -1)
+    {
+        switch (opt)
+        {
+            case 't': simConfig.seconds = atof(optarg); break;
+            case 's': simConfig.seed = strtoull(optarg, NULL, 0); break;
+            case 'z': simConfig.zbTxRate = atof(optarg); break;
+            case 'r': simConfig.zbRxRate = atof(optarg); break;
+            case 'e': simConfig.beaconRate = atof(optarg); break;
+            case 'p': simConfig.propRate = atof(optarg); break;
+            case 'd': simConfig.echoDelayMs = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'w': simConfig.zbWeight = (uint8_t)strtoul(optarg, NULL, 0); break;
+            case 'W': simConfig.propWeight = (uint8_t)strtoul(optarg, NULL, 0); break;
+            case 'a': simConfig.zbApplied = (uint32_t)strtoul(optarg, NULL, 16); break;
+            case 'A': simConfig.propApplied = (uint32_t)strtoul(optarg, NULL, 16); break;
+            case 'b': simConfig.balancedMode = (uint32_t)strtoul(optarg, NULL, 16); break;
+            case 'B': simConfig.blockZb = true; break;
+            case 'U': simConfig.blockZb = false; break;
+            case 'c': simConfig.propChained = true; break;
+            case 'v': simConfig.verbose = true; break;
+            default:
+                simUsage(argv[0]);
+                return (opt == 'h') ? 0 : 1;
+        }
+    }
+
+    simRandState = simConfig.seed ? simConfig.seed : 1;
+    simTicks = (uint64_t)(simConfig.seconds * 4000000.0);
+
+    /* The policy of zr_genericapp.syscfg, with the weights and balanced mode from the command line */
+    simPolicy[0].appState[SIM_PROP_IDX].state = SIM_STATE_ANY;
+    simPolicy[0].appState[SIM_PROP_IDX].weight = simConfig.propWeight;
+    simPolicy[0].appState[SIM_PROP_IDX].timingConstraint = DMMPOLICY_TIME_RESERVED;
+    simPolicy[0].appState[SIM_PROP_IDX].pause = DMMPOLICY_NOT_PAUSED;
+    simPolicy[0].appState[SIM_PROP_IDX].appliedActivity = simConfig.propApplied;
+    simPolicy[0].appState[SIM_ZB_IDX].state = SIM_STATE_ANY;
+    simPolicy[0].appState[SIM_ZB_IDX].weight = simConfig.zbWeight;
+    simPolicy[0].appState[SIM_ZB_IDX].timingConstraint = DMMPOLICY_TIME_RESERVED;
+    simPolicy[0].appState[SIM_ZB_IDX].pause = DMMPOLICY_NOT_PAUSED;
+    simPolicy[0].appState[SIM_ZB_IDX].appliedActivity = simConfig.zbApplied;
+    simPolicy[0].balancedMode = simConfig.balancedMode;
+
+    /* Same sequence as main.c */
+    DMMPolicy_init();
+    DMMPolicy_Params_init(&simPolicyParams);
+    simPolicyParams.policyTable.stackRole[SIM_PROP_IDX] = DMMPolicy_StackRole_custom1;
+    simPolicyParams.policyTable.stackRole[SIM_ZB_IDX] = DMMPolicy_StackRole_ZigbeeRouter;
+    simPolicyParams.policyTable.policy = simPolicy;
+    simPolicyParams.numPolicyTableEntries = sizeof(simPolicy) / sizeof(simPolicy[0]);
+    simPolicyParams.globalPriorityTable = globalPriorityTable_propLzigbeeZrH;
+    if (DMMPolicy_open(&simPolicyParams) != DMMPolicy_StatusSuccess)
+    {
+        fprintf(stderr, "DMMPolicy_open failed\n");
+        return 1;
+    }
+
+    DMMSch_init();
+    DMMSch_Params_init(&schParams);
+    memcpy(schParams.stackRoles, simPolicyParams.policyTable.stackRole, sizeof(DMMPolicy_StackRole) * DMMPOLICY_NUM_STACKS);
+    DMMSch_open(&schParams);
+    DMMSch_registerClient(&simZbTask, DMMPolicy_StackRole_ZigbeeRouter);
+    DMMSch_registerClient(&simPropTask, DMMPolicy_StackRole_custom1);
+    DMMSch_registerPreemptionCb(simPreemptionCb);
+    DMMSim_registerTraceCb(simTraceCb);
+
+    zbStart();
+    propStart();
+    if ((zbRfHandle == NULL) || (propRfHandle == NULL))
+    {
+        fprintf(stderr, "DMMSch_rfOpen failed\n");
+        return 1;
+    }
+    if (simConfig.blockZb)
+    {
+        DMMSim_setTimer(&simBlockTimer, SIM_MS_TO_TICKS(SIM_BLOCK_DELAY_MS), simBlockCb, NULL);
+    }
+
+    DMMSim_run(simTicks);
+
+    /* Stop everything so that the running commands are accounted for */
+    simStopping = true;
+    (void)DMMSch_rfFlushCmd(zbRfHandle, RF_CMDHANDLE_FLUSH_ALL, 0);
+    (void)DMMSch_rfFlushCmd(propRfHandle, RF_CMDHANDLE_FLUSH_ALL, 0);
+
+    simReport(simTicks);
+
+    return 0;
+}
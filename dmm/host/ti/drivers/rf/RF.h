@@ -0,0 +1,265 @@
+/******************************************************************************
+
+ @file RF.h
+
+ @brief Host stand-in of the RF driver interface
+
+ Group: WCS LPC
+ Target Device: cc13xx_cc26xx
+
+ ******************************************************************************
+ 
+ Copyright (c) 2022, Texas Instruments Incorporated
+
+ All rights reserved not granted herein.
+ Limited License.
+
+ Texas Instruments Incorporated grants a world-wide, royalty-free,
+ non-exclusive license under copyrights and patents it now or hereafter
+ owns or controls to make, have made, use, import, offer to sell and sell
+ ("Utilize") this software subject to the terms herein. With respect to the
+ foregoing patent license, such license is granted solely to the extent that
+ any such patent is necessary to Utilize the software alone. The patent
+ license shall not apply to any combinations which include this software,
+ other than combinations with devices manufactured by or for TI ("TI
+ Devices"). No hardware patent is licensed hereunder.
+
+ Redistributions must preserve existing copyright notices and reproduce
+ this license (including the above copyright notice and the disclaimer and
+ (if applicable) source code license limitations below) in the documentation
+ and/or other materials provided with the distribution.
+
+ Redistribution and use in binary form, without modification, are permitted
+ provided that the following conditions are met:
+
+   * No reverse engineering, decompilation, or disassembly of this software
+     is permitted with respect to any software provided in binary form.
+   * Any redistribution and use are licensed by TI for use only with TI Devices.
+   * Nothing shall obligate TI to provide you with source code for the software
+     licensed and provided to you in object code.
+
+ If software source code is provided to you, modification and redistribution
+ of the source code are permitted provided that the following conditions are
+ met:
+
+   * Any redistribution and use of the source code, including any resulting
+     derivative works, are licensed by TI for use only with TI Devices.
+   * Any redistribution and use of any object code compiled from the source
+     code and any resulting derivative works, are licensed by TI for use
+     only with TI Devices.
+
+ Neither the name of Texas Instruments Incorporated nor the names of its
+ suppliers may be used to endorse or promote products derived from this
+ software without specific prior written permission.
+
+ DISCLAIMER.
+
+ THIS SOFTWARE IS PROVIDED BY TI AND TI'S LICENSORS "AS IS" AND ANY EXPRESS
+ OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ IN NO EVENT SHALL TI AND TI'S LICENSORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ 
+ 
+ *****************************************************************************/
+/*!****************************************************************************
+ *  @file  RF.h
+ *
+ *  @brief      Host stand-in of the RF driver interface
+ *
+ *  Only the types, constants and functions the DMM headers and the DMM host
+ *  simulator use are provided. Radio operations are not executed: the host
+ *  scheduler (dmm_host.c) places them on a virtual radio timeline that runs
+ *  on 4 MHz radio timer (RAT) ticks, like the target radio timer.
+ *
+ *  An operation runs for RF_ScheduleCmdParams.duration ticks. A duration of
+ *  0 or ~0 (or RF_EndInfinit) keeps the operation running, like an RX command,
+ *  until it is cancelled or preempted. Operations posted without schedule
+ *  parameters run for DMMSIM_POST_CMD_DURATION ticks.
+ *
+ *  Event bit values are those of the host stand-in only.
+ *
+ *********************************************************************************/
+
+#ifndef ti_drivers_rf_RF_H_
+#define ti_drivers_rf_RF_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*!
+ * @brief Radio timer (RAT) ticks per microsecond
+ */
+#define RF_RAT_TICKS_PER_US            4U
+
+#define RF_convertUsToRatTicks(us)     ((uint32_t)(us) * RF_RAT_TICKS_PER_US)        ///< microseconds to RAT ticks
+#define RF_convertMsToRatTicks(ms)     ((uint32_t)(ms) * 1000U * RF_RAT_TICKS_PER_US) ///< milliseconds to RAT ticks
+#define RF_convertRatTicksToUs(ticks)  ((uint32_t)(ticks) / RF_RAT_TICKS_PER_US)      ///< RAT ticks to microseconds
+
+/**
+ *  @name RF Events
+ *  @anchor RF_Core_Events
+ *
+ *  Events reported to the command callback
+ *  @{
+ */
+#define RF_EventCmdDone         ((RF_EventMask)1 << 0)    ///< A radio operation command in a chain finished
+#define RF_EventLastCmdDone     ((RF_EventMask)1 << 1)    ///< The last radio operation command in a chain finished
+#define RF_EventTxDone          ((RF_EventMask)1 << 4)    ///< Packet transmitted
+#define RF_EventRxOk            ((RF_EventMask)1 << 16)   ///< Packet received with CRC OK
+#define RF_EventRxEntryDone     ((RF_EventMask)1 << 23)   ///< Current data entry of the RX queue is finished
+#define RF_EventCmdAborted      ((RF_EventMask)1 << 56)   ///< Command was aborted by RF_cancelCmd()/RF_flushCmd()
+#define RF_EventCmdStopped      ((RF_EventMask)1 << 57)   ///< Command was stopped gracefully by RF_cancelCmd()/RF_flushCmd()
+#define RF_EventCmdCancelled    ((RF_EventMask)1 << 60)   ///< Command was cancelled before it started
+#define RF_EventCmdPreempted    ((RF_EventMask)1 << 62)   ///< Command was preempted by a command of higher priority
+/** @} */
+
+#define RF_ALLOC_ERROR          ((RF_CmdHandle)-2)        ///< No command could be allocated
+#define RF_SCHEDULE_CMD_ERROR   ((RF_CmdHandle)-3)        ///< The command could not be scheduled
+#define RF_CMDHANDLE_FLUSH_ALL  ((RF_CmdHandle)-1)        ///< RF_flushCmd() all commands of the client
+
+/*!
+ * @brief Trigger types of RF_Op.startTrigger
+ */
+#define TRIG_NOW                0       ///< Start immediately
+#define TRIG_ABSTIME            2       ///< Start at RF_Op.startTime
+#define TRIG_REL_PREVEND        7       ///< Start RF_Op.startTime after the previous command ended
+
+typedef uint64_t RF_EventMask;          ///< Bitmask of RF events
+typedef int16_t  RF_CmdHandle;          ///< Handle of a posted or scheduled command
+typedef uint32_t ratmr_t;               ///< Radio timer value
+
+/** @brief Common header of all radio operation commands */
+typedef struct RF_Op_s {
+    uint16_t commandNo;                 ///< Command ID
+    uint16_t status;                    ///< Status of the command
+    struct RF_Op_s *pNextOp;            ///< Next operation in the chain
+    ratmr_t startTime;                  ///< Absolute or relative start time
+    struct {
+        uint8_t triggerType:4;          ///< Start trigger, TRIG_*
+        uint8_t bEnaCmd:1;
+        uint8_t triggerNo:2;
+        uint8_t pastTrig:1;
+    } startTrigger;
+    struct {
+        uint8_t rule:4;                 ///< Condition for running the next command
+        uint8_t nSkip:4;
+    } condition;
+} RF_Op;
+
+/** @brief Radio mode, opaque to the host */
+typedef struct {
+    uint8_t rfMode;                     ///< PHY of the client
+} RF_Mode;
+
+/** @brief Radio setup command */
+typedef union {
+    RF_Op commonOp;                     ///< Common command header
+} RF_RadioSetup;
+
+/** @brief Priority of a command posted without schedule parameters */
+typedef enum {
+    RF_PriorityNormal  = 0,             ///< Normal priority
+    RF_PriorityHigh    = 1,             ///< High priority
+    RF_PriorityHighest = 2,             ///< Highest priority
+} RF_Priority;
+
+/** @brief Status codes of the RF functions */
+typedef enum {
+    RF_StatBusyError,                   ///< Another client owns the radio
+    RF_StatRadioInactiveError,          ///< The radio is not running a command of the client
+    RF_StatCmdDoneError,                ///< The command terminated with an error
+    RF_StatInvalidParamsError,          ///< Invalid parameters
+    RF_StatCmdEnded,                    ///< The command already terminated
+    RF_StatError = 0x80,                ///< General error
+    RF_StatCmdDoneSuccess,              ///< The command completed
+    RF_StatCmdSch,                      ///< The command was scheduled
+    RF_StatSuccess                      ///< Function finished with success
+} RF_Stat;
+
+/** @brief How the start time of a scheduled command is given */
+typedef enum {
+    RF_StartNotSpecified = 0,           ///< Start as soon as possible
+    RF_StartAbs          = 1,           ///< Start at RF_ScheduleCmdParams.startTime
+} RF_StartType;
+
+/** @brief How the end time of a scheduled command is given */
+typedef enum {
+    RF_EndNotSpecified = 0,             ///< Run for RF_ScheduleCmdParams.duration
+    RF_EndAbs          = 1,             ///< Must have finished by RF_ScheduleCmdParams.endTime
+    RF_EndRel          = 2,             ///< Must have finished endTime ticks after its start time
+    RF_EndInfinit      = 3,             ///< Run until cancelled or preempted
+} RF_EndType;
+
+/** @brief Whether a scheduled command may start later than its start time */
+typedef enum {
+    RF_AllowDelayNone = 0,              ///< Start exactly at the start time or not at all
+    RF_AllowDelayAny  = 0xFFFFFFFFU,    ///< Start whenever the radio is free
+} RF_AllowDelay;
+
+/** @brief Schedule parameters of RF_scheduleCmd() */
+typedef struct {
+    uint32_t      startTime;            ///< Start time in RAT ticks
+    RF_StartType  startType;            ///< How startTime is given
+    uint32_t      allowDelay;           ///< RF_AllowDelay
+    uint32_t      endTime;              ///< End time in RAT ticks
+    RF_EndType    endType;              ///< How endTime is given
+    uint32_t      duration;             ///< Expected duration in RAT ticks, 0 = until cancelled
+    uint32_t      activityInfo;         ///< DMM activity and priority level
+} RF_ScheduleCmdParams;
+
+/** @brief Parameters of RF_requestAccess() */
+typedef struct {
+    uint32_t    duration;               ///< Access duration in RAT ticks
+    RF_Priority priority;               ///< Access priority
+} RF_AccessParams;
+
+/** @brief Client parameters of RF_open() */
+typedef struct {
+    uint32_t nInactivityTimeout;        ///< Unused by the host
+    uint32_t nPowerUpDuration;          ///< Unused by the host
+    uint32_t nID;                       ///< Client identifier
+} RF_Params;
+
+/** @brief Client object of RF_open() */
+typedef struct {
+    RF_Params      params;              ///< Client parameters
+    RF_Mode       *pRfMode;             ///< Radio mode of the client
+    RF_RadioSetup *pOpSetup;            ///< Radio setup command of the client
+    uint8_t        stackIdx;            ///< Index of the client in the DMM policy tables
+} RF_Object;
+
+typedef RF_Object *RF_Handle;           ///< Client handle
+
+/** @brief Command callback */
+typedef void (*RF_Callback)(RF_Handle h, RF_CmdHandle ch, RF_EventMask e);
+
+#define RF_STACK_ID_CUSTOM      0x00000000U     ///< Client ID of a custom stack
+
+/** @brief  Initialize the client parameters to their defaults */
+extern void RF_Params_init(RF_Params *params);
+
+/** @brief  Initialize the schedule parameters to their defaults */
+extern void RF_ScheduleCmdParams_init(RF_ScheduleCmdParams *pSchParams);
+
+/** @brief  Get the virtual radio timer
+ *  @return current time in RAT ticks
+ */
+extern uint32_t RF_getCurrentTime(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ti_drivers_rf_RF_H_ */
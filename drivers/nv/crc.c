@@ -12,6 +12,8 @@
  *  - XorOut        = 0x00
  *  - ReflectOut    = False
  *  - Algorithm     = table-driven
+ *
+ * crc_update() was extended to slice-by-4 with the derived tables below.
  */
 #include "crc.h"     /* include the header file generated with pycrc */
 #include <stdlib.h>
@@ -41,12 +43,87 @@ static const crc_t crc_table[256] = {
     0xaa, 0x3d, 0x13, 0x84, 0x4f, 0xd8, 0xf6, 0x61, 0xf7, 0x60, 0x4e, 0xd9, 0x12, 0x85, 0xab, 0x3c
 };
 
+/**
+ * CRC of a byte followed by one zero byte, crc_table[crc_table[i]].
+ */
+static const crc_t crc_table_1[256] = {
+    0x00, 0xd3, 0x31, 0xe2, 0x62, 0xb1, 0x53, 0x80, 0xc4, 0x17, 0xf5, 0x26, 0xa6, 0x75, 0x97, 0x44,
+    0x1f, 0xcc, 0x2e, 0xfd, 0x7d, 0xae, 0x4c, 0x9f, 0xdb, 0x08, 0xea, 0x39, 0xb9, 0x6a, 0x88, 0x5b,
+    0x3e, 0xed, 0x0f, 0xdc, 0x5c, 0x8f, 0x6d, 0xbe, 0xfa, 0x29, 0xcb, 0x18, 0x98, 0x4b, 0xa9, 0x7a,
+    0x21, 0xf2, 0x10, 0xc3, 0x43, 0x90, 0x72, 0xa1, 0xe5, 0x36, 0xd4, 0x07, 0x87, 0x54, 0xb6, 0x65,
+    0x7c, 0xaf, 0x4d, 0x9e, 0x1e, 0xcd, 0x2f, 0xfc, 0xb8, 0x6b, 0x89, 0x5a, 0xda, 0x09, 0xeb, 0x38,
+    0x63, 0xb0, 0x52, 0x81, 0x01, 0xd2, 0x30, 0xe3, 0xa7, 0x74, 0x96, 0x45, 0xc5, 0x16, 0xf4, 0x27,
+    0x42, 0x91, 0x73, 0xa0, 0x20, 0xf3, 0x11, 0xc2, 0x86, 0x55, 0xb7, 0x64, 0xe4, 0x37, 0xd5, 0x06,
+    0x5d, 0x8e, 0x6c, 0xbf, 0x3f, 0xec, 0x0e, 0xdd, 0x99, 0x4a, 0xa8, 0x7b, 0xfb, 0x28, 0xca, 0x19,
+    0xf8, 0x2b, 0xc9, 0x1a, 0x9a, 0x49, 0xab, 0x78, 0x3c, 0xef, 0x0d, 0xde, 0x5e, 0x8d, 0x6f, 0xbc,
+    0xe7, 0x34, 0xd6, 0x05, 0x85, 0x56, 0xb4, 0x67, 0x23, 0xf0, 0x12, 0xc1, 0x41, 0x92, 0x70, 0xa3,
+    0xc6, 0x15, 0xf7, 0x24, 0xa4, 0x77, 0x95, 0x46, 0x02, 0xd1, 0x33, 0xe0, 0x60, 0xb3, 0x51, 0x82,
+    0xd9, 0x0a, 0xe8, 0x3b, 0xbb, 0x68, 0x8a, 0x59, 0x1d, 0xce, 0x2c, 0xff, 0x7f, 0xac, 0x4e, 0x9d,
+    0x84, 0x57, 0xb5, 0x66, 0xe6, 0x35, 0xd7, 0x04, 0x40, 0x93, 0x71, 0xa2, 0x22, 0xf1, 0x13, 0xc0,
+    0x9b, 0x48, 0xaa, 0x79, 0xf9, 0x2a, 0xc8, 0x1b, 0x5f, 0x8c, 0x6e, 0xbd, 0x3d, 0xee, 0x0c, 0xdf,
+    0xba, 0x69, 0x8b, 0x58, 0xd8, 0x0b, 0xe9, 0x3a, 0x7e, 0xad, 0x4f, 0x9c, 0x1c, 0xcf, 0x2d, 0xfe,
+    0xa5, 0x76, 0x94, 0x47, 0xc7, 0x14, 0xf6, 0x25, 0x61, 0xb2, 0x50, 0x83, 0x03, 0xd0, 0x32, 0xe1
+};
+
+/**
+ * CRC of a byte followed by two zero bytes, crc_table[crc_table_1[i]].
+ */
+static const crc_t crc_table_2[256] = {
+    0x00, 0x67, 0xce, 0xa9, 0x0b, 0x6c, 0xc5, 0xa2, 0x16, 0x71, 0xd8, 0xbf, 0x1d, 0x7a, 0xd3, 0xb4,
+    0x2c, 0x4b, 0xe2, 0x85, 0x27, 0x40, 0xe9, 0x8e, 0x3a, 0x5d, 0xf4, 0x93, 0x31, 0x56, 0xff, 0x98,
+    0x58, 0x3f, 0x96, 0xf1, 0x53, 0x34, 0x9d, 0xfa, 0x4e, 0x29, 0x80, 0xe7, 0x45, 0x22, 0x8b, 0xec,
+    0x74, 0x13, 0xba, 0xdd, 0x7f, 0x18, 0xb1, 0xd6, 0x62, 0x05, 0xac, 0xcb, 0x69, 0x0e, 0xa7, 0xc0,
+    0xb0, 0xd7, 0x7e, 0x19, 0xbb, 0xdc, 0x75, 0x12, 0xa6, 0xc1, 0x68, 0x0f, 0xad, 0xca, 0x63, 0x04,
+    0x9c, 0xfb, 0x52, 0x35, 0x97, 0xf0, 0x59, 0x3e, 0x8a, 0xed, 0x44, 0x23, 0x81, 0xe6, 0x4f, 0x28,
+    0xe8, 0x8f, 0x26, 0x41, 0xe3, 0x84, 0x2d, 0x4a, 0xfe, 0x99, 0x30, 0x57, 0xf5, 0x92, 0x3b, 0x5c,
+    0xc4, 0xa3, 0x0a, 0x6d, 0xcf, 0xa8, 0x01, 0x66, 0xd2, 0xb5, 0x1c, 0x7b, 0xd9, 0xbe, 0x17, 0x70,
+    0xf7, 0x90, 0x39, 0x5e, 0xfc, 0x9b, 0x32, 0x55, 0xe1, 0x86, 0x2f, 0x48, 0xea, 0x8d, 0x24, 0x43,
+    0xdb, 0xbc, 0x15, 0x72, 0xd0, 0xb7, 0x1e, 0x79, 0xcd, 0xaa, 0x03, 0x64, 0xc6, 0xa1, 0x08, 0x6f,
+    0xaf, 0xc8, 0x61, 0x06, 0xa4, 0xc3, 0x6a, 0x0d, 0xb9, 0xde, 0x77, 0x10, 0xb2, 0xd5, 0x7c, 0x1b,
+    0x83, 0xe4, 0x4d, 0x2a, 0x88, 0xef, 0x46, 0x21, 0x95, 0xf2, 0x5b, 0x3c, 0x9e, 0xf9, 0x50, 0x37,
+    0x47, 0x20, 0x89, 0xee, 0x4c, 0x2b, 0x82, 0xe5, 0x51, 0x36, 0x9f, 0xf8, 0x5a, 0x3d, 0x94, 0xf3,
+    0x6b, 0x0c, 0xa5, 0xc2, 0x60, 0x07, 0xae, 0xc9, 0x7d, 0x1a, 0xb3, 0xd4, 0x76, 0x11, 0xb8, 0xdf,
+    0x1f, 0x78, 0xd1, 0xb6, 0x14, 0x73, 0xda, 0xbd, 0x09, 0x6e, 0xc7, 0xa0, 0x02, 0x65, 0xcc, 0xab,
+    0x33, 0x54, 0xfd, 0x9a, 0x38, 0x5f, 0xf6, 0x91, 0x25, 0x42, 0xeb, 0x8c, 0x2e, 0x49, 0xe0, 0x87
+};
+
+/**
+ * CRC of a byte followed by three zero bytes, crc_table[crc_table_2[i]].
+ */
+static const crc_t crc_table_3[256] = {
+    0x00, 0x79, 0xf2, 0x8b, 0x73, 0x0a, 0x81, 0xf8, 0xe6, 0x9f, 0x14, 0x6d, 0x95, 0xec, 0x67, 0x1e,
+    0x5b, 0x22, 0xa9, 0xd0, 0x28, 0x51, 0xda, 0xa3, 0xbd, 0xc4, 0x4f, 0x36, 0xce, 0xb7, 0x3c, 0x45,
+    0xb6, 0xcf, 0x44, 0x3d, 0xc5, 0xbc, 0x37, 0x4e, 0x50, 0x29, 0xa2, 0xdb, 0x23, 0x5a, 0xd1, 0xa8,
+    0xed, 0x94, 0x1f, 0x66, 0x9e, 0xe7, 0x6c, 0x15, 0x0b, 0x72, 0xf9, 0x80, 0x78, 0x01, 0x8a, 0xf3,
+    0xfb, 0x82, 0x09, 0x70, 0x88, 0xf1, 0x7a, 0x03, 0x1d, 0x64, 0xef, 0x96, 0x6e, 0x17, 0x9c, 0xe5,
+    0xa0, 0xd9, 0x52, 0x2b, 0xd3, 0xaa, 0x21, 0x58, 0x46, 0x3f, 0xb4, 0xcd, 0x35, 0x4c, 0xc7, 0xbe,
+    0x4d, 0x34, 0xbf, 0xc6, 0x3e, 0x47, 0xcc, 0xb5, 0xab, 0xd2, 0x59, 0x20, 0xd8, 0xa1, 0x2a, 0x53,
+    0x16, 0x6f, 0xe4, 0x9d, 0x65, 0x1c, 0x97, 0xee, 0xf0, 0x89, 0x02, 0x7b, 0x83, 0xfa, 0x71, 0x08,
+    0x61, 0x18, 0x93, 0xea, 0x12, 0x6b, 0xe0, 0x99, 0x87, 0xfe, 0x75, 0x0c, 0xf4, 0x8d, 0x06, 0x7f,
+    0x3a, 0x43, 0xc8, 0xb1, 0x49, 0x30, 0xbb, 0xc2, 0xdc, 0xa5, 0x2e, 0x57, 0xaf, 0xd6, 0x5d, 0x24,
+    0xd7, 0xae, 0x25, 0x5c, 0xa4, 0xdd, 0x56, 0x2f, 0x31, 0x48, 0xc3, 0xba, 0x42, 0x3b, 0xb0, 0xc9,
+    0x8c, 0xf5, 0x7e, 0x07, 0xff, 0x86, 0x0d, 0x74, 0x6a, 0x13, 0x98, 0xe1, 0x19, 0x60, 0xeb, 0x92,
+    0x9a, 0xe3, 0x68, 0x11, 0xe9, 0x90, 0x1b, 0x62, 0x7c, 0x05, 0x8e, 0xf7, 0x0f, 0x76, 0xfd, 0x84,
+    0xc1, 0xb8, 0x33, 0x4a, 0xb2, 0xcb, 0x40, 0x39, 0x27, 0x5e, 0xd5, 0xac, 0x54, 0x2d, 0xa6, 0xdf,
+    0x2c, 0x55, 0xde, 0xa7, 0x5f, 0x26, 0xad, 0xd4, 0xca, 0xb3, 0x38, 0x41, 0xb9, 0xc0, 0x4b, 0x32,
+    0x77, 0x0e, 0x85, 0xfc, 0x04, 0x7d, 0xf6, 0x8f, 0x91, 0xe8, 0x63, 0x1a, 0xe2, 0x9b, 0x10, 0x69
+};
+
 
 crc_t crc_update(crc_t crc, const void *data, size_t data_len)
 {
     const unsigned char *d = (const unsigned char *)data;
     unsigned int tbl_idx;
 
+    /* Slice-by-4: the CRC of four bytes is the XOR of each byte's CRC
+     * shifted through the remaining zero bytes, so the lookups do not
+     * depend on each other. */
+    while (data_len >= 4) {
+        crc = crc_table_3[(crc ^ d[0]) & 0xff] ^ crc_table_2[d[1]] ^
+              crc_table_1[d[2]] ^ crc_table[d[3]];
+        d += 4;
+        data_len -= 4;
+    }
     while (data_len--) {
         tbl_idx = crc ^ *d;
         crc = crc_table[tbl_idx] & 0xff;
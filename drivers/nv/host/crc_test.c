@@ -0,0 +1,317 @@
+/******************************************************************************
+
+ @file  crc_test.c
+
+ @brief crc_update reference test and throughput benchmark
+
+ Group: CMCU, LPC
+ Target Device: cc13xx_cc26xx
+
+ ******************************************************************************
+ 
+ Copyright (c) 2019-2026, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ 
+ 
+ *****************************************************************************/
+
+/*
+Checks crc_update() of crc.c, the slice-by-4 CRC-8 used by NVOCMP for item
+headers and data, against a bitwise CRC-8 (polynomial 0x97, no reflection,
+initial value and final XOR 0):
+
+- every length from 0 to 1024 bytes, at every start offset modulo 4, with
+  every initial CRC value, so the slice-by-4 loop, the byte-wise tail and
+  all four derived tables are covered
+- the same data split at every point into two crc_update() calls, as
+  NVOCMP does for an item's data and its header
+- the CRC of every single byte, and the pycrc check value of "123456789"
+
+Then it reports crc_update() throughput against the bitwise and byte-wise
+table-driven algorithms, for the buffer sizes NVOCMP checks: an item
+header, a typical Z-Stack item, the NVOCMP_XFERBLKMAX flash read block
+and a whole page.
+
+The exit status is 1 on any difference. Build and run from the repository
+root:
+
+  cc -O2 -Idrivers/nv -o crc_test drivers/nv/host/crc_test.c drivers/nv/crc.c
+  ./crc_test
+*/
+
+//*****************************************************************************
+// Includes
+//*****************************************************************************
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <crc.h>
+
+//*****************************************************************************
+// Constants and Definitions
+//*****************************************************************************
+
+#define TEST_CRC_POLY       0x97
+
+// pycrc check value, CRC of "123456789"
+#define TEST_CRC_CHECK      0x94
+
+#define TEST_MAX_LEN        1024
+
+// Bytes processed per throughput measurement
+#define TEST_BENCH_BYTES    (64UL * 1024UL * 1024UL)
+
+//*****************************************************************************
+// Local Variables
+//*****************************************************************************
+
+static uint8_t testTable[256];
+static uint8_t testBuf[TEST_MAX_LEN + 8];
+static unsigned long testFailures;
+static volatile crc_t testSink;
+
+//*****************************************************************************
+// Local Functions
+//*****************************************************************************
+
+/**
+ * @fn      testCrcBitwise
+ *
+ * @brief   Reference CRC-8, one bit at a time
+ *
+ * @param   crc - current CRC value
+ * @param   pData - data to add to the CRC
+ * @param   len - number of bytes
+ *
+ * @return  updated CRC value
+ */
+static crc_t testCrcBitwise(crc_t crc, const uint8_t *pData, size_t len)
+{
+    uint8_t c = (uint8_t)crc;
+    int bit;
+
+    while(len--)
+    {
+        c ^= *pData++;
+        for(bit = 0; bit < 8; bit++)
+        {
+            c = (c & 0x80) ? (uint8_t)((c << 1) ^ TEST_CRC_POLY) : (uint8_t)(c << 1);
+        }
+    }
+    return(c);
+}
+
+/**
+ * @fn      testCrcBytewise
+ *
+ * @brief   Table-driven CRC-8, one byte at a time, as crc_update() was
+ *          before slice-by-4. The table is built from testCrcBitwise().
+ *
+ * @param   crc - current CRC value
+ * @param   pData - data to add to the CRC
+ * @param   len - number of bytes
+ *
+ * @return  updated CRC value
+ */
+static crc_t testCrcBytewise(crc_t crc, const uint8_t *pData, size_t len)
+{
+    while(len--)
+    {
+        crc = testTable[(crc ^ *pData++) & 0xff];
+    }
+    return(crc);
+}
+
+/**
+ * @fn      testNowNs
+ *
+ * @brief   Monotonic host time
+ *
+ * @param   none
+ *
+ * @return  time in ns
+ */
+static double testNowNs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return((double)ts.tv_sec * 1e9 + (double)ts.tv_nsec);
+}
+
+/**
+ * @fn      testCheck
+ *
+ * @brief   Compare crc_update() with the bitwise reference
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+static void testCheck(void)
+{
+    uint8_t check[] = "123456789";
+    unsigned int ofs, init, split;
+    size_t len;
+    crc_t ref, crc;
+
+    for(len = 0; len < sizeof(testBuf); len++)
+    {
+        testBuf[len] = (uint8_t)rand();
+    }
+
+    ref = testCrcBitwise(0, check, 9);
+    crc = crc_finalize(crc_update(crc_init(), check, 9));
+    if((ref != TEST_CRC_CHECK) || (crc != TEST_CRC_CHECK))
+    {
+        printf("check value: bitwise 0x%02x, crc_update 0x%02x, expected 0x%02x\n",
+               (unsigned int)ref, (unsigned int)crc, TEST_CRC_CHECK);
+        testFailures++;
+    }
+
+    for(init = 0; init < 256; init++)
+    {
+        uint8_t byte = (uint8_t)init;
+
+        testTable[init] = testCrcBitwise(0, &byte, 1);
+        if(crc_update(0, &byte, 1) != testTable[init])
+        {
+            printf("byte 0x%02x: crc_update 0x%02x, bitwise 0x%02x\n", init,
+                   (unsigned int)crc_update(0, &byte, 1), testTable[init]);
+            testFailures++;
+        }
+    }
+
+    for(ofs = 0; ofs < 4; ofs++)
+    {
+        for(len = 0; len <= TEST_MAX_LEN; len++)
+        {
+            for(init = 0; init < 256; init += (len < 64) ? 1 : 37)
+            {
+                ref = testCrcBitwise((crc_t)init, &testBuf[ofs], len);
+                crc = crc_update((crc_t)init, &testBuf[ofs], len);
+                if(crc != ref)
+                {
+                    printf("offset %u length %zu initial 0x%02x: crc_update 0x%02x, bitwise 0x%02x\n",
+                           ofs, len, init, (unsigned int)crc, (unsigned int)ref);
+                    testFailures++;
+                }
+            }
+        }
+    }
+
+    for(len = 0; len <= 64; len++)
+    {
+        ref = testCrcBitwise(0, testBuf, len);
+        for(split = 0; split <= len; split++)
+        {
+            crc = crc_update(crc_update(0, testBuf, split), &testBuf[split], len - split);
+            if(crc != ref)
+            {
+                printf("length %zu split at %u: crc_update 0x%02x, bitwise 0x%02x\n",
+                       len, split, (unsigned int)crc, (unsigned int)ref);
+                testFailures++;
+            }
+        }
+    }
+}
+
+typedef crc_t (*testCrcFn)(crc_t crc, const uint8_t *pData, size_t len);
+
+static crc_t testCrcUpdate(crc_t crc, const uint8_t *pData, size_t len)
+{
+    return(crc_update(crc, pData, len));
+}
+
+/**
+ * @fn      testThroughput
+ *
+ * @brief   Throughput of a CRC function on buffers of one size
+ *
+ * @param   pfnCrc - CRC function
+ * @param   len - buffer size, bytes
+ *
+ * @return  MB/s
+ */
+static double testThroughput(testCrcFn pfnCrc, size_t len)
+{
+    unsigned long n = TEST_BENCH_BYTES / len;
+    unsigned long i;
+    double t0, ns;
+    crc_t crc = 0;
+
+    // Bitwise is about 8x slower, use fewer bytes
+    if(pfnCrc == testCrcBitwise)
+    {
+        n /= 8;
+    }
+    t0 = testNowNs();
+    for(i = 0; i < n; i++)
+    {
+        crc = pfnCrc(crc, testBuf, len);
+    }
+    ns = testNowNs() - t0;
+    testSink = crc;
+    return(((double)n * (double)len * 1e3) / ns);
+}
+
+//*****************************************************************************
+// Main
+//*****************************************************************************
+
+int main(void)
+{
+    // Item header, typical item, NVOCMP_XFERBLKMAX, page
+    static const size_t sizes[] = {5, 20, 32, 256, 1024};
+    unsigned int i;
+
+    srand(1);
+    testCheck();
+
+    printf("crc_update throughput, MB/s\n");
+    printf("  %8s %10s %10s %10s %8s\n", "bytes", "bitwise", "bytewise", "slice-4", "speedup");
+    for(i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+    {
+        double bit = testThroughput(testCrcBitwise, sizes[i]);
+        double byte = testThroughput(testCrcBytewise, sizes[i]);
+        double slice = testThroughput(testCrcUpdate, sizes[i]);
+
+        printf("  %8zu %10.1f %10.1f %10.1f %7.2fx\n", sizes[i], bit, byte, slice,
+               slice / byte);
+    }
+    printf("crc_update results differing from the bitwise CRC: %lu\n", testFailures);
+
+    return((testFailures != 0) ? 1 : 0);
+}
@@ -0,0 +1,1052 @@
+/******************************************************************************
+
+ @file  nv_linux.c
+
+ @brief Simulated NVS flash device for the Linux build of NVOCMP
+
+ Group: CMCU, LPC
+ Target Device: cc13xx_cc26xx
+
+ ******************************************************************************
+ 
+ Copyright (c) 2019-2026, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ 
+ 
+ *****************************************************************************/
+
+//*****************************************************************************
+// Includes
+//*****************************************************************************
+
+#include <fcntl.h>
+#include <libgen.h>
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "nv_linux.h"
+
+//*****************************************************************************
+// Constants and Definitions
+//*****************************************************************************
+
+#define NV_LINUX_REGION_SIZE    (FLASH_PAGE_SIZE * NVOCMP_NVPAGES)
+
+// Typical flash time of programming len bytes, rounded up to whole words
+#define NV_LINUX_PROG_US(len)   ((((len) + 3) / 4) * NV_LINUX_PROG_WORD_US)
+
+// Journal file: a header, then one record per save
+//   header: magic, CRC-32 of the image it applies to, region size
+//   record: magic, payload length, CRC-32 of the payload, payload
+//   payload: per changed page, page, flags, offset, length and the bytes
+#define NV_LINUX_JNL_MAGIC      0x4C4E4A56
+#define NV_LINUX_REC_MAGIC      0x43455256
+#define NV_LINUX_JNL_HDRLEN     12
+#define NV_LINUX_REC_HDRLEN     12
+#define NV_LINUX_ENT_HDRLEN     6
+#define NV_LINUX_ENT_ERASE      0x01    // Page erased before the bytes
+
+// Changed byte ranges tracked per page, more are merged
+#define NV_LINUX_DIRTY_RANGES   4
+
+#define NV_LINUX_REC_MAXLEN     (NV_LINUX_REC_HDRLEN + NVOCMP_NVPAGES * \
+                                 (NV_LINUX_DIRTY_RANGES * NV_LINUX_ENT_HDRLEN + FLASH_PAGE_SIZE))
+
+#define NV_LINUX_JNL_SUFFIX     ".jnl"
+#define NV_LINUX_TMP_SUFFIX     ".tmp"
+
+//*****************************************************************************
+// Typedefs
+//*****************************************************************************
+
+// Changed bytes of a page
+typedef struct
+{
+    uint16_t lo;        // First changed byte
+    uint16_t hi;        // Past the last changed byte
+} NV_LINUX_range_t;
+
+// Bytes of a page changed since the last save
+typedef struct
+{
+    NV_LINUX_range_t range[NV_LINUX_DIRTY_RANGES];  // Disjoint ranges
+    uint8_t          num;                           // Ranges in use
+    bool             erased;    // Page erased, bytes outside the ranges are 0xFF
+} NV_LINUX_dirty_t;
+
+//*****************************************************************************
+// Global Variables
+//*****************************************************************************
+
+NVS_Attrs NV_LINUX_attrs = {NV_LINUX_REGION_SIZE, FLASH_PAGE_SIZE};
+bool NV_LINUX_lowVoltage = false;
+bool NV_LINUX_verbose = false;
+bool NV_LINUX_syncWrites = true;
+uint32_t NV_LINUX_journalMax = NV_LINUX_JOURNAL_MAX;
+
+//*****************************************************************************
+// Local Variables
+//*****************************************************************************
+
+static uint8_t NV_LINUX_flash[NVOCMP_NVPAGES][FLASH_PAGE_SIZE];
+static NV_LINUX_stats_t NV_LINUX_stats;
+static const char *NV_LINUX_imageFile = NULL;
+static uint32_t NV_LINUX_powerCut = 0;
+static uint32_t NV_LINUX_saveCut = 0;
+
+static NV_LINUX_dirty_t NV_LINUX_dirty[NVOCMP_NVPAGES];
+static uint8_t NV_LINUX_rec[NV_LINUX_REC_MAXLEN];
+static int NV_LINUX_jnlFd = -1;
+static uint32_t NV_LINUX_jnlSize = 0;
+// CRC-32 of the image file, the base of the journal
+static uint32_t NV_LINUX_baseCrc = 0;
+
+//*****************************************************************************
+// Local Functions
+//*****************************************************************************
+
+/**
+ * @fn      NV_LINUX_checkPowerCut
+ *
+ * @brief   Count a program or erase, and lose power instead of doing the one
+ *          NV_LINUX_setPowerCut() selected
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+static void NV_LINUX_checkPowerCut(void)
+{
+    if ((NV_LINUX_powerCut != 0) && (--NV_LINUX_powerCut == 0))
+    {
+        NV_LINUX_save();
+        _exit(NV_LINUX_POWERCUT_EXIT);
+    }
+}
+
+/**
+ * @fn      NV_LINUX_checkSaveCut
+ *
+ * @brief   Count a file operation of a save
+ *
+ * @param   none
+ *
+ * @return  true if the process must stop at this one
+ */
+static bool NV_LINUX_checkSaveCut(void)
+{
+    return((NV_LINUX_saveCut != 0) && (--NV_LINUX_saveCut == 0));
+}
+
+/**
+ * @fn      NV_LINUX_crc32
+ *
+ * @brief   CRC-32 (IEEE 802.3) of a buffer
+ *
+ * @param   crc  - CRC of the preceding bytes, 0 to start
+ * @param   pBuf - bytes
+ * @param   len  - number of bytes
+ *
+ * @return  CRC-32
+ */
+static uint32_t NV_LINUX_crc32(uint32_t crc, const uint8_t *pBuf, size_t len)
+{
+    uint8_t bit;
+
+    crc = ~crc;
+    while (len--)
+    {
+        crc ^= *pBuf++;
+        for (bit = 0; bit < 8; bit++)
+        {
+            crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+        }
+    }
+    return(~crc);
+}
+
+static void NV_LINUX_put16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void NV_LINUX_put32(uint8_t *p, uint32_t v)
+{
+    NV_LINUX_put16(p, (uint16_t)v);
+    NV_LINUX_put16(p + 2, (uint16_t)(v >> 16));
+}
+
+static uint16_t NV_LINUX_get16(const uint8_t *p)
+{
+    return((uint16_t)(p[0] | (p[1] << 8)));
+}
+
+static uint32_t NV_LINUX_get32(const uint8_t *p)
+{
+    return(NV_LINUX_get16(p) | ((uint32_t)NV_LINUX_get16(p + 2) << 16));
+}
+
+/**
+ * @fn      NV_LINUX_path
+ *
+ * @brief   Name of a file that goes with the image file
+ *
+ * @param   pPath  - destination, PATH_MAX bytes
+ * @param   suffix - suffix appended to the image file name
+ *
+ * @return  true if the name fits
+ */
+static bool NV_LINUX_path(char *pPath, const char *suffix)
+{
+    int len = snprintf(pPath, PATH_MAX, "%s%s", NV_LINUX_imageFile, suffix);
+
+    return((len > 0) && (len < PATH_MAX));
+}
+
+/**
+ * @fn      NV_LINUX_writeFile
+ *
+ * @brief   Write a buffer to a file. At the file operation selected by
+ *          NV_LINUX_setSaveCut() only half of it is written and the
+ *          process exits, as when it is killed in the middle of a save.
+ *
+ * @param   fd   - file
+ * @param   pBuf - bytes
+ * @param   len  - number of bytes
+ *
+ * @return  true if all bytes were written
+ */
+static bool NV_LINUX_writeFile(int fd, const uint8_t *pBuf, size_t len)
+{
+    ssize_t n;
+
+    if (NV_LINUX_checkSaveCut())
+    {
+        (void)write(fd, pBuf, len / 2);
+        _exit(NV_LINUX_POWERCUT_EXIT);
+    }
+
+    while (len > 0)
+    {
+        n = write(fd, pBuf, len);
+        if (n <= 0)
+        {
+            return(false);
+        }
+        pBuf += n;
+        len -= (size_t)n;
+        NV_LINUX_stats.fileBytes += (uint32_t)n;
+    }
+    return(true);
+}
+
+/**
+ * @fn      NV_LINUX_syncFile
+ *
+ * @brief   Flush a file to the disk, unless NV_LINUX_syncWrites is clear
+ *
+ * @param   fd - file
+ *
+ * @return  true if flushed or not required
+ */
+static bool NV_LINUX_syncFile(int fd)
+{
+    if (!NV_LINUX_syncWrites)
+    {
+        return(true);
+    }
+    NV_LINUX_stats.fileSyncs++;
+    return(fsync(fd) == 0);
+}
+
+/**
+ * @fn      NV_LINUX_syncDir
+ *
+ * @brief   Flush the directory of the image file, so that a rename in it is
+ *          on the disk before the journal is removed
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+static void NV_LINUX_syncDir(void)
+{
+    char path[PATH_MAX];
+    int fd;
+
+    if (!NV_LINUX_syncWrites || !NV_LINUX_path(path, ""))
+    {
+        return;
+    }
+
+    fd = open(dirname(path), O_RDONLY | O_DIRECTORY);
+    if (fd >= 0)
+    {
+        (void)NV_LINUX_syncFile(fd);
+        close(fd);
+    }
+}
+
+/**
+ * @fn      NV_LINUX_clearDirty
+ *
+ * @brief   Mark every page as saved
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+static void NV_LINUX_clearDirty(void)
+{
+    uint8_t pg;
+
+    for (pg = 0; pg < NVOCMP_NVPAGES; pg++)
+    {
+        NV_LINUX_dirty[pg].num = 0;
+        NV_LINUX_dirty[pg].erased = false;
+    }
+}
+
+/**
+ * @fn      NV_LINUX_gap
+ *
+ * @brief   Bytes between a changed range and other bytes of its page
+ *
+ * @param   pRange - changed range
+ * @param   lo     - first byte
+ * @param   hi     - past the last byte
+ *
+ * @return  bytes between them, 0 when they overlap or touch
+ */
+static uint16_t NV_LINUX_gap(const NV_LINUX_range_t *pRange, uint16_t lo, uint16_t hi)
+{
+    if (lo > pRange->hi)
+    {
+        return(lo - pRange->hi);
+    }
+    if (pRange->lo > hi)
+    {
+        return(pRange->lo - hi);
+    }
+    return(0);
+}
+
+/**
+ * @fn      NV_LINUX_addDirty
+ *
+ * @brief   Add programmed bytes to the changed ranges of a page. Ranges
+ *          closer than an entry header are merged, and once all ranges are
+ *          in use the new one is merged with the nearest.
+ *
+ * @param   pg - page
+ * @param   lo - first programmed byte
+ * @param   hi - past the last programmed byte
+ *
+ * @return  none
+ */
+static void NV_LINUX_addDirty(uint8_t pg, uint16_t lo, uint16_t hi)
+{
+    NV_LINUX_dirty_t *pDirty = &NV_LINUX_dirty[pg];
+    NV_LINUX_range_t *pRange;
+    uint16_t nearGap;
+    uint16_t gap;
+    uint8_t near;
+    uint8_t i = 0;
+
+    while (i < pDirty->num)
+    {
+        pRange = &pDirty->range[i];
+        if (NV_LINUX_gap(pRange, lo, hi) > NV_LINUX_ENT_HDRLEN)
+        {
+            i++;
+            continue;
+        }
+        // Take the range out and start over with the merged bytes
+        lo = (pRange->lo < lo) ? pRange->lo : lo;
+        hi = (pRange->hi > hi) ? pRange->hi : hi;
+        *pRange = pDirty->range[--pDirty->num];
+        i = 0;
+    }
+
+    if (pDirty->num == NV_LINUX_DIRTY_RANGES)
+    {
+        // No free range, merge with the nearest one. No other range lies
+        // between them, so the ranges stay disjoint.
+        near = 0;
+        nearGap = FLASH_PAGE_SIZE;
+        for (i = 0; i < pDirty->num; i++)
+        {
+            gap = NV_LINUX_gap(&pDirty->range[i], lo, hi);
+            if (gap < nearGap)
+            {
+                nearGap = gap;
+                near = i;
+            }
+        }
+        pRange = &pDirty->range[near];
+        lo = (pRange->lo < lo) ? pRange->lo : lo;
+        hi = (pRange->hi > hi) ? pRange->hi : hi;
+        *pRange = pDirty->range[--pDirty->num];
+    }
+
+    pDirty->range[pDirty->num].lo = lo;
+    pDirty->range[pDirty->num].hi = hi;
+    pDirty->num++;
+}
+
+/**
+ * @fn      NV_LINUX_closeJournal
+ *
+ * @brief   Close the journal file, the next save starts a new one
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+static void NV_LINUX_closeJournal(void)
+{
+    if (NV_LINUX_jnlFd >= 0)
+    {
+        close(NV_LINUX_jnlFd);
+        NV_LINUX_jnlFd = -1;
+    }
+    NV_LINUX_jnlSize = 0;
+}
+
+/**
+ * @fn      NV_LINUX_applyRecord
+ *
+ * @brief   Apply the payload of a journal record to the NV region
+ *
+ * @param   pBuf - payload
+ * @param   len  - payload length
+ *
+ * @return  true if the payload is well formed
+ */
+static bool NV_LINUX_applyRecord(const uint8_t *pBuf, uint32_t len)
+{
+    uint32_t pos = 0;
+
+    while (pos < len)
+    {
+        uint8_t pg;
+        uint8_t flags;
+        uint16_t off;
+        uint16_t cnt;
+
+        if (len - pos < NV_LINUX_ENT_HDRLEN)
+        {
+            return(false);
+        }
+        pg = pBuf[pos];
+        flags = pBuf[pos + 1];
+        off = NV_LINUX_get16(&pBuf[pos + 2]);
+        cnt = NV_LINUX_get16(&pBuf[pos + 4]);
+        pos += NV_LINUX_ENT_HDRLEN;
+        if ((pg >= NVOCMP_NVPAGES) || ((uint32_t)off + cnt > FLASH_PAGE_SIZE) ||
+            (len - pos < cnt))
+        {
+            return(false);
+        }
+
+        if (flags & NV_LINUX_ENT_ERASE)
+        {
+            memset(NV_LINUX_flash[pg], 0xFF, FLASH_PAGE_SIZE);
+        }
+        memcpy(&NV_LINUX_flash[pg][off], &pBuf[pos], cnt);
+        pos += cnt;
+    }
+    return(true);
+}
+
+/**
+ * @fn      NV_LINUX_replayJournal
+ *
+ * @brief   Apply the journal of the image file to the NV region, and keep
+ *          it open for the next saves. A journal of another image, left
+ *          by a checkpoint that was stopped before removing it, is ignored.
+ *          A record cut short by a stopped save ends the journal and is
+ *          cut off.
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+static void NV_LINUX_replayJournal(void)
+{
+    char path[PATH_MAX];
+    uint8_t hdr[NV_LINUX_REC_HDRLEN];
+    uint32_t size;
+    uint32_t len;
+    FILE *fp;
+
+    if (!NV_LINUX_path(path, NV_LINUX_JNL_SUFFIX))
+    {
+        return;
+    }
+    fp = fopen(path, "rb");
+    if (fp == NULL)
+    {
+        return;
+    }
+
+    if ((fread(hdr, 1, NV_LINUX_JNL_HDRLEN, fp) != NV_LINUX_JNL_HDRLEN) ||
+        (NV_LINUX_get32(&hdr[0]) != NV_LINUX_JNL_MAGIC) ||
+        (NV_LINUX_get32(&hdr[4]) != NV_LINUX_baseCrc) ||
+        (NV_LINUX_get32(&hdr[8]) != NV_LINUX_REGION_SIZE))
+    {
+        // Stale or cut short before its first record, the next save
+        // replaces it
+        fclose(fp);
+        return;
+    }
+
+    size = NV_LINUX_JNL_HDRLEN;
+    while (fread(hdr, 1, NV_LINUX_REC_HDRLEN, fp) == NV_LINUX_REC_HDRLEN)
+    {
+        len = NV_LINUX_get32(&hdr[4]);
+        if ((NV_LINUX_get32(&hdr[0]) != NV_LINUX_REC_MAGIC) ||
+            (len > NV_LINUX_REC_MAXLEN - NV_LINUX_REC_HDRLEN) ||
+            (fread(NV_LINUX_rec, 1, len, fp) != len) ||
+            (NV_LINUX_crc32(0, NV_LINUX_rec, len) != NV_LINUX_get32(&hdr[8])) ||
+            !NV_LINUX_applyRecord(NV_LINUX_rec, len))
+        {
+            break;
+        }
+        size += NV_LINUX_REC_HDRLEN + len;
+    }
+    fclose(fp);
+
+    NV_LINUX_jnlFd = open(path, O_WRONLY | O_APPEND);
+    if ((NV_LINUX_jnlFd < 0) || (ftruncate(NV_LINUX_jnlFd, size) != 0))
+    {
+        NV_LINUX_assert(false, "NV_LINUX: cannot open the journal file", false);
+        NV_LINUX_closeJournal();
+        return;
+    }
+    NV_LINUX_jnlSize = size;
+}
+
+/**
+ * @fn      NV_LINUX_openJournal
+ *
+ * @brief   Start a journal on the image file
+ *
+ * @param   none
+ *
+ * @return  true if the journal is open
+ */
+static bool NV_LINUX_openJournal(void)
+{
+    char path[PATH_MAX];
+    uint8_t hdr[NV_LINUX_JNL_HDRLEN];
+
+    if (!NV_LINUX_path(path, NV_LINUX_JNL_SUFFIX))
+    {
+        return(false);
+    }
+    NV_LINUX_jnlFd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0644);
+    if (NV_LINUX_jnlFd < 0)
+    {
+        return(false);
+    }
+
+    NV_LINUX_put32(&hdr[0], NV_LINUX_JNL_MAGIC);
+    NV_LINUX_put32(&hdr[4], NV_LINUX_baseCrc);
+    NV_LINUX_put32(&hdr[8], NV_LINUX_REGION_SIZE);
+    if (!NV_LINUX_writeFile(NV_LINUX_jnlFd, hdr, NV_LINUX_JNL_HDRLEN))
+    {
+        NV_LINUX_closeJournal();
+        return(false);
+    }
+    NV_LINUX_jnlSize = NV_LINUX_JNL_HDRLEN;
+    return(true);
+}
+
+/**
+ * @fn      NV_LINUX_buildRecord
+ *
+ * @brief   Put the bytes changed since the last save in a journal record
+ *
+ * @param   none
+ *
+ * @return  record length, 0 when nothing changed
+ */
+static uint32_t NV_LINUX_buildRecord(void)
+{
+    uint32_t len = NV_LINUX_REC_HDRLEN;
+    uint8_t pg;
+
+    for (pg = 0; pg < NVOCMP_NVPAGES; pg++)
+    {
+        NV_LINUX_dirty_t *pDirty = &NV_LINUX_dirty[pg];
+        // An erased page without programmed bytes still needs an entry
+        uint8_t num = (pDirty->erased && (pDirty->num == 0)) ? 1 : pDirty->num;
+        uint8_t i;
+
+        for (i = 0; i < num; i++)
+        {
+            uint16_t off = (i < pDirty->num) ? pDirty->range[i].lo : 0;
+            uint16_t cnt = (i < pDirty->num) ? (pDirty->range[i].hi - off) : 0;
+
+            // The erase goes first, before any bytes of the page
+            NV_LINUX_rec[len] = pg;
+            NV_LINUX_rec[len + 1] = (pDirty->erased && (i == 0)) ? NV_LINUX_ENT_ERASE : 0;
+            NV_LINUX_put16(&NV_LINUX_rec[len + 2], off);
+            NV_LINUX_put16(&NV_LINUX_rec[len + 4], cnt);
+            len += NV_LINUX_ENT_HDRLEN;
+            memcpy(&NV_LINUX_rec[len], &NV_LINUX_flash[pg][off], cnt);
+            len += cnt;
+        }
+    }
+    if (len == NV_LINUX_REC_HDRLEN)
+    {
+        return(0);
+    }
+
+    NV_LINUX_put32(&NV_LINUX_rec[0], NV_LINUX_REC_MAGIC);
+    NV_LINUX_put32(&NV_LINUX_rec[4], len - NV_LINUX_REC_HDRLEN);
+    NV_LINUX_put32(&NV_LINUX_rec[8], NV_LINUX_crc32(0, &NV_LINUX_rec[NV_LINUX_REC_HDRLEN],
+                                                    len - NV_LINUX_REC_HDRLEN));
+    return(len);
+}
+
+//*****************************************************************************
+// Functions
+//*****************************************************************************
+
+/**
+ * @fn      NV_LINUX_setImageFile
+ *
+ * @brief   Select the image file of the NV region
+ *
+ * @param   path - image file path, NULL for none
+ *
+ * @return  none
+ */
+void NV_LINUX_setImageFile(const char *path)
+{
+    NV_LINUX_closeJournal();
+    NV_LINUX_imageFile = path;
+}
+
+/**
+ * @fn      NV_LINUX_init
+ *
+ * @brief   Load the NV region from the image file and its journal, or erase
+ *          it
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+void NV_LINUX_init(void)
+{
+    FILE *fp = NULL;
+    size_t len = 0;
+
+    NV_LINUX_closeJournal();
+    NV_LINUX_clearDirty();
+
+    if (NV_LINUX_imageFile != NULL)
+    {
+        fp = fopen(NV_LINUX_imageFile, "rb");
+    }
+
+    if (fp != NULL)
+    {
+        len = fread(NV_LINUX_flash, 1, NV_LINUX_REGION_SIZE, fp);
+        fclose(fp);
+    }
+
+    if (len != NV_LINUX_REGION_SIZE)
+    {
+        // No image, or an image of another geometry: start blank
+        memset(NV_LINUX_flash, 0xFF, NV_LINUX_REGION_SIZE);
+    }
+
+    if (NV_LINUX_imageFile != NULL)
+    {
+        NV_LINUX_baseCrc = NV_LINUX_crc32(0, &NV_LINUX_flash[0][0], NV_LINUX_REGION_SIZE);
+        NV_LINUX_replayJournal();
+    }
+}
+
+/**
+ * @fn      NV_LINUX_read
+ *
+ * @brief   Read from the NV region
+ *
+ * @param   pg   - page to read from
+ * @param   off  - offset in the page
+ * @param   pBuf - destination buffer
+ * @param   len  - number of bytes to read
+ *
+ * @return  none
+ */
+void NV_LINUX_read(uint8_t pg, uint16_t off, uint8_t *pBuf, uint16_t len)
+{
+    if ((pg < NVOCMP_NVPAGES) && ((uint32_t)off + len <= FLASH_PAGE_SIZE))
+    {
+        memcpy(pBuf, &NV_LINUX_flash[pg][off], len);
+    }
+    else
+    {
+        // Reads outside the region see erased flash
+        memset(pBuf, 0xFF, len);
+        NV_LINUX_assert(false, "NV_LINUX: read outside the NV region", true);
+    }
+}
+
+/**
+ * @fn      NV_LINUX_write
+ *
+ * @brief   Program the NV region, clearing bits only
+ *
+ * @param   pg   - page to program
+ * @param   off  - offset in the page
+ * @param   pBuf - data to program
+ * @param   len  - number of bytes to program
+ *
+ * @return  NVS_STATUS_SUCCESS, NVS_STATUS_INV_OFFSET or NVS_STATUS_ERROR
+ */
+int_fast16_t NV_LINUX_write(uint8_t pg, uint16_t off, uint8_t *pBuf, uint16_t len)
+{
+    uint8_t *pDst;
+    uint16_t i;
+    int_fast16_t status = NVS_STATUS_SUCCESS;
+
+    if ((pg >= NVOCMP_NVPAGES) || ((uint32_t)off + len > FLASH_PAGE_SIZE))
+    {
+        return(NVS_STATUS_INV_OFFSET);
+    }
+
+    NV_LINUX_checkPowerCut();
+
+    pDst = &NV_LINUX_flash[pg][off];
+    for (i = 0; i < len; i++)
+    {
+        if ((pDst[i] & pBuf[i]) != pBuf[i])
+        {
+            // A program cannot set a bit, the byte keeps its value and the
+            // post-write verify fails
+            status = NVS_STATUS_ERROR;
+        }
+        else
+        {
+            pDst[i] = pBuf[i];
+        }
+    }
+
+    if (len > 0)
+    {
+        NV_LINUX_addDirty(pg, off, off + len);
+    }
+
+    NV_LINUX_stats.programs++;
+    NV_LINUX_stats.bytesProgrammed += len;
+    NV_LINUX_stats.busyUs += NV_LINUX_PROG_US(len);
+    if (status != NVS_STATUS_SUCCESS)
+    {
+        NV_LINUX_stats.faults++;
+    }
+
+    return(status);
+}
+
+/**
+ * @fn      NV_LINUX_erase
+ *
+ * @brief   Erase a page of the NV region to 0xFF
+ *
+ * @param   pg - page to erase
+ *
+ * @return  NVS_STATUS_SUCCESS or NVS_STATUS_INV_OFFSET
+ */
+int_fast16_t NV_LINUX_erase(uint8_t pg)
+{
+    if (pg >= NVOCMP_NVPAGES)
+    {
+        return(NVS_STATUS_INV_OFFSET);
+    }
+
+    NV_LINUX_checkPowerCut();
+
+    memset(NV_LINUX_flash[pg], 0xFF, FLASH_PAGE_SIZE);
+
+    // Bytes programmed before the erase are gone
+    NV_LINUX_dirty[pg].num = 0;
+    NV_LINUX_dirty[pg].erased = true;
+
+    NV_LINUX_stats.erases[pg]++;
+    NV_LINUX_stats.busyUs += NV_LINUX_ERASE_PAGE_US;
+
+    return(NVS_STATUS_SUCCESS);
+}
+
+/**
+ * @fn      NV_LINUX_save
+ *
+ * @brief   Append the bytes changed since the last save to the journal of
+ *          the image file, and fold the journal into the image once it is
+ *          longer than NV_LINUX_journalMax
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+void NV_LINUX_save(void)
+{
+    uint32_t len;
+
+    if (NV_LINUX_imageFile == NULL)
+    {
+        NV_LINUX_clearDirty();
+        return;
+    }
+
+    len = NV_LINUX_buildRecord();
+    if (len == 0)
+    {
+        return;
+    }
+
+    if ((NV_LINUX_jnlFd < 0) && !NV_LINUX_openJournal())
+    {
+        NV_LINUX_assert(false, "NV_LINUX: cannot open the journal file", false);
+        return;
+    }
+
+    if (!NV_LINUX_writeFile(NV_LINUX_jnlFd, NV_LINUX_rec, len) ||
+        !NV_LINUX_syncFile(NV_LINUX_jnlFd))
+    {
+        // The record may be cut short, start over with a checkpoint
+        NV_LINUX_assert(false, "NV_LINUX: cannot write the journal file", false);
+        NV_LINUX_checkpoint();
+        return;
+    }
+    NV_LINUX_jnlSize += len;
+    NV_LINUX_stats.saves++;
+    NV_LINUX_clearDirty();
+
+    if (NV_LINUX_jnlSize > NV_LINUX_journalMax)
+    {
+        NV_LINUX_checkpoint();
+    }
+}
+
+/**
+ * @fn      NV_LINUX_checkpoint
+ *
+ * @brief   Write the NV region to a temporary file, rename it over the image
+ *          file and remove the journal
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+void NV_LINUX_checkpoint(void)
+{
+    char tmpPath[PATH_MAX];
+    char jnlPath[PATH_MAX];
+    bool ok;
+    int fd;
+
+    if ((NV_LINUX_imageFile == NULL) ||
+        !NV_LINUX_path(tmpPath, NV_LINUX_TMP_SUFFIX) ||
+        !NV_LINUX_path(jnlPath, NV_LINUX_JNL_SUFFIX))
+    {
+        return;
+    }
+
+    fd = open(tmpPath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+    {
+        NV_LINUX_assert(false, "NV_LINUX: cannot open the image file", false);
+        return;
+    }
+    ok = NV_LINUX_writeFile(fd, &NV_LINUX_flash[0][0], NV_LINUX_REGION_SIZE) &&
+         NV_LINUX_syncFile(fd);
+    close(fd);
+    if (!ok)
+    {
+        NV_LINUX_assert(false, "NV_LINUX: cannot write the image file", false);
+        (void)unlink(tmpPath);
+        return;
+    }
+
+    // The image file and its journal stay valid until the rename
+    if (NV_LINUX_checkSaveCut())
+    {
+        _exit(NV_LINUX_POWERCUT_EXIT);
+    }
+    if (rename(tmpPath, NV_LINUX_imageFile) != 0)
+    {
+        NV_LINUX_assert(false, "NV_LINUX: cannot rename the image file", false);
+        (void)unlink(tmpPath);
+        return;
+    }
+    NV_LINUX_syncDir();
+    NV_LINUX_baseCrc = NV_LINUX_crc32(0, &NV_LINUX_flash[0][0], NV_LINUX_REGION_SIZE);
+
+    // The journal now applies to another image and is ignored by a load
+    if (NV_LINUX_checkSaveCut())
+    {
+        _exit(NV_LINUX_POWERCUT_EXIT);
+    }
+    NV_LINUX_closeJournal();
+    (void)unlink(jnlPath);
+
+    NV_LINUX_stats.checkpoints++;
+    NV_LINUX_clearDirty();
+}
+
+/**
+ * @fn      NV_LINUX_removeImage
+ *
+ * @brief   Remove the image file and its journal
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+void NV_LINUX_removeImage(void)
+{
+    char path[PATH_MAX];
+
+    NV_LINUX_closeJournal();
+    if (NV_LINUX_imageFile == NULL)
+    {
+        return;
+    }
+
+    (void)unlink(NV_LINUX_imageFile);
+    if (NV_LINUX_path(path, NV_LINUX_JNL_SUFFIX))
+    {
+        (void)unlink(path);
+    }
+    if (NV_LINUX_path(path, NV_LINUX_TMP_SUFFIX))
+    {
+        (void)unlink(path);
+    }
+}
+
+/**
+ * @fn      NV_LINUX_setPowerCut
+ *
+ * @brief   Select the program or erase at which power is lost
+ *
+ * @param   flashOps - 1 for the next program or erase, 0 for none
+ *
+ * @return  none
+ */
+void NV_LINUX_setPowerCut(uint32_t flashOps)
+{
+    NV_LINUX_powerCut = flashOps;
+}
+
+/**
+ * @fn      NV_LINUX_setSaveCut
+ *
+ * @brief   Select the file operation of a save at which the process stops
+ *
+ * @param   fileOps - 1 for the next file operation, 0 for none
+ *
+ * @return  none
+ */
+void NV_LINUX_setSaveCut(uint32_t fileOps)
+{
+    NV_LINUX_saveCut = fileOps;
+}
+
+/**
+ * @fn      NV_LINUX_getStats
+ *
+ * @brief   Copy the activity counters of the simulated device
+ *
+ * @param   pStats - destination of the counters
+ *
+ * @return  none
+ */
+void NV_LINUX_getStats(NV_LINUX_stats_t *pStats)
+{
+    if (pStats != NULL)
+    {
+        memcpy(pStats, &NV_LINUX_stats, sizeof(NV_LINUX_stats_t));
+    }
+}
+
+/**
+ * @fn      NV_LINUX_resetStats
+ *
+ * @brief   Clear the activity counters of the simulated device
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+void NV_LINUX_resetStats(void)
+{
+    memset(&NV_LINUX_stats, 0, sizeof(NV_LINUX_stats_t));
+}
+
+/**
+ * @fn      NV_LINUX_assert
+ *
+ * @brief   NVOCMP_ASSERT()/NVOCMP_ALERT() handler
+ *
+ * @param   cond    - condition, nothing is done when true
+ * @param   message - message to print
+ * @param   fatal   - true for NVOCMP_ASSERT(), false for NVOCMP_ALERT()
+ *
+ * @return  none
+ */
+void NV_LINUX_assert(bool cond, const char *message, bool fatal)
+{
+    if (cond)
+    {
+        return;
+    }
+
+    if (fatal)
+    {
+        NV_LINUX_stats.asserts++;
+        fprintf(stderr, "NVOCMP assert: %s\n", message);
+    }
+    else if (NV_LINUX_verbose)
+    {
+        fprintf(stderr, "NVOCMP alert: %s\n", message);
+    }
+}
@@ -0,0 +1,362 @@
+/******************************************************************************
+
+ @file  nv_linux.h
+
+ @brief Simulated NVS flash device for the Linux build of NVOCMP
+
+ Group: CMCU, LPC
+ Target Device: cc13xx_cc26xx
+
+ ******************************************************************************
+ 
+ Copyright (c) 2019-2026, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ 
+ 
+ *****************************************************************************/
+#ifndef NV_LINUX_H
+#define NV_LINUX_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*
+This module stands in for the TI NVS driver when nvocmp.c is built with
+NV_LINUX. The NV region is NVOCMP_NVPAGES pages of FLASH_PAGE_SIZE bytes in
+RAM, with the rules of the on-chip flash:
+
+- An erase sets every byte of a page to 0xFF.
+- A program can only clear bits. Programming a byte that would need a 0 bit
+  set back to 1 fails, leaves the byte unchanged and is counted as a fault,
+  like a failed NVS_WRITE_POST_VERIFY on target.
+- Every program and erase adds its typical flash time to a busy time
+  counter, so that callers can derive the flash time spent per API call.
+
+The region can be loaded from and saved to an image file, see
+NV_LINUX_setImageFile(), and a power loss in the middle of an NVOCMP call
+can be simulated, see NV_LINUX_setPowerCut().
+
+A save appends the bytes programmed or erased since the previous save to a
+journal next to the image file (<image>.jnl), as one record with a CRC-32,
+so its cost follows the bytes changed, not the NV size. Once the journal is
+longer than NV_LINUX_journalMax, the region is written to <image>.tmp and
+renamed over the image file, and the journal is removed. A load applies the
+journal records that are whole to the image. A process that stops anywhere
+in a save therefore loads the region as of the previous or of this save,
+see NV_LINUX_setSaveCut().
+
+nvocmp.c and nv_linux.c must be built with the same NVOCMP_NVPAGES and
+device family (or FLASH_PAGE_SIZE) defines.
+*/
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <nvintf.h>
+
+//*****************************************************************************
+// Constants and definitions
+//*****************************************************************************
+
+#ifndef NVOCMP_NVPAGES
+#define NVOCMP_NVPAGES      2     //1 ~ 5 are supported
+#endif
+
+// Same page size as nvocmp.c selects for the device family
+#if !defined (FLASH_PAGE_SIZE)
+#if defined(DeviceFamily_CC13X4) || defined(DeviceFamily_CC26X4) || defined(DeviceFamily_CC26X3) || defined(DeviceFamily_CC23X0)
+#define FLASH_PAGE_SIZE  0x800
+#else
+#define FLASH_PAGE_SIZE  0x2000
+#endif
+#endif // FLASH_PAGE_SIZE
+
+// Typical flash program time per 32-bit word, in microseconds
+#ifndef NV_LINUX_PROG_WORD_US
+#define NV_LINUX_PROG_WORD_US   8
+#endif
+
+// Typical flash page erase time, in microseconds
+#ifndef NV_LINUX_ERASE_PAGE_US
+#define NV_LINUX_ERASE_PAGE_US  8000
+#endif
+
+// Default of NV_LINUX_journalMax
+#ifndef NV_LINUX_JOURNAL_MAX
+#define NV_LINUX_JOURNAL_MAX    (4 * FLASH_PAGE_SIZE * NVOCMP_NVPAGES)
+#endif
+
+// Exit status of a process stopped by a simulated power loss
+#define NV_LINUX_POWERCUT_EXIT  3
+
+// NVS status codes returned by the simulated device
+#define NVS_STATUS_SUCCESS      (0)
+#define NVS_STATUS_ERROR        (-1)
+#define NVS_STATUS_INV_OFFSET   (-3)
+
+// Handle of the simulated device, only checked against NULL by NVOCMP
+#define NVS_HANDLE              ((NVS_Handle)&NV_LINUX_attrs)
+
+// Refuse writes and erases while a low supply is simulated
+#define NVOCMP_FLASHACCESS(err) {if (NV_LINUX_lowVoltage) { err = NVINTF_LOWPOWER; }}
+
+#ifndef NVDEBUG
+#define NVOCMP_ASSERT(cond, message)    NV_LINUX_assert((cond), (message), true);
+#define NVOCMP_ALERT(cond, message)     NV_LINUX_assert((cond), (message), false);
+#endif
+
+//*****************************************************************************
+// Typedefs
+//*****************************************************************************
+
+// Attributes of the NV region, as NVS_getAttrs() reports them on target
+typedef struct
+{
+    size_t regionSize;      // Size of the NV region in bytes
+    size_t sectorSize;      // Size of an erase sector in bytes
+} NVS_Attrs;
+
+typedef NVS_Attrs *NVS_Handle;
+
+// Activity counters of the simulated device
+typedef struct
+{
+    uint32_t programs;                  // Program operations
+    uint32_t bytesProgrammed;           // Bytes programmed
+    uint32_t faults;                    // Programs that needed a bit set to 1
+    uint32_t asserts;                   // NVOCMP_ASSERT() failures
+    uint32_t erases[NVOCMP_NVPAGES];    // Erases per page
+    uint64_t busyUs;                    // Typical flash time of all of the above
+    uint32_t saves;                     // Journal records written
+    uint32_t checkpoints;               // Journals folded into the image file
+    uint32_t fileSyncs;                 // fsync() calls
+    uint64_t fileBytes;                 // Bytes written to the image and journal files
+} NV_LINUX_stats_t;
+
+//*****************************************************************************
+// Global Variables
+//*****************************************************************************
+
+extern NVS_Attrs NV_LINUX_attrs;
+
+// Set to make NVOCMP refuse writes and erases with NVINTF_LOWPOWER
+extern bool NV_LINUX_lowVoltage;
+
+// Set to print NVOCMP_ALERT() messages on stderr
+extern bool NV_LINUX_verbose;
+
+// Set, the default, to fsync() every save, so that it survives a host crash.
+// Clear, a save only survives a crash of the process.
+extern bool NV_LINUX_syncWrites;
+
+// Journal length in bytes above which a save folds it into the image file,
+// 0 to write the full image file at every save
+extern uint32_t NV_LINUX_journalMax;
+
+//*****************************************************************************
+// Functions
+//*****************************************************************************
+
+/**
+ * @fn      NV_LINUX_setImageFile
+ *
+ * @brief   Select the image file that NV_LINUX_init() loads the NV region
+ *          from and NV_LINUX_save() writes it to. Without an image file the
+ *          region only lives in RAM.
+ *
+ * @param   path - image file path, NULL for none
+ *
+ * @return  none
+ */
+extern void NV_LINUX_setImageFile(const char *path);
+
+/**
+ * @fn      NV_LINUX_init
+ *
+ * @brief   Load the NV region from the image file and apply its journal, or
+ *          erase it when there is no image file or the file does not hold a
+ *          full region
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+extern void NV_LINUX_init(void);
+
+/**
+ * @fn      NV_LINUX_read
+ *
+ * @brief   Read from the NV region
+ *
+ * @param   pg   - page to read from
+ * @param   off  - offset in the page
+ * @param   pBuf - destination buffer
+ * @param   len  - number of bytes to read
+ *
+ * @return  none
+ */
+extern void NV_LINUX_read(uint8_t pg, uint16_t off, uint8_t *pBuf, uint16_t len);
+
+/**
+ * @fn      NV_LINUX_write
+ *
+ * @brief   Program the NV region, clearing bits only
+ *
+ * @param   pg   - page to program
+ * @param   off  - offset in the page
+ * @param   pBuf - data to program
+ * @param   len  - number of bytes to program
+ *
+ * @return  NVS_STATUS_SUCCESS, NVS_STATUS_INV_OFFSET when the range is
+ *          outside the page, NVS_STATUS_ERROR when a byte needs a bit set
+ */
+extern int_fast16_t NV_LINUX_write(uint8_t pg, uint16_t off, uint8_t *pBuf, uint16_t len);
+
+/**
+ * @fn      NV_LINUX_erase
+ *
+ * @brief   Erase a page of the NV region to 0xFF
+ *
+ * @param   pg - page to erase
+ *
+ * @return  NVS_STATUS_SUCCESS or NVS_STATUS_INV_OFFSET
+ */
+extern int_fast16_t NV_LINUX_erase(uint8_t pg);
+
+/**
+ * @fn      NV_LINUX_save
+ *
+ * @brief   Append the bytes changed since the last save to the journal of
+ *          the image file, if one is selected, and fold the journal into
+ *          the image file once it is longer than NV_LINUX_journalMax
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+extern void NV_LINUX_save(void);
+
+/**
+ * @fn      NV_LINUX_checkpoint
+ *
+ * @brief   Write the NV region to the image file through a temporary file
+ *          and a rename, and remove the journal
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+extern void NV_LINUX_checkpoint(void);
+
+/**
+ * @fn      NV_LINUX_removeImage
+ *
+ * @brief   Remove the image file and its journal, the next load starts blank
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+extern void NV_LINUX_removeImage(void);
+
+/**
+ * @fn      NV_LINUX_setPowerCut
+ *
+ * @brief   Simulate a power loss. The selected program or erase is not
+ *          done, the NV region is saved to the image file as it is and the
+ *          process exits with NV_LINUX_POWERCUT_EXIT, so that a new process
+ *          can initialize NVOCMP from the image like a device after reset.
+ *
+ * @param   flashOps - 1 for the next program or erase, 0 for none
+ *
+ * @return  none
+ */
+extern void NV_LINUX_setPowerCut(uint32_t flashOps);
+
+/**
+ * @fn      NV_LINUX_setSaveCut
+ *
+ * @brief   Simulate a process killed in the middle of a save. At the
+ *          selected file operation (a journal or image file write, the
+ *          rename of the image file or the removal of the journal) a write
+ *          is cut to half of its bytes, and the process exits with
+ *          NV_LINUX_POWERCUT_EXIT.
+ *
+ * @param   fileOps - 1 for the next file operation, 0 for none
+ *
+ * @return  none
+ */
+extern void NV_LINUX_setSaveCut(uint32_t fileOps);
+
+/**
+ * @fn      NV_LINUX_getStats
+ *
+ * @brief   Copy the activity counters of the simulated device
+ *
+ * @param   pStats - destination of the counters
+ *
+ * @return  none
+ */
+extern void NV_LINUX_getStats(NV_LINUX_stats_t *pStats);
+
+/**
+ * @fn      NV_LINUX_resetStats
+ *
+ * @brief   Clear the activity counters of the simulated device
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+extern void NV_LINUX_resetStats(void);
+
+/**
+ * @fn      NV_LINUX_assert
+ *
+ * @brief   NVOCMP_ASSERT()/NVOCMP_ALERT() handler. A failed assert is
+ *          printed and counted, a failed alert is printed in verbose mode.
+ *
+ * @param   cond    - condition, nothing is done when true
+ * @param   message - message to print
+ * @param   fatal   - true for NVOCMP_ASSERT(), false for NVOCMP_ALERT()
+ *
+ * @return  none
+ */
+extern void NV_LINUX_assert(bool cond, const char *message, bool fatal);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NV_LINUX_H */
@@ -0,0 +1,342 @@
+/******************************************************************************
+
+ @file  nv_linux_bench.c
+
+ @brief NV_LINUX item write throughput benchmark
+
+ Group: CMCU, LPC
+ Target Device: cc13xx_cc26xx
+
+ ******************************************************************************
+ 
+ Copyright (c) 2019-2026, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ 
+ 
+ *****************************************************************************/
+
+/*
+Measures how many NVOCMP item writes per second the Linux build sustains
+with the simulated flash of nv_linux.c saved to an image file, the way a
+gateway or simulation build runs. Every write is followed by a save, and
+each configuration is run:
+
+- image: NV_LINUX_journalMax 0, every save writes the full image to a
+  temporary file and renames it over the image file, O(NV size) per write
+- journal: the default NV_LINUX_journalMax, every save appends the bytes the
+  write changed to the journal, folded into the image every few writes
+
+both without and with an fsync() per save. The workload rewrites frame
+counter sized items, as the stack does for NWK security material and trust
+center link keys. Per configuration the benchmark reports writes per second,
+bytes written to files and fsync() calls per write, and checkpoints. After
+each run NVOCMP is initialized again from the files and every item is read
+back, the exit status is 1 when one has other data.
+
+Build and run from the repository root:
+
+  cc -O2 -DNV_LINUX -DNVOCMP_POSIX_MUTEX \
+      -Idrivers/nv/host -Idrivers/nv -o nv_linux_bench \
+      drivers/nv/host/nv_linux_bench.c drivers/nv/host/nv_linux.c \
+      drivers/nv/nvocmp.c drivers/nv/crc.c -lpthread
+  ./nv_linux_bench -h
+
+Run it with the image file on the file system the build will use, the fsync
+figures depend on it.
+*/
+
+//*****************************************************************************
+// Includes
+//*****************************************************************************
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <nvocmp.h>
+#include "nv_linux.h"
+
+//*****************************************************************************
+// Constants and Definitions
+//*****************************************************************************
+
+#define BENCH_ITEM_ID           0x0007
+#define BENCH_ITEMS             16
+#define BENCH_MIN_LEN           12
+#define BENCH_MAX_LEN           20
+
+#define BENCH_OPS               5000
+#define BENCH_SYNC_OPS          500
+
+#define BENCH_IMAGE_FILE        "nv_linux_bench.img"
+
+//*****************************************************************************
+// Typedefs
+//*****************************************************************************
+
+// Save configuration
+typedef struct
+{
+    const char *name;
+    uint32_t    journalMax;     // NV_LINUX_journalMax
+} bench_mode_t;
+
+//*****************************************************************************
+// Local Variables
+//*****************************************************************************
+
+static const bench_mode_t benchModes[] =
+{
+    {"image",   0},
+    {"journal", NV_LINUX_JOURNAL_MAX},
+};
+
+static NVINTF_nvFuncts_t benchNv;
+static uint32_t benchSeed = 1;
+static uint8_t benchData[BENCH_ITEMS][BENCH_MAX_LEN];
+static uint8_t benchLen[BENCH_ITEMS];
+static bool benchFailed = false;
+
+//*****************************************************************************
+// Local Functions
+//*****************************************************************************
+
+/**
+ * @fn      benchRand
+ *
+ * @brief   xorshift32 pseudo random number, reproducible per seed
+ *
+ * @param   none
+ *
+ * @return  random number
+ */
+static uint32_t benchRand(void)
+{
+    benchSeed ^= benchSeed << 13;
+    benchSeed ^= benchSeed >> 17;
+    benchSeed ^= benchSeed << 5;
+    return(benchSeed);
+}
+
+static uint64_t benchNowNs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return((uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec);
+}
+
+static NVINTF_itemID_t benchItem(uint16_t idx)
+{
+    NVINTF_itemID_t id;
+
+    id.systemID = NVINTF_SYSID_ZSTACK;
+    id.itemID = BENCH_ITEM_ID;
+    id.subID = idx;
+    return(id);
+}
+
+/**
+ * @fn      benchInit
+ *
+ * @brief   Initialize NVOCMP from the image file
+ *
+ * @param   none
+ *
+ * @return  true if NVOCMP initialized
+ */
+static bool benchInit(void)
+{
+    NVOCMP_loadApiPtrs(&benchNv);
+    return(benchNv.initNV(NULL) == NVINTF_SUCCESS);
+}
+
+/**
+ * @fn      benchVerify
+ *
+ * @brief   Initialize NVOCMP again from the files and read every item back
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+static void benchVerify(void)
+{
+    uint8_t buf[BENCH_MAX_LEN];
+    uint16_t idx;
+
+    if (!benchInit())
+    {
+        printf("initNV from the image file failed\n");
+        benchFailed = true;
+        return;
+    }
+
+    for (idx = 0; idx < BENCH_ITEMS; idx++)
+    {
+        if (benchLen[idx] == 0)
+        {
+            // Not written in this run
+            continue;
+        }
+        if ((benchNv.readItem(benchItem(idx), 0, benchLen[idx], buf) != NVINTF_SUCCESS) ||
+            (memcmp(buf, benchData[idx], benchLen[idx]) != 0))
+        {
+            printf("item %u read other data than written\n", idx);
+            benchFailed = true;
+        }
+    }
+}
+
+/**
+ * @fn      benchRun
+ *
+ * @brief   Run the workload in a save configuration and print its line
+ *
+ * @param   pMode - save configuration
+ * @param   sync  - fsync() every save
+ * @param   ops   - item writes
+ *
+ * @return  none
+ */
+static void benchRun(const bench_mode_t *pMode, bool sync, uint32_t ops)
+{
+    NV_LINUX_stats_t stats;
+    uint64_t startNs;
+    uint64_t ns;
+    uint32_t op;
+    uint16_t idx;
+    uint8_t i;
+
+    NV_LINUX_removeImage();
+    NV_LINUX_journalMax = pMode->journalMax;
+    NV_LINUX_syncWrites = sync;
+    if (!benchInit())
+    {
+        printf("initNV failed\n");
+        benchFailed = true;
+        return;
+    }
+    NV_LINUX_resetStats();
+
+    startNs = benchNowNs();
+    for (op = 0; op < ops; op++)
+    {
+        idx = (uint16_t)(benchRand() % BENCH_ITEMS);
+        benchLen[idx] = (uint8_t)(BENCH_MIN_LEN + benchRand() % (BENCH_MAX_LEN - BENCH_MIN_LEN + 1));
+        for (i = 0; i < benchLen[idx]; i++)
+        {
+            benchData[idx][i] = (uint8_t)benchRand();
+        }
+        if (benchNv.writeItem(benchItem(idx), benchLen[idx], benchData[idx]) != NVINTF_SUCCESS)
+        {
+            printf("writeItem failed\n");
+            benchFailed = true;
+            return;
+        }
+    }
+    ns = benchNowNs() - startNs;
+    NV_LINUX_getStats(&stats);
+
+    printf("%-8s %-5s %8u %11.0f %12.1f %10.2f %11u\n",
+           pMode->name, sync ? "yes" : "no", ops,
+           ns ? (double)ops * 1e9 / ns : 0.0,
+           (double)stats.fileBytes / ops, (double)stats.fileSyncs / ops,
+           stats.checkpoints);
+
+    benchVerify();
+}
+
+static void benchUsage(const char *prog)
+{
+    printf("Usage: %s [options]\n"
+           "  -n <ops>    item writes per run without fsync(), default %u\n"
+           "  -y <ops>    item writes per run with fsync(), default %u, 0 to skip\n"
+           "  -s <seed>   random seed, default 1\n"
+           "  -i <file>   image file, default %s\n"
+           "  -h          this help\n"
+           "%u NV pages of %u bytes\n",
+           prog, BENCH_OPS, BENCH_SYNC_OPS, BENCH_IMAGE_FILE,
+           NVOCMP_NVPAGES, FLASH_PAGE_SIZE);
+}
+
+int main(int argc, char *argv[])
+{
+    const char *pImage = BENCH_IMAGE_FILE;
+    uint32_t ops = BENCH_OPS;
+    uint32_t syncOps = BENCH_SYNC_OPS;
+    uint32_t seed;
+    uint8_t m;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:y:s:i:h")) != -1)
+    {
+        switch (opt)
+        {
+            case 'n': ops = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'y': syncOps = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 's': benchSeed = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'i': pImage = optarg; break;
+            case 'h': benchUsage(argv[0]); return(0);
+            default:  benchUsage(argv[0]); return(2);
+        }
+    }
+    if ((benchSeed == 0) || (ops == 0))
+    {
+        fprintf(stderr, "seed and -n must not be 0\n");
+        return(2);
+    }
+    seed = benchSeed;
+
+    printf("NV_LINUX save benchmark: %u NV pages of %u bytes, image %s, seed %u\n\n",
+           NVOCMP_NVPAGES, FLASH_PAGE_SIZE, pImage, seed);
+    printf("save     fsync   writes    writes/s  file B/write  syncs/write checkpoints\n");
+
+    NV_LINUX_setImageFile(pImage);
+    for (m = 0; m < sizeof(benchModes) / sizeof(benchModes[0]); m++)
+    {
+        benchSeed = seed;
+        memset(benchLen, 0, sizeof(benchLen));
+        benchRun(&benchModes[m], false, ops);
+        if (syncOps != 0)
+        {
+            benchSeed = seed;
+            memset(benchLen, 0, sizeof(benchLen));
+            benchRun(&benchModes[m], true, syncOps);
+        }
+    }
+    NV_LINUX_removeImage();
+
+    return(benchFailed ? 1 : 0);
+}
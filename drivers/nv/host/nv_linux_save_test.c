@@ -0,0 +1,492 @@
+/******************************************************************************
+
+ @file  nv_linux_save_test.c
+
+ @brief NV_LINUX save crash consistency test
+
+ Group: CMCU, LPC
+ Target Device: cc13xx_cc26xx
+
+ ******************************************************************************
+ 
+ Copyright (c) 2019-2026, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ 
+ 
+ *****************************************************************************/
+
+/*
+Stops processes in the middle of NV_LINUX_save() and checks that the NV
+items loaded by the next process are the ones saved before. A child process
+runs random NVOCMP item writes and deletes on the simulated flash of
+nv_linux.c, each call appending a record to the journal of the image file,
+and the journal being folded into the image file every few calls. The child
+is stopped in one of two ways:
+
+- NV_LINUX_setSaveCut() makes a chosen journal write, image write, image
+  rename or journal removal stop the process, the write cut to half of its
+  bytes
+- the test kills the child with SIGKILL after a random delay
+
+Another child then initializes NVOCMP from the image file and its journal,
+as a gateway does after a restart, and reads every item back:
+
+- an item written or deleted by a completed call must read as it was left
+- the item of the call that was stopped may read as before or after the call
+- no program may need a bit set and no NVOCMP assert may fire
+
+The next child goes on from the files left, so a journal cut short, a stale
+journal and a left over temporary image are all loaded again.
+
+Build and run from the repository root:
+
+  cc -O2 -DNV_LINUX -DNVOCMP_POSIX_MUTEX \
+      -Idrivers/nv/host -Idrivers/nv -o nv_linux_save_test \
+      drivers/nv/host/nv_linux_save_test.c drivers/nv/host/nv_linux.c \
+      drivers/nv/nvocmp.c drivers/nv/crc.c -lpthread
+  ./nv_linux_save_test -h
+*/
+
+//*****************************************************************************
+// Includes
+//*****************************************************************************
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <nvocmp.h>
+#include "nv_linux.h"
+
+//*****************************************************************************
+// Constants and Definitions
+//*****************************************************************************
+
+#define TEST_ITEM_ID            0x0100
+#define TEST_ITEMS              48
+#define TEST_MAX_LEN            24
+
+#define TEST_STOPS              400
+#define TEST_MAX_CUT            200
+#define TEST_MAX_KILL_US        3000
+
+// Journal length that makes the saves fold the journal every few calls
+#define TEST_JOURNAL_MAX        1024
+
+// Calls a device runs when it is not stopped
+#define TEST_MAX_CALLS          100000
+
+#define TEST_IMAGE_FILE         "nv_linux_save_test.img"
+
+// Seconds after which a process is taken as hung
+#define TEST_TIMEOUT_S          60
+
+//*****************************************************************************
+// Typedefs
+//*****************************************************************************
+
+// Value of an item
+typedef struct
+{
+    uint8_t len;                    // 0 when the item does not exist
+    uint8_t data[TEST_MAX_LEN];
+} test_item_t;
+
+// State shared by the test and the device processes
+typedef struct
+{
+    test_item_t items[TEST_ITEMS];  // Values left by completed calls
+    int16_t     pendIdx;            // Item of the call in progress, -1 if none
+    test_item_t pend;               // Its value if the call completes
+    uint32_t    calls;              // Calls completed
+} test_shared_t;
+
+//*****************************************************************************
+// Local Variables
+//*****************************************************************************
+
+static NVINTF_nvFuncts_t testNv;
+static test_shared_t *pTest;
+static uint32_t testSeed = 1;
+static uint32_t testJournalMax = TEST_JOURNAL_MAX;
+
+//*****************************************************************************
+// Local Functions
+//*****************************************************************************
+
+/**
+ * @fn      testRand
+ *
+ * @brief   xorshift32 pseudo random number, reproducible per seed
+ *
+ * @param   none
+ *
+ * @return  random number
+ */
+static uint32_t testRand(void)
+{
+    testSeed ^= testSeed << 13;
+    testSeed ^= testSeed >> 17;
+    testSeed ^= testSeed << 5;
+    return(testSeed);
+}
+
+static NVINTF_itemID_t testId(uint16_t idx)
+{
+    NVINTF_itemID_t id;
+
+    id.systemID = NVINTF_SYSID_APP;
+    id.itemID = TEST_ITEM_ID;
+    id.subID = idx;
+    return(id);
+}
+
+/**
+ * @fn      testInit
+ *
+ * @brief   Initialize NVOCMP from the image file, as after a restart
+ *
+ * @param   pImage - image file
+ *
+ * @return  true if NVOCMP initialized
+ */
+static bool testInit(const char *pImage)
+{
+    NV_LINUX_setImageFile(pImage);
+    NV_LINUX_journalMax = testJournalMax;
+    NVOCMP_loadApiPtrs(&testNv);
+    return(testNv.initNV(NULL) == NVINTF_SUCCESS);
+}
+
+/**
+ * @fn      testFlashOk
+ *
+ * @brief   Check that no program needed a bit set and no assert fired
+ *
+ * @param   none
+ *
+ * @return  true if so
+ */
+static bool testFlashOk(void)
+{
+    NV_LINUX_stats_t stats;
+
+    NV_LINUX_getStats(&stats);
+    if (stats.faults || stats.asserts)
+    {
+        printf("%u program faults, %u NVOCMP asserts\n", stats.faults, stats.asserts);
+        return(false);
+    }
+    return(true);
+}
+
+/**
+ * @fn      testDevice
+ *
+ * @brief   Device process: random writes and deletes until it is stopped
+ *
+ * @param   pImage - image file
+ * @param   cut    - file operation at which the process stops, 0 for none
+ *
+ * @return  process exit status
+ */
+static int testDevice(const char *pImage, uint32_t cut)
+{
+    uint32_t calls;
+
+    if (!testInit(pImage))
+    {
+        printf("initNV failed\n");
+        return(1);
+    }
+
+    NV_LINUX_setSaveCut(cut);
+    for (calls = 0; calls < TEST_MAX_CALLS; calls++)
+    {
+        uint16_t idx = testRand() % TEST_ITEMS;
+        test_item_t *pItem = &pTest->items[idx];
+        uint8_t status;
+        uint8_t i;
+
+        if (((testRand() % 4) != 0) || (pItem->len == 0))
+        {
+            pTest->pend.len = (uint8_t)(1 + testRand() % TEST_MAX_LEN);
+            for (i = 0; i < pTest->pend.len; i++)
+            {
+                pTest->pend.data[i] = (uint8_t)testRand();
+            }
+            pTest->pendIdx = (int16_t)idx;
+            status = testNv.writeItem(testId(idx), pTest->pend.len, pTest->pend.data);
+        }
+        else
+        {
+            pTest->pend.len = 0;
+            pTest->pendIdx = (int16_t)idx;
+            status = testNv.deleteItem(testId(idx));
+        }
+
+        if (status != NVINTF_SUCCESS)
+        {
+            printf("call on item %u failed: %u\n", idx, status);
+            return(1);
+        }
+        *pItem = pTest->pend;
+        pTest->pendIdx = -1;
+        pTest->calls++;
+
+        if (!testFlashOk())
+        {
+            return(1);
+        }
+    }
+
+    return(0);
+}
+
+/**
+ * @fn      testCheckItem
+ *
+ * @brief   Check an item after a restart against one of its expected values
+ *
+ * @param   idx       - item
+ * @param   pExpected - expected value
+ *
+ * @return  true if the item has that value
+ */
+static bool testCheckItem(uint16_t idx, const test_item_t *pExpected)
+{
+    uint8_t buf[TEST_MAX_LEN];
+    uint32_t len = testNv.getItemLen(testId(idx));
+
+    if (len != pExpected->len)
+    {
+        return(false);
+    }
+    if (len == 0)
+    {
+        return(true);
+    }
+    return((testNv.readItem(testId(idx), 0, (uint16_t)len, buf) == NVINTF_SUCCESS) &&
+           (memcmp(buf, pExpected->data, len) == 0));
+}
+
+/**
+ * @fn      testRestart
+ *
+ * @brief   Process of a restarted device: read back every item
+ *
+ * @param   pImage - image file
+ * @param   cut    - unused
+ *
+ * @return  process exit status
+ */
+static int testRestart(const char *pImage, uint32_t cut)
+{
+    uint16_t idx;
+
+    (void)cut;
+    if (!testInit(pImage))
+    {
+        printf("initNV after the restart failed\n");
+        return(1);
+    }
+
+    for (idx = 0; idx < TEST_ITEMS; idx++)
+    {
+        if (testCheckItem(idx, &pTest->items[idx]))
+        {
+            continue;
+        }
+        if ((idx == pTest->pendIdx) && testCheckItem(idx, &pTest->pend))
+        {
+            // The call that was stopped had saved
+            pTest->items[idx] = pTest->pend;
+            continue;
+        }
+        printf("item %u has another value than saved before the restart: len %u, expected %u%s\n",
+               idx, testNv.getItemLen(testId(idx)), pTest->items[idx].len,
+               (idx == pTest->pendIdx) ? " (call in progress)" : "");
+        return(1);
+    }
+    pTest->pendIdx = -1;
+
+    return(testFlashOk() ? 0 : 1);
+}
+
+/**
+ * @fn      testRun
+ *
+ * @brief   Run a function in a child process, and kill it after a delay
+ *
+ * @param   pfn     - function
+ * @param   pImage  - image file
+ * @param   cut     - file operation at which testDevice() stops
+ * @param   killUs  - delay after which the child is killed, 0 for none
+ *
+ * @return  exit status of the child, NV_LINUX_POWERCUT_EXIT if it was
+ *          killed, -1 if it did not exit
+ */
+static int testRun(int (*pfn)(const char *, uint32_t), const char *pImage,
+                   uint32_t cut, uint32_t killUs)
+{
+    pid_t pid;
+    int status;
+
+    fflush(stdout);
+    pid = fork();
+    if (pid == 0)
+    {
+        (void)alarm(TEST_TIMEOUT_S);
+        exit(pfn(pImage, cut));
+    }
+    if (pid < 0)
+    {
+        return(-1);
+    }
+
+    if (killUs != 0)
+    {
+        (void)usleep(killUs);
+        (void)kill(pid, SIGKILL);
+    }
+    if (waitpid(pid, &status, 0) != pid)
+    {
+        return(-1);
+    }
+    if ((killUs != 0) && WIFSIGNALED(status) && (WTERMSIG(status) == SIGKILL))
+    {
+        return(NV_LINUX_POWERCUT_EXIT);
+    }
+    return(WIFEXITED(status) ? WEXITSTATUS(status) : -1);
+}
+
+static void testUsage(const char *prog)
+{
+    printf("Usage: %s [options]\n"
+           "  -n <num>    stopped processes, default %u, half of them killed\n"
+           "  -f <num>    saves stop within the first <num> file operations\n"
+           "              of a device run, default %u\n"
+           "  -k <us>     processes killed within <us> microseconds, default %u\n"
+           "  -j <bytes>  journal length folded into the image, default %u\n"
+           "  -y          fsync() the saves\n"
+           "  -s <seed>   random seed, default 1\n"
+           "  -i <file>   image file, default %s\n"
+           "  -h          this help\n"
+           "%u NV pages of %u bytes\n",
+           prog, TEST_STOPS, TEST_MAX_CUT, TEST_MAX_KILL_US, TEST_JOURNAL_MAX,
+           TEST_IMAGE_FILE, NVOCMP_NVPAGES, FLASH_PAGE_SIZE);
+}
+
+int main(int argc, char *argv[])
+{
+    const char *pImage = TEST_IMAGE_FILE;
+    uint32_t stops = TEST_STOPS;
+    uint32_t maxCut = TEST_MAX_CUT;
+    uint32_t maxKillUs = TEST_MAX_KILL_US;
+    uint32_t killed = 0;
+    uint32_t seed;
+    uint32_t n;
+    int status;
+    int opt;
+
+    NV_LINUX_syncWrites = false;
+    while ((opt = getopt(argc, argv, "n:f:k:j:ys:i:h")) != -1)
+    {
+        switch (opt)
+        {
+            case 'n': stops = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'f': maxCut = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'k': maxKillUs = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'j': testJournalMax = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'y': NV_LINUX_syncWrites = true; break;
+            case 's': testSeed = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'i': pImage = optarg; break;
+            case 'h': testUsage(argv[0]); return(0);
+            default:  testUsage(argv[0]); return(2);
+        }
+    }
+    if ((testSeed == 0) || (maxCut == 0) || (maxKillUs == 0))
+    {
+        fprintf(stderr, "seed, -f and -k must not be 0\n");
+        return(2);
+    }
+    seed = testSeed;
+
+    pTest = mmap(NULL, sizeof(test_shared_t), PROT_READ | PROT_WRITE,
+                 MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (pTest == MAP_FAILED)
+    {
+        fprintf(stderr, "mmap failed\n");
+        return(2);
+    }
+    memset(pTest, 0, sizeof(test_shared_t));
+    pTest->pendIdx = -1;
+
+    // Start from blank flash
+    NV_LINUX_setImageFile(pImage);
+    NV_LINUX_removeImage();
+
+    for (n = 0; n < stops; n++)
+    {
+        // Every device run draws other calls
+        (void)testRand();
+        if (n & 1)
+        {
+            killed++;
+            status = testRun(testDevice, pImage, 0, 1 + testRand() % maxKillUs);
+        }
+        else
+        {
+            status = testRun(testDevice, pImage, 1 + testRand() % maxCut, 0);
+        }
+        if (status != NV_LINUX_POWERCUT_EXIT)
+        {
+            printf("stop %u: device run ended with status %d (-s %u)\n", n, status, seed);
+            return(1);
+        }
+
+        if (testRun(testRestart, pImage, 0, 0) != 0)
+        {
+            printf("stop %u: items wrong after the restart (-s %u)\n", n, seed);
+            return(1);
+        }
+    }
+
+    printf("%u saves stopped, %u processes killed, %u calls: passed\n",
+           stops - killed, killed, pTest->calls);
+    NV_LINUX_removeImage();
+    return(0);
+}
@@ -0,0 +1,851 @@
+/******************************************************************************
+
+ @file  nvocmp_bench.c
+
+ @brief NVOCMP benchmark replaying Z-Stack NV item workloads
+
+ Group: CMCU, LPC
+ Target Device: cc13xx_cc26xx
+
+ ******************************************************************************
+ 
+ Copyright (c) 2019-2026, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ 
+ 
+ *****************************************************************************/
+
+/*
+Replays Z-Stack NV item workloads through the NVOCMP API on the simulated
+flash of nv_linux.c, and reports per workload:
+
+- bytes programmed, program faults and erases per page (nv_linux.c)
+- item bytes written through the API, write amplification, compactions and
+  item header reads per API call (NVOCMP_PERFSTATS)
+- per-API latency percentiles, as host CPU time and as typical flash time
+  (NV_LINUX_PROG_WORD_US, NV_LINUX_ERASE_PAGE_US)
+- with NVOCMP_INCCOMPACT and -c, the same for the background compaction
+  steps that ran, NVOCMP_compactStep() being called every few operations
+
+Workloads, with the item IDs and sizes the stack uses through osal_nv:
+
+- binding: binding table slots (ZCD_NV_EX_BINDING_TABLE, BindingEntry_t)
+  rewritten one at a time, lookups, and a full table restore every 500 ops
+- framecounter: NWK security material (ZCD_NV_EX_NWK_SEC_MATERIAL_TABLE)
+  saved every NWK_FRAMECOUNTER_CHANGES_RESTORE_DELTA frames
+- tclk: trust center link key entries (ZCD_NV_EX_TCLK_TABLE) of joining
+  devices written, deleted when they leave, and their frame counters updated
+- mixed: the three interleaved
+
+Every workload starts from an erased NV region. Statistics are taken after
+the workload has created its initial items. Every read is checked against
+the last value written, and every item is read back at the end of a
+workload. The exit status is 1 when an API call failed, a read returned
+other data, a program needed a bit set or an NVOCMP assert fired, so the
+benchmark can gate NV changes.
+
+Build and run from the repository root, with the NVOCMP defines to test:
+
+  cc -O2 -DNV_LINUX -DNVOCMP_POSIX_MUTEX -DNVOCMP_PERFSTATS \
+      -Idrivers/nv/host -Idrivers/nv -o nvocmp_bench \
+      drivers/nv/host/nvocmp_bench.c drivers/nv/host/nv_linux.c \
+      drivers/nv/nvocmp.c drivers/nv/crc.c -lpthread
+  ./nvocmp_bench -h
+
+Add -DNVOCMP_NVPAGES=<n> to change the number of NV pages, and
+-DNVOCMP_INCCOMPACT to measure background compaction.
+*/
+
+//*****************************************************************************
+// Includes
+//*****************************************************************************
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <nvocmp.h>
+#include "nv_linux.h"
+
+#ifndef NVOCMP_PERFSTATS
+#error "nvocmp_bench needs NVOCMP_PERFSTATS"
+#endif
+
+//*****************************************************************************
+// Constants and Definitions
+//*****************************************************************************
+
+// Z-Stack extended NV item IDs (zcomdef.h)
+#define BENCH_NV_EX_BINDING_TABLE           0x0002
+#define BENCH_NV_EX_TCLK_TABLE              0x0004
+#define BENCH_NV_EX_NWK_SEC_MATERIAL_TABLE  0x0007
+
+// Item sizes: BindingEntry_t with 4 cluster IDs, APSME_TCLKDevEntry_t,
+// nwkSecMaterialDesc_t
+#define BENCH_BINDING_LEN       14
+#define BENCH_TCLK_LEN          20
+#define BENCH_SECMAT_LEN        12
+
+// Defaults of NWK_MAX_BINDING_ENTRIES and ZDSECMGR_TC_DEVICE_MAX
+#define BENCH_BINDINGS          32
+#define BENCH_TCLK_DEVICES      40
+
+// Frames sent between frame counter saves
+#define BENCH_FRAMECOUNTER_DELTA    1250
+
+// Ops between full binding table restores
+#define BENCH_RESTORE_PERIOD    500
+
+#define BENCH_OPS               20000
+
+// APIs with latency samples
+#define BENCH_API_WRITE         0
+#define BENCH_API_READ          1
+#define BENCH_API_DELETE        2
+#define BENCH_API_STEP          3
+#define BENCH_API_NUM           4
+
+// Largest item
+#define BENCH_MAX_LEN           BENCH_TCLK_LEN
+
+// Free bytes below which background compaction steps run, as
+// ZS_NV_COMPACT_MIN_FREE in zstacktask.c
+#define BENCH_MIN_FREE          1024
+
+//*****************************************************************************
+// Typedefs
+//*****************************************************************************
+
+// Latency samples of an API
+typedef struct
+{
+    uint32_t  num;          // Samples taken
+    uint32_t  max;          // Room in the sample arrays
+    uint32_t *pCpuNs;       // Host CPU time of each call, ns
+    uint32_t *pFlashUs;     // Typical flash time of each call, us
+} bench_api_t;
+
+typedef void (*bench_setupFn)(void);
+typedef void (*bench_opFn)(uint32_t op);
+
+typedef struct
+{
+    const char    *name;
+    bench_setupFn  pfnSetup;    // Creates the initial items
+    bench_opFn     pfnOp;       // Runs one operation
+} bench_workload_t;
+
+//*****************************************************************************
+// Local Variables
+//*****************************************************************************
+
+static NVINTF_nvFuncts_t benchNv;
+static bench_api_t benchApi[BENCH_API_NUM];
+static const char *benchApiName[BENCH_API_NUM] = {"writeItem", "readItem", "deleteItem",
+                                                   "compactStep"};
+
+static uint32_t benchSeed = 1;
+static uint16_t benchBindings = BENCH_BINDINGS;
+static uint16_t benchTclkDevices = BENCH_TCLK_DEVICES;
+static uint32_t benchFailures;
+static uint32_t benchStepPeriod = 0;
+static uint16_t benchMinFree = BENCH_MIN_FREE;
+
+static uint8_t  benchBinding[256][BENCH_BINDING_LEN];
+static uint8_t  benchTclk[256][BENCH_TCLK_LEN];
+static bool     benchTclkUsed[256];
+static uint32_t benchFrameCounter;
+static bool     benchFrameCounterUsed;
+static bool     benchBindingUsed;
+
+//*****************************************************************************
+// Local Functions
+//*****************************************************************************
+
+/**
+ * @fn      benchRand
+ *
+ * @brief   xorshift32 pseudo random number, reproducible per seed
+ *
+ * @param   none
+ *
+ * @return  random number
+ */
+static uint32_t benchRand(void)
+{
+    benchSeed ^= benchSeed << 13;
+    benchSeed ^= benchSeed >> 17;
+    benchSeed ^= benchSeed << 5;
+    return(benchSeed);
+}
+
+/**
+ * @fn      benchNowNs
+ *
+ * @brief   Monotonic host time
+ *
+ * @param   none
+ *
+ * @return  time in ns
+ */
+static uint64_t benchNowNs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return((uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec);
+}
+
+/**
+ * @fn      benchFlashUs
+ *
+ * @brief   Typical flash time spent so far by the simulated device
+ *
+ * @param   none
+ *
+ * @return  time in us
+ */
+static uint64_t benchFlashUs(void)
+{
+    NV_LINUX_stats_t stats;
+
+    NV_LINUX_getStats(&stats);
+    return(stats.busyUs);
+}
+
+/**
+ * @fn      benchItem
+ *
+ * @brief   Build a Z-Stack item ID
+ *
+ * @param   itemID - extended item ID
+ * @param   subID  - table index
+ *
+ * @return  item ID
+ */
+static NVINTF_itemID_t benchItem(uint16_t itemID, uint16_t subID)
+{
+    NVINTF_itemID_t id;
+
+    id.systemID = NVINTF_SYSID_ZSTACK;
+    id.itemID = itemID;
+    id.subID = subID;
+    return(id);
+}
+
+/**
+ * @fn      benchCall
+ *
+ * @brief   Call an NV API, record its latency and count failures
+ *
+ * @param   api   - BENCH_API_*
+ * @param   id    - item ID
+ * @param   len   - item length
+ * @param   pBuf  - item data
+ *
+ * @return  NVINTF status
+ */
+static uint8_t benchCall(uint8_t api, NVINTF_itemID_t id, uint16_t len, void *pBuf)
+{
+    bench_api_t *pApi = &benchApi[api];
+    uint64_t t0 = benchNowNs();
+    uint64_t f0 = benchFlashUs();
+    uint8_t status;
+
+    switch (api)
+    {
+        case BENCH_API_WRITE:
+            status = benchNv.writeItem(id, len, pBuf);
+            break;
+        case BENCH_API_READ:
+            status = benchNv.readItem(id, 0, len, pBuf);
+            break;
+#ifdef NVOCMP_INCCOMPACT
+        case BENCH_API_STEP:
+            status = NVOCMP_compactStep(benchMinFree);
+            if (status != NVINTF_SUCCESS)
+            {
+                // No step was needed, only steps that ran are sampled
+                return((status == NVINTF_BADPARAM) ? NVINTF_SUCCESS : status);
+            }
+            break;
+#endif
+        default:
+            status = benchNv.deleteItem(id);
+            break;
+    }
+
+    if (pApi->num < pApi->max)
+    {
+        pApi->pCpuNs[pApi->num] = (uint32_t)(benchNowNs() - t0);
+        pApi->pFlashUs[pApi->num] = (uint32_t)(benchFlashUs() - f0);
+        pApi->num++;
+    }
+
+    if (status != NVINTF_SUCCESS)
+    {
+        benchFailures++;
+        fprintf(stderr, "%s(%u/%u/%u) failed: %u\n", benchApiName[api],
+                id.systemID, id.itemID, id.subID, status);
+    }
+
+    return(status);
+}
+
+/**
+ * @fn      benchRead
+ *
+ * @brief   Read an item and check it against the last value written
+ *
+ * @param   id        - item ID
+ * @param   len       - item length
+ * @param   pExpected - last value written, NULL if the item was deleted
+ *
+ * @return  none
+ */
+static void benchRead(NVINTF_itemID_t id, uint16_t len, const void *pExpected)
+{
+    uint8_t buf[BENCH_MAX_LEN];
+    uint8_t status;
+
+    if (pExpected == NULL)
+    {
+        status = benchNv.readItem(id, 0, len, buf);
+        if (status != NVINTF_NOTFOUND)
+        {
+            benchFailures++;
+            fprintf(stderr, "deleted item %u/%u/%u read: %u\n",
+                    id.systemID, id.itemID, id.subID, status);
+        }
+    }
+    else if ((benchCall(BENCH_API_READ, id, len, buf) == NVINTF_SUCCESS) &&
+             (memcmp(buf, pExpected, len) != 0))
+    {
+        benchFailures++;
+        fprintf(stderr, "readItem(%u/%u/%u) returned other data than written\n",
+                id.systemID, id.itemID, id.subID);
+    }
+}
+
+/*
+ * Binding table
+ */
+static void benchBindingSetup(void)
+{
+    uint16_t i;
+
+    benchBindingUsed = true;
+    for (i = 0; i < benchBindings; i++)
+    {
+        // Empty slot, as BindInitNV() writes it
+        memset(benchBinding[i], 0xFF, BENCH_BINDING_LEN);
+        benchCall(BENCH_API_WRITE, benchItem(BENCH_NV_EX_BINDING_TABLE, i),
+                  BENCH_BINDING_LEN, benchBinding[i]);
+    }
+}
+
+static void benchBindingOp(uint32_t op)
+{
+    uint16_t slot = benchRand() % benchBindings;
+    uint16_t i;
+
+    if ((op % BENCH_RESTORE_PERIOD) == BENCH_RESTORE_PERIOD - 1)
+    {
+        // BindRestoreFromNV() after a reset
+        for (i = 0; i < benchBindings; i++)
+        {
+            benchRead(benchItem(BENCH_NV_EX_BINDING_TABLE, i),
+                      BENCH_BINDING_LEN, benchBinding[i]);
+        }
+    }
+    else if ((benchRand() % 4) != 0)
+    {
+        // Add, remove or update one binding
+        uint8_t *pEntry = benchBinding[slot];
+        uint8_t numClusters = (uint8_t)(benchRand() % 5);
+
+        if (numClusters == 0)
+        {
+            memset(pEntry, 0xFF, BENCH_BINDING_LEN);
+        }
+        else
+        {
+            pEntry[0] = (uint8_t)(1 + benchRand() % 8);     // srcEP
+            pEntry[1] = 0;                                  // dstGroupMode
+            pEntry[2] = (uint8_t)benchRand();               // dstIdx
+            pEntry[3] = 0;
+            pEntry[4] = (uint8_t)(1 + benchRand() % 8);     // dstEP
+            pEntry[5] = numClusters;
+            for (i = 0; i < 4; i++)
+            {
+                uint16_t cluster = (i < numClusters) ? (uint16_t)(benchRand() % 0x0800) : 0xFFFF;
+                pEntry[6 + 2 * i] = (uint8_t)cluster;
+                pEntry[7 + 2 * i] = (uint8_t)(cluster >> 8);
+            }
+        }
+        benchCall(BENCH_API_WRITE, benchItem(BENCH_NV_EX_BINDING_TABLE, slot),
+                  BENCH_BINDING_LEN, pEntry);
+    }
+    else
+    {
+        benchRead(benchItem(BENCH_NV_EX_BINDING_TABLE, slot),
+                  BENCH_BINDING_LEN, benchBinding[slot]);
+    }
+}
+
+/*
+ * NWK frame counter
+ */
+static void benchFrameCounterItem(uint8_t *pBuf)
+{
+    memcpy(pBuf, &benchFrameCounter, sizeof(benchFrameCounter));
+    memset(pBuf + 4, 0xA5, BENCH_SECMAT_LEN - 4);           // extendedPanID
+}
+
+static void benchFrameCounterWrite(void)
+{
+    uint8_t buf[BENCH_SECMAT_LEN];
+
+    benchFrameCounterItem(buf);
+    benchCall(BENCH_API_WRITE, benchItem(BENCH_NV_EX_NWK_SEC_MATERIAL_TABLE, 0),
+              BENCH_SECMAT_LEN, buf);
+}
+
+static void benchFrameCounterSetup(void)
+{
+    benchFrameCounterUsed = true;
+    benchFrameCounter = 0;
+    benchFrameCounterWrite();
+}
+
+static void benchFrameCounterOp(uint32_t op)
+{
+    uint8_t buf[BENCH_SECMAT_LEN];
+
+    if ((op % 10) == 9)
+    {
+        benchFrameCounterItem(buf);
+        benchRead(benchItem(BENCH_NV_EX_NWK_SEC_MATERIAL_TABLE, 0),
+                  BENCH_SECMAT_LEN, buf);
+    }
+    else
+    {
+        benchFrameCounter += BENCH_FRAMECOUNTER_DELTA;
+        benchFrameCounterWrite();
+    }
+}
+
+/*
+ * Trust center link keys
+ */
+static void benchTclkJoin(uint16_t idx)
+{
+    uint8_t *pEntry = benchTclk[idx];
+    uint8_t i;
+
+    memset(pEntry, 0, BENCH_TCLK_LEN);                      // txFrmCntr, rxFrmCntr
+    for (i = 8; i < 16; i++)
+    {
+        pEntry[i] = (uint8_t)benchRand();                   // extAddr
+    }
+    pEntry[16] = 1;                                         // keyAttributes
+    pEntry[17] = 1;                                         // keyType
+    pEntry[18] = (uint8_t)benchRand();                      // SeedShift_IcIndex
+    benchTclkUsed[idx] = true;
+    benchCall(BENCH_API_WRITE, benchItem(BENCH_NV_EX_TCLK_TABLE, idx),
+              BENCH_TCLK_LEN, pEntry);
+}
+
+static void benchTclkSetup(void)
+{
+    uint16_t i;
+
+    memset(benchTclkUsed, 0, sizeof(benchTclkUsed));
+    for (i = 0; i < benchTclkDevices / 2; i++)
+    {
+        benchTclkJoin(i);
+    }
+}
+
+static void benchTclkOp(uint32_t op)
+{
+    uint16_t idx = benchRand() % benchTclkDevices;
+    uint32_t kind = benchRand() % 10;
+    uint32_t cntr;
+
+    (void)op;
+
+    if (!benchTclkUsed[idx])
+    {
+        // Free slot, a device joins
+        benchTclkJoin(idx);
+    }
+    else if (kind < 2)
+    {
+        // The device leaves
+        benchTclkUsed[idx] = false;
+        benchCall(BENCH_API_DELETE, benchItem(BENCH_NV_EX_TCLK_TABLE, idx), 0, NULL);
+    }
+    else if (kind < 6)
+    {
+        // Incoming frame counter of the device saved
+        memcpy(&cntr, benchTclk[idx] + 4, sizeof(cntr));
+        cntr += 1 + benchRand() % 64;
+        memcpy(benchTclk[idx] + 4, &cntr, sizeof(cntr));
+        benchCall(BENCH_API_WRITE, benchItem(BENCH_NV_EX_TCLK_TABLE, idx),
+                  BENCH_TCLK_LEN, benchTclk[idx]);
+    }
+    else
+    {
+        benchRead(benchItem(BENCH_NV_EX_TCLK_TABLE, idx), BENCH_TCLK_LEN, benchTclk[idx]);
+    }
+}
+
+/*
+ * All three interleaved
+ */
+static void benchMixedSetup(void)
+{
+    benchBindingSetup();
+    benchFrameCounterSetup();
+    benchTclkSetup();
+}
+
+static void benchMixedOp(uint32_t op)
+{
+    uint32_t kind = benchRand() % 10;
+
+    if (kind < 3)
+    {
+        benchBindingOp(op);
+    }
+    else if (kind < 7)
+    {
+        benchFrameCounterOp(op);
+    }
+    else
+    {
+        benchTclkOp(op);
+    }
+}
+
+static const bench_workload_t benchWorkloads[] =
+{
+    {"binding",      benchBindingSetup,      benchBindingOp},
+    {"framecounter", benchFrameCounterSetup, benchFrameCounterOp},
+    {"tclk",         benchTclkSetup,         benchTclkOp},
+    {"mixed",        benchMixedSetup,        benchMixedOp},
+};
+
+#define BENCH_NUM_WORKLOADS (sizeof(benchWorkloads) / sizeof(benchWorkloads[0]))
+
+static int benchCompare(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+
+    return((x > y) - (x < y));
+}
+
+/**
+ * @fn      benchPercentile
+ *
+ * @brief   Percentile of sorted samples, nearest rank
+ *
+ * @param   pSorted - sorted samples
+ * @param   num     - number of samples, not 0
+ * @param   pct     - percentile, 0 to 100
+ *
+ * @return  sample at the percentile
+ */
+static uint32_t benchPercentile(const uint32_t *pSorted, uint32_t num, uint32_t pct)
+{
+    uint32_t rank = (uint32_t)(((uint64_t)num * pct + 99) / 100);
+
+    return(pSorted[(rank == 0) ? 0 : rank - 1]);
+}
+
+/**
+ * @fn      benchVerify
+ *
+ * @brief   Read back every item the workload wrote or deleted
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+static void benchVerify(void)
+{
+    uint8_t buf[BENCH_SECMAT_LEN];
+    uint16_t i;
+
+    for (i = 0; benchBindingUsed && (i < benchBindings); i++)
+    {
+        benchRead(benchItem(BENCH_NV_EX_BINDING_TABLE, i), BENCH_BINDING_LEN,
+                  benchBinding[i]);
+    }
+    if (benchFrameCounterUsed)
+    {
+        benchFrameCounterItem(buf);
+        benchRead(benchItem(BENCH_NV_EX_NWK_SEC_MATERIAL_TABLE, 0), BENCH_SECMAT_LEN, buf);
+    }
+    for (i = 0; i < benchTclkDevices; i++)
+    {
+        if (benchTclkUsed[i])
+        {
+            benchRead(benchItem(BENCH_NV_EX_TCLK_TABLE, i), BENCH_TCLK_LEN, benchTclk[i]);
+        }
+        else
+        {
+            benchRead(benchItem(BENCH_NV_EX_TCLK_TABLE, i), BENCH_TCLK_LEN, NULL);
+        }
+    }
+}
+
+/**
+ * @fn      benchRun
+ *
+ * @brief   Run a workload on an erased NV region and print its report
+ *
+ * @param   pWl - workload
+ * @param   ops - number of operations
+ *
+ * @return  none
+ */
+static void benchRun(const bench_workload_t *pWl, uint32_t ops)
+{
+    NVOCMP_perfStats_t perf;
+    NV_LINUX_stats_t flash;
+    uint32_t op, calls = 0;
+    uint8_t api, pg;
+
+    if (benchNv.eraseNV() != NVINTF_SUCCESS)
+    {
+        benchFailures++;
+        fprintf(stderr, "eraseNV failed\n");
+    }
+
+    benchBindingUsed = false;
+    benchFrameCounterUsed = false;
+    memset(benchTclkUsed, 0, sizeof(benchTclkUsed));
+    pWl->pfnSetup();
+
+    NVOCMP_resetPerfStats();
+    NV_LINUX_resetStats();
+    for (api = 0; api < BENCH_API_NUM; api++)
+    {
+        benchApi[api].num = 0;
+    }
+
+    for (op = 0; op < ops; op++)
+    {
+        pWl->pfnOp(op);
+        if (benchStepPeriod && ((op % benchStepPeriod) == benchStepPeriod - 1))
+        {
+            benchCall(BENCH_API_STEP, benchItem(0, 0), 0, NULL);
+        }
+    }
+
+    NVOCMP_getPerfStats(&perf);
+    NV_LINUX_getStats(&flash);
+
+    // Not counted in the statistics
+    benchVerify();
+
+    printf("\n== %s: %u ops, %u bytes free at the end\n", pWl->name, ops,
+           (unsigned)benchNv.getFreeNV());
+    printf("  item bytes written   %10u\n", perf.itemBytes);
+    printf("  bytes programmed     %10u  (%u programs, %u faults)\n",
+           flash.bytesProgrammed, flash.programs, flash.faults);
+    printf("  write amplification  %10.2f\n",
+           perf.itemBytes ? (double)flash.bytesProgrammed / perf.itemBytes : 0.0);
+    printf("  compactions          %10u\n", perf.compactions);
+    if (benchStepPeriod)
+    {
+        printf("  compaction steps     %10u  (every %u ops below %u bytes free)\n",
+               perf.compactSteps, benchStepPeriod, benchMinFree);
+    }
+    printf("  erases per page     ");
+    for (pg = 0; pg < NVOCMP_NVPAGES; pg++)
+    {
+        printf(" %u", flash.erases[pg]);
+    }
+    printf("\n");
+    for (api = 0; api < BENCH_API_NUM; api++)
+    {
+        calls += benchApi[api].num;
+    }
+    printf("  header reads / call  %10.1f\n", calls ? (double)perf.hdrReads / calls : 0.0);
+    printf("  flash time           %10.1f ms\n", flash.busyUs / 1000.0);
+    if (flash.asserts)
+    {
+        printf("  NVOCMP asserts       %10u\n", flash.asserts);
+    }
+
+    printf("  %-10s %7s | %-31s | %s\n", "", "", "host CPU us", "flash us");
+    printf("  %-10s %7s | %7s %7s %7s %7s | %7s %7s %7s %7s\n", "API", "calls",
+           "p50", "p90", "p99", "max", "p50", "p90", "p99", "max");
+    for (api = 0; api < BENCH_API_NUM; api++)
+    {
+        bench_api_t *pApi = &benchApi[api];
+
+        if (pApi->num == 0)
+        {
+            continue;
+        }
+        qsort(pApi->pCpuNs, pApi->num, sizeof(uint32_t), benchCompare);
+        qsort(pApi->pFlashUs, pApi->num, sizeof(uint32_t), benchCompare);
+        printf("  %-10s %7u | %7.1f %7.1f %7.1f %7.1f | %7u %7u %7u %7u\n",
+               benchApiName[api], pApi->num,
+               benchPercentile(pApi->pCpuNs, pApi->num, 50) / 1000.0,
+               benchPercentile(pApi->pCpuNs, pApi->num, 90) / 1000.0,
+               benchPercentile(pApi->pCpuNs, pApi->num, 99) / 1000.0,
+               pApi->pCpuNs[pApi->num - 1] / 1000.0,
+               benchPercentile(pApi->pFlashUs, pApi->num, 50),
+               benchPercentile(pApi->pFlashUs, pApi->num, 90),
+               benchPercentile(pApi->pFlashUs, pApi->num, 99),
+               pApi->pFlashUs[pApi->num - 1]);
+    }
+
+    if (flash.faults || flash.asserts)
+    {
+        benchFailures++;
+    }
+}
+
+static void benchUsage(const char *prog)
+{
+    uint8_t i;
+
+    printf("Usage: %s [options]\n"
+           "  -w <name>   workload to run, default all:", prog);
+    for (i = 0; i < BENCH_NUM_WORKLOADS; i++)
+    {
+        printf(" %s", benchWorkloads[i].name);
+    }
+    printf("\n"
+           "  -n <ops>    operations per workload, default %u\n"
+           "  -s <seed>   random seed, default 1\n"
+           "  -b <num>    binding table entries, default %u\n"
+           "  -t <num>    TCLK table entries, default %u\n"
+           "  -i <file>   NV image file, loaded at start and saved after every change\n"
+#ifdef NVOCMP_INCCOMPACT
+           "  -c <ops>    run a background compaction step every <ops> operations\n"
+           "  -m <bytes>  free bytes below which the steps compact, default %u\n"
+#endif
+           "  -v          print NVOCMP alerts\n"
+           "  -h          this help\n"
+           "%u NV pages of %u bytes\n",
+           BENCH_OPS, BENCH_BINDINGS, BENCH_TCLK_DEVICES,
+#ifdef NVOCMP_INCCOMPACT
+           BENCH_MIN_FREE,
+#endif
+           NVOCMP_NVPAGES, FLASH_PAGE_SIZE);
+}
+
+int main(int argc, char *argv[])
+{
+    const char *workload = NULL;
+    uint32_t ops = BENCH_OPS;
+    uint32_t i;
+    bool found = false;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "w:n:s:b:t:i:c:m:vh")) != -1)
+    {
+        switch (opt)
+        {
+            case 'w': workload = optarg; break;
+            case 'n': ops = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 's': benchSeed = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'b': benchBindings = (uint16_t)strtoul(optarg, NULL, 0); break;
+            case 't': benchTclkDevices = (uint16_t)strtoul(optarg, NULL, 0); break;
+            case 'i': NV_LINUX_setImageFile(optarg); break;
+#ifdef NVOCMP_INCCOMPACT
+            case 'c': benchStepPeriod = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'm': benchMinFree = (uint16_t)strtoul(optarg, NULL, 0); break;
+#endif
+            case 'v': NV_LINUX_verbose = true; break;
+            case 'h': benchUsage(argv[0]); return(0);
+            default:  benchUsage(argv[0]); return(2);
+        }
+    }
+
+    if ((benchSeed == 0) || (benchBindings == 0) || (benchBindings > 256) ||
+        (benchTclkDevices == 0) || (benchTclkDevices > 256))
+    {
+        fprintf(stderr, "seed must not be 0, table sizes must be 1 to 256\n");
+        return(2);
+    }
+
+    // Every op makes at most one call, except a full binding table restore
+    for (i = 0; i < BENCH_API_NUM; i++)
+    {
+        benchApi[i].max = ops + (ops / BENCH_RESTORE_PERIOD + 1) * benchBindings;
+        benchApi[i].pCpuNs = malloc(benchApi[i].max * sizeof(uint32_t));
+        benchApi[i].pFlashUs = malloc(benchApi[i].max * sizeof(uint32_t));
+        if ((benchApi[i].pCpuNs == NULL) || (benchApi[i].pFlashUs == NULL))
+        {
+            fprintf(stderr, "out of memory\n");
+            return(2);
+        }
+    }
+
+    NVOCMP_loadApiPtrs(&benchNv);
+    if (benchNv.initNV(NULL) != NVINTF_SUCCESS)
+    {
+        fprintf(stderr, "initNV failed\n");
+        return(1);
+    }
+
+    printf("NVOCMP benchmark: %u NV pages of %u bytes, seed %u\n",
+           NVOCMP_NVPAGES, FLASH_PAGE_SIZE, benchSeed);
+
+    for (i = 0; i < BENCH_NUM_WORKLOADS; i++)
+    {
+        if ((workload == NULL) || (strcmp(workload, benchWorkloads[i].name) == 0))
+        {
+            found = true;
+            benchRun(&benchWorkloads[i], ops);
+        }
+    }
+
+    if (!found)
+    {
+        fprintf(stderr, "unknown workload %s\n", workload);
+        return(2);
+    }
+
+    return(benchFailures ? 1 : 0);
+}
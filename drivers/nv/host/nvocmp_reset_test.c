@@ -0,0 +1,497 @@
+/******************************************************************************
+
+ @file  nvocmp_reset_test.c
+
+ @brief NVOCMP power loss and reset test
+
+ Group: CMCU, LPC
+ Target Device: cc13xx_cc26xx
+
+ ******************************************************************************
+ 
+ Copyright (c) 2019-2026, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ 
+ 
+ *****************************************************************************/
+
+/*
+Cuts power at random points of NVOCMP calls and checks that the items read
+after a reset are the ones written before it. Each reset is simulated with
+NV_LINUX_setPowerCut(): a child process runs random item writes, deletes and
+reads on the simulated flash of nv_linux.c, calling NVOCMP_compactStep()
+after every call, until the program or erase chosen for the power loss. The
+flash is then saved to an image file, and another child initializes NVOCMP
+from it, as a device does after a reset, and reads every item back:
+
+- an item written or deleted by a completed call must read as it was left
+- the item of the call that lost power may read as before or after the call
+- no program may need a bit set and no NVOCMP assert may fire
+
+The device then goes on from that image, so compactions that were in
+progress when power was lost are finished or started over. The items use
+little of the NV, the compaction steps run whenever NVOCMP would reclaim
+enough, so that most power losses happen during a background compaction.
+
+Build and run from the repository root:
+
+  cc -O2 -DNV_LINUX -DNVOCMP_POSIX_MUTEX -DNVOCMP_INCCOMPACT \
+      -Idrivers/nv/host -Idrivers/nv -o nvocmp_reset_test \
+      drivers/nv/host/nvocmp_reset_test.c drivers/nv/host/nv_linux.c \
+      drivers/nv/nvocmp.c drivers/nv/crc.c -lpthread
+  ./nvocmp_reset_test -h
+
+Add -DNVOCMP_NVPAGES=<n> to change the number of NV pages, without
+-DNVOCMP_INCCOMPACT the power losses only hit item writes and compactions.
+One page NV compacts in place through RAM, so items are lost on a power loss
+during a compaction, it is not tested.
+*/
+
+//*****************************************************************************
+// Includes
+//*****************************************************************************
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <nvocmp.h>
+#include "nv_linux.h"
+
+#if (NVOCMP_NVPAGES == 1)
+#error "one page NV compaction is not power loss safe, use NVOCMP_NVPAGES > 1"
+#endif
+
+//*****************************************************************************
+// Constants and Definitions
+//*****************************************************************************
+
+#define TEST_ITEM_ID            0x0100
+#define TEST_ITEMS              48
+#define TEST_MAX_LEN            24
+
+#define TEST_RESETS             500
+#define TEST_MAX_CUT            2000
+
+// Calls a device runs when no power loss stops it
+#define TEST_MAX_CALLS          100000
+
+// Free bytes below which compaction steps run
+#define TEST_MIN_FREE           (FLASH_PAGE_SIZE / 2)
+
+#define TEST_IMAGE_FILE         "nvocmp_reset_test.img"
+
+// Seconds after which a process is taken as hung
+#define TEST_TIMEOUT_S          60
+
+//*****************************************************************************
+// Typedefs
+//*****************************************************************************
+
+// Value of an item
+typedef struct
+{
+    uint8_t len;                    // 0 when the item does not exist
+    uint8_t data[TEST_MAX_LEN];
+} test_item_t;
+
+// State shared by the test and the device processes
+typedef struct
+{
+    test_item_t items[TEST_ITEMS];  // Values left by completed calls
+    int16_t     pendIdx;            // Item of the call in progress, -1 if none
+    test_item_t pend;               // Its value if the call completes
+    bool        inStep;             // NVOCMP_compactStep() in progress
+    uint32_t    calls;              // Calls completed
+} test_shared_t;
+
+//*****************************************************************************
+// Local Variables
+//*****************************************************************************
+
+static NVINTF_nvFuncts_t testNv;
+static test_shared_t *pTest;
+static uint32_t testSeed = 1;
+
+//*****************************************************************************
+// Local Functions
+//*****************************************************************************
+
+/**
+ * @fn      testRand
+ *
+ * @brief   xorshift32 pseudo random number, reproducible per seed
+ *
+ * @param   none
+ *
+ * @return  random number
+ */
+static uint32_t testRand(void)
+{
+    testSeed ^= testSeed << 13;
+    testSeed ^= testSeed >> 17;
+    testSeed ^= testSeed << 5;
+    return(testSeed);
+}
+
+static NVINTF_itemID_t testId(uint16_t idx)
+{
+    NVINTF_itemID_t id;
+
+    id.systemID = NVINTF_SYSID_APP;
+    id.itemID = TEST_ITEM_ID;
+    id.subID = idx;
+    return(id);
+}
+
+/**
+ * @fn      testInit
+ *
+ * @brief   Initialize NVOCMP from the image file, as after a reset
+ *
+ * @param   pImage - image file
+ *
+ * @return  true if NVOCMP initialized
+ */
+static bool testInit(const char *pImage)
+{
+    NV_LINUX_setImageFile(pImage);
+    NVOCMP_loadApiPtrs(&testNv);
+    return(testNv.initNV(NULL) == NVINTF_SUCCESS);
+}
+
+/**
+ * @fn      testFlashOk
+ *
+ * @brief   Check that no program needed a bit set and no assert fired
+ *
+ * @param   none
+ *
+ * @return  true if so
+ */
+static bool testFlashOk(void)
+{
+    NV_LINUX_stats_t stats;
+
+    NV_LINUX_getStats(&stats);
+    if (stats.faults || stats.asserts)
+    {
+        printf("%u program faults, %u NVOCMP asserts\n", stats.faults, stats.asserts);
+        return(false);
+    }
+    return(true);
+}
+
+/**
+ * @fn      testDevice
+ *
+ * @brief   Device process: random calls until the power loss
+ *
+ * @param   pImage - image file
+ * @param   cut    - program or erase at which power is lost
+ *
+ * @return  process exit status
+ */
+static int testDevice(const char *pImage, uint32_t cut)
+{
+    uint8_t buf[TEST_MAX_LEN];
+    uint32_t calls;
+
+    if (!testInit(pImage))
+    {
+        printf("initNV failed\n");
+        return(1);
+    }
+
+    NV_LINUX_setPowerCut(cut);
+    for (calls = 0; calls < TEST_MAX_CALLS; calls++)
+    {
+        uint16_t idx = testRand() % TEST_ITEMS;
+        test_item_t *pItem = &pTest->items[idx];
+        uint32_t kind = testRand() % 10;
+        uint8_t status;
+        uint8_t i;
+
+        if ((kind < 6) || (pItem->len == 0))
+        {
+            pTest->pend.len = (uint8_t)(1 + testRand() % TEST_MAX_LEN);
+            for (i = 0; i < pTest->pend.len; i++)
+            {
+                pTest->pend.data[i] = (uint8_t)testRand();
+            }
+            pTest->pendIdx = (int16_t)idx;
+            status = testNv.writeItem(testId(idx), pTest->pend.len, pTest->pend.data);
+        }
+        else if (kind < 8)
+        {
+            pTest->pend.len = 0;
+            pTest->pendIdx = (int16_t)idx;
+            status = testNv.deleteItem(testId(idx));
+        }
+        else
+        {
+            status = testNv.readItem(testId(idx), 0, pItem->len, buf);
+            if ((status == NVINTF_SUCCESS) && (memcmp(buf, pItem->data, pItem->len) != 0))
+            {
+                printf("item %u read other data than written\n", idx);
+                return(1);
+            }
+        }
+
+        if (status != NVINTF_SUCCESS)
+        {
+            printf("call on item %u failed: %u\n", idx, status);
+            return(1);
+        }
+        if (pTest->pendIdx >= 0)
+        {
+            *pItem = pTest->pend;
+            pTest->pendIdx = -1;
+        }
+        pTest->calls++;
+
+#ifdef NVOCMP_INCCOMPACT
+        pTest->inStep = true;
+        status = NVOCMP_compactStep(TEST_MIN_FREE);
+        pTest->inStep = false;
+        if ((status != NVINTF_SUCCESS) && (status != NVINTF_BADPARAM))
+        {
+            printf("compactStep failed: %u\n", status);
+            return(1);
+        }
+#endif
+
+        if (!testFlashOk())
+        {
+            return(1);
+        }
+    }
+
+    return(0);
+}
+
+/**
+ * @fn      testCheckItem
+ *
+ * @brief   Check an item after a reset against one of its expected values
+ *
+ * @param   idx       - item
+ * @param   pExpected - expected value
+ *
+ * @return  true if the item has that value
+ */
+static bool testCheckItem(uint16_t idx, const test_item_t *pExpected)
+{
+    uint8_t buf[TEST_MAX_LEN];
+    uint32_t len = testNv.getItemLen(testId(idx));
+
+    if (len != pExpected->len)
+    {
+        return(false);
+    }
+    if (len == 0)
+    {
+        return(true);
+    }
+    return((testNv.readItem(testId(idx), 0, (uint16_t)len, buf) == NVINTF_SUCCESS) &&
+           (memcmp(buf, pExpected->data, len) == 0));
+}
+
+/**
+ * @fn      testReset
+ *
+ * @brief   Process of a reset device: read back every item
+ *
+ * @param   pImage - image file
+ *
+ * @return  process exit status
+ */
+static int testReset(const char *pImage)
+{
+    uint16_t idx;
+
+    if (!testInit(pImage))
+    {
+        printf("initNV after the reset failed\n");
+        return(1);
+    }
+
+    for (idx = 0; idx < TEST_ITEMS; idx++)
+    {
+        if (testCheckItem(idx, &pTest->items[idx]))
+        {
+            continue;
+        }
+        if ((idx == pTest->pendIdx) && testCheckItem(idx, &pTest->pend))
+        {
+            // The call that lost power was done
+            pTest->items[idx] = pTest->pend;
+            continue;
+        }
+        printf("item %u has another value than written before the reset: len %u, expected %u%s\n",
+               idx, testNv.getItemLen(testId(idx)), pTest->items[idx].len,
+               (idx == pTest->pendIdx) ? " (call in progress)" : "");
+        return(1);
+    }
+    pTest->pendIdx = -1;
+
+    return(testFlashOk() ? 0 : 1);
+}
+
+/**
+ * @fn      testRun
+ *
+ * @brief   Run a function in a child process
+ *
+ * @param   pfn    - function
+ * @param   pImage - image file
+ * @param   cut    - power loss, for testDevice()
+ *
+ * @return  exit status of the child, -1 if it did not exit
+ */
+static int testRun(int (*pfn)(const char *, uint32_t), const char *pImage, uint32_t cut)
+{
+    pid_t pid;
+    int status;
+
+    fflush(stdout);
+    pid = fork();
+    if (pid == 0)
+    {
+        (void)alarm(TEST_TIMEOUT_S);
+        exit(pfn(pImage, cut));
+    }
+    if ((pid < 0) || (waitpid(pid, &status, 0) != pid) || !WIFEXITED(status))
+    {
+        return(-1);
+    }
+    return(WEXITSTATUS(status));
+}
+
+static int testResetRun(const char *pImage, uint32_t cut)
+{
+    (void)cut;
+    return(testReset(pImage));
+}
+
+static void testUsage(const char *prog)
+{
+    printf("Usage: %s [options]\n"
+           "  -n <num>    power losses, default %u\n"
+           "  -f <num>    power lost within the first <num> programs and erases\n"
+           "              of a device run, default %u\n"
+           "  -s <seed>   random seed, default 1\n"
+           "  -i <file>   image file, default %s\n"
+           "  -h          this help\n"
+           "%u NV pages of %u bytes\n",
+           prog, TEST_RESETS, TEST_MAX_CUT, TEST_IMAGE_FILE,
+           NVOCMP_NVPAGES, FLASH_PAGE_SIZE);
+}
+
+int main(int argc, char *argv[])
+{
+    const char *pImage = TEST_IMAGE_FILE;
+    uint32_t resets = TEST_RESETS;
+    uint32_t maxCut = TEST_MAX_CUT;
+    uint32_t inStep = 0;
+    uint32_t seed;
+    uint32_t n;
+    int status;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:f:s:i:h")) != -1)
+    {
+        switch (opt)
+        {
+            case 'n': resets = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'f': maxCut = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 's': testSeed = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'i': pImage = optarg; break;
+            case 'h': testUsage(argv[0]); return(0);
+            default:  testUsage(argv[0]); return(2);
+        }
+    }
+    if ((testSeed == 0) || (maxCut == 0))
+    {
+        fprintf(stderr, "seed and -f must not be 0\n");
+        return(2);
+    }
+    seed = testSeed;
+
+    pTest = mmap(NULL, sizeof(test_shared_t), PROT_READ | PROT_WRITE,
+                 MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (pTest == MAP_FAILED)
+    {
+        fprintf(stderr, "mmap failed\n");
+        return(2);
+    }
+    memset(pTest, 0, sizeof(test_shared_t));
+    pTest->pendIdx = -1;
+
+    // Start from blank flash. The image only has to outlive the device
+    // processes, not the host.
+    NV_LINUX_setImageFile(pImage);
+    NV_LINUX_removeImage();
+    NV_LINUX_syncWrites = false;
+
+    for (n = 0; n < resets; n++)
+    {
+        // Every device run draws other calls
+        (void)testRand();
+        status = testRun(testDevice, pImage, 1 + testRand() % maxCut);
+        if (status != NV_LINUX_POWERCUT_EXIT)
+        {
+            printf("power loss %u: device run stopped with status %d (-s %u)\n",
+                   n, status, seed);
+            return(1);
+        }
+        if (pTest->inStep)
+        {
+            inStep++;
+            pTest->inStep = false;
+        }
+
+        if (testRun(testResetRun, pImage, 0) != 0)
+        {
+            printf("power loss %u: items wrong after the reset (-s %u)\n", n, seed);
+            return(1);
+        }
+    }
+
+    printf("%u power losses, %u during a compaction step, %u calls: passed\n",
+           resets, inStep, pTest->calls);
+    NV_LINUX_removeImage();
+    return(0);
+}
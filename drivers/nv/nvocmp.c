@@ -119,7 +119,8 @@ status = nvFps.readItem(id, 0, len, buf);
 
 Note: Each item operation results in a traversal of the page starting at
 the most recently written item. This makes 'finding' items by 'trying' item IDs
-in order extremely inefficient. The doNext() API call allows the user to find,
+in order extremely inefficient. (NVOCMP_ITEMINDEX removes the traversal for
+operations on an exact item ID.) The doNext() API call allows the user to find,
 read, or delete items in one page traversal. However, this call requires the
 user to lock access to NV until the operation is complete so it should be used
 carefully and sparingly.
@@ -137,6 +138,11 @@ Linux envrionment. If debugging/logging functionality is required, the
 Configuration:
 NVOCMP_STATS - Places a protected item with driver stats
 
+NVOCMP_PERFSTATS - Counts Flash bytes programmed, erases per page, compactions
+and item header reads in RAM. Read with NVOCMP_getPerfStats() to measure
+write amplification and lookup cost of a workload. host/nvocmp_bench.c reports
+them for Z-Stack item workloads on the simulated flash of host/nv_linux.c.
+
 NVOCMP_CRCONREAD (on:1 off:0) - item crc is checked on read. Disabling this may
 increase driver speed but safety is reduced.
 
@@ -156,6 +162,32 @@ NVOCMP_sanityCheckApi() to be available. This function is used to perform
 a sanity check on the active partition to report if corruption has been
 detected.
 
+NVOCMP_ITEMINDEX - Keeps a RAM hash index of the newest active instance of
+each item (compressed ID -> page/header offset) so that exact-ID lookups do
+not traverse item headers. The index is rebuilt with one page traversal after
+initialization or compaction and is updated on every item write or delete.
+Every hit is verified against the item header in Flash; if the index cannot
+be trusted the driver falls back to the page traversal.
+
+NVOCMP_ITEMINDEX_SIZE - Number of index slots (power of two, default 128,
+8 bytes each). Indexing is suspended until the next compaction when more than
+3/4 of the slots are in use or corruption is found.
+
+NVOCMP_INCCOMPACT - Enables NVOCMP_compactStep() for background compaction.
+With two pages, each step copies at most NVOCMP_COMPACTSTEPITEMS (default 8)
+active items of the active page into the tail page, and the last step makes
+the tail page active. The active page is complete until then, a reset drops
+the partial copy and a blocking compaction cancels it. With more pages, each
+step compacts one source page into the tail page, the same bounded unit
+addItem() uses, so the compact headers keep Flash recoverable after every
+step. With one page, compaction is in place and a step is a compaction. Calling it periodically from a low priority task keeps free space ahead
+of writes, and the blocking compaction in addItem() only runs when NV is
+really out of space. Steps take the driver mutex, so they must not be called
+from the idle hook. Inactive item bytes are counted per page, steps only run
+when at least NVOCMP_COMPACTMINRECLAIM bytes (default 1/8 page) can be
+reclaimed. After a reset, a page with inactive items counts as all inactive
+until it has been compacted once.
+
 Dependencies:
 Requires NVS for NV access.
 Requires TI-RTOS GateMutexPri or POSIX mutex to be enabled in configuration.
@@ -208,6 +240,25 @@ Requires API's in a crc.h to implement CRC functionality.
 #define NVOCMP_FASTOFF      1           // Fast Search Offset
 #define NVOCMP_FASTITEM     0           // Fast Find Item
 
+#ifdef NVOCMP_ITEMINDEX
+#ifndef NVOCMP_ITEMINDEX_SIZE
+#define NVOCMP_ITEMINDEX_SIZE   128     // Must be a power of two
+#endif
+
+#if (NVOCMP_ITEMINDEX_SIZE & (NVOCMP_ITEMINDEX_SIZE - 1))
+#error "NVOCMP_ITEMINDEX_SIZE should be a power of two"
+#endif
+
+#define NVOCMP_IDXMASK      (NVOCMP_ITEMINDEX_SIZE - 1)
+#define NVOCMP_IDXMAXLOAD   ((NVOCMP_ITEMINDEX_SIZE * 3) / 4)
+// Index slot markers (compressed IDs never have bit31 set)
+#define NVOCMP_IDXEMPTY     0xFFFFFFFF
+#define NVOCMP_IDXDELETED   0xFFFFFFFE
+
+// Item index states
+enum {NVOCMP_IDXSTALE = 0, NVOCMP_IDXREADY, NVOCMP_IDXOFF};
+#endif // NVOCMP_ITEMINDEX
+
 #ifndef NVOCMP_NWSAMEITEM
 #define NVOCMP_NWSAMEITEM   0           // Not Write Same Item
 #endif
@@ -219,6 +270,11 @@ Requires API's in a crc.h to implement CRC functionality.
 #define NVOCMP_NVONEP       1           // One Page NV
 #define NVOCMP_NVTWOP       2           // Two Page NV
 
+// Two page NV compacts in the background a few items per step
+#if defined(NVOCMP_INCCOMPACT) && (NVOCMP_NVPAGES == NVOCMP_NVTWOP)
+#define NVOCMP_STEPCOPY
+#endif
+
 #define NVOCMP_NVSIZE       NVOCMP_size
 #define NVOCMP_ADDPAGE(p,n) (((p) + (n)) % NVOCMP_NVSIZE)
 #define NVOCMP_INCPAGE(p)   NVOCMP_ADDPAGE(p,1)
@@ -524,6 +580,16 @@ typedef struct
 // Compressed item header byte array
 typedef uint8_t cmpIH_t[NVOCMP_ITEMHDRLEN];
 
+#ifdef NVOCMP_ITEMINDEX
+// Item index slot
+typedef struct
+{
+    uint32_t cmpid; // Compressed ID or NVOCMP_IDXEMPTY/NVOCMP_IDXDELETED
+    uint16_t hofs;  // Header offset
+    uint8_t  hpage; // Header page
+} NVOCMP_idxEntry_t;
+#endif // NVOCMP_ITEMINDEX
+
 // Item write parameters
 typedef struct
 {
@@ -652,6 +718,56 @@ static bool (*NVOCMP_voltCheckFptr)(void);
 static uint16_t NVOCMP_badCRCCount = 0;
 #endif // NVOCMP_STATS
 
+#ifdef NVOCMP_INCCOMPACT
+#ifndef NVOCMP_COMPACTMINRECLAIM
+// Inactive bytes below which a background compaction step is not worth it
+#define NVOCMP_COMPACTMINRECLAIM    (FLASH_PAGE_SIZE / 8)
+#endif
+// Inactive item bytes per page, what compacting the page would reclaim
+static uint16_t NVOCMP_pgInactive[NVOCMP_NVPAGES];
+// Background compaction started and not yet back above its upper threshold
+static bool NVOCMP_stepActive = false;
+#endif // NVOCMP_INCCOMPACT
+
+#ifdef NVOCMP_STEPCOPY
+#ifndef NVOCMP_COMPACTSTEPITEMS
+// Items copied by one background compaction step
+#define NVOCMP_COMPACTSTEPITEMS     8
+#endif
+// Head page is being copied into the tail page, see compactInfo for where
+static bool NVOCMP_stepCopy = false;
+// Items below this head page offset were copied by earlier passes
+static uint16_t NVOCMP_stepEnd;
+#endif // NVOCMP_STEPCOPY
+
+#ifdef NVOCMP_PERFSTATS
+// Flash activity counters
+static NVOCMP_perfStats_t NVOCMP_perfStats;
+#define NVOCMP_PERFINC(field, n)    (NVOCMP_perfStats.field += (n))
+#else
+#define NVOCMP_PERFINC(field, n)
+#endif // NVOCMP_PERFSTATS
+
+#ifdef NVOCMP_ITEMINDEX
+// RAM index of newest active item instances
+static NVOCMP_idxEntry_t NVOCMP_idxTable[NVOCMP_ITEMINDEX_SIZE];
+// Number of slots not empty (occupied or deleted)
+static uint16_t NVOCMP_idxUsed;
+// Index state: stale after items are relocated or erased, off when full
+static uint8_t NVOCMP_idxState = NVOCMP_IDXSTALE;
+#endif // NVOCMP_ITEMINDEX
+
+#ifdef NV_LINUX
+// Set when the simulated flash image changed since it was last saved
+static bool NVOCMP_linuxDirty = false;
+// Persist the simulated flash image after a successful API call, but only
+// when that call actually wrote or erased something
+#define NVOCMP_LINUXSAVE(err)   if (((err) == NVINTF_SUCCESS) && NVOCMP_linuxDirty) \
+                                { NVOCMP_linuxDirty = false; NV_LINUX_save(); }
+#else
+#define NVOCMP_LINUXSAVE(err)
+#endif // NV_LINUX
+
 NVOCMP_initAction_t gAction;
 uint8_t NVOCMP_size;
 
@@ -713,6 +829,7 @@ static inline void NVOCMP_read(uint8_t pg, uint16_t off, uint8_t *pBuf, uint16_t
 static uint8_t    NVOCMP_write(uint8_t dstPg, uint16_t off, uint8_t *pBuf, uint16_t len);
 
 static void       NVOCMP_readHeader(uint8_t pg, uint16_t ofs, NVOCMP_itemHdr_t *iHdr, bool flag);
+static bool       NVOCMP_readNewestHeader(NVOCMP_nvHandle_t *pNvHandle, NVOCMP_itemHdr_t *iHdr);
 static void       NVOCMP_setCompactHdr(uint8_t dstPg, uint8_t pg, int16_t offset,
                                        uint16_t location);
 static uint16_t   NVOCMP_findOffset(uint8_t pg, uint16_t ofs);
@@ -722,6 +839,16 @@ static uint8_t    NVOCMP_verifyCRC(uint16_t iOfs, uint16_t len, uint8_t crc, uin
 static uint8_t    NVOCMP_readByte(uint8_t pg, uint16_t ofs);
 static void       NVOCMP_writeByte(uint8_t pg, uint16_t ofs, uint8_t bwv);
 
+#ifdef NVOCMP_ITEMINDEX
+static inline uint16_t NVOCMP_idxHash(uint32_t cmpid);
+static NVOCMP_idxEntry_t *NVOCMP_idxLookup(uint32_t cmpid);
+static void       NVOCMP_idxInsert(uint32_t cmpid, uint8_t pg, uint16_t hofs, bool replace);
+static void       NVOCMP_idxRemove(uint32_t cmpid, uint8_t pg, uint16_t hofs);
+static bool       NVOCMP_idxBuild(NVOCMP_nvHandle_t *pNvHandle);
+static bool       NVOCMP_idxFind(NVOCMP_nvHandle_t *pNvHandle, NVOCMP_itemHdr_t *pHdr,
+                                 int8_t *pStatus);
+#endif
+
 #if (NVOCMP_NVPAGES > NVOCMP_NVTWOP)
 static uint8_t    NVOCMP_findDstPage(NVOCMP_nvHandle_t *pNvHandle);
 static uint8_t    NVOCMP_cleanPage(NVOCMP_nvHandle_t *pNvHandle);
@@ -730,12 +857,20 @@ static void       NVOCMP_getCompactHdr(uint8_t dstPg, uint16_t location, NVOCMP_
 #endif
 
 #if (NVOCMP_NVPAGES > NVOCMP_NVONEP)
-#if !defined(NVOCMP_MIGRATE_DISABLED)
+#if !defined(NVOCMP_MIGRATE_DISABLED) || defined(NVOCMP_STEPCOPY)
 static void       NVOCMP_copyItem(uint8_t srcPg, uint8_t xPg, uint16_t sOfs, uint16_t dOfs, uint16_t len);
+#endif
+#if !defined(NVOCMP_MIGRATE_DISABLED)
 static void       NVOCMP_migratePage(NVOCMP_nvHandle_t *pNvHandle, uint8_t page);
 #endif
 #endif
 
+#ifdef NVOCMP_STEPCOPY
+static uint8_t    NVOCMP_stepCopyItems(NVOCMP_nvHandle_t *pNvHandle, uint16_t maxItems);
+static void       NVOCMP_stepCancel(NVOCMP_nvHandle_t *pNvHandle);
+static void       NVOCMP_stepDropCopy(NVOCMP_nvHandle_t *pNvHandle, uint32_t cmpid);
+#endif
+
 //*****************************************************************************
 // Load Pointer Functions (These are declared in nvoctp.h)
 //*****************************************************************************
@@ -918,6 +1053,39 @@ static bool NVOCMP_checkVoltage(void)
 }
 #endif
 
+#ifdef NVOCMP_PERFSTATS
+/**
+ * @fn      NVOCMP_getPerfStats
+ *
+ * @brief   Global function to copy the Flash activity counters
+ *
+ * @param   pStats - pointer to caller's counter buffer
+ *
+ * @return  none
+ */
+extern void NVOCMP_getPerfStats(NVOCMP_perfStats_t *pStats)
+{
+    if(pStats != NULL)
+    {
+        memcpy(pStats, &NVOCMP_perfStats, sizeof(NVOCMP_perfStats_t));
+    }
+}
+
+/**
+ * @fn      NVOCMP_resetPerfStats
+ *
+ * @brief   Global function to clear the Flash activity counters
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+extern void NVOCMP_resetPerfStats(void)
+{
+    memset(&NVOCMP_perfStats, 0, sizeof(NVOCMP_perfStats_t));
+}
+#endif // NVOCMP_PERFSTATS
+
 #ifdef NVDEBUG
 void NVOCMP_corruptData(uint8_t pg, uint16_t off, uint16_t len, uint8_t buf)
 {
@@ -1027,6 +1195,26 @@ static uint8_t NVOCMP_initNvApi(void *param)
 
         NVOCMP_initNv(&NVOCMP_nvHandle);
 
+#ifdef NVOCMP_ITEMINDEX
+        // Index the items found by initialization
+        (void)NVOCMP_idxBuild(&NVOCMP_nvHandle);
+#endif
+
+#ifdef NVOCMP_INCCOMPACT
+        {
+            uint8_t p;
+
+            // Only items made inactive from now on are counted, take all
+            // of a page that already has inactive items as reclaimable
+            for(p = 0; p < NVOCMP_NVSIZE; p++)
+            {
+                NVOCMP_pgInactive[p] =
+                    (NVOCMP_nvHandle.pageInfo[p].allActive == NVOCMP_SOMEINACTIVE) ?
+                    (NVOCMP_nvHandle.pageInfo[p].offset - NVOCMP_PGDATAOFS) : 0;
+            }
+        }
+#endif
+
 #if defined (NVOCMP_STATS)
         {
             uint8_t err;
@@ -1092,12 +1280,7 @@ static uint8_t NVOCMP_eraseNvApi(void)
   NVOCMP_changePageState(&NVOCMP_nvHandle, NVOCMP_nvHandle.headPage, NVOCMP_PGRDY);
   NVOCMP_changePageState(&NVOCMP_nvHandle, NVOCMP_nvHandle.tailPage, NVOCMP_PGXDST);
 
-#ifdef NV_LINUX
-    if(err == NVINTF_SUCCESS)
-    {
-        NV_LINUX_save();
-    }
-#endif
+    NVOCMP_LINUXSAVE(err)
 
   NVOCMP_UNLOCK(err);
 }
@@ -1185,15 +1368,139 @@ static uint8_t NVOCMP_compactNvApi(uint16_t minAvail)
         }
     }
 
-#ifdef NV_LINUX
-    if(err == NVINTF_SUCCESS)
+    NVOCMP_LINUXSAVE(err)
+
+    NVOCMP_UNLOCK(err);
+}
+
+#ifdef NVOCMP_INCCOMPACT
+/******************************************************************************
+ * @fn      NVOCMP_compactStep
+ *
+ * @brief   Global function to run one bounded step of background compaction
+ *
+ *          Steps start when free space drops below minFree and enough
+ *          inactive bytes can be reclaimed, and go on until twice minFree
+ *          is free or too little is left to reclaim. With two pages a step
+ *          copies NVOCMP_COMPACTSTEPITEMS items and a compaction takes
+ *          several steps, once started it runs to its end.
+ *
+ * @param   minFree - free bytes in NV below which a step is run
+ *
+ * @return  NVINTF_SUCCESS if a step ran (and, with more than two pages,
+ *          reclaimed space), NVINTF_BADPARAM if no step was needed or
+ *          worth it, or specific failure code
+ */
+uint8_t NVOCMP_compactStep(uint16_t minFree)
+{
+    uint8_t err = NVINTF_SUCCESS;
+    uint32_t freeBytes;
+    uint32_t reclaim = 0;
+#if (NVOCMP_NVPAGES <= NVOCMP_NVTWOP)
+    uint8_t pg;
+#endif
+
+    // Check voltage if possible
+    NVOCMP_FLASHACCESS(err)
+    if(err)
     {
-        NV_LINUX_save();
+      return(err);
     }
+
+    // Prevent RTOS thread contention
+    NVOCMP_LOCK();
+    err = NVOCMP_failF;
+    // Check for a fatal error
+    if(err == NVINTF_SUCCESS)
+    {
+        freeBytes = NVOCMP_getFreeNvApi();
+#if (NVOCMP_NVPAGES > NVOCMP_NVTWOP)
+        // A step compacts the head page only, compacting past an all active
+        // head page skips pages, which reset recovery does not follow. The
+        // active page is closed first, so it must not be empty.
+        reclaim = (NVOCMP_nvHandle.pageInfo[NVOCMP_nvHandle.actPage].offset > NVOCMP_PGDATAOFS) ?
+                  NVOCMP_pgInactive[NVOCMP_nvHandle.headPage] : 0;
+#else
+        for(pg = 0; pg < NVOCMP_NVSIZE; pg++)
+        {
+            if((pg != NVOCMP_nvHandle.tailPage) || (NVOCMP_NVSIZE == NVOCMP_NVONEP))
+            {
+                reclaim += NVOCMP_pgInactive[pg];
+            }
+        }
+#endif
+
+#ifdef NVOCMP_STEPCOPY
+        if(NVOCMP_stepCopy)
+        {
+            // Finish the copy in progress
+            NVOCMP_stepActive = true;
+        }
+        else
+#endif
+        if(reclaim < NVOCMP_COMPACTMINRECLAIM)
+        {
+            NVOCMP_stepActive = false;
+        }
+        else if(NVOCMP_stepActive)
+        {
+            NVOCMP_stepActive = (freeBytes < 2 * (uint32_t)minFree);
+        }
+        else
+        {
+            NVOCMP_stepActive = (freeBytes < minFree);
+        }
+
+        if(NVOCMP_stepActive)
+        {
+#ifdef NVOCMP_STEPCOPY
+            // Copy a few items, the pages are switched by the last step
+            err = NVOCMP_stepCopyItems(&NVOCMP_nvHandle, NVOCMP_COMPACTSTEPITEMS);
+            if(err == NVINTF_SUCCESS)
+            {
+                NVOCMP_PERFINC(compactSteps, 1);
+            }
+#else
+#if (NVOCMP_NVPAGES > NVOCMP_NVTWOP)
+            // Close the active page as addItem() does before compacting, so
+            // the compacted page is the only active page after a reset
+            if(NVOCMP_nvHandle.pageInfo[NVOCMP_nvHandle.actPage].state == NVOCMP_PGACT)
+            {
+                NVOCMP_changePageState(&NVOCMP_nvHandle, NVOCMP_nvHandle.actPage, NVOCMP_PGFULL);
+            }
+#endif
+            // 'update' compaction stops at the first destination page with
+            // room, leaving the state a compaction by addItem() leaves
+            (void)NVOCMP_compactPage(&NVOCMP_nvHandle, NVOCMP_ITEMHDRLEN + 1);
+            // 'failW' indicates compaction status
+            err = NVOCMP_failW;
+            if(err == NVINTF_SUCCESS)
+            {
+                if(NVOCMP_getFreeNvApi() > freeBytes)
+                {
+                    NVOCMP_PERFINC(compactSteps, 1);
+                }
+                else
+                {
+                    // Nothing was compacted, wait for more inactive items
+                    NVOCMP_stepActive = false;
+                    err = NVINTF_BADPARAM;
+                }
+            }
 #endif
+        }
+        else
+        {
+            // Nothing to do yet
+            err = NVINTF_BADPARAM;
+        }
+    }
+
+    NVOCMP_LINUXSAVE(err)
 
     NVOCMP_UNLOCK(err);
 }
+#endif // NVOCMP_INCCOMPACT
 
 //*****************************************************************************
 // API Functions - NV Data Items
@@ -1261,12 +1568,7 @@ static uint8_t NVOCMP_createItemApi(NVINTF_itemID_t id, uint32_t len, void *pBuf
       err = NVINTF_FAILURE;
     }
 
-#ifdef NV_LINUX
-    if(err == NVINTF_SUCCESS)
-    {
-        NV_LINUX_save();
-    }
-#endif
+    NVOCMP_LINUXSAVE(err)
 
     NVOCMP_UNLOCK(err);
 }
@@ -1335,12 +1637,7 @@ static uint8_t NVOCMP_updateItemApi(NVINTF_itemID_t id, uint32_t len, void *pBuf
       err = NVINTF_FAILURE;
     }
 
-#ifdef NV_LINUX
-    if(err == NVINTF_SUCCESS)
-    {
-        NV_LINUX_save();
-    }
-#endif
+    NVOCMP_LINUXSAVE(err)
 
     NVOCMP_UNLOCK(err);
 }
@@ -1402,12 +1699,7 @@ static uint8_t NVOCMP_deleteItemApi(NVINTF_itemID_t id)
       NVOCMP_ALERT(err == NVOCMP_failW, "Item delete failed.")
     }
 
-#ifdef NV_LINUX
-    if(err == NVINTF_SUCCESS)
-    {
-        NV_LINUX_save();
-    }
-#endif
+    NVOCMP_LINUXSAVE(err)
 
     NVOCMP_UNLOCK(err);
 }
@@ -1597,12 +1889,7 @@ static uint8_t NVOCMP_writeItemApi(NVINTF_itemID_t id, uint16_t len, void *pBuf)
         err = NVOCMP_failW;
     }
 
-#ifdef NV_LINUX
-    if(err == NVINTF_SUCCESS)
-    {
-        NV_LINUX_save();
-    }
-#endif
+    NVOCMP_LINUXSAVE(err)
 
     NVOCMP_UNLOCK(err);
 }
@@ -2287,8 +2574,9 @@ static void NVOCMP_initNv(NVOCMP_nvHandle_t *pNvHandle)
       }
       else if(noPgNact)
       {
+        // Power lost after erasing a compacted page, before marking it
         pgXdst = pgNact;
-        NVOCMP_changePageState(pNvHandle, pNvHandle->tailPage, NVOCMP_PGXDST);
+        NVOCMP_changePageState(pNvHandle, pgXdst, NVOCMP_PGXDST);
         action = NVOCMP_NORMAL_RESUME;
       }
       else
@@ -2337,8 +2625,7 @@ static void NVOCMP_initNv(NVOCMP_nvHandle_t *pNvHandle)
         int8_t status;
         if(pNvHandle->actOffset > NVOCMP_PGDATAOFS + NVOCMP_ITEMHDRLEN)
         {
-          NVOCMP_readHeader(pNvHandle->actPage, pNvHandle->actOffset - NVOCMP_ITEMHDRLEN , &iHdr, false);
-          if(iHdr.stats & NVOCMP_FOLLOWBIT)
+          if(NVOCMP_readNewestHeader(pNvHandle, &iHdr))
           {
             status = NVOCMP_findItem(pNvHandle, pNvHandle->actPage, pNvHandle->actOffset - NVOCMP_ITEMHDRLEN - iHdr.len,
                             &iHdr, NVOCMP_FINDSTRICT, NULL);
@@ -2349,6 +2636,7 @@ static void NVOCMP_initNv(NVOCMP_nvHandle_t *pNvHandle)
           }
           else
           {
+            pNvHandle->forceCompact = 1;
             NVOCMP_compactPage(pNvHandle, 0);
           }
         }
@@ -2536,6 +2824,16 @@ static void NVOCMP_initNv(NVOCMP_nvHandle_t *pNvHandle)
       NVOCMP_failW |= NVOCMP_erase(pNvHandle, pNvHandle->tailPage);
       NVOCMP_changePageState(pNvHandle, pNvHandle->tailPage, NVOCMP_PGXDST);
     }
+#ifdef NVOCMP_STEPCOPY
+    else if((action == NVOCMP_NORMAL_RESUME) &&
+            (NVOCMP_readByte(pNvHandle->tailPage, NVOCMP_COMPMODEOFS) == NVOCMP_PGCDST))
+    {
+      // Reset during a background compaction, the active page is complete
+      // and the partial copy is dropped
+      NVOCMP_failW |= NVOCMP_erase(pNvHandle, pNvHandle->tailPage);
+      NVOCMP_changePageState(pNvHandle, pNvHandle->tailPage, NVOCMP_PGXDST);
+    }
+#endif
 
     pNvHandle->headPage = pNvHandle->actPage;
     pNvHandle->actOffset = pNvHandle->pageInfo[pNvHandle->actPage].offset;
@@ -2553,8 +2851,7 @@ static void NVOCMP_initNv(NVOCMP_nvHandle_t *pNvHandle)
           compaction_occurred = false;
           if(pNvHandle->actOffset > NVOCMP_PGDATAOFS + NVOCMP_ITEMHDRLEN)
           {
-            NVOCMP_readHeader(pNvHandle->actPage, pNvHandle->actOffset - NVOCMP_ITEMHDRLEN , &iHdr, false);
-            if(iHdr.stats & NVOCMP_FOLLOWBIT)
+            if(NVOCMP_readNewestHeader(pNvHandle, &iHdr))
             {
               /* Cache current active page value before search starts */
               prevactPage = pNvHandle->actPage;
@@ -2676,8 +2973,7 @@ static void NVOCMP_initNv(NVOCMP_nvHandle_t *pNvHandle)
       // resume state, set head page, act page and tail page
       if(pNvHandle->actOffset > NVOCMP_PGDATAOFS + NVOCMP_ITEMHDRLEN)
       {
-        NVOCMP_readHeader(pNvHandle->actPage, pNvHandle->actOffset - NVOCMP_ITEMHDRLEN , &iHdr, false);
-        if(iHdr.stats & NVOCMP_FOLLOWBIT)
+        if(NVOCMP_readNewestHeader(pNvHandle, &iHdr))
         {
           status = NVOCMP_findItem(pNvHandle, pNvHandle->actPage, pNvHandle->actOffset - NVOCMP_ITEMHDRLEN - iHdr.len,
                           &iHdr, NVOCMP_FINDSTRICT, NULL);
@@ -2974,7 +3270,10 @@ static uint8_t NVOCMP_write(uint8_t dstPg, uint16_t off, uint8_t *pBuf, uint16_t
                            pBuf, len, NVS_WRITE_POST_VERIFY);
 #else
         nvsRes = NV_LINUX_write(dstPg, off, pBuf, len);
+        NVOCMP_linuxDirty = true;
 #endif
+        NVOCMP_PERFINC(writes, 1);
+        NVOCMP_PERFINC(bytesWritten, len);
     }
     else
     {
@@ -3015,11 +3314,16 @@ static uint8_t NVOCMP_erase(NVOCMP_nvHandle_t *pNvHandle, uint8_t dstPg)
 
     if (NVINTF_SUCCESS == err)
     {
+#ifdef NVOCMP_ITEMINDEX
+        // Items on this page are gone, rebuild index on next lookup
+        NVOCMP_idxState = NVOCMP_IDXSTALE;
+#endif
 #ifndef NV_LINUX
         nvsRes = NVS_erase(NVOCMP_nvsHandle, NVOCMP_FLASHOFFSET(dstPg, 0),
                            NVOCMP_nvsAttrs.sectorSize);
 #else
         nvsRes = NV_LINUX_erase(dstPg);
+        NVOCMP_linuxDirty = true;
 #endif
         if (nvsRes < 0)
         {
@@ -3027,6 +3331,7 @@ static uint8_t NVOCMP_erase(NVOCMP_nvHandle_t *pNvHandle, uint8_t dstPg)
         }
         else
         {
+          NVOCMP_PERFINC(erases[dstPg], 1);
           // Bump the compaction cycle counter, wrap-around if at maximum
           pNvHandle->pageInfo[dstPg].cycle = (pNvHandle->pageInfo[dstPg].cycle < NVOCMP_MAXCYCLE) ?
                                            (pNvHandle->pageInfo[dstPg].cycle + 1) : NVOCMP_MINCYCLE;
@@ -3036,6 +3341,13 @@ static uint8_t NVOCMP_erase(NVOCMP_nvHandle_t *pNvHandle, uint8_t dstPg)
           NVOCMP_setCompactHdr(dstPg, NVOCMP_NULLPAGE, NVOCMP_NULLOFFSET, XSRCENDHDR);
           pNvHandle->pageInfo[dstPg].offset = NVOCMP_PGDATAOFS;
           pNvHandle->pageInfo[dstPg].mode = NVOCMP_PGNORMAL;
+#ifdef NVOCMP_INCCOMPACT
+          NVOCMP_pgInactive[dstPg] = 0;
+#endif
+#ifdef NVOCMP_STEPCOPY
+          // Erasing either page ends a background copy
+          NVOCMP_stepCopy = false;
+#endif
         }
     }
     else
@@ -3087,6 +3399,7 @@ static void NVOCMP_writeItem(NVOCMP_nvHandle_t *pNvHandle, NVOCMP_itemHdr_t *pHd
 
     // Total length of this item
     iLen = NVOCMP_ITEMHDRLEN + pHdr->len;
+    NVOCMP_PERFINC(itemBytes, iLen);
 
     if((dstOff + iLen) <= FLASH_PAGE_SIZE)
     {
@@ -3191,6 +3504,13 @@ static void NVOCMP_writeItem(NVOCMP_nvHandle_t *pNvHandle, NVOCMP_itemHdr_t *pHd
         {
             NVOCMP_setItemInactive(pNvHandle, dstPg, hOfs);
         }
+#ifdef NVOCMP_ITEMINDEX
+        else
+        {
+            // This is now the newest instance of the item
+            NVOCMP_idxInsert(pHdr->cmpid, dstPg, hOfs, true);
+        }
+#endif
     }
     else
     {
@@ -3254,6 +3574,7 @@ static void NVOCMP_readHeader(uint8_t pg, uint16_t ofs, NVOCMP_itemHdr_t *pHdr,
     pHdr->sig    = cHdr[6];
 #endif
     pHdr->cmpid  = NVOCMP_CMPRID(pHdr->sysid, pHdr->itemid, pHdr->subid);
+    NVOCMP_PERFINC(hdrReads, 1);
     // Our item has correct signature?
     if (pHdr->sig != NVOCMP_SIGNATURE)
     {
@@ -3269,6 +3590,32 @@ static void NVOCMP_readHeader(uint8_t pg, uint16_t ofs, NVOCMP_itemHdr_t *pHdr,
     }
 }
 
+/******************************************************************************
+ * @fn      NVOCMP_readNewestHeader
+ *
+ * @brief   Read the header of the newest item on the active page and check
+ *          the item. Items longer than NVOCMP_SMALLITEM are written data
+ *          first, so a power loss can leave data without a header there.
+ *
+ * @param   pNvHandle - pointer to NV handle
+ * @param   iHdr - pointer to header buffer
+ *
+ * @return  true if the item is complete
+ */
+static bool NVOCMP_readNewestHeader(NVOCMP_nvHandle_t *pNvHandle, NVOCMP_itemHdr_t *iHdr)
+{
+    uint16_t hOfs = pNvHandle->actOffset - NVOCMP_ITEMHDRLEN;
+
+    NVOCMP_readHeader(pNvHandle->actPage, hOfs, iHdr, false);
+    if(!(iHdr->stats & NVOCMP_FOLLOWBIT) || (iHdr->stats & NVOCMP_VALIDIDBIT) ||
+       (hOfs < NVOCMP_PGDATAOFS + iHdr->len))
+    {
+        return(false);
+    }
+    return(NVOCMP_verifyCRC(hOfs - iHdr->len, iHdr->len, iHdr->crc8,
+                            pNvHandle->actPage, false) == NVINTF_SUCCESS);
+}
+
 /******************************************************************************
  * @fn      NVOCMP_readItem
  *
@@ -3341,6 +3688,33 @@ static void NVOCMP_setItemInactive(NVOCMP_nvHandle_t *pNvHandle, uint8_t pg,
                                    uint16_t iOfs)
 {
     uint8_t tmp;
+#if defined(NVOCMP_ITEMINDEX) || defined(NVOCMP_INCCOMPACT)
+    NVOCMP_itemHdr_t iHdr;
+
+    NVOCMP_readHeader(pg, iOfs, &iHdr, false);
+#endif
+
+#ifdef NVOCMP_ITEMINDEX
+    if(NVOCMP_idxState == NVOCMP_IDXREADY)
+    {
+        // Drop the index entry if it refers to this instance
+        NVOCMP_idxRemove(iHdr.cmpid, pg, iOfs);
+    }
+#endif
+#ifdef NVOCMP_INCCOMPACT
+    // Space that compacting this page will reclaim
+    NVOCMP_pgInactive[pg] += NVOCMP_ITEMHDRLEN + iHdr.len;
+#endif
+#ifdef NVOCMP_STEPCOPY
+    // Drop the copy a background compaction already made of this item
+    if(NVOCMP_stepCopy && (pg == pNvHandle->headPage) &&
+       ((iOfs < NVOCMP_stepEnd) ||
+        ((iOfs >= pNvHandle->compactInfo.xSrcEOffset) &&
+         (iOfs < pNvHandle->compactInfo.xSrcSOffset))))
+    {
+        NVOCMP_stepDropCopy(pNvHandle, iHdr.cmpid);
+    }
+#endif
 
     // Get byte with validity bit
     tmp = NVOCMP_readByte(pg, iOfs + NVOCMP_HDRVLDOFS);
@@ -3592,6 +3966,20 @@ static int8_t NVOCMP_findItem(NVOCMP_nvHandle_t *pNvHandle, uint8_t pg, uint16_t
 #endif
     uint32_t cid = NVOCMP_CMPRID(pHdr->sysid,pHdr->itemid,pHdr->subid);
 
+#ifdef NVOCMP_ITEMINDEX
+    // Exact lookups starting at the newest item can be answered by the index
+    if((flag == NVOCMP_FINDSTRICT) && (pg == pNvHandle->actPage) &&
+       (ofs == pNvHandle->actOffset))
+    {
+        int8_t status;
+
+        if(NVOCMP_idxFind(pNvHandle, pHdr, &status))
+        {
+            return(status);
+        }
+    }
+#endif
+
 #ifdef NVOCMP_GPRAM
     NVOCMP_disableCache(&vm);
 #endif
@@ -3743,6 +4131,20 @@ static int8_t NVOCMP_findItem(NVOCMP_nvHandle_t *pNvHandle, uint8_t pg, uint16_t
     uint16_t items = 0;
     uint32_t cid = NVOCMP_CMPRID(pHdr->sysid,pHdr->itemid,pHdr->subid);
 
+#ifdef NVOCMP_ITEMINDEX
+    // Exact lookups starting at the newest item can be answered by the index
+    if((flag == NVOCMP_FINDSTRICT) && (pg == pNvHandle->actPage) &&
+       (ofs == pNvHandle->actOffset))
+    {
+        int8_t status;
+
+        if(NVOCMP_idxFind(pNvHandle, pHdr, &status))
+        {
+            return(status);
+        }
+    }
+#endif
+
 #if (NVOCMP_NVPAGES > NVOCMP_NVTWOP)
     uint16_t nvSearched = 0;
     for(p = pg; nvSearched < NVOCMP_NVSIZE; p = NVOCMP_DECPAGE(p), ofs = pNvHandle->pageInfo[p].offset)
@@ -3877,6 +4279,283 @@ static int8_t NVOCMP_findItem(NVOCMP_nvHandle_t *pNvHandle, uint8_t pg, uint16_t
 }
 #endif
 
+#ifdef NVOCMP_ITEMINDEX
+/******************************************************************************
+ * @fn      NVOCMP_idxHash
+ *
+ * @brief   Map a compressed item ID to its home slot in the item index
+ *
+ * @param   cmpid - compressed item ID
+ *
+ * @return  Index slot
+ */
+static inline uint16_t NVOCMP_idxHash(uint32_t cmpid)
+{
+    // Fold sysid/itemid into subid bits, then scramble
+    cmpid ^= (cmpid >> NVOCMP_CMPSPACE) ^ (cmpid >> (2 * NVOCMP_CMPSPACE));
+    cmpid *= 0x9E3779B1;
+
+    return((uint16_t)(cmpid >> 16) & NVOCMP_IDXMASK);
+}
+
+/******************************************************************************
+ * @fn      NVOCMP_idxLookup
+ *
+ * @brief   Find the index slot holding a compressed item ID
+ *
+ * @param   cmpid - compressed item ID
+ *
+ * @return  Pointer to slot or NULL if the ID is not indexed
+ */
+static NVOCMP_idxEntry_t *NVOCMP_idxLookup(uint32_t cmpid)
+{
+    uint16_t i;
+    uint16_t n;
+    NVOCMP_idxEntry_t *pEntry;
+
+    i = NVOCMP_idxHash(cmpid);
+    for(n = 0; n < NVOCMP_ITEMINDEX_SIZE; n++)
+    {
+        pEntry = &NVOCMP_idxTable[i];
+        if(pEntry->cmpid == cmpid)
+        {
+            return(pEntry);
+        }
+        if(pEntry->cmpid == NVOCMP_IDXEMPTY)
+        {
+            break;
+        }
+        i = (i + 1) & NVOCMP_IDXMASK;
+    }
+
+    return(NULL);
+}
+
+/******************************************************************************
+ * @fn      NVOCMP_idxInsert
+ *
+ * @brief   Record the location of an item instance in the item index. When
+ *          the index runs out of room it is suspended until the next rebuild.
+ *
+ * @param   cmpid - compressed item ID
+ * @param   pg - page of item header
+ * @param   hofs - offset of item header
+ * @param   replace - true to overwrite an existing entry for this ID
+ *
+ * @return  none
+ */
+static void NVOCMP_idxInsert(uint32_t cmpid, uint8_t pg, uint16_t hofs, bool replace)
+{
+    uint16_t i;
+    uint16_t n;
+    uint16_t slot = NVOCMP_ITEMINDEX_SIZE;
+    NVOCMP_idxEntry_t *pEntry;
+
+    if(NVOCMP_idxState != NVOCMP_IDXREADY)
+    {
+        return;
+    }
+
+    i = NVOCMP_idxHash(cmpid);
+    for(n = 0; n < NVOCMP_ITEMINDEX_SIZE; n++)
+    {
+        pEntry = &NVOCMP_idxTable[i];
+        if(pEntry->cmpid == cmpid)
+        {
+            if(replace)
+            {
+                pEntry->hpage = pg;
+                pEntry->hofs = hofs;
+            }
+            return;
+        }
+        if(pEntry->cmpid == NVOCMP_IDXDELETED)
+        {
+            // Reuse first deleted slot on the probe path
+            if(slot == NVOCMP_ITEMINDEX_SIZE)
+            {
+                slot = i;
+            }
+        }
+        else if(pEntry->cmpid == NVOCMP_IDXEMPTY)
+        {
+            if(slot == NVOCMP_ITEMINDEX_SIZE)
+            {
+                if(NVOCMP_idxUsed >= NVOCMP_IDXMAXLOAD)
+                {
+                    NVOCMP_ALERT(false, "Item index full, using page traversal.")
+                    NVOCMP_idxState = NVOCMP_IDXOFF;
+                    return;
+                }
+                NVOCMP_idxUsed++;
+                slot = i;
+            }
+            break;
+        }
+        i = (i + 1) & NVOCMP_IDXMASK;
+    }
+
+    if(slot == NVOCMP_ITEMINDEX_SIZE)
+    {
+        NVOCMP_idxState = NVOCMP_IDXOFF;
+        return;
+    }
+
+    pEntry = &NVOCMP_idxTable[slot];
+    pEntry->cmpid = cmpid;
+    pEntry->hpage = pg;
+    pEntry->hofs = hofs;
+}
+
+/******************************************************************************
+ * @fn      NVOCMP_idxRemove
+ *
+ * @brief   Remove an item instance from the item index
+ *
+ * @param   cmpid - compressed item ID
+ * @param   pg - page of item header
+ * @param   hofs - offset of item header
+ *
+ * @return  none
+ */
+static void NVOCMP_idxRemove(uint32_t cmpid, uint8_t pg, uint16_t hofs)
+{
+    NVOCMP_idxEntry_t *pEntry;
+
+    if(NVOCMP_idxState != NVOCMP_IDXREADY)
+    {
+        return;
+    }
+
+    pEntry = NVOCMP_idxLookup(cmpid);
+    // Only forget the ID if the index refers to this instance
+    if((pEntry != NULL) && (pEntry->hpage == pg) && (pEntry->hofs == hofs))
+    {
+        pEntry->cmpid = NVOCMP_IDXDELETED;
+    }
+}
+
+/******************************************************************************
+ * @fn      NVOCMP_idxBuild
+ *
+ * @brief   Rebuild the item index with one traversal of the item headers,
+ *          visiting pages in the same order as NVOCMP_findItem()
+ *
+ * @param   pNvHandle - pointer to NV handle
+ *
+ * @return  true if the index is usable
+ */
+static bool NVOCMP_idxBuild(NVOCMP_nvHandle_t *pNvHandle)
+{
+    uint8_t p = pNvHandle->actPage;
+    uint16_t ofs = pNvHandle->actOffset;
+
+    memset(NVOCMP_idxTable, 0xFF, sizeof(NVOCMP_idxTable));
+    NVOCMP_idxUsed = 0;
+    NVOCMP_idxState = NVOCMP_IDXREADY;
+
+#if (NVOCMP_NVPAGES > NVOCMP_NVTWOP)
+    uint16_t nvSearched = 0;
+    for(; (NVOCMP_idxState == NVOCMP_IDXREADY) && (nvSearched < NVOCMP_NVSIZE);
+        p = NVOCMP_DECPAGE(p), ofs = pNvHandle->pageInfo[p].offset)
+    {
+      nvSearched++;
+      if(p == pNvHandle->tailPage)
+      {
+        continue;
+      }
+#endif
+      while((NVOCMP_idxState == NVOCMP_IDXREADY) && (ofs >= (NVOCMP_PGDATAOFS + NVOCMP_ITEMHDRLEN)))
+      {
+          NVOCMP_itemHdr_t iHdr;
+
+          // Align to start of item header
+          ofs -= NVOCMP_ITEMHDRLEN;
+
+          // Read and decompress item header
+          NVOCMP_readHeader(p, ofs, &iHdr, false);
+
+          if(!(iHdr.stats & NVOCMP_FOLLOWBIT) || (iHdr.len >= ofs))
+          {
+              // Corruption is recovered by NVOCMP_findItem(), not here
+              NVOCMP_idxState = NVOCMP_IDXOFF;
+              break;
+          }
+
+          if((iHdr.stats & NVOCMP_ACTIVEIDBIT) &&
+            !(iHdr.stats & NVOCMP_VALIDIDBIT))
+          {
+              // Newer instances are visited first and take precedence
+              NVOCMP_idxInsert(iHdr.cmpid, p, ofs, false);
+          }
+
+          // Jump to next item
+          ofs -= iHdr.len;
+      }
+#if (NVOCMP_NVPAGES > NVOCMP_NVTWOP)
+    }
+#endif
+
+    return(NVOCMP_idxState == NVOCMP_IDXREADY);
+}
+
+/******************************************************************************
+ * @fn      NVOCMP_idxFind
+ *
+ * @brief   Resolve an exact item lookup through the item index
+ *
+ * @param   pNvHandle - pointer to NV handle
+ * @param   pHdr - pointer to item header
+ * @param   pStatus - NVINTF_SUCCESS or NVINTF_NOTFOUND when resolved
+ *
+ * @return  true if resolved, false if a page traversal is required
+ */
+static bool NVOCMP_idxFind(NVOCMP_nvHandle_t *pNvHandle, NVOCMP_itemHdr_t *pHdr,
+                           int8_t *pStatus)
+{
+    NVOCMP_itemHdr_t iHdr;
+    NVOCMP_idxEntry_t *pEntry;
+    uint32_t cid = NVOCMP_CMPRID(pHdr->sysid,pHdr->itemid,pHdr->subid);
+
+    if(pNvHandle->actPage == NVOCMP_NULLPAGE)
+    {
+        return(false);
+    }
+
+    if(NVOCMP_idxState == NVOCMP_IDXSTALE)
+    {
+        (void)NVOCMP_idxBuild(pNvHandle);
+    }
+    if(NVOCMP_idxState != NVOCMP_IDXREADY)
+    {
+        return(false);
+    }
+
+    pEntry = NVOCMP_idxLookup(cid);
+    if(pEntry == NULL)
+    {
+        pHdr->hofs = 0;
+        *pStatus = NVINTF_NOTFOUND;
+        return(true);
+    }
+
+    // Confirm the index against the header in Flash
+    NVOCMP_readHeader(pEntry->hpage, pEntry->hofs, &iHdr, false);
+    if((iHdr.cmpid == cid) && (iHdr.stats & NVOCMP_ACTIVEIDBIT) &&
+      !(iHdr.stats & NVOCMP_VALIDIDBIT))
+    {
+        memcpy(pHdr, &iHdr, sizeof(NVOCMP_itemHdr_t));
+        *pStatus = NVINTF_SUCCESS;
+        return(true);
+    }
+
+    // Stale entry, do not trust the index until it is rebuilt
+    NVOCMP_ALERT(false, "Item index out of date.")
+    NVOCMP_idxState = NVOCMP_IDXSTALE;
+    return(false);
+}
+#endif // NVOCMP_ITEMINDEX
+
 #if (NVOCMP_NVPAGES > NVOCMP_NVTWOP)
 /******************************************************************************
  * @fn      NVOCMP_cleanPage
@@ -3986,6 +4665,11 @@ static int16_t NVOCMP_compactPage(NVOCMP_nvHandle_t *pNvHandle, uint16_t nBytes)
     return(0);
   }
 
+#ifdef NVOCMP_ITEMINDEX
+  // Items are about to be relocated
+  NVOCMP_idxState = NVOCMP_IDXSTALE;
+#endif
+
   srcPg = pNvHandle->headPage;
   dstPg = pNvHandle->tailPage;
   compactPages = NVOCMP_NVSIZE - 1;
@@ -3998,7 +4682,7 @@ static int16_t NVOCMP_compactPage(NVOCMP_nvHandle_t *pNvHandle, uint16_t nBytes)
     pNvHandle->compactInfo.xSrcPages = NVOCMP_NVSIZE - 1;
   }
 
-  // mark page mode
+  // nothing to reclaim when all items are active
   for(pg = 0; pg < NVOCMP_NVSIZE; pg++)
   {
     if(pg != dstPg)
@@ -4008,6 +4692,20 @@ static int16_t NVOCMP_compactPage(NVOCMP_nvHandle_t *pNvHandle, uint16_t nBytes)
       {
         allActivePages++;
       }
+    }
+  }
+
+  if((allActivePages == NVOCMP_NVSIZE - 1) && !pNvHandle->forceCompact)
+  {
+    return(0);
+  }
+
+  // mark page mode
+  for(pg = 0; pg < NVOCMP_NVSIZE; pg++)
+  {
+    if((pg != dstPg) && (pNvHandle->pageInfo[pg].mode != NVOCMP_PGCSRC))
+    {
+      NVOCMP_read(pg, NVOCMP_PGHDROFS, (uint8_t *)&pageHdr, NVOCMP_PGHDRLEN);
       if(pageHdr.state == NVOCMP_PGACT || pageHdr.state == NVOCMP_PGFULL)
       {
         mode = NVOCMP_PGCSRC;
@@ -4017,11 +4715,6 @@ static int16_t NVOCMP_compactPage(NVOCMP_nvHandle_t *pNvHandle, uint16_t nBytes)
     }
   }
 
-  if((allActivePages == NVOCMP_NVSIZE - 1) && !pNvHandle->forceCompact)
-  {
-    return(0);
-  }
-
   while(compactPages)
   {
     if(pNvHandle->compactInfo.xSrcPages == 0)
@@ -4065,6 +4758,7 @@ static int16_t NVOCMP_compactPage(NVOCMP_nvHandle_t *pNvHandle, uint16_t nBytes)
     pNvHandle->compactInfo.xSrcSOffset = pNvHandle->pageInfo[srcPg].offset;
     pNvHandle->compactInfo.xSrcEPage = NVOCMP_NULLPAGE;
     pNvHandle->compactInfo.xSrcEOffset = 0;
+    NVOCMP_PERFINC(compactions, 1);
     status = NVOCMP_compact(pNvHandle);
 
     if(status == NVOCMP_COMPACT_FAILURE)
@@ -4201,6 +4895,31 @@ static int16_t NVOCMP_compactPage(NVOCMP_nvHandle_t *pNvHandle, uint16_t nBytes)
     return(0);
   }
 
+#ifdef NVOCMP_ITEMINDEX
+  // Items are about to be relocated
+  NVOCMP_idxState = NVOCMP_IDXSTALE;
+#endif
+
+#ifdef NVOCMP_STEPCOPY
+  if(NVOCMP_stepCopy && pNvHandle->forceCompact)
+  {
+    // Start over from the corrupted page
+    NVOCMP_stepCancel(pNvHandle);
+  }
+  else if(NVOCMP_stepCopy)
+  {
+    // Finish the background copy, it reclaims what was inactive when it
+    // started. Compact the result only if that is not enough.
+    (void)NVOCMP_stepCopyItems(pNvHandle, NVOCMP_NULLOFFSET);
+    needBytes = nBytes ? nBytes : 16;
+    if((NVOCMP_failW == NVINTF_SUCCESS) &&
+       (FLASH_PAGE_SIZE - pNvHandle->actOffset >= needBytes))
+    {
+      return(FLASH_PAGE_SIZE - pNvHandle->actOffset);
+    }
+  }
+#endif
+
 #if(NVOCMP_NVPAGES == NVOCMP_NVONEP)
   srcPg = 0;
   dstPg = 0;
@@ -4239,6 +4958,7 @@ static int16_t NVOCMP_compactPage(NVOCMP_nvHandle_t *pNvHandle, uint16_t nBytes)
 #endif
 
   pNvHandle->compactInfo.xSrcSOffset = pNvHandle->pageInfo[srcPg].offset;
+  NVOCMP_PERFINC(compactions, 1);
   status = NVOCMP_compact(pNvHandle);
 
   if(status == NVOCMP_COMPACT_FAILURE)
@@ -4300,6 +5020,205 @@ static int16_t NVOCMP_compactPage(NVOCMP_nvHandle_t *pNvHandle, uint16_t nBytes)
 }
 #endif
 
+#ifdef NVOCMP_STEPCOPY
+/******************************************************************************
+ * @fn      NVOCMP_stepCopyItems
+ *
+ * @brief   Run one step of a background compaction: copy at most maxItems
+ *          active items of the head page into the tail page, and switch
+ *          the pages once every active item has been copied
+ *
+ *          Items are copied from the newest down, so their order on the
+ *          tail page is reversed as with NVOCMP_COMPR. Items written after
+ *          a pass started are copied by another pass, down to where that
+ *          pass started. Between steps compactInfo holds where to resume:
+ *          xSrcSOffset is where the pass started, xSrcEOffset the end of
+ *          the next item to look at and xDstOffset the end of the copied
+ *          items. The head page stays the active page until the switch, so
+ *          a reset only loses the partial copy (see NVOCMP_initNv()).
+ *
+ * @param   pNvHandle - pointer to NV handle
+ * @param   maxItems - maximum number of items to copy
+ *
+ * @return  NVINTF_SUCCESS or specific failure code
+ */
+static uint8_t NVOCMP_stepCopyItems(NVOCMP_nvHandle_t *pNvHandle, uint16_t maxItems)
+{
+  NVOCMP_itemHdr_t iHdr;
+  uint8_t srcPg = pNvHandle->headPage;
+  uint8_t dstPg = pNvHandle->tailPage;
+  uint16_t srcOff;
+  uint16_t dstOff;
+  uint16_t itemSize;
+  uint16_t items = 0;
+  bool corrupt = false;
+  uint8_t err;
+
+  NVOCMP_failW = NVINTF_SUCCESS;
+
+  if(!NVOCMP_stepCopy)
+  {
+    // Start copying the whole head page, a reset drops the copy of a
+    // tail page in this mode
+    NVOCMP_writeByte(dstPg, NVOCMP_COMPMODEOFS, NVOCMP_PGCDST);
+    pNvHandle->pageInfo[dstPg].mode = NVOCMP_PGCDST;
+    pNvHandle->compactInfo.xDstPage = dstPg;
+    pNvHandle->compactInfo.xSrcSPage = srcPg;
+    pNvHandle->compactInfo.xSrcEPage = srcPg;
+    pNvHandle->compactInfo.xSrcPages = 1;
+    pNvHandle->compactInfo.xSrcSOffset = pNvHandle->actOffset;
+    pNvHandle->compactInfo.xSrcEOffset = pNvHandle->actOffset;
+    pNvHandle->compactInfo.xDstOffset = pNvHandle->pageInfo[dstPg].offset;
+    NVOCMP_stepEnd = NVOCMP_PGDATAOFS;
+    NVOCMP_stepCopy = (NVOCMP_failW == NVINTF_SUCCESS);
+    NVOCMP_PERFINC(compactions, 1);
+  }
+
+  srcOff = pNvHandle->compactInfo.xSrcEOffset;
+  dstOff = pNvHandle->compactInfo.xDstOffset;
+
+  while((items < maxItems) && (NVOCMP_failW == NVINTF_SUCCESS))
+  {
+    if(srcOff < NVOCMP_stepEnd + NVOCMP_ITEMHDRLEN)
+    {
+      if(pNvHandle->actOffset == pNvHandle->compactInfo.xSrcSOffset)
+      {
+        // Every active item has been copied
+        break;
+      }
+      // Copy the items written since this pass started
+      NVOCMP_stepEnd = pNvHandle->compactInfo.xSrcSOffset;
+      pNvHandle->compactInfo.xSrcSOffset = pNvHandle->actOffset;
+      srcOff = pNvHandle->actOffset;
+      continue;
+    }
+
+    NVOCMP_readHeader(srcPg, srcOff - NVOCMP_ITEMHDRLEN, &iHdr, false);
+    itemSize = NVOCMP_ITEMHDRLEN + iHdr.len;
+    if((NVOCMP_SIGNATURE != iHdr.sig) || (srcOff < NVOCMP_stepEnd + itemSize))
+    {
+      NVOCMP_ALERT(false, "Item header corrupted, background compaction stopped.")
+      corrupt = true;
+      break;
+    }
+
+    if(!(iHdr.stats & NVOCMP_VALIDIDBIT) && (iHdr.stats & NVOCMP_ACTIVEIDBIT))
+    {
+      if(NVOCMP_verifyCRC(srcOff - itemSize, iHdr.len, iHdr.crc8, srcPg, false))
+      {
+        NVOCMP_ALERT(false, "Item CRC incorrect, background compaction stopped.")
+        corrupt = true;
+        break;
+      }
+      if(dstOff + itemSize > FLASH_PAGE_SIZE)
+      {
+        // Cannot happen, the tail page only gets items of the head page
+        corrupt = true;
+        break;
+      }
+      NVOCMP_copyItem(srcPg, dstPg, srcOff - itemSize, dstOff, itemSize);
+      dstOff += itemSize;
+      items++;
+    }
+    srcOff -= itemSize;
+  }
+
+  pNvHandle->compactInfo.xSrcEOffset = srcOff;
+  pNvHandle->compactInfo.xDstOffset = dstOff;
+  pNvHandle->pageInfo[dstPg].offset = dstOff;
+  err = NVOCMP_failW;
+
+  if(corrupt || (err != NVINTF_SUCCESS))
+  {
+    NVOCMP_stepCancel(pNvHandle);
+    if(corrupt)
+    {
+      // A blocking compaction scans past corrupted items
+      pNvHandle->forceCompact = 1;
+      (void)NVOCMP_compactPage(pNvHandle, 0);
+    }
+    return((err != NVINTF_SUCCESS) ? err : NVOCMP_failW);
+  }
+
+  if((srcOff < NVOCMP_stepEnd + NVOCMP_ITEMHDRLEN) &&
+     (pNvHandle->actOffset == pNvHandle->compactInfo.xSrcSOffset))
+  {
+    // Switch pages. Both pages hold every active item until the head page
+    // is erased, so the tail page is made active first and the head page is
+    // not marked as a compaction source.
+    NVOCMP_setCompactHdr(dstPg, srcPg, pNvHandle->compactInfo.xSrcSOffset, XSRCSTARTHDR);
+    NVOCMP_setCompactHdr(dstPg, srcPg, srcOff, XSRCENDHDR);
+    if(FLASH_PAGE_SIZE - dstOff >= 16)
+    {
+      NVOCMP_changePageState(pNvHandle, dstPg, NVOCMP_PGACT);
+    }
+    else
+    {
+      NVOCMP_changePageState(pNvHandle, dstPg, NVOCMP_PGFULL);
+    }
+    NVOCMP_failW |= NVOCMP_erase(pNvHandle, srcPg);
+
+    NVOCMP_writeByte(dstPg, NVOCMP_COMPMODEOFS, NVOCMP_PGCDONE);
+    pNvHandle->pageInfo[dstPg].mode = NVOCMP_PGCDONE;
+
+    pNvHandle->tailPage = srcPg;
+    pNvHandle->headPage = dstPg;
+    pNvHandle->actPage = dstPg;
+    pNvHandle->actOffset = dstOff;
+    NVOCMP_changePageState(pNvHandle, srcPg, NVOCMP_PGXDST);
+  }
+
+  return(NVOCMP_failW);
+}
+
+/******************************************************************************
+ * @fn      NVOCMP_stepCancel
+ *
+ * @brief   Drop the partial copy of a background compaction
+ *
+ * @param   pNvHandle - pointer to NV handle
+ *
+ * @return  none
+ */
+static void NVOCMP_stepCancel(NVOCMP_nvHandle_t *pNvHandle)
+{
+  NVOCMP_failW = NVOCMP_erase(pNvHandle, pNvHandle->tailPage);
+  NVOCMP_changePageState(pNvHandle, pNvHandle->tailPage, NVOCMP_PGXDST);
+}
+
+/******************************************************************************
+ * @fn      NVOCMP_stepDropCopy
+ *
+ * @brief   Mark inactive the copy a background compaction made of an item
+ *          that is being made inactive on the head page
+ *
+ * @param   pNvHandle - pointer to NV handle
+ * @param   cmpid - compressed ID of the item
+ *
+ * @return  none
+ */
+static void NVOCMP_stepDropCopy(NVOCMP_nvHandle_t *pNvHandle, uint32_t cmpid)
+{
+  NVOCMP_itemHdr_t iHdr;
+  uint8_t dstPg = pNvHandle->tailPage;
+  uint16_t ofs = pNvHandle->compactInfo.xDstOffset;
+
+  // The copies were just written, their lengths can be trusted
+  while(ofs >= (NVOCMP_PGDATAOFS + NVOCMP_ITEMHDRLEN))
+  {
+    ofs -= NVOCMP_ITEMHDRLEN;
+    NVOCMP_readHeader(dstPg, ofs, &iHdr, false);
+    if((iHdr.cmpid == cmpid) && (iHdr.stats & NVOCMP_ACTIVEIDBIT) &&
+      !(iHdr.stats & NVOCMP_VALIDIDBIT))
+    {
+      NVOCMP_setItemInactive(pNvHandle, dstPg, ofs);
+      return;
+    }
+    ofs -= iHdr.len;
+  }
+}
+#endif // NVOCMP_STEPCOPY
+
 /******************************************************************************
 * @fn      NVOCMP_findSignature
 *
@@ -4352,6 +5271,7 @@ static NVOCMP_compactStatus_t NVOCMP_compact(NVOCMP_nvHandle_t *pNvHandle)
 {
     bool needScan = false;
     bool needSkip = false;
+    bool needCheck = true;   // newest item may lack its header after a power loss
     bool dstFull = false;
     uint16_t dstOff;
     uint16_t endOff;
@@ -4404,6 +5324,9 @@ static NVOCMP_compactStatus_t NVOCMP_compact(NVOCMP_nvHandle_t *pNvHandle)
 
         if(srcOff <= endOff)
         {
+          // No item left, a scan past a corrupted item can stop short of
+          // the data start. The page is erased once compacted.
+          srcOff = NVOCMP_PGDATAOFS;
           if(aItem)
           {
             pNvHandle->pageInfo[srcPg].offset = srcOff;
@@ -4417,6 +5340,7 @@ static NVOCMP_compactStatus_t NVOCMP_compact(NVOCMP_nvHandle_t *pNvHandle)
             srcPg = NVOCMP_INCPAGE(srcPg);
             srcOff = pNvHandle->pageInfo[srcPg].offset;
             aItem = 0;
+            needCheck = true;
             continue;
           }
         }
@@ -4443,22 +5367,27 @@ static NVOCMP_compactStatus_t NVOCMP_compact(NVOCMP_nvHandle_t *pNvHandle)
             }
             else
             {
-              if(!(srcHdr.stats & NVOCMP_VALIDIDBIT) && srcHdr.stats & NVOCMP_ACTIVEIDBIT)
+              if(needCheck ||
+                 (!(srcHdr.stats & NVOCMP_VALIDIDBIT) && srcHdr.stats & NVOCMP_ACTIVEIDBIT))
               {
                 NVOCMP_ALERT(srcOff >= (dataLen + NVOCMP_PGDATAOFS),
                              "Item header corrupted, data length too long.")
                 crcOff    = srcOff - dataLen;
-                if(NVOCMP_verifyCRC(crcOff,dataLen,srcHdr.crc8, srcPg, false))
+                if(NVOCMP_verifyCRC(crcOff,dataLen,srcHdr.crc8, srcPg, false) ||
+                   (needCheck && (crcOff != NVOCMP_PGDATAOFS) &&
+                    (NVOCMP_readByte(srcPg, crcOff - 1) != NVOCMP_SIGNATURE)))
                 {
-                  // Invalid CRC, corruption
+                  // Invalid CRC, or an item in the middle of another one,
+                  // corruption
                   NVOCMP_ALERT(false, "Item CRC incorrect!")
                   needScan = true;
-                  srcOff--;
                 }
                 else
                 {
                   needScan = false;
-                  needSkip = false;
+                  needSkip = (srcHdr.stats & NVOCMP_VALIDIDBIT) ||
+                             !(srcHdr.stats & NVOCMP_ACTIVEIDBIT);
+                  needCheck = false;
                 }
               }
               else
@@ -4470,19 +5399,23 @@ static NVOCMP_compactStatus_t NVOCMP_compact(NVOCMP_nvHandle_t *pNvHandle)
 
             if(needScan)
             {
-              // Detected a problem, find next header (scan for signature)
+              // Detected a problem, find next header (scan for signature).
+              // Resume below the bad signature byte, a header may end within
+              // the bytes read as this one.
               NVOCMP_ALERT(false, "Attempting to find signature...")
+              srcOff += NVOCMP_ITEMHDRLEN - 1;
               bool foundSig = NVOCMP_findSignature(srcPg, &srcOff);
               if(!foundSig)
               {
-#ifdef NVOCMP_GPRAM
-                NVOCMP_restoreCache(vm);
-#endif
                 // If we get here and foundSig is false, we never found another
-                // item in the page
+                // item in the page, go on with the next source page so that
+                // the items of the other pages are kept
                 NVOCMP_ALERT(foundSig, "Attempt to find signature failed.")
-                return(NVOCMP_COMPACT_FAILURE);
+                srcOff = NVOCMP_PGDATAOFS;
               }
+              // The length of a header found by scanning is trusted once
+              // its item passes the CRC check
+              needCheck = true;
             }
             else
             {
@@ -4592,6 +5525,7 @@ static NVOCMP_compactStatus_t NVOCMP_compact(NVOCMP_nvHandle_t *pNvHandle)
 {
     bool needScan = false;
     bool needSkip = false;
+    bool needCheck = true;   // newest item may lack its header after a power loss
     uint16_t dstOff;
     uint16_t endOff;
     uint16_t srcOff;
@@ -4657,20 +5591,25 @@ static NVOCMP_compactStatus_t NVOCMP_compact(NVOCMP_nvHandle_t *pNvHandle)
             }
             else
             {
-              if(!(srcHdr.stats & NVOCMP_VALIDIDBIT) && (srcHdr.stats & NVOCMP_ACTIVEIDBIT)) //valid bit is ok
+              if(needCheck ||
+                 (!(srcHdr.stats & NVOCMP_VALIDIDBIT) && (srcHdr.stats & NVOCMP_ACTIVEIDBIT))) //valid bit is ok
               {
                 crcOff    = srcOff - dataLen;
-                if(NVOCMP_verifyCRC(crcOff,dataLen,srcHdr.crc8, srcPg, false))
+                if(NVOCMP_verifyCRC(crcOff,dataLen,srcHdr.crc8, srcPg, false) ||
+                   (needCheck && (crcOff != NVOCMP_PGDATAOFS) &&
+                    (NVOCMP_readByte(srcPg, crcOff - 1) != NVOCMP_SIGNATURE)))
                 {
-                  // Invalid CRC, corruption
+                  // Invalid CRC, or an item in the middle of another one,
+                  // corruption
                   NVOCMP_ALERT(false, "Item CRC incorrect!")
                   needScan = true;
-                  srcOff--;
                 }
                 else
                 {
                   needScan = false;
-                  needSkip = false;
+                  needSkip = (srcHdr.stats & NVOCMP_VALIDIDBIT) ||
+                             !(srcHdr.stats & NVOCMP_ACTIVEIDBIT);
+                  needCheck = false;
                 }
               }
               else
@@ -4682,8 +5621,11 @@ static NVOCMP_compactStatus_t NVOCMP_compact(NVOCMP_nvHandle_t *pNvHandle)
 
             if(needScan)
             {
-              // Detected a problem, find next header (scan for signature)
+              // Detected a problem, find next header (scan for signature).
+              // Resume below the bad signature byte, a header may end within
+              // the bytes read as this one.
               NVOCMP_ALERT(false, "Attempting to find signature...")
+              srcOff += NVOCMP_ITEMHDRLEN - 1;
               bool foundSig = NVOCMP_findSignature(srcPg, &srcOff);
               if(!foundSig)
               {
@@ -4694,6 +5636,9 @@ static NVOCMP_compactStatus_t NVOCMP_compact(NVOCMP_nvHandle_t *pNvHandle)
                 NVOCMP_ALERT(foundSig, "Attempt to find signature failed.")
                 break;
               }
+              // The length of a header found by scanning is trusted once
+              // its item passes the CRC check
+              needCheck = true;
             }
             else
             {
@@ -4767,7 +5712,7 @@ static NVOCMP_compactStatus_t NVOCMP_compact(NVOCMP_nvHandle_t *pNvHandle)
 }
 #endif
 
-#if ((NVOCMP_NVPAGES > NVOCMP_NVONEP) && !defined(NVOCMP_MIGRATE_DISABLED))
+#if ((NVOCMP_NVPAGES > NVOCMP_NVONEP) && (!defined(NVOCMP_MIGRATE_DISABLED) || defined(NVOCMP_STEPCOPY)))
 /******************************************************************************
  * @fn      NVOCMP_copyItem
  *
@@ -4865,18 +5810,17 @@ static uint8_t NVOCMP_doNVCRC(uint8_t pg, uint16_t ofs, uint16_t len, uint8_t cr
     uint8_t tmp[NVOCMP_XFERBLKMAX];
     crc_t newCRC = (crc_t)crc;
 
+    if(flag)
+    {
+        // Page is cached in RAM, no need to copy it out in blocks
+        return(crc_update(newCRC, pTBuffer + ofs, len));
+    }
+
     // Read flash and compute CRC in blocks
     while(len > 0)
     {
         rdLen  = (len < NVOCMP_XFERBLKMAX ? len : NVOCMP_XFERBLKMAX);
-        if(flag)
-        {
-          memcpy((uint8_t *)tmp, (uint8_t *)(pTBuffer+ofs), rdLen);
-        }
-        else
-        {
-          NVOCMP_read(pg, ofs, tmp, rdLen);
-        }
+        NVOCMP_read(pg, ofs, tmp, rdLen);
         newCRC = crc_update(newCRC,tmp,rdLen);
         len   -= rdLen;
         ofs   += rdLen;
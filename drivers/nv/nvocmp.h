@@ -82,6 +82,24 @@ NVOCMP_diag_t;
 
 // Low Voltage Check Callback function, voltage is measured voltage value
 typedef void (*lowVoltCbFptr)(uint32_t voltage);
+
+#ifdef NVOCMP_PERFSTATS
+// Maximum number of NV pages supported by the driver
+#define NVOCMP_PERFMAXPAGES 5
+
+// NV driver Flash activity counters (RAM only, not persisted)
+typedef struct
+{
+    uint32_t bytesWritten;  // Bytes programmed into Flash, including compaction
+    uint32_t itemBytes;     // Item bytes (data + header) written by the API
+    uint32_t writes;        // Flash program operations
+    uint32_t hdrReads;      // Item headers read and decoded
+    uint16_t compactions;   // Compaction passes
+    uint16_t compactSteps;  // Background compaction steps (NVOCMP_INCCOMPACT)
+    uint16_t erases[NVOCMP_PERFMAXPAGES]; // Erases per NV page
+}
+NVOCMP_perfStats_t;
+#endif // NVOCMP_PERFSTATS
 //*****************************************************************************
 // Functions
 //*****************************************************************************
@@ -154,6 +172,53 @@ extern void NVOCMP_setCheckVoltage(void *funcPtr);
  */
 extern void NVOCMP_setLowVoltageCb(lowVoltCbFptr funcPtr);
 
+#ifdef NVOCMP_INCCOMPACT
+/**
+ * @fn      NVOCMP_compactStep
+ *
+ * @brief   Global function to run one bounded step of background compaction.
+ *          When free NV space is below minFree and enough inactive bytes
+ *          can be reclaimed, a step copies a few items into the tail page
+ *          (two pages) or compacts one source page into it (more pages).
+ *          Steps go on until twice minFree is free. Call it periodically
+ *          from a low priority task (it takes the driver mutex) so that
+ *          writes rarely have to wait for a compaction, and sooner while
+ *          it returns NVINTF_SUCCESS.
+ *
+ * @param   minFree - free bytes in NV below which a step is run
+ *
+ * @return  NVINTF_SUCCESS if a step ran (with more than two pages: and
+ *          reclaimed space), NVINTF_BADPARAM if no step was needed or
+ *          worth it, or specific failure code
+ */
+extern uint8_t NVOCMP_compactStep(uint16_t minFree);
+#endif // NVOCMP_INCCOMPACT
+
+#ifdef NVOCMP_PERFSTATS
+/**
+ * @fn      NVOCMP_getPerfStats
+ *
+ * @brief   Global function to copy the Flash activity counters. Write
+ *          amplification is bytesWritten / itemBytes.
+ *
+ * @param   pStats - pointer to caller's counter buffer
+ *
+ * @return  none
+ */
+extern void NVOCMP_getPerfStats(NVOCMP_perfStats_t *pStats);
+
+/**
+ * @fn      NVOCMP_resetPerfStats
+ *
+ * @brief   Global function to clear the Flash activity counters
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+extern void NVOCMP_resetPerfStats(void);
+#endif // NVOCMP_PERFSTATS
+
 // Exception function can be defined to handle NV corruption issues
 // If none provided, NV module attempts to proceed ignoring problem
 #if !defined (NVOCMP_EXCEPTION)
@@ -755,6 +755,12 @@ ZStatus_t bdb_RepAddAttrCfgRecordDefaultToList(uint8_t endpoint, uint16_t cluste
  *          attribute value to validate the triggering of a reporting attribute message.
  */
 ZStatus_t bdb_RepChangedAttrValue(uint8_t endpoint, uint16_t cluster, uint16_t attrID); //newvalue must a a buffer of size 8
+
+/*
+ * @brief   Get the number of report frames sent and the number of frames saved
+ *          by coalescing reports within BDB_REPORTING_COALESCE_WINDOW.
+ */
+void bdb_RepGetCoalesceMetrics(uint32_t* pFramesSent, uint32_t* pFramesSaved);
 #endif
 
 /*****************************
@@ -246,6 +246,14 @@ extern "C"
 
 //Define the DISABLE_DEFAULT_RSP flag for reporting attributes
 #define BDB_REPORTING_DISABLE_DEFAULT_RSP  FALSE
+
+//Window in seconds to coalesce attribute reports. Value changed reports are
+//deferred up to this time so further changes go in the same frame, and periodic
+//reports due within it are sent along with the one triggering the report.
+//0 disables coalescing
+#ifndef BDB_REPORTING_COALESCE_WINDOW
+#define BDB_REPORTING_COALESCE_WINDOW      0
+#endif
 #endif
 
 /*********************************************************************
@@ -93,6 +93,10 @@
  */
 #define BDBREPORTING_HASBINDING_FLAG_MASK      0x01
 #define BDBREPORTING_NONEXTINCREMENT_FLAG_MASK 0x02
+#define BDBREPORTING_PENDINGREPORT_FLAG_MASK   0x04
+
+//Frame control, sequence number and command ID of a ZCL report frame
+#define BDBREPORTING_ZCL_HDR_LEN               3
 
 
 #if BDBREPORTING_MAX_ANALOG_ATTR_SIZE == 8
@@ -162,7 +166,11 @@ typedef struct
   uint16_t  cluster;          // to send or receive reports of the attribute
   uint16_t  consolidatedMinReportInt;             // attribute ID
   uint16_t  consolidatedMaxReportInt;           // attribute data type
-  uint16_t  timeSinceLastReport;
+  uint32_t  lastReportTime;     // bdb_reportingClock value of the last report
+  uint8_t   dueHeapIndex;       // position in bdb_reportingDueHeap or BDBREPORTING_INVALIDINDEX
+#if BDB_REPORTING_COALESCE_WINDOW > 0
+  uint32_t  pendingReportTime;  // bdb_reportingClock value to send a deferred report
+#endif
   bdbAttrLinkedListAttr_t attrLinkedList;
 } bdbReportAttrClusterEndpoint_t;
 
@@ -232,6 +240,20 @@ uint16_t bdb_reportingNextEventTimeout;
 //This variable hasthe index of the cluster-endpoint entry that trigger the current
 //timer use to report periodically
 uint8_t bdb_reportingNextClusterEndpointIndex;
+//Reporting clock in seconds, advanced by the elapsed time of the reporting timer.
+//Entries keep the absolute time of their last report instead of a per-entry counter
+uint32_t bdb_reportingClock;
+//Binary min-heap of cluster-endpoint indexes with periodic reporting, ordered by
+//the time their consolidatedMaxReportInt expires
+uint8_t bdb_reportingDueHeap[BDB_MAX_CLUSTERENDPOINTS_REPORTING];
+//Current size of the due time heap
+uint8_t bdb_reportingDueHeapCount;
+//Set when an entry may hold the no next increment flag, avoids walking the table otherwise
+uint8_t bdb_reportingNoIncrementPending;
+//Number of report frames sent
+uint32_t bdb_reportingFramesSent;
+//Number of report frames saved by coalescing reports within BDB_REPORTING_COALESCE_WINDOW
+uint32_t bdb_reportingFramesSaved;
 //This is the table that holds in the memory the attribute reporting configurations (dynamic table)
 bdbReportAttrCfgData_t* bdb_reportingAttrCfgRecordsArray;
 //Current size of the attribute reporting configurations table
@@ -273,8 +295,22 @@ static void bdb_clusterEndpointArrayFreeAll( void );
 static uint8_t bdb_clusterEndpointArraySearch( uint8_t endpoint, uint16_t cluster );
 static uint8_t bdb_clusterEndpointArrayRemoveAt( uint8_t index );
 static void bdb_clusterEndpointArrayIncrementAll( uint16_t timeSinceLastReportIncrement, uint8_t CheckNoIncrementFlag );
+static uint16_t bdb_clusterEndpointArrayGetTimeSinceLastReport( uint8_t index );
+static uint32_t bdb_clusterEndpointArrayGetDueTime( uint8_t index );
+static void bdb_clusterEndpointArrayReschedule( uint8_t index );
 //End: Cluster-endpoint array live methods
 
+//Begin: Due time heap methods
+#if BDB_REPORTING_COALESCE_WINDOW > 0
+static uint32_t bdb_dueHeapGetDueTime( uint8_t heapIndex );
+#endif
+static uint8_t bdb_dueHeapIsBefore( uint8_t indexA, uint8_t indexB );
+static void bdb_dueHeapSet( uint8_t heapIndex, uint8_t index );
+static void bdb_dueHeapSiftUp( uint8_t heapIndex );
+static void bdb_dueHeapSiftDown( uint8_t heapIndex );
+static void bdb_dueHeapRemove( uint8_t heapIndex );
+//End: Due time heap methods
+
 //Begin: Single linked list default attr cfg records methods
 static void bdb_repAttrDefaultCfgRecordInitValues( bdbReportAttrDefaultCfgData_t* item );
 static void bdb_repAttrDefaultCfgRecordsLinkedListInit( bdbRepAttrDefaultCfgRecordLinkedList_t *list );
@@ -311,6 +347,11 @@ static void bdb_RepStartReporting( void );
 static void bdb_RepStopEventTimer( void );
 static void bdb_RepSetupReporting( void );
 static void bdb_RepReport( uint8_t indexClusterEndpoint );
+static void bdb_RepSendReportCmd( bdbReportAttrClusterEndpoint_t* clusterEndpointItem, afAddrType_t* dstAddr, zclReportCmd_t* pReportCmd );
+#if BDB_REPORTING_COALESCE_WINDOW > 0
+static void bdb_RepReportDueWithinWindow( void );
+static void bdb_RepDeferReport( uint8_t indexClusterEndpoint, uint16_t elapsedTime, uint8_t isTimeRemaining );
+#endif
 
 extern zclAttrRecsList *zclFindAttrRecsList( uint8_t endpoint ); //Definition is located in zcl.h
 
@@ -470,8 +511,10 @@ static uint16_t bdb_RepCalculateEventElapsedTime( uint32_t remainingTimeoutTimer
  * @brief       Method that process the timer expired event in the reporting
  *              code, it calculate the next cluster-endpoint entry based
  *              on the minimum with consolidatedMaxReportInt - timeSinceLastReport,
- *              updates timeSinceLastReport of all entries. If the minimum is zero,
- *              report the cluster-endpoint attrs.
+ *              advances the reporting clock by the elapsed timeout. The minimum
+ *              is the root of the due time heap. If the minimum is zero,
+ *              report the cluster-endpoint attrs, along with any other entry
+ *              due within BDB_REPORTING_COALESCE_WINDOW.
  *
  * @return      none
  */
@@ -483,10 +526,10 @@ void bdb_RepProcessEvent( void )
   {
     return;
   }
-   uint16_t minVal = bdb_reportingClusterEndpointArray[minIndex].consolidatedMaxReportInt - bdb_reportingClusterEndpointArray[minIndex].timeSinceLastReport;
-   if( minVal>0 )
+   uint32_t dueTime = bdb_clusterEndpointArrayGetDueTime( minIndex );
+   if( dueTime > bdb_reportingClock )
    {
-     bdb_reportingNextEventTimeout = minVal;
+     bdb_reportingNextEventTimeout = (uint16_t)(dueTime - bdb_reportingClock);
    }
    else
    {
@@ -494,6 +537,9 @@ void bdb_RepProcessEvent( void )
      bdb_reportingNextClusterEndpointIndex = minIndex;
      bdb_RepReport( BDBREPORTING_INVALIDINDEX );
      bdb_clusterEndpointArrayUpdateAt( minIndex, 0, BDBREPORTING_IGNORE, BDBREPORTING_IGNORE );
+#if BDB_REPORTING_COALESCE_WINDOW > 0
+     bdb_RepReportDueWithinWindow( );
+#endif
      bdb_reportingNextEventTimeout = 0;
    }
    bdb_RepRestartNextEventTimer( );
@@ -1045,6 +1091,8 @@ static bdbLinkedListAttrItem_t* bdb_linkedListAttrGetAtIndex( bdbAttrLinkedListA
 static void bdb_clusterEndpointArrayInit( void )
 {
   bdb_reportingClusterEndpointArrayCount = 0;
+  bdb_reportingDueHeapCount = 0;
+  bdb_reportingNoIncrementPending = BDBREPORTING_FALSE;
 }
 
 /*********************************************************************
@@ -1070,7 +1118,8 @@ static uint8_t bdb_clusterEndpointArrayAdd( uint8_t endpoint, uint16_t cluster,
 
   bdb_reportingClusterEndpointArray[bdb_reportingClusterEndpointArrayCount].consolidatedMinReportInt = consolidatedMinReportInt;
   bdb_reportingClusterEndpointArray[bdb_reportingClusterEndpointArrayCount].consolidatedMaxReportInt = consolidatedMaxReportInt;
-  bdb_reportingClusterEndpointArray[bdb_reportingClusterEndpointArrayCount].timeSinceLastReport = timeSinceLastReport;
+  bdb_reportingClusterEndpointArray[bdb_reportingClusterEndpointArrayCount].lastReportTime = bdb_reportingClock - timeSinceLastReport;
+  bdb_reportingClusterEndpointArray[bdb_reportingClusterEndpointArrayCount].dueHeapIndex = BDBREPORTING_INVALIDINDEX;
   bdb_linkedListAttrInit( &bdb_reportingClusterEndpointArray[bdb_reportingClusterEndpointArrayCount].attrLinkedList );
   FLAGS_TURNOFFALLFLAGS( bdb_reportingClusterEndpointArray[bdb_reportingClusterEndpointArrayCount].flags );
 
@@ -1080,34 +1129,12 @@ static uint8_t bdb_clusterEndpointArrayAdd( uint8_t endpoint, uint16_t cluster,
 
 static uint8_t bdb_clusterEndpointArrayGetMin( void )
 {
-  uint8_t indexMin = 0xFF;
-  uint16_t ValueMin = 0xFFFF;
-  uint16_t possibleMin;
-  uint8_t i;
-  for( i=0; i<bdb_reportingClusterEndpointArrayCount; i++ )
+  //Only entries with binding and periodic reporting are kept in the heap
+  if( bdb_reportingDueHeapCount == 0 )
   {
-    if( FLAGS_CHECKFLAG( bdb_reportingClusterEndpointArray[i].flags, BDBREPORTING_HASBINDING_FLAG_MASK ) == BDBREPORTING_TRUE )
-    { //Only do with valid entries (HasBinding==true)
-      if( bdb_reportingClusterEndpointArray[i].consolidatedMaxReportInt != BDBREPORTING_NOPERIODIC &&
-         bdb_reportingClusterEndpointArray[i].consolidatedMaxReportInt != BDBREPORTING_REPORTOFF )
-      {
-        //If maxInterval is BDBREPORTING_NOPERIODIC=0x0000 or BDBREPORTING_REPORTOFF=0xFFFF, ignore to calculate min
-        if( ValueMin == 0 )
-        {
-          //stop if we find a minValue of zero because there no other Min less than that
-          break;
-        }
-        possibleMin = bdb_reportingClusterEndpointArray[i].consolidatedMaxReportInt - bdb_reportingClusterEndpointArray[i].timeSinceLastReport;
-        if( possibleMin<ValueMin )
-        {
-          indexMin = i;
-          ValueMin = possibleMin;
-        }
-      }
-    }
+    return BDBREPORTING_INVALIDINDEX;
   }
-  return indexMin;
-
+  return bdb_reportingDueHeap[0];
 }
 
 static uint8_t bdb_clusterEndpointArrayRemoveAt( uint8_t index )
@@ -1118,9 +1145,20 @@ static uint8_t bdb_clusterEndpointArrayRemoveAt( uint8_t index )
   }
   //Freeing list, all the other fields are not dynamic
   bdb_linkedListAttrFreeAll( &bdb_reportingClusterEndpointArray[index].attrLinkedList );
+  if( bdb_reportingClusterEndpointArray[index].dueHeapIndex != BDBREPORTING_INVALIDINDEX )
+  {
+    bdb_dueHeapRemove( bdb_reportingClusterEndpointArray[index].dueHeapIndex );
+  }
   //moving last element to free slot
   bdb_clusterEndpointArrayMoveTo( index, bdb_reportingClusterEndpointArrayCount-1 );
   bdb_reportingClusterEndpointArrayCount--;
+  if( (index < bdb_reportingClusterEndpointArrayCount) &&
+      (bdb_reportingClusterEndpointArray[index].dueHeapIndex != BDBREPORTING_INVALIDINDEX) )
+  {
+    //Its index changed, entries due at the same time are ordered by index
+    bdb_dueHeapSiftUp( bdb_reportingClusterEndpointArray[index].dueHeapIndex );
+    bdb_dueHeapSiftDown( bdb_reportingClusterEndpointArray[index].dueHeapIndex );
+  }
   return BDBREPORTING_SUCCESS;
 }
 
@@ -1130,9 +1168,18 @@ static void bdb_clusterEndpointArrayMoveTo( uint8_t indexSrc, uint8_t indexDest
   bdb_reportingClusterEndpointArray[indexSrc].endpoint = bdb_reportingClusterEndpointArray[indexDest].endpoint;
   bdb_reportingClusterEndpointArray[indexSrc].consolidatedMaxReportInt = bdb_reportingClusterEndpointArray[indexDest].consolidatedMaxReportInt;
   bdb_reportingClusterEndpointArray[indexSrc].consolidatedMinReportInt = bdb_reportingClusterEndpointArray[indexDest].consolidatedMinReportInt;
-  bdb_reportingClusterEndpointArray[indexSrc].timeSinceLastReport = bdb_reportingClusterEndpointArray[indexDest].timeSinceLastReport;
+  bdb_reportingClusterEndpointArray[indexSrc].lastReportTime = bdb_reportingClusterEndpointArray[indexDest].lastReportTime;
+  bdb_reportingClusterEndpointArray[indexSrc].dueHeapIndex = bdb_reportingClusterEndpointArray[indexDest].dueHeapIndex;
+#if BDB_REPORTING_COALESCE_WINDOW > 0
+  bdb_reportingClusterEndpointArray[indexSrc].pendingReportTime = bdb_reportingClusterEndpointArray[indexDest].pendingReportTime;
+#endif
   bdb_reportingClusterEndpointArray[indexSrc].attrLinkedList = bdb_reportingClusterEndpointArray[indexDest].attrLinkedList;
   bdb_reportingClusterEndpointArray[indexSrc].flags = bdb_reportingClusterEndpointArray[indexDest].flags;
+  if( bdb_reportingClusterEndpointArray[indexSrc].dueHeapIndex != BDBREPORTING_INVALIDINDEX )
+  {
+    //Heap slot follows the entry to its new position
+    bdb_reportingDueHeap[bdb_reportingClusterEndpointArray[indexSrc].dueHeapIndex] = indexSrc;
+  }
   bdb_linkedListAttrClearList( &bdb_reportingClusterEndpointArray[indexDest].attrLinkedList );
 }
 
@@ -1142,7 +1189,7 @@ static uint8_t bdb_clusterEndpointArrayUpdateAt( uint8_t index, uint16_t newTime
   {
     return BDBREPORTING_ERROR;
   }
-  bdb_reportingClusterEndpointArray[index].timeSinceLastReport = newTimeSinceLastReport;
+  bdb_reportingClusterEndpointArray[index].lastReportTime = bdb_reportingClock - newTimeSinceLastReport;
   if( markHasBinding != BDBREPORTING_IGNORE )
   {
     if( markHasBinding == BDBREPORTING_TRUE )
@@ -1152,6 +1199,8 @@ static uint8_t bdb_clusterEndpointArrayUpdateAt( uint8_t index, uint16_t newTime
     else
     {
       FLAGS_TURNOFFFLAG( bdb_reportingClusterEndpointArray[index].flags, BDBREPORTING_HASBINDING_FLAG_MASK );
+      //Nowhere to send a deferred report
+      FLAGS_TURNOFFFLAG( bdb_reportingClusterEndpointArray[index].flags, BDBREPORTING_PENDINGREPORT_FLAG_MASK );
     }
   }
   if( markNoNextIncrement != BDBREPORTING_IGNORE )
@@ -1159,12 +1208,14 @@ static uint8_t bdb_clusterEndpointArrayUpdateAt( uint8_t index, uint16_t newTime
     if( markNoNextIncrement == BDBREPORTING_TRUE )
     {
       FLAGS_TURNONFLAG( bdb_reportingClusterEndpointArray[index].flags, BDBREPORTING_NONEXTINCREMENT_FLAG_MASK );
+      bdb_reportingNoIncrementPending = BDBREPORTING_TRUE;
     }
     else
     {
       FLAGS_TURNOFFFLAG( bdb_reportingClusterEndpointArray[index].flags, BDBREPORTING_NONEXTINCREMENT_FLAG_MASK );
     }
   }
+  bdb_clusterEndpointArrayReschedule( index );
   return BDBREPORTING_SUCCESS;
 }
 
@@ -1193,40 +1244,136 @@ static uint8_t bdb_clusterEndpointArraySearch( uint8_t endpoint, uint16_t cluste
   return foundIndex;
 }
 
+/*********************************************************************
+ * @fn      bdb_clusterEndpointArrayIncrementAll
+ *
+ * @brief   Advances the time since last report of all the entries with binding.
+ *          Only the reporting clock moves, so this is O(1) unless an entry
+ *          carries the one shot no next increment flag.
+ *
+ * @param   timeSinceLastReportIncrement - elapsed time in seconds
+ * @param   CheckNoIncrementFlag - if TRUE, entries with the no next increment
+ *          flag keep their time since last report
+ *
+ * @return  none
+ */
 static void bdb_clusterEndpointArrayIncrementAll( uint16_t timeSinceLastReportIncrement, uint8_t CheckNoIncrementFlag )
 {
   uint8_t i;
-  uint8_t doIncrement;
+  bdb_reportingClock += timeSinceLastReportIncrement;
+  if( bdb_reportingNoIncrementPending == BDBREPORTING_FALSE )
+  {
+    return;
+  }
+  bdb_reportingNoIncrementPending = BDBREPORTING_FALSE;
   for( i=0; i<bdb_reportingClusterEndpointArrayCount; i++ )
   {
-    doIncrement = BDBREPORTING_FALSE;
+    if( FLAGS_CHECKFLAG( bdb_reportingClusterEndpointArray[i].flags, BDBREPORTING_NONEXTINCREMENT_FLAG_MASK ) == BDBREPORTING_FALSE )
+    {
+      continue;
+    }
     if( FLAGS_CHECKFLAG( bdb_reportingClusterEndpointArray[i].flags, BDBREPORTING_HASBINDING_FLAG_MASK ) == BDBREPORTING_TRUE )
     {
       //Only do with valid entries (HasBinding==true)
-      if( CheckNoIncrementFlag == BDBREPORTING_FALSE )
+      if( CheckNoIncrementFlag == BDBREPORTING_TRUE )
       {
-        doIncrement = BDBREPORTING_TRUE;
-      }
-      else
-      {
-        if( FLAGS_CHECKFLAG( bdb_reportingClusterEndpointArray[i].flags, BDBREPORTING_NONEXTINCREMENT_FLAG_MASK ) == BDBREPORTING_FALSE )
-        {
-          doIncrement = BDBREPORTING_TRUE;
-        }
-      }
-      if( doIncrement == BDBREPORTING_TRUE )
-      {
-        if( bdb_reportingClusterEndpointArray[i].consolidatedMaxReportInt != BDBREPORTING_NOPERIODIC &&  bdb_reportingClusterEndpointArray[i].consolidatedMaxReportInt != BDBREPORTING_REPORTOFF )
-        {
-          bdb_reportingClusterEndpointArray[i].timeSinceLastReport = (bdb_reportingClusterEndpointArray[i].timeSinceLastReport+timeSinceLastReportIncrement
-                                                                      > bdb_reportingClusterEndpointArray[i].consolidatedMaxReportInt)?
-                                                                      bdb_reportingClusterEndpointArray[i].consolidatedMaxReportInt:
-                                                                      bdb_reportingClusterEndpointArray[i].timeSinceLastReport+timeSinceLastReportIncrement;
-        }
+        //Shift the last report time so this entry does not see the increment
+        bdb_reportingClusterEndpointArray[i].lastReportTime += timeSinceLastReportIncrement;
+        bdb_clusterEndpointArrayReschedule( i );
       }
       FLAGS_TURNOFFFLAG( bdb_reportingClusterEndpointArray[i].flags, BDBREPORTING_NONEXTINCREMENT_FLAG_MASK ); //Always turn off, one shot functionality
+    }
+    else
+    {
+      //Flag stays until the entry gets a binding
+      bdb_reportingNoIncrementPending = BDBREPORTING_TRUE;
+    }
+  }
+}
+
+/*********************************************************************
+ * @fn      bdb_clusterEndpointArrayGetTimeSinceLastReport
+ *
+ * @brief   Time since the last report of an entry, saturated at its
+ *          consolidatedMaxReportInt.
+ *
+ * @param   index - index of the cluster-endpoint entry
+ *
+ * @return  time in seconds
+ */
+static uint16_t bdb_clusterEndpointArrayGetTimeSinceLastReport( uint8_t index )
+{
+  uint32_t timeSinceLastReport = bdb_reportingClock - bdb_reportingClusterEndpointArray[index].lastReportTime;
+  if( timeSinceLastReport > bdb_reportingClusterEndpointArray[index].consolidatedMaxReportInt )
+  {
+    return bdb_reportingClusterEndpointArray[index].consolidatedMaxReportInt;
+  }
+  return (uint16_t)timeSinceLastReport;
+}
 
+/*********************************************************************
+ * @fn      bdb_clusterEndpointArrayGetDueTime
+ *
+ * @brief   Reporting clock value at which an entry has to be reported, either
+ *          its deferred report or the expiration of consolidatedMaxReportInt.
+ *
+ * @param   index - index of the cluster-endpoint entry
+ *
+ * @return  due time in seconds
+ */
+static uint32_t bdb_clusterEndpointArrayGetDueTime( uint8_t index )
+{
+#if BDB_REPORTING_COALESCE_WINDOW > 0
+  if( FLAGS_CHECKFLAG( bdb_reportingClusterEndpointArray[index].flags, BDBREPORTING_PENDINGREPORT_FLAG_MASK ) == BDBREPORTING_TRUE )
+  {
+    //Never later than the periodic report, see bdb_RepDeferReport
+    return bdb_reportingClusterEndpointArray[index].pendingReportTime;
+  }
+#endif
+  return bdb_reportingClusterEndpointArray[index].lastReportTime + bdb_reportingClusterEndpointArray[index].consolidatedMaxReportInt;
+}
+
+/*********************************************************************
+ * @fn      bdb_clusterEndpointArrayReschedule
+ *
+ * @brief   Inserts, moves or removes an entry in the due time heap after its
+ *          last report time, flags or intervals changed.
+ *
+ * @param   index - index of the cluster-endpoint entry
+ *
+ * @return  none
+ */
+static void bdb_clusterEndpointArrayReschedule( uint8_t index )
+{
+  uint8_t heapIndex = bdb_reportingClusterEndpointArray[index].dueHeapIndex;
+  uint8_t isScheduled = BDBREPORTING_FALSE;
+  if( FLAGS_CHECKFLAG( bdb_reportingClusterEndpointArray[index].flags, BDBREPORTING_HASBINDING_FLAG_MASK ) == BDBREPORTING_TRUE )
+  {
+    if( bdb_reportingClusterEndpointArray[index].consolidatedMaxReportInt != BDBREPORTING_NOPERIODIC &&
+        bdb_reportingClusterEndpointArray[index].consolidatedMaxReportInt != BDBREPORTING_REPORTOFF )
+    {
+      isScheduled = BDBREPORTING_TRUE;
     }
+    else if( FLAGS_CHECKFLAG( bdb_reportingClusterEndpointArray[index].flags, BDBREPORTING_PENDINGREPORT_FLAG_MASK ) == BDBREPORTING_TRUE )
+    {
+      //Deferred value changed report of a cluster without periodic reporting
+      isScheduled = BDBREPORTING_TRUE;
+    }
+  }
+  if( isScheduled == BDBREPORTING_TRUE )
+  {
+    if( heapIndex == BDBREPORTING_INVALIDINDEX )
+    {
+      heapIndex = bdb_reportingDueHeapCount++;
+      bdb_dueHeapSet( heapIndex, index );
+    }
+    bdb_dueHeapSiftUp( heapIndex );
+    bdb_dueHeapSiftDown( bdb_reportingClusterEndpointArray[index].dueHeapIndex );
+  }
+  else if( heapIndex != BDBREPORTING_INVALIDINDEX )
+  {
+    //If maxInterval is BDBREPORTING_NOPERIODIC=0x0000 or BDBREPORTING_REPORTOFF=0xFFFF, no periodic report
+    bdb_dueHeapRemove( heapIndex );
   }
 }
 
@@ -1235,6 +1382,103 @@ static void bdb_clusterEndpointArrayIncrementAll( uint16_t timeSinceLastReportIn
 */
 
 
+/*
+* Begin: Due time heap methods
+*/
+
+#if BDB_REPORTING_COALESCE_WINDOW > 0
+static uint32_t bdb_dueHeapGetDueTime( uint8_t heapIndex )
+{
+  return bdb_clusterEndpointArrayGetDueTime( bdb_reportingDueHeap[heapIndex] );
+}
+#endif
+
+/*********************************************************************
+ * @fn      bdb_dueHeapIsBefore
+ *
+ * @brief   Order of the due time heap. Entries due at the same time are
+ *          ordered by their index in the cluster-endpoint array, so they are
+ *          reported in the order the array scan of the counter based
+ *          scheduler reported them.
+ *
+ * @param   indexA - index of a cluster-endpoint entry
+ * @param   indexB - index of another cluster-endpoint entry
+ *
+ * @return  BDBREPORTING_TRUE if indexA is served before indexB
+ */
+static uint8_t bdb_dueHeapIsBefore( uint8_t indexA, uint8_t indexB )
+{
+  uint32_t dueTimeA = bdb_clusterEndpointArrayGetDueTime( indexA );
+  uint32_t dueTimeB = bdb_clusterEndpointArrayGetDueTime( indexB );
+  if( dueTimeA != dueTimeB )
+  {
+    return ( dueTimeA < dueTimeB ) ? BDBREPORTING_TRUE : BDBREPORTING_FALSE;
+  }
+  return ( indexA <= indexB ) ? BDBREPORTING_TRUE : BDBREPORTING_FALSE;
+}
+
+static void bdb_dueHeapSet( uint8_t heapIndex, uint8_t index )
+{
+  bdb_reportingDueHeap[heapIndex] = index;
+  bdb_reportingClusterEndpointArray[index].dueHeapIndex = heapIndex;
+}
+
+static void bdb_dueHeapSiftUp( uint8_t heapIndex )
+{
+  uint8_t index = bdb_reportingDueHeap[heapIndex];
+  while( heapIndex > 0 )
+  {
+    uint8_t parent = (heapIndex - 1) / 2;
+    if( bdb_dueHeapIsBefore( bdb_reportingDueHeap[parent], index ) == BDBREPORTING_TRUE )
+    {
+      break;
+    }
+    bdb_dueHeapSet( heapIndex, bdb_reportingDueHeap[parent] );
+    heapIndex = parent;
+  }
+  bdb_dueHeapSet( heapIndex, index );
+}
+
+static void bdb_dueHeapSiftDown( uint8_t heapIndex )
+{
+  uint8_t index = bdb_reportingDueHeap[heapIndex];
+  while( (2 * heapIndex) + 1 < bdb_reportingDueHeapCount )
+  {
+    uint8_t child = (2 * heapIndex) + 1;
+    if( child + 1 < bdb_reportingDueHeapCount &&
+        bdb_dueHeapIsBefore( bdb_reportingDueHeap[child + 1], bdb_reportingDueHeap[child] ) == BDBREPORTING_TRUE )
+    {
+      child++;
+    }
+    if( bdb_dueHeapIsBefore( index, bdb_reportingDueHeap[child] ) == BDBREPORTING_TRUE )
+    {
+      break;
+    }
+    bdb_dueHeapSet( heapIndex, bdb_reportingDueHeap[child] );
+    heapIndex = child;
+  }
+  bdb_dueHeapSet( heapIndex, index );
+}
+
+static void bdb_dueHeapRemove( uint8_t heapIndex )
+{
+  bdb_reportingClusterEndpointArray[bdb_reportingDueHeap[heapIndex]].dueHeapIndex = BDBREPORTING_INVALIDINDEX;
+  bdb_reportingDueHeapCount--;
+  if( heapIndex < bdb_reportingDueHeapCount )
+  {
+    //Move the last heap element to the free slot
+    uint8_t index = bdb_reportingDueHeap[bdb_reportingDueHeapCount];
+    bdb_dueHeapSet( heapIndex, index );
+    bdb_dueHeapSiftUp( heapIndex );
+    bdb_dueHeapSiftDown( bdb_reportingClusterEndpointArray[index].dueHeapIndex );
+  }
+}
+
+/*
+* End: Due time heap methods
+*/
+
+
 /*
 * Begin: Single linked list default attr cfg records methods
 */
@@ -1711,6 +1955,8 @@ static void bdb_RepReport( uint8_t specificCLusterEndpointIndex )
   {
     uint8_t *pAttrData = NULL;
     uint8_t *pAttrDataTemp = NULL;
+    //The report carries the current values, nothing is left deferred
+    FLAGS_TURNOFFFLAG( clusterEndpointItem->flags, BDBREPORTING_PENDINGREPORT_FLAG_MASK );
     dstAddr.addrMode = (afAddrMode_t)AddrNotPresent;
     dstAddr.addr.shortAddr = 0;
     dstAddr.endPoint = clusterEndpointItem->endpoint;
@@ -1750,9 +1996,7 @@ static void bdb_RepReport( uint8_t specificCLusterEndpointIndex )
         }
       }
 
-      zcl_StackSendReportCmd( clusterEndpointItem->endpoint, &dstAddr,
-                         clusterEndpointItem->cluster, pReportCmd,
-                         ZCL_FRAME_SERVER_CLIENT_DIR, BDB_REPORTING_DISABLE_DEFAULT_RSP, zcl_getFrameCounter() );
+      bdb_RepSendReportCmd( clusterEndpointItem, &dstAddr, pReportCmd );
     }
     if( (pReportCmd != NULL ) )
     {
@@ -1765,6 +2009,159 @@ static void bdb_RepReport( uint8_t specificCLusterEndpointIndex )
   }
 }
 
+/*********************************************************************
+ * @fn      bdb_RepSendReportCmd
+ *
+ * @brief   Sends the attribute records of a cluster-endpoint entry packed in
+ *          the minimum number of report frames that fit in afDataReqMTU.
+ *
+ * @param   clusterEndpointItem - cluster-endpoint entry being reported
+ * @param   dstAddr - destination address
+ * @param   pReportCmd - report command with all the attribute records, the
+ *          records are consumed
+ *
+ * @return  none
+ */
+static void bdb_RepSendReportCmd( bdbReportAttrClusterEndpoint_t* clusterEndpointItem, afAddrType_t* dstAddr, zclReportCmd_t* pReportCmd )
+{
+  afDataReqMTU_t mtu;
+  uint16_t maxLen;
+  uint16_t frameLen;
+  uint16_t recLen;
+  uint8_t numAttr = pReportCmd->numAttr;
+  uint8_t i;
+
+  //Assume secured frames, the MTU is then the smallest
+  mtu.kvp = FALSE;
+  mtu.aps.secure = TRUE;
+  mtu.aps.addressingMode = dstAddr->addrMode;
+  maxLen = afDataReqMTU( &mtu ) - BDBREPORTING_ZCL_HDR_LEN;
+
+  while( numAttr > 0 )
+  {
+    //At least one record per frame, larger ones are left to APS fragmentation
+    frameLen = 0;
+    for( i = 0; i < numAttr; i++ )
+    {
+      recLen = 2 + 1 + zclGetAttrDataLength( pReportCmd->attrList[i].dataType, pReportCmd->attrList[i].attrData );
+      if( (i > 0) && (frameLen + recLen > maxLen) )
+      {
+        break;
+      }
+      frameLen += recLen;
+    }
+    pReportCmd->numAttr = i;
+    zcl_StackSendReportCmd( clusterEndpointItem->endpoint, dstAddr,
+                       clusterEndpointItem->cluster, pReportCmd,
+                       ZCL_FRAME_SERVER_CLIENT_DIR, BDB_REPORTING_DISABLE_DEFAULT_RSP, zcl_getFrameCounter() );
+    bdb_reportingFramesSent++;
+
+    numAttr -= i;
+    if( numAttr > 0 )
+    {
+      memmove( &pReportCmd->attrList[0], &pReportCmd->attrList[i], numAttr * sizeof( zclReport_t ) );
+    }
+  }
+}
+
+#if BDB_REPORTING_COALESCE_WINDOW > 0
+/*********************************************************************
+ * @fn      bdb_RepReportDueWithinWindow
+ *
+ * @brief   Reports every entry due within BDB_REPORTING_COALESCE_WINDOW
+ *          along with the one that triggered the reporting event, so the
+ *          timers of entries drifting close together line up and are served
+ *          by a single event. Entries reported at this clock value and
+ *          entries still within their consolidatedMinReportInt are left to
+ *          their own due time.
+ *
+ * @return  none
+ */
+static void bdb_RepReportDueWithinWindow( void )
+{
+  uint8_t i;
+  uint8_t index;
+  uint32_t timeSinceLastReport;
+  uint32_t windowEnd = bdb_reportingClock + BDB_REPORTING_COALESCE_WINDOW;
+  bdbReportAttrClusterEndpoint_t* clusterEndpointItem;
+
+  do
+  {
+    //Reporting an entry moves it in the heap, look for the next one from the start
+    index = BDBREPORTING_INVALIDINDEX;
+    for( i = 0; i < bdb_reportingDueHeapCount; i++ )
+    {
+      clusterEndpointItem = &bdb_reportingClusterEndpointArray[bdb_reportingDueHeap[i]];
+      timeSinceLastReport = bdb_reportingClock - clusterEndpointItem->lastReportTime;
+      if( (timeSinceLastReport == 0) ||
+          (bdb_dueHeapGetDueTime( i ) > windowEnd) )
+      {
+        //Just reported or not due within the window
+        continue;
+      }
+      if( (clusterEndpointItem->consolidatedMinReportInt != BDBREPORTING_NOLIMIT) &&
+          (timeSinceLastReport < clusterEndpointItem->consolidatedMinReportInt) )
+      {
+        //Reporting now would break the minimum reporting interval
+        continue;
+      }
+      index = bdb_reportingDueHeap[i];
+      break;
+    }
+    if( index != BDBREPORTING_INVALIDINDEX )
+    {
+      bdb_RepReport( index );
+      bdb_clusterEndpointArrayUpdateAt( index, 0, BDBREPORTING_IGNORE, BDBREPORTING_IGNORE );
+    }
+  } while( index != BDBREPORTING_INVALIDINDEX );
+}
+
+/*********************************************************************
+ * @fn      bdb_RepDeferReport
+ *
+ * @brief   Defers the value changed report of a cluster-endpoint entry by up
+ *          to BDB_REPORTING_COALESCE_WINDOW, further changes of the attributes
+ *          in the entry and its periodic report are sent in the same frame.
+ *
+ * @param   indexClusterEndpoint - index of the cluster-endpoint entry
+ * @param   elapsedTime - elapsed time of the running reporting timer
+ * @param   isTimeRemaining - TRUE if the reporting timer is running
+ *
+ * @return  none
+ */
+static void bdb_RepDeferReport( uint8_t indexClusterEndpoint, uint16_t elapsedTime, uint8_t isTimeRemaining )
+{
+  bdbReportAttrClusterEndpoint_t* clusterEndpointItem = &bdb_reportingClusterEndpointArray[indexClusterEndpoint];
+  uint32_t dueTime;
+
+  if( FLAGS_CHECKFLAG( clusterEndpointItem->flags, BDBREPORTING_PENDINGREPORT_FLAG_MASK ) == BDBREPORTING_TRUE )
+  {
+    //A report is already deferred, it reads the attribute values when it is sent
+    bdb_reportingFramesSaved++;
+    return;
+  }
+
+  bdb_RepStopEventTimer( );
+  if( isTimeRemaining == BDBREPORTING_TRUE )
+  {
+    bdb_clusterEndpointArrayIncrementAll( elapsedTime, BDBREPORTING_FALSE );
+  }
+  dueTime = bdb_reportingClock + BDB_REPORTING_COALESCE_WINDOW;
+  if( (clusterEndpointItem->dueHeapIndex != BDBREPORTING_INVALIDINDEX) &&
+      (bdb_clusterEndpointArrayGetDueTime( indexClusterEndpoint ) <= dueTime) )
+  {
+    //The periodic report is sent within the window and carries the new value
+    dueTime = bdb_clusterEndpointArrayGetDueTime( indexClusterEndpoint );
+    bdb_reportingFramesSaved++;
+  }
+  clusterEndpointItem->pendingReportTime = dueTime;
+  FLAGS_TURNONFLAG( clusterEndpointItem->flags, BDBREPORTING_PENDINGREPORT_FLAG_MASK );
+  bdb_clusterEndpointArrayReschedule( indexClusterEndpoint );
+  //Restart reporting
+  bdb_RepStartReporting( );
+}
+#endif
+
 static uint8_t bdb_isAttrValueChangedSurpassDelta( uint8_t datatype, uint8_t* delta, uint8_t* curValue, uint8_t* lastValue )
 {
   uint8_t res = BDBREPORTING_FALSE;
@@ -1995,7 +2392,13 @@ static void bdb_RepSetupReporting( void )
      uint8_t clusterEndpointIndex = bdb_clusterEndpointArraySearch( arrayFlags[i].endpoint, arrayFlags[i].cluster );
      if( clusterEndpointIndex != BDBREPORTING_INVALIDINDEX )
      {
-       bdb_reportingClusterEndpointArray[clusterEndpointIndex].flags = arrayFlags[i].flags;
+       //Deferred reports are dropped, the attributes are reported again with the new configuration
+       bdb_reportingClusterEndpointArray[clusterEndpointIndex].flags = arrayFlags[i].flags & ~BDBREPORTING_PENDINGREPORT_FLAG_MASK;
+       if( FLAGS_CHECKFLAG( arrayFlags[i].flags, BDBREPORTING_NONEXTINCREMENT_FLAG_MASK ) == BDBREPORTING_TRUE )
+       {
+         bdb_reportingNoIncrementPending = BDBREPORTING_TRUE;
+       }
+       bdb_clusterEndpointArrayReschedule( clusterEndpointIndex );
      }
   }
   OsalPort_free( arrayFlags );
@@ -2248,7 +2651,7 @@ ZStatus_t bdb_RepChangedAttrValue( uint8_t endpoint, uint16_t cluster, uint16_t
   }
 
   if( bdb_reportingClusterEndpointArray[indexClusterEndpoint].consolidatedMinReportInt != BDBREPORTING_NOLIMIT &&
-     (bdb_reportingClusterEndpointArray[indexClusterEndpoint].timeSinceLastReport + elapsedTime) <= bdb_reportingClusterEndpointArray[indexClusterEndpoint].consolidatedMinReportInt)
+     (bdb_clusterEndpointArrayGetTimeSinceLastReport( indexClusterEndpoint ) + elapsedTime) <= bdb_reportingClusterEndpointArray[indexClusterEndpoint].consolidatedMinReportInt)
   {
       //Attr value has changed before minInterval, ommit reporting
       return ZSuccess;
@@ -2269,6 +2672,9 @@ ZStatus_t bdb_RepChangedAttrValue( uint8_t endpoint, uint16_t cluster, uint16_t
     //Attr is discrete, just report without checking the changeValue
   }
 
+#if BDB_REPORTING_COALESCE_WINDOW > 0
+  bdb_RepDeferReport( indexClusterEndpoint, elapsedTime, isTimeRemaining );
+#else
   //Stop reporting
   bdb_RepStopEventTimer( );
   bdb_RepReport( indexClusterEndpoint );
@@ -2279,10 +2685,34 @@ ZStatus_t bdb_RepChangedAttrValue( uint8_t endpoint, uint16_t cluster, uint16_t
   bdb_clusterEndpointArrayUpdateAt( indexClusterEndpoint, 0, BDBREPORTING_IGNORE, BDBREPORTING_IGNORE ); //return time since last report to zero
   //Restart reporting
   bdb_RepStartReporting( );
+#endif
 
   return ZSuccess;
 }
 
+/*********************************************************************
+ * @fn          bdb_RepGetCoalesceMetrics
+ *
+ * @brief       Get the number of report frames sent and the number of frames
+ *              saved by coalescing reports within BDB_REPORTING_COALESCE_WINDOW.
+ *
+ * @param       pFramesSent - number of report frames sent, can be NULL
+ * @param       pFramesSaved - number of report frames saved, can be NULL
+ *
+ * @return      none
+ */
+void bdb_RepGetCoalesceMetrics( uint32_t* pFramesSent, uint32_t* pFramesSaved )
+{
+  if( pFramesSent != NULL )
+  {
+    *pFramesSent = bdb_reportingFramesSent;
+  }
+  if( pFramesSaved != NULL )
+  {
+    *pFramesSaved = bdb_reportingFramesSaved;
+  }
+}
+
 #endif //BDB_REPORTING
 
 /*
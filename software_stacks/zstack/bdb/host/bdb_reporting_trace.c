@@ -0,0 +1,777 @@
+/******************************************************************************
+
+ @file  bdb_reporting_trace.c
+
+ @brief BDB attribute reporting scheduler trace comparison
+
+ Group: WCS, LPC
+ Target Device: cc13xx_cc26xx
+
+ ******************************************************************************
+ 
+ Copyright (c) 2019-2026, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ 
+ 
+ *****************************************************************************/
+
+/*
+Drives bdb_reporting.c through a random but reproducible trace of the events
+that move its report schedule: attribute changes, bindings created while the
+reporting timer runs (which set the no-next-increment flag of the entry),
+bindings removed, Configure Reporting commands and quiet periods of up to a
+day, longer than the 0xFFFE s maximum interval, so elapsed times saturate.
+Time is virtual, in milliseconds; the OSAL timer functions bdb_reporting.c
+uses are implemented here on that clock and bdb_RepProcessEvent() is called
+when the BDB_REPORT_TIMEOUT timer expires. Every frame bdb_reporting.c sends
+(reports and Configure Reporting responses) is logged with its time.
+
+The attribute set covers the configurations the scheduler treats apart:
+maximum intervals of 0 (no periodic report), 0xFFFF (off), 0xFFFE and a few
+seconds, minimum intervals of 0 and above the maximum, and clusters with
+several attributes whose intervals are consolidated.
+
+To check that two versions of the scheduler send the same reports at the
+same times, build this program against each, then run one with -x naming
+the other; both run the same trace and their logs are compared line by line.
+For the counter based scheduler before the due time heap:
+
+  git show c8ef66f^:software_stacks/zstack/bdb/bdb_reporting.c > /tmp/bdb_reporting_counter.c
+
+  for v in heap counter; do
+    src=software_stacks/zstack/bdb/bdb_reporting.c
+    [ $v = counter ] && src=/tmp/bdb_reporting_counter.c
+    cc -O2 -DOSAL_PORT2TIRTOS -DBDB_REPORTING -DZCL_READ -DZCL_WRITE \
+        -DZCL_DISCOVER -DZCL_REPORT -DZCL_REPORTING_DEVICE \
+        -Isoftware_stacks/zstack/host -I. -Isoftware_stacks \
+        -Isoftware_stacks/ti15_4stack/hal/platform \
+        -Isoftware_stacks/ti15_4stack/mac/services \
+        -Isoftware_stacks/ti15_4stack/mac -Isoftware_stacks/zstack/af \
+        -Isoftware_stacks/zstack/bdb -Isoftware_stacks/zstack/sys \
+        -Isoftware_stacks/zstack/nwk -Isoftware_stacks/zstack/osal_port \
+        -Isoftware_stacks/zstack/common/zcl -Isoftware_stacks/zstack/stack_task \
+        -Isoftware_stacks/zstack/zdo -Isoftware_stacks/zstack/sec \
+        -Isoftware_stacks/zstack/gp -Isoftware_stacks/zstack/zmac \
+        -Isoftware_stacks/zstack/rom -Idrivers/nv \
+        -o bdb_reporting_trace_$v \
+        software_stacks/zstack/bdb/host/bdb_reporting_trace.c $src \
+        software_stacks/zstack/common/zcl/zcl.c \
+        software_stacks/zstack/host/zstack_host.c
+  done
+  ./bdb_reporting_trace_heap -x ./bdb_reporting_trace_counter
+
+The exit status is 1 when the logs differ or when a report does not carry
+the current attribute values.
+*/
+
+//*****************************************************************************
+// Includes
+//*****************************************************************************
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "zcl.h"
+#include "bdb.h"
+#include "bdb_interface.h"
+#include "bdb_reporting.h"
+#include "binding_table.h"
+#include "osal_nv.h"
+#include "osal_port_timers.h"
+#include "nwk.h"
+#include "zstack_host.h"
+
+//*****************************************************************************
+// Constants and Definitions
+//*****************************************************************************
+
+// Home Automation profile
+#define TRACE_PROFILE_ID        0x0104
+
+#define TRACE_EP_A              8
+#define TRACE_EP_B              9
+
+#define TRACE_CLUSTER_LEVEL     0x0008
+#define TRACE_CLUSTER_ONOFF     0x0006
+#define TRACE_CLUSTER_ILLUM     0x0400
+#define TRACE_CLUSTER_TEMP      0x0402
+#define TRACE_CLUSTER_PRESSURE  0x0403
+#define TRACE_CLUSTER_HUMIDITY  0x0405
+
+#define TRACE_NUM_ATTRS         9
+#define TRACE_MAX_NV_ITEMS      4
+#define TRACE_MAX_NV_LEN        1024
+#define TRACE_MAX_LINE          160
+
+// Intervals of a Configure Reporting record asking for the default
+// configuration, as bdb_reporting.c defines them
+#define TRACE_MININTERVAL_DEFAULT  0xFFFF
+#define TRACE_MAXINTERVAL_DEFAULT  0x0000
+
+// Expiries of the reporting timer in a row without time advancing
+#define TRACE_MAX_SPINS         1000
+
+//*****************************************************************************
+// Typedefs
+//*****************************************************************************
+
+// A reportable attribute and its default reporting configuration
+typedef struct
+{
+    uint8_t   endpoint;
+    uint16_t  cluster;
+    uint16_t  attrID;
+    uint8_t   dataType;
+    uint16_t  minReportInt;
+    uint16_t  maxReportInt;
+    uint16_t  reportableChange;
+    uint16_t  maxStep;      // largest change of one attribute change event
+} traceAttr_t;
+
+// An NV item
+typedef struct
+{
+    uint16_t  id;
+    uint16_t  len;
+    uint8_t   data[TRACE_MAX_NV_LEN];
+} traceNvItem_t;
+
+//*****************************************************************************
+// Locals
+//*****************************************************************************
+
+static const traceAttr_t traceAttrs[TRACE_NUM_ATTRS] =
+{
+    { TRACE_EP_A, TRACE_CLUSTER_TEMP,     0x0000, ZCL_DATATYPE_INT16,       1,     10,  50, 120 },
+    { TRACE_EP_A, TRACE_CLUSTER_TEMP,     0x0001, ZCL_DATATYPE_INT16,       5,      0,  20,  40 },
+    { TRACE_EP_A, TRACE_CLUSTER_ONOFF,    0x0000, ZCL_DATATYPE_BOOLEAN,     0, 0xFFFE,   0,   1 },
+    { TRACE_EP_A, TRACE_CLUSTER_HUMIDITY, 0x0000, ZCL_DATATYPE_UINT16,      2, 0xFFFF, 100, 300 },
+    { TRACE_EP_B, TRACE_CLUSTER_ILLUM,    0x0000, ZCL_DATATYPE_UINT16,      0,      3,  10,  25 },
+    { TRACE_EP_B, TRACE_CLUSTER_ILLUM,    0x0002, ZCL_DATATYPE_UINT16,     30,     20,   1,   4 },
+    { TRACE_EP_B, TRACE_CLUSTER_PRESSURE, 0x0000, ZCL_DATATYPE_INT16,      60,   3600,   5,  12 },
+    { TRACE_EP_B, TRACE_CLUSTER_LEVEL,    0x0000, ZCL_DATATYPE_UINT8,       1,      0,   8,  30 },
+    { TRACE_EP_B, TRACE_CLUSTER_LEVEL,    0x0001, ZCL_DATATYPE_UINT16,      1,      0,   8,  30 },
+};
+
+// Intervals picked by the Configure Reporting commands of the trace
+static const uint16_t traceMinInts[] = { 0, 1, 4, 30, 0xFFFF };
+static const uint16_t traceMaxInts[] = { 0, 2, 7, 60, 0xFFFE, 0xFFFF };
+
+static uint16_t attrValues[TRACE_NUM_ATTRS];
+static zclAttrRec_t attrRecsA[TRACE_NUM_ATTRS];
+static zclAttrRec_t attrRecsB[TRACE_NUM_ATTRS];
+
+static SimpleDescriptionFormat_t descA = { TRACE_EP_A, TRACE_PROFILE_ID };
+static SimpleDescriptionFormat_t descB = { TRACE_EP_B, TRACE_PROFILE_ID };
+static SimpleDescriptionFormat_t descZdo = { 0, 0 };
+static endPointDesc_t epDescA = { TRACE_EP_A, 0, NULL, &descA, noLatencyReqs };
+static endPointDesc_t epDescB = { TRACE_EP_B, 0, NULL, &descB, noLatencyReqs };
+static endPointDesc_t epDescZdo = { 0, 0, NULL, &descZdo, noLatencyReqs };
+
+// Application endpoints, then ZDO, as AF keeps them
+static epList_t epListZdo = { NULL, &epDescZdo };
+static epList_t epListB = { &epListZdo, &epDescB };
+static epList_t epListA = { &epListB, &epDescA };
+
+static uint8_t bound[TRACE_NUM_ATTRS];
+static BindingEntry_t bindEntry;
+
+static traceNvItem_t nvItems[TRACE_MAX_NV_ITEMS];
+static int numNvItems;
+
+static uint64_t now;
+static uint64_t timerDue;
+static uint8_t timerRunning;
+
+static FILE *logOut;
+static FILE *refIn;
+static uint32_t logLines;
+static uint32_t mismatches;
+static uint32_t failures;
+
+static uint32_t numReports;
+static uint32_t numCfgRsps;
+static uint32_t numChanges;
+static uint32_t numBinds;
+static uint32_t numBindsRunning;
+static uint32_t numUnbinds;
+static uint32_t numConfigs;
+static uint32_t numQuiet;
+static uint32_t numExpiries;
+
+//*****************************************************************************
+// Stack globals and functions used by bdb_reporting.c
+//*****************************************************************************
+
+epList_t *epList = &epListA;
+epList_t *bdb_HeadEpDescriptorList = &epListA;
+byte bdb_TaskID = 1;
+nwkIB_t _NIB;
+
+uint8_t OsalPortTimers_startTimer(uint8_t taskId, uint32_t eventId, uint32_t timeoutValue)
+{
+    (void)taskId;
+    (void)eventId;
+    timerDue = now + timeoutValue;
+    timerRunning = TRUE;
+    return(SUCCESS);
+}
+
+uint8_t OsalPortTimers_stopTimer(uint8_t taskId, uint32_t eventId)
+{
+    (void)taskId;
+    (void)eventId;
+    timerRunning = FALSE;
+    return(SUCCESS);
+}
+
+uint32_t OsalPortTimers_getTimerTimeout(uint8_t taskId, uint32_t eventId)
+{
+    (void)taskId;
+    (void)eventId;
+    return(timerRunning ? (uint32_t)(timerDue - now) : 0);
+}
+
+uint8_t afDataReqMTU(afDataReqMTU_t *fields)
+{
+    (void)fields;
+    return(80);
+}
+
+BindingEntry_t *bindFind(uint8_t ep, uint16_t clusterID, uint8_t skipping)
+{
+    int i;
+
+    (void)skipping;
+    for(i = 0; i < TRACE_NUM_ATTRS; i++)
+    {
+        if(bound[i] && (traceAttrs[i].endpoint == ep) && (traceAttrs[i].cluster == clusterID))
+        {
+            bindEntry.srcEP = ep;
+            bindEntry.numClusterIds = 1;
+            bindEntry.clusterIdList[0] = clusterID;
+            return(&bindEntry);
+        }
+    }
+    return(NULL);
+}
+
+static traceNvItem_t *nvFind(uint16_t id)
+{
+    int i;
+
+    for(i = 0; i < numNvItems; i++)
+    {
+        if(nvItems[i].id == id)
+        {
+            return(&nvItems[i]);
+        }
+    }
+    return(NULL);
+}
+
+uint8_t osal_nv_item_init(uint16_t id, uint16_t len, void *buf)
+{
+    traceNvItem_t *pItem = nvFind(id);
+
+    if(pItem != NULL)
+    {
+        return((pItem->len == len) ? SUCCESS : NV_OPER_FAILED);
+    }
+    if((numNvItems >= TRACE_MAX_NV_ITEMS) || (len > TRACE_MAX_NV_LEN))
+    {
+        return(NV_OPER_FAILED);
+    }
+    pItem = &nvItems[numNvItems++];
+    pItem->id = id;
+    pItem->len = len;
+    memset(pItem->data, 0xFF, len);
+    if(buf != NULL)
+    {
+        memcpy(pItem->data, buf, len);
+    }
+    return(NV_ITEM_UNINIT);
+}
+
+uint16_t osal_nv_item_len(uint16_t id)
+{
+    traceNvItem_t *pItem = nvFind(id);
+
+    return((pItem != NULL) ? pItem->len : 0);
+}
+
+uint8_t osal_nv_read(uint16_t id, uint16_t offset, uint16_t len, void *buf)
+{
+    traceNvItem_t *pItem = nvFind(id);
+
+    if((pItem == NULL) || (offset + len > pItem->len))
+    {
+        return(NV_OPER_FAILED);
+    }
+    memcpy(buf, pItem->data + offset, len);
+    return(SUCCESS);
+}
+
+uint8_t osal_nv_write(uint16_t id, uint16_t len, void *buf)
+{
+    traceNvItem_t *pItem = nvFind(id);
+
+    if((pItem == NULL) || (len > pItem->len))
+    {
+        return(NV_OPER_FAILED);
+    }
+    memcpy(pItem->data, buf, len);
+    return(SUCCESS);
+}
+
+//*****************************************************************************
+// Log
+//*****************************************************************************
+
+/*
+ * Writes a line to the log and compares it with the next line of the
+ * reference program, if any.
+ */
+static void logLine(const char *line)
+{
+    char ref[TRACE_MAX_LINE];
+
+    logLines++;
+    if(logOut != NULL)
+    {
+        fputs(line, logOut);
+    }
+    if(refIn != NULL)
+    {
+        if(fgets(ref, sizeof(ref), refIn) == NULL)
+        {
+            strcpy(ref, "(end of log)\n");
+        }
+        if(strcmp(line, ref) != 0)
+        {
+            if(mismatches < 10)
+            {
+                printf("line %u differs:\n  this:      %s  reference: %s", logLines, line, ref);
+            }
+            mismatches++;
+        }
+    }
+}
+
+static int attrIndex(uint8_t endpoint, uint16_t cluster, uint16_t attrID)
+{
+    int i;
+
+    for(i = 0; i < TRACE_NUM_ATTRS; i++)
+    {
+        if((traceAttrs[i].endpoint == endpoint) && (traceAttrs[i].cluster == cluster) &&
+           (traceAttrs[i].attrID == attrID))
+        {
+            return(i);
+        }
+    }
+    return(-1);
+}
+
+/*
+ * Checks that the records of a Report Attributes command carry the current
+ * attribute values.
+ */
+static void checkReport(uint8_t endpoint, uint16_t cluster, uint8_t *pData, uint8_t *pEnd)
+{
+    while(pData + 3 <= pEnd)
+    {
+        uint16_t attrID = BUILD_UINT16(pData[0], pData[1]);
+        uint8_t dataType = pData[2];
+        uint8_t len = zclGetDataTypeLength(dataType);
+        int i = attrIndex(endpoint, cluster, attrID);
+        uint16_t value;
+
+        pData += 3;
+        if((i < 0) || (dataType != traceAttrs[i].dataType) || (pData + len > pEnd))
+        {
+            printf("bad report record for 0x%04X 0x%04X\n", cluster, attrID);
+            failures++;
+            return;
+        }
+        value = (len == 1) ? pData[0] : BUILD_UINT16(pData[0], pData[1]);
+        if(value != attrValues[i])
+        {
+            printf("report of 0x%04X 0x%04X carries %u, value is %u\n", cluster, attrID,
+                   value, attrValues[i]);
+            failures++;
+        }
+        pData += len;
+    }
+}
+
+/*
+ * AF data requests of bdb_reporting.c and zcl.c end up here.
+ */
+static afStatus_t traceAfDataCb(afAddrType_t *dstAddr, endPointDesc_t *srcEP, uint16_t cID,
+                                uint16_t len, uint8_t *buf, uint8_t options)
+{
+    char line[TRACE_MAX_LINE];
+    zclFrameHdr_t hdr;
+    uint8_t *pPayload = zclParseHdr(&hdr, buf);
+    int n;
+    uint16_t i;
+
+    (void)dstAddr;
+    (void)options;
+
+    if(hdr.commandID == ZCL_CMD_REPORT)
+    {
+        numReports++;
+        checkReport(srcEP->endPoint, cID, pPayload, buf + len);
+    }
+    else
+    {
+        numCfgRsps++;
+    }
+
+    n = snprintf(line, sizeof(line), "%llu.%03llu %u 0x%04X",
+                 (unsigned long long)(now / 1000), (unsigned long long)(now % 1000),
+                 srcEP->endPoint, cID);
+    for(i = 0; (i < len) && (n < TRACE_MAX_LINE - 4); i++)
+    {
+        n += snprintf(line + n, sizeof(line) - n, " %02X", buf[i]);
+    }
+    snprintf(line + n, sizeof(line) - n, "\n");
+    logLine(line);
+    return(afStatus_SUCCESS);
+}
+
+//*****************************************************************************
+// Trace
+//*****************************************************************************
+
+static uint32_t randRange(uint32_t n)
+{
+    return((uint32_t)rand() % n);
+}
+
+/*
+ * Advances the virtual clock to the given time, running the reporting timer
+ * when it expires on the way.
+ */
+static void advanceTo(uint64_t time)
+{
+    uint32_t spins = 0;
+    uint64_t last = now;
+
+    while(timerRunning && (timerDue <= time))
+    {
+        now = timerDue;
+        spins = (now == last) ? spins + 1 : 0;
+        last = now;
+        if(spins > TRACE_MAX_SPINS)
+        {
+            printf("reporting timer keeps expiring at %llu ms\n", (unsigned long long)now);
+            failures++;
+            timerRunning = FALSE;
+            break;
+        }
+        timerRunning = FALSE;
+        numExpiries++;
+        bdb_RepProcessEvent();
+    }
+    now = time;
+}
+
+static void traceChange(int i)
+{
+    const traceAttr_t *pAttr = &traceAttrs[i];
+    int32_t step = (int32_t)randRange(2 * pAttr->maxStep + 1) - pAttr->maxStep;
+
+    if(pAttr->dataType == ZCL_DATATYPE_BOOLEAN)
+    {
+        attrValues[i] ^= 1;
+    }
+    else if(pAttr->dataType == ZCL_DATATYPE_UINT8)
+    {
+        attrValues[i] = (uint8_t)(attrValues[i] + step);
+    }
+    else
+    {
+        attrValues[i] = (uint16_t)(attrValues[i] + step);
+    }
+    numChanges++;
+    bdb_RepChangedAttrValue(pAttr->endpoint, pAttr->cluster, pAttr->attrID);
+}
+
+static void traceBind(int i, uint8_t bind)
+{
+    const traceAttr_t *pAttr = &traceAttrs[i];
+    int j;
+
+    // Bindings are per cluster
+    for(j = 0; j < TRACE_NUM_ATTRS; j++)
+    {
+        if((traceAttrs[j].endpoint == pAttr->endpoint) && (traceAttrs[j].cluster == pAttr->cluster))
+        {
+            bound[j] = bind;
+        }
+    }
+    if(bind)
+    {
+        // As bindAddEntry() does
+        numBinds++;
+        numBindsRunning += (OsalPortTimers_getTimerTimeout(bdb_TaskID, BDB_REPORT_TIMEOUT) != 0);
+        bdb_RepMarkHasBindingInEndpointClusterArray(pAttr->endpoint, pAttr->cluster,
+                                                    BDBREPORTING_FALSE, BDBREPORTING_TRUE);
+        bdb_RepStartOrContinueReporting();
+    }
+    else
+    {
+        // As bindRemoveEntry() does
+        numUnbinds++;
+        bdb_RepUpdateMarkBindings();
+    }
+}
+
+static void traceConfigure(int i)
+{
+    const traceAttr_t *pAttr = &traceAttrs[i];
+    uint8_t cmdBuf[sizeof(zclCfgReportCmd_t) + sizeof(zclCfgReportRec_t)];
+    zclCfgReportCmd_t *pCmd = (zclCfgReportCmd_t *)cmdBuf;
+    uint8_t change[BDBREPORTING_MAX_ANALOG_ATTR_SIZE] = { 0 };
+    zclIncomingMsg_t msg;
+
+    memset(&msg, 0, sizeof(msg));
+    msg.zclHdr.transSeqNum = (uint8_t)numConfigs;
+    msg.clusterId = pAttr->cluster;
+    msg.srcAddr.addrMode = afAddr16Bit;
+    msg.srcAddr.addr.shortAddr = 0x0000;
+    msg.srcAddr.endPoint = 1;
+    msg.endPoint = pAttr->endpoint;
+    msg.attrCmd = pCmd;
+
+    change[0] = (uint8_t)(1 + randRange(pAttr->reportableChange + 1));
+    pCmd->numAttr = 1;
+    pCmd->attrList[0].direction = ZCL_SEND_ATTR_REPORTS;
+    pCmd->attrList[0].attrID = pAttr->attrID;
+    pCmd->attrList[0].dataType = pAttr->dataType;
+    pCmd->attrList[0].timeoutPeriod = 0;
+    pCmd->attrList[0].reportableChange = change;
+    if(randRange(5) == 0)
+    {
+        // Back to the default configuration
+        pCmd->attrList[0].minReportInt = TRACE_MININTERVAL_DEFAULT;
+        pCmd->attrList[0].maxReportInt = TRACE_MAXINTERVAL_DEFAULT;
+    }
+    else
+    {
+        pCmd->attrList[0].minReportInt = traceMinInts[randRange(sizeof(traceMinInts) / sizeof(traceMinInts[0]))];
+        pCmd->attrList[0].maxReportInt = traceMaxInts[randRange(sizeof(traceMaxInts) / sizeof(traceMaxInts[0]))];
+    }
+    numConfigs++;
+    bdb_ProcessInConfigReportCmd(&msg);
+}
+
+/*
+ * Runs the trace for the given number of hours of virtual time.
+ */
+static void runTrace(uint32_t hours)
+{
+    uint64_t end = (uint64_t)hours * 3600 * 1000;
+
+    while(now < end)
+    {
+        uint32_t r = randRange(100000);
+        uint64_t gap;
+        int i = (int)randRange(TRACE_NUM_ATTRS);
+
+        // Mostly seconds apart, sometimes a burst, sometimes a quiet day
+        if(r < 10)
+        {
+            gap = 3600 * 1000 + (uint64_t)randRange(24 * 3600) * 1000;
+            numQuiet++;
+        }
+        else if(r < 20000)
+        {
+            gap = randRange(500);
+        }
+        else
+        {
+            gap = randRange(20000);
+        }
+        advanceTo(now + gap);
+
+        r = randRange(100);
+        if(r < 70)
+        {
+            traceChange(i);
+        }
+        else if(r < 85)
+        {
+            traceBind(i, !bound[i]);
+        }
+        else if(r < 87)
+        {
+            traceConfigure(i);
+        }
+    }
+    advanceTo(end);
+}
+
+static void setup(void)
+{
+    uint8_t change[BDBREPORTING_MAX_ANALOG_ATTR_SIZE];
+    int numA = 0;
+    int numB = 0;
+    int i;
+
+    ZstackHost_addEndpoint(&epDescA);
+    ZstackHost_addEndpoint(&epDescB);
+    for(i = 0; i < TRACE_NUM_ATTRS; i++)
+    {
+        const traceAttr_t *pAttr = &traceAttrs[i];
+        zclAttrRec_t *pRec = (pAttr->endpoint == TRACE_EP_A) ? &attrRecsA[numA++] : &attrRecsB[numB++];
+
+        pRec->clusterID = pAttr->cluster;
+        pRec->attr.attrId = pAttr->attrID;
+        pRec->attr.dataType = pAttr->dataType;
+        pRec->attr.accessControl = ACCESS_CONTROL_READ | ACCESS_REPORTABLE;
+        pRec->attr.dataPtr = &attrValues[i];
+    }
+    zcl_registerAttrList(TRACE_EP_A, numA, attrRecsA);
+    zcl_registerAttrList(TRACE_EP_B, numB, attrRecsB);
+
+    bdb_RepInit();
+    for(i = 0; i < TRACE_NUM_ATTRS; i++)
+    {
+        const traceAttr_t *pAttr = &traceAttrs[i];
+
+        memset(change, 0, sizeof(change));
+        change[0] = LO_UINT16(pAttr->reportableChange);
+        change[1] = HI_UINT16(pAttr->reportableChange);
+        bdb_RepAddAttrCfgRecordDefaultToList(pAttr->endpoint, pAttr->cluster, pAttr->attrID,
+                                             pAttr->minReportInt, pAttr->maxReportInt, change);
+    }
+    bdb_RepConstructReportingData();
+}
+
+//*****************************************************************************
+// Main
+//*****************************************************************************
+
+static void usage(const char *prog)
+{
+    printf("usage: %s [-t hours] [-s seed] [-l] [-x reference]\n", prog);
+    printf("  -t  hours of virtual time (default 336)\n");
+    printf("  -s  seed of the trace (default 1)\n");
+    printf("  -l  print the log of sent frames: time, endpoint, cluster, ZCL frame\n");
+    printf("  -x  run the same trace with another build of this program and\n");
+    printf("      compare the logs\n");
+}
+
+int main(int argc, char *argv[])
+{
+    char cmd[TRACE_MAX_LINE];
+    const char *ref = NULL;
+    int hours = 336;
+    int seed = 1;
+    int opt;
+
+    while((opt = getopt(argc, argv, "t:s:lx:h")) != -1)
+    {
+        switch(opt)
+        {
+            case 't': hours = atoi(optarg); break;
+            case 's': seed = atoi(optarg); break;
+            case 'l': logOut = stdout; break;
+            case 'x': ref = optarg; break;
+            case 'h': usage(argv[0]); return(0);
+            default: usage(argv[0]); return(2);
+        }
+    }
+    if((hours < 1) || ((logOut != NULL) && (ref != NULL)))
+    {
+        usage(argv[0]);
+        return(2);
+    }
+    if(ref != NULL)
+    {
+        snprintf(cmd, sizeof(cmd), "%s -t %d -s %d -l", ref, hours, seed);
+        refIn = popen(cmd, "r");
+        if(refIn == NULL)
+        {
+            printf("cannot run %s\n", ref);
+            return(1);
+        }
+    }
+    srand(seed);
+
+    ZstackHost_setAfDataCb(traceAfDataCb);
+    setup();
+    runTrace((uint32_t)hours);
+
+    if(refIn != NULL)
+    {
+        char extra[TRACE_MAX_LINE];
+
+        while(fgets(extra, sizeof(extra), refIn) != NULL)
+        {
+            if(mismatches < 10)
+            {
+                printf("line %u only in reference: %s", logLines + 1, extra);
+            }
+            logLines++;
+            mismatches++;
+        }
+        if(pclose(refIn) != 0)
+        {
+            printf("reference run failed\n");
+            failures++;
+        }
+    }
+    if(logOut != NULL)
+    {
+        return((failures != 0) ? 1 : 0);
+    }
+
+    printf("%d hours: %u attribute changes, %u bindings (%u while the timer ran), "
+           "%u unbindings, %u configurations, %u quiet periods\n",
+           hours, numChanges, numBinds, numBindsRunning, numUnbinds, numConfigs, numQuiet);
+    printf("%u timer expiries, %u report frames, %u configuration responses\n",
+           numExpiries, numReports, numCfgRsps);
+    if(refIn != NULL)
+    {
+        printf("lines differing from the reference: %u\n", mismatches);
+    }
+    printf("failures: %u\n", failures);
+
+    return(((failures != 0) || (mismatches != 0)) ? 1 : 0);
+}
@@ -80,6 +80,7 @@
 #include "zcl.h"
 #include <zstack/af/af.h>
 #include <zstack/common/gp/gp_bit_fields.h>
+#include <zstack/common/gp/gp_proxy.h>
 
 #include <zstack/common/gp/gp_interface.h>
 #include <ti15_4stack/mac/mac_api.h>
@@ -700,10 +701,8 @@ uint8_t gpLookForGpd( uint16_t currEntryId, uint8_t* pNew )
 
   zcl_memcpy(newEntry, pNew, GP_TBL_OPT_AND_GPD_ID_LEN);
 
-  status = zclport_readNV(ZCL_PORT_PROXY_TABLE_NV_ID, currEntryId,
-                          0,
-                          GP_TBL_OPT_AND_GPD_ID_LEN,
-                          currEntry);
+  // Served from the RAM copy of the proxy table entry keys
+  status = gp_getProxyTableKeyByIndex(currEntryId, currEntry);
 
   if((status == SUCCESS) && (GP_TBL_COMP_APPLICATION_ID( newEntry[GP_TBL_OPT], currEntry[GP_TBL_OPT])))
   {
@@ -140,6 +140,11 @@ static gpCommissioningMode_t  pfnCommissioningMode = NULL;
 static gpChangeChannelReq_t   pfnChangeChannelReq = NULL;
 static gpChangeChannelReq_t   pfnChangeChannelReqForBDB = NULL;
 
+// RAM copy of the options and GPD ID of every proxy table NV entry, so a
+// GPD can be resolved to its NV entry without reading the whole table
+static uint8_t gpProxyTblKeys[GPP_MAX_PROXY_TABLE_ENTRIES][GP_TBL_OPT_AND_GPD_ID_LEN];
+static uint8_t gpProxyTblKeysLoaded = FALSE;
+
 
 /*********************************************************************
  * PUBLIC FUNCTIONS
@@ -190,9 +195,7 @@ void zclGp_GpPairingCommandCB( zclGpPairing_t *pCmd )
     if(gp_getProxyTableByGpId(&gpdID, currEntry, &proxyTableIndex) == ZSuccess)
     {
       gp_ResetProxyTblEntry(currEntry);
-      zclport_writeNV(ZCL_PORT_PROXY_TABLE_NV_ID, proxyTableIndex,
-                               PROXY_TBL_LEN,
-                               currEntry);
+      gp_setProxyTableByIndex(proxyTableIndex, currEntry);
     }
     return;
   }
@@ -522,10 +525,7 @@ void zclGp_GpResponseCommandCB(zclGpResponse_t *pCmd)
       if(PROXY_TBL_GET_FIRST_TO_FORWARD(ProxyTableEntryTemp[PROXY_TBL_OPT]) == 0)
       {
         PROXY_TBL_SET_FIRST_TO_FORWARD(&ProxyTableEntryTemp[PROXY_TBL_OPT], TRUE);
-        zclport_writeNV(ZCL_PORT_PROXY_TABLE_NV_ID,
-                        NvProxyTableIndex,
-                        PROXY_TBL_LEN,
-                        &ProxyTableEntryTemp);
+        gp_setProxyTableByIndex(NvProxyTableIndex, ProxyTableEntryTemp);
       }
     }
     //Depends on TempMasterAddress
@@ -563,10 +563,7 @@ void zclGp_GpResponseCommandCB(zclGpResponse_t *pCmd)
        (PROXY_TBL_GET_FIRST_TO_FORWARD(ProxyTableEntryTemp[PROXY_TBL_OPT]) == 1))
     {
         PROXY_TBL_SET_FIRST_TO_FORWARD(&ProxyTableEntryTemp[PROXY_TBL_OPT], FALSE);
-        zclport_writeNV( ZCL_PORT_PROXY_TABLE_NV_ID,
-                         NvProxyTableIndex,
-                         PROXY_TBL_LEN,
-                         ProxyTableEntryTemp );
+        gp_setProxyTableByIndex(NvProxyTableIndex, ProxyTableEntryTemp);
     }
     //Also remove any packet to the GPD
     gp_DataReq->Action = 0;
@@ -654,6 +651,9 @@ uint8_t gp_ProxyTblInit(uint8_t resetTable)
 
  gp_ResetProxyTblEntry(emptyEntry);
 
+ // The entry keys are reloaded from NV on next lookup
+ gpProxyTblKeysLoaded = FALSE;
+
  for(i = 0; i < GPP_MAX_PROXY_TABLE_ENTRIES ; i++)
  {
    status = zclport_initializeNVItem(ZCL_PORT_PROXY_TABLE_NV_ID, i,
@@ -725,6 +725,7 @@ uint8_t gp_getProxyTableByGpId(gpdID_t *gpdID, uint8_t *pEntry, uint16_t *NvProx
 {
   uint8_t i;
   uint8_t status;
+  uint8_t key[GP_TBL_OPT_AND_GPD_ID_LEN];
 
   if((pEntry == NULL) || (gpdID == NULL) || (NvProxyTableIndex == NULL))
   {
@@ -733,7 +734,8 @@ uint8_t gp_getProxyTableByGpId(gpdID_t *gpdID, uint8_t *pEntry, uint16_t *NvProx
 
   for(i = 0; i < GPP_MAX_PROXY_TABLE_ENTRIES ; i++)
   {
-    status = gp_getProxyTableByIndex(i, pEntry);
+    // Only the RAM copy of the entry keys is searched
+    status = gp_getProxyTableKeyByIndex(i, key);
     if(status == NV_OPER_FAILED)
     {
       // FAIL
@@ -747,21 +749,21 @@ uint8_t gp_getProxyTableByGpId(gpdID_t *gpdID, uint8_t *pEntry, uint16_t *NvProx
     }
 
     //Check that App ID is the same
-    if(GP_TBL_COMP_APPLICATION_ID(gpdID->appID, pEntry[PROXY_TBL_OPT]))
+    if(GP_TBL_COMP_APPLICATION_ID(gpdID->appID, key[PROXY_TBL_OPT]))
     {
       if((gpdID->appID == GP_OPT_APP_ID_GPD) &&
-        zcl_memcmp( &gpdID->id.srcID, &pEntry[PROXY_TBL_GPD_ID + 4], sizeof(uint32_t)))
+        zcl_memcmp( &gpdID->id.srcID, &key[PROXY_TBL_GPD_ID + 4], sizeof(uint32_t)))
       {
         // Entry found
         *NvProxyTableIndex = i;
-        return ZSuccess;
+        break;
       }
       else if((gpdID->appID == GP_OPT_APP_ID_IEEE) &&
-              zcl_memcmp(&gpdID->id.gpdExtAddr, &pEntry[PROXY_TBL_GPD_ID], Z_EXTADDR_LEN))
+              zcl_memcmp(&gpdID->id.gpdExtAddr, &key[PROXY_TBL_GPD_ID], Z_EXTADDR_LEN))
       {
         // Entry found
         *NvProxyTableIndex = i;
-        return ZSuccess;
+        break;
       }
     }
     else
@@ -769,7 +771,17 @@ uint8_t gp_getProxyTableByGpId(gpdID_t *gpdID, uint8_t *pEntry, uint16_t *NvProx
       continue;
     }
   }
-  return ZInvalidParameter;
+
+  if(i >= GPP_MAX_PROXY_TABLE_ENTRIES)
+  {
+    return ZInvalidParameter;
+  }
+
+  if(gp_getProxyTableByIndex(i, pEntry) != SUCCESS)
+  {
+    return ZFailure;
+  }
+  return ZSuccess;
 }
 
  /*********************************************************************
@@ -807,6 +819,88 @@ uint8_t gp_getProxyTableByIndex( uint16_t nvIndex, uint8_t *pEntry )
   return status;
 }
 
+ /*********************************************************************
+ * @fn          gp_getProxyTableKeyByIndex
+ *
+ * @brief       Get the options and GPD ID of a proxy table entry from the
+ *              RAM copy, loading it from NV on first use
+ *
+ * @param       nvIndex - NV Id of proxy table
+ *              pKey    - pointer to GP_TBL_OPT_AND_GPD_ID_LEN array
+ *
+ * @return      SUCCESS, NV_INVALID_DATA if the entry is empty or
+ *              NV_OPER_FAILED if the table could not be read
+ */
+uint8_t gp_getProxyTableKeyByIndex( uint16_t nvIndex, uint8_t *pKey )
+{
+  uint8_t i;
+  uint8_t status;
+  uint16_t emptyEntry = 0xFFFF;
+
+  if(nvIndex >= GPP_MAX_PROXY_TABLE_ENTRIES)
+  {
+    return NV_OPER_FAILED;
+  }
+
+  if(gpProxyTblKeysLoaded == FALSE)
+  {
+    for(i = 0; i < GPP_MAX_PROXY_TABLE_ENTRIES ; i++)
+    {
+      status = zclport_readNV(ZCL_PORT_PROXY_TABLE_NV_ID, i,
+                              0,
+                              GP_TBL_OPT_AND_GPD_ID_LEN,
+                              gpProxyTblKeys[i]);
+      if(status != SUCCESS)
+      {
+        return NV_OPER_FAILED;
+      }
+    }
+    gpProxyTblKeysLoaded = TRUE;
+  }
+
+  zcl_memcpy(pKey, gpProxyTblKeys[nvIndex], GP_TBL_OPT_AND_GPD_ID_LEN);
+
+  // if the entry is empty
+  if(zcl_memcmp(pKey, &emptyEntry, sizeof(uint16_t)))
+  {
+    return NV_INVALID_DATA;
+  }
+
+  return SUCCESS;
+}
+
+ /*********************************************************************
+ * @fn          gp_setProxyTableByIndex
+ *
+ * @brief       General function to write a proxy table entry to NV,
+ *              keeping the RAM copy of the entry keys in sync
+ *
+ * @param       nvIndex - NV Id of proxy table
+ *              pEntry  - pointer to PROXY_TBL_LEN array
+ *
+ * @return      status of the NV write
+ */
+uint8_t gp_setProxyTableByIndex( uint16_t nvIndex, uint8_t *pEntry )
+{
+  uint8_t status;
+
+  status = zclport_writeNV(ZCL_PORT_PROXY_TABLE_NV_ID, nvIndex,
+                           PROXY_TBL_LEN,
+                           pEntry);
+
+  if((status == SUCCESS) && (nvIndex < GPP_MAX_PROXY_TABLE_ENTRIES))
+  {
+    zcl_memcpy(gpProxyTblKeys[nvIndex], pEntry, GP_TBL_OPT_AND_GPD_ID_LEN);
+  }
+  else
+  {
+    // NV content is unknown, reload it on next lookup
+    gpProxyTblKeysLoaded = FALSE;
+  }
+
+  return status;
+}
+
 /*********************************************************************
  * @fn          gp_dataIndProxy
  *
@@ -916,9 +1010,7 @@ void gp_dataIndProxy(gp_DataInd_t *gp_DataInd)
                 (uint8_t*)&gp_DataInd->GPDSecFrameCounter,
                 sizeof(uint32_t));
 
-      zclport_writeNV(ZCL_PORT_PROXY_TABLE_NV_ID, nvIndex,
-                        PROXY_TBL_LEN,
-                        pProxyTableEntry);
+      gp_setProxyTableByIndex(nvIndex, pProxyTableEntry);
     }
 
 
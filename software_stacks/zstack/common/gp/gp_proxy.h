@@ -172,6 +172,16 @@ extern uint8_t gp_getProxyTableByGpId(gpdID_t *gpdID, uint8_t *pEntry, uint16_t*
  */
 extern uint8_t gp_getProxyTableByIndex( uint16_t nvIndex, uint8_t *pEntry );
 
+/*
+ * @brief   Get the options and GPD ID of a proxy table entry from RAM
+ */
+extern uint8_t gp_getProxyTableKeyByIndex( uint16_t nvIndex, uint8_t *pKey );
+
+/*
+ * @brief   General function to write a proxy table entry by NV index
+ */
+extern uint8_t gp_setProxyTableByIndex( uint16_t nvIndex, uint8_t *pEntry );
+
 /*
  * @brief   Handle Gp attributes.
  */
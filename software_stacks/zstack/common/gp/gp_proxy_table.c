@@ -340,7 +340,8 @@ uint8_t gp_UpdateProxyTbl( uint8_t* pEntry, uint32_t options, uint8_t conflictRe
   for(i = 0; i < GPP_MAX_PROXY_TABLE_ENTRIES ; i++)
   {
     proxyTableIndex = i;
-    status = gp_getProxyTableByIndex(proxyTableIndex, currEntry);
+    // Only the entry keys are needed to look for the GPD
+    status = gp_getProxyTableKeyByIndex(proxyTableIndex, currEntry);
     if(status == NV_OPER_FAILED)
     {
       // FAIL
@@ -351,9 +352,7 @@ uint8_t gp_UpdateProxyTbl( uint8_t* pEntry, uint32_t options, uint8_t conflictRe
     if((status == NV_INVALID_DATA) && (GP_PAIRING_OPT_ADD_SINK(options) == TRUE))
     {
       // Save new entry
-      status = zclport_writeNV( ZCL_PORT_PROXY_TABLE_NV_ID, proxyTableIndex,
-                                PROXY_TBL_LEN,
-                                newEntry );
+      status = gp_setProxyTableByIndex( proxyTableIndex, newEntry );
 
       // Perform address conflict resolution
       if(zcl_memcmp(&_NIB.nwkDevAddress, &newEntry[PROXY_TBL_ALIAS], sizeof(uint16_t))        ||
@@ -397,6 +396,12 @@ uint8_t gp_UpdateProxyTbl( uint8_t* pEntry, uint32_t options, uint8_t conflictRe
     return FAILURE;
   }
 
+  status = gp_getProxyTableByIndex(proxyTableIndex, currEntry);
+  if(status != SUCCESS)
+  {
+    return status;
+  }
+
   // Remove the entry
   if(GP_PAIRING_OPT_ADD_SINK(options) == FALSE)
   {
@@ -407,9 +412,7 @@ uint8_t gp_UpdateProxyTbl( uint8_t* pEntry, uint32_t options, uint8_t conflictRe
     {
       gp_ResetProxyTblEntry(currEntry);
     }
-    status = zclport_writeNV(ZCL_PORT_PROXY_TABLE_NV_ID, proxyTableIndex,
-                             PROXY_TBL_LEN,
-                             currEntry);
+    status = gp_setProxyTableByIndex(proxyTableIndex, currEntry);
     return status;
   }
 
@@ -450,9 +453,7 @@ uint8_t gp_UpdateProxyTbl( uint8_t* pEntry, uint32_t options, uint8_t conflictRe
   zcl_memcpy(&currEntry[PROXY_TBL_SEC_FRAME], &newEntry[PROXY_TBL_SEC_FRAME], sizeof(uint32_t));
   currEntry[PROXY_TBL_RADIUS] = newEntry[PROXY_TBL_RADIUS];
   currEntry[PROXY_TBL_SEARCH_COUNTER] = newEntry[PROXY_TBL_SEARCH_COUNTER];
-  status = zclport_writeNV(ZCL_PORT_PROXY_TABLE_NV_ID, proxyTableIndex,
-                           PROXY_TBL_LEN,
-                           currEntry);
+  status = gp_setProxyTableByIndex(proxyTableIndex, currEntry);
 
   if (zcl_memcmp(&_NIB.nwkDevAddress, &currEntry[PROXY_TBL_ALIAS], sizeof(uint16_t))        ||
       zcl_memcmp(&_NIB.nwkDevAddress, &currEntry[PROXY_TBL_1ST_GRP_ADDR], sizeof(uint16_t)) ||
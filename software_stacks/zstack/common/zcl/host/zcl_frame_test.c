@@ -0,0 +1,481 @@
+/******************************************************************************
+
+ @file  zcl_frame_test.c
+
+ @brief ZCL frame builder allocation and copy test
+
+ Group: WCS, LPC
+ Target Device: cc13xx_cc26xx
+
+ ******************************************************************************
+ 
+ Copyright (c) 2019-2026, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ 
+ 
+ *****************************************************************************/
+
+/*
+Checks that the ZCL commands serialized into a zcl_FrameAlloc() buffer are
+sent with one allocation and without copying the payload, and that they go
+out exactly as the copying path sends them. For every case the frame is sent
+twice, counting the allocations and copies of zstack_host.c:
+
+- old: the payload serialized into its own zcl_mem_alloc() buffer and sent
+  with zcl_SendCommandEx(), which allocates the frame and copies the payload
+  behind the ZCL header, as zcl.c did before the frame builder
+- new: the zcl.c function under test, zcl_SendRead(), zcl_SendReadRsp(),
+  zcl_SendReportCmdEx() or zcl_SendFrame()
+
+and checks:
+
+- both hand AF the same bytes
+- new allocates once, frees what it allocated, and copies payloadLen bytes
+  less than old
+- the largest ZCL header, manufacturer specific, fits in the headroom
+
+The table shows the counters per frame, copies in bytes. The copies left on
+the new path are string attributes serialized into the frame. AF copy is the
+frame AF_DataRequest() copies into the APS frame on target, the same for
+both. The exit status is 1 on any failure.
+
+zcl.c is included by this file, for the static serializers the old path
+uses. Build and run from the repository root:
+
+  cc -O2 -DOSAL_PORT2TIRTOS -DZCL_READ -DZCL_REPORTING_DEVICE \
+      -Isoftware_stacks/zstack/host -I. -Isoftware_stacks \
+      -Isoftware_stacks/ti15_4stack/hal/platform \
+      -Isoftware_stacks/ti15_4stack/mac/services \
+      -Isoftware_stacks/ti15_4stack/mac -Isoftware_stacks/zstack/af \
+      -Isoftware_stacks/zstack/bdb -Isoftware_stacks/zstack/sys \
+      -Isoftware_stacks/zstack/nwk -Isoftware_stacks/zstack/osal_port \
+      -Isoftware_stacks/zstack/common/zcl -Isoftware_stacks/zstack/stack_task \
+      -Isoftware_stacks/zstack/zdo -Isoftware_stacks/zstack/sec \
+      -Isoftware_stacks/zstack/gp -Isoftware_stacks/zstack/zmac -Idrivers/nv \
+      -o zcl_frame_test \
+      software_stacks/zstack/common/zcl/host/zcl_frame_test.c \
+      software_stacks/zstack/host/zstack_host.c
+  ./zcl_frame_test
+*/
+
+//*****************************************************************************
+// Includes
+//*****************************************************************************
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <zstack/common/zcl/zcl.c>
+#include "zstack_host.h"
+
+//*****************************************************************************
+// Constants and Definitions
+//*****************************************************************************
+
+// Home Automation profile
+#define FRAME_PROFILE_ID        0x0104
+
+#define FRAME_SRC_EP            8
+#define FRAME_DST_EP            9
+
+#define FRAME_MAX_ATTRS         16
+#define FRAME_MAX_LEN           256
+
+#define FRAME_MANU_CODE         0x1234
+
+//*****************************************************************************
+// Typedefs
+//*****************************************************************************
+
+// Counters and frame of one send
+typedef struct
+{
+    ZStatus_t status;
+    uint32_t  mallocs;
+    uint32_t  frees;
+    uint32_t  copyBytes;
+    uint32_t  afCopyBytes;
+    uint16_t  len;
+    uint8_t   frame[FRAME_MAX_LEN];
+} frameSend_t;
+
+// A frame to send the old and the new way
+typedef struct
+{
+    const char *name;
+    ZStatus_t (*pfnOld)(void);
+    ZStatus_t (*pfnNew)(void);
+    uint16_t  (*pfnPayloadLen)(void);
+} frameCase_t;
+
+//*****************************************************************************
+// Locals
+//*****************************************************************************
+
+static SimpleDescriptionFormat_t srcDesc = { FRAME_SRC_EP, FRAME_PROFILE_ID };
+static endPointDesc_t srcEp = { FRAME_SRC_EP, 0, NULL, &srcDesc, noLatencyReqs };
+static afAddrType_t dstAddr;
+
+// Captured by the AF data callback
+static frameSend_t *pCapture;
+
+// Attribute values
+static uint8_t  valBool = 1;
+static uint8_t  valUint8 = 0x5A;
+static uint16_t valUint16 = 0x1234;
+static uint32_t valUint32 = 0x89ABCDEF;
+static int16_t  valInt16 = -1234;
+static uint8_t  valEnum8 = 3;
+static uint8_t  valString[] = { 11, 'T', 'e', 'x', 'a', 's', ' ', 'I', 'n', 's', 't', '.' };
+
+static uint8_t readCmdBuf[sizeof(zclReadCmd_t) + FRAME_MAX_ATTRS * sizeof(uint16_t)];
+static uint8_t readRspCmdBuf[sizeof(zclReadRspCmd_t) + FRAME_MAX_ATTRS * sizeof(zclReadRspStatus_t)];
+static uint8_t reportCmdBuf[sizeof(zclReportCmd_t) + FRAME_MAX_ATTRS * sizeof(zclReport_t)];
+static zclReadCmd_t *readCmd = (zclReadCmd_t *)readCmdBuf;
+static zclReadRspCmd_t *readRspCmd = (zclReadRspCmd_t *)readRspCmdBuf;
+static zclReportCmd_t *reportCmd = (zclReportCmd_t *)reportCmdBuf;
+
+static uint8_t manuPayload[40];
+
+static uint32_t failures;
+
+//*****************************************************************************
+// Old path, as zcl.c sent these commands before the frame builder
+//*****************************************************************************
+
+static uint16_t readPayloadLen(void)
+{
+    return((uint16_t)(readCmd->numAttr * 2));
+}
+
+static ZStatus_t oldSendRead(void)
+{
+    uint16_t dataLen = readPayloadLen();
+    uint8_t *buf = zcl_mem_alloc(dataLen);
+    uint8_t *pBuf = buf;
+    ZStatus_t status;
+    uint8_t i;
+
+    for(i = 0; i < readCmd->numAttr; i++)
+    {
+        *pBuf++ = LO_UINT16(readCmd->attrID[i]);
+        *pBuf++ = HI_UINT16(readCmd->attrID[i]);
+    }
+    status = zcl_SendCommand(FRAME_SRC_EP, &dstAddr, ZCL_CLUSTER_ID_GENERAL_BASIC, ZCL_CMD_READ,
+                             FALSE, ZCL_FRAME_CLIENT_SERVER_DIR, FALSE, 0, 1, dataLen, buf);
+    zcl_mem_free(buf);
+    return(status);
+}
+
+static uint16_t readRspPayloadLen(void)
+{
+    uint16_t len = 0;
+    uint8_t i;
+
+    for(i = 0; i < readRspCmd->numAttr; i++)
+    {
+        zclReadRspStatus_t *statusRec = &readRspCmd->attrList[i];
+
+        len += 2 + 1;
+        if(statusRec->status == ZCL_STATUS_SUCCESS)
+        {
+            len += 1 + zclGetAttrDataLength(statusRec->dataType, statusRec->data);
+        }
+    }
+    return(len);
+}
+
+static ZStatus_t oldSendReadRsp(void)
+{
+    uint16_t len = readRspPayloadLen();
+    uint8_t *buf = zcl_mem_alloc(len);
+    uint8_t *pBuf = buf;
+    ZStatus_t status;
+    uint8_t i;
+
+    for(i = 0; i < readRspCmd->numAttr; i++)
+    {
+        zclReadRspStatus_t *statusRec = &readRspCmd->attrList[i];
+
+        *pBuf++ = LO_UINT16(statusRec->attrID);
+        *pBuf++ = HI_UINT16(statusRec->attrID);
+        *pBuf++ = statusRec->status;
+        if(statusRec->status == ZCL_STATUS_SUCCESS)
+        {
+            *pBuf++ = statusRec->dataType;
+            pBuf = zclSerializeData(statusRec->dataType, statusRec->data, pBuf);
+        }
+    }
+    status = zcl_SendCommand(FRAME_SRC_EP, &dstAddr, ZCL_CLUSTER_ID_GENERAL_BASIC, ZCL_CMD_READ_RSP,
+                             FALSE, ZCL_FRAME_SERVER_CLIENT_DIR, TRUE, 0, 2, len, buf);
+    zcl_mem_free(buf);
+    return(status);
+}
+
+static uint16_t reportPayloadLen(void)
+{
+    uint16_t len = 0;
+    uint8_t i;
+
+    for(i = 0; i < reportCmd->numAttr; i++)
+    {
+        len += 2 + 1 + zclGetAttrDataLength(reportCmd->attrList[i].dataType,
+                                            reportCmd->attrList[i].attrData);
+    }
+    return(len);
+}
+
+static ZStatus_t oldSendReport(void)
+{
+    uint16_t len = reportPayloadLen();
+    uint8_t *buf = zcl_mem_alloc(len);
+    uint8_t *pBuf = buf;
+    ZStatus_t status;
+    uint8_t i;
+
+    for(i = 0; i < reportCmd->numAttr; i++)
+    {
+        zclReport_t *reportRec = &reportCmd->attrList[i];
+
+        *pBuf++ = LO_UINT16(reportRec->attrID);
+        *pBuf++ = HI_UINT16(reportRec->attrID);
+        *pBuf++ = reportRec->dataType;
+        pBuf = zclSerializeData(reportRec->dataType, reportRec->attrData, pBuf);
+    }
+    status = zcl_SendCommandEx(FRAME_SRC_EP, &dstAddr, ZCL_CLUSTER_ID_GENERAL_BASIC, ZCL_CMD_REPORT,
+                               FALSE, ZCL_FRAME_SERVER_CLIENT_DIR, TRUE, 0, 3, len, buf, FALSE);
+    zcl_mem_free(buf);
+    return(status);
+}
+
+static uint16_t manuPayloadLen(void)
+{
+    return(sizeof(manuPayload));
+}
+
+static ZStatus_t oldSendManu(void)
+{
+    uint8_t *buf = zcl_mem_alloc(sizeof(manuPayload));
+    ZStatus_t status;
+
+    memcpy(buf, manuPayload, sizeof(manuPayload));
+    status = zcl_SendCommand(FRAME_SRC_EP, &dstAddr, ZCL_CLUSTER_ID_GENERAL_BASIC, 0x01,
+                             TRUE, ZCL_FRAME_CLIENT_SERVER_DIR, FALSE, FRAME_MANU_CODE, 4,
+                             sizeof(manuPayload), buf);
+    zcl_mem_free(buf);
+    return(status);
+}
+
+//*****************************************************************************
+// New path
+//*****************************************************************************
+
+static ZStatus_t newSendRead(void)
+{
+    return(zcl_SendRead(FRAME_SRC_EP, &dstAddr, ZCL_CLUSTER_ID_GENERAL_BASIC, readCmd,
+                        ZCL_FRAME_CLIENT_SERVER_DIR, FALSE, 1));
+}
+
+static ZStatus_t newSendReadRsp(void)
+{
+    return(zcl_SendReadRsp(FRAME_SRC_EP, &dstAddr, ZCL_CLUSTER_ID_GENERAL_BASIC, readRspCmd,
+                           ZCL_FRAME_SERVER_CLIENT_DIR, TRUE, 2));
+}
+
+static ZStatus_t newSendReport(void)
+{
+    return(zcl_SendReportCmdEx(FRAME_SRC_EP, &dstAddr, ZCL_CLUSTER_ID_GENERAL_BASIC, reportCmd,
+                               ZCL_FRAME_SERVER_CLIENT_DIR, TRUE, 3, FALSE));
+}
+
+static ZStatus_t newSendManu(void)
+{
+    uint8_t *buf = zcl_FrameAlloc(sizeof(manuPayload));
+    ZStatus_t status;
+
+    // The payload is built in place, memcpy() stands in for a serializer
+    memcpy(buf, manuPayload, sizeof(manuPayload));
+    status = zcl_SendFrame(FRAME_SRC_EP, &dstAddr, ZCL_CLUSTER_ID_GENERAL_BASIC, 0x01,
+                           TRUE, ZCL_FRAME_CLIENT_SERVER_DIR, FALSE, FRAME_MANU_CODE, 4,
+                           sizeof(manuPayload), buf);
+    zcl_FrameFree(buf);
+    return(status);
+}
+
+//*****************************************************************************
+// Test
+//*****************************************************************************
+
+/*
+ * AF data requests end up here, the frame is kept for comparison.
+ */
+static afStatus_t frameAfDataCb(afAddrType_t *dstAddr, endPointDesc_t *srcEP, uint16_t cID,
+                                uint16_t len, uint8_t *buf, uint8_t options)
+{
+    (void)dstAddr;
+    (void)srcEP;
+    (void)cID;
+    (void)options;
+
+    if((pCapture == NULL) || (len > FRAME_MAX_LEN))
+    {
+        printf("unexpected AF data request of %u bytes\n", len);
+        failures++;
+        return(afStatus_SUCCESS);
+    }
+    memcpy(pCapture->frame, buf, len);
+    pCapture->len = len;
+    return(afStatus_SUCCESS);
+}
+
+/*
+ * Send a frame and keep its counters.
+ */
+static void frameSend(ZStatus_t (*pfn)(void), frameSend_t *pSend)
+{
+    memset(pSend, 0, sizeof(frameSend_t));
+    pCapture = pSend;
+    ZstackHost_resetStats();
+
+    pSend->status = pfn();
+
+    pSend->mallocs = ZstackHost_stats.mallocs;
+    pSend->frees = ZstackHost_stats.frees;
+    pSend->copyBytes = ZstackHost_stats.copyBytes;
+    pSend->afCopyBytes = ZstackHost_stats.afCopyBytes;
+    pCapture = NULL;
+}
+
+static void frameCheck(const char *name, int ok, const char *what)
+{
+    if(!ok)
+    {
+        printf("%s: %s\n", name, what);
+        failures++;
+    }
+}
+
+static void frameRun(const frameCase_t *pCase)
+{
+    static frameSend_t oldSend;
+    static frameSend_t newSend;
+    uint16_t payloadLen = pCase->pfnPayloadLen();
+
+    frameSend(pCase->pfnOld, &oldSend);
+    frameSend(pCase->pfnNew, &newSend);
+
+    printf("  %-22s %7u %10u %10u %11u %11u %7u\n", pCase->name, payloadLen,
+           oldSend.mallocs, newSend.mallocs, oldSend.copyBytes, newSend.copyBytes,
+           newSend.afCopyBytes);
+
+    frameCheck(pCase->name, (oldSend.status == ZSuccess) && (newSend.status == ZSuccess),
+               "send failed");
+    frameCheck(pCase->name, (oldSend.len == newSend.len) &&
+               (memcmp(oldSend.frame, newSend.frame, newSend.len) == 0),
+               "frames differ");
+    frameCheck(pCase->name, newSend.mallocs == 1, "more than one allocation");
+    frameCheck(pCase->name, newSend.frees == newSend.mallocs, "allocation not freed");
+    frameCheck(pCase->name, oldSend.copyBytes - newSend.copyBytes == payloadLen,
+               "payload copied");
+}
+
+static void frameSetup(void)
+{
+    uint8_t i;
+
+    readCmd->numAttr = 8;
+    for(i = 0; i < readCmd->numAttr; i++)
+    {
+        readCmd->attrID[i] = (uint16_t)(0x0000 + i);
+    }
+
+    readRspCmd->numAttr = 8;
+    readRspCmd->attrList[0] = (zclReadRspStatus_t){ 0x0000, ZCL_STATUS_SUCCESS, ZCL_DATATYPE_UINT8, &valUint8 };
+    readRspCmd->attrList[1] = (zclReadRspStatus_t){ 0x0001, ZCL_STATUS_SUCCESS, ZCL_DATATYPE_UINT16, (uint8_t *)&valUint16 };
+    readRspCmd->attrList[2] = (zclReadRspStatus_t){ 0x0002, ZCL_STATUS_SUCCESS, ZCL_DATATYPE_UINT32, (uint8_t *)&valUint32 };
+    readRspCmd->attrList[3] = (zclReadRspStatus_t){ 0x0003, ZCL_STATUS_SUCCESS, ZCL_DATATYPE_INT16, (uint8_t *)&valInt16 };
+    readRspCmd->attrList[4] = (zclReadRspStatus_t){ 0x0004, ZCL_STATUS_SUCCESS, ZCL_DATATYPE_CHAR_STR, valString };
+    readRspCmd->attrList[5] = (zclReadRspStatus_t){ 0x0005, ZCL_STATUS_UNSUPPORTED_ATTRIBUTE, 0, NULL };
+    readRspCmd->attrList[6] = (zclReadRspStatus_t){ 0x0006, ZCL_STATUS_SUCCESS, ZCL_DATATYPE_ENUM8, &valEnum8 };
+    readRspCmd->attrList[7] = (zclReadRspStatus_t){ 0x0007, ZCL_STATUS_SUCCESS, ZCL_DATATYPE_BOOLEAN, &valBool };
+
+    reportCmd->numAttr = 4;
+    reportCmd->attrList[0] = (zclReport_t){ 0x0000, ZCL_DATATYPE_UINT16, (uint8_t *)&valUint16 };
+    reportCmd->attrList[1] = (zclReport_t){ 0x0001, ZCL_DATATYPE_INT16, (uint8_t *)&valInt16 };
+    reportCmd->attrList[2] = (zclReport_t){ 0x0002, ZCL_DATATYPE_CHAR_STR, valString };
+    reportCmd->attrList[3] = (zclReport_t){ 0x0003, ZCL_DATATYPE_BOOLEAN, &valBool };
+
+    for(i = 0; i < sizeof(manuPayload); i++)
+    {
+        manuPayload[i] = i;
+    }
+}
+
+//*****************************************************************************
+// Main
+//*****************************************************************************
+
+int main(void)
+{
+    static const frameCase_t cases[] =
+    {
+        { "read, 8 attributes",       oldSendRead,    newSendRead,    readPayloadLen },
+        { "read rsp, 8 attributes",   oldSendReadRsp, newSendReadRsp, readRspPayloadLen },
+        { "report, 4 attributes",     oldSendReport,  newSendReport,  reportPayloadLen },
+        { "manufacturer specific",    oldSendManu,    newSendManu,    manuPayloadLen },
+    };
+    unsigned int c;
+
+    dstAddr.addrMode = afAddr16Bit;
+    dstAddr.addr.shortAddr = 0x0001;
+    dstAddr.endPoint = FRAME_DST_EP;
+    ZstackHost_addEndpoint(&srcEp);
+    ZstackHost_setAfDataCb(frameAfDataCb);
+    frameSetup();
+
+    printf("  %-22s %7s %10s %10s %11s %11s %7s\n", "frame", "payload", "old allocs",
+           "new allocs", "old copied", "new copied", "AF copy");
+    for(c = 0; c < sizeof(cases) / sizeof(cases[0]); c++)
+    {
+        frameRun(&cases[c]);
+    }
+
+    if(ZstackHost_stats.inUse != 0)
+    {
+        printf("%u blocks leaked\n", ZstackHost_stats.inUse);
+        failures++;
+    }
+    printf("failures: %u\n", failures);
+
+    return((failures != 0) ? 1 : 0);
+}
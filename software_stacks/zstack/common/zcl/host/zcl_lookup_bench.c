@@ -0,0 +1,658 @@
+/******************************************************************************
+
+ @file  zcl_lookup_bench.c
+
+ @brief ZCL attribute and command record lookup benchmark
+
+ Group: WCS, LPC
+ Target Device: cc13xx_cc26xx
+
+ ******************************************************************************
+ 
+ Copyright (c) 2019-2026, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ 
+ 
+ *****************************************************************************/
+
+/*
+Compares the attribute and command record lookups of zcl.c, which use the
+sorted record indexes built at registration, with the linear scans they
+replaced, on endpoints with several hundred attribute records:
+
+- zclFindAttrRec() and zclFindCmdRec(), for records that exist and for
+  records that don't
+- zclFindNextAttrRec() and zclFindNextCmdRec(), walking every record of a
+  cluster as the discover attributes/commands handlers do
+
+Every lookup is first checked against the linear scan, which is the
+reference: both must return the same record, including for record lists that
+are not sorted by ID (-u), where discovery returns records in list order.
+The exit status is 1 on any difference.
+
+zcl.c is included by this file, so that its static lookup functions can be
+called. Build and run from the repository root:
+
+  cc -O2 -DOSAL_PORT2TIRTOS -DZCL_READ -DZCL_WRITE -DZCL_DISCOVER \
+      -Isoftware_stacks/zstack/host -I. -Isoftware_stacks \
+      -Isoftware_stacks/ti15_4stack/hal/platform \
+      -Isoftware_stacks/ti15_4stack/mac/services \
+      -Isoftware_stacks/ti15_4stack/mac -Isoftware_stacks/zstack/af \
+      -Isoftware_stacks/zstack/bdb -Isoftware_stacks/zstack/sys \
+      -Isoftware_stacks/zstack/nwk -Isoftware_stacks/zstack/osal_port \
+      -Isoftware_stacks/zstack/common/zcl -Isoftware_stacks/zstack/stack_task \
+      -Isoftware_stacks/zstack/zdo -Isoftware_stacks/zstack/sec \
+      -Isoftware_stacks/zstack/gp -Isoftware_stacks/zstack/zmac -Idrivers/nv \
+      -o zcl_lookup_bench \
+      software_stacks/zstack/common/zcl/host/zcl_lookup_bench.c \
+      software_stacks/zstack/host/zstack_host.c
+  ./zcl_lookup_bench -h
+*/
+
+//*****************************************************************************
+// Includes
+//*****************************************************************************
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <zstack/common/zcl/zcl.c>
+#include "zstack_host.h"
+
+//*****************************************************************************
+// Constants and Definitions
+//*****************************************************************************
+
+#define BENCH_MAX_ENDPOINTS     8
+#define BENCH_MAX_RECORDS       255
+
+// First endpoint, cluster and attribute IDs used
+#define BENCH_FIRST_ENDPOINT    1
+#define BENCH_FIRST_CLUSTER     0x0000
+#define BENCH_ATTR_ID_STEP      3
+
+#define BENCH_CMDS_PER_CLUSTER  8
+
+//*****************************************************************************
+// Locals
+//*****************************************************************************
+
+static int numEndpoints = 4;
+static int numAttrs = 250;
+static int numClusters = 10;
+static long numLookups = 200000;
+static int unsorted = 0;
+
+static zclAttrRec_t benchAttrs[BENCH_MAX_ENDPOINTS][BENCH_MAX_RECORDS];
+static zclCommandRec_t benchCmds[BENCH_MAX_ENDPOINTS][BENCH_MAX_RECORDS];
+static int benchNumCmds;
+static uint8_t benchData;
+
+// Records looked up by the timed loops, drawn before timing starts
+#define BENCH_QUERIES           4096
+static uint16_t queryEp[BENCH_QUERIES];
+static uint16_t queryRec[BENCH_QUERIES];
+
+static long mismatches;
+static volatile uint32_t sink;
+
+//*****************************************************************************
+// Reference lookups, the linear scans of the records in list order
+//*****************************************************************************
+
+static zclAttrRecsList *refFindAttrRecsList(uint8_t endpoint)
+{
+  zclAttrRecsList *pLoop = attrList;
+
+  while ( pLoop != NULL )
+  {
+    if ( pLoop->endpoint == endpoint )
+    {
+      return ( pLoop );
+    }
+    pLoop = pLoop->next;
+  }
+  return ( NULL );
+}
+
+static zclCmdRecsList_t *refFindCmdRecsList(uint8_t endpoint)
+{
+  zclCmdRecsList_t *pLoop = gpCmdList;
+
+  while ( pLoop != NULL )
+  {
+    if ( pLoop->endpoint == endpoint )
+    {
+      return ( pLoop );
+    }
+    pLoop = pLoop->pNext;
+  }
+  return ( NULL );
+}
+
+static uint8_t refFindAttrRec(uint8_t endpoint, uint16_t clusterID, uint16_t attrId,
+                              zclAttrRec_t *pAttr)
+{
+  zclAttrRecsList *pRec = refFindAttrRecsList( endpoint );
+  uint16_t x;
+
+  if ( pRec != NULL )
+  {
+    for ( x = 0; x < pRec->numAttributes; x++ )
+    {
+      if ( pRec->attrs[x].clusterID == clusterID && pRec->attrs[x].attr.attrId == attrId )
+      {
+        *pAttr = pRec->attrs[x];
+        return ( TRUE );
+      }
+    }
+  }
+  return ( FALSE );
+}
+
+static uint8_t refFindCmdRec(uint8_t endpoint, uint16_t clusterID, uint8_t cmdID,
+                             zclCommandRec_t *pCmd)
+{
+  zclCmdRecsList_t *pRec = refFindCmdRecsList( endpoint );
+  uint16_t i;
+
+  if ( pRec != NULL )
+  {
+    for ( i = 0; i < pRec->numCommands; i++ )
+    {
+      if ( pRec->pCmdRecs[i].clusterID == clusterID && pRec->pCmdRecs[i].cmdID == cmdID )
+      {
+        *pCmd = pRec->pCmdRecs[i];
+        return ( TRUE );
+      }
+    }
+  }
+  return ( FALSE );
+}
+
+static uint8_t refFindNextAttrRec(uint8_t endpoint, uint16_t clusterID, uint8_t direction,
+                                  uint16_t *attrId, zclAttrRec_t *pAttr)
+{
+  zclAttrRecsList *pRec = refFindAttrRecsList( endpoint );
+  uint8_t attrDir;
+  uint16_t x;
+
+  if ( pRec != NULL )
+  {
+    for ( x = 0; x < pRec->numAttributes; x++ )
+    {
+      if ( ( pRec->attrs[x].clusterID == clusterID ) &&
+           ( pRec->attrs[x].attr.attrId >= *attrId ) )
+      {
+        attrDir = (pRec->attrs[x].attr.accessControl & ACCESS_CLIENT) ? 1 : 0;
+        if ( (attrDir == direction) || (pRec->attrs[x].attr.accessControl & ACCESS_GLOBAL))
+        {
+          *pAttr = pRec->attrs[x];
+          *attrId = pAttr->attr.attrId;
+          return ( TRUE );
+        }
+      }
+    }
+  }
+  return ( FALSE );
+}
+
+static uint8_t refFindNextCmdRec(uint8_t endpoint, uint16_t clusterID, uint8_t commandID,
+                                 uint8_t direction, uint8_t *pCmdID, zclCommandRec_t *pCmd)
+{
+  zclCmdRecsList_t *pRec = refFindCmdRecsList( endpoint );
+  uint8_t flag;
+  uint16_t i;
+
+  if ( pRec != NULL )
+  {
+    for ( i = 0; i < pRec->numCommands; i++ )
+    {
+      if ( ( pRec->pCmdRecs[i].clusterID == clusterID ) &&
+           ( pRec->pCmdRecs[i].cmdID >= *pCmdID ) )
+      {
+        flag = pRec->pCmdRecs[i].flag;
+        if ( commandID == ZCL_CMD_DISCOVER_CMDS_RECEIVED )
+        {
+          if ( ( ( direction == ZCL_FRAME_SERVER_CLIENT_DIR ) && ( flag & CMD_DIR_CLIENT_RECEIVED ) ) ||
+               ( ( direction == ZCL_FRAME_CLIENT_SERVER_DIR ) && ( flag & CMD_DIR_SERVER_RECEIVED ) ) )
+          {
+            *pCmd = pRec->pCmdRecs[i];
+            *pCmdID = pCmd->cmdID;
+            return ( TRUE );
+          }
+        }
+        else if ( commandID == ZCL_CMD_DISCOVER_CMDS_GEN )
+        {
+          if ( ( ( direction == ZCL_FRAME_CLIENT_SERVER_DIR ) && ( flag & CMD_DIR_SERVER_GENERATED ) ) ||
+               ( ( direction == ZCL_FRAME_SERVER_CLIENT_DIR ) && ( flag & CMD_DIR_CLIENT_GENERATED ) ) )
+          {
+            *pCmd = pRec->pCmdRecs[i];
+            *pCmdID = pCmd->cmdID;
+            return ( TRUE );
+          }
+        }
+        else
+        {
+          return ( FALSE );
+        }
+      }
+    }
+  }
+  return ( FALSE );
+}
+
+//*****************************************************************************
+// Local Functions
+//*****************************************************************************
+
+static double nowNs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return((double)ts.tv_sec * 1e9 + (double)ts.tv_nsec);
+}
+
+static uint16_t benchCluster(int n)
+{
+    return((uint16_t)(BENCH_FIRST_CLUSTER + n));
+}
+
+static int sameAttr(uint8_t f1, zclAttrRec_t *a1, uint8_t f2, zclAttrRec_t *a2)
+{
+    if(f1 != f2)
+    {
+        return(0);
+    }
+    return(!f1 || ((a1->clusterID == a2->clusterID) &&
+                   (a1->attr.attrId == a2->attr.attrId) &&
+                   (a1->attr.accessControl == a2->attr.accessControl) &&
+                   (a1->attr.dataPtr == a2->attr.dataPtr)));
+}
+
+static int sameCmd(uint8_t f1, zclCommandRec_t *c1, uint8_t f2, zclCommandRec_t *c2)
+{
+    if(f1 != f2)
+    {
+        return(0);
+    }
+    return(!f1 || ((c1->clusterID == c2->clusterID) && (c1->cmdID == c2->cmdID) &&
+                   (c1->flag == c2->flag)));
+}
+
+static void shuffle(void *base, int n, size_t size)
+{
+    uint8_t tmp[sizeof(zclAttrRec_t)];
+    uint8_t *p = base;
+    int i, j;
+
+    for(i = n - 1; i > 0; i--)
+    {
+        j = rand() % (i + 1);
+        memcpy(tmp, p + (i * size), size);
+        memcpy(p + (i * size), p + (j * size), size);
+        memcpy(p + (j * size), tmp, size);
+    }
+}
+
+/*
+ * Register the attribute and command lists of every endpoint. IDs are spaced
+ * by BENCH_ATTR_ID_STEP so that lookups of missing IDs fall between records.
+ * A few attributes are client side or global, and commands get every
+ * direction flag, so that discovery has records to skip.
+ */
+static void benchRegister(void)
+{
+    int ep, i, perCluster;
+
+    perCluster = (numAttrs + numClusters - 1) / numClusters;
+    benchNumCmds = numClusters * BENCH_CMDS_PER_CLUSTER;
+    if(benchNumCmds > BENCH_MAX_RECORDS)
+    {
+        benchNumCmds = BENCH_MAX_RECORDS;
+    }
+
+    for(ep = 0; ep < numEndpoints; ep++)
+    {
+        for(i = 0; i < numAttrs; i++)
+        {
+            zclAttrRec_t *pAttr = &benchAttrs[ep][i];
+
+            pAttr->clusterID = benchCluster(i / perCluster);
+            pAttr->attr.attrId = (uint16_t)((i % perCluster) * BENCH_ATTR_ID_STEP);
+            pAttr->attr.dataType = ZCL_DATATYPE_UINT8;
+            pAttr->attr.accessControl = ACCESS_CONTROL_READ;
+            if((i % 7) == 3)
+            {
+                pAttr->attr.accessControl |= ACCESS_CLIENT;
+            }
+            else if((i % 11) == 5)
+            {
+                pAttr->attr.accessControl |= ACCESS_GLOBAL;
+            }
+            pAttr->attr.dataPtr = &benchData;
+        }
+        for(i = 0; i < benchNumCmds; i++)
+        {
+            zclCommandRec_t *pCmd = &benchCmds[ep][i];
+
+            pCmd->clusterID = benchCluster(i / BENCH_CMDS_PER_CLUSTER);
+            pCmd->cmdID = (uint8_t)((i % BENCH_CMDS_PER_CLUSTER) * BENCH_ATTR_ID_STEP);
+            pCmd->flag = (uint8_t)(1 << (i % 4));
+        }
+        if(unsorted)
+        {
+            shuffle(benchAttrs[ep], numAttrs, sizeof(zclAttrRec_t));
+            shuffle(benchCmds[ep], benchNumCmds, sizeof(zclCommandRec_t));
+        }
+
+        zcl_registerAttrList((uint8_t)(BENCH_FIRST_ENDPOINT + ep), (uint8_t)numAttrs,
+                             benchAttrs[ep]);
+        zcl_registerCmdList((uint8_t)(BENCH_FIRST_ENDPOINT + ep), (uint8_t)benchNumCmds,
+                            benchCmds[ep]);
+    }
+}
+
+/*
+ * Check every kind of lookup against the reference, for every cluster of
+ * every endpoint, a cluster that is not registered and an unknown endpoint.
+ */
+static void benchCheck(void)
+{
+    int ep, cl, id, dir, k;
+    static const uint8_t discCmds[] = { ZCL_CMD_DISCOVER_CMDS_RECEIVED,
+                                        ZCL_CMD_DISCOVER_CMDS_GEN };
+
+    for(ep = 0; ep <= numEndpoints; ep++)
+    {
+        uint8_t endpoint = (uint8_t)(BENCH_FIRST_ENDPOINT + ep);
+
+        for(cl = 0; cl <= numClusters; cl++)
+        {
+            uint16_t clusterID = benchCluster(cl);
+
+            for(id = 0; id < 260 * BENCH_ATTR_ID_STEP; id++)
+            {
+                zclAttrRec_t a1, a2;
+                uint8_t f1 = zclFindAttrRec(endpoint, clusterID, (uint16_t)id, &a1);
+                uint8_t f2 = refFindAttrRec(endpoint, clusterID, (uint16_t)id, &a2);
+
+                if(!sameAttr(f1, &a1, f2, &a2))
+                {
+                    printf("zclFindAttrRec ep %u cluster 0x%04X attr 0x%04X differs\n",
+                           endpoint, clusterID, id);
+                    mismatches++;
+                }
+            }
+            for(id = 0; id < 256; id++)
+            {
+                zclCommandRec_t c1, c2;
+                uint8_t f1 = zclFindCmdRec(endpoint, clusterID, (uint8_t)id, &c1);
+                uint8_t f2 = refFindCmdRec(endpoint, clusterID, (uint8_t)id, &c2);
+
+                if(!sameCmd(f1, &c1, f2, &c2))
+                {
+                    printf("zclFindCmdRec ep %u cluster 0x%04X cmd 0x%02X differs\n",
+                           endpoint, clusterID, id);
+                    mismatches++;
+                }
+            }
+
+            for(dir = 0; dir < 2; dir++)
+            {
+                // Discover attributes, starting at every ID
+                for(id = 0; id < 260 * BENCH_ATTR_ID_STEP; id++)
+                {
+                    zclAttrRec_t a1, a2;
+                    uint16_t id1 = (uint16_t)id, id2 = (uint16_t)id;
+                    uint8_t f1 = zclFindNextAttrRec(endpoint, clusterID, (uint8_t)dir, &id1, &a1);
+                    uint8_t f2 = refFindNextAttrRec(endpoint, clusterID, (uint8_t)dir, &id2, &a2);
+
+                    if(!sameAttr(f1, &a1, f2, &a2) || (id1 != id2))
+                    {
+                        printf("zclFindNextAttrRec ep %u cluster 0x%04X dir %d from 0x%04X differs\n",
+                               endpoint, clusterID, dir, id);
+                        mismatches++;
+                    }
+                }
+                // Discover commands, both kinds, starting at every ID
+                for(k = 0; k < 3; k++)
+                {
+                    uint8_t commandID = (k < 2) ? discCmds[k] : ZCL_CMD_READ;
+
+                    for(id = 0; id < 256; id++)
+                    {
+                        zclCommandRec_t c1, c2;
+                        uint8_t id1 = (uint8_t)id, id2 = (uint8_t)id;
+                        uint8_t f1 = zclFindNextCmdRec(endpoint, clusterID, commandID,
+                                                       (uint8_t)dir, &id1, &c1);
+                        uint8_t f2 = refFindNextCmdRec(endpoint, clusterID, commandID,
+                                                       (uint8_t)dir, &id2, &c2);
+
+                        if(!sameCmd(f1, &c1, f2, &c2) || (id1 != id2))
+                        {
+                            printf("zclFindNextCmdRec ep %u cluster 0x%04X 0x%02X dir %d from 0x%02X differs\n",
+                                   endpoint, clusterID, commandID, dir, id);
+                            mismatches++;
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+static void drawQueries(int seed, int numRecs)
+{
+    int i;
+
+    srand(seed);
+    for(i = 0; i < BENCH_QUERIES; i++)
+    {
+        queryEp[i] = (uint16_t)(rand() % numEndpoints);
+        queryRec[i] = (uint16_t)(rand() % numRecs);
+    }
+}
+
+typedef uint8_t (*benchAttrFn_t)(uint8_t, uint16_t, uint16_t, zclAttrRec_t *);
+typedef uint8_t (*benchCmdFn_t)(uint8_t, uint16_t, uint8_t, zclCommandRec_t *);
+typedef uint8_t (*benchNextAttrFn_t)(uint8_t, uint16_t, uint8_t, uint16_t *, zclAttrRec_t *);
+typedef uint8_t (*benchNextCmdFn_t)(uint8_t, uint16_t, uint8_t, uint8_t, uint8_t *,
+                                    zclCommandRec_t *);
+
+// Time numLookups attribute lookups of existing (hit) or missing IDs
+static double timeFindAttr(benchAttrFn_t fn, int hit)
+{
+    zclAttrRec_t attr;
+    double t0;
+    long n;
+
+    drawQueries(2, numAttrs);
+    t0 = nowNs();
+    for(n = 0; n < numLookups; n++)
+    {
+        int ep = queryEp[n % BENCH_QUERIES];
+        zclAttrRec_t *pRec = &benchAttrs[ep][queryRec[n % BENCH_QUERIES]];
+
+        sink += fn((uint8_t)(BENCH_FIRST_ENDPOINT + ep), pRec->clusterID,
+                   (uint16_t)(pRec->attr.attrId + (hit ? 0 : 1)), &attr);
+    }
+    return((nowNs() - t0) / numLookups);
+}
+
+static double timeFindCmd(benchCmdFn_t fn)
+{
+    zclCommandRec_t cmd;
+    double t0;
+    long n;
+
+    drawQueries(3, benchNumCmds);
+    t0 = nowNs();
+    for(n = 0; n < numLookups; n++)
+    {
+        int ep = queryEp[n % BENCH_QUERIES];
+        zclCommandRec_t *pRec = &benchCmds[ep][queryRec[n % BENCH_QUERIES]];
+
+        sink += fn((uint8_t)(BENCH_FIRST_ENDPOINT + ep), pRec->clusterID, pRec->cmdID, &cmd);
+    }
+    return((nowNs() - t0) / numLookups);
+}
+
+// Time the discovery of every attribute of a cluster, per record returned
+static double timeDiscoverAttrs(benchNextAttrFn_t fn)
+{
+    zclAttrRec_t attr;
+    long found = 0;
+    double t0;
+    long n;
+
+    drawQueries(4, numClusters);
+    t0 = nowNs();
+    for(n = 0; n < numLookups / 20; n++)
+    {
+        uint8_t endpoint = (uint8_t)(BENCH_FIRST_ENDPOINT + queryEp[n % BENCH_QUERIES]);
+        uint16_t clusterID = benchCluster(queryRec[n % BENCH_QUERIES]);
+        uint16_t attrId = 0;
+
+        while(fn(endpoint, clusterID, ZCL_FRAME_CLIENT_SERVER_DIR, &attrId, &attr))
+        {
+            found++;
+            attrId++;
+        }
+    }
+    return((nowNs() - t0) / (found ? found : 1));
+}
+
+static double timeDiscoverCmds(benchNextCmdFn_t fn)
+{
+    zclCommandRec_t cmd;
+    long found = 0;
+    double t0;
+    long n;
+
+    drawQueries(5, numClusters);
+    t0 = nowNs();
+    for(n = 0; n < numLookups / 20; n++)
+    {
+        uint8_t endpoint = (uint8_t)(BENCH_FIRST_ENDPOINT + queryEp[n % BENCH_QUERIES]);
+        uint16_t clusterID = benchCluster(queryRec[n % BENCH_QUERIES]);
+        uint8_t cmdID = 0;
+
+        while(fn(endpoint, clusterID, ZCL_CMD_DISCOVER_CMDS_RECEIVED,
+                 ZCL_FRAME_CLIENT_SERVER_DIR, &cmdID, &cmd))
+        {
+            found++;
+            if(cmdID == 0xFF)
+            {
+                break;
+            }
+            cmdID++;
+        }
+    }
+    return((nowNs() - t0) / (found ? found : 1));
+}
+
+static void printRow(const char *name, double refNs, double idxNs)
+{
+    printf("  %-26s %9.1f %9.1f %8.1fx\n", name, refNs, idxNs,
+           (idxNs > 0) ? refNs / idxNs : 0.0);
+}
+
+static void usage(const char *prog)
+{
+    printf("Usage: %s [options]\n"
+           "  -e <n>   endpoints (default %d, max %d)\n"
+           "  -a <n>   attribute records per endpoint (default %d, max %d)\n"
+           "  -c <n>   clusters per endpoint (default %d)\n"
+           "  -n <n>   timed lookups per measurement (default %ld)\n"
+           "  -u       records not sorted by cluster and ID\n"
+           "  -s <n>   random seed of the record order (default 1)\n"
+           "  -h       this help\n",
+           prog, numEndpoints, BENCH_MAX_ENDPOINTS, numAttrs, BENCH_MAX_RECORDS,
+           numClusters, numLookups);
+}
+
+//*****************************************************************************
+// Main
+//*****************************************************************************
+
+int main(int argc, char *argv[])
+{
+    int seed = 1;
+    int opt;
+
+    while((opt = getopt(argc, argv, "e:a:c:n:us:h")) != -1)
+    {
+        switch(opt)
+        {
+            case 'e': numEndpoints = atoi(optarg); break;
+            case 'a': numAttrs = atoi(optarg); break;
+            case 'c': numClusters = atoi(optarg); break;
+            case 'n': numLookups = atol(optarg); break;
+            case 'u': unsorted = 1; break;
+            case 's': seed = atoi(optarg); break;
+            case 'h': usage(argv[0]); return(0);
+            default: usage(argv[0]); return(2);
+        }
+    }
+    if((numEndpoints < 1) || (numEndpoints > BENCH_MAX_ENDPOINTS) ||
+       (numAttrs < 1) || (numAttrs > BENCH_MAX_RECORDS) ||
+       (numClusters < 1) || (numClusters > numAttrs) || (numLookups < 20))
+    {
+        usage(argv[0]);
+        return(2);
+    }
+
+    srand(seed);
+    benchRegister();
+    benchCheck();
+
+    printf("%d endpoints, %d attribute and %d command records each, %d clusters, %s\n",
+           numEndpoints, numAttrs, benchNumCmds, numClusters,
+           unsorted ? "unsorted" : "sorted by cluster and ID");
+    printf("  %-26s %9s %9s %9s\n", "ns per lookup", "linear", "indexed", "speedup");
+    printRow("zclFindAttrRec (hit)", timeFindAttr(refFindAttrRec, 1),
+             timeFindAttr(zclFindAttrRec, 1));
+    printRow("zclFindAttrRec (miss)", timeFindAttr(refFindAttrRec, 0),
+             timeFindAttr(zclFindAttrRec, 0));
+    printRow("zclFindCmdRec", timeFindCmd(refFindCmdRec), timeFindCmd(zclFindCmdRec));
+    printRow("zclFindNextAttrRec", timeDiscoverAttrs(refFindNextAttrRec),
+             timeDiscoverAttrs(zclFindNextAttrRec));
+    printRow("zclFindNextCmdRec", timeDiscoverCmds(refFindNextCmdRec),
+             timeDiscoverCmds(zclFindNextCmdRec));
+    printf("lookups differing from the linear scan: %ld\n", mismatches);
+
+    return((mismatches != 0) ? 1 : 0);
+}
@@ -0,0 +1,901 @@
+/******************************************************************************
+
+ @file  zcl_ota_download_sim.c
+
+ @brief End-to-end simulation of an OTA client image download
+
+ Group: WCS, LPC
+ Target Device: cc13xx_cc26xx
+
+ ******************************************************************************
+ 
+ Copyright (c) 2019-2026, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ 
+ 
+ *****************************************************************************/
+
+/*
+Simulates an OTA client downloading an image end to end and reports the
+download time. zclOTA_ProcessImageData() of zcl_ota.c parses the OTA file and
+stores the image in a simulated external flash. The image is the OTA header,
+then an upgrade image element holding an OAD image with its CRC. The time is
+virtual, in microseconds, and modelled as follows:
+
+- link: 250 kbit/s frames with Z-Stack header overhead and a fixed CSMA and
+  ACK time per hop. All frames share one channel, so the responses to
+  outstanding requests queue behind each other. The server takes a fixed time
+  per Image Block Request. With -p the client is a sleepy end device. Its
+  parent holds a response until the next poll, then delivers everything it
+  holds. With -l a frame is lost with the given probability. The client
+  requests the block again after OTA_MAX_BLOCK_RSP_WAIT_TIME, up to
+  OTA_MAX_BLOCK_RETRIES times.
+- client: keeps a window of up to W Image Block Requests outstanding. Blocks
+  that arrive out of order wait in a reorder buffer. They are passed to
+  zclOTA_ProcessImageData() in file order. Each block costs a fixed CPU time
+  plus the flash time it caused. The client sends no requests while busy.
+- flash: an SPI NOR flash of EFL_FLASH_SIZE with 4 KB erase pages and 256
+  byte program pages. Each program command costs a fixed time plus a time
+  per byte. A writeFlashPg() that crosses a program page needs one command
+  per program page. Erases and reads have their own costs. Programming a
+  byte can only clear bits.
+
+Each window size of -w is one download. After a download, the image in flash
+must match the image sent, and no byte may have been programmed twice. The
+exit status is 1 if a download fails or does not match.
+
+The window is a client application setting. That application is not part of
+this tree. The flash programs depend on the write buffer of zcl_ota.c. To
+compare them with zcl_ota.c before its write buffer, build the simulation
+against each version and run both with the same options:
+
+  git show bef6b94^:software_stacks/zstack/common/zcl/zcl_ota.c > /tmp/zcl_ota_unbuffered.c
+
+  for v in buffered unbuffered; do
+    src=software_stacks/zstack/common/zcl/zcl_ota.c
+    [ $v = unbuffered ] && src=/tmp/zcl_ota_unbuffered.c
+    cc -O2 -DOSAL_PORT2TIRTOS -DOTA_CLIENT_STANDALONE \
+        -Dbuffer_uint32=OsalPort_bufferUint32 \
+        -Isoftware_stacks/zstack/host -I. -Isoftware_stacks \
+        -Isoftware_stacks/ti15_4stack/hal/platform \
+        -Isoftware_stacks/ti15_4stack/mac/services \
+        -Isoftware_stacks/ti15_4stack/mac -Isoftware_stacks/zstack/af \
+        -Isoftware_stacks/zstack/bdb -Isoftware_stacks/zstack/sys \
+        -Isoftware_stacks/zstack/nwk -Isoftware_stacks/zstack/osal_port \
+        -Isoftware_stacks/zstack/common/zcl -Isoftware_stacks/zstack/stack_task \
+        -Isoftware_stacks/zstack/zdo -Isoftware_stacks/zstack/sec \
+        -Isoftware_stacks/zstack/gp -Isoftware_stacks/zstack/zmac -Idrivers/nv \
+        -o zcl_ota_download_sim_$v \
+        software_stacks/zstack/common/zcl/host/zcl_ota_download_sim.c $src \
+        software_stacks/zstack/common/zcl/zcl.c \
+        software_stacks/zstack/host/zstack_host.c \
+        software_stacks/ti15_4stack/mac/services/saddr.c
+  done
+  ./zcl_ota_download_sim_buffered -h
+
+The MMO hash of OTA_MMO_SIGN is not simulated.
+*/
+
+//*****************************************************************************
+// Includes
+//*****************************************************************************
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "zcl.h"
+#include "zcl_ota.h"
+#include "ota_client.h"
+#include "flash_interface.h"
+#include "oad_image_header.h"
+#include "ext_flash_layout.h"
+#include "crc32.h"
+#include "zstack_host.h"
+
+//*****************************************************************************
+// Constants and Definitions
+//*****************************************************************************
+
+#define SIM_IMAGE_SIZE          (200 * 1024)
+#define SIM_MAX_BLOCK           128
+#define SIM_MAX_WINDOW          16
+#define SIM_MAX_RUNS            8
+
+// OTA file header and upgrade image element header
+#define SIM_OTA_HDR_LEN         56
+#define SIM_ELEM_HDR_LEN        6
+#define SIM_FILE_VERSION        0x00000002
+
+// Link: 250 kbit/s, PHY, MAC, NWK, APS and ZCL header bytes per frame,
+// CSMA backoff, turnaround and ACK per hop
+#define SIM_AIR_BYTE_US         32
+#define SIM_FRAME_OVERHEAD      36
+#define SIM_HOP_US              2000
+
+// ZCL payload of an Image Block Request and of a response without data
+#define SIM_REQ_PAYLOAD         14
+#define SIM_RSP_PAYLOAD         14
+
+// Client CPU time per received block, beside the flash time
+#define SIM_CLIENT_US           500
+
+// SPI NOR flash timing
+#define SIM_PROG_PAGE_SIZE      256
+#define SIM_PROG_CMD_NS         40000
+#define SIM_PROG_BYTE_NS        3200
+#define SIM_ERASE_NS            40000000
+#define SIM_READ_BYTE_NS        2000
+
+// Block states of the client window
+#define SIM_BLOCK_FREE          0
+#define SIM_BLOCK_REQUESTED     1
+#define SIM_BLOCK_RECEIVED      2
+
+// Events
+#define SIM_EV_REQ              0   // Request arrives at the server
+#define SIM_EV_RSP              1   // Response arrives at the client
+#define SIM_EV_TIMEOUT          2   // Response wait time of a request expired
+
+#define SIM_MAX_EVENTS          (SIM_MAX_WINDOW * 8)
+
+//*****************************************************************************
+// Typedefs
+//*****************************************************************************
+
+// Flash counters
+typedef struct
+{
+    uint32_t writes;        // writeFlashPg() calls
+    uint32_t programs;      // Program commands, one per program page written
+    uint32_t progBytes;
+    uint32_t erases;
+    uint32_t readBytes;
+    uint32_t overwrites;    // Bytes programmed that were not erased
+    uint64_t busyNs;
+} simFlashStats_t;
+
+// A block of the client window
+typedef struct
+{
+    uint8_t  state;
+    uint8_t  retries;
+    uint16_t seq;           // Sequence of the latest request
+    uint32_t block;
+    uint8_t  len;
+    uint8_t  data[SIM_MAX_BLOCK];
+} simBlock_t;
+
+typedef struct
+{
+    uint64_t time;
+    uint8_t  type;
+    uint16_t seq;
+    uint32_t block;
+} simEvent_t;
+
+//*****************************************************************************
+// Locals
+//*****************************************************************************
+
+// Options
+static uint32_t imageSize = SIM_IMAGE_SIZE;
+static uint8_t  blockSize = OTA_MAX_MTU;
+static uint8_t  windows[SIM_MAX_RUNS] = { 1, 2, 4, 8 };
+static uint8_t  numWindows = 4;
+static uint32_t serverUs = 20000;
+static uint8_t  hops = 1;
+static uint32_t pollUs = 0;
+static uint32_t lossPermille = 0;
+static uint32_t simSeed = 1;
+
+// OTA file as the server holds it
+static uint8_t *otaFile;
+static uint32_t otaFileLen;
+static uint8_t *oadImage;
+
+// Simulated external flash
+static uint8_t simFlash[EFL_FLASH_SIZE];
+static simFlashStats_t flashStats;
+static bool flashOpen;
+
+// OTA attributes and client state shared with zcl_ota.c
+uint8_t  zclOTA_ClientPdState;
+uint32_t zclOTA_DownloadedImageSize;
+static uint32_t otaFileOffset;
+static uint16_t otaStackVersion;
+static uint8_t  otaUpgradeStatus;
+
+static zclAttrRec_t otaAttrs[] =
+{
+    { ZCL_CLUSTER_ID_OTA, { ATTRID_OTA_UPGRADE_FILE_OFFSET, ZCL_DATATYPE_UINT32,
+                            ACCESS_CONTROL_READ, &otaFileOffset } },
+    { ZCL_CLUSTER_ID_OTA, { ATTRID_OTA_UPGRADE_DOWNLOADED_ZIG_BEE_STACK_VERSION,
+                            ZCL_DATATYPE_UINT16, ACCESS_CONTROL_READ, &otaStackVersion } },
+    { ZCL_CLUSTER_ID_OTA, { ATTRID_OTA_UPGRADE_IMAGE_UPGRADE_STATUS, ZCL_DATATYPE_ENUM8,
+                            ACCESS_CONTROL_READ, &otaUpgradeStatus } },
+};
+
+// Link, server and client of the running download
+static simEvent_t events[SIM_MAX_EVENTS];
+static uint16_t numEvents;
+static uint64_t chanFree;
+static uint64_t serverFree;
+static uint64_t clientBusy;
+static simBlock_t window[SIM_MAX_WINDOW];
+static uint8_t  windowSize;
+static uint32_t numBlocks;
+static uint32_t nextToProcess;
+static uint32_t nextToRequest;
+static uint32_t requests;
+static uint32_t resends;
+static uint64_t doneTime;
+static bool     done;
+static bool     failed;
+
+static uint32_t failures;
+
+//*****************************************************************************
+// Flash interface of zcl_ota.c
+//*****************************************************************************
+
+bool flash_open(void)
+{
+    flashOpen = true;
+    return(true);
+}
+
+void flash_close(void)
+{
+    flashOpen = false;
+}
+
+uint8_t readFlash(uint32_t addr, uint8_t *pBuf, size_t len)
+{
+    if(addr + len > sizeof(simFlash))
+    {
+        return(FLASH_FAILURE);
+    }
+    memcpy(pBuf, &simFlash[addr], len);
+    flashStats.readBytes += len;
+    flashStats.busyNs += (uint64_t)len * SIM_READ_BYTE_NS;
+    return(FLASH_SUCCESS);
+}
+
+uint8_t readFlashPg(uint8_t page, uint32_t offset, uint8_t *pBuf, uint16_t len)
+{
+    return(readFlash(EXT_FLASH_ADDRESS((uint32_t)page, offset), pBuf, len));
+}
+
+uint8_t writeFlashPg(uint8_t page, uint32_t offset, uint8_t *pBuf, uint16_t len)
+{
+    uint32_t addr = EXT_FLASH_ADDRESS((uint32_t)page, offset);
+    uint32_t i;
+
+    if(!flashOpen || (addr + len > sizeof(simFlash)))
+    {
+        return(FLASH_FAILURE);
+    }
+
+    flashStats.writes++;
+    for(i = 0; i < len; i++)
+    {
+        // A new program command at every program page
+        if((i == 0) || (((addr + i) & (SIM_PROG_PAGE_SIZE - 1)) == 0))
+        {
+            flashStats.programs++;
+            flashStats.busyNs += SIM_PROG_CMD_NS;
+        }
+        if(simFlash[addr + i] != 0xFF)
+        {
+            flashStats.overwrites++;
+        }
+        simFlash[addr + i] &= pBuf[i];
+    }
+    flashStats.progBytes += len;
+    flashStats.busyNs += (uint64_t)len * SIM_PROG_BYTE_NS;
+    return(FLASH_SUCCESS);
+}
+
+uint8_t eraseFlashPg(uint8_t page)
+{
+    uint32_t addr = EXT_FLASH_ADDRESS((uint32_t)page, 0);
+
+    if(!flashOpen || (addr + EFL_PAGE_SIZE > sizeof(simFlash)))
+    {
+        return(FLASH_FAILURE);
+    }
+    memset(&simFlash[addr], 0xFF, EFL_PAGE_SIZE);
+    flashStats.erases++;
+    flashStats.busyNs += SIM_ERASE_NS;
+    return(FLASH_SUCCESS);
+}
+
+//*****************************************************************************
+// Image CRC
+//*****************************************************************************
+
+static uint32_t simCrc32(uint32_t crc, const uint8_t *pData, uint32_t len)
+{
+    uint8_t bit;
+
+    while(len--)
+    {
+        crc ^= *pData++;
+        for(bit = 0; bit < 8; bit++)
+        {
+            crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+        }
+    }
+    return(crc);
+}
+
+uint32_t CRC32_calc(uint8_t page, uint32_t pageSize, uint16_t offset,
+                    uint32_t len, bool useExtFl)
+{
+    uint8_t buf[256];
+    uint32_t addr = (uint32_t)page * pageSize + offset + OAD_IMG_CRC_START;
+    uint32_t end = (uint32_t)page * pageSize + offset + len;
+    uint32_t crc = 0xFFFFFFFF;
+    uint32_t n;
+
+    (void)useExtFl;
+    while(addr < end)
+    {
+        n = end - addr;
+        if(n > sizeof(buf))
+        {
+            n = sizeof(buf);
+        }
+        if(readFlash(addr, buf, n) != FLASH_SUCCESS)
+        {
+            return(0);
+        }
+        crc = simCrc32(crc, buf, n);
+        addr += n;
+    }
+    return(crc ^ 0xFFFFFFFF);
+}
+
+//*****************************************************************************
+// Local Functions
+//*****************************************************************************
+
+/**
+ * @fn      simRand
+ *
+ * @brief   xorshift32 pseudo random number, reproducible per seed
+ *
+ * @param   none
+ *
+ * @return  random number
+ */
+static uint32_t simRand(void)
+{
+    simSeed ^= simSeed << 13;
+    simSeed ^= simSeed >> 17;
+    simSeed ^= simSeed << 5;
+    return(simSeed);
+}
+
+static uint8_t *simPut16(uint8_t *p, uint16_t val)
+{
+    *p++ = LO_UINT16(val);
+    *p++ = HI_UINT16(val);
+    return(p);
+}
+
+static uint8_t *simPut32(uint8_t *p, uint32_t val)
+{
+    p = simPut16(p, (uint16_t)val);
+    return(simPut16(p, (uint16_t)(val >> 16)));
+}
+
+/**
+ * @fn      simBuildFile
+ *
+ * @brief   Build the OTA file: OTA header, upgrade image element and an OAD
+ *          image of imageSize bytes with its header and CRC
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+static void simBuildFile(void)
+{
+    static const uint8_t imgId[] = OAD_IMG_ID_VAL;
+    imgHdr_t *pHdr;
+    uint8_t *p;
+    uint32_t i;
+
+    otaFileLen = SIM_OTA_HDR_LEN + SIM_ELEM_HDR_LEN + imageSize;
+    otaFile = malloc(otaFileLen);
+    memset(otaFile, 0, otaFileLen);
+
+    p = simPut32(otaFile, OTA_HDR_MAGIC_NUMBER);
+    p = simPut16(p, OTA_HDR_VERSION);
+    p = simPut16(p, SIM_OTA_HDR_LEN);
+    p = simPut16(p, 0);
+    p = simPut16(p, OTA_MANUFACTURER_ID);
+    p = simPut16(p, OTA_TYPE_ID);
+    p = simPut32(p, SIM_FILE_VERSION);
+    p = simPut16(p, OTA_HDR_STACK_VERSION);
+    memcpy(p, "zcl_ota_download_sim", 20);
+    p += 32;
+    p = simPut32(p, otaFileLen);
+    p = simPut16(p, OTA_UPGRADE_IMAGE_TAG_ID);
+    p = simPut32(p, imageSize);
+
+    oadImage = p;
+    for(i = sizeof(imgHdr_t); i < imageSize; i++)
+    {
+        oadImage[i] = (uint8_t)simRand();
+    }
+    pHdr = (imgHdr_t *)oadImage;
+    memset(pHdr, 0xFF, sizeof(imgHdr_t));
+    memcpy(pHdr->fixedHdr.imgID, imgId, sizeof(imgId));
+    pHdr->fixedHdr.bimVer = BIM_VER;
+    pHdr->fixedHdr.metaVer = 1;
+    pHdr->fixedHdr.techType = OAD_WIRELESS_TECH_ZIGBEE;
+    pHdr->fixedHdr.imgType = OAD_IMG_TYPE_APPSTACKLIB;
+    pHdr->fixedHdr.imgNo = 0;
+    pHdr->fixedHdr.len = imageSize;
+    pHdr->fixedHdr.hdrLen = sizeof(imgHdr_t);
+    pHdr->fixedHdr.crc32 = simCrc32(0xFFFFFFFF, &oadImage[OAD_IMG_CRC_START],
+                                    imageSize - OAD_IMG_CRC_START) ^ 0xFFFFFFFF;
+}
+
+/**
+ * @fn      simResetFlash
+ *
+ * @brief   Erase the flash and store the metadata of a factory new image,
+ *          which the client requires, at the first page
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+static void simResetFlash(void)
+{
+    static const uint8_t extFlId[] = OAD_EXTFL_ID_VAL;
+    ExtImageInfo_t factoryNew;
+
+    memset(simFlash, 0xFF, sizeof(simFlash));
+    memset(&factoryNew, 0xFF, sizeof(factoryNew));
+    memcpy(factoryNew.fixedHdr.imgID, extFlId, sizeof(extFlId));
+    factoryNew.fixedHdr.len = imageSize;
+    memcpy(&simFlash[EFL_ADDR_META_FACT_IMG], &factoryNew, sizeof(factoryNew));
+    memset(&flashStats, 0, sizeof(flashStats));
+}
+
+static void simAddEvent(uint64_t time, uint8_t type, uint32_t block, uint16_t seq)
+{
+    if(numEvents == SIM_MAX_EVENTS)
+    {
+        printf("event queue full\n");
+        exit(1);
+    }
+    events[numEvents].time = time;
+    events[numEvents].type = type;
+    events[numEvents].block = block;
+    events[numEvents].seq = seq;
+    numEvents++;
+}
+
+/**
+ * @fn      simNextEvent
+ *
+ * @brief   Remove the earliest event, first added first at equal times
+ *
+ * @param   pEvent - the event is copied here
+ *
+ * @return  false if there is none
+ */
+static bool simNextEvent(simEvent_t *pEvent)
+{
+    uint16_t first = 0;
+    uint16_t i;
+
+    if(numEvents == 0)
+    {
+        return(false);
+    }
+    for(i = 1; i < numEvents; i++)
+    {
+        if(events[i].time < events[first].time)
+        {
+            first = i;
+        }
+    }
+    *pEvent = events[first];
+    memmove(&events[first], &events[first + 1], (numEvents - first - 1) * sizeof(simEvent_t));
+    numEvents--;
+    return(true);
+}
+
+static void simCancelTimeout(uint32_t block)
+{
+    uint16_t i;
+
+    for(i = 0; i < numEvents; i++)
+    {
+        if((events[i].type == SIM_EV_TIMEOUT) && (events[i].block == block))
+        {
+            memmove(&events[i], &events[i + 1], (numEvents - i - 1) * sizeof(simEvent_t));
+            numEvents--;
+            return;
+        }
+    }
+}
+
+/**
+ * @fn      simSendFrame
+ *
+ * @brief   Send a frame over the shared channel
+ *
+ * @param   time    - when the frame is ready
+ * @param   payload - ZCL payload length
+ * @param   pArrive - arrival time
+ *
+ * @return  false if the frame is lost
+ */
+static bool simSendFrame(uint64_t time, uint16_t payload, uint64_t *pArrive)
+{
+    uint64_t start = (time > chanFree) ? time : chanFree;
+
+    chanFree = start + (uint64_t)hops * ((SIM_FRAME_OVERHEAD + payload) * SIM_AIR_BYTE_US + SIM_HOP_US);
+    *pArrive = chanFree;
+    return((simRand() % 1000) >= lossPermille);
+}
+
+static void simRequest(uint64_t time, uint32_t block)
+{
+    simBlock_t *pBlock = &window[block % SIM_MAX_WINDOW];
+    uint64_t arrive;
+
+    if(pBlock->state == SIM_BLOCK_FREE)
+    {
+        pBlock->retries = 0;
+    }
+    pBlock->state = SIM_BLOCK_REQUESTED;
+    pBlock->block = block;
+    pBlock->seq++;
+    requests++;
+    if(simSendFrame(time, SIM_REQ_PAYLOAD, &arrive))
+    {
+        simAddEvent(arrive, SIM_EV_REQ, block, pBlock->seq);
+    }
+    simAddEvent(time + OTA_MAX_BLOCK_RSP_WAIT_TIME * 1000ull, SIM_EV_TIMEOUT, block, pBlock->seq);
+}
+
+/**
+ * @fn      simServerRequest
+ *
+ * @brief   Answer an Image Block Request at the server
+ *
+ * @param   time  - arrival time of the request
+ * @param   block - requested block
+ *
+ * @return  none
+ */
+static void simServerRequest(uint64_t time, uint32_t block)
+{
+    uint32_t offset = block * blockSize;
+    uint32_t len = otaFileLen - offset;
+    uint64_t arrive;
+
+    if(len > blockSize)
+    {
+        len = blockSize;
+    }
+    serverFree = ((time > serverFree) ? time : serverFree) + serverUs;
+    if(!simSendFrame(serverFree, (uint16_t)(SIM_RSP_PAYLOAD + len), &arrive))
+    {
+        return;
+    }
+    if(pollUs != 0)
+    {
+        // Held by the parent until the next poll of the client
+        arrive = (arrive + pollUs - 1) / pollUs * pollUs + SIM_HOP_US;
+    }
+    simAddEvent(arrive, SIM_EV_RSP, block, 0);
+}
+
+/**
+ * @fn      simClientRun
+ *
+ * @brief   Pass the blocks received in order to zclOTA_ProcessImageData(),
+ *          then fill the window with requests
+ *
+ * @param   time - current time
+ *
+ * @return  none
+ */
+static void simClientRun(uint64_t time)
+{
+    simBlock_t *pBlock;
+    uint64_t flashNs;
+    uint8_t status;
+
+    if(clientBusy < time)
+    {
+        clientBusy = time;
+    }
+
+    pBlock = &window[nextToProcess % SIM_MAX_WINDOW];
+    while(!done && (pBlock->state == SIM_BLOCK_RECEIVED) && (pBlock->block == nextToProcess))
+    {
+        flashNs = flashStats.busyNs;
+        status = zclOTA_ProcessImageData(pBlock->data, pBlock->len);
+        clientBusy += SIM_CLIENT_US + (flashStats.busyNs - flashNs) / 1000;
+        pBlock->state = SIM_BLOCK_FREE;
+        nextToProcess++;
+
+        if(status != ZSuccess)
+        {
+            printf("block %u: zclOTA_ProcessImageData() status 0x%02X\n", nextToProcess - 1, status);
+            failed = true;
+            return;
+        }
+        if(otaUpgradeStatus == OTA_STATUS_COMPLETE)
+        {
+            done = true;
+            doneTime = clientBusy;
+            return;
+        }
+        pBlock = &window[nextToProcess % SIM_MAX_WINDOW];
+    }
+
+    while((nextToRequest < numBlocks) && (nextToRequest < nextToProcess + windowSize))
+    {
+        simRequest(clientBusy, nextToRequest++);
+    }
+}
+
+/**
+ * @fn      simClientResponse
+ *
+ * @brief   Receive an Image Block Response at the client
+ *
+ * @param   time  - arrival time of the response
+ * @param   block - block in the response
+ *
+ * @return  none
+ */
+static void simClientResponse(uint64_t time, uint32_t block)
+{
+    simBlock_t *pBlock = &window[block % SIM_MAX_WINDOW];
+    uint32_t offset = block * blockSize;
+
+    // Duplicates of blocks already received are dropped
+    if((pBlock->state != SIM_BLOCK_REQUESTED) || (pBlock->block != block))
+    {
+        return;
+    }
+    pBlock->len = (uint8_t)(((otaFileLen - offset) > blockSize) ? blockSize : (otaFileLen - offset));
+    memcpy(pBlock->data, &otaFile[offset], pBlock->len);
+    pBlock->state = SIM_BLOCK_RECEIVED;
+    simCancelTimeout(block);
+    simClientRun(time);
+}
+
+static void simClientTimeout(uint64_t time, uint32_t block, uint16_t seq)
+{
+    simBlock_t *pBlock = &window[block % SIM_MAX_WINDOW];
+
+    if((pBlock->state != SIM_BLOCK_REQUESTED) || (pBlock->block != block) || (pBlock->seq != seq))
+    {
+        return;
+    }
+    if(++pBlock->retries > OTA_MAX_BLOCK_RETRIES)
+    {
+        printf("block %u: no response after %u retries\n", block, OTA_MAX_BLOCK_RETRIES);
+        failed = true;
+        return;
+    }
+    resends++;
+    simRequest((time > clientBusy) ? time : clientBusy, block);
+}
+
+/**
+ * @fn      simVerify
+ *
+ * @brief   Check the downloaded image in flash
+ *
+ * @param   none
+ *
+ * @return  false if it does not match the image sent
+ */
+static bool simVerify(void)
+{
+    ExtImageInfo_t info;
+
+    memcpy(&info, &simFlash[EFL_ADDR_META + EFL_PAGE_SIZE], sizeof(info));
+    if((info.extFlAddr + imageSize > sizeof(simFlash)) ||
+       (memcmp(&simFlash[info.extFlAddr], oadImage, imageSize) != 0))
+    {
+        printf("image in flash differs from the image sent\n");
+        return(false);
+    }
+    if(flashStats.overwrites != 0)
+    {
+        printf("%u bytes programmed without an erase\n", flashStats.overwrites);
+        return(false);
+    }
+    return(true);
+}
+
+/**
+ * @fn      simDownload
+ *
+ * @brief   Download the image with a window of outstanding requests and
+ *          print its line
+ *
+ * @param   w - window size
+ *
+ * @return  none
+ */
+static void simDownload(uint8_t w)
+{
+    simEvent_t ev;
+    uint32_t seed = simSeed;
+
+    simResetFlash();
+    memset(window, 0, sizeof(window));
+    numEvents = 0;
+    chanFree = serverFree = clientBusy = 0;
+    windowSize = w;
+    numBlocks = (otaFileLen + blockSize - 1) / blockSize;
+    nextToProcess = nextToRequest = 0;
+    requests = resends = 0;
+    done = failed = false;
+
+    // As the client does on the Query Next Image Response
+    zclOTA_ClientPdState = ZCL_OTA_PD_MAGIC_0_STATE;
+    zclOTA_DownloadedImageSize = otaFileLen;
+    otaFileOffset = 0;
+    otaUpgradeStatus = OTA_STATUS_IN_PROGRESS;
+
+    simClientRun(0);
+    while(!done && !failed && simNextEvent(&ev))
+    {
+        switch(ev.type)
+        {
+            case SIM_EV_REQ:     simServerRequest(ev.time, ev.block); break;
+            case SIM_EV_RSP:     simClientResponse(ev.time, ev.block); break;
+            case SIM_EV_TIMEOUT: simClientTimeout(ev.time, ev.block, ev.seq); break;
+        }
+    }
+    simSeed = seed;
+
+    if(!done || failed || !simVerify())
+    {
+        printf("%6u  download failed\n", w);
+        failures++;
+        return;
+    }
+
+    printf("%6u %9u %8u %8.1f %8.2f %8u %8u %8.2f\n", w, requests, resends,
+           doneTime / 1e6, (imageSize / 1024.0) / (doneTime / 60e6),
+           flashStats.writes, flashStats.programs, flashStats.busyNs / 1e9);
+}
+
+static void simParseWindows(char *arg)
+{
+    char *tok;
+
+    numWindows = 0;
+    for(tok = strtok(arg, ","); (tok != NULL) && (numWindows < SIM_MAX_RUNS); tok = strtok(NULL, ","))
+    {
+        windows[numWindows++] = (uint8_t)strtoul(tok, NULL, 0);
+    }
+}
+
+static void simUsage(const char *prog)
+{
+    printf("Usage: %s [options]\n"
+           "  -s <bytes>  OAD image size, default %u\n"
+           "  -b <bytes>  block data size, default OTA_MAX_MTU %u, at most %u\n"
+           "  -w <list>   comma separated window sizes, default 1,2,4,8, at most %u\n"
+           "  -d <ms>     server time per request, default 20\n"
+           "  -H <hops>   hops between server and client, default 1\n"
+           "  -p <ms>     poll period of a sleepy client, default 0, not sleepy\n"
+           "  -l <1/1000> frame loss, default 0\n"
+           "  -r <seed>   random seed, default 1\n"
+           "  -h          this help\n",
+           prog, SIM_IMAGE_SIZE, OTA_MAX_MTU, SIM_MAX_BLOCK, SIM_MAX_WINDOW);
+}
+
+//*****************************************************************************
+// Main
+//*****************************************************************************
+
+int main(int argc, char *argv[])
+{
+    uint8_t i;
+    int opt;
+
+    while((opt = getopt(argc, argv, "s:b:w:d:H:p:l:r:h")) != -1)
+    {
+        switch(opt)
+        {
+            case 's': imageSize = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'b': blockSize = (uint8_t)strtoul(optarg, NULL, 0); break;
+            case 'w': simParseWindows(optarg); break;
+            case 'd': serverUs = (uint32_t)strtoul(optarg, NULL, 0) * 1000; break;
+            case 'H': hops = (uint8_t)strtoul(optarg, NULL, 0); break;
+            case 'p': pollUs = (uint32_t)strtoul(optarg, NULL, 0) * 1000; break;
+            case 'l': lossPermille = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'r': simSeed = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'h': simUsage(argv[0]); return(0);
+            default:  simUsage(argv[0]); return(2);
+        }
+    }
+    // Factory new and downloaded image below the last page, each with a spare page
+    if((imageSize < sizeof(imgHdr_t)) ||
+       (2 * (EXT_FLASH_PAGE(imageSize) + 1) + 2 > EFL_FLASH_SIZE / EFL_PAGE_SIZE))
+    {
+        fprintf(stderr, "image size out of range\n");
+        return(2);
+    }
+    if((blockSize == 0) || (blockSize > SIM_MAX_BLOCK) || (hops == 0) ||
+       (lossPermille >= 1000) || (simSeed == 0) || (numWindows == 0))
+    {
+        simUsage(argv[0]);
+        return(2);
+    }
+    for(i = 0; i < numWindows; i++)
+    {
+        if((windows[i] == 0) || (windows[i] > SIM_MAX_WINDOW))
+        {
+            simUsage(argv[0]);
+            return(2);
+        }
+    }
+
+    zclOTA_setAttributes(otaAttrs, sizeof(otaAttrs) / sizeof(otaAttrs[0]));
+    simBuildFile();
+
+    printf("OTA download: %u byte image, %u byte file in %u byte blocks, %u hop(s), "
+           "server %u ms, poll %u ms, loss %u/1000\n\n",
+           imageSize, otaFileLen, blockSize, hops, serverUs / 1000, pollUs / 1000,
+           lossPermille);
+    printf("window  requests  resends   time s   KB/min   writes programs  flash s\n");
+    for(i = 0; i < numWindows; i++)
+    {
+        simDownload(windows[i]);
+    }
+    free(otaFile);
+
+    return((failures != 0) ? 1 : 0);
+}
@@ -0,0 +1,669 @@
+/******************************************************************************
+
+ @file  zcl_ota_server_bench.c
+
+ @brief Benchmark of the OTA server block cache with concurrent clients
+
+ Group: WCS, LPC
+ Target Device: cc13xx_cc26xx
+
+ ******************************************************************************
+ 
+ Copyright (c) 2019-2026, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ 
+ 
+ *****************************************************************************/
+
+/*
+Simulates N OTA clients downloading images from one server at the same time
+and compares two ways of answering their Image Block Requests:
+
+- none: every request reads its block from the image store, then answers
+  with zclOTA_SendImageBlockRsp(), as servers did before the block cache
+- cache: zclOTA_ServerSendImageBlock() answers from the block cache of
+  zcl_ota.c, which reads whole OTA_CACHE_PAGE_SIZE pages, shares them between
+  clients and reads ahead of active sessions
+
+Time is virtual, in microseconds. A client sends its next request a random
+0.5 to 1.5 times -i after the response to its previous one, as sleepy end
+devices polling their parent do. Clients start at random times within -t.
+The server answers the requests one at a time, in arrival order. Each one
+costs a fixed CPU time plus the time of the store reads it makes. A store
+read costs -S plus -B per byte, by default a store on the host of a network
+processor, read over a 115200 baud UART. Response latency runs from the
+arrival of a request to the response being sent. Time spent reading ahead
+after the response delays only the requests that come later.
+
+Per client count and mode, the benchmark reports requests, store reads and
+bytes, cache hits and read-ahead pages, the mean, 99th percentile and
+maximum response latency, and the time until the last client is done.
+It also checks:
+
+- every client receives every byte of its image, with offsets in order
+- cache: hits and misses add up to the requests
+- cache, while the clients fit in the OTA_CACHE_NUM_SESSIONS sessions: each
+  session holds the image size, the offset and the blocks of its client,
+  and is gone after zclOTA_ServerEndSession()
+- no memory is left allocated
+
+The exit status is 1 if a check fails. Half of the clients are addressed by
+extended address. The low bytes of each of those addresses equal the short
+address of another client.
+
+zcl_ota.c is included by this file, for the cache configuration. To try
+other cache sizes, build with e.g. -DOTA_CACHE_NUM_PAGES=64
+-DOTA_CACHE_NUM_SESSIONS=32. Build and run from the repository root:
+
+  cc -O2 -DOSAL_PORT2TIRTOS -DOTA_SERVER -DOTA_SERVER_BLOCK_CACHE \
+      -Isoftware_stacks/zstack/host -I. -Isoftware_stacks \
+      -Isoftware_stacks/ti15_4stack/hal/platform \
+      -Isoftware_stacks/ti15_4stack/mac/services \
+      -Isoftware_stacks/ti15_4stack/mac -Isoftware_stacks/zstack/af \
+      -Isoftware_stacks/zstack/bdb -Isoftware_stacks/zstack/sys \
+      -Isoftware_stacks/zstack/nwk -Isoftware_stacks/zstack/osal_port \
+      -Isoftware_stacks/zstack/common/zcl -Isoftware_stacks/zstack/stack_task \
+      -Isoftware_stacks/zstack/zdo -Isoftware_stacks/zstack/sec \
+      -Isoftware_stacks/zstack/gp -Isoftware_stacks/zstack/zmac -Idrivers/nv \
+      -o zcl_ota_server_bench \
+      software_stacks/zstack/common/zcl/host/zcl_ota_server_bench.c \
+      software_stacks/zstack/common/zcl/zcl.c \
+      software_stacks/zstack/host/zstack_host.c \
+      software_stacks/ti15_4stack/mac/services/saddr.c
+  ./zcl_ota_server_bench -h
+*/
+
+//*****************************************************************************
+// Includes
+//*****************************************************************************
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <zstack/common/zcl/zcl_ota.c>
+#include "zstack_host.h"
+
+//*****************************************************************************
+// Constants and Definitions
+//*****************************************************************************
+
+#define BENCH_FILE_SIZE         (200 * 1024)
+#define BENCH_MAX_CLIENTS       64
+#define BENCH_MAX_FILES         4
+#define BENCH_MAX_RUNS          8
+
+#define BENCH_SRC_EP            20
+#define BENCH_DST_EP            20
+
+// OTA header bytes up to the total image size
+#define BENCH_OTA_HDR_LEN       56
+
+// Server CPU time per request, beside the store reads
+#define BENCH_SERVER_US         300
+
+// ZCL header of the Image Block Response, frame control, sequence, command
+#define BENCH_ZCL_HDR_LEN       3
+
+//*****************************************************************************
+// Typedefs
+//*****************************************************************************
+
+typedef struct
+{
+    afAddrType_t addr;
+    uint8_t  file;
+    uint32_t offset;        // Next offset to request
+    uint32_t blocks;        // Responses received
+    uint64_t nextReq;       // Time of the next request
+    uint64_t doneTime;
+    bool     done;
+    uint8_t *data;          // Image as received
+} benchClient_t;
+
+//*****************************************************************************
+// Locals
+//*****************************************************************************
+
+// Options
+static uint32_t fileSize = BENCH_FILE_SIZE;
+static uint8_t  blockSize = OTA_MAX_MTU;
+static uint8_t  clientCounts[BENCH_MAX_RUNS] = { 1, 8, 30 };
+static uint8_t  numCounts = 3;
+static uint8_t  numFiles = 1;
+static uint32_t intervalUs = 250000;
+static uint32_t spreadUs = 1000000;
+static uint32_t readUs = 5000;
+static uint32_t readByteNs = 87000;
+static uint32_t benchSeed = 1;
+
+static SimpleDescriptionFormat_t srcDesc = { BENCH_SRC_EP, ZCL_HA_PROFILE_ID };
+static endPointDesc_t srcEp = { BENCH_SRC_EP, 0, NULL, &srcDesc, noLatencyReqs };
+
+// Image store
+static uint8_t *files[BENCH_MAX_FILES];
+static uint32_t storeReads;
+static uint64_t storeBytes;
+static uint64_t storeNs;
+
+static benchClient_t clients[BENCH_MAX_CLIENTS];
+static uint8_t numClients;
+
+// Request being answered
+static benchClient_t *pCurClient;
+static uint32_t curReqOffset;
+static uint64_t storeNsAtSend;
+static bool sent;
+
+static uint32_t *latencies;
+static uint32_t numLatencies;
+static uint32_t maxLatencies;
+
+static uint32_t failures;
+
+//*****************************************************************************
+// Local Functions
+//*****************************************************************************
+
+/**
+ * @fn      benchRand
+ *
+ * @brief   xorshift32 pseudo random number, reproducible per seed
+ *
+ * @param   none
+ *
+ * @return  random number
+ */
+static uint32_t benchRand(void)
+{
+    benchSeed ^= benchSeed << 13;
+    benchSeed ^= benchSeed >> 17;
+    benchSeed ^= benchSeed << 5;
+    return(benchSeed);
+}
+
+static void benchCheck(bool ok, const char *what)
+{
+    if(!ok)
+    {
+        printf("FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+static void benchFileId(uint8_t file, zclOTA_FileID_t *pFileId)
+{
+    pFileId->manufacturer = OTA_MANUFACTURER_ID;
+    pFileId->type = OTA_TYPE_ID;
+    pFileId->version = 1 + file;
+}
+
+/**
+ * @fn      benchBuildFiles
+ *
+ * @brief   Build the OTA files of the store, random data behind an OTA
+ *          header that holds the total image size
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+static void benchBuildFiles(void)
+{
+    uint32_t i;
+    uint8_t f;
+
+    for(f = 0; f < numFiles; f++)
+    {
+        files[f] = malloc(fileSize);
+        for(i = 0; i < fileSize; i++)
+        {
+            files[f][i] = (uint8_t)benchRand();
+        }
+        OsalPort_bufferUint32(&files[f][ZCL_OTA_IMG_SIZE_OFFSET], fileSize);
+    }
+}
+
+/**
+ * @fn      benchStoreRead
+ *
+ * @brief   Image store read function, counts the reads and their time
+ *
+ * @param   pFileId - image
+ * @param   offset  - file offset
+ * @param   len     - bytes to read
+ * @param   pBuf    - data is copied here
+ *
+ * @return  bytes read, less than len at the end of the image, 0 on failure
+ */
+static uint16_t benchStoreRead(zclOTA_FileID_t *pFileId, uint32_t offset,
+                               uint16_t len, uint8_t *pBuf)
+{
+    uint32_t file = pFileId->version - 1;
+
+    if((file >= numFiles) || (offset >= fileSize))
+    {
+        return(0);
+    }
+    if(len > fileSize - offset)
+    {
+        len = (uint16_t)(fileSize - offset);
+    }
+    memcpy(pBuf, &files[file][offset], len);
+    storeReads++;
+    storeBytes += len;
+    storeNs += (uint64_t)readUs * 1000 + (uint64_t)len * readByteNs;
+    return(len);
+}
+
+static bool benchSameAddr(afAddrType_t *pAddr1, afAddrType_t *pAddr2)
+{
+    if(pAddr1->addrMode != pAddr2->addrMode)
+    {
+        return(false);
+    }
+    if(pAddr1->addrMode == afAddr64Bit)
+    {
+        return(memcmp(pAddr1->addr.extAddr, pAddr2->addr.extAddr, Z_EXTADDR_LEN) == 0);
+    }
+    return(pAddr1->addr.shortAddr == pAddr2->addr.shortAddr);
+}
+
+/**
+ * @fn      benchAfDataCb
+ *
+ * @brief   Receive the Image Block Response at the client it is sent to
+ *
+ * @return  afStatus_SUCCESS
+ */
+static afStatus_t benchAfDataCb(afAddrType_t *dstAddr, endPointDesc_t *srcEP,
+                                uint16_t cID, uint16_t len, uint8_t *buf,
+                                uint8_t options)
+{
+    benchClient_t *pClient = pCurClient;
+    uint8_t *p = &buf[BENCH_ZCL_HDR_LEN];
+    uint32_t offset;
+    uint8_t dataSize;
+
+    (void)srcEP;
+    (void)options;
+
+    storeNsAtSend = storeNs;
+    sent = true;
+
+    if((pClient == NULL) || !benchSameAddr(dstAddr, &pClient->addr) ||
+       (cID != ZCL_CLUSTER_ID_OTA) || (len < BENCH_ZCL_HDR_LEN + PAYLOAD_MAX_LEN_IMAGE_BLOCK_RSP) ||
+       (buf[2] != COMMAND_OTA_UPGRADE_IMAGE_BLOCK_RESPONSE) || (p[0] != ZCL_STATUS_SUCCESS))
+    {
+        benchCheck(false, "response not a successful Image Block Response to the client");
+        return(afStatus_SUCCESS);
+    }
+
+    offset = OsalPort_buildUint32(&p[9], 4);
+    dataSize = p[13];
+    if((offset != curReqOffset) || (dataSize == 0) || (offset + dataSize > fileSize) ||
+       (len != BENCH_ZCL_HDR_LEN + PAYLOAD_MAX_LEN_IMAGE_BLOCK_RSP + dataSize))
+    {
+        benchCheck(false, "block at another offset or of a wrong size");
+        return(afStatus_SUCCESS);
+    }
+    memcpy(&pClient->data[offset], &p[14], dataSize);
+    pClient->offset = offset + dataSize;
+    pClient->blocks++;
+    return(afStatus_SUCCESS);
+}
+
+/**
+ * @fn      benchSendNoCache
+ *
+ * @brief   Answer an Image Block Request with a store read of the block
+ *
+ * @param   dstAddr - client
+ * @param   pReq    - request
+ *
+ * @return  ZStatus_t
+ */
+static ZStatus_t benchSendNoCache(afAddrType_t *dstAddr, zclOTA_ImageBlockReqParams_t *pReq)
+{
+    zclOTA_ImageBlockRspParams_t rsp;
+    uint8_t data[255];
+    uint16_t len;
+
+    len = benchStoreRead(&pReq->fileId, pReq->fileOffset, pReq->maxDataSize, data);
+    if(len == 0)
+    {
+        rsp.status = ZCL_STATUS_ABORT;
+    }
+    else
+    {
+        rsp.status = ZCL_STATUS_SUCCESS;
+        rsp.rsp.success.fileId = pReq->fileId;
+        rsp.rsp.success.fileOffset = pReq->fileOffset;
+        rsp.rsp.success.dataSize = (uint8_t)len;
+        rsp.rsp.success.pData = data;
+    }
+    return(zclOTA_SendImageBlockRsp(BENCH_SRC_EP, dstAddr, &rsp, 0));
+}
+
+static int benchCmpU32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+
+    return((x > y) - (x < y));
+}
+
+/**
+ * @fn      benchCheckSessions
+ *
+ * @brief   Check the progress the cache tracked for every client, then end
+ *          the sessions
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+static void benchCheckSessions(void)
+{
+    zclOTA_ServerSession_t *pSession;
+    zclOTA_FileID_t fileId;
+    uint8_t c;
+
+    for(c = 0; c < numClients; c++)
+    {
+        pSession = zclOTA_ServerGetSession(&clients[c].addr);
+        if(numClients <= OTA_CACHE_NUM_SESSIONS)
+        {
+            benchFileId(clients[c].file, &fileId);
+            benchCheck((pSession != NULL) && (pSession->imageSize == fileSize) &&
+                       (pSession->fileOffset == fileSize) &&
+                       (pSession->blocksSent == clients[c].blocks) &&
+                       (pSession->fileId.version == fileId.version),
+                       "session does not hold the progress of its client");
+        }
+        zclOTA_ServerEndSession(&clients[c].addr);
+        benchCheck(zclOTA_ServerGetSession(&clients[c].addr) == NULL,
+                   "session left after zclOTA_ServerEndSession()");
+    }
+}
+
+/**
+ * @fn      benchRun
+ *
+ * @brief   Let the clients download their images and print the line of the
+ *          run
+ *
+ * @param   n     - number of clients
+ * @param   cache - answer from the block cache
+ *
+ * @return  none
+ */
+static void benchRun(uint8_t n, bool cache)
+{
+    zclOTA_ImageBlockReqParams_t req;
+    zclOTA_ServerCacheStats_t stats;
+    benchClient_t *pClient;
+    uint64_t serverFree = 0;
+    uint64_t start;
+    uint64_t latencySum = 0;
+    uint64_t endTime = 0;
+    uint32_t seed = benchSeed;
+    uint32_t requests = 0;
+    uint8_t remaining = n;
+    uint8_t c;
+
+    numClients = n;
+    for(c = 0; c < n; c++)
+    {
+        pClient = &clients[c];
+        memset(pClient, 0, sizeof(benchClient_t));
+        pClient->file = c % numFiles;
+        pClient->data = calloc(1, fileSize);
+        pClient->nextReq = spreadUs ? benchRand() % spreadUs : 0;
+        pClient->addr.endPoint = BENCH_DST_EP;
+        if(c & 1)
+        {
+            // Low bytes equal to the short address of the previous client
+            pClient->addr.addrMode = afAddr64Bit;
+            pClient->addr.addr.extAddr[0] = LO_UINT16(0x1000 + c - 1);
+            pClient->addr.addr.extAddr[1] = HI_UINT16(0x1000 + c - 1);
+            pClient->addr.addr.extAddr[7] = 0x12;
+        }
+        else
+        {
+            pClient->addr.addrMode = afAddr16Bit;
+            pClient->addr.addr.shortAddr = (uint16_t)(0x1000 + c);
+        }
+    }
+
+    storeReads = 0;
+    storeBytes = 0;
+    storeNs = 0;
+    numLatencies = 0;
+    zclOTA_ServerCacheInit(benchStoreRead);
+
+    while(remaining > 0)
+    {
+        // Next request in time
+        pClient = NULL;
+        for(c = 0; c < n; c++)
+        {
+            if(!clients[c].done && ((pClient == NULL) || (clients[c].nextReq < pClient->nextReq)))
+            {
+                pClient = &clients[c];
+            }
+        }
+
+        benchFileId(pClient->file, &req.fileId);
+        req.fileOffset = pClient->offset;
+        req.maxDataSize = blockSize;
+        req.fieldControl = 0;
+        req.blockReqDelay = 0;
+
+        start = (pClient->nextReq > serverFree) ? pClient->nextReq : serverFree;
+        pCurClient = pClient;
+        curReqOffset = req.fileOffset;
+        sent = false;
+        storeNs = 0;
+        if(cache)
+        {
+            (void)zclOTA_ServerSendImageBlock(BENCH_SRC_EP, &pClient->addr, &req, 0);
+        }
+        else
+        {
+            (void)benchSendNoCache(&pClient->addr, &req);
+        }
+        pCurClient = NULL;
+        requests++;
+
+        if(!sent || (pClient->offset == req.fileOffset) || (numLatencies == maxLatencies))
+        {
+            benchCheck(false, "request not answered");
+            break;
+        }
+
+        latencies[numLatencies] = (uint32_t)(start - pClient->nextReq + BENCH_SERVER_US + storeNsAtSend / 1000);
+        latencySum += latencies[numLatencies++];
+        serverFree = start + BENCH_SERVER_US + storeNs / 1000;
+
+        if(pClient->offset >= fileSize)
+        {
+            pClient->done = true;
+            pClient->doneTime = start + BENCH_SERVER_US + storeNsAtSend / 1000;
+            if(pClient->doneTime > endTime)
+            {
+                endTime = pClient->doneTime;
+            }
+            remaining--;
+        }
+        else
+        {
+            pClient->nextReq = start + BENCH_SERVER_US + storeNsAtSend / 1000 +
+                               intervalUs / 2 + (intervalUs ? benchRand() % intervalUs : 0);
+        }
+    }
+
+    for(c = 0; c < n; c++)
+    {
+        benchCheck(clients[c].done &&
+                   (memcmp(clients[c].data, files[clients[c].file], fileSize) == 0),
+                   "image received differs from the store");
+        free(clients[c].data);
+    }
+
+    memset(&stats, 0, sizeof(stats));
+    if(cache)
+    {
+        zclOTA_ServerCacheGetStats(&stats);
+        benchCheck(stats.hits + stats.misses == requests, "hits and misses are not the requests");
+        // Beside the pages, only image sizes are read from the store
+        benchCheck(storeReads >= stats.misses + stats.prefetches, "fewer store reads than pages read");
+        benchCheckSessions();
+    }
+    benchCheck(ZstackHost_stats.inUse == 0, "memory left allocated");
+
+    qsort(latencies, numLatencies, sizeof(uint32_t), benchCmpU32);
+    printf("%7u %-5s %8u %8u %9.0f %6.1f %8u %8.1f %8.1f %8.1f %8.1f\n",
+           n, cache ? "cache" : "none", requests, storeReads, storeBytes / 1024.0,
+           cache ? 100.0 * stats.hits / requests : 0.0, stats.prefetches,
+           latencySum / 1e3 / numLatencies,
+           latencies[(uint32_t)(numLatencies * 0.99)] / 1e3,
+           latencies[numLatencies - 1] / 1e3, endTime / 1e6);
+
+    benchSeed = seed;
+}
+
+static void benchParseCounts(char *arg)
+{
+    char *tok;
+
+    numCounts = 0;
+    for(tok = strtok(arg, ","); (tok != NULL) && (numCounts < BENCH_MAX_RUNS); tok = strtok(NULL, ","))
+    {
+        clientCounts[numCounts++] = (uint8_t)strtoul(tok, NULL, 0);
+    }
+}
+
+static void benchUsage(const char *prog)
+{
+    printf("Usage: %s [options]\n"
+           "  -n <list>   comma separated client counts, default 1,8,30, at most %u\n"
+           "  -s <bytes>  OTA file size, default %u\n"
+           "  -b <bytes>  maximum data size of the requests, default OTA_MAX_MTU %u\n"
+           "  -f <files>  images, client i downloads image i modulo files, default 1, at most %u\n"
+           "  -i <ms>     mean time between a response and the next request, default 250\n"
+           "  -t <ms>     clients start within this time, default 1000\n"
+           "  -S <us>     store time per read, default 5000\n"
+           "  -B <ns>     store time per byte, default 87000\n"
+           "  -r <seed>   random seed, default 1\n"
+           "  -h          this help\n"
+           "Cache of %u pages of %u bytes, %u sessions\n",
+           prog, BENCH_MAX_CLIENTS, BENCH_FILE_SIZE, OTA_MAX_MTU, BENCH_MAX_FILES,
+           OTA_CACHE_NUM_PAGES, OTA_CACHE_PAGE_SIZE, OTA_CACHE_NUM_SESSIONS);
+}
+
+//*****************************************************************************
+// Main
+//*****************************************************************************
+
+int main(int argc, char *argv[])
+{
+    uint8_t maxClients = 0;
+    uint8_t i;
+    uint8_t f;
+    int opt;
+
+    while((opt = getopt(argc, argv, "n:s:b:f:i:t:S:B:r:h")) != -1)
+    {
+        switch(opt)
+        {
+            case 'n': benchParseCounts(optarg); break;
+            case 's': fileSize = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'b': blockSize = (uint8_t)strtoul(optarg, NULL, 0); break;
+            case 'f': numFiles = (uint8_t)strtoul(optarg, NULL, 0); break;
+            case 'i': intervalUs = (uint32_t)strtoul(optarg, NULL, 0) * 1000; break;
+            case 't': spreadUs = (uint32_t)strtoul(optarg, NULL, 0) * 1000; break;
+            case 'S': readUs = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'B': readByteNs = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'r': benchSeed = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'h': benchUsage(argv[0]); return(0);
+            default:  benchUsage(argv[0]); return(2);
+        }
+    }
+    if((fileSize < BENCH_OTA_HDR_LEN) || (blockSize == 0) || (numFiles == 0) ||
+       (numFiles > BENCH_MAX_FILES) || (benchSeed == 0) || (numCounts == 0))
+    {
+        benchUsage(argv[0]);
+        return(2);
+    }
+    for(i = 0; i < numCounts; i++)
+    {
+        if((clientCounts[i] == 0) || (clientCounts[i] > BENCH_MAX_CLIENTS))
+        {
+            benchUsage(argv[0]);
+            return(2);
+        }
+        if(clientCounts[i] > maxClients)
+        {
+            maxClients = clientCounts[i];
+        }
+    }
+    // Cached blocks end at page ends, so a page may take one block more
+    maxLatencies = maxClients * (fileSize / blockSize + fileSize / OTA_CACHE_PAGE_SIZE + 2);
+    latencies = malloc(maxLatencies * sizeof(uint32_t));
+
+    ZstackHost_addEndpoint(&srcEp);
+    ZstackHost_setAfDataCb(benchAfDataCb);
+    benchBuildFiles();
+
+    printf("OTA server: %u file(s) of %u bytes, blocks of %u bytes, request interval %u ms, "
+           "store %u us + %u ns/byte\n"
+           "Cache of %u pages of %u bytes, %u sessions\n\n",
+           numFiles, fileSize, blockSize, intervalUs / 1000, readUs, readByteNs,
+           OTA_CACHE_NUM_PAGES, OTA_CACHE_PAGE_SIZE, OTA_CACHE_NUM_SESSIONS);
+    printf("clients mode  requests    reads  store KB  hit %% prefetch  mean ms   p99 ms   max ms   time s\n");
+    for(i = 0; i < numCounts; i++)
+    {
+        benchRun(clientCounts[i], false);
+        benchRun(clientCounts[i], true);
+    }
+
+    for(f = 0; f < numFiles; f++)
+    {
+        free(files[f]);
+    }
+    free(latencies);
+    printf("failures: %u\n", failures);
+
+    return((failures != 0) ? 1 : 0);
+}
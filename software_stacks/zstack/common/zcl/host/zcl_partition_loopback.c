@@ -0,0 +1,626 @@
+/******************************************************************************
+
+ @file  zcl_partition_loopback.c
+
+ @brief Partition cluster transfer engine loopback test
+
+ Group: WCS, LPC
+ Target Device: cc13xx_cc26xx
+
+ ******************************************************************************
+ 
+ Copyright (c) 2019-2026, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ 
+ 
+ *****************************************************************************/
+
+/*
+Runs the windowed transfer engine of zcl_partition.c against itself: a
+sender and a receiver exchange Transfer Partitioned Frame and Multiple ACK
+commands, built and parsed by the cluster's own send and convert functions,
+over a simulated channel that loses, duplicates and delays (reorders)
+frames in both directions. Time advances in ticks. The sender times out
+when no Multiple ACK came for a while, the receiver sends a Multiple ACK
+when frames stop arriving before its window is full.
+
+Each configuration is run with 8-bit and 16-bit partition indicators and
+NACK IDs (transfers of at most and of more than 255 frames), and checks:
+
+- the receiver reassembles exactly the data sent, and both sides finish
+- a frame the sender learned from the last Multiple ACK it processed was
+  received is not sent again, even when a timeout marked it for resending
+  before that Multiple ACK arrived
+- no memory is leaked
+
+Directed cases check zclPartition_TxProcessMultipleAck() on its own. The
+exit status is 1 on any failure. Build and run from the repository root:
+
+  cc -O2 -DOSAL_PORT2TIRTOS -DZCL_PARTITION \
+      -Isoftware_stacks/zstack/host -I. -Isoftware_stacks \
+      -Isoftware_stacks/ti15_4stack/hal/platform \
+      -Isoftware_stacks/ti15_4stack/mac/services \
+      -Isoftware_stacks/ti15_4stack/mac -Isoftware_stacks/zstack/af \
+      -Isoftware_stacks/zstack/bdb -Isoftware_stacks/zstack/sys \
+      -Isoftware_stacks/zstack/nwk -Isoftware_stacks/zstack/osal_port \
+      -Isoftware_stacks/zstack/common/zcl -Isoftware_stacks/zstack/stack_task \
+      -Isoftware_stacks/zstack/zdo -Isoftware_stacks/zstack/sec \
+      -Isoftware_stacks/zstack/gp -Isoftware_stacks/zstack/zmac -Idrivers/nv \
+      -o zcl_partition_loopback \
+      software_stacks/zstack/common/zcl/host/zcl_partition_loopback.c \
+      software_stacks/zstack/common/zcl/zcl_partition.c \
+      software_stacks/zstack/common/zcl/zcl.c \
+      software_stacks/zstack/host/zstack_host.c
+  ./zcl_partition_loopback -h
+*/
+
+//*****************************************************************************
+// Includes
+//*****************************************************************************
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "zcl.h"
+#include "zcl_partition.h"
+#include "zstack_host.h"
+
+//*****************************************************************************
+// Constants and Definitions
+//*****************************************************************************
+
+// Home Automation profile
+#define LOOP_PROFILE_ID         0x0104
+
+#define LOOP_SENDER_EP          8
+#define LOOP_RECEIVER_EP        9
+
+#define LOOP_MAX_LEN            4000
+#define LOOP_MAX_FRAMES         LOOP_MAX_LEN
+#define LOOP_MAX_PACKETS        256
+#define LOOP_MAX_PACKET_LEN     80
+#define LOOP_MAX_NACKS          32
+
+// Ticks without a Multiple ACK before the sender times out, and without a
+// frame before the receiver acknowledges a partial window
+#define LOOP_TX_TIMEOUT         20
+#define LOOP_RX_TIMEOUT         8
+
+#define LOOP_MAX_RETRIES        100
+#define LOOP_MAX_TICKS          1000000
+
+//*****************************************************************************
+// Typedefs
+//*****************************************************************************
+
+// A command on its way through the channel
+typedef struct
+{
+    uint32_t  deliverAt;    // tick it arrives
+    uint8_t   toReceiver;   // Transfer Partitioned Frame, else Multiple ACK
+    uint8_t   len;
+    uint8_t   data[LOOP_MAX_PACKET_LEN];
+} loopPacket_t;
+
+// A transfer setup
+typedef struct
+{
+    const char *name;
+    uint16_t    len;
+    uint8_t     frameSize;
+    uint8_t     window;
+} loopConfig_t;
+
+//*****************************************************************************
+// Locals
+//*****************************************************************************
+
+static int lossPct = 10;
+static int dupPct = 5;
+static uint32_t maxDelay = 30;
+static int numRuns = 50;
+
+static loopPacket_t channel[LOOP_MAX_PACKETS];
+static int channelLen;
+static uint32_t now;
+
+static SimpleDescriptionFormat_t senderDesc = { LOOP_SENDER_EP, LOOP_PROFILE_ID };
+static SimpleDescriptionFormat_t receiverDesc = { LOOP_RECEIVER_EP, LOOP_PROFILE_ID };
+static endPointDesc_t senderEp = { LOOP_SENDER_EP, 0, NULL, &senderDesc, noLatencyReqs };
+static endPointDesc_t receiverEp = { LOOP_RECEIVER_EP, 0, NULL, &receiverDesc, noLatencyReqs };
+static afAddrType_t toReceiver;
+static afAddrType_t toSender;
+
+static zclPartitionTransfer_t tx;
+static zclPartitionTransfer_t rx;
+static uint8_t txData[LOOP_MAX_LEN];
+static uint8_t rxData[LOOP_MAX_LEN];
+static uint8_t seqNum;
+
+// Frames the last Multiple ACK processed by the sender reports as received,
+// since the last sender timeout
+static uint8_t confirmed[LOOP_MAX_FRAMES];
+
+static uint32_t framesSent;
+static uint32_t dupFramesRx;
+static uint32_t acksSent;
+static uint32_t txTimeouts;
+static uint32_t violations;
+static uint32_t failures;
+
+//*****************************************************************************
+// Channel
+//*****************************************************************************
+
+static int chance(int pct)
+{
+    return((rand() % 100) < pct);
+}
+
+static void channelPut(uint8_t toRx, uint8_t *buf, uint16_t len)
+{
+    if((channelLen >= LOOP_MAX_PACKETS) || (len > LOOP_MAX_PACKET_LEN))
+    {
+        printf("channel overflow\n");
+        failures++;
+        return;
+    }
+    channel[channelLen].deliverAt = now + 1 + (maxDelay ? (uint32_t)rand() % maxDelay : 0);
+    channel[channelLen].toReceiver = toRx;
+    channel[channelLen].len = (uint8_t)len;
+    memcpy(channel[channelLen].data, buf, len);
+    channelLen++;
+}
+
+/*
+ * AF data requests of both sides end up here. Records frames the sender
+ * sends that it was told were received, then loses or duplicates the
+ * command.
+ */
+static afStatus_t loopAfDataCb(afAddrType_t *dstAddr, endPointDesc_t *srcEP, uint16_t cID,
+                               uint16_t len, uint8_t *buf, uint8_t options)
+{
+    uint8_t toRx = (dstAddr->endPoint == LOOP_RECEIVER_EP);
+    (void)srcEP;
+    (void)options;
+
+    if(cID != ZCL_CLUSTER_ID_GENERAL_PARTITION)
+    {
+        printf("unexpected cluster 0x%04X\n", cID);
+        failures++;
+        return(afStatus_SUCCESS);
+    }
+
+    if(toRx)
+    {
+        zclCmdTransferPartitionedFrame_t cmd;
+        zclFrameHdr_t hdr;
+        uint8_t *pPayload = zclParseHdr(&hdr, buf);
+        uint16_t frame;
+
+        zclPartition_ConvertOtaToNative_TransferPartitionedFrame(&cmd, pPayload,
+                                                                  (uint8_t)(len - (pPayload - buf)));
+        frame = (cmd.fragmentationOptions & ZCL_PARTITION_OPTIONS_FIRSTBLOCK) ? 0 : cmd.partitionIndicator;
+        if(confirmed[frame])
+        {
+            violations++;
+        }
+        framesSent++;
+    }
+    else
+    {
+        acksSent++;
+    }
+
+    if(!chance(lossPct))
+    {
+        channelPut(toRx, buf, len);
+        if(chance(dupPct))
+        {
+            channelPut(toRx, buf, len);
+        }
+    }
+    return(afStatus_SUCCESS);
+}
+
+//*****************************************************************************
+// Sender and receiver
+//*****************************************************************************
+
+static void senderSend(void)
+{
+    ZStatus_t status = zclPartition_TxSend(&tx, LOOP_SENDER_EP, &toReceiver, TRUE, &seqNum);
+
+    if(status != ZSuccess)
+    {
+        printf("zclPartition_TxSend failed, 0x%02X\n", status);
+        failures++;
+    }
+}
+
+static void receiverAck(void)
+{
+    zclCmdMultipleAck_t ack;
+    uint16_t nacks[LOOP_MAX_NACKS];
+
+    zclPartition_RxBuildMultipleAck(&rx, &ack, nacks, LOOP_MAX_NACKS);
+    zclPartition_Send_MultipleAck(LOOP_RECEIVER_EP, &toSender, &ack, TRUE, seqNum++);
+}
+
+static void receiverProcess(loopPacket_t *pPkt)
+{
+    zclCmdTransferPartitionedFrame_t cmd;
+    zclFrameHdr_t hdr;
+    uint8_t *pPayload = zclParseHdr(&hdr, pPkt->data);
+    uint8_t ackDue;
+    uint16_t frame;
+    ZStatus_t status;
+
+    zclPartition_ConvertOtaToNative_TransferPartitionedFrame(&cmd, pPayload,
+                                                              (uint8_t)(pPkt->len - (pPayload - pPkt->data)));
+    frame = (cmd.fragmentationOptions & ZCL_PARTITION_OPTIONS_FIRSTBLOCK) ? 0 : cmd.partitionIndicator;
+    if((rx.totalLen != 0) && (frame < rx.numFrames) &&
+       (rx.pFrameMap[frame >> 3] & (1 << (frame & 0x07))))
+    {
+        dupFramesRx++;
+    }
+
+    status = zclPartition_RxProcessFrame(&rx, &cmd, &ackDue);
+    if(status != ZSuccess)
+    {
+        printf("zclPartition_RxProcessFrame frame %u failed, 0x%02X\n", frame, status);
+        failures++;
+    }
+    else if(ackDue)
+    {
+        receiverAck();
+    }
+}
+
+static void senderProcess(loopPacket_t *pPkt)
+{
+    zclCmdMultipleAck_t ack;
+    zclFrameHdr_t hdr;
+    uint8_t *pPayload = zclParseHdr(&hdr, pPkt->data);
+    uint16_t frame;
+    uint8_t i;
+
+    if(zclPartition_ConvertOtaToNative_MultipleAck(&ack, pPayload,
+                                                   (uint8_t)(pPkt->len - (pPayload - pPkt->data))) != ZSuccess)
+    {
+        printf("zclPartition_ConvertOtaToNative_MultipleAck failed\n");
+        failures++;
+        return;
+    }
+
+    // What the sender now knows: everything before FirstFrameID and every
+    // frame sent up to the last NACK was received, except the NACKed ones
+    for(frame = 0; frame < ack.firstFrameID; frame++)
+    {
+        confirmed[frame] = 1;
+    }
+    for(i = 0; i < ack.numNAcks; i++)
+    {
+        if(i && (ack.pNAckID[i] > ack.pNAckID[i - 1] + 1))
+        {
+            for(frame = ack.pNAckID[i - 1] + 1; frame < ack.pNAckID[i]; frame++)
+            {
+                confirmed[frame] = 1;
+            }
+        }
+        confirmed[ack.pNAckID[i]] = 0;
+    }
+
+    zclPartition_TxProcessMultipleAck(&tx, &ack);
+    zcl_mem_free(ack.pNAckID);
+    senderSend();
+}
+
+//*****************************************************************************
+// Tests
+//*****************************************************************************
+
+/*
+ * Run one transfer to completion. Returns the ticks it took, 0 on failure.
+ */
+static uint32_t loopTransfer(const loopConfig_t *pCfg)
+{
+    uint32_t lastTxActivity = 0;
+    uint32_t lastRxFrame = 0;
+    uint32_t failuresBefore = failures;
+    uint16_t i;
+
+    for(i = 0; i < pCfg->len; i++)
+    {
+        txData[i] = (uint8_t)rand();
+    }
+    memset(rxData, 0, sizeof(rxData));
+    memset(confirmed, 0, sizeof(confirmed));
+    channelLen = 0;
+    now = 0;
+
+    if((zclPartition_TxStart(&tx, txData, pCfg->len, pCfg->frameSize, pCfg->window) != ZSuccess) ||
+       (zclPartition_RxStart(&rx, rxData, sizeof(rxData), pCfg->frameSize, pCfg->window) != ZSuccess))
+    {
+        printf("%s: start failed\n", pCfg->name);
+        failures++;
+        return(0);
+    }
+    senderSend();
+
+    while(!(zclPartition_TxDone(&tx) && zclPartition_RxDone(&rx)) && (now < LOOP_MAX_TICKS) &&
+          (failures == failuresBefore))
+    {
+        int n;
+
+        now++;
+
+        // Deliver the packets due, in random order when several are
+        for(n = 0; n < channelLen; )
+        {
+            if(channel[n].deliverAt <= now)
+            {
+                loopPacket_t pkt = channel[n];
+
+                channel[n] = channel[--channelLen];
+                if(pkt.toReceiver)
+                {
+                    receiverProcess(&pkt);
+                    lastRxFrame = now;
+                }
+                else
+                {
+                    senderProcess(&pkt);
+                    lastTxActivity = now;
+                }
+                n = 0;
+                continue;
+            }
+            n++;
+        }
+
+        if((rx.inFlight > 0) && (now - lastRxFrame >= LOOP_RX_TIMEOUT))
+        {
+            receiverAck();
+        }
+        if(!zclPartition_TxDone(&tx) && (now - lastTxActivity >= LOOP_TX_TIMEOUT))
+        {
+            if(zclPartition_TxTimeout(&tx, LOOP_MAX_RETRIES) != ZSuccess)
+            {
+                printf("%s: sender gave up after %d retries\n", pCfg->name, LOOP_MAX_RETRIES);
+                failures++;
+                break;
+            }
+            txTimeouts++;
+            memset(confirmed, 0, sizeof(confirmed));
+            lastTxActivity = now;
+            senderSend();
+        }
+    }
+
+    if(failures == failuresBefore)
+    {
+        if(!zclPartition_TxDone(&tx) || !zclPartition_RxDone(&rx))
+        {
+            printf("%s: not done after %u ticks\n", pCfg->name, now);
+            failures++;
+        }
+        else if((rx.totalLen != pCfg->len) || memcmp(rxData, txData, pCfg->len))
+        {
+            printf("%s: received data differs\n", pCfg->name);
+            failures++;
+        }
+    }
+
+    zclPartition_TransferFree(&tx);
+    zclPartition_TransferFree(&rx);
+    return((failures == failuresBefore) ? now : 0);
+}
+
+/*
+ * A timeout marks every unacknowledged frame for resending. A Multiple ACK
+ * arriving afterwards leaves only its NACKed frames marked, from the new
+ * ackBase on, where zclPartition_TxSend() looks for frames to resend.
+ */
+static void testLateMultipleAck(void)
+{
+    zclCmdMultipleAck_t ack;
+    uint16_t nack[2] = { 4, 6 };
+    uint16_t frame;
+
+    zclPartition_TxStart(&tx, txData, 200, 10, 8);
+    tx.nextFrame = 8;
+    tx.inFlight = 8;
+    zclPartition_TxTimeout(&tx, 3);
+
+    ack.options = ZCL_PARTITION_OPTIONS_NACK_8BIT;
+    ack.firstFrameID = 2;
+    ack.numNAcks = 2;
+    ack.pNAckID = nack;
+    zclPartition_TxProcessMultipleAck(&tx, &ack);
+
+    for(frame = tx.ackBase; frame < tx.numFrames; frame++)
+    {
+        uint8_t marked = (tx.pFrameMap[frame >> 3] & (1 << (frame & 0x07))) != 0;
+
+        if(marked != ((frame == 4) || (frame == 6)))
+        {
+            printf("late Multiple ACK: frame %u %s marked for resending\n", frame,
+                   marked ? "still" : "not");
+            failures++;
+        }
+    }
+    if((tx.ackBase != 2) || (tx.inFlight != 0) || (tx.retries != 0))
+    {
+        printf("late Multiple ACK: ackBase %u inFlight %u retries %u\n", tx.ackBase,
+               tx.inFlight, tx.retries);
+        failures++;
+    }
+    zclPartition_TransferFree(&tx);
+}
+
+/*
+ * FirstFrameID past the frames sent, and NACKs outside the frames sent,
+ * are ignored.
+ */
+static void testMultipleAckBounds(void)
+{
+    zclCmdMultipleAck_t ack;
+    uint16_t nack[3] = { 1, 5, 300 };
+    uint16_t frame;
+
+    zclPartition_TxStart(&tx, txData, 3000, 10, 16);
+    tx.nextFrame = 5;
+    zclPartition_TxTimeout(&tx, 3);
+
+    ack.options = ZCL_PARTITION_OPTIONS_NACK_16BIT;
+    ack.firstFrameID = 2;
+    ack.numNAcks = 3;
+    ack.pNAckID = nack;
+    zclPartition_TxProcessMultipleAck(&tx, &ack);
+    for(frame = tx.ackBase; frame < tx.numFrames; frame++)
+    {
+        if(tx.pFrameMap[frame >> 3] & (1 << (frame & 0x07)))
+        {
+            printf("Multiple ACK bounds: frame %u marked for resending\n", frame);
+            failures++;
+        }
+    }
+
+    ack.firstFrameID = 9;
+    ack.numNAcks = 0;
+    zclPartition_TxProcessMultipleAck(&tx, &ack);
+    if(tx.ackBase != 5)
+    {
+        printf("Multiple ACK bounds: ackBase %u, expected 5\n", tx.ackBase);
+        failures++;
+    }
+    zclPartition_TransferFree(&tx);
+}
+
+static void usage(const char *prog)
+{
+    printf("Usage: %s [options]\n"
+           "  -n <n>   transfers per configuration (default %d)\n"
+           "  -l <n>   loss, percent of commands (default %d)\n"
+           "  -d <n>   duplicates, percent of commands (default %d)\n"
+           "  -r <n>   maximum delay in ticks, reorders when > 1 (default %u)\n"
+           "  -s <n>   random seed (default 1)\n"
+           "  -h       this help\n",
+           prog, numRuns, lossPct, dupPct, maxDelay);
+}
+
+//*****************************************************************************
+// Main
+//*****************************************************************************
+
+int main(int argc, char *argv[])
+{
+    static const loopConfig_t configs[] =
+    {
+        { "8-bit, 10 frames",    200,  20,  4 },
+        { "8-bit, 255 frames",   255,   1, 16 },
+        { "16-bit, 256 frames",  256,   1,  8 },
+        { "16-bit, 400 frames", 4000,  10, 16 },
+        { "16-bit, window 1",    600,  40,  1 },
+    };
+    unsigned int c;
+    int seed = 1;
+    int opt;
+
+    while((opt = getopt(argc, argv, "n:l:d:r:s:h")) != -1)
+    {
+        switch(opt)
+        {
+            case 'n': numRuns = atoi(optarg); break;
+            case 'l': lossPct = atoi(optarg); break;
+            case 'd': dupPct = atoi(optarg); break;
+            case 'r': maxDelay = (uint32_t)atoi(optarg); break;
+            case 's': seed = atoi(optarg); break;
+            case 'h': usage(argv[0]); return(0);
+            default: usage(argv[0]); return(2);
+        }
+    }
+    if((numRuns < 1) || (lossPct < 0) || (lossPct > 90) || (dupPct < 0) || (dupPct > 100))
+    {
+        usage(argv[0]);
+        return(2);
+    }
+    srand(seed);
+
+    toReceiver.addrMode = afAddr16Bit;
+    toReceiver.addr.shortAddr = 0x0001;
+    toReceiver.endPoint = LOOP_RECEIVER_EP;
+    toSender.addrMode = afAddr16Bit;
+    toSender.addr.shortAddr = 0x0000;
+    toSender.endPoint = LOOP_SENDER_EP;
+    ZstackHost_addEndpoint(&senderEp);
+    ZstackHost_addEndpoint(&receiverEp);
+
+    testLateMultipleAck();
+    testMultipleAckBounds();
+
+    ZstackHost_setAfDataCb(loopAfDataCb);
+    printf("loss %d%%, duplicates %d%%, delay 1..%u ticks, %d transfers each\n",
+           lossPct, dupPct, maxDelay, numRuns);
+    printf("  %-20s %10s %10s %8s %8s %10s\n", "transfer", "frames/tx", "dup rx/tx",
+           "acks/tx", "timeouts", "ticks/tx");
+    for(c = 0; c < sizeof(configs) / sizeof(configs[0]); c++)
+    {
+        const loopConfig_t *pCfg = &configs[c];
+        uint32_t numFrames = (pCfg->len + pCfg->frameSize - 1) / pCfg->frameSize;
+        uint64_t ticks = 0;
+        int run;
+
+        framesSent = dupFramesRx = acksSent = txTimeouts = 0;
+        for(run = 0; run < numRuns; run++)
+        {
+            ticks += loopTransfer(pCfg);
+        }
+        printf("  %-20s %10.2f %10.2f %8.1f %8.1f %10.1f\n", pCfg->name,
+               (double)framesSent / numRuns / numFrames, (double)dupFramesRx / numRuns,
+               (double)acksSent / numRuns, (double)txTimeouts / numRuns,
+               (double)ticks / numRuns);
+    }
+
+    if(ZstackHost_stats.inUse != 0)
+    {
+        printf("%u blocks leaked\n", ZstackHost_stats.inUse);
+        failures++;
+    }
+    printf("acknowledged frames sent again: %u\n", violations);
+    printf("failures: %u\n", failures);
+
+    return(((failures != 0) || (violations != 0)) ? 1 : 0);
+}
@@ -99,9 +99,34 @@
                                         (cmd) == ZCL_CMD_DEFAULT_RSP ) // exception
 #define  ZCL_VALID_MIN_HEADER_LEN  3
 
+// Sort key of the attribute/command record indexes
+#define ZCL_ATTR_INDEX_KEY( clusterID, id )  ( ((uint32_t)(clusterID) << 16) | (uint16_t)(id) )
+
 /*********************************************************************
  * CONSTANTS
  */
+// Room kept in front of a zcl_FrameAlloc payload for the largest ZCL header:
+// frame control, manufacturer code, sequence number and command ID
+#define ZCL_FRAME_HDR_HEADROOM    5
+
+// Number of endpoints whose per-frame lookups are kept in the hot cache
+#if !defined ( ZCL_HOT_CACHE_ENTRIES )
+  #define ZCL_HOT_CACHE_ENTRIES     2
+#endif
+
+// Hot cache entry flags
+#define ZCL_HOT_IN_USE            0x01
+#define ZCL_HOT_DEVICE_ENABLED    0x02  // pDeviceEnabled is valid
+#define ZCL_HOT_OPTION            0x04  // optionClusterID/pOption are valid
+
+// The hot cache is used from both the application and the stack thread
+#if !defined ( ZCL_STANDALONE ) || defined ( ZCL_STANDALONE_OSAL )
+  #define ZCL_HOT_CACHE_LOCK()      uint32_t hotKey = OsalPort_enterCS()
+  #define ZCL_HOT_CACHE_UNLOCK()    OsalPort_leaveCS( hotKey )
+#else
+  #define ZCL_HOT_CACHE_LOCK()
+  #define ZCL_HOT_CACHE_UNLOCK()
+#endif
 
 /*********************************************************************
  * TYPEDEFS
@@ -121,6 +146,7 @@ typedef struct zclCmdRecsList
   uint8_t                 endpoint;
   uint8_t                 numCommands;
   CONST zclCommandRec_t *pCmdRecs;
+  uint8_t                *pCmdIndex;  // pCmdRecs indexes sorted by cluster ID and command ID
 } zclCmdRecsList_t;
 
 
@@ -151,6 +177,16 @@ typedef struct zclExternalFoundationHandlerList
     uint8_t zcl_ExternalEndPoint;
 } zclExternalFoundationHandlerList;
 
+// Lookups done for every frame sent or received on an endpoint
+typedef struct
+{
+  uint8_t           endpoint;
+  uint8_t           flags;            // ZCL_HOT_xxx
+  uint8_t          *pDeviceEnabled;   // DeviceEnabled attribute data, NULL if none
+  uint16_t          optionClusterID;  // cluster of the last option lookup
+  zclOptionRec_t   *pOption;          // its option record, NULL if none
+} zclHotCache_t;
+
 
 /*********************************************************************
  * GLOBAL VARIABLES
@@ -182,6 +218,14 @@ uint8_t zcl_radius = AF_DEFAULT_RADIUS;
  */
 static zclLibPlugin_t *plugins = (zclLibPlugin_t *)NULL;
 
+// Last plugin lookup, cleared when a plugin is registered
+static zclLibPlugin_t *hotPlugin = (zclLibPlugin_t *)NULL;
+static uint16_t hotPluginClusterID;
+static uint8_t hotPluginValid = FALSE;
+
+static zclHotCache_t hotCache[ZCL_HOT_CACHE_ENTRIES];
+static uint8_t hotCacheNext = 0;
+
 #if defined ( ZCL_DISCOVER )
   static zclCmdRecsList_t *gpCmdList = (zclCmdRecsList_t *)NULL;
 #endif
@@ -200,7 +244,16 @@ static zclExternalFoundationHandlerList *externalEndPointHandlerList = (zclExter
  */
 static uint8_t *zclBuildHdr( zclFrameHdr_t *hdr, uint8_t *pData );
 static uint8_t zclCalcHdrSize( zclFrameHdr_t *hdr );
+static ZStatus_t zclSendPrepare( uint8_t srcEP, afAddrType_t *destAddr, uint16_t clusterID, uint8_t cmd,
+                                 uint8_t specific, uint8_t direction, uint8_t disableDefaultRsp,
+                                 uint16_t manuCode, uint8_t seqNum, zclFrameHdr_t *hdr,
+                                 endPointDesc_t **ppEpDesc, uint8_t *pOptions );
+static ZStatus_t zclSendMsg( afAddrType_t *destAddr, endPointDesc_t *epDesc, uint16_t clusterID,
+                             uint16_t msgLen, uint8_t *msgBuf, uint8_t options, uint8_t isReqFromApp );
 static zclLibPlugin_t *zclFindPlugin( uint16_t clusterID, uint16_t profileID );
+static zclHotCache_t *zclGetHotCache( uint8_t endpoint );
+static void zclInvalidateHotCache( uint8_t endpoint, uint8_t flags );
+static uint8_t *zclFindDeviceEnabled( uint8_t endpoint );
 
 #if !defined ( ZCL_STANDALONE )
 static uint8_t zcl_addExternalFoundationHandler( uint8_t taskId, uint8_t endPointId );
@@ -209,9 +262,13 @@ static uint8_t zcl_getExternalFoundationHandler( afIncomingMSGPacket_t *pInMsg )
 
 #if defined ( ZCL_DISCOVER )
   static zclCmdRecsList_t *zclFindCmdRecsList( uint8_t endpoint );
+  static uint8_t *zclBuildCmdIndex( uint8_t numCmds, CONST zclCommandRec_t cmds[] );
+  static uint8_t zclCmdIndexLowerBound( zclCmdRecsList_t *pRec, uint16_t clusterID, uint8_t cmdID );
 #endif
 
 zclAttrRecsList *zclFindAttrRecsList( uint8_t endpoint );
+static uint8_t *zclBuildAttrIndex( uint8_t numAttr, CONST zclAttrRec_t attrs[] );
+static uint8_t zclAttrIndexLowerBound( zclAttrRecsList *pRec, uint16_t clusterID, uint16_t attrId );
 static zclOptionRec_t *zclFindClusterOption( uint8_t endpoint, uint16_t clusterID );
 static uint8_t zclGetClusterOption( uint8_t endpoint, uint16_t clusterID );
 static void zclSetSecurityOption( uint8_t endpoint, uint16_t clusterID, uint8_t enable );
@@ -748,6 +805,13 @@ ZStatus_t zcl_registerPlugin( uint16_t startClusterID,
     pLoop->next = pNewItem;
   }
 
+  // The new plugin may serve the cached cluster
+  {
+    ZCL_HOT_CACHE_LOCK();
+    hotPluginValid = FALSE;
+    ZCL_HOT_CACHE_UNLOCK();
+  }
+
   return ( ZSuccess );
 }
 
@@ -767,6 +831,22 @@ ZStatus_t zcl_registerCmdList( uint8_t endpoint, CONST uint8_t cmdListSize, CONS
   zclCmdRecsList_t *pNewItem;
   zclCmdRecsList_t *pLoop;
 
+  // Re-registering an endpoint replaces its list, and its index
+  pNewItem = zclFindCmdRecsList( endpoint );
+  if ( pNewItem != NULL )
+  {
+    if ( pNewItem->pCmdIndex != NULL )
+    {
+      zcl_mem_free( pNewItem->pCmdIndex );
+    }
+
+    pNewItem->numCommands = cmdListSize;
+    pNewItem->pCmdRecs = newCmdList;
+    pNewItem->pCmdIndex = zclBuildCmdIndex( cmdListSize, newCmdList );
+
+    return ( ZSuccess );
+  }
+
   // Fill in the new profile list
   pNewItem = zcl_mem_alloc( sizeof( zclCmdRecsList_t ) );
   if ( pNewItem == NULL )
@@ -778,6 +858,7 @@ ZStatus_t zcl_registerCmdList( uint8_t endpoint, CONST uint8_t cmdListSize, CONS
   pNewItem->endpoint = endpoint;
   pNewItem->numCommands = cmdListSize;
   pNewItem->pCmdRecs = newCmdList;
+  pNewItem->pCmdIndex = zclBuildCmdIndex( cmdListSize, newCmdList );
 
   // Find spot in list
   if ( gpCmdList == NULL )
@@ -820,6 +901,24 @@ ZStatus_t zcl_registerAttrList( uint8_t endpoint, uint8_t numAttr, CONST zclAttr
   zclAttrRecsList *pNewItem;
   zclAttrRecsList *pLoop;
 
+  // Re-registering an endpoint replaces its list, and its index
+  pNewItem = zclFindAttrRecsList( endpoint );
+  if ( pNewItem != NULL )
+  {
+    if ( pNewItem->attrIndex != NULL )
+    {
+      zcl_mem_free( pNewItem->attrIndex );
+    }
+
+    pNewItem->numAttributes = numAttr;
+    pNewItem->attrs = newAttrList;
+    pNewItem->attrIndex = zclBuildAttrIndex( numAttr, newAttrList );
+
+    zclInvalidateHotCache( endpoint, ZCL_HOT_DEVICE_ENABLED );
+
+    return ( ZSuccess );
+  }
+
   // Fill in the new profile list
   pNewItem = zcl_mem_alloc( sizeof( zclAttrRecsList ) );
   if ( pNewItem == NULL )
@@ -832,6 +931,7 @@ ZStatus_t zcl_registerAttrList( uint8_t endpoint, uint8_t numAttr, CONST zclAttr
   pNewItem->pfnReadWriteCB = NULL;
   pNewItem->numAttributes = numAttr;
   pNewItem->attrs = newAttrList;
+  pNewItem->attrIndex = zclBuildAttrIndex( numAttr, newAttrList );
 
   // Find spot in list
   if ( attrList == NULL )
@@ -851,6 +951,8 @@ ZStatus_t zcl_registerAttrList( uint8_t endpoint, uint8_t numAttr, CONST zclAttr
     pLoop->next = pNewItem;
   }
 
+  zclInvalidateHotCache( endpoint, ZCL_HOT_DEVICE_ENABLED );
+
   return ( ZSuccess );
 }
 
@@ -907,6 +1009,8 @@ ZStatus_t zcl_registerClusterOptionList( uint8_t endpoint, uint8_t numOption, zc
     pLoop->next = pNewItem;
   }
 
+  zclInvalidateHotCache( endpoint, ZCL_HOT_OPTION );
+
   return ( ZSuccess );
 }
 
@@ -981,8 +1085,8 @@ ZStatus_t zcl_registerReadWriteCB( uint8_t endpoint, zclReadWriteCB_t pfnReadWri
 static uint8_t zcl_DeviceOperational( uint8_t srcEP, uint16_t clusterID,
                                     uint8_t frameType, uint8_t cmd, uint16_t profileID )
 {
-  zclAttrRec_t attrRec;
-  uint8_t deviceEnabled = DEVICE_ENABLED; // default value
+  zclHotCache_t *pHot;
+  uint8_t *pDeviceEnabled;
 
   (void)profileID;  // Intentionally unreferenced parameter
 
@@ -1001,15 +1105,116 @@ static uint8_t zcl_DeviceOperational( uint8_t srcEP, uint16_t clusterID,
   }
 
   // Is device enabled?
-  if ( zclFindAttrRec( srcEP, ZCL_CLUSTER_ID_GENERAL_BASIC,
-                       ATTRID_BASIC_DEVICE_ENABLED, &attrRec ) )
   {
+    ZCL_HOT_CACHE_LOCK();
+    pHot = zclGetHotCache( srcEP );
+    if ( !( pHot->flags & ZCL_HOT_DEVICE_ENABLED ) )
+    {
+      pHot->pDeviceEnabled = zclFindDeviceEnabled( srcEP );
+      pHot->flags |= ZCL_HOT_DEVICE_ENABLED;
+    }
+    pDeviceEnabled = pHot->pDeviceEnabled;
+    ZCL_HOT_CACHE_UNLOCK();
+  }
+
+  // Read the attribute itself, the application may change it at any time
+  if ( ( pDeviceEnabled != NULL ) && ( *pDeviceEnabled != DEVICE_ENABLED ) )
+  {
+    return ( FALSE );
+  }
+
+  return ( TRUE );
+}
+
+/*********************************************************************
+ * @fn      zclGetHotCache
+ *
+ * @brief   Get the hot cache entry of an endpoint. An endpoint without
+ *          an entry takes over the oldest one, with nothing cached.
+ *          Must be called with ZCL_HOT_CACHE_LOCK held, and the entry
+ *          only used until ZCL_HOT_CACHE_UNLOCK.
+ *
+ * @param   endpoint - application's endpoint
+ *
+ * @return  pointer to the hot cache entry
+ */
+static zclHotCache_t *zclGetHotCache( uint8_t endpoint )
+{
+  zclHotCache_t *pHot;
+  uint8_t i;
+
+  for ( i = 0; i < ZCL_HOT_CACHE_ENTRIES; i++ )
+  {
+    if ( ( hotCache[i].flags & ZCL_HOT_IN_USE ) && ( hotCache[i].endpoint == endpoint ) )
+    {
+      return ( &hotCache[i] ); // EMBEDDED RETURN
+    }
+  }
+
+  pHot = &hotCache[hotCacheNext];
+  hotCacheNext = ( hotCacheNext + 1 ) % ZCL_HOT_CACHE_ENTRIES;
+
+  pHot->endpoint = endpoint;
+  pHot->flags = ZCL_HOT_IN_USE;
+
+  return ( pHot );
+}
+
+/*********************************************************************
+ * @fn      zclInvalidateHotCache
+ *
+ * @brief   Drop cached lookups of an endpoint, they are redone on the
+ *          next use.
+ *
+ * @param   endpoint - application's endpoint
+ * @param   flags - ZCL_HOT_DEVICE_ENABLED and/or ZCL_HOT_OPTION
+ *
+ * @return  none
+ */
+static void zclInvalidateHotCache( uint8_t endpoint, uint8_t flags )
+{
+  uint8_t i;
+  ZCL_HOT_CACHE_LOCK();
+
+  for ( i = 0; i < ZCL_HOT_CACHE_ENTRIES; i++ )
+  {
+    if ( ( hotCache[i].flags & ZCL_HOT_IN_USE ) && ( hotCache[i].endpoint == endpoint ) )
+    {
+      hotCache[i].flags &= ~flags;
+    }
+  }
+
+  ZCL_HOT_CACHE_UNLOCK();
+}
+
+/*********************************************************************
+ * @fn      zclFindDeviceEnabled
+ *
+ * @brief   Look up the DeviceEnabled attribute data of an endpoint for
+ *          the hot cache. As before the cache, only an attribute with a
+ *          data pointer is read, one kept by the application's read/write
+ *          callback counts as enabled (the callback is not called here,
+ *          this may run in the stack thread).
+ *
+ * @param   endpoint - application's endpoint
+ *
+ * @return  pointer to the attribute data, NULL if there is none
+ */
+static uint8_t *zclFindDeviceEnabled( uint8_t endpoint )
+{
 #ifdef ZCL_READ
-    zclReadAttrData( &deviceEnabled, &attrRec, NULL );
-#endif
+  zclAttrRec_t attrRec;
+
+  if ( zclFindAttrRec( endpoint, ZCL_CLUSTER_ID_GENERAL_BASIC,
+                       ATTRID_BASIC_DEVICE_ENABLED, &attrRec ) )
+  {
+    return ( (uint8_t *)attrRec.attr.dataPtr );
   }
+#else
+  (void)endpoint;  // Intentionally unreferenced parameter
+#endif
 
-  return ( deviceEnabled == DEVICE_ENABLED ? TRUE : FALSE );
+  return ( (uint8_t *)NULL );
 }
 
 /*********************************************************************
@@ -1048,6 +1253,164 @@ ZStatus_t zcl_SendCommandEx( uint8_t srcEP, afAddrType_t *destAddr,
   uint8_t options;
   ZStatus_t status;
 
+  status = zclSendPrepare( srcEP, destAddr, clusterID, cmd, specific, direction,
+                           disableDefaultRsp, manuCode, seqNum, &hdr, &epDesc, &options );
+  if ( status != ZSuccess )
+  {
+    return ( status ); // EMBEDDED RETURN
+  }
+
+  // calculate the needed buffer size
+  msgLen = zclCalcHdrSize( &hdr );
+  msgLen += cmdFormatLen;
+
+  // Allocate the buffer needed
+  msgBuf = zcl_mem_alloc( msgLen );
+  if ( msgBuf != NULL )
+  {
+    // Fill in the ZCL Header
+    pBuf = zclBuildHdr( &hdr, msgBuf );
+
+    // Fill in the command frame
+    zcl_memcpy( pBuf, cmdFormat, cmdFormatLen );
+
+    status = zclSendMsg( destAddr, epDesc, clusterID, msgLen, msgBuf, options, isReqFromApp );
+
+    zcl_mem_free ( msgBuf );
+  }
+  else
+  {
+    status = ZMemError;
+  }
+
+  return ( status );
+}
+
+/*********************************************************************
+ * @fn      zcl_FrameAlloc
+ *
+ * @brief   Allocate a buffer for the payload of a ZCL frame, with room
+ *          in front of it for the ZCL header. The payload can then be
+ *          serialized in place and sent with zcl_SendFrame() without
+ *          being copied into another buffer.
+ *
+ * @param   payloadLen - length of the command payload
+ *
+ * @return  pointer to the payload, NULL if out of memory
+ */
+uint8_t *zcl_FrameAlloc( uint16_t payloadLen )
+{
+  uint8_t *pFrame;
+
+  pFrame = zcl_mem_alloc( ZCL_FRAME_HDR_HEADROOM + payloadLen );
+  if ( pFrame == NULL )
+  {
+    return ( NULL );
+  }
+
+  return ( pFrame + ZCL_FRAME_HDR_HEADROOM );
+}
+
+/*********************************************************************
+ * @fn      zcl_FrameFree
+ *
+ * @brief   Free a buffer allocated with zcl_FrameAlloc().
+ *
+ * @param   pPayload - payload pointer returned by zcl_FrameAlloc()
+ *
+ * @return  none
+ */
+void zcl_FrameFree( uint8_t *pPayload )
+{
+  if ( pPayload != NULL )
+  {
+    zcl_mem_free( pPayload - ZCL_FRAME_HDR_HEADROOM );
+  }
+}
+
+/*********************************************************************
+ * @fn      zcl_SendFrameEx
+ *
+ * @brief   Same as zcl_SendCommandEx(), but for a payload that was
+ *          serialized into a zcl_FrameAlloc() buffer. The ZCL header is
+ *          built in the headroom of the buffer and the frame is passed
+ *          down to AF as is. The buffer is still owned by the caller.
+ *
+ *          NOTE: The calling application is responsible for incrementing
+ *                the Sequence Number.
+ *
+ * @param   srcEp - source endpoint
+ * @param   destAddr - destination address
+ * @param   clusterID - cluster ID
+ * @param   cmd - command ID
+ * @param   specific - whether the command is Cluster Specific
+ * @param   direction - client/server direction of the command
+ * @param   disableDefaultRsp - disable Default Response command
+ * @param   manuCode - manufacturer code for proprietary extensions to a profile
+ * @param   seqNumber - identification number for the transaction
+ * @param   payloadLen - length of the command payload
+ * @param   pPayload - payload pointer returned by zcl_FrameAlloc()
+ * @param   isReqFromApp - Indicates where it comes from application thread or stack thread
+ *
+ * @return  ZSuccess if OK
+ */
+ZStatus_t zcl_SendFrameEx( uint8_t srcEP, afAddrType_t *destAddr,
+                           uint16_t clusterID, uint8_t cmd, uint8_t specific, uint8_t direction,
+                           uint8_t disableDefaultRsp, uint16_t manuCode, uint8_t seqNum,
+                           uint16_t payloadLen, uint8_t *pPayload, uint8_t isReqFromApp )
+{
+  endPointDesc_t *epDesc;
+  zclFrameHdr_t hdr;
+  uint8_t *msgBuf;
+  uint8_t hdrLen;
+  uint8_t options;
+  ZStatus_t status;
+
+  status = zclSendPrepare( srcEP, destAddr, clusterID, cmd, specific, direction,
+                           disableDefaultRsp, manuCode, seqNum, &hdr, &epDesc, &options );
+  if ( status != ZSuccess )
+  {
+    return ( status ); // EMBEDDED RETURN
+  }
+
+  // Fill in the ZCL Header right in front of the payload
+  hdrLen = zclCalcHdrSize( &hdr );
+  msgBuf = pPayload - hdrLen;
+  zclBuildHdr( &hdr, msgBuf );
+
+  return ( zclSendMsg( destAddr, epDesc, clusterID, hdrLen + payloadLen,
+                       msgBuf, options, isReqFromApp ) );
+}
+
+/*********************************************************************
+ * @fn      zclSendPrepare
+ *
+ * @brief   Look up the source endpoint, get the TX options and fill in
+ *          the ZCL header of an outgoing command.
+ *
+ * @param   srcEp - source endpoint
+ * @param   destAddr - destination address
+ * @param   clusterID - cluster ID
+ * @param   cmd - command ID
+ * @param   specific - whether the command is Cluster Specific
+ * @param   direction - client/server direction of the command
+ * @param   disableDefaultRsp - disable Default Response command
+ * @param   manuCode - manufacturer code for proprietary extensions to a profile
+ * @param   seqNumber - identification number for the transaction
+ * @param   hdr - ZCL header to fill in
+ * @param   ppEpDesc - source endpoint descriptor is returned here
+ * @param   pOptions - TX options are returned here
+ *
+ * @return  ZSuccess if the command can be sent
+ */
+static ZStatus_t zclSendPrepare( uint8_t srcEP, afAddrType_t *destAddr, uint16_t clusterID, uint8_t cmd,
+                                 uint8_t specific, uint8_t direction, uint8_t disableDefaultRsp,
+                                 uint16_t manuCode, uint8_t seqNum, zclFrameHdr_t *hdr,
+                                 endPointDesc_t **ppEpDesc, uint8_t *pOptions )
+{
+  endPointDesc_t *epDesc;
+  uint8_t options;
+
   epDesc = afFindEndPointDesc( srcEP );
   if ( epDesc == NULL )
   {
@@ -1078,20 +1441,20 @@ ZStatus_t zcl_SendCommandEx( uint8_t srcEP, afAddrType_t *destAddr,
     }
   }
 
-  zcl_memset( &hdr, 0, sizeof( zclFrameHdr_t ) );
+  zcl_memset( hdr, 0, sizeof( zclFrameHdr_t ) );
 
   // Not Profile wide command (like READ, WRITE)
   if ( specific )
   {
-    hdr.fc.type = ZCL_FRAME_TYPE_SPECIFIC_CMD;
+    hdr->fc.type = ZCL_FRAME_TYPE_SPECIFIC_CMD;
   }
   else
   {
-    hdr.fc.type = ZCL_FRAME_TYPE_PROFILE_CMD;
+    hdr->fc.type = ZCL_FRAME_TYPE_PROFILE_CMD;
   }
 
   if ( ( epDesc->simpleDesc == NULL ) ||
-       ( zcl_DeviceOperational( srcEP, clusterID, hdr.fc.type,
+       ( zcl_DeviceOperational( srcEP, clusterID, hdr->fc.type,
                                 cmd, epDesc->simpleDesc->AppProfId ) == FALSE ) )
   {
     return ( ZFailure ); // EMBEDDED RETURN
@@ -1100,72 +1463,77 @@ ZStatus_t zcl_SendCommandEx( uint8_t srcEP, afAddrType_t *destAddr,
   // Fill in the Maufacturer Code
   if ( manuCode != 0 )
   {
-    hdr.fc.manuSpecific = 1;
-    hdr.manuCode = manuCode;
+    hdr->fc.manuSpecific = 1;
+    hdr->manuCode = manuCode;
   }
 
   // Set the Command Direction
   if ( direction )
   {
-    hdr.fc.direction = ZCL_FRAME_SERVER_CLIENT_DIR;
+    hdr->fc.direction = ZCL_FRAME_SERVER_CLIENT_DIR;
   }
   else
   {
-    hdr.fc.direction = ZCL_FRAME_CLIENT_SERVER_DIR;
+    hdr->fc.direction = ZCL_FRAME_CLIENT_SERVER_DIR;
   }
 
   // Set the Disable Default Response field
   if ( disableDefaultRsp )
   {
-    hdr.fc.disableDefaultRsp = 1;
+    hdr->fc.disableDefaultRsp = 1;
   }
   else
   {
-    hdr.fc.disableDefaultRsp = 0;
+    hdr->fc.disableDefaultRsp = 0;
   }
 
   // Fill in the Transaction Sequence Number
-  hdr.transSeqNum = seqNum;
+  hdr->transSeqNum = seqNum;
 
   // Fill in the command
-  hdr.commandID = cmd;
+  hdr->commandID = cmd;
 
-  // calculate the needed buffer size
-  msgLen = zclCalcHdrSize( &hdr );
-  msgLen += cmdFormatLen;
+  *ppEpDesc = epDesc;
+  *pOptions = options;
 
-  // Allocate the buffer needed
-  msgBuf = zcl_mem_alloc( msgLen );
-  if ( msgBuf != NULL )
-  {
-    // Fill in the ZCL Header
-    pBuf = zclBuildHdr( &hdr, msgBuf );
-
-    // Fill in the command frame
-    zcl_memcpy( pBuf, cmdFormat, cmdFormatLen );
-
-    if(isReqFromApp)
-    {
-      status = zcl_AF_DataRequest( destAddr, epDesc, clusterID, msgLen, msgBuf,
-                               &zcl_TransID, options, zcl_radius );
-    }
-    else
-    {
-      status = AF_DataRequest( destAddr, epDesc, clusterID, msgLen, msgBuf,
-                               &zcl_TransID, options, zcl_radius );
-    }
+  return ( ZSuccess );
+}
 
-    // GP Groupcast Radius was used, reset value to default.
-    if(zcl_radius != AF_DEFAULT_RADIUS)
-    {
-        zcl_radius = AF_DEFAULT_RADIUS;
-    }
+/*********************************************************************
+ * @fn      zclSendMsg
+ *
+ * @brief   Hand a complete ZCL frame to AF.
+ *
+ * @param   destAddr - destination address
+ * @param   epDesc - source endpoint descriptor
+ * @param   clusterID - cluster ID
+ * @param   msgLen - length of the ZCL frame
+ * @param   msgBuf - ZCL frame, header included
+ * @param   options - TX options
+ * @param   isReqFromApp - Indicates where it comes from application thread or stack thread
+ *
+ * @return  ZSuccess if OK
+ */
+static ZStatus_t zclSendMsg( afAddrType_t *destAddr, endPointDesc_t *epDesc, uint16_t clusterID,
+                             uint16_t msgLen, uint8_t *msgBuf, uint8_t options, uint8_t isReqFromApp )
+{
+  ZStatus_t status;
 
-    zcl_mem_free ( msgBuf );
+  if(isReqFromApp)
+  {
+    status = zcl_AF_DataRequest( destAddr, epDesc, clusterID, msgLen, msgBuf,
+                             &zcl_TransID, options, zcl_radius );
   }
   else
   {
-    status = ZMemError;
+    status = AF_DataRequest( destAddr, epDesc, clusterID, msgLen, msgBuf,
+                             &zcl_TransID, options, zcl_radius );
+  }
+
+  // GP Groupcast Radius was used, reset value to default.
+  if(zcl_radius != AF_DEFAULT_RADIUS)
+  {
+      zcl_radius = AF_DEFAULT_RADIUS;
   }
 
   return ( status );
@@ -1197,7 +1565,7 @@ ZStatus_t zcl_SendRead( uint8_t srcEP, afAddrType_t *dstAddr,
 
   dataLen = readCmd->numAttr * 2; // Attribute ID
 
-  buf = zcl_mem_alloc( dataLen );
+  buf = zcl_FrameAlloc( dataLen );
   if ( buf != NULL )
   {
     uint8_t i;
@@ -1210,9 +1578,9 @@ ZStatus_t zcl_SendRead( uint8_t srcEP, afAddrType_t *dstAddr,
       *pBuf++ = HI_UINT16( readCmd->attrID[i] );
     }
 
-    status = zcl_SendCommand( srcEP, dstAddr, clusterID, ZCL_CMD_READ, FALSE,
-                              direction, disableDefaultRsp, 0, seqNum, dataLen, buf );
-    zcl_mem_free( buf );
+    status = zcl_SendFrame( srcEP, dstAddr, clusterID, ZCL_CMD_READ, FALSE,
+                            direction, disableDefaultRsp, 0, seqNum, dataLen, buf );
+    zcl_FrameFree( buf );
   }
   else
   {
@@ -1268,7 +1636,7 @@ ZStatus_t zcl_SendReadRsp( uint8_t srcEP, afAddrType_t *dstAddr,
     }
   }
 
-  buf = zcl_mem_alloc( len );
+  buf = zcl_FrameAlloc( len );
   if ( buf != NULL )
   {
     // Load the buffer - serially
@@ -1302,9 +1670,9 @@ ZStatus_t zcl_SendReadRsp( uint8_t srcEP, afAddrType_t *dstAddr,
       }
     } // for loop
 
-    status = zcl_SendCommand( srcEP, dstAddr, clusterID, ZCL_CMD_READ_RSP, FALSE,
-                              direction, disableDefaultRsp, 0, seqNum, len, buf );
-    zcl_mem_free( buf );
+    status = zcl_SendFrame( srcEP, dstAddr, clusterID, ZCL_CMD_READ_RSP, FALSE,
+                            direction, disableDefaultRsp, 0, seqNum, len, buf );
+    zcl_FrameFree( buf );
   }
   else
   {
@@ -1795,7 +2163,7 @@ ZStatus_t zcl_SendReportCmdEx( uint8_t srcEP, afAddrType_t *dstAddr,
     dataLen += zclGetAttrDataLength( reportRec->dataType, reportRec->attrData );
   }
 
-  buf = zcl_mem_alloc( dataLen );
+  buf = zcl_FrameAlloc( dataLen );
   if ( buf != NULL )
   {
     // Load the buffer - serially
@@ -1811,17 +2179,10 @@ ZStatus_t zcl_SendReportCmdEx( uint8_t srcEP, afAddrType_t *dstAddr,
 
       pBuf = zclSerializeData( reportRec->dataType, reportRec->attrData, pBuf );
     }
-    if(isReqFromApp)
-    {
-      status = zcl_SendCommand( srcEP, dstAddr, clusterID, ZCL_CMD_REPORT, FALSE,
-                                direction, disableDefaultRsp, 0, seqNum, dataLen, buf );
-    }
-    else
-    {
-      status = zcl_StackSendCommand( srcEP, dstAddr, clusterID, ZCL_CMD_REPORT, FALSE,
-                                direction, disableDefaultRsp, 0, seqNum, dataLen, buf );
-    }
-    zcl_mem_free( buf );
+
+    status = zcl_SendFrameEx( srcEP, dstAddr, clusterID, ZCL_CMD_REPORT, FALSE,
+                              direction, disableDefaultRsp, 0, seqNum, dataLen, buf, isReqFromApp );
+    zcl_FrameFree( buf );
   }
   else
   {
@@ -2518,19 +2879,35 @@ static zclLibPlugin_t *zclFindPlugin( uint16_t clusterID, uint16_t profileID )
 {
   zclLibPlugin_t *pLoop = plugins;
 
+  ZCL_HOT_CACHE_LOCK();
+
   (void)profileID;  // Intentionally unreferenced parameter
 
-  while ( pLoop != NULL )
+  // Consecutive frames are mostly for the same cluster
+  if ( hotPluginValid && ( hotPluginClusterID == clusterID ) )
   {
-    if ( ( clusterID >= pLoop->startClusterID ) && ( clusterID <= pLoop->endClusterID ) )
+    pLoop = hotPlugin;
+  }
+  else
+  {
+    while ( pLoop != NULL )
     {
-      return ( pLoop );
+      if ( ( clusterID >= pLoop->startClusterID ) && ( clusterID <= pLoop->endClusterID ) )
+      {
+        break;
+      }
+
+      pLoop = pLoop->next;
     }
 
-    pLoop = pLoop->next;
+    hotPlugin = pLoop;
+    hotPluginClusterID = clusterID;
+    hotPluginValid = TRUE;
   }
 
-  return ( (zclLibPlugin_t *)NULL );
+  ZCL_HOT_CACHE_UNLOCK();
+
+  return ( pLoop );
 }
 
 #ifdef ZCL_DISCOVER
@@ -2577,7 +2954,21 @@ uint8_t zclFindCmdRec( uint8_t endpoint, uint16_t clusterID, uint8_t cmdID, zclC
   uint8_t i;
   zclCmdRecsList_t *pRec = zclFindCmdRecsList( endpoint );
 
-  if ( pRec != NULL )
+  if ( pRec != NULL && pRec->pCmdIndex != NULL )
+  {
+    i = zclCmdIndexLowerBound( pRec, clusterID, cmdID );
+    if ( i < pRec->numCommands )
+    {
+      i = pRec->pCmdIndex[i];
+      if ( pRec->pCmdRecs[i].clusterID == clusterID && pRec->pCmdRecs[i].cmdID == cmdID )
+      {
+        *pCmd = pRec->pCmdRecs[i];
+
+        return ( TRUE ); // EMBEDDED RETURN
+      }
+    }
+  }
+  else if ( pRec != NULL )
   {
     for ( i = 0; i < pRec->numCommands; i++ )
     {
@@ -2592,6 +2983,86 @@ uint8_t zclFindCmdRec( uint8_t endpoint, uint16_t clusterID, uint8_t cmdID, zclC
 
   return ( FALSE );
 }
+
+/*********************************************************************
+ * @fn      zclBuildCmdIndex
+ *
+ * @brief   Build the sorted index of a command record list, ordered by
+ *          cluster ID then command ID (stable for equal IDs).
+ *
+ * @param   numCmds - number of commands in list
+ * @param   cmds - array of command records
+ *
+ * @return  pointer to the index, NULL if not enough memory
+ */
+static uint8_t *zclBuildCmdIndex( uint8_t numCmds, CONST zclCommandRec_t cmds[] )
+{
+  uint8_t *pIndex;
+  uint32_t key;
+  uint8_t i, j, x;
+
+  pIndex = zcl_mem_alloc( numCmds ? numCmds : 1 );
+  if ( pIndex == NULL )
+  {
+    return ( NULL );
+  }
+
+  for ( i = 0; i < numCmds; i++ )
+  {
+    key = ZCL_ATTR_INDEX_KEY( cmds[i].clusterID, cmds[i].cmdID );
+
+    for ( j = i; j > 0; j-- )
+    {
+      x = pIndex[j - 1];
+      if ( ZCL_ATTR_INDEX_KEY( cmds[x].clusterID, cmds[x].cmdID ) <= key )
+      {
+        break;
+      }
+      pIndex[j] = x;
+    }
+    pIndex[j] = i;
+  }
+
+  return ( pIndex );
+}
+
+/*********************************************************************
+ * @fn      zclCmdIndexLowerBound
+ *
+ * @brief   Binary search the sorted index of a command record list.
+ *
+ * @param   pRec - command record list, with pCmdIndex built
+ * @param   clusterID - cluster ID
+ * @param   cmdID - command ID
+ *
+ * @return  position in pCmdIndex of the first record not lower than
+ *          clusterID/cmdID, numCommands if there is none
+ */
+static uint8_t zclCmdIndexLowerBound( zclCmdRecsList_t *pRec, uint16_t clusterID, uint8_t cmdID )
+{
+  uint32_t key = ZCL_ATTR_INDEX_KEY( clusterID, cmdID );
+  uint16_t lo = 0;
+  uint16_t hi = pRec->numCommands;
+  uint16_t mid;
+  CONST zclCommandRec_t *pCmd;
+
+  while ( lo < hi )
+  {
+    mid = (lo + hi) >> 1;
+    pCmd = &pRec->pCmdRecs[pRec->pCmdIndex[mid]];
+
+    if ( ZCL_ATTR_INDEX_KEY( pCmd->clusterID, pCmd->cmdID ) < key )
+    {
+      lo = mid + 1;
+    }
+    else
+    {
+      hi = mid;
+    }
+  }
+
+  return ( (uint8_t)lo );
+}
 #endif // ZCL_DISCOVER
 
 /*********************************************************************
@@ -2637,7 +3108,21 @@ uint8_t zclFindAttrRec( uint8_t endpoint, uint16_t clusterID, uint16_t attrId, z
   uint8_t x;
   zclAttrRecsList *pRec = zclFindAttrRecsList( endpoint );
 
-  if ( pRec != NULL )
+  if ( pRec != NULL && pRec->attrIndex != NULL )
+  {
+    x = zclAttrIndexLowerBound( pRec, clusterID, attrId );
+    if ( x < pRec->numAttributes )
+    {
+      x = pRec->attrIndex[x];
+      if ( pRec->attrs[x].clusterID == clusterID && pRec->attrs[x].attr.attrId == attrId )
+      {
+        *pAttr = pRec->attrs[x];
+
+        return ( TRUE ); // EMBEDDED RETURN
+      }
+    }
+  }
+  else if ( pRec != NULL )
   {
     for ( x = 0; x < pRec->numAttributes; x++ )
     {
@@ -2653,6 +3138,88 @@ uint8_t zclFindAttrRec( uint8_t endpoint, uint16_t clusterID, uint16_t attrId, z
   return ( FALSE );
 }
 
+/*********************************************************************
+ * @fn      zclBuildAttrIndex
+ *
+ * @brief   Build the sorted index of an attribute record list. Records
+ *          are ordered by cluster ID then attribute ID; records with the
+ *          same IDs keep their list order (insertion sort is stable), so
+ *          lookups return the same record as a linear search.
+ *
+ * @param   numAttr - number of attributes in list
+ * @param   attrs - array of attribute records
+ *
+ * @return  pointer to the index, NULL if not enough memory
+ */
+static uint8_t *zclBuildAttrIndex( uint8_t numAttr, CONST zclAttrRec_t attrs[] )
+{
+  uint8_t *pIndex;
+  uint32_t key;
+  uint8_t i, j, x;
+
+  pIndex = zcl_mem_alloc( numAttr ? numAttr : 1 );
+  if ( pIndex == NULL )
+  {
+    return ( NULL );
+  }
+
+  for ( i = 0; i < numAttr; i++ )
+  {
+    key = ZCL_ATTR_INDEX_KEY( attrs[i].clusterID, attrs[i].attr.attrId );
+
+    for ( j = i; j > 0; j-- )
+    {
+      x = pIndex[j - 1];
+      if ( ZCL_ATTR_INDEX_KEY( attrs[x].clusterID, attrs[x].attr.attrId ) <= key )
+      {
+        break;
+      }
+      pIndex[j] = x;
+    }
+    pIndex[j] = i;
+  }
+
+  return ( pIndex );
+}
+
+/*********************************************************************
+ * @fn      zclAttrIndexLowerBound
+ *
+ * @brief   Binary search the sorted index of an attribute record list.
+ *
+ * @param   pRec - attribute record list, with attrIndex built
+ * @param   clusterID - cluster ID
+ * @param   attrId - attribute ID
+ *
+ * @return  position in attrIndex of the first record not lower than
+ *          clusterID/attrId, numAttributes if there is none
+ */
+static uint8_t zclAttrIndexLowerBound( zclAttrRecsList *pRec, uint16_t clusterID, uint16_t attrId )
+{
+  uint32_t key = ZCL_ATTR_INDEX_KEY( clusterID, attrId );
+  uint16_t lo = 0;
+  uint16_t hi = pRec->numAttributes;
+  uint16_t mid;
+  CONST zclAttrRec_t *pAttr;
+
+  while ( lo < hi )
+  {
+    mid = (lo + hi) >> 1;
+    pAttr = &pRec->attrs[pRec->attrIndex[mid]];
+
+    if ( ZCL_ATTR_INDEX_KEY( pAttr->clusterID, pAttr->attr.attrId ) < key )
+    {
+      lo = mid + 1;
+    }
+    else
+    {
+      hi = mid;
+    }
+  }
+
+  return ( (uint8_t)lo );
+}
+
 #if defined ( ZCL_STANDALONE )
 /*********************************************************************
  * @fn      zclSetAttrRecList
@@ -2675,8 +3242,17 @@ uint8_t zclSetAttrRecList( uint8_t endpoint, uint8_t numAttr, CONST zclAttrRec_t
 
   if ( pRecsList != NULL )
   {
+    if ( pRecsList->attrIndex != NULL )
+    {
+      zcl_mem_free( pRecsList->attrIndex );
+    }
+
     pRecsList->numAttributes = numAttr;
     pRecsList->attrs = attrList;
+    pRecsList->attrIndex = zclBuildAttrIndex( numAttr, attrList );
+
+    zclInvalidateHotCache( endpoint, ZCL_HOT_DEVICE_ENABLED );
+
     return ( TRUE );
   }
 
@@ -2777,14 +3353,26 @@ static zclOptionRec_t *zclFindClusterOption( uint8_t endpoint, uint16_t clusterI
  */
 static uint8_t zclGetClusterOption( uint8_t endpoint, uint16_t clusterID )
 {
-  uint8_t option;
+  zclHotCache_t *pHot;
   zclOptionRec_t *pOption;
 
-  pOption = zclFindClusterOption( endpoint, clusterID );
+  // The record is cached rather than the option, which may still change
+  {
+    ZCL_HOT_CACHE_LOCK();
+    pHot = zclGetHotCache( endpoint );
+    if ( !( pHot->flags & ZCL_HOT_OPTION ) || ( pHot->optionClusterID != clusterID ) )
+    {
+      pHot->pOption = zclFindClusterOption( endpoint, clusterID );
+      pHot->optionClusterID = clusterID;
+      pHot->flags |= ZCL_HOT_OPTION;
+    }
+    pOption = pHot->pOption;
+    ZCL_HOT_CACHE_UNLOCK();
+  }
+
   if ( pOption != NULL )
   {
-    option = pOption->option;
-    return ( option ); // EMBEDDED RETURN
+    return ( pOption->option ); // EMBEDDED RETURN
   }
 
   return ( AF_TX_OPTIONS_NONE );
@@ -2838,63 +3426,68 @@ static uint8_t zclFindNextCmdRec( uint8_t endpoint, uint16_t clusterID, uint8_t
                                 uint8_t direction, uint8_t *pCmdID, zclCommandRec_t *pCmd )
 {
   zclCmdRecsList_t *pRec = zclFindCmdRecsList( endpoint );
+  uint16_t found = 0xFFFF;
+  uint16_t n;
   uint8_t i;
+  uint8_t flag;
+  uint8_t match;
 
   if ( pRec != NULL )
   {
-    for ( i = 0; i < pRec->numCommands; i++ )
+    // The index narrows the search to this cluster's records from *pCmdID
+    // on; of those, the first in list order is returned, as without it.
+    n = ( pRec->pCmdIndex != NULL ) ? zclCmdIndexLowerBound( pRec, clusterID, *pCmdID ) : 0;
+
+    for ( ; n < pRec->numCommands; n++ )
     {
+      i = ( pRec->pCmdIndex != NULL ) ? pRec->pCmdIndex[n] : (uint8_t)n;
+
+      if ( ( pRec->pCmdIndex != NULL ) && ( pRec->pCmdRecs[i].clusterID != clusterID ) )
+      {
+        break;
+      }
+
       if ( ( pRec->pCmdRecs[i].clusterID == clusterID ) &&
           ( pRec->pCmdRecs[i].cmdID >= *pCmdID ) )
       {
+        flag = pRec->pCmdRecs[i].flag;
+
         if ( commandID == ZCL_CMD_DISCOVER_CMDS_RECEIVED )
         {
-          if ( ( direction == ZCL_FRAME_SERVER_CLIENT_DIR ) && ( pRec->pCmdRecs[i].flag & CMD_DIR_CLIENT_RECEIVED ) )
-          {
-            *pCmd = pRec->pCmdRecs[i];
-
-            // Update command ID
-            *pCmdID = pCmd->cmdID;
-
-            return ( TRUE ); // EMBEDDED RETURN
-          }
-          else if ( ( direction == ZCL_FRAME_CLIENT_SERVER_DIR ) && ( pRec->pCmdRecs[i].flag & CMD_DIR_SERVER_RECEIVED ) )
-          {
-            *pCmd = pRec->pCmdRecs[i];
-
-            // Update command ID
-            *pCmdID = pCmd->cmdID;
-
-            return ( TRUE ); // EMBEDDED RETURN
-          }
+          match = ( ( direction == ZCL_FRAME_SERVER_CLIENT_DIR ) && ( flag & CMD_DIR_CLIENT_RECEIVED ) ) ||
+                  ( ( direction == ZCL_FRAME_CLIENT_SERVER_DIR ) && ( flag & CMD_DIR_SERVER_RECEIVED ) );
         }
         else if ( commandID == ZCL_CMD_DISCOVER_CMDS_GEN )
         {
-          if ( ( direction == ZCL_FRAME_CLIENT_SERVER_DIR ) && ( pRec->pCmdRecs[i].flag & CMD_DIR_SERVER_GENERATED ) )
-          {
-            *pCmd = pRec->pCmdRecs[i];
-
-            // Update command ID
-            *pCmdID = pCmd->cmdID;
-
-            return ( TRUE ); // EMBEDDED RETURN
-          }
-          else if ( ( direction == ZCL_FRAME_SERVER_CLIENT_DIR ) && ( pRec->pCmdRecs[i].flag & CMD_DIR_CLIENT_GENERATED ) )
-          {
-            *pCmd = pRec->pCmdRecs[i];
-
-            // Update command ID
-            *pCmdID = pCmd->cmdID;
-
-            return ( TRUE ); // EMBEDDED RETURN
-          }
+          match = ( ( direction == ZCL_FRAME_CLIENT_SERVER_DIR ) && ( flag & CMD_DIR_SERVER_GENERATED ) ) ||
+                  ( ( direction == ZCL_FRAME_SERVER_CLIENT_DIR ) && ( flag & CMD_DIR_CLIENT_GENERATED ) );
         }
         else
         {
           return ( FALSE ); // Incorrect Command ID
         }
+
+        if ( match && ( i < found ) )
+        {
+          found = i;
+
+          if ( pRec->pCmdIndex == NULL )
+          {
+            break; // list order, the first match is the one
+          }
+        }
       }
     }
+
+    if ( found != 0xFFFF )
+    {
+      *pCmd = pRec->pCmdRecs[found];
+
+      // Update command ID
+      *pCmdID = pCmd->cmdID;
+
+      return ( TRUE );
+    }
   }
 
   return ( FALSE );
@@ -2915,29 +3508,52 @@ static uint8_t zclFindNextAttrRec( uint8_t endpoint, uint16_t clusterID, uint8_t
                                  uint16_t *attrId, zclAttrRec_t *pAttr )
 {
   zclAttrRecsList *pRec = zclFindAttrRecsList( endpoint );
+  uint16_t found = 0xFFFF;
+  uint16_t i;
+  uint8_t x;
   uint8_t attrDir;
 
   if ( pRec != NULL )
   {
-    uint16_t x;
+    // The index narrows the search to this cluster's records from *attrId
+    // on; of those, the first in list order is returned, as without it.
+    i = ( pRec->attrIndex != NULL ) ? zclAttrIndexLowerBound( pRec, clusterID, *attrId ) : 0;
 
-    for ( x = 0; x < pRec->numAttributes; x++ )
+    for ( ; i < pRec->numAttributes; i++ )
     {
+      x = ( pRec->attrIndex != NULL ) ? pRec->attrIndex[i] : (uint8_t)i;
+
+      if ( ( pRec->attrIndex != NULL ) && ( pRec->attrs[x].clusterID != clusterID ) )
+      {
+        break;
+      }
+
       if ( ( pRec->attrs[x].clusterID == clusterID ) &&
            ( pRec->attrs[x].attr.attrId >= *attrId ) )
       {
         // also make sure direction is right
         attrDir = (pRec->attrs[x].attr.accessControl & ACCESS_CLIENT) ? 1 : 0;
-        if ( (attrDir == direction) || (pRec->attrs[x].attr.accessControl & ACCESS_GLOBAL))
+        if ( ( (attrDir == direction) || (pRec->attrs[x].attr.accessControl & ACCESS_GLOBAL) ) &&
+             ( x < found ) )
         {
-          // return attribute and found attribute ID
-          *pAttr = pRec->attrs[x];
-          *attrId = pAttr->attr.attrId;
+          found = x;
 
-          return ( TRUE ); // EMBEDDED RETURN
+          if ( pRec->attrIndex == NULL )
+          {
+            break; // list order, the first match is the one
+          }
         }
       }
     }
+
+    if ( found != 0xFFFF )
+    {
+      // return attribute and found attribute ID
+      *pAttr = pRec->attrs[found];
+      *attrId = pAttr->attr.attrId;
+
+      return ( TRUE );
+    }
   }
 
   return ( FALSE );
@@ -1194,6 +1194,7 @@ typedef struct zclAttrRecsList
   zclAuthorizeCB_t       pfnAuthorizeCB;//!< Authorize Read or Write operation
   uint8_t                  numAttributes; //!< Number of the following records
   CONST zclAttrRec_t     *attrs;        //!< attribute records
+  uint8_t                 *attrIndex;    //!< attrs indexes sorted by cluster ID and attribute ID, NULL if not built
 } zclAttrRecsList;
 /** @} End ZCL_TYPEDEFS */
 
@@ -1250,6 +1251,26 @@ extern uint8_t zcl_radius;
  */
 #define zcl_StackSendCommand(a,b,c,d,e,f,g,h,i,j,k)   (zcl_SendCommandEx(a,b,c,d,e,f,g,h,i,j,k,FALSE))
 
+/*
+ *  @brief Send a ZCL Command, serialized into a zcl_FrameAlloc() buffer, from application thread
+ *  Use like:
+ *      ZStatus_t zcl_SendFrame( uint8_t srcEP, afAddrType_t *dstAddr,
+ *                               uint16_t clusterID, uint8_t cmd, uint8_t specific, uint8_t direction,
+ *                               uint8_t disableDefaultRsp, uint16_t manuCode, uint8_t seqNum,
+ *                               uint16_t payloadLen, uint8_t *pPayload );
+ */
+#define zcl_SendFrame(a,b,c,d,e,f,g,h,i,j,k)          (zcl_SendFrameEx(a,b,c,d,e,f,g,h,i,j,k,TRUE))
+
+/*
+ *  @brief Send a ZCL Command, serialized into a zcl_FrameAlloc() buffer, from Stack thread
+ *  Use like:
+ *      ZStatus_t zcl_StackSendFrame( uint8_t srcEP, afAddrType_t *dstAddr,
+ *                               uint16_t clusterID, uint8_t cmd, uint8_t specific, uint8_t direction,
+ *                               uint8_t disableDefaultRsp, uint16_t manuCode, uint8_t seqNum,
+ *                               uint16_t payloadLen, uint8_t *pPayload );
+ */
+#define zcl_StackSendFrame(a,b,c,d,e,f,g,h,i,j,k)     (zcl_SendFrameEx(a,b,c,d,e,f,g,h,i,j,k,FALSE))
+
 #ifdef ZCL_REPORTING_DEVICE
 
 /*
@@ -1516,6 +1537,51 @@ extern ZStatus_t zcl_SendCommandEx( uint8_t srcEP, afAddrType_t *dstAddr,
                                   uint8_t disableDefaultRsp, uint16_t manuCode, uint8_t seqNum,
                                   uint16_t cmdFormatLen, uint8_t *cmdFormat, uint8_t isReqFromApp  );
 
+/*!
+ *  Allocate a buffer for the payload of a ZCL frame, with headroom for
+ *  the ZCL header, so that it can be sent with zcl_SendFrame() without
+ *  being copied.
+ *
+ * @param   payloadLen - length of the command payload
+ *
+ * @return  pointer to the payload, NULL if out of memory
+ */
+extern uint8_t *zcl_FrameAlloc( uint16_t payloadLen );
+
+/*!
+ *  Free a buffer allocated with zcl_FrameAlloc().
+ *
+ * @param   pPayload - payload pointer returned by zcl_FrameAlloc()
+ */
+extern void zcl_FrameFree( uint8_t *pPayload );
+
+/*!
+ *  Send a command serialized into a zcl_FrameAlloc() buffer. The ZCL
+ *  header is built in place in front of the payload.
+ *
+ *          NOTE: The calling application is responsible for incrementing
+ *                the Sequence Number.
+ *
+ * @param   srcEP - source endpoint
+ * @param   dstAddr - destination address
+ * @param   clusterID - cluster ID
+ * @param   cmd - command ID
+ * @param   specific - whether the command is Cluster Specific
+ * @param   direction - client/server direction of the command
+ * @param   disableDefaultRsp - disable Default Response command
+ * @param   manuCode - manufacturer code for proprietary extensions to a profile
+ * @param   seqNum - identification number for the transaction
+ * @param   payloadLen - length of the command payload
+ * @param   pPayload - payload pointer returned by zcl_FrameAlloc()
+ * @param   isReqFromApp - Indicates where it comes from application thread or stack thread
+ *
+ * @return  ZSuccess if OK
+ */
+extern ZStatus_t zcl_SendFrameEx( uint8_t srcEP, afAddrType_t *dstAddr,
+                                  uint16_t clusterID, uint8_t cmd, uint8_t specific, uint8_t direction,
+                                  uint8_t disableDefaultRsp, uint16_t manuCode, uint8_t seqNum,
+                                  uint16_t payloadLen, uint8_t *pPayload, uint8_t isReqFromApp );
+
 #ifdef ZCL_READ
 /*!
  *
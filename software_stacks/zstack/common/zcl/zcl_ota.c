@@ -84,6 +84,32 @@
 #define ZCL_OTA_HDR_LEN_OFFSET      6  // Header length location in OTA upgrade image
 #define ZCL_OTA_STK_VER_OFFSET      18 // Stack version location in OTA upgrade image
 #define ZCL_OTA_DL_CRC_OFFSET       62
+#define ZCL_OTA_IMG_SIZE_OFFSET     52 // Total image size location in OTA upgrade image
+
+// Image data is buffered in RAM and programmed in aligned chunks of this
+// size. Must be a power of 2 that divides the flash page size.
+#if !defined OTA_WRITE_BUF_LEN
+  #define OTA_WRITE_BUF_LEN         256
+#endif
+
+#if defined OTA_SERVER_BLOCK_CACHE
+// Image data is cached by the server in pages of this size, must be a power of 2
+#if !defined OTA_CACHE_PAGE_SIZE
+  #define OTA_CACHE_PAGE_SIZE       256
+#endif
+
+// Number of cached pages, shared by all clients. With fewer than two pages
+// per client downloading at once, pages are evicted between the requests of
+// a client and each miss reads a whole page for one block.
+#if !defined OTA_CACHE_NUM_PAGES
+  #define OTA_CACHE_NUM_PAGES       4
+#endif
+
+// Number of clients whose download progress is tracked
+#if !defined OTA_CACHE_NUM_SESSIONS
+  #define OTA_CACHE_NUM_SESSIONS    8
+#endif
+#endif // OTA_SERVER_BLOCK_CACHE
 
 
 /******************************************************************************
@@ -141,6 +167,28 @@ uint8_t oadPdState = 0;
 static uint8_t zclOTA_SeqNo = 0;
 #endif
 
+#if (defined OTA_SERVER) && (defined OTA_SERVER_BLOCK_CACHE)
+// Cached image page
+typedef struct
+{
+  zclOTA_FileID_t fileId;
+  uint32_t offset;                      // Page aligned file offset
+  uint16_t len;                         // Bytes read, 0 if unused
+  uint32_t lastUsed;                    // Use count of the last access
+  uint8_t  data[OTA_CACHE_PAGE_SIZE];
+} zclOTA_CachePage_t;
+
+static zclOTA_ImageReadCB_t zclOTA_ImageReadCB = NULL;
+// One page more than the cache holds: a miss is read into the spare page,
+// which only replaces the victim once the read succeeded
+static zclOTA_CachePage_t zclOTA_CachePageStore[OTA_CACHE_NUM_PAGES + 1];
+static zclOTA_CachePage_t *zclOTA_CachePages[OTA_CACHE_NUM_PAGES];
+static zclOTA_CachePage_t *zclOTA_CacheSpare;
+static zclOTA_ServerSession_t zclOTA_Sessions[OTA_CACHE_NUM_SESSIONS];
+static zclOTA_ServerCacheStats_t zclOTA_CacheStats;
+static uint32_t zclOTA_CacheUseCount = 0;
+#endif
+
 #if defined OTA_MMO_SIGN
 static OTA_MmoCtrl_t zclOTA_MmoHash;
 static uint8_t zclOTA_DataToHash[OTA_MMO_HASH_SIZE];
@@ -166,6 +214,11 @@ static const uint8_t zclOTA_HdrMagic[] = {0x1E, 0xF1, 0xEE, 0x0B};
 
 imgHdr_t oad_imgHdr = {0};
 uint16_t   oad_imgHdr_pos = 0;
+
+// Image data not programmed yet, starting at flash offset zclOTA_WriteBufAddr
+static uint8_t  zclOTA_WriteBuf[OTA_WRITE_BUF_LEN];
+static uint16_t zclOTA_WriteBufLen = 0;
+static uint32_t zclOTA_WriteBufAddr;
 #endif // (defined OTA_CLIENT_STANDALONE) || (defined OTA_CLIENT_INTEGRATED
 
 /******************************************************************************
@@ -177,9 +230,24 @@ static uint8_t* buffer_uint32( uint8_t *buf, uint32_t val );
 #endif
 #endif
 
+#if (defined OTA_SERVER) && (defined OTA_SERVER_BLOCK_CACHE)
+static uint8_t zclOTA_SameFile( zclOTA_FileID_t *pFileId1, zclOTA_FileID_t *pFileId2 );
+static zclOTA_CachePage_t *zclOTA_CacheGetPage( zclOTA_FileID_t *pFileId, uint32_t offset, uint8_t prefetch );
+static uint32_t zclOTA_CacheImageSize( zclOTA_FileID_t *pFileId, uint8_t read );
+static uint8_t zclOTA_SameClient( afAddrType_t *pAddr1, afAddrType_t *pAddr2 );
+static zclOTA_ServerSession_t *zclOTA_CacheFindSession( afAddrType_t *clientAddr, uint8_t create );
+#endif
+
 #if (defined OTA_CLIENT_STANDALONE) || (defined OTA_CLIENT_INTEGRATED)
 static uint8_t oadEraseExtFlashPages(uint8_t imgStartPage, uint8_t imgPageLen);
 static uint8_t oadCheckDL(uint8_t imagePage);
+static uint8_t zclOTA_ProcessImageBytes(uint8_t *pData, uint8_t len);
+static uint8_t zclOTA_WriteImage(uint32_t addr, uint8_t *pData, uint32_t len);
+static uint8_t zclOTA_FlushImage(void);
+static uint8_t zclOTA_CheckImage(void);
+#if defined OTA_MMO_SIGN
+static void zclOTA_HashData(uint8_t *pData, uint16_t len);
+#endif
 #endif
 
 /******************************************************************************
@@ -227,7 +295,9 @@ void zclOTA_ProcessUnhandledFoundationZCLMsgs ( zclIncomingMsg_t *pMsg )
   switch ( pMsg->zclHdr.commandID )
   {
     case ZCL_CMD_DEFAULT_RSP:
+#if (defined OTA_CLIENT_STANDALONE) || (defined OTA_CLIENT_INTEGRATED)
       zclOTA_ProcessInDefaultRspCmd( pMsg );
+#endif
       break;
     default :
       break;
@@ -474,6 +544,410 @@ ZStatus_t zclOTA_SendQuerySpecificFileRsp (uint8_t srcEp, afAddrType_t *dstAddr,
 
   return status;
 }
+#if defined OTA_SERVER_BLOCK_CACHE
+/******************************************************************************
+ * @fn      zclOTA_ServerCacheInit
+ *
+ * @brief   Set the image store read function and empty the block cache
+ *          and the client sessions. Must be called again when an image
+ *          in the store changes.
+ *
+ * @param   pfnReadCB - image store read function
+ *
+ * @return  none
+ */
+void zclOTA_ServerCacheInit( zclOTA_ImageReadCB_t pfnReadCB )
+{
+  uint8_t i;
+
+  zclOTA_ImageReadCB = pfnReadCB;
+
+  memset( zclOTA_CachePageStore, 0, sizeof( zclOTA_CachePageStore ) );
+  for ( i = 0; i < OTA_CACHE_NUM_PAGES; i++ )
+  {
+    zclOTA_CachePages[i] = &zclOTA_CachePageStore[i];
+  }
+  zclOTA_CacheSpare = &zclOTA_CachePageStore[OTA_CACHE_NUM_PAGES];
+  memset( zclOTA_Sessions, 0, sizeof( zclOTA_Sessions ) );
+  memset( &zclOTA_CacheStats, 0, sizeof( zclOTA_CacheStats ) );
+  zclOTA_CacheUseCount = 0;
+}
+
+/******************************************************************************
+ * @fn      zclOTA_ServerSendImageBlock
+ *
+ * @brief   Answer an Image Block Request from the block cache. The block
+ *          is sent straight from its cached page, which is read from the
+ *          image store on a miss. A block ends at the end of its page,
+ *          the client requests the rest with its next request. Once a
+ *          client is past the middle of a page, the next page is read
+ *          ahead so that its following requests are hits. Reading ahead
+ *          stops at the end of the image, and is skipped when there are
+ *          too many sessions for every one to keep two pages, it would
+ *          only evict pages of other clients.
+ *
+ * @param   srcEp   - endpoint from which the message is send
+ * @param   dstAddr - address of the requesting client
+ * @param   pReq    - Image Block Request parameters
+ * @param   transSeqNum - Transaction Sequence Number of the request
+ *
+ * @return  ZStatus_t
+ */
+ZStatus_t zclOTA_ServerSendImageBlock( uint8_t srcEp, afAddrType_t *dstAddr,
+                                       zclOTA_ImageBlockReqParams_t *pReq, uint8_t transSeqNum )
+{
+  zclOTA_ImageBlockRspParams_t rsp;
+  zclOTA_CachePage_t *pPage;
+  zclOTA_ServerSession_t *pSession;
+  uint32_t pageOffset;
+  uint32_t nextOffset;
+  uint16_t pos;
+  uint16_t dataSize;
+  uint8_t readAhead;
+  uint8_t numSessions = 0;
+  uint8_t i;
+  ZStatus_t status;
+
+  pPage = zclOTA_CacheGetPage( &pReq->fileId, pReq->fileOffset, FALSE );
+  pos = ( uint16_t ) ( pReq->fileOffset & ( OTA_CACHE_PAGE_SIZE - 1 ) );
+
+  if ( ( pPage == NULL ) || ( pos >= pPage->len ) )
+  {
+    // Image could not be read or offset is past its end
+    rsp.status = ZCL_STATUS_ABORT;
+    return ( zclOTA_SendImageBlockRsp ( srcEp, dstAddr, &rsp, transSeqNum ) );
+  }
+
+  dataSize = pPage->len - pos;
+  if ( dataSize > pReq->maxDataSize )
+  {
+    dataSize = pReq->maxDataSize;
+  }
+
+  rsp.status = ZCL_STATUS_SUCCESS;
+  rsp.rsp.success.fileId = pReq->fileId;
+  rsp.rsp.success.fileOffset = pReq->fileOffset;
+  rsp.rsp.success.dataSize = ( uint8_t ) dataSize;
+  rsp.rsp.success.pData = &pPage->data[pos];
+
+  status = zclOTA_SendImageBlockRsp ( srcEp, dstAddr, &rsp, transSeqNum );
+
+  // Only the last page of an image is shorter than a full page
+  pageOffset = pPage->offset;
+  readAhead = ( pPage->len == OTA_CACHE_PAGE_SIZE ) &&
+              ( pos + dataSize >= OTA_CACHE_PAGE_SIZE / 2 );
+
+  if ( status == ZSuccess )
+  {
+    pSession = zclOTA_CacheFindSession( dstAddr, TRUE );
+    if ( ( pSession->imageSize == 0 ) || !zclOTA_SameFile( &pSession->fileId, &pReq->fileId ) )
+    {
+      pSession->fileId = pReq->fileId;
+      pSession->imageSize = zclOTA_CacheImageSize( &pReq->fileId, FALSE );
+    }
+    pSession->fileOffset = pReq->fileOffset + dataSize;
+    pSession->blocksSent++;
+    pSession->lastUsed = zclOTA_CacheUseCount;
+
+    for ( i = 0; i < OTA_CACHE_NUM_SESSIONS; i++ )
+    {
+      if ( zclOTA_Sessions[i].blocksSent != 0 )
+      {
+        numSessions++;
+      }
+    }
+
+    if ( readAhead && ( numSessions * 2 <= OTA_CACHE_NUM_PAGES ) )
+    {
+      // The size is read from the store only when it is needed here, not
+      // for every session that starts without the first page cached
+      if ( pSession->imageSize == 0 )
+      {
+        pSession->imageSize = zclOTA_CacheImageSize( &pReq->fileId, TRUE );
+      }
+
+      // Nothing to read ahead past the end of the image, or if its size is unknown
+      nextOffset = pageOffset + OTA_CACHE_PAGE_SIZE;
+      if ( nextOffset < pSession->imageSize )
+      {
+        (void)zclOTA_CacheGetPage( &pReq->fileId, nextOffset, TRUE );
+      }
+    }
+  }
+
+  return status;
+}
+
+/******************************************************************************
+ * @fn      zclOTA_ServerGetSession
+ *
+ * @brief   Get the download progress of a client.
+ *
+ * @param   clientAddr - address of the client, its mode and address are used
+ *
+ * @return  pointer to the session, NULL if the client has none
+ */
+zclOTA_ServerSession_t *zclOTA_ServerGetSession( afAddrType_t *clientAddr )
+{
+  return ( zclOTA_CacheFindSession( clientAddr, FALSE ) );
+}
+
+/******************************************************************************
+ * @fn      zclOTA_ServerEndSession
+ *
+ * @brief   Forget the session of a client, e.g. on its Upgrade End Request.
+ *
+ * @param   clientAddr - address of the client, its mode and address are used
+ *
+ * @return  none
+ */
+void zclOTA_ServerEndSession( afAddrType_t *clientAddr )
+{
+  zclOTA_ServerSession_t *pSession = zclOTA_CacheFindSession( clientAddr, FALSE );
+
+  if ( pSession != NULL )
+  {
+    memset( pSession, 0, sizeof( zclOTA_ServerSession_t ) );
+  }
+}
+
+/******************************************************************************
+ * @fn      zclOTA_ServerCacheGetStats
+ *
+ * @brief   Get the block cache counters.
+ *
+ * @param   pStats - counters are copied here
+ *
+ * @return  none
+ */
+void zclOTA_ServerCacheGetStats( zclOTA_ServerCacheStats_t *pStats )
+{
+  *pStats = zclOTA_CacheStats;
+}
+
+/******************************************************************************
+ * @fn      zclOTA_SameFile
+ *
+ * @brief   Compare two OTA file IDs.
+ *
+ * @param   pFileId1 - first file ID
+ * @param   pFileId2 - second file ID
+ *
+ * @return  TRUE if both identify the same image
+ */
+static uint8_t zclOTA_SameFile( zclOTA_FileID_t *pFileId1, zclOTA_FileID_t *pFileId2 )
+{
+  return ( ( pFileId1->manufacturer == pFileId2->manufacturer ) &&
+           ( pFileId1->type == pFileId2->type ) &&
+           ( pFileId1->version == pFileId2->version ) );
+}
+
+/******************************************************************************
+ * @fn      zclOTA_CacheGetPage
+ *
+ * @brief   Get the cached page holding an image offset. On a miss the
+ *          page is read from the image store into the spare page, which
+ *          then replaces the least recently used page. A failed read
+ *          leaves the cache as it was.
+ *
+ * @param   pFileId - image
+ * @param   offset - file offset within the page
+ * @param   prefetch - TRUE when reading ahead of a client
+ *
+ * @return  pointer to the page, NULL if it could not be read
+ */
+static zclOTA_CachePage_t *zclOTA_CacheGetPage( zclOTA_FileID_t *pFileId, uint32_t offset, uint8_t prefetch )
+{
+  zclOTA_CachePage_t *pPage;
+  zclOTA_CachePage_t *pVictim = NULL;
+  uint8_t victim = 0;
+  uint8_t i;
+
+  // zclOTA_ServerCacheInit() not called yet
+  if ( zclOTA_CacheSpare == NULL )
+  {
+    return ( NULL );
+  }
+
+  offset &= ~( ( uint32_t ) OTA_CACHE_PAGE_SIZE - 1 );
+  zclOTA_CacheUseCount++;
+
+  for ( i = 0; i < OTA_CACHE_NUM_PAGES; i++ )
+  {
+    pPage = zclOTA_CachePages[i];
+
+    if ( pPage->len == 0 )
+    {
+      if ( ( pVictim == NULL ) || ( pVictim->len != 0 ) )
+      {
+        pVictim = pPage;
+        victim = i;
+      }
+    }
+    else if ( ( pPage->offset == offset ) && zclOTA_SameFile( &pPage->fileId, pFileId ) )
+    {
+      if ( !prefetch )
+      {
+        zclOTA_CacheStats.hits++;
+      }
+      pPage->lastUsed = zclOTA_CacheUseCount;
+      return ( pPage );
+    }
+    else if ( ( pVictim == NULL ) ||
+              ( ( pVictim->len != 0 ) && ( pPage->lastUsed < pVictim->lastUsed ) ) )
+    {
+      pVictim = pPage;
+      victim = i;
+    }
+  }
+
+  if ( zclOTA_ImageReadCB == NULL )
+  {
+    return ( NULL );
+  }
+
+  if ( prefetch )
+  {
+    zclOTA_CacheStats.prefetches++;
+  }
+  else
+  {
+    zclOTA_CacheStats.misses++;
+  }
+
+  pPage = zclOTA_CacheSpare;
+  pPage->len = zclOTA_ImageReadCB( pFileId, offset, OTA_CACHE_PAGE_SIZE, pPage->data );
+  if ( pPage->len == 0 )
+  {
+    return ( NULL );
+  }
+
+  pPage->fileId = *pFileId;
+  pPage->offset = offset;
+  pPage->lastUsed = zclOTA_CacheUseCount;
+
+  // The victim becomes the spare page
+  pVictim->len = 0;
+  zclOTA_CacheSpare = pVictim;
+  zclOTA_CachePages[victim] = pPage;
+
+  return ( pPage );
+}
+
+/******************************************************************************
+ * @fn      zclOTA_CacheImageSize
+ *
+ * @brief   Get the total image size from the OTA header of an image,
+ *          from its cached first page or else from the image store.
+ *
+ * @param   pFileId - image
+ * @param   read - TRUE to read the image store if the first page is not cached
+ *
+ * @return  total image size, 0 if it could not be read
+ */
+static uint32_t zclOTA_CacheImageSize( zclOTA_FileID_t *pFileId, uint8_t read )
+{
+  zclOTA_CachePage_t *pPage;
+  uint8_t buf[4];
+  uint8_t i;
+
+  if ( zclOTA_CacheSpare == NULL )
+  {
+    return ( 0 );
+  }
+
+  for ( i = 0; i < OTA_CACHE_NUM_PAGES; i++ )
+  {
+    pPage = zclOTA_CachePages[i];
+
+    if ( ( pPage->len >= ZCL_OTA_IMG_SIZE_OFFSET + sizeof( buf ) ) &&
+         ( pPage->offset == 0 ) && zclOTA_SameFile( &pPage->fileId, pFileId ) )
+    {
+      return ( OsalPort_buildUint32( &pPage->data[ZCL_OTA_IMG_SIZE_OFFSET], sizeof( buf ) ) );
+    }
+  }
+
+  if ( !read || ( zclOTA_ImageReadCB == NULL ) ||
+       ( zclOTA_ImageReadCB( pFileId, ZCL_OTA_IMG_SIZE_OFFSET, sizeof( buf ), buf ) != sizeof( buf ) ) )
+  {
+    return ( 0 );
+  }
+
+  return ( OsalPort_buildUint32( buf, sizeof( buf ) ) );
+}
+
+/******************************************************************************
+ * @fn      zclOTA_SameClient
+ *
+ * @brief   Compare two client addresses by address mode and address.
+ *
+ * @param   pAddr1 - first address
+ * @param   pAddr2 - second address
+ *
+ * @return  TRUE if both identify the same client
+ */
+static uint8_t zclOTA_SameClient( afAddrType_t *pAddr1, afAddrType_t *pAddr2 )
+{
+  if ( pAddr1->addrMode != pAddr2->addrMode )
+  {
+    return ( FALSE );
+  }
+
+  if ( pAddr1->addrMode == afAddr64Bit )
+  {
+    return ( osal_ExtAddrEqual( pAddr1->addr.extAddr, pAddr2->addr.extAddr ) );
+  }
+
+  return ( pAddr1->addr.shortAddr == pAddr2->addr.shortAddr );
+}
+
+/******************************************************************************
+ * @fn      zclOTA_CacheFindSession
+ *
+ * @brief   Find the session of a client.
+ *
+ * @param   clientAddr - address of the client, its mode and address are used
+ * @param   create - TRUE to start a session if the client has none, which
+ *                   replaces the least recently used one if all are in use
+ *
+ * @return  pointer to the session, NULL if not found
+ */
+static zclOTA_ServerSession_t *zclOTA_CacheFindSession( afAddrType_t *clientAddr, uint8_t create )
+{
+  zclOTA_ServerSession_t *pSession;
+  zclOTA_ServerSession_t *pOldest = &zclOTA_Sessions[0];
+  uint8_t i;
+
+  for ( i = 0; i < OTA_CACHE_NUM_SESSIONS; i++ )
+  {
+    pSession = &zclOTA_Sessions[i];
+
+    if ( pSession->blocksSent == 0 )
+    {
+      pOldest = pSession;
+    }
+    else if ( zclOTA_SameClient( &pSession->clientAddr, clientAddr ) )
+    {
+      return ( pSession );
+    }
+    else if ( ( pOldest->blocksSent != 0 ) && ( pSession->lastUsed < pOldest->lastUsed ) )
+    {
+      pOldest = pSession;
+    }
+  }
+
+  if ( !create )
+  {
+    return ( NULL );
+  }
+
+  memset( pOldest, 0, sizeof( zclOTA_ServerSession_t ) );
+  pOldest->clientAddr = *clientAddr;
+
+  return ( pOldest );
+}
+#endif // OTA_SERVER_BLOCK_CACHE
+
 #endif // defined OTA_SERVER
 
 
@@ -765,6 +1239,10 @@ ZStatus_t zclOTA_SendUpgradeEndReq (uint8_t srcEp, afAddrType_t *dstAddr,
  * @fn      zclOTA_ProcessImageData
  *
  * @brief   Process image data as it is received from the host.
+ *          When the download completes or is aborted, the image data
+ *          still held in the write buffer is programmed before
+ *          returning, so the upgrade end handling sees the whole image
+ *          in flash and the next download starts with an empty buffer.
  *
  * @param   pData - pointer to the data
  * @param   len - length of the data
@@ -773,7 +1251,43 @@ ZStatus_t zclOTA_SendUpgradeEndReq (uint8_t srcEp, afAddrType_t *dstAddr,
  */
 uint8_t zclOTA_ProcessImageData ( uint8_t *pData, uint8_t len )
 {
-  int8_t i;
+  uint8_t status;
+
+  status = zclOTA_ProcessImageBytes( pData, len );
+
+  if ( ( zclOTA_WriteBufLen > 0 ) &&
+       ( ( status != ZSuccess ) || ( *zclOTA_ImageUpgradeStatus == OTA_STATUS_COMPLETE ) ) )
+  {
+    // Abort paths may have closed the flash already
+    if ( ( flash_open() == 0 ) || ( zclOTA_FlushImage() != FLASH_SUCCESS ) )
+    {
+      // The buffered data is lost, so is the image
+      zclOTA_WriteBufLen = 0;
+      if ( status == ZSuccess )
+      {
+        status = ZCL_STATUS_ABORT;
+      }
+    }
+  }
+
+  return status;
+}
+
+/******************************************************************************
+ * @fn      zclOTA_ProcessImageBytes
+ *
+ * @brief   Parse and store image data, see zclOTA_ProcessImageData().
+ *
+ * @param   pData - pointer to the data
+ * @param   len - length of the data
+ *
+ * @return  status of the operation
+ */
+static uint8_t zclOTA_ProcessImageBytes ( uint8_t *pData, uint8_t len )
+{
+  uint16_t i;
+  uint16_t start;
+  uint16_t n;
 #if defined OTA_MMO_SIGN
   uint8_t skipHash = FALSE;
 #endif
@@ -785,6 +1299,9 @@ uint8_t zclOTA_ProcessImageData ( uint8_t *pData, uint8_t len )
 
   for ( i=0; i<len; i++ )
   {
+    // States that consume a run of bytes at once advance i to the last one
+    start = i;
+
     switch ( zclOTA_ClientPdState )
     {
         // verify header magic number
@@ -840,6 +1357,18 @@ uint8_t zclOTA_ProcessImageData ( uint8_t *pData, uint8_t len )
         break;
 
       case ZCL_OTA_PD_CONT_HDR_STATE:
+        // Skip the rest of the header in this block at once
+        if ( *zclOTA_FileOffset < zclOTA_HeaderLen-1 )
+        {
+          n = zclOTA_HeaderLen - 1 - *zclOTA_FileOffset;
+          if ( n > len - 1 - i )
+          {
+            n = len - 1 - i;
+          }
+          i += n;
+          *zclOTA_FileOffset += n;
+        }
+
         // Complete the header
         if ( *zclOTA_FileOffset == zclOTA_HeaderLen-1 )
         {
@@ -889,6 +1418,7 @@ uint8_t zclOTA_ProcessImageData ( uint8_t *pData, uint8_t len )
             oadPdState = OAD_GET_IMAGE_HDR_STATE;
             oad_imgHdr_pos = 0;
             memset(&oad_imgHdr,0,sizeof(oad_imgHdr));
+            zclOTA_WriteBufLen = 0;
         }
 #if defined OTA_MMO_SIGN
         if ( zclOTA_ElementTag == OTA_ECDSA_SIGNATURE_TAG_ID )
@@ -942,11 +1472,20 @@ uint8_t zclOTA_ProcessImageData ( uint8_t *pData, uint8_t len )
 
                     if(oad_imgHdr_pos < sizeof(oad_imgHdr))
                     {
-                        ((uint8_t*)&oad_imgHdr)[oad_imgHdr_pos] = pData[i];
-                        oad_imgHdr_pos++;
+                        //Copy as much of the header as this block holds
+                        n = sizeof(oad_imgHdr) - oad_imgHdr_pos;
+                        if(n > len - i)
+                        {
+                            n = len - i;
+                        }
+                        memcpy(&((uint8_t*)&oad_imgHdr)[oad_imgHdr_pos], &pData[i], n);
+                        oad_imgHdr_pos += n;
 
                         //Keep track of OTA element bytes received
-                        zclOTA_ElementPos++;
+                        zclOTA_ElementPos += n;
+
+                        i += n - 1;
+                        *zclOTA_FileOffset += n - 1;  //Minus 1 due to *zclOTA_FileOffset being increased at if ( ++*zclOTA_FileOffset >= zclOTA_DownloadedImageSize )
                         break;
                     }
 
@@ -1058,11 +1597,7 @@ uint8_t zclOTA_ProcessImageData ( uint8_t *pData, uint8_t len )
 #endif
 
                         //Also write the OAD header into the external flash binary section
-#ifndef OTA_ONCHIP
-                        if(writeFlashPg(EXT_FLASH_PAGE(binaryAddrOffset), 0,  (uint8_t *)&oad_imgHdr, sizeof (imgHdr_t)) != FLASH_SUCCESS)
-#else
-                        if(writeFlashPg(FLASH_PAGE(binaryAddrOffset), 0,  (uint8_t *)&oad_imgHdr, sizeof (imgHdr_t)) != FLASH_SUCCESS)
-#endif
+                        if(zclOTA_WriteImage(binaryAddrOffset, (uint8_t *)&oad_imgHdr, sizeof (imgHdr_t)) != FLASH_SUCCESS)
                         {
                             flash_close();
                             //Something went wrong...
@@ -1072,11 +1607,7 @@ uint8_t zclOTA_ProcessImageData ( uint8_t *pData, uint8_t len )
                         binaryAddrOffset += sizeof (imgHdr_t);
 
                         //add the remaining payload image into the image section
-#ifndef OTA_ONCHIP
-                        if(writeFlashPg(EXT_FLASH_PAGE(binaryAddrOffset), binaryAddrOffset & (~EXTFLASH_PAGE_MASK), &pData[i], len - i ) != FLASH_SUCCESS)
-#else
-                        if(writeFlashPg(FLASH_PAGE(binaryAddrOffset), binaryAddrOffset & (~INTFLASH_PAGE_MASK), &pData[i], len - i ) != FLASH_SUCCESS)
-#endif
+                        if(zclOTA_WriteImage(binaryAddrOffset, &pData[i], len - i ) != FLASH_SUCCESS)
                         {
                             flash_close();
                             //Something went wrong...
@@ -1092,9 +1623,23 @@ uint8_t zclOTA_ProcessImageData ( uint8_t *pData, uint8_t len )
                         *zclOTA_FileOffset += len - i - 1;  //Minus 1 due to *zclOTA_FileOffset being increased at if ( ++*zclOTA_FileOffset >= zclOTA_DownloadedImageSize )
 
                         //Had copied the whole packet already, so skip this frame.
-                        i = len;
+                        i = len - 1;
 
                         oadPdState = OAD_GET_IMAGE_PAYLOAD_STATE;
+
+                        //The whole image may fit in the first block
+                        if(binaryAddrOffset - binaryAddrStart >= oad_imgHdr.fixedHdr.len)
+                        {
+                            if(zclOTA_CheckImage() == ZSuccess)
+                            {
+                                oadPdState = OAD_IMAGE_COMPLETED_STATE;
+                            }
+                            else
+                            {
+                                flash_close();
+                                return ZCL_STATUS_ABORT;
+                            }
+                        }
                     }
                     else
                     {
@@ -1116,11 +1661,7 @@ uint8_t zclOTA_ProcessImageData ( uint8_t *pData, uint8_t len )
                         if(binaryAddrOffset + len < binaryAddrStart + oad_imgHdr.fixedHdr.len)
                         {
                             //add the image payload into the image section
-#ifndef OTA_ONCHIP
-                            if(writeFlashPg(EXT_FLASH_PAGE(binaryAddrOffset), binaryAddrOffset & (~EXTFLASH_PAGE_MASK), &pData[i], len ) != FLASH_SUCCESS)
-#else
-                            if(writeFlashPg(FLASH_PAGE(binaryAddrOffset), binaryAddrOffset & (~INTFLASH_PAGE_MASK), &pData[i], len ) != FLASH_SUCCESS)
-#endif
+                            if(zclOTA_WriteImage(binaryAddrOffset, &pData[i], len ) != FLASH_SUCCESS)
                             {
                                 flash_close();
                                 //Something went wrong...
@@ -1136,11 +1677,7 @@ uint8_t zclOTA_ProcessImageData ( uint8_t *pData, uint8_t len )
                             remaining = oad_imgHdr.fixedHdr.len - (binaryAddrOffset - binaryAddrStart);
 
                             //add the image payload into the image section
-#ifndef OTA_ONCHIP
-                            if(writeFlashPg(EXT_FLASH_PAGE(binaryAddrOffset), binaryAddrOffset & (~EXTFLASH_PAGE_MASK), &pData[i],  remaining ) != FLASH_SUCCESS)
-#else
-                            if(writeFlashPg(FLASH_PAGE(binaryAddrOffset), binaryAddrOffset & (~INTFLASH_PAGE_MASK), &pData[i],  remaining ) != FLASH_SUCCESS)
-#endif
+                            if(zclOTA_WriteImage(binaryAddrOffset, &pData[i],  remaining ) != FLASH_SUCCESS)
                             {
                                 flash_close();
                                 //Something went wrong...
@@ -1149,12 +1686,8 @@ uint8_t zclOTA_ProcessImageData ( uint8_t *pData, uint8_t len )
                             binaryAddrOffset += remaining;
                             *zclOTA_FileOffset += remaining - 1; //Minus 1 due to *zclOTA_FileOffset being increased at if ( ++*zclOTA_FileOffset >= zclOTA_DownloadedImageSize )
 
-                            //check the binary copied CRC
-#ifndef OTA_ONCHIP
-                            if(oadCheckDL(EXT_FLASH_PAGE(binaryAddrStart)) == ZSuccess)
-#else
-                            if(oadCheckDL(FLASH_PAGE(binaryAddrStart)) == ZSuccess)
-#endif
+                            //program what is still buffered and check the binary copied CRC
+                            if(zclOTA_CheckImage() == ZSuccess)
                             {
                                 oadPdState = OAD_IMAGE_COMPLETED_STATE;
                             }
@@ -1167,7 +1700,7 @@ uint8_t zclOTA_ProcessImageData ( uint8_t *pData, uint8_t len )
                     }
 
                     //As we copy the whole buffer, force the index to be the last byte
-                    i = len;
+                    i = len - 1;
 
                 break;
             }
@@ -1184,16 +1717,10 @@ uint8_t zclOTA_ProcessImageData ( uint8_t *pData, uint8_t len )
 #if defined OTA_MMO_SIGN
     if ( !skipHash )
     {
-      // Maintain a buffer of data to hash
-      zclOTA_DataToHash[zclOTA_HashPos++] = pData[i];
-
-      // When the buffer reaches OTA_MMO_HASH_SIZE, update the Hash
-      if ( zclOTA_HashPos == OTA_MMO_HASH_SIZE )
-      {
-        OTA_CalculateMmoR3 ( &zclOTA_MmoHash, zclOTA_DataToHash, OTA_MMO_HASH_SIZE, FALSE );
-        zclOTA_HashPos = 0;
-      }
+      zclOTA_HashData( &pData[start], i - start + 1 );
     }
+#else
+    (void)start;
 #endif
 
     // Check if the download is complete
@@ -1219,6 +1746,152 @@ uint8_t zclOTA_ProcessImageData ( uint8_t *pData, uint8_t len )
   return ZSuccess;
 }
 
+/*********************************************************************
+ * @fn      zclOTA_WriteImage
+ *
+ * @brief   Write image data to flash through the RAM write buffer. Data
+ *          is programmed in OTA_WRITE_BUF_LEN chunks aligned to that size,
+ *          so a chunk never crosses a flash page. Writes must be
+ *          sequential, zclOTA_FlushImage() programs what is left.
+ *
+ * @param   addr - flash offset of the data
+ * @param   pData - data to write
+ * @param   len - length of the data
+ *
+ * @return  FLASH_SUCCESS if OK
+ */
+static uint8_t zclOTA_WriteImage(uint32_t addr, uint8_t *pData, uint32_t len)
+{
+    uint32_t room;
+
+    if(zclOTA_WriteBufLen == 0)
+    {
+        zclOTA_WriteBufAddr = addr;
+    }
+
+    while(len > 0)
+    {
+        //Bytes left up to the next aligned chunk
+        room = OTA_WRITE_BUF_LEN - ((zclOTA_WriteBufAddr + zclOTA_WriteBufLen) & (OTA_WRITE_BUF_LEN - 1));
+        if(room > len)
+        {
+            room = len;
+        }
+
+        OsalPort_memcpy(&zclOTA_WriteBuf[zclOTA_WriteBufLen], pData, room);
+        zclOTA_WriteBufLen += room;
+        pData += room;
+        len -= room;
+
+        //Chunk complete, program it
+        if(((zclOTA_WriteBufAddr + zclOTA_WriteBufLen) & (OTA_WRITE_BUF_LEN - 1)) == 0)
+        {
+            addr = zclOTA_WriteBufAddr + zclOTA_WriteBufLen;
+            if(zclOTA_FlushImage() != FLASH_SUCCESS)
+            {
+                return FLASH_FAILURE;
+            }
+            zclOTA_WriteBufAddr = addr;
+        }
+    }
+
+    return FLASH_SUCCESS;
+}
+
+/*********************************************************************
+ * @fn      zclOTA_FlushImage
+ *
+ * @brief   Program the image data held in the RAM write buffer.
+ *
+ * @return  FLASH_SUCCESS if OK
+ */
+static uint8_t zclOTA_FlushImage(void)
+{
+    uint8_t status = FLASH_SUCCESS;
+
+    if(zclOTA_WriteBufLen > 0)
+    {
+#ifndef OTA_ONCHIP
+        status = writeFlashPg(EXT_FLASH_PAGE(zclOTA_WriteBufAddr), zclOTA_WriteBufAddr & (~EXTFLASH_PAGE_MASK), zclOTA_WriteBuf, zclOTA_WriteBufLen);
+#else
+        status = writeFlashPg(FLASH_PAGE(zclOTA_WriteBufAddr), zclOTA_WriteBufAddr & (~INTFLASH_PAGE_MASK), zclOTA_WriteBuf, zclOTA_WriteBufLen);
+#endif
+        zclOTA_WriteBufLen = 0;
+    }
+
+    return status;
+}
+
+/*********************************************************************
+ * @fn      zclOTA_CheckImage
+ *
+ * @brief   Program the image data held in the RAM write buffer, then
+ *          check the CRC of the image in flash.
+ *
+ * @return  ZSuccess if the image is valid
+ */
+static uint8_t zclOTA_CheckImage(void)
+{
+    if(zclOTA_FlushImage() != FLASH_SUCCESS)
+    {
+        return ZFailure;
+    }
+
+#ifndef OTA_ONCHIP
+    return oadCheckDL(EXT_FLASH_PAGE(binaryAddrStart));
+#else
+    return oadCheckDL(FLASH_PAGE(binaryAddrStart));
+#endif
+}
+
+#if defined OTA_MMO_SIGN
+/*********************************************************************
+ * @fn      zclOTA_HashData
+ *
+ * @brief   Add image data to the MMO hash. Whole hash blocks are hashed
+ *          straight from the data, only partial ones are staged in
+ *          zclOTA_DataToHash.
+ *
+ * @param   pData - data to hash
+ * @param   len - length of the data
+ *
+ * @return  none
+ */
+static void zclOTA_HashData(uint8_t *pData, uint16_t len)
+{
+    uint16_t n;
+
+    while(len > 0)
+    {
+        if((zclOTA_HashPos == 0) && (len >= OTA_MMO_HASH_SIZE))
+        {
+            OTA_CalculateMmoR3 ( &zclOTA_MmoHash, pData, OTA_MMO_HASH_SIZE, FALSE );
+            pData += OTA_MMO_HASH_SIZE;
+            len -= OTA_MMO_HASH_SIZE;
+            continue;
+        }
+
+        n = OTA_MMO_HASH_SIZE - zclOTA_HashPos;
+        if(n > len)
+        {
+            n = len;
+        }
+
+        memcpy(&zclOTA_DataToHash[zclOTA_HashPos], pData, n);
+        zclOTA_HashPos += n;
+        pData += n;
+        len -= n;
+
+        // When the buffer reaches OTA_MMO_HASH_SIZE, update the Hash
+        if ( zclOTA_HashPos == OTA_MMO_HASH_SIZE )
+        {
+            OTA_CalculateMmoR3 ( &zclOTA_MmoHash, zclOTA_DataToHash, OTA_MMO_HASH_SIZE, FALSE );
+            zclOTA_HashPos = 0;
+        }
+    }
+}
+#endif // OTA_MMO_SIGN
+
 /*********************************************************************
  * @fn      oadEraseExtFlashPages
  *
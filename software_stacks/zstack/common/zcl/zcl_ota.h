@@ -432,6 +432,32 @@ typedef struct
   uint8_t ota_event;
 } zclOTA_CallbackMsg_t;
 
+#if defined OTA_SERVER_BLOCK_CACHE
+/**
+ * Image store read function of the server. Returns the number of bytes
+ * read, less than len at the end of the image and 0 on failure.
+ */
+typedef uint16_t (*zclOTA_ImageReadCB_t)( zclOTA_FileID_t *pFileId, uint32_t offset,
+                                          uint16_t len, uint8_t *pBuf );
+
+typedef struct
+{
+  afAddrType_t clientAddr;  //!< Address of the client, compared by mode and address.
+  zclOTA_FileID_t fileId; //!< Image being downloaded.
+  uint32_t imageSize;       //!< Total image size from the OTA header, 0 if unknown.
+  uint32_t fileOffset;      //!< Offset following the last block sent.
+  uint32_t blocksSent;      //!< Number of Image Block Responses sent, 0 if unused.
+  uint32_t lastUsed;        //!< Block cache use count of the last request.
+} zclOTA_ServerSession_t;
+
+typedef struct
+{
+  uint32_t hits;            //!< Blocks served from a cached page.
+  uint32_t misses;          //!< Blocks whose page had to be read.
+  uint32_t prefetches;      //!< Pages read ahead of a session.
+} zclOTA_ServerCacheStats_t;
+#endif // OTA_SERVER_BLOCK_CACHE
+
 /** @} End ZCL_OTA_CLUSTER_TYPEDEFS */
 
 /**
@@ -679,6 +705,69 @@ extern ZStatus_t zclOTA_SendImageBlockRsp (uint8_t srcEp, afAddrType_t *dstAddr,
  */
 extern ZStatus_t zclOTA_SendUpgradeEndRsp (uint8_t srcEp, afAddrType_t *dstAddr, zclOTA_UpgradeEndRspParams_t *pParams, uint8_t transSeqNum );
 
+#if defined OTA_SERVER_BLOCK_CACHE
+/******************************************************************************
+ * @fn      zclOTA_ServerCacheInit
+ *
+ * @brief   Set the image store read function and empty the block cache
+ *          and the client sessions. Must be called again when an image
+ *          in the store changes.
+ *
+ * @param   pfnReadCB - image store read function
+ *
+ * @return  none
+ */
+extern void zclOTA_ServerCacheInit( zclOTA_ImageReadCB_t pfnReadCB );
+
+/******************************************************************************
+ * @fn      zclOTA_ServerSendImageBlock
+ *
+ * @brief   Answer an Image Block Request from the block cache.
+ *
+ * @param   srcEp   - endpoint from which the message is send
+ * @param   dstAddr - address of the requesting client
+ * @param   pReq    - Image Block Request parameters
+ * @param   transSeqNum - Transaction Sequence Number of the request
+ *
+ * @return  ZStatus_t
+ */
+extern ZStatus_t zclOTA_ServerSendImageBlock( uint8_t srcEp, afAddrType_t *dstAddr,
+                                              zclOTA_ImageBlockReqParams_t *pReq, uint8_t transSeqNum );
+
+/******************************************************************************
+ * @fn      zclOTA_ServerGetSession
+ *
+ * @brief   Get the download progress of a client.
+ *
+ * @param   clientAddr - address of the client, its mode and address are used
+ *
+ * @return  pointer to the session, NULL if the client has none
+ */
+extern zclOTA_ServerSession_t *zclOTA_ServerGetSession( afAddrType_t *clientAddr );
+
+/******************************************************************************
+ * @fn      zclOTA_ServerEndSession
+ *
+ * @brief   Forget the session of a client, e.g. on its Upgrade End Request.
+ *
+ * @param   clientAddr - address of the client, its mode and address are used
+ *
+ * @return  none
+ */
+extern void zclOTA_ServerEndSession( afAddrType_t *clientAddr );
+
+/******************************************************************************
+ * @fn      zclOTA_ServerCacheGetStats
+ *
+ * @brief   Get the block cache counters.
+ *
+ * @param   pStats - counters are copied here
+ *
+ * @return  none
+ */
+extern void zclOTA_ServerCacheGetStats( zclOTA_ServerCacheStats_t *pStats );
+#endif // OTA_SERVER_BLOCK_CACHE
+
 /** @} End ZCL_OTA_CLUSTER_FUNCTIONS */
 
 #endif // OTA_SERVER
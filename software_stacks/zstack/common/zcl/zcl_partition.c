@@ -55,6 +55,10 @@
 /*********************************************************************
  * MACROS
  */
+// Frame map of a windowed transfer, one bit per frame
+#define ZCL_PARTITION_MAP_TEST( pMap, n )   ( (pMap)[(n) >> 3] & ( 1 << ( (n) & 0x07 ) ) )
+#define ZCL_PARTITION_MAP_SET( pMap, n )    ( (pMap)[(n) >> 3] |= ( 1 << ( (n) & 0x07 ) ) )
+#define ZCL_PARTITION_MAP_CLR( pMap, n )    ( (pMap)[(n) >> 3] &= ~( 1 << ( (n) & 0x07 ) ) )
 
 /*********************************************************************
  * CONSTANTS
@@ -97,6 +101,8 @@ static ZStatus_t zclPartition_ProcessInCmd_ReadHandshakeParam( zclIncoming_t *pI
 static ZStatus_t zclPartition_ProcessInCmd_WriteHandshakeParam( zclIncoming_t *pInMsg, zclPartition_AppCallbacks_t *pCBs );
 static ZStatus_t zclPartition_ProcessInCmd_MultipleAck( zclIncoming_t *pInMsg, zclPartition_AppCallbacks_t *pCBs );
 static ZStatus_t zclPartition_ProcessInCmd_ReadHandshakeParamRsp( zclIncoming_t *pInMsg, zclPartition_AppCallbacks_t *pCBs );
+static ZStatus_t zclPartition_TransferInit( zclPartitionTransfer_t *pXfer, uint8_t *pData, uint16_t bufLen,
+                                            uint8_t frameSize, uint8_t window );
 
 
 /*********************************************************************
@@ -1129,6 +1135,413 @@ static ZStatus_t zclPartition_ProcessInCmd_ReadHandshakeParamRsp( zclIncoming_t
   return ( ZFailure );
 }
 
+/*********************************************************************
+ * @fn      zclPartition_TransferInit
+ *
+ * @brief   Common setup of a windowed transfer, allocates the frame map.
+ *
+ * @param   pXfer - transfer state
+ * @param   pData - buffer to send from or reassemble into
+ * @param   bufLen - length of pData
+ * @param   frameSize - PartitionedFrameSize
+ * @param   window - NumberOfACKFrames
+ *
+ * @return  ZSuccess, ZCL_STATUS_INVALID_VALUE or ZMemError
+ */
+static ZStatus_t zclPartition_TransferInit( zclPartitionTransfer_t *pXfer, uint8_t *pData, uint16_t bufLen,
+                                            uint8_t frameSize, uint8_t window )
+{
+  uint16_t mapLen;
+
+  if ( ( pData == NULL ) || ( bufLen == 0 ) || ( frameSize == 0 ) || ( window == 0 ) )
+  {
+    return ( ZCL_STATUS_INVALID_VALUE );
+  }
+
+  zcl_memset( pXfer, 0, sizeof( zclPartitionTransfer_t ) );
+  pXfer->pData = pData;
+  pXfer->bufLen = bufLen;
+  pXfer->frameSize = frameSize;
+  pXfer->window = window;
+  pXfer->numFrames = (uint16_t)( ( (uint32_t)bufLen + frameSize - 1 ) / frameSize );
+
+  mapLen = ( pXfer->numFrames + 7 ) / 8;
+  pXfer->pFrameMap = zcl_mem_alloc( mapLen );
+  if ( pXfer->pFrameMap == NULL )
+  {
+    return ( ZMemError );
+  }
+  zcl_memset( pXfer->pFrameMap, 0, mapLen );
+
+  return ( ZSuccess );
+}
+
+/*********************************************************************
+ * @fn      zclPartition_TxStart
+ *
+ * @brief   Start an outgoing transfer of a buffer, segmented into frames of
+ *          frameSize bytes with up to window frames sent per Multiple ACK.
+ *          The buffer must stay valid until the transfer is done.
+ *
+ * @param   pXfer - transfer state
+ * @param   pData - data to send
+ * @param   len - length of data, up to MaxOutgoingTransferSize
+ * @param   frameSize - PartitionedFrameSize
+ * @param   window - NumberOfACKFrames
+ *
+ * @return  ZSuccess, ZCL_STATUS_INVALID_VALUE or ZMemError
+ */
+ZStatus_t zclPartition_TxStart( zclPartitionTransfer_t *pXfer, uint8_t *pData, uint16_t len,
+                                uint8_t frameSize, uint8_t window )
+{
+  ZStatus_t status;
+
+  status = zclPartition_TransferInit( pXfer, pData, len, frameSize, window );
+  pXfer->totalLen = len;
+
+  return ( status );
+}
+
+/*********************************************************************
+ * @fn      zclPartition_TxSend
+ *
+ * @brief   Send frames until the window is full, NACKed and timed out
+ *          frames first, then new ones. Call after zclPartition_TxStart,
+ *          after every Multiple ACK and after a timeout.
+ *
+ * @param   pXfer - transfer state
+ * @param   srcEP - Sending application's endpoint
+ * @param   dstAddr - where you want the message to go
+ * @param   disableDefaultRsp - whether to disable the Default Response command
+ * @param   pSeqNum - sequence number, incremented for every frame sent
+ *
+ * @return  ZStatus_t, frames that failed to send are sent again next call
+ */
+ZStatus_t zclPartition_TxSend( zclPartitionTransfer_t *pXfer, uint8_t srcEP, afAddrType_t *dstAddr,
+                               uint8_t disableDefaultRsp, uint8_t *pSeqNum )
+{
+  zclCmdTransferPartitionedFrame_t cmd;
+  uint16_t resend = pXfer->ackBase;
+  uint16_t frame;
+  uint8_t indicatorSize;
+  ZStatus_t status = ZSuccess;
+
+  if ( ( pXfer->totalLen > 0xFF ) || ( pXfer->numFrames > 0xFF ) )
+  {
+    indicatorSize = ZCL_PARTITION_OPTIONS_INDICATOR_16BIT;
+  }
+  else
+  {
+    indicatorSize = ZCL_PARTITION_OPTIONS_INDICATOR_8BIT;
+  }
+
+  while ( ( pXfer->inFlight < pXfer->window ) && ( status == ZSuccess ) )
+  {
+    // frames to resend come first
+    while ( ( resend < pXfer->nextFrame ) && !ZCL_PARTITION_MAP_TEST( pXfer->pFrameMap, resend ) )
+    {
+      resend++;
+    }
+
+    if ( resend < pXfer->nextFrame )
+    {
+      frame = resend;
+      ZCL_PARTITION_MAP_CLR( pXfer->pFrameMap, frame );
+    }
+    else if ( pXfer->nextFrame < pXfer->numFrames )
+    {
+      frame = pXfer->nextFrame++;
+    }
+    else
+    {
+      break;  // everything is sent, wait for the Multiple ACK
+    }
+
+    cmd.fragmentationOptions = indicatorSize;
+    if ( frame == 0 )
+    {
+      cmd.fragmentationOptions |= ZCL_PARTITION_OPTIONS_FIRSTBLOCK;
+      cmd.partitionIndicator = pXfer->totalLen;
+    }
+    else
+    {
+      cmd.partitionIndicator = frame;
+    }
+    cmd.pFrame = &pXfer->pData[(uint32_t)frame * pXfer->frameSize];
+    if ( frame == ( pXfer->numFrames - 1 ) )
+    {
+      cmd.frameLen = (uint8_t)( pXfer->totalLen - (uint32_t)frame * pXfer->frameSize );
+    }
+    else
+    {
+      cmd.frameLen = pXfer->frameSize;
+    }
+
+    status = zclPartition_Send_TransferPartitionedFrame( srcEP, dstAddr, &cmd, disableDefaultRsp, (*pSeqNum)++ );
+    if ( status == ZSuccess )
+    {
+      pXfer->inFlight++;
+    }
+    else
+    {
+      ZCL_PARTITION_MAP_SET( pXfer->pFrameMap, frame );
+    }
+  }
+
+  return ( status );
+}
+
+/*********************************************************************
+ * @fn      zclPartition_TxProcessMultipleAck
+ *
+ * @brief   Process a Multiple ACK from the receiver. All frames before
+ *          FirstFrameID were received, the NACKed frames are sent again
+ *          by the next zclPartition_TxSend and every other frame sent is
+ *          no longer due for resending, even if a timeout marked it.
+ *          Frees nothing, the caller still owns pCmd->pNAckID.
+ *
+ * @param   pXfer - transfer state
+ * @param   pCmd - received Multiple ACK
+ *
+ * @return  none
+ */
+void zclPartition_TxProcessMultipleAck( zclPartitionTransfer_t *pXfer, zclCmdMultipleAck_t *pCmd )
+{
+  uint16_t frame;
+  uint8_t i;
+
+  if ( pCmd->firstFrameID > pXfer->nextFrame )
+  {
+    pXfer->ackBase = pXfer->nextFrame;
+  }
+  else if ( pCmd->firstFrameID > pXfer->ackBase )
+  {
+    pXfer->ackBase = pCmd->firstFrameID;
+  }
+
+  // only the frames in the NACK list are resent
+  for ( frame = pXfer->ackBase; frame < pXfer->nextFrame; frame++ )
+  {
+    ZCL_PARTITION_MAP_CLR( pXfer->pFrameMap, frame );
+  }
+  for ( i = 0; i < pCmd->numNAcks; i++ )
+  {
+    if ( ( pCmd->pNAckID[i] >= pXfer->ackBase ) && ( pCmd->pNAckID[i] < pXfer->nextFrame ) )
+    {
+      ZCL_PARTITION_MAP_SET( pXfer->pFrameMap, pCmd->pNAckID[i] );
+    }
+  }
+
+  // the receiver answered, a new window can be sent
+  pXfer->inFlight = 0;
+  pXfer->retries = 0;
+}
+
+/*********************************************************************
+ * @fn      zclPartition_TxTimeout
+ *
+ * @brief   No Multiple ACK arrived within the NACK timeout. All frames not
+ *          acknowledged yet are sent again by the next zclPartition_TxSend.
+ *
+ * @param   pXfer - transfer state
+ * @param   maxRetries - NumberOfSendRetries
+ *
+ * @return  ZSuccess, or ZCL_STATUS_TIMEOUT when the retries are used up
+ */
+ZStatus_t zclPartition_TxTimeout( zclPartitionTransfer_t *pXfer, uint8_t maxRetries )
+{
+  uint16_t frame;
+
+  if ( pXfer->retries >= maxRetries )
+  {
+    return ( ZCL_STATUS_TIMEOUT );
+  }
+  pXfer->retries++;
+
+  for ( frame = pXfer->ackBase; frame < pXfer->nextFrame; frame++ )
+  {
+    ZCL_PARTITION_MAP_SET( pXfer->pFrameMap, frame );
+  }
+  pXfer->inFlight = 0;
+
+  return ( ZSuccess );
+}
+
+/*********************************************************************
+ * @fn      zclPartition_TxDone
+ *
+ * @brief   Check whether the receiver acknowledged every frame.
+ *
+ * @param   pXfer - transfer state
+ *
+ * @return  TRUE if the outgoing transfer is complete
+ */
+uint8_t zclPartition_TxDone( zclPartitionTransfer_t *pXfer )
+{
+  return ( pXfer->ackBase >= pXfer->numFrames );
+}
+
+/*********************************************************************
+ * @fn      zclPartition_RxStart
+ *
+ * @brief   Start reassembling an incoming transfer into a caller buffer.
+ *
+ * @param   pXfer - transfer state
+ * @param   pBuf - buffer the transfer is reassembled into
+ * @param   bufLen - size of pBuf, transfers larger than this are refused
+ * @param   frameSize - PartitionedFrameSize
+ * @param   window - NumberOfACKFrames
+ *
+ * @return  ZSuccess, ZCL_STATUS_INVALID_VALUE or ZMemError
+ */
+ZStatus_t zclPartition_RxStart( zclPartitionTransfer_t *pXfer, uint8_t *pBuf, uint16_t bufLen,
+                                uint8_t frameSize, uint8_t window )
+{
+  return ( zclPartition_TransferInit( pXfer, pBuf, bufLen, frameSize, window ) );
+}
+
+/*********************************************************************
+ * @fn      zclPartition_RxProcessFrame
+ *
+ * @brief   Place a received partitioned frame into the reassembly buffer.
+ *          Frames may arrive in any order and more than once.
+ *
+ * @param   pXfer - transfer state
+ * @param   pCmd - received Transfer Partitioned Frame
+ * @param   pAckDue - (output) TRUE when a Multiple ACK should be sent now
+ *
+ * @return  ZSuccess, ZCL_STATUS_INSUFFICIENT_SPACE if the transfer does not
+ *          fit the buffer or ZCL_STATUS_INVALID_VALUE for a bad frame
+ */
+ZStatus_t zclPartition_RxProcessFrame( zclPartitionTransfer_t *pXfer, zclCmdTransferPartitionedFrame_t *pCmd,
+                                       uint8_t *pAckDue )
+{
+  uint16_t frame;
+  uint32_t offset;
+
+  *pAckDue = FALSE;
+
+  if ( pCmd->fragmentationOptions & ZCL_PARTITION_OPTIONS_FIRSTBLOCK )
+  {
+    if ( ( pCmd->partitionIndicator == 0 ) || ( pCmd->partitionIndicator > pXfer->bufLen ) )
+    {
+      return ( ZCL_STATUS_INSUFFICIENT_SPACE );
+    }
+    pXfer->totalLen = pCmd->partitionIndicator;
+    pXfer->numFrames = ( pXfer->totalLen + pXfer->frameSize - 1 ) / pXfer->frameSize;
+    frame = 0;
+  }
+  else
+  {
+    frame = pCmd->partitionIndicator;
+  }
+
+  offset = (uint32_t)frame * pXfer->frameSize;
+  if ( ( frame >= pXfer->numFrames ) || ( pCmd->frameLen > pXfer->frameSize )
+      || ( ( offset + pCmd->frameLen ) > pXfer->bufLen ) )
+  {
+    return ( ZCL_STATUS_INVALID_VALUE );
+  }
+
+  if ( !ZCL_PARTITION_MAP_TEST( pXfer->pFrameMap, frame ) )
+  {
+    zcl_memcpy( &pXfer->pData[offset], pCmd->pFrame, pCmd->frameLen );
+    ZCL_PARTITION_MAP_SET( pXfer->pFrameMap, frame );
+  }
+
+  if ( frame >= pXfer->nextFrame )
+  {
+    pXfer->nextFrame = frame + 1;
+  }
+  while ( ( pXfer->ackBase < pXfer->numFrames ) && ZCL_PARTITION_MAP_TEST( pXfer->pFrameMap, pXfer->ackBase ) )
+  {
+    pXfer->ackBase++;
+  }
+
+  if ( pXfer->inFlight < 0xFF )
+  {
+    pXfer->inFlight++;
+  }
+  *pAckDue = ( pXfer->inFlight >= pXfer->window ) || zclPartition_RxDone( pXfer );
+
+  return ( ZSuccess );
+}
+
+/*********************************************************************
+ * @fn      zclPartition_RxBuildMultipleAck
+ *
+ * @brief   Fill in a Multiple ACK for the frames received so far: the first
+ *          frame not received yet and the missing frames up to the highest
+ *          frame received. Send it with zclPartition_Send_MultipleAck.
+ *
+ * @param   pXfer - transfer state
+ * @param   pCmd - (output) Multiple ACK, pNAckID points to pNAckBuf
+ * @param   pNAckBuf - room for the NACK IDs
+ * @param   maxNAcks - number of NACK IDs pNAckBuf holds
+ *
+ * @return  none
+ */
+void zclPartition_RxBuildMultipleAck( zclPartitionTransfer_t *pXfer, zclCmdMultipleAck_t *pCmd,
+                                      uint16_t *pNAckBuf, uint8_t maxNAcks )
+{
+  uint16_t frame;
+
+  pCmd->firstFrameID = pXfer->ackBase;
+  pCmd->numNAcks = 0;
+  pCmd->pNAckID = pNAckBuf;
+
+  for ( frame = pXfer->ackBase; ( frame < pXfer->nextFrame ) && ( pCmd->numNAcks < maxNAcks ); frame++ )
+  {
+    if ( !ZCL_PARTITION_MAP_TEST( pXfer->pFrameMap, frame ) )
+    {
+      pNAckBuf[pCmd->numNAcks++] = frame;
+    }
+  }
+
+  if ( pXfer->nextFrame > 0xFF )
+  {
+    pCmd->options = ZCL_PARTITION_OPTIONS_NACK_16BIT;
+  }
+  else
+  {
+    pCmd->options = ZCL_PARTITION_OPTIONS_NACK_8BIT;
+  }
+
+  pXfer->inFlight = 0;
+}
+
+/*********************************************************************
+ * @fn      zclPartition_RxDone
+ *
+ * @brief   Check whether every frame of the incoming transfer arrived.
+ *
+ * @param   pXfer - transfer state
+ *
+ * @return  TRUE if pData holds the complete transfer of totalLen bytes
+ */
+uint8_t zclPartition_RxDone( zclPartitionTransfer_t *pXfer )
+{
+  return ( ( pXfer->totalLen != 0 ) && ( pXfer->ackBase >= pXfer->numFrames ) );
+}
+
+/*********************************************************************
+ * @fn      zclPartition_TransferFree
+ *
+ * @brief   Release the frame map of a finished or abandoned transfer.
+ *
+ * @param   pXfer - transfer state
+ *
+ * @return  none
+ */
+void zclPartition_TransferFree( zclPartitionTransfer_t *pXfer )
+{
+  if ( pXfer->pFrameMap != NULL )
+  {
+    zcl_mem_free( pXfer->pFrameMap );
+    pXfer->pFrameMap = NULL;
+  }
+}
+
 
 /****************************************************************************
 ****************************************************************************/
@@ -178,6 +178,25 @@ typedef struct
   zclPartitionReadRec_t  *pReadRecord;    // array of Read Attribute Response Status records
 } zclCmdReadHandshakeParamRsp_t;
 
+/*** ZCL Partition: windowed transfer engine ***/
+// State of one outgoing or incoming partitioned transfer. The application
+// sends and receives the PDUs, the engine segments, tracks the ACK window
+// and the NACKed frames, and reassembles.
+typedef struct
+{
+  uint8_t   *pData;       // buffer sent from, or reassembled into
+  uint16_t  bufLen;       // size of pData
+  uint16_t  totalLen;     // transfer length, receiver learns it from the first block
+  uint16_t  numFrames;    // frames in the transfer (receiver: max frames pData holds until first block)
+  uint8_t   frameSize;    // PartitionedFrameSize
+  uint8_t   window;       // NumberOfACKFrames, frames between Multiple ACKs
+  uint8_t   inFlight;     // frames sent (sender) or received (receiver) since the last Multiple ACK
+  uint8_t   retries;      // sender: timeouts since the last Multiple ACK
+  uint16_t  nextFrame;    // sender: next frame never sent, receiver: highest frame received + 1
+  uint16_t  ackBase;      // first frame not covered by a Multiple ACK yet
+  uint8_t   *pFrameMap;   // one bit per frame, sender: frame must be resent, receiver: frame received
+} zclPartitionTransfer_t;
+
 // Partition Cluster callback types
 typedef ZStatus_t (*zclPartition_TransferPartitionedFrame_t)( afAddrType_t *srcAddr, zclCmdTransferPartitionedFrame_t *pCmd );
 typedef ZStatus_t (*zclPartition_ReadHandshakeParam_t)( afAddrType_t *srcAddr, zclCmdReadHandshakeParam_t *pCmd );
@@ -314,6 +333,33 @@ extern ZStatus_t zclPartition_Send_ReadHandshakeParamRsp( uint8_t srcEP, afAddrT
                                                           zclCmdReadHandshakeParamRsp_t *pCmd,
                                                           uint8_t disableDefaultRsp, uint8_t seqNum );
 
+/*
+ * Windowed transfer engine, sender side
+ */
+extern ZStatus_t zclPartition_TxStart( zclPartitionTransfer_t *pXfer, uint8_t *pData, uint16_t len,
+                                       uint8_t frameSize, uint8_t window );
+extern ZStatus_t zclPartition_TxSend( zclPartitionTransfer_t *pXfer, uint8_t srcEP, afAddrType_t *dstAddr,
+                                      uint8_t disableDefaultRsp, uint8_t *pSeqNum );
+extern void zclPartition_TxProcessMultipleAck( zclPartitionTransfer_t *pXfer, zclCmdMultipleAck_t *pCmd );
+extern ZStatus_t zclPartition_TxTimeout( zclPartitionTransfer_t *pXfer, uint8_t maxRetries );
+extern uint8_t zclPartition_TxDone( zclPartitionTransfer_t *pXfer );
+
+/*
+ * Windowed transfer engine, receiver side
+ */
+extern ZStatus_t zclPartition_RxStart( zclPartitionTransfer_t *pXfer, uint8_t *pBuf, uint16_t bufLen,
+                                       uint8_t frameSize, uint8_t window );
+extern ZStatus_t zclPartition_RxProcessFrame( zclPartitionTransfer_t *pXfer, zclCmdTransferPartitionedFrame_t *pCmd,
+                                              uint8_t *pAckDue );
+extern void zclPartition_RxBuildMultipleAck( zclPartitionTransfer_t *pXfer, zclCmdMultipleAck_t *pCmd,
+                                             uint16_t *pNAckBuf, uint8_t maxNAcks );
+extern uint8_t zclPartition_RxDone( zclPartitionTransfer_t *pXfer );
+
+/*
+ * Release the frame map of a transfer
+ */
+extern void zclPartition_TransferFree( zclPartitionTransfer_t *pXfer );
+
 
 /*********************************************************************
 *********************************************************************/
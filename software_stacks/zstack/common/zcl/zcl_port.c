@@ -73,6 +73,16 @@
 
 #define EXT_ADDR_LEN 8
 
+#if defined (ZCL_SCENES)
+// Scene ID wildcard for the scene table RAM index lookups
+#define SCENE_IDX_ANY 0xFFFF
+
+// Scene table RAM index slot states
+#define SCENE_IDX_UNREAD 0    // not read from NV yet, or the read failed
+#define SCENE_IDX_FREE   1    // empty record in NV
+#define SCENE_IDX_USED   2    // scene record in NV
+#endif
+
 /*********************************************************************
  * TYPEDEFS
  */
@@ -93,6 +103,15 @@ typedef struct zclGenSceneNVItem
     uint8_t endpoint;
     zclGeneral_Scene_t scene;
 }zclGenSceneNVItem_t;
+
+// RAM index entry of a scene table slot
+typedef struct
+{
+    uint8_t state;
+    uint8_t endpoint;
+    uint8_t sceneID;
+    uint16_t groupID;
+} zclSceneIdx_t;
 #endif
 
 typedef struct
@@ -144,6 +163,11 @@ static zstack_sysNwkInfoReadRsp_t nwkInfo =
 
 #if defined (ZCL_SCENES)
 static uint8_t lastFindSceneEndpoint = 0xFF;
+
+// RAM index of the scene table, the slot number is the NV sub ID
+static zclSceneIdx_t sceneIdx[ZCL_GENERAL_MAX_SCENES];
+// True when every slot of the index has been read from NV
+static bool sceneIdxLoaded = false;
 #endif
 
 // Function pointer for applications to ZCL Handle External
@@ -155,6 +179,9 @@ static zclHandleExternalList_t *zclHandleExternalList = NULL;
 static void convertTxOptions(zstack_TransOptions_t *pOptions, uint8_t options);
 endPointDesc_t *zcl_afFindEndPointDesc(uint8_t EndPoint);
 uint8_t zclPortFindEntity(uint8_t EndPoint);
+#if defined (ZCL_SCENES)
+static void sceneIdxReset(void);
+#endif
 /*********************************************************************
 * PUBLIC FUNCTIONS
 *********************************************************************/
@@ -221,6 +248,7 @@ void zclport_registerNV(NVINTF_nvFuncts_t *pfnNV, uint16_t sceneNVID)
     pfnZclPortNV = pfnNV;
 #if defined (ZCL_SCENES)
     zclSceneNVID = sceneNVID;
+    sceneIdxReset();
 #endif
 }
 
@@ -1088,6 +1116,150 @@ static bool sceneRecEmpty(zclGenSceneNVItem_t *pNvItem)
     return(true);
 }
 
+/*********************************************************************
+ * @fn      sceneIdxSet
+ *
+ * @brief   Update the RAM index entry of a scene table slot
+ *
+ * @param   x - scene table slot (NV sub ID)
+ * @param   pNvItem - scene NV record written in the slot
+ */
+static void sceneIdxSet(uint16_t x, zclGenSceneNVItem_t *pNvItem)
+{
+    sceneIdx[x].state = SCENE_IDX_USED;
+    sceneIdx[x].endpoint = pNvItem->endpoint;
+    sceneIdx[x].sceneID = pNvItem->scene.ID;
+    sceneIdx[x].groupID = pNvItem->scene.groupID;
+}
+
+/*********************************************************************
+ * @fn      sceneIdxReset
+ *
+ * @brief   Forget the RAM index of the scene table, every slot is read
+ *          from NV again on next use
+ */
+static void sceneIdxReset(void)
+{
+    uint16_t x;
+
+    for(x = 0; x < ZCL_GENERAL_MAX_SCENES; x++)
+    {
+        sceneIdx[x].state = SCENE_IDX_UNREAD;
+    }
+    sceneIdxLoaded = false;
+}
+
+/*********************************************************************
+ * @fn      sceneIdxLoad
+ *
+ * @brief   Read the slots of the scene table RAM index that are not
+ *          known yet from NV. The index is then kept in sync by every
+ *          function writing the scene table.
+ *
+ *          A slot whose NV read fails stays SCENE_IDX_UNREAD, like an
+ *          unreadable record in the old NV scan: it matches no scene,
+ *          is not counted and is not reused by zclGeneral_AddScene().
+ *          Its read is retried on the next call.
+ */
+static void sceneIdxLoad(void)
+{
+    uint16_t x;
+    zclGenSceneNVItem_t nvItem;
+    bool loaded = true;
+
+    // Nothing to read without the NV driver
+    if( (sceneIdxLoaded == true) || (pfnZclPortNV == NULL) )
+    {
+        return;
+    }
+
+    for(x = 0; x < ZCL_GENERAL_MAX_SCENES; x++)
+    {
+        if(sceneIdx[x].state != SCENE_IDX_UNREAD)
+        {
+            continue;
+        }
+
+        // A missing item reads as an empty record
+        memset(&nvItem, 0xFF, sizeof(zclGenSceneNVItem_t));
+        if(zclport_readNV(zclSceneNVID, x, 0,
+                          sizeof(zclGenSceneNVItem_t), &nvItem) != SUCCESS)
+        {
+            loaded = false;
+        }
+        else if(sceneRecEmpty(&nvItem) == false)
+        {
+            sceneIdxSet(x, &nvItem);
+        }
+        else
+        {
+            sceneIdx[x].state = SCENE_IDX_FREE;
+        }
+    }
+
+    sceneIdxLoaded = loaded;
+}
+
+/*********************************************************************
+ * @fn      sceneIdxFind
+ *
+ * @brief   Find the next scene table slot matching a scene
+ *
+ * @param   x - first slot to look at
+ * @param   endpoint - endpoint to filter with, 0xFF for any endpoint
+ * @param   groupID - group ID looking for
+ * @param   sceneID - scene ID looking for, SCENE_IDX_ANY for any scene
+ *
+ * @return  slot found, ZCL_GENERAL_MAX_SCENES if none
+ */
+static uint16_t sceneIdxFind(uint16_t x, uint8_t endpoint, uint16_t groupID,
+                             uint16_t sceneID)
+{
+    for(; x < ZCL_GENERAL_MAX_SCENES; x++)
+    {
+        if( (sceneIdx[x].state == SCENE_IDX_USED)
+            && ( (sceneIdx[x].endpoint == endpoint) || (endpoint == 0xFF) )
+            && (sceneIdx[x].groupID == groupID)
+            && ( (sceneIdx[x].sceneID == sceneID)
+                 || (sceneID == SCENE_IDX_ANY) ) )
+        {
+            break;
+        }
+    }
+    return(x);
+}
+
+/*********************************************************************
+ * @fn      sceneIdxRemove
+ *
+ * @brief   Empty a scene table slot in NV and in the RAM index
+ *
+ * @param   x - scene table slot
+ *
+ * @return  SUCCESS if the NV record was written
+ */
+static uint8_t sceneIdxRemove(uint16_t x)
+{
+    zclGenSceneNVItem_t nvItem;
+    uint8_t status;
+
+    // Remove the item by setting it all to 0xFF
+    memset( &nvItem, 0xFF, sizeof(zclGenSceneNVItem_t) );
+    status = zclport_writeNV(zclSceneNVID, x,
+                             sizeof(zclGenSceneNVItem_t), &nvItem);
+    if(status == SUCCESS)
+    {
+        sceneIdx[x].state = SCENE_IDX_FREE;
+    }
+    else
+    {
+        // The NV record is unknown now, read it again on next use
+        sceneIdx[x].state = SCENE_IDX_UNREAD;
+        sceneIdxLoaded = false;
+    }
+    return(status);
+}
+
 /*********************************************************************
  * @fn      zclGeneral_ScenesInit
  *
@@ -1104,6 +1276,9 @@ void zclGeneral_ScenesInit(void)
         zclport_initializeNVItem(zclSceneNVID, x,
                                  sizeof(zclGenSceneNVItem_t), &temp);
     }
+
+    // Rebuild the RAM index on next use
+    sceneIdxReset();
 }
 
 /*********************************************************************
@@ -1117,23 +1292,14 @@ void zclGeneral_ScenesInit(void)
 void zclGeneral_RemoveAllScenes(uint8_t endpoint, uint16_t groupID)
 {
     uint16_t x;
-    zclGenSceneNVItem_t nvItem;
 
-    for(x = 0; x < ZCL_GENERAL_MAX_SCENES; x++)
+    sceneIdxLoad();
+
+    for(x = sceneIdxFind(0, endpoint, groupID, SCENE_IDX_ANY);
+        x < ZCL_GENERAL_MAX_SCENES;
+        x = sceneIdxFind(x + 1, endpoint, groupID, SCENE_IDX_ANY))
     {
-        if(zclport_readNV(zclSceneNVID, x, 0,
-                          sizeof(zclGenSceneNVItem_t), &nvItem) == SUCCESS)
-        {
-            if( (sceneRecEmpty(&nvItem) == false)
-                && ( (nvItem.endpoint == endpoint) || (endpoint == 0xFF) )
-                && (nvItem.scene.groupID == groupID) )
-            {
-                // Remove the item by setting it all to 0xFF
-                memset( &nvItem, 0xFF, sizeof(zclGenSceneNVItem_t) );
-                zclport_writeNV(zclSceneNVID, x,
-                                sizeof(zclGenSceneNVItem_t), &nvItem);
-            }
-        }
+        (void)sceneIdxRemove(x);
     }
 }
 
@@ -1151,32 +1317,13 @@ void zclGeneral_RemoveAllScenes(uint8_t endpoint, uint16_t groupID)
 uint8_t zclGeneral_RemoveScene(uint8_t endpoint, uint16_t groupID, uint8_t sceneID)
 {
     uint16_t x;
-    zclGenSceneNVItem_t nvItem;
 
-    for(x = 0; x < ZCL_GENERAL_MAX_SCENES; x++)
+    sceneIdxLoad();
+
+    x = sceneIdxFind(0, endpoint, groupID, sceneID);
+    if( (x < ZCL_GENERAL_MAX_SCENES) && (sceneIdxRemove(x) == SUCCESS) )
     {
-        if(zclport_readNV(zclSceneNVID, x, 0,
-                          sizeof(zclGenSceneNVItem_t), &nvItem) == SUCCESS)
-        {
-            if( (sceneRecEmpty(&nvItem) == false)
-                && ( (nvItem.endpoint == endpoint) || (endpoint == 0xFF) )
-                && (nvItem.scene.groupID == groupID)
-                && (nvItem.scene.ID == sceneID) )
-            {
-                // Remove the item by setting it all to 0xFF
-                memset( &nvItem, 0xFF, sizeof(zclGenSceneNVItem_t) );
-                if(zclport_writeNV(zclSceneNVID, x,
-                                   sizeof(zclGenSceneNVItem_t),
-                                   &nvItem) == SUCCESS)
-                {
-                    return(TRUE);
-                }
-                else
-                {
-                    return(FALSE);
-                }
-            }
-        }
+        return(TRUE);
     }
     return(FALSE);
 }
@@ -1201,26 +1348,22 @@ zclGeneral_Scene_t *zclGeneral_FindScene(uint8_t endpoint, uint16_t groupID,
 
     if(pEPDesc != NULL)
     {
-        for(x = 0; x < ZCL_GENERAL_MAX_SCENES; x++)
+        sceneIdxLoad();
+
+        // Only the matching record is read from NV
+        x = sceneIdxFind(0, endpoint, groupID, sceneID);
+        if( (x < ZCL_GENERAL_MAX_SCENES)
+            && (zclport_readNV(zclSceneNVID, x, 0,
+                               sizeof(zclGenSceneNVItem_t),
+                               &nvItem) == SUCCESS) )
         {
-            if(zclport_readNV(zclSceneNVID, x, 0,
-                              sizeof(zclGenSceneNVItem_t),
-                              &nvItem) == SUCCESS)
-            {
-                if( (sceneRecEmpty(&nvItem) == false)
-                    && ( (nvItem.endpoint == endpoint) || (endpoint == 0xFF) )
-                    && (nvItem.scene.groupID == groupID)
-                    && (nvItem.scene.ID == sceneID) )
-                {
-                    lastFindSceneEndpoint = endpoint;
-
-                    // Copy to a temp area
-                    OsalPort_memcpy( &(pEPDesc->scene), &(nvItem.scene),
-                            sizeof(zclGeneral_Scene_t) );
-
-                    return( &(pEPDesc->scene) );
-                }
-            }
+            lastFindSceneEndpoint = endpoint;
+
+            // Copy to a temp area
+            OsalPort_memcpy( &(pEPDesc->scene), &(nvItem.scene),
+                    sizeof(zclGeneral_Scene_t) );
+
+            return( &(pEPDesc->scene) );
         }
     }
 
@@ -1242,19 +1385,17 @@ ZStatus_t zclGeneral_AddScene(uint8_t endpoint, zclGeneral_Scene_t *scene)
     uint16_t x;
     zclGenSceneNVItem_t nvItem;
 
-    // See if the item exists already
+    sceneIdxLoad();
+
+    // See if the item exists already, the endpoint has to match exactly
     for(x = 0; x < ZCL_GENERAL_MAX_SCENES; x++)
     {
-        if(zclport_readNV(zclSceneNVID, x, 0,
-                          sizeof(zclGenSceneNVItem_t), &nvItem) == SUCCESS)
+        if( (sceneIdx[x].state == SCENE_IDX_USED)
+            && (sceneIdx[x].endpoint == endpoint)
+            && (sceneIdx[x].groupID == scene->groupID)
+            && (sceneIdx[x].sceneID == scene->ID) )
         {
-            if( (sceneRecEmpty(&nvItem) == false)
-                && (nvItem.endpoint == endpoint)
-                && (nvItem.scene.groupID == scene->groupID)
-                && (nvItem.scene.ID == scene->ID) )
-            {
-                break;
-            }
+            break;
         }
     }
 
@@ -1263,14 +1404,9 @@ ZStatus_t zclGeneral_AddScene(uint8_t endpoint, zclGeneral_Scene_t *scene)
     {
         for(x = 0; x < ZCL_GENERAL_MAX_SCENES; x++)
         {
-            if(zclport_readNV(zclSceneNVID, x, 0,
-                              sizeof(zclGenSceneNVItem_t),
-                              &nvItem) == SUCCESS)
+            if(sceneIdx[x].state == SCENE_IDX_FREE)
             {
-                if( sceneRecEmpty(&nvItem) )
-                {
-                    break;
-                }
+                break;
             }
         }
     }
@@ -1287,10 +1423,14 @@ ZStatus_t zclGeneral_AddScene(uint8_t endpoint, zclGeneral_Scene_t *scene)
     if(zclport_writeNV(zclSceneNVID, x,
                        sizeof(zclGenSceneNVItem_t), &nvItem) == SUCCESS)
     {
+        sceneIdxSet(x, &nvItem);
         return(ZSuccess);
     }
     else
     {
+        // The NV record is unknown now, read it again on next use
+        sceneIdx[x].state = SCENE_IDX_UNREAD;
+        sceneIdxLoaded = false;
         return(ZFailure);
     }
 }
@@ -1305,18 +1445,15 @@ ZStatus_t zclGeneral_AddScene(uint8_t endpoint, zclGeneral_Scene_t *scene)
 uint8_t zclGeneral_CountAllScenes(void)
 {
     uint16_t x;
-    zclGenSceneNVItem_t nvItem;
     uint8_t cnt = 0;
 
+    sceneIdxLoad();
+
     for(x = 0; x < ZCL_GENERAL_MAX_SCENES; x++)
     {
-        if(zclport_readNV(zclSceneNVID, x, 0,
-                          sizeof(zclGenSceneNVItem_t), &nvItem) == SUCCESS)
+        if(sceneIdx[x].state == SCENE_IDX_USED)
         {
-            if(sceneRecEmpty(&nvItem) == false)
-            {
-                cnt++;
-            }
+            cnt++;
         }
     }
 
@@ -1337,20 +1474,17 @@ uint8_t zclGeneral_FindAllScenesForGroup(uint8_t endpoint, uint16_t groupID,
                                        uint8_t *sceneList)
 {
     uint16_t x;
-    zclGenSceneNVItem_t nvItem;
     uint8_t cnt = 0;
 
+    sceneIdxLoad();
+
     for(x = 0; x < ZCL_GENERAL_MAX_SCENES; x++)
     {
-        if(zclport_readNV(zclSceneNVID, x, 0,
-                          sizeof(zclGenSceneNVItem_t), &nvItem) == SUCCESS)
+        if( (sceneIdx[x].state == SCENE_IDX_USED)
+            && (sceneIdx[x].endpoint == endpoint) &&
+            (sceneIdx[x].groupID == groupID) )
         {
-            if( (sceneRecEmpty(&nvItem) == false)
-                && (nvItem.endpoint == endpoint) &&
-                (nvItem.scene.groupID == groupID) )
-            {
-                sceneList[cnt++] = nvItem.scene.ID;
-            }
+            sceneList[cnt++] = sceneIdx[x].sceneID;
         }
     }
     return(cnt);
@@ -0,0 +1,84 @@
+/******************************************************************************
+
+ @file  api_mac.h
+
+ @brief Host stand-in of the TI 15.4 MAC API header
+
+ Group: WCS, LPC
+ Target Device: cc13xx_cc26xx
+
+ ******************************************************************************
+ 
+ Copyright (c) 2019-2026, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ 
+ 
+ *****************************************************************************/
+
+/*
+Only the types mac_api.h refers to are provided, so that the Z-Stack headers
+can be included by the host builds of the stack sources. None of the MAC API
+functions are available on the host.
+
+The SDK header brings the OSAL port definitions in with its own includes,
+assoc_list.h and af.h rely on that.
+*/
+
+#ifndef API_MAC_H
+#define API_MAC_H
+
+#include <stdint.h>
+#include <zstack/osal_port/osal_port.h>
+
+typedef uint8_t ApiMac_status_t;
+
+typedef struct
+{
+    uint8_t keySource[8];
+    uint8_t securityLevel;
+    uint8_t keyIdMode;
+    uint8_t keyIndex;
+} ApiMac_sec_t;
+
+// MAC requests, opaque to the host builds
+typedef struct { uint8_t unused; } ApiMac_mcpsDataReq_t;
+typedef struct { uint8_t unused; } ApiMac_mlmeAssociateReq_t;
+typedef struct { uint8_t unused; } ApiMac_mlmeAssociateRsp_t;
+typedef struct { uint8_t unused; } ApiMac_mlmeDisassociateReq_t;
+typedef struct { uint8_t unused; } ApiMac_mlmeOrphanRsp_t;
+typedef struct { uint8_t unused; } ApiMac_mlmePollReq_t;
+typedef struct { uint8_t unused; } ApiMac_mlmeScanReq_t;
+typedef struct { uint8_t unused; } ApiMac_mlmeStartReq_t;
+typedef struct { uint8_t unused; } ApiMac_mlmeSyncReq_t;
+typedef struct { uint8_t unused; } ApiMac_mlmeWSAsyncReq_t;
+
+#endif /* API_MAC_H */
@@ -0,0 +1,78 @@
+/******************************************************************************
+
+ @file  ext_flash_layout.h
+
+ @brief Host stand-in of the OAD external flash layout
+
+ Group: WCS, LPC
+ Target Device: cc13xx_cc26xx
+
+ ******************************************************************************
+ 
+ Copyright (c) 2019-2026, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ 
+ 
+ *****************************************************************************/
+
+/*
+External flash layout of the OAD images: metadata pages from the start of
+the flash, image binaries from the end.
+*/
+
+#ifndef EXT_FLASH_LAYOUT_H
+#define EXT_FLASH_LAYOUT_H
+
+#include <stdint.h>
+
+#include "oad_image_header.h"
+
+#if !defined EFL_FLASH_SIZE
+  #define EFL_FLASH_SIZE            0x100000
+#endif
+#define EFL_PAGE_SIZE               0x1000
+
+#define EFL_ADDR_META               0x00000
+#define EFL_ADDR_META_FACT_IMG      EFL_ADDR_META
+#define EFL_FACT_IMG_META_PG        0
+
+// Metadata of an image in external flash
+typedef struct __attribute__((packed))
+{
+  imgFixedHdr_t fixedHdr;
+  uint32_t      extFlAddr;
+  uint32_t      counter;
+} ExtImageInfo_t;
+
+#define EFL_METADATA_LEN            sizeof(ExtImageInfo_t)
+
+#endif /* EXT_FLASH_LAYOUT_H */
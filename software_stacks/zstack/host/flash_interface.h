@@ -0,0 +1,82 @@
+/******************************************************************************
+
+ @file  flash_interface.h
+
+ @brief Host stand-in of the OAD flash interface
+
+ Group: WCS, LPC
+ Target Device: cc13xx_cc26xx
+
+ ******************************************************************************
+ 
+ Copyright (c) 2019-2026, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ 
+ 
+ *****************************************************************************/
+
+/*
+Flash access of the OAD image download. Host programs that download images
+provide the functions, usually over a simulated flash.
+*/
+
+#ifndef FLASH_INTERFACE_H
+#define FLASH_INTERFACE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ext_flash_layout.h"
+
+#define FLASH_SUCCESS               0
+#define FLASH_FAILURE               0xFF
+
+// Page bits of a flash address, addr & ~mask is the offset in the page
+#define EXTFLASH_PAGE_MASK          (~(uint32_t)(EFL_PAGE_SIZE - 1))
+#define EXT_FLASH_PAGE(addr)        ((addr) >> 12)
+#define EXT_FLASH_ADDRESS(page, offset) (((page) << 12) + (offset))
+
+#if !defined INTFLASH_PAGE_SIZE
+  #define INTFLASH_PAGE_SIZE        0x2000
+#endif
+#define INTFLASH_PAGE_MASK          (~(uint32_t)(INTFLASH_PAGE_SIZE - 1))
+#define FLASH_PAGE(addr)            ((addr) / INTFLASH_PAGE_SIZE)
+
+extern bool flash_open(void);
+extern void flash_close(void);
+extern uint8_t readFlash(uint32_t addr, uint8_t *pBuf, size_t len);
+extern uint8_t readFlashPg(uint8_t page, uint32_t offset, uint8_t *pBuf, uint16_t len);
+extern uint8_t writeFlashPg(uint8_t page, uint32_t offset, uint8_t *pBuf, uint16_t len);
+extern uint8_t eraseFlashPg(uint8_t page);
+
+#endif /* FLASH_INTERFACE_H */
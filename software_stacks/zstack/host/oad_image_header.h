@@ -0,0 +1,114 @@
+/******************************************************************************
+
+ @file  oad_image_header.h
+
+ @brief Host stand-in of the OAD image header definitions
+
+ Group: WCS, LPC
+ Target Device: cc13xx_cc26xx
+
+ ******************************************************************************
+ 
+ Copyright (c) 2019-2026, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ 
+ 
+ *****************************************************************************/
+
+/*
+Layout of the OAD image header the ZCL OTA client checks and stores, with
+the fields it uses at their target offsets.
+*/
+
+#ifndef OAD_IMAGE_HEADER_H
+#define OAD_IMAGE_HEADER_H
+
+#include <stdint.h>
+
+#define OAD_IMG_ID_VAL              {'C', 'C', '2', '6', 'x', '2', 'R', '1'}
+#define OAD_EXTFL_ID_VAL            {'O', 'A', 'D', ' ', 'N', 'V', 'M', '1'}
+
+#define BIM_VER                     0x03
+
+#define OAD_WIRELESS_TECH_ZIGBEE    0xFFEF
+#define OAD_IMG_TYPE_APPSTACKLIB    1
+
+#define CRC_VALID                   0xFE
+#define CRC_INVALID                 0xFC
+
+// Offset of crcStat in the image header
+#define CRC_STAT_OFFSET             17
+
+// The image CRC covers the image from this offset, after imgID and crc32
+#define OAD_IMG_CRC_START           12
+
+// Fixed image header
+typedef struct __attribute__((packed))
+{
+  uint8_t   imgID[8];
+  uint32_t  crc32;
+  uint8_t   bimVer;
+  uint8_t   metaVer;
+  uint16_t  techType;
+  uint8_t   imgCpStat;
+  uint8_t   crcStat;
+  uint8_t   imgType;
+  uint8_t   imgNo;
+  uint32_t  imgVld;
+  uint32_t  len;
+  uint32_t  prgEntry;
+  uint8_t   softVer[4];
+  uint32_t  imgEndAddr;
+  uint16_t  hdrLen;
+  uint16_t  rfu;
+} imgFixedHdr_t;
+
+#define OAD_IMG_HDR_LEN             sizeof(imgFixedHdr_t)
+
+// Image payload segment
+typedef struct __attribute__((packed))
+{
+  uint8_t   segTypeImg;
+  uint16_t  wirelessTech;
+  uint8_t   rfu;
+  uint32_t  imgSegLen;
+  uint32_t  startAddr;
+} imgPayloadSeg_t;
+
+// Image header at the start of an OAD image
+typedef struct __attribute__((packed))
+{
+  imgFixedHdr_t   fixedHdr;
+  imgPayloadSeg_t imgPayload;
+} imgHdr_t;
+
+#endif /* OAD_IMAGE_HEADER_H */
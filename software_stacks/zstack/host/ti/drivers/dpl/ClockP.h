@@ -0,0 +1,106 @@
+/******************************************************************************
+
+ @file  ClockP.h
+
+ @brief Clock module of the driver porting layer for host builds
+
+ Group: WCS, LPC
+ Target Device: cc13xx_cc26xx
+
+ ******************************************************************************
+ 
+ Copyright (c) 2019-2026, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ 
+ 
+ *****************************************************************************/
+
+/*
+The subset of the ClockP API the OSAL port uses. The host builds have no
+kernel clock, a host program implements these functions on a clock it
+advances itself.
+*/
+
+#ifndef ti_dpl_ClockP__include
+#define ti_dpl_ClockP__include
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+// Includes
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+
+//*****************************************************************************
+// Typedefs
+//*****************************************************************************
+
+typedef void *ClockP_Handle;
+
+typedef void (*ClockP_Fxn)(uintptr_t arg);
+
+typedef struct
+{
+    char      *name;        // name of the clock instance, unused
+    uint32_t   period;      // period in ticks, 0 for one shot
+    bool       startFlag;   // start the clock when it is created
+    uintptr_t  arg;         // argument of the clock function
+} ClockP_Params;
+
+//*****************************************************************************
+// API Functions
+//*****************************************************************************
+
+extern void ClockP_Params_init(ClockP_Params *params);
+extern ClockP_Handle ClockP_create(ClockP_Fxn clockFxn, uint32_t timeout,
+                                   ClockP_Params *params);
+extern void ClockP_delete(ClockP_Handle handle);
+extern void ClockP_start(ClockP_Handle handle);
+extern void ClockP_stop(ClockP_Handle handle);
+extern void ClockP_setTimeout(ClockP_Handle handle, uint32_t timeout);
+extern uint32_t ClockP_getTimeout(ClockP_Handle handle);
+extern bool ClockP_isActive(ClockP_Handle handle);
+
+// System tick counter and its period in microseconds
+extern uint32_t ClockP_getSystemTicks(void);
+extern uint32_t ClockP_getSystemTickPeriod(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ti_dpl_ClockP__include */
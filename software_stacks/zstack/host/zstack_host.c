@@ -0,0 +1,326 @@
+/******************************************************************************
+
+ @file  zstack_host.c
+
+ @brief Host runtime for the Z-Stack host builds
+
+ Group: WCS, LPC
+ Target Device: cc13xx_cc26xx
+
+ ******************************************************************************
+ 
+ Copyright (c) 2019-2026, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ 
+ 
+ *****************************************************************************/
+
+//*****************************************************************************
+// Includes
+//*****************************************************************************
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <zstack/osal_port/osal_port.h>
+#include <zstack/bdb/bdb.h>
+#include "zstack_host.h"
+
+//*****************************************************************************
+// Constants and Definitions
+//*****************************************************************************
+
+// Endpoints afFindEndPointDesc() can look up
+#define ZSTACK_HOST_MAX_ENDPOINTS   16
+
+// Task IDs messages can be sent to
+#define ZSTACK_HOST_MAX_TASKS       16
+
+//*****************************************************************************
+// Globals
+//*****************************************************************************
+
+ZstackHost_stats_t ZstackHost_stats;
+
+//*****************************************************************************
+// Locals
+//*****************************************************************************
+
+static ZstackHost_afDataCb_t ZstackHost_afDataCb;
+
+static endPointDesc_t *ZstackHost_endpoints[ZSTACK_HOST_MAX_ENDPOINTS];
+static uint8_t ZstackHost_numEndpoints;
+
+// Message queue of each task, head and tail
+static uint8_t *ZstackHost_msgHead[ZSTACK_HOST_MAX_TASKS];
+static uint8_t *ZstackHost_msgTail[ZSTACK_HOST_MAX_TASKS];
+
+//*****************************************************************************
+// API Functions
+//*****************************************************************************
+
+/*
+ * Reset the counters, except inUse
+ */
+void ZstackHost_resetStats(void)
+{
+    uint32_t inUse = ZstackHost_stats.inUse;
+
+    memset(&ZstackHost_stats, 0, sizeof(ZstackHost_stats));
+    ZstackHost_stats.inUse = inUse;
+}
+
+/*
+ * Set the callback of AF data requests
+ */
+void ZstackHost_setAfDataCb(ZstackHost_afDataCb_t cb)
+{
+    ZstackHost_afDataCb = cb;
+}
+
+/*
+ * Make an endpoint known to afFindEndPointDesc()
+ */
+bool ZstackHost_addEndpoint(endPointDesc_t *epDesc)
+{
+    if(ZstackHost_numEndpoints >= ZSTACK_HOST_MAX_ENDPOINTS)
+    {
+        return(false);
+    }
+    ZstackHost_endpoints[ZstackHost_numEndpoints++] = epDesc;
+    return(true);
+}
+
+//*****************************************************************************
+// OSAL port
+//*****************************************************************************
+
+void *OsalPort_malloc(uint32_t size)
+{
+    ZstackHost_stats.mallocs++;
+    ZstackHost_stats.mallocBytes += size;
+    ZstackHost_stats.inUse++;
+    return(malloc(size ? size : 1));
+}
+
+void OsalPort_free(void *buf)
+{
+    if(buf != NULL)
+    {
+        ZstackHost_stats.frees++;
+        ZstackHost_stats.inUse--;
+        free(buf);
+    }
+}
+
+void *OsalPort_memcpy(void *dst, const void *src, unsigned int len)
+{
+    ZstackHost_stats.copies++;
+    ZstackHost_stats.copyBytes += len;
+    memcpy(dst, src, len);
+    return((uint8_t *)dst + len);
+}
+
+uint32_t OsalPort_buildUint32(uint8_t *swapped, uint8_t len)
+{
+    uint32_t val = 0;
+
+    if((len == 0) || (len > 4))
+    {
+        return(0xFEFEFEFE);
+    }
+    while(len > 0)
+    {
+        len--;
+        val = (val << 8) | swapped[len];
+    }
+    return(val);
+}
+
+uint8_t *OsalPort_bufferUint32(uint8_t *buf, uint32_t val)
+{
+    *buf++ = (uint8_t)val;
+    *buf++ = (uint8_t)(val >> 8);
+    *buf++ = (uint8_t)(val >> 16);
+    *buf++ = (uint8_t)(val >> 24);
+    return(buf);
+}
+
+uint32_t OsalPort_enterCS(void)
+{
+    // The host builds are single threaded
+    return(0);
+}
+
+void OsalPort_leaveCS(uint32_t key)
+{
+    (void)key;
+}
+
+uint8_t *OsalPort_msgAllocate(uint16_t len)
+{
+    OsalPort_MsgHdr *hdr = OsalPort_malloc(sizeof(OsalPort_MsgHdr) + len);
+
+    if(hdr == NULL)
+    {
+        return(NULL);
+    }
+    hdr->next = NULL;
+    hdr->len = len;
+    hdr->dest_id = OsalPort_TASK_NO_TASK;
+    return((uint8_t *)(hdr + 1));
+}
+
+uint8_t OsalPort_msgDeallocate(uint8_t *pMsg)
+{
+    if(pMsg == NULL)
+    {
+        return(OsalPort_INVALID_MSG_POINTER);
+    }
+    OsalPort_free((OsalPort_MsgHdr *)pMsg - 1);
+    return(OsalPort_SUCCESS);
+}
+
+uint8_t OsalPort_msgSend(uint8_t destinationTask, uint8_t *pMsg)
+{
+    if(pMsg == NULL)
+    {
+        return(OsalPort_INVALID_MSG_POINTER);
+    }
+    if(destinationTask >= ZSTACK_HOST_MAX_TASKS)
+    {
+        OsalPort_msgDeallocate(pMsg);
+        return(OsalPort_INVALID_TASK);
+    }
+
+    OsalPort_MSG_NEXT(pMsg) = NULL;
+    OsalPort_MSG_ID(pMsg) = destinationTask;
+    if(ZstackHost_msgTail[destinationTask] == NULL)
+    {
+        ZstackHost_msgHead[destinationTask] = pMsg;
+    }
+    else
+    {
+        OsalPort_MSG_NEXT(ZstackHost_msgTail[destinationTask]) = pMsg;
+    }
+    ZstackHost_msgTail[destinationTask] = pMsg;
+    return(OsalPort_SUCCESS);
+}
+
+uint8_t *OsalPort_msgReceive(uint8_t taskId)
+{
+    uint8_t *pMsg;
+
+    if(taskId >= ZSTACK_HOST_MAX_TASKS)
+    {
+        return(NULL);
+    }
+    pMsg = ZstackHost_msgHead[taskId];
+    if(pMsg != NULL)
+    {
+        ZstackHost_msgHead[taskId] = OsalPort_MSG_NEXT(pMsg);
+        if(ZstackHost_msgHead[taskId] == NULL)
+        {
+            ZstackHost_msgTail[taskId] = NULL;
+        }
+    }
+    return(pMsg);
+}
+
+//*****************************************************************************
+// AF
+//*****************************************************************************
+
+afStatus_t AF_DataRequest(afAddrType_t *dstAddr, endPointDesc_t *srcEP,
+                          uint16_t cID, uint16_t len, uint8_t *buf,
+                          uint8_t *transID, uint8_t options, uint8_t radius)
+{
+    (void)radius;
+
+    ZstackHost_stats.afRequests++;
+    // AF copies the payload into the APS frame
+    ZstackHost_stats.afCopyBytes += len;
+    if(transID != NULL)
+    {
+        (*transID)++;
+    }
+
+    if(ZstackHost_afDataCb != NULL)
+    {
+        return(ZstackHost_afDataCb(dstAddr, srcEP, cID, len, buf, options));
+    }
+    return(afStatus_SUCCESS);
+}
+
+afStatus_t zcl_AF_DataRequest(afAddrType_t *dstAddr, endPointDesc_t *srcEP,
+                              uint16_t cID, uint16_t bufLen, uint8_t *buf,
+                              uint8_t *transID, uint8_t options, uint8_t radius)
+{
+    // On target this goes through the stack thread, the frame is the same
+    return(AF_DataRequest(dstAddr, srcEP, cID, bufLen, buf, transID, options,
+                          radius));
+}
+
+endPointDesc_t *afFindEndPointDesc(uint8_t endPoint)
+{
+    uint8_t i;
+
+    for(i = 0; i < ZstackHost_numEndpoints; i++)
+    {
+        if(ZstackHost_endpoints[i]->endPoint == endPoint)
+        {
+            return(ZstackHost_endpoints[i]);
+        }
+    }
+    return(NULL);
+}
+
+//*****************************************************************************
+// BDB hooks of the ZCL
+//*****************************************************************************
+
+void bdb_ZclIdentifyCmdInd(uint16_t identifyTime, uint8_t endpoint)
+{
+    (void)identifyTime;
+    (void)endpoint;
+}
+
+endPointDesc_t *bdb_setEpDescListToActiveEndpoint(void)
+{
+    return(NULL);
+}
+
+ZStatus_t bdb_SetIdentifyActiveEndpoint(uint8_t activeEndpoint)
+{
+    (void)activeEndpoint;
+    return(ZSuccess);
+}
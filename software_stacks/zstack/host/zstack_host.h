@@ -0,0 +1,142 @@
+/******************************************************************************
+
+ @file  zstack_host.h
+
+ @brief Host runtime for the Z-Stack host builds
+
+ Group: WCS, LPC
+ Target Device: cc13xx_cc26xx
+
+ ******************************************************************************
+ 
+ Copyright (c) 2019-2026, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ 
+ 
+ *****************************************************************************/
+
+/*
+zstack_host.c provides the OSAL port memory, message and critical section
+functions, AF_DataRequest() and the endpoint lookup of AF for host builds of
+Z-Stack sources such as zcl.c, so that those sources can be exercised by
+tests and benchmarks on Linux. It counts allocations and copies, and hands
+every AF data request to a callback, where a test can inspect the frame or
+loop it back into the stack.
+
+Build with the stand-in headers of this directory first in the include path:
+
+  -Isoftware_stacks/zstack/host -I. -Isoftware_stacks \
+  -Isoftware_stacks/ti15_4stack/hal/platform \
+  -Isoftware_stacks/ti15_4stack/mac/services -Isoftware_stacks/ti15_4stack/mac \
+  -Isoftware_stacks/zstack/af -Isoftware_stacks/zstack/bdb \
+  -Isoftware_stacks/zstack/sys -Isoftware_stacks/zstack/nwk \
+  -Isoftware_stacks/zstack/osal_port -Isoftware_stacks/zstack/common/zcl \
+  -Isoftware_stacks/zstack/stack_task -Isoftware_stacks/zstack/zdo \
+  -Isoftware_stacks/zstack/sec -Isoftware_stacks/zstack/gp \
+  -Isoftware_stacks/zstack/zmac -Idrivers/nv -DOSAL_PORT2TIRTOS
+*/
+
+#ifndef ZSTACK_HOST_H
+#define ZSTACK_HOST_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+// Includes
+//*****************************************************************************
+
+#include <stdint.h>
+#include <zstack/af/af.h>
+
+//*****************************************************************************
+// Typedefs
+//*****************************************************************************
+
+// Counters of the host runtime
+typedef struct
+{
+    uint32_t mallocs;       // OsalPort_malloc() and OsalPort_msgAllocate() calls
+    uint32_t mallocBytes;   // bytes requested by those calls
+    uint32_t frees;         // OsalPort_free() and OsalPort_msgDeallocate() calls
+    uint32_t inUse;         // blocks allocated and not freed
+    uint32_t copies;        // OsalPort_memcpy() calls
+    uint32_t copyBytes;     // bytes copied by those calls
+    uint32_t afRequests;    // AF_DataRequest() calls
+    uint32_t afCopyBytes;   // payload bytes AF copies into the APS frame
+} ZstackHost_stats_t;
+
+// Called for every AF data request, its return value is returned by
+// AF_DataRequest()
+typedef afStatus_t (*ZstackHost_afDataCb_t)(afAddrType_t *dstAddr,
+                                             endPointDesc_t *srcEP,
+                                             uint16_t cID, uint16_t len,
+                                             uint8_t *buf, uint8_t options);
+
+//*****************************************************************************
+// Globals
+//*****************************************************************************
+
+extern ZstackHost_stats_t ZstackHost_stats;
+
+//*****************************************************************************
+// API Functions
+//*****************************************************************************
+
+/*
+ * @brief Reset the counters, except inUse
+ */
+extern void ZstackHost_resetStats(void);
+
+/*
+ * @brief Set the callback of AF data requests
+ *
+ * @param cb - callback, NULL to accept every request without looking at it
+ */
+extern void ZstackHost_setAfDataCb(ZstackHost_afDataCb_t cb);
+
+/*
+ * @brief Make an endpoint known to afFindEndPointDesc()
+ *
+ * @param epDesc - endpoint descriptor, kept by reference
+ *
+ * @return true if added, false if the endpoint table is full
+ */
+extern bool ZstackHost_addEndpoint(endPointDesc_t *epDesc);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ZSTACK_HOST_H */
@@ -74,6 +74,7 @@
 #include <zstack/nwk/nwk_util.h>
 #include <zstack/osal_port/osal_nv.h>
 #include <zstack/sys/zcomdef.h>
+#include <zstack/zdo/zd_app.h>
 #ifdef BDB_REPORTING
 #include <zstack/bdb/bdb_reporting.h>
 #endif
@@ -81,6 +82,9 @@
 /*********************************************************************
  * MACROS
  */
+#define BIND_DIRTY_SET( x )    ( BindingTableDirty[(x) >> 3] |= (uint8_t)(1 << ((x) & 0x07)) )
+#define BIND_DIRTY_CLR( x )    ( BindingTableDirty[(x) >> 3] &= (uint8_t)~(1 << ((x) & 0x07)) )
+#define BIND_DIRTY_GET( x )    ( BindingTableDirty[(x) >> 3] & (1 << ((x) & 0x07)) )
 
 /*********************************************************************
  * CONSTANTS
@@ -89,6 +93,13 @@
 #define NV_BIND_REC_SIZE (gBIND_REC_SIZE)
 #define NV_BIND_ITEM_SIZE  (gBIND_REC_SIZE * gNWK_MAX_BINDING_ENTRIES)
 
+// Time (ms) changed binding records are held in RAM before being written
+// to NV, so bursts of binding changes result in a single write per record.
+// Set to 0 to write a record as soon as a new binding is added.
+#if !defined ( BIND_NV_UPDATE_DELAY )
+  #define BIND_NV_UPDATE_DELAY  0
+#endif
+
 /*********************************************************************
  * TYPEDEFS
  */
@@ -118,6 +129,7 @@ BindingEntry_t *bindFindEmpty(  bindTableIndex_t* bindTableIndex  );
 uint16_t bindingAddrMgsHelperFind( zAddrType_t *addr );
 uint8_t bindingAddrMgsHelperConvert( uint16_t idx, zAddrType_t *addr );
 void bindAddrMgrLocalLoad( void );
+static void bindClearDirty( void );
 
 
 /*********************************************************************
@@ -171,6 +183,7 @@ void BindAddrMgrCB( uint8_t update, AddrMgrEntry_t *entryNew,
 void InitBindingTable( void )
 {
   memset( BindingTable, 0xFF, gBIND_REC_SIZE * gNWK_MAX_BINDING_ENTRIES );
+  bindClearDirty();
 
   pbindAddEntry = bindAddEntry;
   pbindNumOfEntries = bindNumOfEntries;
@@ -371,7 +384,7 @@ BindingEntry_t *bindAddEntry( byte srcEpInt,
         // Found - is the cluster already defined?
         if ( bindIsClusterIDinList( entry, clusterIds[index] ) == FALSE )
         {
-          // Nope, add this cluster
+          // Nope, add this cluster (marks the record dirty)
           if ( bindAddClusterIdToList( entry, clusterIds[index] ) == FALSE )
           {
             // Indicate error if cluster list was full
@@ -379,10 +392,6 @@ BindingEntry_t *bindAddEntry( byte srcEpInt,
           }
           else
           {
-            // Save the record to NV
-            osal_nv_write_ex( ZCD_NV_EX_BINDING_TABLE, bindIdx,
-                           (uint16_t)NV_BIND_REC_SIZE, &BindingTable[bindIdx] );
-
 #if (BDB_FINDING_BINDING_CAPABILITY_ENABLED==1)
             // new bind added - notify application
             bindData.clusterId = clusterIds[index];
@@ -442,12 +451,15 @@ BindingEntry_t *bindAddEntry( byte srcEpInt,
                      clusterIds,
                      numClusterIds * sizeof(uint16_t) );
 
-        // Save the record to NV
-        osal_nv_write_ex( ZCD_NV_EX_BINDING_TABLE, bindTableIndex,
-                         (uint16_t)NV_BIND_REC_SIZE, &BindingTable[bindTableIndex] );
+        bindMarkDirty( entry );
       }
     }
   }
+
+#if ( BIND_NV_UPDATE_DELAY == 0 )
+  // Save the changed record to NV, once for all the clusters added
+  BindWriteNV();
+#endif
 #ifdef BDB_REPORTING
   if(bindAdded == TRUE)
   {
@@ -469,12 +481,59 @@ BindingEntry_t *bindAddEntry( byte srcEpInt,
 byte bindRemoveEntry( BindingEntry_t *pBind )
 {
   memset( pBind, 0xFF, gBIND_REC_SIZE );
+  bindMarkDirty( pBind );
 #ifdef BDB_REPORTING
   bdb_RepUpdateMarkBindings();
 #endif
   return ( TRUE );
 }
 
+/*********************************************************************
+ * @fn      bindMarkDirty
+ *
+ * @brief   Flags a binding table entry as changed, so that the next
+ *          BindWriteNV() saves it. With BIND_NV_UPDATE_DELAY set, an
+ *          NV update is also scheduled if one isn't already pending.
+ *
+ * @param   pBind - pointer to the changed binding table entry
+ *
+ * @return  none
+ */
+void bindMarkDirty( BindingEntry_t *pBind )
+{
+  bindTableIndex_t x = (bindTableIndex_t)(pBind - BindingTable);
+
+  if ( x < gNWK_MAX_BINDING_ENTRIES )
+  {
+    BIND_DIRTY_SET( x );
+
+#if ( BIND_NV_UPDATE_DELAY > 0 )
+    if ( !OsalPortTimers_getTimerTimeout( ZDAppTaskID, ZDO_BIND_UPDATE_NV ) )
+    {
+      OsalPortTimers_startTimer( ZDAppTaskID, ZDO_BIND_UPDATE_NV, BIND_NV_UPDATE_DELAY );
+    }
+#endif
+  }
+}
+
+/*********************************************************************
+ * @fn      bindClearDirty
+ *
+ * @brief   Flags all binding table entries as matching NV.
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+static void bindClearDirty( void )
+{
+  memset( BindingTableDirty, 0, (gNWK_MAX_BINDING_ENTRIES + 7) / 8 );
+
+#if ( BIND_NV_UPDATE_DELAY > 0 )
+  OsalPortTimers_stopTimer( ZDAppTaskID, ZDO_BIND_UPDATE_NV );
+#endif
+}
+
 /*********************************************************************
  * @fn      bindIsClusterIDinList()
  *
@@ -539,6 +598,7 @@ byte bindRemoveClusterIdFromList( BindingEntry_t *entry, uint16_t clusterId )
         else
         {
           entry->numClusterIds--;
+          bindMarkDirty( entry );
 
 #ifdef BDB_REPORTING
            numRemoved++;
@@ -585,6 +645,7 @@ byte bindAddClusterIdToList( BindingEntry_t *entry, uint16_t clusterId )
     // Add the new one
     entry->clusterIdList[entry->numClusterIds] = clusterId;
     entry->numClusterIds++;
+    bindMarkDirty( entry );
     return ( TRUE );
   }
   return ( FALSE );
@@ -921,6 +982,7 @@ void bindUpdateAddr( uint16_t oldAddr, uint16_t newAddr )
     if ( pBind->dstIdx == oldIdx )
     {
       pBind->dstIdx = newIdx;
+      bindMarkDirty( pBind );
     }
   }
 }
@@ -1181,6 +1243,8 @@ void BindSetDefaultNV( void )
     // Over write each binding record with an "empty" record
     osal_nv_write_ex( ZCD_NV_EX_BINDING_TABLE, x, NV_BIND_REC_SIZE, &bind );
   }
+
+  bindClearDirty();
 }
 
 /*********************************************************************
@@ -1211,13 +1275,18 @@ uint16_t BindRestoreFromNV( void )
       }
     }
   }
+
+  // RAM and NV now match
+  bindClearDirty();
+
   return ( validRecsCount );
 }
 
 /*********************************************************************
  * @fn          BindWriteNV
  *
- * @brief       Copy the Binding Table in NV
+ * @brief       Copy the Binding Table in NV. Only the records flagged
+ *              by bindMarkDirty() since the last update are written.
  *
  * @param       none
  *
@@ -1229,10 +1298,20 @@ void BindWriteNV( void )
 
   for ( x = 0; x < gNWK_MAX_BINDING_ENTRIES; x++ )
   {
-    // Save the record to NV
-    osal_nv_write_ex( ZCD_NV_EX_BINDING_TABLE, x,
-                     (uint16_t)NV_BIND_REC_SIZE, &BindingTable[x] );
+    if ( BIND_DIRTY_GET( x ) )
+    {
+      // Save the record to NV, keep it flagged if the write failed
+      if ( osal_nv_write_ex( ZCD_NV_EX_BINDING_TABLE, x,
+                            (uint16_t)NV_BIND_REC_SIZE, &BindingTable[x] ) == SUCCESS )
+      {
+        BIND_DIRTY_CLR( x );
+      }
+    }
   }
+
+#if ( BIND_NV_UPDATE_DELAY > 0 )
+  OsalPortTimers_stopTimer( ZDAppTaskID, ZDO_BIND_UPDATE_NV );
+#endif
 }
 
 /*********************************************************************
@@ -132,6 +132,10 @@ typedef struct
 // number of records - use gNWK_MAX_BINDING_ENTRIES.
 extern BindingEntry_t BindingTable[];
 
+// One bit per BindingTable record, set when the record has changed since
+// it was last written to NV. Defined in nwk_globals.c.
+extern uint8_t BindingTableDirty[];
+
 /*********************************************************************
  * FUNCTIONS
  */
@@ -146,6 +150,12 @@ extern void InitBindingTable( void );
  */
 extern byte bindRemoveEntry( BindingEntry_t *pBind );
 
+/*
+ * Flag a binding table entry as changed so the next NV update saves it.
+ * Must be called by any code that modifies a BindingTable record directly.
+ */
+extern void bindMarkDirty( BindingEntry_t *pBind );
+
 /*
  * Is the clusterID in the clusterID list?
  */
@@ -273,6 +273,9 @@ CONST uint16_t gBIND_REC_SIZE = sizeof( BindingEntry_t );
 // Binding Table
 BindingEntry_t BindingTable[NWK_MAX_BINDING_ENTRIES];
 
+// Binding Table records changed since they were last written to NV (1 bit per record)
+uint8_t BindingTableDirty[(NWK_MAX_BINDING_ENTRIES + 7) / 8];
+
 // Maximum number allowed in the groups table.
 CONFIG_ITEM uint8_t gAPS_MAX_GROUPS = APS_MAX_GROUPS;
 
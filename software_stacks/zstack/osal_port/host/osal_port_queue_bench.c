@@ -0,0 +1,439 @@
+/******************************************************************************
+
+ @file  osal_port_queue_bench.c
+
+ @brief OSAL port message queue benchmark
+
+ Group: WCS, LPC
+ Target Device: cc13xx_cc26xx
+
+ ******************************************************************************
+ 
+ Copyright (c) 2019-2026, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ 
+ 
+ *****************************************************************************/
+
+/*
+Measures the task message queues of osal_port.c at queue depths of 1 to 256
+messages: a message is sent to a task whose queue already holds depth - 1
+messages, then the oldest one is received, so the queue stays at that
+depth. For each depth it reports
+
+- the time of an OsalPort_msgSend() and OsalPort_msgReceive() pair, and
+  the message rate that gives
+- the length of the critical sections of the send and of the receive,
+  median and 99th percentile, timed from the outermost HwiP_disable() to
+  the HwiP_restore() that enables interrupts again
+- the time of an OsalPort_msgEnqueue() and OsalPort_msgDequeue() pair on a
+  queue that is not a task queue, as the MAC uses internally
+
+The critical sections are timed in a separate pass, the clock reads add
+the time of an empty critical section, printed first. Messages are checked
+to come out in the order they were sent. Tasks are registered without a
+semaphore, so no time goes to posting it.
+
+Build against the current osal_port.c, and against the one before the
+queues kept their tail and depth to compare:
+
+  git show 7e70422^:software_stacks/zstack/osal_port/osal_port.c > /tmp/osal_port_list.c
+
+  cc -O2 -DOSAL_PORT2TIRTOS -DFREERTOS_SUPPORT \
+      -Isoftware_stacks/zstack/host -I. -Isoftware_stacks \
+      -Isoftware_stacks/zstack/osal_port \
+      -o osal_port_queue_bench \
+      software_stacks/zstack/osal_port/host/osal_port_queue_bench.c \
+      software_stacks/zstack/osal_port/osal_port.c -lpthread
+  ./osal_port_queue_bench -h
+*/
+
+//*****************************************************************************
+// Includes
+//*****************************************************************************
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <ti/drivers/dpl/ClockP.h>
+#include <ti/drivers/dpl/HwiP.h>
+#include <ti/drivers/Power.h>
+#include <ti/drivers/utils/Random.h>
+#include <zstack/osal_port/osal_port.h>
+
+//*****************************************************************************
+// Constants and Definitions
+//*****************************************************************************
+
+#define BENCH_MAX_DEPTH         256
+#define BENCH_NUM_TASKS         3
+#define BENCH_MAX_SAMPLES       200000
+
+//*****************************************************************************
+// Typedefs
+//*****************************************************************************
+
+// Message sent to the task
+typedef struct
+{
+    OsalPort_EventHdr hdr;
+    uint32_t          seq;
+} benchMsg_t;
+
+// Lengths of the critical sections of one kind of call
+typedef struct
+{
+    uint32_t  count;
+    uint32_t  ns[BENCH_MAX_SAMPLES];
+} benchCsSamples_t;
+
+//*****************************************************************************
+// Locals
+//*****************************************************************************
+
+static uint32_t taskEvents[BENCH_NUM_TASKS];
+static uint8_t taskIds[BENCH_NUM_TASKS];
+static benchMsg_t *msgs[BENCH_MAX_DEPTH];
+static uint32_t sendSeq;
+static uint32_t recvSeq;
+static uint32_t failures;
+
+// Critical section timing
+static int hwiDisabled;
+static struct timespec csStart;
+static benchCsSamples_t *pCsSamples;
+static benchCsSamples_t sendSamples;
+static benchCsSamples_t recvSamples;
+static benchCsSamples_t emptySamples;
+
+//*****************************************************************************
+// Drivers used by osal_port.c
+//*****************************************************************************
+
+static uint32_t nsBetween(struct timespec *pStart, struct timespec *pEnd)
+{
+    return((uint32_t)((pEnd->tv_sec - pStart->tv_sec) * 1000000000L +
+                      (pEnd->tv_nsec - pStart->tv_nsec)));
+}
+
+uintptr_t HwiP_disable(void)
+{
+    uintptr_t key = (uintptr_t)hwiDisabled;
+
+    if(!hwiDisabled)
+    {
+        hwiDisabled = 1;
+        if(pCsSamples != NULL)
+        {
+            clock_gettime(CLOCK_MONOTONIC, &csStart);
+        }
+    }
+    return(key);
+}
+
+void HwiP_restore(uintptr_t key)
+{
+    struct timespec end;
+
+    if((key == 0) && hwiDisabled)
+    {
+        hwiDisabled = 0;
+        if((pCsSamples != NULL) && (pCsSamples->count < BENCH_MAX_SAMPLES))
+        {
+            clock_gettime(CLOCK_MONOTONIC, &end);
+            pCsSamples->ns[pCsSamples->count++] = nsBetween(&csStart, &end);
+        }
+    }
+}
+
+int_fast16_t Power_setConstraint(uint_fast16_t constraintId)
+{
+    (void)constraintId;
+    return(Power_SOK);
+}
+
+int_fast16_t Power_releaseConstraint(uint_fast16_t constraintId)
+{
+    (void)constraintId;
+    return(Power_SOK);
+}
+
+uint32_t Random_getNumber(void)
+{
+    return((uint32_t)rand());
+}
+
+// The OSAL timers of osal_port.c are not used
+void ClockP_Params_init(ClockP_Params *params)
+{
+    memset(params, 0, sizeof(*params));
+}
+
+ClockP_Handle ClockP_create(ClockP_Fxn clockFxn, uint32_t timeout, ClockP_Params *params)
+{
+    (void)clockFxn;
+    (void)timeout;
+    (void)params;
+    return(NULL);
+}
+
+void ClockP_delete(ClockP_Handle handle)
+{
+    (void)handle;
+}
+
+void ClockP_start(ClockP_Handle handle)
+{
+    (void)handle;
+}
+
+void ClockP_stop(ClockP_Handle handle)
+{
+    (void)handle;
+}
+
+void ClockP_setTimeout(ClockP_Handle handle, uint32_t timeout)
+{
+    (void)handle;
+    (void)timeout;
+}
+
+bool ClockP_isActive(ClockP_Handle handle)
+{
+    (void)handle;
+    return(false);
+}
+
+//*****************************************************************************
+// Benchmark
+//*****************************************************************************
+
+static double nsSince(struct timespec *pStart, uint32_t n)
+{
+    struct timespec end;
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return(((end.tv_sec - pStart->tv_sec) * 1e9 + (end.tv_nsec - pStart->tv_nsec)) / n);
+}
+
+static int cmpU32(const void *pA, const void *pB)
+{
+    uint32_t a = *(const uint32_t *)pA;
+    uint32_t b = *(const uint32_t *)pB;
+
+    return((a > b) - (a < b));
+}
+
+static void percentiles(benchCsSamples_t *pSamples, uint32_t *pMedian, uint32_t *pP99)
+{
+    qsort(pSamples->ns, pSamples->count, sizeof(uint32_t), cmpU32);
+    *pMedian = pSamples->count ? pSamples->ns[pSamples->count / 2] : 0;
+    *pP99 = pSamples->count ? pSamples->ns[(pSamples->count * 99) / 100] : 0;
+}
+
+static void send(uint8_t task, benchMsg_t *pMsg)
+{
+    pMsg->seq = sendSeq++;
+    pCsSamples = (pCsSamples != NULL) ? &sendSamples : NULL;
+    OsalPort_msgSend(task, (uint8_t *)pMsg);
+}
+
+static benchMsg_t *receive(uint8_t task)
+{
+    benchMsg_t *pMsg;
+
+    pCsSamples = (pCsSamples != NULL) ? &recvSamples : NULL;
+    pMsg = (benchMsg_t *)OsalPort_msgReceive(task);
+    if((pMsg == NULL) || (pMsg->seq != recvSeq))
+    {
+        if(failures < 10)
+        {
+            printf("message %u received out of order\n", recvSeq);
+        }
+        failures++;
+    }
+    recvSeq++;
+    return(pMsg);
+}
+
+/*
+ * Sends and receives messages through the queue of the last task, kept at
+ * the given depth, with or without timing the critical sections.
+ */
+static double runTaskQueue(int depth, uint32_t iterations, bool timeCs)
+{
+    uint8_t task = taskIds[BENCH_NUM_TASKS - 1];
+    struct timespec start;
+    benchMsg_t *pMsg;
+    double ns;
+    uint32_t i;
+    int d;
+
+    for(d = 0; d < depth - 1; d++)
+    {
+        send(task, msgs[d]);
+    }
+    pMsg = msgs[depth - 1];
+
+    sendSamples.count = recvSamples.count = 0;
+    pCsSamples = timeCs ? &sendSamples : NULL;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for(i = 0; i < iterations; i++)
+    {
+        send(task, pMsg);
+        pMsg = receive(task);
+    }
+    ns = nsSince(&start, iterations);
+    pCsSamples = NULL;
+
+    for(d = 0; d < depth - 1; d++)
+    {
+        receive(task);
+    }
+    return(ns);
+}
+
+/*
+ * Same with OsalPort_msgEnqueue() and OsalPort_msgDequeue() on a queue
+ * that is not a task queue.
+ */
+static double runPlainQueue(int depth, uint32_t iterations)
+{
+    OsalPort_MsgQ q = NULL;
+    struct timespec start;
+    void *pMsg;
+    uint32_t i;
+    int d;
+
+    for(d = 0; d < depth - 1; d++)
+    {
+        OsalPort_msgEnqueue(&q, msgs[d]);
+    }
+    pMsg = msgs[depth - 1];
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for(i = 0; i < iterations; i++)
+    {
+        OsalPort_msgEnqueue(&q, pMsg);
+        pMsg = OsalPort_msgDequeue(&q);
+    }
+    return(nsSince(&start, iterations));
+}
+
+//*****************************************************************************
+// Main
+//*****************************************************************************
+
+static void usage(const char *prog)
+{
+    printf("usage: %s [-n iterations]\n", prog);
+    printf("  -n  send and receive pairs per depth (default 1000000)\n");
+}
+
+int main(int argc, char *argv[])
+{
+    static const int depths[] = { 1, 2, 4, 8, 16, 32, 64, 128, 256 };
+    uint32_t iterations = 1000000;
+    uint32_t median;
+    uint32_t p99;
+    unsigned int d;
+    int i;
+    int opt;
+
+    while((opt = getopt(argc, argv, "n:h")) != -1)
+    {
+        switch(opt)
+        {
+            case 'n': iterations = (uint32_t)atoi(optarg); break;
+            case 'h': usage(argv[0]); return(0);
+            default: usage(argv[0]); return(2);
+        }
+    }
+    if(iterations == 0)
+    {
+        usage(argv[0]);
+        return(2);
+    }
+
+    // The queue measured is that of the last task, not found first
+    for(i = 0; i < BENCH_NUM_TASKS; i++)
+    {
+        taskIds[i] = OsalPort_registerTask(&taskEvents[i], NULL, &taskEvents[i]);
+    }
+    for(i = 0; i < BENCH_MAX_DEPTH; i++)
+    {
+        msgs[i] = (benchMsg_t *)OsalPort_msgAllocate(sizeof(benchMsg_t));
+        if(msgs[i] == NULL)
+        {
+            printf("out of memory\n");
+            return(1);
+        }
+        msgs[i]->hdr.event = OsalPort_SYS_EVENT_MSG;
+    }
+
+    pCsSamples = &emptySamples;
+    for(i = 0; i < BENCH_MAX_SAMPLES; i++)
+    {
+        OsalPort_leaveCS(OsalPort_enterCS());
+    }
+    pCsSamples = NULL;
+    percentiles(&emptySamples, &median, &p99);
+    printf("empty critical section: median %u ns, p99 %u ns\n\n", median, p99);
+
+    printf("%6s %14s %9s | %19s %19s | %14s\n", "", "task queue", "",
+           "send crit. section", "recv crit. section", "plain queue");
+    printf("%6s %14s %9s | %9s %9s %9s %9s | %14s\n", "depth", "send+recv ns", "Mmsg/s",
+           "median", "p99", "median", "p99", "enq+deq ns");
+    for(d = 0; d < sizeof(depths) / sizeof(depths[0]); d++)
+    {
+        uint32_t sendMedian;
+        uint32_t sendP99;
+        double ns;
+
+        ns = runTaskQueue(depths[d], iterations, false);
+        runTaskQueue(depths[d], (iterations < BENCH_MAX_SAMPLES) ? iterations : BENCH_MAX_SAMPLES,
+                     true);
+        percentiles(&sendSamples, &sendMedian, &sendP99);
+        percentiles(&recvSamples, &median, &p99);
+        printf("%6d %14.1f %9.2f | %9u %9u %9u %9u | %14.1f\n", depths[d], ns, 1000.0 / ns,
+               sendMedian, sendP99, median, p99, runPlainQueue(depths[d], iterations));
+    }
+
+    if(failures != 0)
+    {
+        printf("failures: %u\n", failures);
+    }
+    return((failures != 0) ? 1 : 0);
+}
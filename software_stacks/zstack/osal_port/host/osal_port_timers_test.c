@@ -0,0 +1,798 @@
+/******************************************************************************
+
+ @file  osal_port_timers_test.c
+
+ @brief OSAL port timer test and benchmark
+
+ Group: WCS, LPC
+ Target Device: cc13xx_cc26xx
+
+ ******************************************************************************
+ 
+ Copyright (c) 2019-2026, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ 
+ 
+ *****************************************************************************/
+
+/*
+Runs osal_port_timers.c on a virtual ClockP: the system tick counter is
+advanced by this program, starting shortly before it wraps, and the clock
+function of the timer module is called when the timeout it armed elapses.
+Every timer event is checked against a model of the timers that keeps
+expiries as 64-bit tick counts:
+
+- an event is set at the tick its timeout ends, once, and only for a
+  running timer; a reload timer is set again every period
+- OsalPortTimers_getTimerTimeout() returns the ms left
+- OsalPortTimers_stopTimer() succeeds for running timers only, and a
+  stopped or restarted timer does not expire at its old time
+
+Directed cases cover timeouts just below, at and above TIMER_MAX_SEGMENT
+ticks and multiples of it, up to 0xFFFFFFFF ms, expiring in order with
+short ones, stopped and restarted in the middle of a segment, reload
+periods longer than a segment and more timers than the preallocated pool.
+A random sequence of starts, restarts, stops and clock advances follows.
+
+-b measures the time of a start and stop pair, of a restart, of
+OsalPortTimers_getTimerTimeout() and of an expiry, with 0 to 200 other
+timers running. The exit status is 1 on any failure. Build and run from
+the repository root:
+
+  cc -O2 -DOSAL_PORT2TIRTOS \
+      -Isoftware_stacks/zstack/host -I. -Isoftware_stacks \
+      -Isoftware_stacks/ti15_4stack/hal/platform \
+      -Isoftware_stacks/ti15_4stack/mac/services \
+      -Isoftware_stacks/ti15_4stack/mac -Isoftware_stacks/zstack/af \
+      -Isoftware_stacks/zstack/bdb -Isoftware_stacks/zstack/sys \
+      -Isoftware_stacks/zstack/nwk -Isoftware_stacks/zstack/osal_port \
+      -Isoftware_stacks/zstack/common/zcl -Isoftware_stacks/zstack/stack_task \
+      -Isoftware_stacks/zstack/zdo -Isoftware_stacks/zstack/sec \
+      -Isoftware_stacks/zstack/gp -Isoftware_stacks/zstack/zmac -Idrivers/nv \
+      -o osal_port_timers_test \
+      software_stacks/zstack/osal_port/host/osal_port_timers_test.c \
+      software_stacks/zstack/osal_port/osal_port_timers.c \
+      software_stacks/zstack/host/zstack_host.c
+  ./osal_port_timers_test -h
+*/
+
+//*****************************************************************************
+// Includes
+//*****************************************************************************
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <ti/drivers/dpl/ClockP.h>
+#include <zstack/osal_port/osal_port.h>
+#include <zstack/osal_port/osal_port_timers.h>
+
+//*****************************************************************************
+// Constants and Definitions
+//*****************************************************************************
+
+// As osal_port_timers.c
+#define TEST_MAX_SEGMENT        0x40000000ULL
+#define TEST_POOL_TIMERS        32
+
+// Timers of the random sequence, more than the preallocated pool
+#define TEST_NUM_TASKS          6
+#define TEST_NUM_EVENTS         8
+#define TEST_NUM_TIMERS         (TEST_NUM_TASKS * TEST_NUM_EVENTS)
+
+// Timers of the benchmark, and of the directed pool test
+#define TEST_MAX_BACKGROUND     200
+
+// Tasks the model covers
+#define TEST_MAX_TASKS          48
+
+// Failures after which the test stops
+#define TEST_MAX_FAILURES       100
+
+// Clock function calls in a row that set no event, more than the segment
+// boundaries of all timers in the longest advance
+#define TEST_MAX_SPINS          100000
+
+//*****************************************************************************
+// Typedefs
+//*****************************************************************************
+
+// Model of a timer
+typedef struct
+{
+    uint8_t   running;
+    uint64_t  due;      // tick the timeout ends
+    uint64_t  fireAt;   // tick the event is expected, the clock needs 1 tick
+    uint64_t  period;   // reload period in ticks, 0 for one shot
+    uint32_t  fired;
+} testTimer_t;
+
+//*****************************************************************************
+// Locals
+//*****************************************************************************
+
+static uint32_t tickPeriod = 10;
+static uint64_t ticksPerMs;
+static uint64_t segmentMs;
+
+// Virtual clock
+static uint64_t now;
+static ClockP_Fxn clockFxn;
+static uintptr_t clockArg;
+static uint32_t clockTimeout;
+static uint64_t clockDue;
+static bool clockActive;
+static uint32_t clockCalls;
+
+static testTimer_t model[TEST_MAX_TASKS][TEST_NUM_EVENTS];
+static uint32_t eventsSet;
+static bool benchmarking;
+static uint32_t failures;
+
+//*****************************************************************************
+// ClockP
+//*****************************************************************************
+
+void ClockP_Params_init(ClockP_Params *params)
+{
+    memset(params, 0, sizeof(*params));
+}
+
+ClockP_Handle ClockP_create(ClockP_Fxn fxn, uint32_t timeout, ClockP_Params *params)
+{
+    // osal_port_timers.c uses a single one shot clock
+    if((clockFxn != NULL) || (params->period != 0))
+    {
+        printf("unexpected ClockP_create()\n");
+        failures++;
+        return(NULL);
+    }
+    clockFxn = fxn;
+    clockArg = params->arg;
+    clockTimeout = timeout;
+    if(params->startFlag)
+    {
+        ClockP_start(&clockFxn);
+    }
+    return(&clockFxn);
+}
+
+void ClockP_delete(ClockP_Handle handle)
+{
+    (void)handle;
+    clockFxn = NULL;
+    clockActive = false;
+}
+
+void ClockP_start(ClockP_Handle handle)
+{
+    (void)handle;
+    if(clockTimeout == 0)
+    {
+        printf("clock started with a timeout of 0\n");
+        failures++;
+    }
+    clockDue = now + clockTimeout;
+    clockActive = true;
+}
+
+void ClockP_stop(ClockP_Handle handle)
+{
+    (void)handle;
+    clockActive = false;
+}
+
+void ClockP_setTimeout(ClockP_Handle handle, uint32_t timeout)
+{
+    (void)handle;
+    clockTimeout = timeout;
+}
+
+uint32_t ClockP_getTimeout(ClockP_Handle handle)
+{
+    (void)handle;
+    return(clockActive ? (uint32_t)(clockDue - now) : clockTimeout);
+}
+
+bool ClockP_isActive(ClockP_Handle handle)
+{
+    (void)handle;
+    return(clockActive);
+}
+
+uint32_t ClockP_getSystemTicks(void)
+{
+    return((uint32_t)now);
+}
+
+uint32_t ClockP_getSystemTickPeriod(void)
+{
+    return(tickPeriod);
+}
+
+//*****************************************************************************
+// Model
+//*****************************************************************************
+
+uint8_t OsalPort_setEvent(uint8_t destinationTask, uint32_t eventFlag)
+{
+    testTimer_t *pTimer;
+    int event = 0;
+
+    while((event < TEST_NUM_EVENTS) && (eventFlag != (1UL << event)))
+    {
+        event++;
+    }
+    if((event == TEST_NUM_EVENTS) || (destinationTask >= TEST_MAX_TASKS))
+    {
+        printf("unknown event 0x%08X of task %u\n", eventFlag, destinationTask);
+        failures++;
+        return(OsalPort_SUCCESS);
+    }
+
+    pTimer = &model[destinationTask][event];
+    eventsSet++;
+    pTimer->fired++;
+    if(!pTimer->running)
+    {
+        printf("task %u event %d set at tick %llu, timer is not running\n",
+               destinationTask, event, (unsigned long long)now);
+        failures++;
+        return(OsalPort_SUCCESS);
+    }
+    if(pTimer->fireAt != now)
+    {
+        printf("task %u event %d set at tick %llu, expected at %llu\n", destinationTask,
+               event, (unsigned long long)now, (unsigned long long)pTimer->fireAt);
+        failures++;
+    }
+    if(pTimer->period != 0)
+    {
+        pTimer->due += pTimer->period;
+        pTimer->fireAt = pTimer->due;
+    }
+    else
+    {
+        pTimer->running = false;
+    }
+    return(OsalPort_SUCCESS);
+}
+
+static void modelStart(uint8_t task, int event, uint32_t timeout, bool reload)
+{
+    testTimer_t *pTimer = &model[task][event];
+    uint8_t status;
+
+    if(reload)
+    {
+        status = OsalPortTimers_startReloadTimer(task, 1UL << event, timeout);
+    }
+    else
+    {
+        status = OsalPortTimers_startTimer(task, 1UL << event, timeout);
+    }
+    if(status != OsalPort_SUCCESS)
+    {
+        printf("start of task %u event %d failed: %u\n", task, event, status);
+        failures++;
+        return;
+    }
+
+    // A restart keeps the reload period the timer was created with
+    if(!pTimer->running)
+    {
+        pTimer->period = reload ? (uint64_t)timeout * ticksPerMs : 0;
+    }
+    pTimer->running = true;
+    pTimer->due = now + (uint64_t)timeout * ticksPerMs;
+    pTimer->fireAt = (timeout == 0) ? now + 1 : pTimer->due;
+}
+
+static void modelStop(uint8_t task, int event)
+{
+    testTimer_t *pTimer = &model[task][event];
+    uint8_t status = OsalPortTimers_stopTimer(task, 1UL << event);
+    uint8_t expected = pTimer->running ? OsalPort_SUCCESS : OsalPort_INVALIDPARAMETER;
+
+    if(status != expected)
+    {
+        printf("stop of task %u event %d returned %u, expected %u\n", task, event, status,
+               expected);
+        failures++;
+    }
+    pTimer->running = false;
+}
+
+static void modelCheckTimeout(uint8_t task, int event)
+{
+    testTimer_t *pTimer = &model[task][event];
+    uint32_t timeout = OsalPortTimers_getTimerTimeout(task, 1UL << event);
+    uint64_t expected = 0;
+
+    if(pTimer->running && (pTimer->due > now))
+    {
+        expected = (pTimer->due - now) / ticksPerMs;
+        if(expected > 0xFFFFFFFFULL)
+        {
+            expected = 0xFFFFFFFFULL;
+        }
+    }
+    if(timeout != expected)
+    {
+        printf("timeout of task %u event %d at tick %llu is %u ms, expected %llu ms\n", task,
+               event, (unsigned long long)now, timeout, (unsigned long long)expected);
+        failures++;
+    }
+}
+
+/*
+ * Advances the virtual clock to the given tick, calling the clock function
+ * of the timer module whenever its timeout elapses on the way, then checks
+ * that no timer missed its expiry.
+ */
+static void advanceTo(uint64_t tick)
+{
+    uint32_t spins = 0;
+    uint32_t events;
+    int task;
+    int event;
+
+    while(clockActive && (clockDue <= tick) && (failures < TEST_MAX_FAILURES))
+    {
+        if(++spins > TEST_MAX_SPINS)
+        {
+            printf("clock keeps expiring without events at tick %llu\n",
+                   (unsigned long long)now);
+            failures++;
+            break;
+        }
+        now = clockDue;
+        clockActive = false;
+        clockCalls++;
+        events = eventsSet;
+        clockFxn(clockArg);
+        if(eventsSet != events)
+        {
+            spins = 0;
+        }
+    }
+    now = tick;
+    if(benchmarking)
+    {
+        return;
+    }
+
+    for(task = 0; task < TEST_MAX_TASKS; task++)
+    {
+        for(event = 0; event < TEST_NUM_EVENTS; event++)
+        {
+            if(model[task][event].running && (model[task][event].fireAt <= now))
+            {
+                printf("task %d event %d not set at tick %llu\n", task, event,
+                       (unsigned long long)model[task][event].fireAt);
+                failures++;
+                model[task][event].running = false;
+            }
+        }
+    }
+}
+
+static void advanceMs(uint64_t ms)
+{
+    advanceTo(now + ms * ticksPerMs);
+}
+
+static uint64_t nextFireAt(void)
+{
+    uint64_t next = UINT64_MAX;
+    int task;
+    int event;
+
+    for(task = 0; task < TEST_MAX_TASKS; task++)
+    {
+        for(event = 0; event < TEST_NUM_EVENTS; event++)
+        {
+            if(model[task][event].running && (model[task][event].fireAt < next))
+            {
+                next = model[task][event].fireAt;
+            }
+        }
+    }
+    return(next);
+}
+
+static void stopAll(void)
+{
+    int task;
+    int event;
+
+    for(task = 0; task < TEST_MAX_TASKS; task++)
+    {
+        for(event = 0; event < TEST_NUM_EVENTS; event++)
+        {
+            if(model[task][event].running)
+            {
+                modelStop((uint8_t)task, event);
+            }
+        }
+    }
+}
+
+//*****************************************************************************
+// Directed cases
+//*****************************************************************************
+
+static void testZeroTimeout(void)
+{
+    modelStart(1, 0, 0, false);
+    modelCheckTimeout(1, 0);
+    advanceTo(now + 1);
+    modelCheckTimeout(1, 0);
+}
+
+/*
+ * One shot timeouts around segment boundaries expire at their tick, not
+ * one tick early, and report the time left on the way.
+ */
+static void testSegmentBoundaries(void)
+{
+    const uint64_t timeouts[] =
+    {
+        segmentMs - 1, segmentMs, segmentMs + 1, 2 * segmentMs, 2 * segmentMs + 1,
+        3 * segmentMs + 3, 0xFFFFFFFFULL
+    };
+    unsigned int i;
+
+    for(i = 0; i < sizeof(timeouts) / sizeof(timeouts[0]); i++)
+    {
+        testTimer_t *pTimer = &model[2][0];
+        uint32_t fired = pTimer->fired;
+        uint64_t start = now;
+
+        modelStart(2, 0, (uint32_t)timeouts[i], false);
+        while(now + TEST_MAX_SEGMENT < pTimer->due)
+        {
+            advanceTo(now + TEST_MAX_SEGMENT - 1 - (uint64_t)(rand() % 1000));
+            modelCheckTimeout(2, 0);
+        }
+        advanceTo(pTimer->due - 1);
+        modelCheckTimeout(2, 0);
+        if(pTimer->fired != fired)
+        {
+            printf("%llu ms timeout expired early\n", (unsigned long long)timeouts[i]);
+            failures++;
+        }
+        advanceTo(pTimer->due);
+        if(pTimer->fired != fired + 1)
+        {
+            printf("%llu ms timeout started at tick %llu did not expire\n",
+                   (unsigned long long)timeouts[i], (unsigned long long)start);
+            failures++;
+        }
+    }
+}
+
+/*
+ * Long and short timers expire in the order of their timeouts, a long one
+ * stopped or restarted in the middle of a segment does not expire at its
+ * old time.
+ */
+static void testOrdering(void)
+{
+    testTimer_t *pA = &model[3][0];
+    testTimer_t *pD = &model[3][3];
+
+    modelStart(3, 0, (uint32_t)(2 * segmentMs + 1), false);
+    modelStart(3, 1, (uint32_t)segmentMs, false);
+    modelStart(3, 2, 1, false);
+    modelStart(3, 3, (uint32_t)(2 * segmentMs), false);
+    modelStart(3, 4, (uint32_t)(3 * segmentMs), false);
+
+    advanceMs(1);
+    advanceTo(model[3][1].due);
+    if(pA->fired != 0)
+    {
+        printf("timer of a longer timeout expired first\n");
+        failures++;
+    }
+
+    // A and D are in their second segment, restart A
+    advanceMs(segmentMs / 2);
+    modelStart(3, 0, 5, false);
+    advanceMs(5);
+
+    // Stop D
+    advanceTo(now + TEST_MAX_SEGMENT / 3);
+    modelCheckTimeout(3, 3);
+    modelStop(3, 3);
+    advanceTo(model[3][4].due);
+    if((pA->fired != 1) || (pD->fired != 0) || (model[3][4].fired != 1))
+    {
+        printf("restarted or stopped long timers expired %u and %u times\n", pA->fired,
+               pD->fired);
+        failures++;
+    }
+}
+
+/*
+ * A reload period longer than a segment.
+ */
+static void testLongReload(void)
+{
+    int k;
+
+    modelStart(4, 0, (uint32_t)(segmentMs + 7), true);
+    for(k = 0; k < 3; k++)
+    {
+        advanceTo(model[4][0].fireAt);
+        modelCheckTimeout(4, 0);
+    }
+    modelStop(4, 0);
+    if(model[4][0].fired != 3)
+    {
+        printf("reload timer expired %u times in 3 periods\n", model[4][0].fired);
+        failures++;
+    }
+}
+
+/*
+ * More timers than the preallocated pool, expiring in reverse order of
+ * their start.
+ */
+static void testPoolGrowth(void)
+{
+    int i;
+
+    for(i = 0; i < TEST_MAX_BACKGROUND; i++)
+    {
+        modelStart((uint8_t)(16 + i / TEST_NUM_EVENTS), i % TEST_NUM_EVENTS,
+                   (uint32_t)(TEST_MAX_BACKGROUND - i) * 3, false);
+    }
+    advanceMs(TEST_MAX_BACKGROUND * 3);
+}
+
+//*****************************************************************************
+// Random sequence
+//*****************************************************************************
+
+static uint32_t randTimeout(void)
+{
+    uint32_t r = (uint32_t)rand() % 100;
+
+    if(r < 2)
+    {
+        return(0);
+    }
+    if(r < 50)
+    {
+        return(1 + (uint32_t)rand() % 2000);
+    }
+    if(r < 70)
+    {
+        return((uint32_t)rand() % 1000000);
+    }
+    if(r < 90)
+    {
+        return((uint32_t)((1 + rand() % 3) * segmentMs) + (uint32_t)(rand() % 7) - 3);
+    }
+    return(0xFFFFFFFFU - (uint32_t)rand() % 100000);
+}
+
+static void runRandom(int numOps)
+{
+    int op;
+
+    for(op = 0; (op < numOps) && (failures < TEST_MAX_FAILURES); op++)
+    {
+        uint8_t task = (uint8_t)(8 + rand() % TEST_NUM_TASKS);
+        int event = rand() % TEST_NUM_EVENTS;
+        uint32_t r = (uint32_t)rand() % 100;
+        uint64_t next;
+
+        if(r < 35)
+        {
+            modelStart(task, event, randTimeout(), false);
+        }
+        else if(r < 45)
+        {
+            // Reload periods stay short of the long timeouts
+            modelStart(task, event, 1 + (uint32_t)rand() % 5000, true);
+        }
+        else if(r < 60)
+        {
+            modelStop(task, event);
+        }
+        else if(r < 70)
+        {
+            modelCheckTimeout(task, event);
+        }
+        else
+        {
+            next = nextFireAt();
+            r = (uint32_t)rand() % 100;
+            if((next != UINT64_MAX) && (r < 50))
+            {
+                advanceTo(next - (r < 10));
+            }
+            else
+            {
+                advanceMs((uint32_t)rand() % 3000);
+            }
+        }
+    }
+    stopAll();
+}
+
+//*****************************************************************************
+// Benchmark
+//*****************************************************************************
+
+static double nsSince(struct timespec *pStart, int n)
+{
+    struct timespec end;
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return(((end.tv_sec - pStart->tv_sec) * 1e9 + (end.tv_nsec - pStart->tv_nsec)) / n);
+}
+
+static void runBenchmark(int iterations)
+{
+    static const int backgrounds[] = { 0, 8, 32, 64, 200 };
+    unsigned int b;
+
+    printf("%10s %14s %12s %12s %12s\n", "timers", "start+stop ns", "restart ns",
+           "timeout ns", "expiry ns");
+    for(b = 0; b < sizeof(backgrounds) / sizeof(backgrounds[0]); b++)
+    {
+        struct timespec start;
+        double startStop;
+        double restart;
+        double timeout;
+        double expiry;
+        int i;
+
+        stopAll();
+        for(i = 0; i < backgrounds[b]; i++)
+        {
+            modelStart((uint8_t)(16 + i / TEST_NUM_EVENTS), i % TEST_NUM_EVENTS,
+                       10000000 + (uint32_t)rand() % 1000000, false);
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for(i = 0; i < iterations; i++)
+        {
+            OsalPortTimers_startTimer(1, 1, 1000 + (i & 1023));
+            OsalPortTimers_stopTimer(1, 1);
+        }
+        startStop = nsSince(&start, iterations);
+
+        OsalPortTimers_startTimer(1, 1, 1000);
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for(i = 0; i < iterations; i++)
+        {
+            OsalPortTimers_startTimer(1, 1, 1000 + (i & 1023));
+        }
+        restart = nsSince(&start, iterations);
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for(i = 0; i < iterations; i++)
+        {
+            (void)OsalPortTimers_getTimerTimeout(1, 1);
+        }
+        timeout = nsSince(&start, iterations);
+        OsalPortTimers_stopTimer(1, 1);
+
+        benchmarking = true;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for(i = 0; i < iterations; i++)
+        {
+            modelStart(1, 0, 1, false);
+            advanceTo(now + ticksPerMs);
+        }
+        expiry = nsSince(&start, iterations);
+        benchmarking = false;
+
+        printf("%10d %14.1f %12.1f %12.1f %12.1f\n", backgrounds[b] + 1, startStop, restart,
+               timeout, expiry);
+    }
+    stopAll();
+}
+
+//*****************************************************************************
+// Main
+//*****************************************************************************
+
+static void usage(const char *prog)
+{
+    printf("usage: %s [-n ops] [-s seed] [-p tick period] [-b iterations]\n", prog);
+    printf("  -n  operations of the random sequence (default 200000)\n");
+    printf("  -s  seed (default 1)\n");
+    printf("  -p  system tick period in us (default 10)\n");
+    printf("  -b  run the benchmark with this many iterations per measure\n");
+}
+
+int main(int argc, char *argv[])
+{
+    int numOps = 200000;
+    int iterations = 0;
+    int seed = 1;
+    int opt;
+
+    while((opt = getopt(argc, argv, "n:s:p:b:h")) != -1)
+    {
+        switch(opt)
+        {
+            case 'n': numOps = atoi(optarg); break;
+            case 's': seed = atoi(optarg); break;
+            case 'p': tickPeriod = (uint32_t)atoi(optarg); break;
+            case 'b': iterations = atoi(optarg); break;
+            case 'h': usage(argv[0]); return(0);
+            default: usage(argv[0]); return(2);
+        }
+    }
+    if((numOps < 0) || (iterations < 0) || (tickPeriod == 0) || (tickPeriod > 1000) ||
+       (1000 % tickPeriod != 0))
+    {
+        usage(argv[0]);
+        return(2);
+    }
+    srand(seed);
+    ticksPerMs = 1000 / tickPeriod;
+    segmentMs = TEST_MAX_SEGMENT / ticksPerMs;
+
+    // Close to the wrap of the system tick counter
+    now = 0xFFFFFFFFULL - 5000 * ticksPerMs;
+
+    testZeroTimeout();
+    testSegmentBoundaries();
+    testOrdering();
+    testLongReload();
+    testPoolGrowth();
+    printf("directed cases: %u events, failures: %u\n", eventsSet, failures);
+
+    runRandom(numOps);
+    printf("%d random operations: %u events, %u clock calls, %llu ticks (%.1f days)\n",
+           numOps, eventsSet, clockCalls, (unsigned long long)now,
+           (double)now / ticksPerMs / 86400000.0);
+
+    if(iterations > 0)
+    {
+        runBenchmark(iterations);
+    }
+
+    printf("failures: %u\n", failures);
+
+    return((failures != 0) ? 1 : 0);
+}
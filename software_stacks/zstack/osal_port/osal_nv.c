@@ -55,12 +55,26 @@
 #include <zstack/nwk/nwk_globals.h>
 #include <zstack/nwk/aps_mede.h>
 #endif
+#ifdef OSAL_NV_CACHE
+#include <string.h>
+#endif
 
 
 /******************************************************************************
  * CONSTANTS
  */
 
+#ifdef OSAL_NV_CACHE
+// Number of NV items that can be given a write-back cache policy
+#ifndef OSAL_NV_CACHE_ENTRIES
+#define OSAL_NV_CACHE_ENTRIES       4
+#endif
+// Largest NV item, in bytes, that the write-back cache holds a copy of
+#ifndef OSAL_NV_CACHE_ITEM_LEN
+#define OSAL_NV_CACHE_ITEM_LEN      32
+#endif
+#endif // OSAL_NV_CACHE
+
 
 /******************************************************************************
  * MACROS
@@ -71,6 +85,23 @@
  * TYPEDEFS
  */
 
+#ifdef OSAL_NV_CACHE
+// Write-back cache entry of one NV item
+typedef struct
+{
+  uint16_t id;
+  uint16_t subId;
+  uint8_t  policy;      // OSAL_NV_CACHE_WRITETHROUGH/DEFERRED/ONSHUTDOWN
+  bool     inUse;       // Entry has been given a policy
+  bool     valid;       // buf holds the current contents of the item
+  bool     dirty;       // buf is newer than the item in NV
+  uint16_t len;         // Length of the item in buf
+  uint32_t maxLatency;  // Longest time in ms a deferred write is held
+  uint32_t age;         // Time in ms since buf became dirty
+  uint8_t  buf[OSAL_NV_CACHE_ITEM_LEN];
+} osal_nv_cacheEntry_t;
+#endif // OSAL_NV_CACHE
+
 
 /******************************************************************************
  * EXTERNAL VARIABLES
@@ -81,11 +112,27 @@ extern zstack_Config_t *pZStackCfg;
  * LOCAL VARIABLES
  */
 
+#ifdef OSAL_NV_CACHE
+static osal_nv_cacheEntry_t osal_nv_cacheTable[OSAL_NV_CACHE_ENTRIES];
+static osal_nv_cacheMetrics_t osal_nv_cacheMetrics;
+// Set while the supply voltage is low, writes are no longer deferred
+static bool osal_nv_cacheLowVolt = FALSE;
+// Optional early warning supply check, see osal_nv_cache_setVoltageCheck()
+static osal_nv_cacheVoltCheck_t osal_nv_cacheVoltCheck = NULL;
+#endif // OSAL_NV_CACHE
+
 
 /******************************************************************************
  * LOCAL FUNCTIONS
  */
 
+static uint8_t osal_nv_writeItem( uint16_t id, uint16_t subId, uint16_t len, void *buf );
+#ifdef OSAL_NV_CACHE
+static osal_nv_cacheEntry_t *osal_nv_cacheFind( uint16_t id, uint16_t subId );
+static uint8_t osal_nv_cacheWrite( osal_nv_cacheEntry_t *pEntry, uint16_t len, void *buf );
+static uint8_t osal_nv_cacheCommit( osal_nv_cacheEntry_t *pEntry );
+#endif // OSAL_NV_CACHE
+
 
 /******************************************************************************
  * @fn      osal_nv_init
@@ -143,6 +190,19 @@ uint8_t osal_nv_item_init_ex( uint16_t id, uint16_t subId, uint16_t len, void *b
       return ( SUCCESS );
     }
 
+#ifdef OSAL_NV_CACHE
+    {
+      osal_nv_cacheEntry_t *pEntry = osal_nv_cacheFind( id, subId );
+
+      if ( pEntry != NULL )
+      {
+        // Item is (re)created, the cached copy no longer applies
+        pEntry->valid = FALSE;
+        pEntry->dirty = FALSE;
+      }
+    }
+#endif // OSAL_NV_CACHE
+
     if ( pZStackCfg->nvFps.createItem( nvId, len, buf ) == NVINTF_FAILURE )
     {
       // Operation failed
@@ -233,6 +293,33 @@ uint16_t osal_nv_item_len( uint16_t id )
  *          exist in NV and offset is non-zero, NV_OPER_FAILED if failure.
  */
 uint8_t osal_nv_write_ex( uint16_t id, uint16_t subId, uint16_t len, void *buf )
+{
+#ifdef OSAL_NV_CACHE
+  osal_nv_cacheEntry_t *pEntry = osal_nv_cacheFind( id, subId );
+
+  if ( pEntry != NULL )
+  {
+    return ( osal_nv_cacheWrite( pEntry, len, buf ) );
+  }
+#endif // OSAL_NV_CACHE
+
+  return ( osal_nv_writeItem( id, subId, len, buf ) );
+}
+
+/******************************************************************************
+ * @fn      osal_nv_writeItem
+ *
+ * @brief   Write a data item straight to the NV driver.
+ *
+ * @param   id  - Valid NV item Id.
+ * @param   subId - Valid NV item sub Id.
+ * @param   len - Length of data to write.
+ * @param  *buf - Data to write.
+ *
+ * @return  SUCCESS if successful, NV_ITEM_UNINIT if item did not
+ *          exist in NV, NV_OPER_FAILED if failure.
+ */
+static uint8_t osal_nv_writeItem( uint16_t id, uint16_t subId, uint16_t len, void *buf )
 {
   uint8_t rtrn = SUCCESS;
   uint8_t status;
@@ -302,6 +389,22 @@ uint8_t osal_nv_write( uint16_t id, uint16_t len, void *buf )
  */
 uint8_t osal_nv_read_ex( uint16_t id, uint16_t subId, uint16_t ndx, uint16_t len, void *buf )
 {
+#ifdef OSAL_NV_CACHE
+  osal_nv_cacheEntry_t *pEntry = osal_nv_cacheFind( id, subId );
+
+  if ( pEntry != NULL )
+  {
+    if ( pEntry->valid && ( (uint32_t)ndx + len <= pEntry->len ) )
+    {
+      // Serve the read from the cached copy, it may be newer than NV
+      memcpy( buf, &pEntry->buf[ndx], len );
+      return ( SUCCESS );
+    }
+
+    // Make NV current before reading past the cached copy
+    (void)osal_nv_cacheCommit( pEntry );
+  }
+#endif // OSAL_NV_CACHE
 
   if ( pZStackCfg && pZStackCfg->nvFps.readItem )
   {
@@ -349,6 +452,19 @@ uint8_t osal_nv_read_ex( uint16_t id, uint16_t subId, uint16_t ndx, uint16_t len
 uint8_t osal_nv_read_match_entry( uint16_t id, uint16_t *subId, uint16_t ndx, uint16_t len, void *buf, uint16_t clen, uint16_t coff, void *cBuf )
 {
 
+#ifdef OSAL_NV_CACHE
+  uint8_t i;
+
+  // The content search runs on NV, commit the pending writes it may cover
+  for ( i = 0; i < OSAL_NV_CACHE_ENTRIES; i++ )
+  {
+    if ( osal_nv_cacheTable[i].inUse && ( osal_nv_cacheTable[i].id == id ) )
+    {
+      (void)osal_nv_cacheCommit( &osal_nv_cacheTable[i] );
+    }
+  }
+#endif // OSAL_NV_CACHE
+
   if ( pZStackCfg && pZStackCfg->nvFps.readContItem )
   {
     NVINTF_itemID_t nvId;
@@ -431,6 +547,19 @@ uint8_t osal_nv_delete_ex( uint16_t id, uint16_t subId, uint16_t len )
     {
       ret = NV_OPER_FAILED;
     }
+#ifdef OSAL_NV_CACHE
+    else
+    {
+      osal_nv_cacheEntry_t *pEntry = osal_nv_cacheFind( id, subId );
+
+      if ( pEntry != NULL )
+      {
+        // Item is gone, drop the cached copy and any pending write
+        pEntry->valid = FALSE;
+        pEntry->dirty = FALSE;
+      }
+    }
+#endif // OSAL_NV_CACHE
   }
 
   return ( ret );
@@ -456,5 +585,337 @@ uint8_t osal_nv_delete( uint16_t id, uint16_t len )
   return ( osal_nv_delete_ex( ZCD_NV_EX_LEGACY, id, len ) );
 }
 
+#ifdef OSAL_NV_CACHE
+/******************************************************************************
+ * @fn      osal_nv_cacheFind
+ *
+ * @brief   Find the write-back cache entry of an NV item.
+ *
+ * @param   id  - Valid NV item Id.
+ * @param   subId - Valid NV item sub Id.
+ *
+ * @return  Pointer to the entry, NULL if the item has no cache policy.
+ */
+static osal_nv_cacheEntry_t *osal_nv_cacheFind( uint16_t id, uint16_t subId )
+{
+  uint8_t i;
+
+  for ( i = 0; i < OSAL_NV_CACHE_ENTRIES; i++ )
+  {
+    if ( osal_nv_cacheTable[i].inUse
+        && ( osal_nv_cacheTable[i].id == id )
+        && ( osal_nv_cacheTable[i].subId == subId ) )
+    {
+      return ( &osal_nv_cacheTable[i] );
+    }
+  }
+
+  return ( NULL );
+}
+
+/******************************************************************************
+ * @fn      osal_nv_cacheWrite
+ *
+ * @brief   Write a data item through its write-back cache entry. Writes of
+ *          unchanged data are dropped, writes of an item known to exist with
+ *          the same length are deferred according to the entry policy and
+ *          anything else goes straight to NV.
+ *
+ * @param   pEntry - Cache entry of the item.
+ * @param   len - Length of data to write.
+ * @param  *buf - Data to write.
+ *
+ * @return  SUCCESS if successful, NV_ITEM_UNINIT if item did not
+ *          exist in NV, NV_OPER_FAILED if failure.
+ */
+static uint8_t osal_nv_cacheWrite( osal_nv_cacheEntry_t *pEntry, uint16_t len, void *buf )
+{
+  uint8_t status;
+
+  if ( pEntry->valid && ( pEntry->len == len ) )
+  {
+    if ( memcmp( pEntry->buf, buf, len ) == 0 )
+    {
+      // Same as the item, or its pending write, nothing to do
+      osal_nv_cacheMetrics.writesSkipped++;
+      osal_nv_cacheMetrics.bytesSaved += len;
+      return ( SUCCESS );
+    }
+
+    if ( ( pEntry->policy != OSAL_NV_CACHE_WRITETHROUGH ) && !osal_nv_cacheLowVolt )
+    {
+      if ( pEntry->dirty )
+      {
+        // The pending write never reaches flash
+        osal_nv_cacheMetrics.writesCoalesced++;
+        osal_nv_cacheMetrics.bytesSaved += len;
+      }
+      else
+      {
+        pEntry->dirty = TRUE;
+        pEntry->age = 0;
+      }
+
+      memcpy( pEntry->buf, buf, len );
+      return ( SUCCESS );
+    }
+  }
+
+  status = osal_nv_writeItem( pEntry->id, pEntry->subId, len, buf );
+
+  if ( status == SUCCESS )
+  {
+    if ( osal_nv_cacheVoltCheck == NULL )
+    {
+      // NV accepted the write, so the supply voltage has recovered
+      osal_nv_cacheLowVolt = FALSE;
+    }
+
+    // This write supersedes any pending one
+    pEntry->dirty = FALSE;
+    pEntry->valid = ( len <= OSAL_NV_CACHE_ITEM_LEN );
+    if ( pEntry->valid )
+    {
+      pEntry->len = len;
+      memcpy( pEntry->buf, buf, len );
+    }
+  }
+
+  return ( status );
+}
+
+/******************************************************************************
+ * @fn      osal_nv_cacheCommit
+ *
+ * @brief   Write the pending data of a write-back cache entry to NV.
+ *
+ * @param   pEntry - Cache entry of the item.
+ *
+ * @return  SUCCESS if nothing is pending anymore, NV_OPER_FAILED if the
+ *          write failed and is still pending.
+ */
+static uint8_t osal_nv_cacheCommit( osal_nv_cacheEntry_t *pEntry )
+{
+  uint8_t status = SUCCESS;
+
+  if ( pEntry->dirty )
+  {
+    status = osal_nv_writeItem( pEntry->id, pEntry->subId, pEntry->len, pEntry->buf );
+
+    if ( status == SUCCESS )
+    {
+      pEntry->dirty = FALSE;
+      osal_nv_cacheMetrics.flushes++;
+    }
+    else if ( status == NV_ITEM_UNINIT )
+    {
+      // Item was removed underneath the cache, nothing left to update
+      pEntry->valid = FALSE;
+      pEntry->dirty = FALSE;
+      status = SUCCESS;
+    }
+  }
+
+  return ( status );
+}
+
+/******************************************************************************
+ * @fn      osal_nv_cache_setPolicy
+ *
+ * @brief   Give an NV item a write-back cache policy. Only items of up to
+ *          OSAL_NV_CACHE_ITEM_LEN bytes are held in RAM, larger ones are
+ *          always written through. Changing an item to write-through commits
+ *          its pending write.
+ *
+ * @param   id  - Valid NV item Id.
+ * @param   subId - Valid NV item sub Id.
+ * @param   policy - OSAL_NV_CACHE_WRITETHROUGH, OSAL_NV_CACHE_DEFERRED or
+ *                   OSAL_NV_CACHE_ONSHUTDOWN.
+ * @param   maxLatency - Longest time in ms a deferred write is held, only
+ *                       used by OSAL_NV_CACHE_DEFERRED.
+ *
+ * @return  SUCCESS if the policy was set, NV_OPER_FAILED if the cache is full.
+ */
+uint8_t osal_nv_cache_setPolicy( uint16_t id, uint16_t subId, uint8_t policy, uint32_t maxLatency )
+{
+  osal_nv_cacheEntry_t *pEntry = osal_nv_cacheFind( id, subId );
+  uint16_t len;
+  uint8_t i;
+
+  if ( pEntry == NULL )
+  {
+    for ( i = 0; i < OSAL_NV_CACHE_ENTRIES; i++ )
+    {
+      if ( !osal_nv_cacheTable[i].inUse )
+      {
+        pEntry = &osal_nv_cacheTable[i];
+        break;
+      }
+    }
+
+    if ( pEntry == NULL )
+    {
+      return ( NV_OPER_FAILED );
+    }
+
+    pEntry->id = id;
+    pEntry->subId = subId;
+    pEntry->valid = FALSE;
+    pEntry->dirty = FALSE;
+    pEntry->inUse = TRUE;
+
+    // Load the current contents so that a first identical write is skipped
+    len = osal_nv_item_len_ex( id, subId );
+    if ( ( len > 0 ) && ( len <= OSAL_NV_CACHE_ITEM_LEN )
+        && ( osal_nv_read_ex( id, subId, 0, len, pEntry->buf ) == SUCCESS ) )
+    {
+      pEntry->len = len;
+      pEntry->valid = TRUE;
+    }
+  }
+  else if ( policy == OSAL_NV_CACHE_WRITETHROUGH )
+  {
+    (void)osal_nv_cacheCommit( pEntry );
+  }
+
+  pEntry->policy = policy;
+  pEntry->maxLatency = maxLatency;
+
+  return ( SUCCESS );
+}
+
+/******************************************************************************
+ * @fn      osal_nv_cache_process
+ *
+ * @brief   Age the deferred NV writes and commit the ones that reached their
+ *          maximum latency. When the voltage check registered with
+ *          osal_nv_cache_setVoltageCheck() reports a low supply, everything
+ *          pending is committed right away and new writes are no longer
+ *          deferred until the supply has recovered. Called periodically, the
+ *          call period is the resolution of the maximum latency and of the
+ *          supply check.
+ *
+ * @param   elapsed - Time in ms since the previous call.
+ *
+ * @return  none
+ */
+void osal_nv_cache_process( uint32_t elapsed )
+{
+  osal_nv_cacheEntry_t *pEntry;
+  uint8_t i;
+
+  if ( osal_nv_cacheVoltCheck != NULL )
+  {
+    osal_nv_cacheLowVolt = !osal_nv_cacheVoltCheck();
+  }
+
+  if ( osal_nv_cacheLowVolt )
+  {
+    // Write everything while NV still takes it
+    (void)osal_nv_cache_flush();
+    return;
+  }
+
+  for ( i = 0; i < OSAL_NV_CACHE_ENTRIES; i++ )
+  {
+    pEntry = &osal_nv_cacheTable[i];
+
+    if ( pEntry->inUse && pEntry->dirty )
+    {
+      if ( pEntry->policy == OSAL_NV_CACHE_DEFERRED )
+      {
+        pEntry->age += elapsed;
+      }
+
+      if ( ( pEntry->policy == OSAL_NV_CACHE_DEFERRED )
+          && ( pEntry->age >= pEntry->maxLatency ) )
+      {
+        (void)osal_nv_cacheCommit( pEntry );
+      }
+    }
+  }
+}
+
+/******************************************************************************
+ * @fn      osal_nv_cache_flush
+ *
+ * @brief   Commit all deferred NV writes, regardless of their policy. Must be
+ *          called before a reset or shutdown.
+ *
+ * @param   none
+ *
+ * @return  SUCCESS if nothing is pending anymore, NV_OPER_FAILED otherwise.
+ */
+uint8_t osal_nv_cache_flush( void )
+{
+  uint8_t status = SUCCESS;
+  uint8_t i;
+
+  for ( i = 0; i < OSAL_NV_CACHE_ENTRIES; i++ )
+  {
+    if ( osal_nv_cacheTable[i].inUse
+        && ( osal_nv_cacheCommit( &osal_nv_cacheTable[i] ) != SUCCESS ) )
+    {
+      status = NV_OPER_FAILED;
+    }
+  }
+
+  return ( status );
+}
+
+/******************************************************************************
+ * @fn      osal_nv_cache_lowVoltage
+ *
+ * @brief   Report a supply voltage too low for NV writes, e.g. from the
+ *          NVOCMP low voltage callback. New writes are no longer deferred.
+ *          NV refuses writes at this voltage, so what is pending stays in
+ *          RAM and is lost if power fails; osal_nv_cache_setVoltageCheck()
+ *          is what commits it in time. Writes are deferred again once the
+ *          voltage check passes, or without one, once NV accepts a write.
+ *          Only sets a flag, so it is safe to call from within the NV driver.
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+void osal_nv_cache_lowVoltage( void )
+{
+  osal_nv_cacheLowVolt = TRUE;
+}
+
+/******************************************************************************
+ * @fn      osal_nv_cache_setVoltageCheck
+ *
+ * @brief   Register an early warning supply check. It is called by every
+ *          osal_nv_cache_process() and must return FALSE while the supply is
+ *          close to, but still above, the minimum NV write voltage. Pending
+ *          writes are then committed at once and new ones are written
+ *          through, until it returns TRUE again. Without a check, deferred
+ *          and on-shutdown data is lost on a power failure.
+ *
+ * @param   pfnVoltCheck - Supply check, NULL to remove it.
+ *
+ * @return  none
+ */
+void osal_nv_cache_setVoltageCheck( osal_nv_cacheVoltCheck_t pfnVoltCheck )
+{
+  osal_nv_cacheVoltCheck = pfnVoltCheck;
+}
+
+/******************************************************************************
+ * @fn      osal_nv_cache_getMetrics
+ *
+ * @brief   Get the write-back cache counters.
+ *
+ * @param   pMetrics - Counters are copied here.
+ *
+ * @return  none
+ */
+void osal_nv_cache_getMetrics( osal_nv_cacheMetrics_t *pMetrics )
+{
+  *pMetrics = osal_nv_cacheMetrics;
+}
+#endif // OSAL_NV_CACHE
+
 /*********************************************************************
  */
@@ -62,6 +62,13 @@ extern "C"
  * CONSTANTS
  */
 
+#ifdef OSAL_NV_CACHE
+// Write-back cache policies, see osal_nv_cache_setPolicy()
+#define OSAL_NV_CACHE_WRITETHROUGH    0   // Write immediately, skip identical data
+#define OSAL_NV_CACHE_DEFERRED        1   // Hold in RAM for at most maxLatency ms
+#define OSAL_NV_CACHE_ONSHUTDOWN      2   // Hold in RAM until osal_nv_cache_flush()
+#endif // OSAL_NV_CACHE
+
 /*********************************************************************
  * MACROS
  */
@@ -70,6 +77,20 @@ extern "C"
  * TYPEDEFS
  */
 
+#ifdef OSAL_NV_CACHE
+// Write-back cache counters
+typedef struct
+{
+  uint32_t writesSkipped;     // Writes dropped because the data was unchanged
+  uint32_t writesCoalesced;   // Deferred writes superseded before reaching flash
+  uint32_t bytesSaved;        // Item bytes not written to flash by the above
+  uint32_t flushes;           // Deferred writes committed to flash
+} osal_nv_cacheMetrics_t;
+
+// Supply check for osal_nv_cache_setVoltageCheck(), FALSE when getting low
+typedef uint8_t (*osal_nv_cacheVoltCheck_t)( void );
+#endif // OSAL_NV_CACHE
+
 /*********************************************************************
  * GLOBAL VARIABLES
  */
@@ -138,6 +159,38 @@ extern uint16_t osal_nv_item_len_ex( uint16_t id, uint16_t subId );
  */
 extern uint8_t osal_nv_delete_ex( uint16_t id, uint16_t subId, uint16_t len );
 
+#ifdef OSAL_NV_CACHE
+/*
+ * Set the write-back cache policy of an NV item (extended format)
+ */
+extern uint8_t osal_nv_cache_setPolicy( uint16_t id, uint16_t subId, uint8_t policy, uint32_t maxLatency );
+
+/*
+ * Age the deferred NV writes and commit the overdue ones
+ */
+extern void osal_nv_cache_process( uint32_t elapsed );
+
+/*
+ * Commit all deferred NV writes
+ */
+extern uint8_t osal_nv_cache_flush( void );
+
+/*
+ * Stop deferring NV writes after a low supply voltage was reported
+ */
+extern void osal_nv_cache_lowVoltage( void );
+
+/*
+ * Register an early warning supply check that commits deferred NV writes
+ */
+extern void osal_nv_cache_setVoltageCheck( osal_nv_cacheVoltCheck_t pfnVoltCheck );
+
+/*
+ * Get the write-back cache counters
+ */
+extern void osal_nv_cache_getMetrics( osal_nv_cacheMetrics_t *pMetrics );
+#endif // OSAL_NV_CACHE
+
 /*********************************************************************
 *********************************************************************/
 
@@ -62,6 +62,33 @@
 /* Only 1 application can talk to the MAC */
 #define MAX_TASKS 15
 
+#ifdef OSAL_PORT_MSG_POOL
+/* Number of blocks of each message pool class. Block sizes include the
+ * OsalPort_MsgHdr and match the common zstackmsg_* and MAC event
+ * structures. A class can be removed by setting its count to 0.
+ */
+#ifndef OsalPort_MSG_POOL_32_CNT
+#define OsalPort_MSG_POOL_32_CNT  16
+#endif
+#ifndef OsalPort_MSG_POOL_64_CNT
+#define OsalPort_MSG_POOL_64_CNT  12
+#endif
+#ifndef OsalPort_MSG_POOL_128_CNT
+#define OsalPort_MSG_POOL_128_CNT 8
+#endif
+#ifndef OsalPort_MSG_POOL_256_CNT
+#define OsalPort_MSG_POOL_256_CNT 4
+#endif
+
+#define OsalPort_MSG_POOL_CLASSES 4
+
+/* Pool storage, as 32-bit words to keep every block aligned */
+#define OsalPort_MSG_POOL_WORDS  ( (OsalPort_MSG_POOL_32_CNT * 32 +   \
+                                    OsalPort_MSG_POOL_64_CNT * 64 +   \
+                                    OsalPort_MSG_POOL_128_CNT * 128 + \
+                                    OsalPort_MSG_POOL_256_CNT * 256) / 4 )
+#endif
+
 /***** Variable declarations *****/
 
 
@@ -84,6 +111,9 @@ typedef struct
     uint8_t taskId;
     pthread_t taskHndl;
     OsalPort_MsgQ qHandle;
+    void* qTail;            /* last message of qHandle */
+    uint16_t qDepth;        /* messages in qHandle */
+    uint16_t qDepthMax;     /* high water mark of qDepth */
     sem_t* taskSem;
     bool conservePower;
     uint32_t* pEventFlag;
@@ -101,6 +131,31 @@ typedef struct
 /*static*/ TaskEntry taskTbl[MAX_TASKS];
 /*static*/ uint8_t taskCnt = 0;
 
+#ifdef OSAL_PORT_MSG_POOL
+typedef struct
+{
+    uint16_t blkSize;
+    uint16_t blkCnt;
+    uint16_t blkUsed;
+    uint16_t blkUsedMax;    /* high water mark of blkUsed */
+    uint8_t *pStart;
+    uint8_t *pEnd;
+    void *pFree;            /* free blocks, linked through their first word */
+} MsgPoolClass;
+
+static uint32_t msgPoolMem[OsalPort_MSG_POOL_WORDS];
+static MsgPoolClass msgPool[OsalPort_MSG_POOL_CLASSES] =
+{
+    { 32,  OsalPort_MSG_POOL_32_CNT,  0, 0, NULL, NULL, NULL },
+    { 64,  OsalPort_MSG_POOL_64_CNT,  0, 0, NULL, NULL, NULL },
+    { 128, OsalPort_MSG_POOL_128_CNT, 0, 0, NULL, NULL, NULL },
+    { 256, OsalPort_MSG_POOL_256_CNT, 0, 0, NULL, NULL, NULL }
+};
+static bool msgPoolInitDone = false;
+/* allocations served by the heap, because too large or the pool was empty */
+static uint32_t msgPoolFallbackCnt = 0;
+#endif
+
 /* instantiate variable referenced in ROM but not used */
 uint16_t *macTasksEvents = 0;
 
@@ -116,6 +171,14 @@ typedef struct _osalPort_schedule_t
 } OsalPort_ScheduleEntry;
 
 /***** Private function definitions *****/
+static TaskEntry* taskEntryById(uint8_t taskId);
+static TaskEntry* taskEntryByQ(OsalPort_MsgQ *pQ);
+#ifdef OSAL_PORT_MSG_POOL
+static void msgPoolInit(void);
+static void *msgPoolAlloc(uint32_t size);
+static bool msgPoolFree(void *pBlk);
+#endif
+
 #ifndef FREERTOS_SUPPORT
 // DMM currently uses ICall Heap
 #if 0   // #ifdef USE_DMM replaced as suggested by Ryan Brown (TI) in the 'AMPT - CC1352P7 RF Switching Protocol Debug'
@@ -199,6 +262,9 @@ uint8_t OsalPort_registerTask(void* taskHndl, void* taskSem, uint32_t* pEvent)
         taskTbl[taskCnt].taskHndl = taskHndl;
         taskTbl[taskCnt].taskSem = (sem_t*) taskSem;
         taskTbl[taskCnt].qHandle = NULL;
+        taskTbl[taskCnt].qTail = NULL;
+        taskTbl[taskCnt].qDepth = 0;
+        taskTbl[taskCnt].qDepthMax = 0;
         taskTbl[taskCnt].conservePower = false;
         taskTbl[taskCnt].pEventFlag = pEvent;
     }
@@ -240,6 +306,10 @@ uint8_t * OsalPort_msgAllocate(uint16_t len )
     if ( len == 0 )
         return ( NULL );
 
+#ifdef OSAL_PORT_MSG_POOL
+    pHdr = (OsalPort_MsgHdr*) msgPoolAlloc( len + sizeof( OsalPort_MsgHdr ) );
+    if ( pHdr == NULL )
+#endif
     pHdr = (OsalPort_MsgHdr*) OsalPort_malloc( len + sizeof( OsalPort_MsgHdr ) );
 
     if ( pHdr )
@@ -281,11 +351,63 @@ uint8_t OsalPort_msgDeallocate( uint8_t *pMsg )
 
     x = (uint8_t *)((uint8_t *)pMsg - sizeof( OsalPort_MsgHdr ));
 
+#ifdef OSAL_PORT_MSG_POOL
+    if ( msgPoolFree( (void *)x ) )
+        return ( OsalPort_SUCCESS );
+#endif
+
     OsalPort_free( (void *)x );
 
     return ( OsalPort_SUCCESS );
 }
 
+#ifdef OSAL_PORT_MSG_POOL
+/*********************************************************************
+ * @fn      OsalPort_msgPoolGetMetrics
+ *
+ * @brief
+ *
+ *    This function returns the usage of a message pool class, and the
+ *    number of message allocations that were served by the heap.
+ *
+ * @param   uint8_t cls - pool class, 0 (smallest) to
+ *          OsalPort_MSG_POOL_CLASSES - 1
+ * @param   uint16_t *pBlkSize - block size of the class
+ * @param   uint16_t *pBlkCnt - number of blocks of the class
+ * @param   uint16_t *pBlkUsed - number of blocks in use
+ * @param   uint16_t *pBlkUsedMax - high water mark of blocks in use
+ * @param   uint32_t *pFallbackCnt - allocations served by the heap
+ *
+ * @return  OsalPort_SUCCESS, OsalPort_INVALIDPARAMETER
+ */
+uint8_t OsalPort_msgPoolGetMetrics(uint8_t cls,
+                                   uint16_t *pBlkSize,
+                                   uint16_t *pBlkCnt,
+                                   uint16_t *pBlkUsed,
+                                   uint16_t *pBlkUsedMax,
+                                   uint32_t *pFallbackCnt)
+{
+    uint32_t key;
+
+    if(cls >= OsalPort_MSG_POOL_CLASSES)
+    {
+        return OsalPort_INVALIDPARAMETER;
+    }
+
+    key = OsalPort_enterCS();
+
+    *pBlkSize = msgPool[cls].blkSize;
+    *pBlkCnt = msgPool[cls].blkCnt;
+    *pBlkUsed = msgPool[cls].blkUsed;
+    *pBlkUsedMax = msgPool[cls].blkUsedMax;
+    *pFallbackCnt = msgPoolFallbackCnt;
+
+    OsalPort_leaveCS(key);
+
+    return OsalPort_SUCCESS;
+}
+#endif
+
 /*********************************************************************
  * @fn      OsalPort_msgSend
  *
@@ -305,7 +427,7 @@ uint8_t OsalPort_msgDeallocate( uint8_t *pMsg )
  */
 uint8_t OsalPort_msgSend( uint8_t destinationTask, uint8_t *pMsg )
 {
-    uint8_t taskIdx;
+    TaskEntry* pTask;
     uint32_t key;
 
     if(pMsg == NULL)
@@ -314,22 +436,20 @@ uint8_t OsalPort_msgSend( uint8_t destinationTask, uint8_t *pMsg )
     }
 
     /*find dest task */
-    for(taskIdx = 0; taskIdx < taskCnt; taskIdx++)
+    pTask = taskEntryById(destinationTask);
+    if(pTask == NULL)
     {
-        if(taskTbl[taskIdx].taskId == destinationTask)
-        {
-            key = OsalPort_enterCS();
+        return OsalPort_INVALID_TASK;
+    }
 
-            OsalPort_msgEnqueue(&taskTbl[taskIdx].qHandle, pMsg );
-            OsalPort_setEvent(destinationTask, OsalPort_SYS_EVENT_MSG);
+    key = OsalPort_enterCS();
 
-            OsalPort_leaveCS(key);
+    OsalPort_msgEnqueue(&pTask->qHandle, pMsg );
+    OsalPort_setEvent(destinationTask, OsalPort_SYS_EVENT_MSG);
 
-            return OsalPort_SUCCESS;
-        }
-    }
+    OsalPort_leaveCS(key);
 
-    return OsalPort_INVALID_TASK;
+    return OsalPort_SUCCESS;
 }
 
 /**************************************************************************************************
@@ -352,30 +472,27 @@ uint8_t OsalPort_msgSend( uint8_t destinationTask, uint8_t *pMsg )
  */
 OsalPort_EventHdr* OsalPort_msgFind(uint8_t taskId, uint8_t event)
 {
-    uint8_t taskIdx;
+    TaskEntry* pTask;
     uint32_t key;
     OsalPort_MsgHdr *pHdr = NULL;
 
     key = OsalPort_enterCS();
 
     /*find dest task */
-    for(taskIdx = 0; taskIdx < taskCnt; taskIdx++)
+    pTask = taskEntryById(taskId);
+    if(pTask != NULL)
     {
-        if(taskTbl[taskIdx].taskId == taskId)
-        {
-            pHdr = (OsalPort_MsgHdr*) taskTbl[taskIdx].qHandle;
+        pHdr = (OsalPort_MsgHdr*) pTask->qHandle;
 
-            // Look through the tasks queue for a message that matches the task_id and event parameters.
-            while (pHdr != NULL)
-            {
-              if (((OsalPort_EventHdr *)pHdr)->event == event)
-              {
-                break;
-              }
-
-              pHdr = OsalPort_MSG_NEXT(pHdr);
-            }
+        // Look through the tasks queue for a message that matches the task_id and event parameters.
+        while (pHdr != NULL)
+        {
+          if (((OsalPort_EventHdr *)pHdr)->event == event)
+          {
             break;
+          }
+
+          pHdr = OsalPort_MSG_NEXT(pHdr);
         }
     }
 
@@ -399,27 +516,24 @@ OsalPort_EventHdr* OsalPort_msgFind(uint8_t taskId, uint8_t event)
  */
 uint8_t *OsalPort_msgReceive( uint8_t destinationTask )
 {
-    uint8_t taskIdx;
+    TaskEntry* pTask;
     uint8_t* pMsg = NULL;
 
-    for(taskIdx = 0; taskIdx < taskCnt; taskIdx++)
+    pTask = taskEntryById(destinationTask);
+    if(pTask != NULL)
     {
-        if(taskTbl[taskIdx].taskId == destinationTask)
-        {
-            pMsg = OsalPort_msgDequeue( &taskTbl[taskIdx].qHandle );
-
-            // Are there any more messages?
-            if ( OsalPort_MSG_Q_EMPTY(&taskTbl[taskIdx].qHandle) )
-            {
-                // Clear message event
-                OsalPort_clearEvent(taskIdx, OsalPort_SYS_EVENT_MSG);
-            }
-            else
-            {
-                // Signal the task that another message is waiting
-                OsalPort_setEvent(taskIdx, OsalPort_SYS_EVENT_MSG);
-            }
+        pMsg = OsalPort_msgDequeue( &pTask->qHandle );
 
+        // Are there any more messages?
+        if ( OsalPort_MSG_Q_EMPTY(&pTask->qHandle) )
+        {
+            // Clear message event
+            OsalPort_clearEvent(destinationTask, OsalPort_SYS_EVENT_MSG);
+        }
+        else
+        {
+            // Signal the task that another message is waiting
+            OsalPort_setEvent(destinationTask, OsalPort_SYS_EVENT_MSG);
         }
     }
 
@@ -441,27 +555,25 @@ uint8_t *OsalPort_msgReceive( uint8_t destinationTask )
  */
 uint8_t OsalPort_setEvent( uint8_t destinationTask, uint32_t eventFlag )
 {
-    uint8_t taskIdx;
+    TaskEntry* pTask;
     uint8_t status = OsalPort_INVALID_TASK;
     uint32_t key;
 
-    for(taskIdx = 0; taskIdx < taskCnt; taskIdx++)
+    pTask = taskEntryById(destinationTask);
+    if(pTask != NULL)
     {
-        if(taskTbl[taskIdx].taskId == destinationTask)
-        {
-            key = OsalPort_enterCS();
+        key = OsalPort_enterCS();
 
-            *taskTbl[taskIdx].pEventFlag |= (uint32_t)eventFlag;
+        *pTask->pEventFlag |= (uint32_t)eventFlag;
 
-            if(taskTbl[taskIdx].taskSem)
-            {
-                sem_post(taskTbl[taskIdx].taskSem);
-            }
+        if(pTask->taskSem)
+        {
+            sem_post(pTask->taskSem);
+        }
 
-            status = OsalPort_SUCCESS;
+        status = OsalPort_SUCCESS;
 
-            OsalPort_leaveCS(key);
-        }
+        OsalPort_leaveCS(key);
     }
 
     return status;
@@ -480,15 +592,13 @@ uint8_t OsalPort_setEvent( uint8_t destinationTask, uint32_t eventFlag )
  */
 uint32_t OsalPort_waitEvent(uint8_t taskId)
 {
-    uint8_t taskIdx;
+    TaskEntry* pTask;
 
-    for(taskIdx = 0; taskIdx < taskCnt; taskIdx++)
+    pTask = taskEntryById(taskId);
+    if(pTask != NULL)
     {
-        if(taskTbl[taskIdx].taskId == taskId)
-        {
-            sem_wait(taskTbl[taskIdx].taskSem);
-            return *taskTbl[taskIdx].pEventFlag;
-        }
+        sem_wait(pTask->taskSem);
+        return *pTask->pEventFlag;
     }
 
     return 0;
@@ -536,19 +646,31 @@ void OsalPort_blockOnEvent(void* taskHndl)
 void OsalPort_clearEvent(uint8_t taskId, uint32_t eventFlag)
 {
     uint8_t taskIdx;
+    TaskEntry* pTask = NULL;
     uint32_t key;
 
-    for(taskIdx = 0; taskIdx < taskCnt; taskIdx++)
+    if(taskId != OsalPort_TASK_NO_TASK)
     {
-        if( ((taskId != OsalPort_TASK_NO_TASK) && (taskTbl[taskIdx].taskId == taskId)) ||
-            ((taskId == OsalPort_TASK_NO_TASK) && (taskTbl[taskIdx].taskHndl == pthread_self())))
+        pTask = taskEntryById(taskId);
+    }
+    else
+    {
+        for(taskIdx = 0; taskIdx < taskCnt; taskIdx++)
         {
-            key = OsalPort_enterCS();
-            *taskTbl[taskIdx].pEventFlag &=  ~(uint32_t)eventFlag;
-            OsalPort_leaveCS(key);
-            break;
+            if(taskTbl[taskIdx].taskHndl == pthread_self())
+            {
+                pTask = &taskTbl[taskIdx];
+                break;
+            }
         }
     }
+
+    if(pTask != NULL)
+    {
+        key = OsalPort_enterCS();
+        *pTask->pEventFlag &=  ~(uint32_t)eventFlag;
+        OsalPort_leaveCS(key);
+    }
 }
 
 /*********************************************************************
@@ -567,6 +689,7 @@ void OsalPort_clearEvent(uint8_t taskId, uint32_t eventFlag)
 void OsalPort_msgEnqueue( OsalPort_MsgQ *pQ, void *pMsg )
 {
     void *list;
+    TaskEntry* pTask;
     uint32_t key;
 
     // Hold off interrupts
@@ -574,10 +697,20 @@ void OsalPort_msgEnqueue( OsalPort_MsgQ *pQ, void *pMsg )
 
     if (pMsg) {
         OsalPort_MSG_NEXT( pMsg ) = NULL;
+        pTask = taskEntryByQ(pQ);
         // If first message in queue
         if ( *pQ == NULL )
         {
           *pQ = pMsg;
+          if (pTask != NULL)
+          {
+              pTask->qDepth = 0;
+          }
+        }
+        else if (pTask != NULL)
+        {
+            // Task queues keep track of their last message
+            OsalPort_MSG_NEXT( pTask->qTail ) = pMsg;
         }
         else
         {
@@ -587,6 +720,16 @@ void OsalPort_msgEnqueue( OsalPort_MsgQ *pQ, void *pMsg )
             // Add message to end of queue
             OsalPort_MSG_NEXT( list ) = pMsg;
         }
+
+        if (pTask != NULL)
+        {
+            pTask->qTail = pMsg;
+            pTask->qDepth++;
+            if (pTask->qDepth > pTask->qDepthMax)
+            {
+                pTask->qDepthMax = pTask->qDepth;
+            }
+        }
     }
 
     // Re-enable interrupts
@@ -610,6 +753,7 @@ void OsalPort_msgEnqueue( OsalPort_MsgQ *pQ, void *pMsg )
 uint8_t OsalPort_msgEnqueueMax( OsalPort_MsgQ *pQ, void *pMsg, uint8_t max )
 {
     void *list;
+    TaskEntry* pTask;
     uint32_t key;
     uint32_t qCount = 0;
     uint8_t status = 0;
@@ -617,8 +761,15 @@ uint8_t OsalPort_msgEnqueueMax( OsalPort_MsgQ *pQ, void *pMsg, uint8_t max )
     // Hold off interrupts
     key = OsalPort_enterCS();
 
-    // Find element count
-    if(*pQ != NULL)
+    pTask = taskEntryByQ(pQ);
+
+    // Find element count, counting the messages after the head as the
+    // list walk does
+    if((pTask != NULL) && (*pQ != NULL))
+    {
+        qCount = pTask->qDepth - 1;
+    }
+    else if(*pQ != NULL)
     {
         for ( list = *pQ; OsalPort_MSG_NEXT( list ) != NULL; list = OsalPort_MSG_NEXT( list ), qCount++ );
     }
@@ -649,6 +800,7 @@ uint8_t OsalPort_msgEnqueueMax( OsalPort_MsgQ *pQ, void *pMsg, uint8_t max )
 void *OsalPort_msgDequeue( OsalPort_MsgQ *pQ )
 {
     void *pMsg = NULL;
+    TaskEntry* pTask;
     uint32_t key;
 
     // Hold off interrupts
@@ -661,6 +813,16 @@ void *OsalPort_msgDequeue( OsalPort_MsgQ *pQ )
       *pQ = OsalPort_MSG_NEXT( pMsg );
       OsalPort_MSG_NEXT( pMsg ) = NULL;
       OsalPort_MSG_ID( pMsg ) = OsalPort_TASK_NO_TASK;
+
+      pTask = taskEntryByQ(pQ);
+      if ( pTask != NULL )
+      {
+        pTask->qDepth--;
+        if ( *pQ == NULL )
+        {
+          pTask->qTail = NULL;
+        }
+      }
     }
 
     // Re-enable interrupts
@@ -684,7 +846,7 @@ void *OsalPort_msgDequeue( OsalPort_MsgQ *pQ )
  */
 OsalPort_EventHdr* OsalPort_msgFindDequeue(uint8_t taskId, uint8_t event)
 {
-    uint8_t taskIdx;
+    TaskEntry* pTask;
     uint32_t key;
     OsalPort_MsgHdr *pHdr = NULL;
     OsalPort_MsgHdr *pPrev = NULL;
@@ -693,35 +855,37 @@ OsalPort_EventHdr* OsalPort_msgFindDequeue(uint8_t taskId, uint8_t event)
     key = OsalPort_enterCS();
 
     /*find dest task */
-    for(taskIdx = 0; taskIdx < taskCnt; taskIdx++)
+    pTask = taskEntryById(taskId);
+    if(pTask != NULL)
     {
-        if(taskTbl[taskIdx].taskId == taskId)
+        pHdr = (OsalPort_MsgHdr*) pTask->qHandle;
+
+        // Look through the tasks queue for a message that matches the task_id and event parameters.
+        while (pHdr != NULL)
         {
-            pHdr = (OsalPort_MsgHdr*) taskTbl[taskIdx].qHandle;
+          if (((OsalPort_EventHdr *)pHdr)->event == event)
+          {
 
-            // Look through the tasks queue for a message that matches the task_id and event parameters.
-            while (pHdr != NULL)
+            if(pPrev == NULL)
             {
-              if (((OsalPort_EventHdr *)pHdr)->event == event)
-              {
-
-                if(pPrev == NULL)
-                {
-                  OsalPort_MSG_Q_HEAD(&taskTbl[taskIdx].qHandle) = OsalPort_MSG_NEXT(pHdr);
-                }
-                else
-                {
-                  OsalPort_MSG_NEXT(pPrev) = OsalPort_MSG_NEXT(pHdr);
-                }
-                OsalPort_MSG_NEXT( pHdr ) = NULL;
-                OsalPort_MSG_ID( pHdr ) = OsalPort_TASK_NO_TASK;
-                break;
-              }
-
-              pPrev = pHdr;
-              pHdr = OsalPort_MSG_NEXT(pHdr);
+              OsalPort_MSG_Q_HEAD(&pTask->qHandle) = OsalPort_MSG_NEXT(pHdr);
             }
+            else
+            {
+              OsalPort_MSG_NEXT(pPrev) = OsalPort_MSG_NEXT(pHdr);
+            }
+            if((void *)pHdr == pTask->qTail)
+            {
+              pTask->qTail = pPrev;
+            }
+            pTask->qDepth--;
+            OsalPort_MSG_NEXT( pHdr ) = NULL;
+            OsalPort_MSG_ID( pHdr ) = OsalPort_TASK_NO_TASK;
             break;
+          }
+
+          pPrev = pHdr;
+          pHdr = OsalPort_MSG_NEXT(pHdr);
         }
     }
 
@@ -745,11 +909,27 @@ OsalPort_EventHdr* OsalPort_msgFindDequeue(uint8_t taskId, uint8_t event)
  */
 void OsalPort_msgPush( OsalPort_MsgQ *pQ, void *pMsg )
 {
+    TaskEntry* pTask;
     uint32_t key;
 
     // Hold off interrupts
     key = OsalPort_enterCS();
 
+    pTask = taskEntryByQ(pQ);
+    if ( pTask != NULL )
+    {
+        if ( *pQ == NULL )
+        {
+            pTask->qTail = pMsg;
+            pTask->qDepth = 0;
+        }
+        pTask->qDepth++;
+        if ( pTask->qDepth > pTask->qDepthMax )
+        {
+            pTask->qDepthMax = pTask->qDepth;
+        }
+    }
+
     // Push message to head of queue
     OsalPort_MSG_NEXT( pMsg ) = *pQ;
     *pQ = pMsg;
@@ -774,6 +954,7 @@ void OsalPort_msgPush( OsalPort_MsgQ *pQ, void *pMsg )
  */
 void OsalPort_msgExtract( OsalPort_MsgQ *pQ, void *pMsg, void *pPrev )
 {
+    TaskEntry* pTask;
     uint32_t key;
 
     // Hold off interrupts
@@ -789,6 +970,16 @@ void OsalPort_msgExtract( OsalPort_MsgQ *pQ, void *pMsg, void *pPrev )
         // remove from middle
         OsalPort_MSG_NEXT( pPrev ) = OsalPort_MSG_NEXT( pMsg );
     }
+
+    pTask = taskEntryByQ(pQ);
+    if ( pTask != NULL )
+    {
+        pTask->qDepth--;
+        if ( pMsg == pTask->qTail )
+        {
+            pTask->qTail = ( *pQ == NULL ) ? NULL : pPrev;
+        }
+    }
     OsalPort_MSG_NEXT( pMsg ) = NULL;
     OsalPort_MSG_ID( pMsg ) = OsalPort_TASK_NO_TASK;
 
@@ -796,6 +987,43 @@ void OsalPort_msgExtract( OsalPort_MsgQ *pQ, void *pMsg, void *pPrev )
     OsalPort_leaveCS(key);
 }
 
+/*********************************************************************
+ * @fn      OsalPort_msgQueueDepth
+ *
+ * @brief
+ *
+ *    This function returns the number of messages waiting in the
+ *    queue of a task.
+ *
+ * @param   uint8_t taskId - task ID
+ * @param   uint16_t *pDepthMax - if not NULL, set to the highest number
+ *          of messages that were waiting in the queue at once
+ *
+ * @return  number of queued messages
+ */
+uint16_t OsalPort_msgQueueDepth( uint8_t taskId, uint16_t *pDepthMax )
+{
+    TaskEntry* pTask;
+    uint16_t depth = 0;
+    uint32_t key;
+
+    key = OsalPort_enterCS();
+
+    pTask = taskEntryById(taskId);
+    if(pTask != NULL)
+    {
+        depth = pTask->qDepth;
+        if(pDepthMax != NULL)
+        {
+            *pDepthMax = pTask->qDepthMax;
+        }
+    }
+
+    OsalPort_leaveCS(key);
+
+    return depth;
+}
+
 /*********************************************************************
  * @fn      OsalPort_pwrmgr_task_state
  *
@@ -1279,3 +1507,163 @@ uint16_t OsalPort_rand( void )
     return (Random_getNumber() & 0xFFFF);
 }
 
+/***** Private function definitions *****/
+
+/*********************************************************************
+ * @fn      taskEntryById
+ *
+ * @brief   Get the task table entry of a task. Task IDs are handed out
+ *          by OsalPort_registerTask as the index in the task table.
+ *
+ * @param   uint8_t taskId - task ID
+ *
+ * @return  task table entry, NULL if the task is not registered
+ */
+static TaskEntry* taskEntryById(uint8_t taskId)
+{
+    if((taskId < taskCnt) && (taskId < MAX_TASKS))
+    {
+        return &taskTbl[taskId];
+    }
+
+    return NULL;
+}
+
+/*********************************************************************
+ * @fn      taskEntryByQ
+ *
+ * @brief   Get the task table entry owning a message queue
+ *
+ * @param   OsalPort_MsgQ *pQ - OSAL queue
+ *
+ * @return  task table entry, NULL if pQ is not a task queue
+ */
+static TaskEntry* taskEntryByQ(OsalPort_MsgQ *pQ)
+{
+    uint32_t taskIdx;
+
+    if((pQ >= &taskTbl[0].qHandle) && (pQ <= &taskTbl[MAX_TASKS - 1].qHandle))
+    {
+        taskIdx = ((uint8_t *)pQ - (uint8_t *)&taskTbl[0].qHandle) / sizeof(TaskEntry);
+        if(&taskTbl[taskIdx].qHandle == pQ)
+        {
+            return &taskTbl[taskIdx];
+        }
+    }
+
+    return NULL;
+}
+
+#ifdef OSAL_PORT_MSG_POOL
+/*********************************************************************
+ * @fn      msgPoolInit
+ *
+ * @brief   Split the pool storage in blocks and build the free list of
+ *          each class. Must be called in a critical section.
+ */
+static void msgPoolInit(void)
+{
+    uint8_t cls;
+    uint16_t blk;
+    uint8_t *pMem = (uint8_t *)msgPoolMem;
+
+    for(cls = 0; cls < OsalPort_MSG_POOL_CLASSES; cls++)
+    {
+        msgPool[cls].pStart = pMem;
+        msgPool[cls].pFree = NULL;
+        for(blk = 0; blk < msgPool[cls].blkCnt; blk++)
+        {
+            *(void **)pMem = msgPool[cls].pFree;
+            msgPool[cls].pFree = pMem;
+            pMem += msgPool[cls].blkSize;
+        }
+        msgPool[cls].pEnd = pMem;
+    }
+
+    msgPoolInitDone = true;
+}
+
+/*********************************************************************
+ * @fn      msgPoolAlloc
+ *
+ * @brief   Allocate a block from the smallest pool class that fits and
+ *          has a free block
+ *
+ * @param   uint32_t size - wanted size, message header included
+ *
+ * @return  block or NULL if the heap has to be used
+ */
+static void *msgPoolAlloc(uint32_t size)
+{
+    uint8_t cls;
+    void *pBlk = NULL;
+    uint32_t key;
+
+    key = OsalPort_enterCS();
+
+    if(!msgPoolInitDone)
+    {
+        msgPoolInit();
+    }
+
+    for(cls = 0; cls < OsalPort_MSG_POOL_CLASSES; cls++)
+    {
+        if((size <= msgPool[cls].blkSize) && (msgPool[cls].pFree != NULL))
+        {
+            pBlk = msgPool[cls].pFree;
+            msgPool[cls].pFree = *(void **)pBlk;
+            msgPool[cls].blkUsed++;
+            if(msgPool[cls].blkUsed > msgPool[cls].blkUsedMax)
+            {
+                msgPool[cls].blkUsedMax = msgPool[cls].blkUsed;
+            }
+            break;
+        }
+    }
+
+    if(pBlk == NULL)
+    {
+        msgPoolFallbackCnt++;
+    }
+
+    OsalPort_leaveCS(key);
+
+    return pBlk;
+}
+
+/*********************************************************************
+ * @fn      msgPoolFree
+ *
+ * @brief   Return a block to its pool class
+ *
+ * @param   void *pBlk - block to free
+ *
+ * @return  true if the block belongs to the pool, false if it has to be
+ *          freed to the heap
+ */
+static bool msgPoolFree(void *pBlk)
+{
+    uint8_t cls;
+    bool found = false;
+    uint32_t key;
+
+    key = OsalPort_enterCS();
+
+    for(cls = 0; cls < OsalPort_MSG_POOL_CLASSES; cls++)
+    {
+        if(((uint8_t *)pBlk >= msgPool[cls].pStart) &&
+           ((uint8_t *)pBlk < msgPool[cls].pEnd))
+        {
+            *(void **)pBlk = msgPool[cls].pFree;
+            msgPool[cls].pFree = pBlk;
+            msgPool[cls].blkUsed--;
+            found = true;
+            break;
+        }
+    }
+
+    OsalPort_leaveCS(key);
+
+    return found;
+}
+#endif
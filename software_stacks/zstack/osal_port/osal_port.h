@@ -390,6 +390,47 @@ extern void OsalPort_msgPush( OsalPort_MsgQ *pQ, void *pMsg );
  */
 extern void OsalPort_msgExtract( OsalPort_MsgQ *pQ, void *pMsg, void *pPrev );
 
+#ifdef OSAL_PORT_MSG_POOL
+/*********************************************************************
+ * @fn      OsalPort_msgPoolGetMetrics
+ *
+ * @brief
+ *
+ *    This function returns the usage of a message pool class, and the
+ *    number of message allocations that were served by the heap.
+ *
+ * @param   uint8_t cls - pool class, 0 (smallest) to 3
+ * @param   uint16_t *pBlkSize - block size of the class
+ * @param   uint16_t *pBlkCnt - number of blocks of the class
+ * @param   uint16_t *pBlkUsed - number of blocks in use
+ * @param   uint16_t *pBlkUsedMax - high water mark of blocks in use
+ * @param   uint32_t *pFallbackCnt - allocations served by the heap
+ *
+ * @return  OsalPort_SUCCESS, OsalPort_INVALIDPARAMETER
+ */
+extern uint8_t OsalPort_msgPoolGetMetrics(uint8_t cls,
+                                          uint16_t *pBlkSize,
+                                          uint16_t *pBlkCnt,
+                                          uint16_t *pBlkUsed,
+                                          uint16_t *pBlkUsedMax,
+                                          uint32_t *pFallbackCnt);
+#endif
+
+/*********************************************************************
+ * @fn      OsalPort_msgQueueDepth
+ *
+ * @brief
+ *
+ *    This function returns the number of messages waiting in the
+ *    queue of a task.
+ *
+ * @param   uint8_t taskId - task ID
+ * @param   uint16_t *pDepthMax - if not NULL, set to the high water mark
+ *
+ * @return  number of queued messages
+ */
+extern uint16_t OsalPort_msgQueueDepth( uint8_t taskId, uint16_t *pDepthMax );
+
 /*********************************************************************
  * @fn      OsalPort_pwrmgr_task_state
  *
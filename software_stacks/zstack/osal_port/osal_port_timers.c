@@ -53,15 +53,49 @@
 
 /***** Defines *****/
 
+/* Number of preallocated timer entries. When more timers are active at
+ * the same time the pool is grown from the heap, by
+ * OsalPortTimers_GROW_TIMERS entries at a time, up to 254 entries.
+ */
+#ifndef OsalPortTimers_MAX_TIMERS
+#define OsalPortTimers_MAX_TIMERS 32
+#endif
+
+#ifndef OsalPortTimers_GROW_TIMERS
+#define OsalPortTimers_GROW_TIMERS 8
+#endif
+
+/* Number of (taskId, eventId) hash buckets, must be a power of 2 */
+#ifndef OsalPortTimers_HASH_SIZE
+#define OsalPortTimers_HASH_SIZE 16
+#endif
+
+#if (OsalPortTimers_MAX_TIMERS >= 0xFF)
+#error "OsalPortTimers_MAX_TIMERS must be less than 255"
+#endif
+
+#define TIMER_IDX_NONE 0xFF
+
+/* Time comparison that survives the system tick counter wrapping */
+#define TIMER_BEFORE(a, b) ((int32_t)((a) - (b)) < 0)
+
+/* Longest time an expiry is set ahead of the clock. TIMER_BEFORE only
+ * orders ticks less than 2^31 apart, longer timeouts are run as a chain
+ * of segments of at most this many ticks.
+ */
+#define TIMER_MAX_SEGMENT 0x40000000UL
+
 /***** Typedefs *****/
 
 typedef struct
 {
-    ClockP_Handle clockHandle;
-    uint8_t taskId;
+    uint64_t remaining; /* ticks left after the current segment */
+    uint32_t expiry;    /* system tick the current segment expires at */
+    uint32_t period;    /* reload period in ms, 0 for one shot */
     uint32_t eventId;
-    bool reload;
-    void* pNext;
+    uint8_t taskId;
+    uint8_t heapPos;    /* position in timerHeap, TIMER_IDX_NONE if free */
+    uint8_t hashNext;   /* next entry in the same hash bucket or free list */
 } TimerEntry_t;
 
 /***** Variable declarations *****/
@@ -69,13 +103,41 @@ static uint8_t stackTaskID;
 static uint32_t stackEventID;
 
 /***** Private variables *****/
-static TimerEntry_t* pTimerEntries = NULL;
-static TimerEntry_t* pDeleteTimerEntries = NULL;
+
+/* Timer entries, preallocated and replaced by a larger heap allocated
+ * array when they are all in use
+ */
+static TimerEntry_t timerPoolStatic[OsalPortTimers_MAX_TIMERS];
+static TimerEntry_t* timerPool = timerPoolStatic;
+static uint8_t timerPoolSize = OsalPortTimers_MAX_TIMERS;
+static uint8_t timerFreeList = TIMER_IDX_NONE;
+static bool timerPoolInit = false;
+
+/* Active timers, by (taskId, eventId) and by expiry (binary min-heap) */
+static uint8_t timerHash[OsalPortTimers_HASH_SIZE];
+static uint8_t timerHeapStatic[OsalPortTimers_MAX_TIMERS];
+static uint8_t* timerHeap = timerHeapStatic;
+static uint8_t timerHeapCnt = 0;
+
+/* Single clock armed for the earliest expiry */
+static ClockP_Handle timerClockHandle = NULL;
 
 /***** Private function definitions *****/
 static void timerCb(uintptr_t arg);
 static uint8_t createTimerEntry(uint8_t taskId, uint32_t eventId, uint32_t timeout, bool reload);
-static TimerEntry_t* getTimerEntry(uint8_t taskId, uint32_t eventId);
+static uint8_t getTimerEntry(uint8_t taskId, uint32_t eventId);
+static bool timerInit(void);
+static bool timerGrow(void);
+static uint64_t timerTicks(uint32_t timeout);
+static void timerSetExpiry(uint8_t idx, uint32_t start, uint64_t ticks);
+static uint8_t timerHashIdx(uint8_t taskId, uint32_t eventId);
+static void timerHeapSwap(uint8_t posA, uint8_t posB);
+static void timerHeapUp(uint8_t pos);
+static void timerHeapDown(uint8_t pos);
+static void timerHeapInsert(uint8_t idx);
+static void timerHeapRemove(uint8_t idx);
+static void timerRelease(uint8_t idx);
+static void timerArm(void);
 
 /***** Public function definitions *****/
 
@@ -140,37 +202,25 @@ uint8_t OsalPortTimers_startReloadTimer(uint8_t taskId, uint32_t eventId, uint32
  */
 uint8_t OsalPortTimers_stopTimer(uint8_t taskId, uint32_t eventId)
 {
-    TimerEntry_t* pTimerEntry;
-
+    uint8_t idx;
     uintptr_t key;
 
     //Enter Critial Section
     key = OsalPort_enterCS();
 
-    pTimerEntry = getTimerEntry(taskId, eventId);
+    idx = getTimerEntry(taskId, eventId);
 
-    //Stop clock, remove from list and free memory
-    if(pTimerEntry != NULL)
+    //Remove from the heap and return the entry to the pool
+    if(idx != TIMER_IDX_NONE)
     {
-        ClockP_stop(pTimerEntry->clockHandle);
-        ClockP_delete(pTimerEntry->clockHandle);
+        bool wasFirst = (timerPool[idx].heapPos == 0);
 
-        //is it first in list
-        if(pTimerEntry == pTimerEntries)
-        {
-            pTimerEntries = pTimerEntry->pNext;
-            OsalPort_free(pTimerEntry);
-        }
-        else
+        timerHeapRemove(idx);
+        timerRelease(idx);
+
+        if(wasFirst)
         {
-            //find prev entry
-            TimerEntry_t* pTimerEntryPrev = pTimerEntries;
-            while(pTimerEntryPrev->pNext != pTimerEntry)
-            {
-                pTimerEntryPrev = pTimerEntryPrev->pNext;
-            }
-            pTimerEntryPrev->pNext = pTimerEntry->pNext;
-            OsalPort_free(pTimerEntry);
+            timerArm();
         }
     }
     else
@@ -202,20 +252,28 @@ uint8_t OsalPortTimers_stopTimer(uint8_t taskId, uint32_t eventId)
  */
 uint32_t OsalPortTimers_getTimerTimeout(uint8_t taskId, uint32_t eventId)
 {
-    TimerEntry_t* pTimerEntry;
-    uint32_t timeoutTicks;
+    uint8_t idx;
+    uint64_t timeoutTicks;
     uint32_t timeout = 0; /* timeout in ms */
+    uint32_t now;
     uintptr_t key;
 
     //Enter Critial Section
     key = OsalPort_enterCS();
 
-    pTimerEntry = getTimerEntry(taskId, eventId);
+    idx = getTimerEntry(taskId, eventId);
 
-    if(pTimerEntry != NULL)
+    if(idx != TIMER_IDX_NONE)
     {
-        timeoutTicks = ClockP_getTimeout(pTimerEntry->clockHandle);
-        timeout = timeoutTicks / (1000 / ClockP_getSystemTickPeriod());
+        now = ClockP_getSystemTicks();
+        timeoutTicks = timerPool[idx].remaining;
+        if(TIMER_BEFORE(now, timerPool[idx].expiry))
+        {
+            timeoutTicks += timerPool[idx].expiry - now;
+        }
+        timeoutTicks /= (1000 / ClockP_getSystemTickPeriod());
+        timeout = (timeoutTicks > 0xFFFFFFFFUL) ? 0xFFFFFFFFUL :
+                                                  (uint32_t)timeoutTicks;
     }
 
     //Leave Critical Section
@@ -229,29 +287,14 @@ uint32_t OsalPortTimers_getTimerTimeout(uint8_t taskId, uint32_t eventId)
  *
  * @brief Clean up inactive Osal Port Timers outside of SWI context
  *
+ *    Timer entries come from a preallocated pool and are released as
+ *    soon as they expire or are stopped, so there is nothing left to
+ *    clean up. Kept for the stack task cleanup event.
  *
  * @return  Timer entry
  */
 void OsalPortTimers_cleanUpTimers(void)
 {
-  uintptr_t key = OsalPort_enterCS();
-
-  if (pDeleteTimerEntries != NULL) {
-    TimerEntry_t *current = pDeleteTimerEntries;
-    TimerEntry_t *next;
-
-    // free the entire pDeleteTimerEntries list
-    while (current != NULL)
-    {
-        next = current->pNext;
-        ClockP_delete(current->clockHandle);
-        OsalPort_free(current);
-        current = next;
-    }
-    pDeleteTimerEntries = NULL;
-  }
-
-  OsalPort_leaveCS(key);
 }
 
 /*********************************************************************
@@ -276,61 +319,68 @@ void OsalPortTimers_registerCleanupEvent(uint8_t taskID, uint32_t eventID)
  *
  * @brief
  *
- *    This function is the timer callback function send to send events
- *    when the timeout happens.
+ *    This function is the clock callback function, it sends the events
+ *    of all the timers that have expired and re-arms the clock for the
+ *    next one.
  *
  *
- * @param   void*    arg - pointer to the Timer Entry that has expired
+ * @param   void*    arg - not used
  *
  * @return  none
  */
 static void timerCb(uintptr_t arg)
 {
-    TimerEntry_t* pTimerEntry = (TimerEntry_t*) arg;
+    uint8_t idx;
+    uint32_t now;
+    uintptr_t key;
+
+    (void)arg;
+
+    key = OsalPort_enterCS();
 
-    /* Set event */
-    OsalPort_setEvent( pTimerEntry->taskId, pTimerEntry->eventId );
+    now = ClockP_getSystemTicks();
 
-    /* if it is not a reload timer then free the entry */
-    if(!pTimerEntry->reload)
+    while( (timerHeapCnt > 0) &&
+           !TIMER_BEFORE(now, timerPool[timerHeap[0]].expiry) )
     {
-        ClockP_stop(pTimerEntry->clockHandle);
+        idx = timerHeap[0];
 
-        // find the element in the timer list and
-        // extract it by updating prev and next ptrs
-        if(pTimerEntry == pTimerEntries)
+        if(timerPool[idx].remaining != 0)
         {
-            pTimerEntries = pTimerEntry->pNext;
+            /* long timer, only a segment has elapsed */
+            timerSetExpiry(idx, timerPool[idx].expiry, timerPool[idx].remaining);
+            timerHeapDown(0);
+            continue;
         }
-        else
+
+        /* Set event */
+        OsalPort_setEvent( timerPool[idx].taskId, timerPool[idx].eventId );
+
+        if(timerPool[idx].period != 0)
         {
-            TimerEntry_t* pPrevTimerEntry = pTimerEntries;
-            while(pPrevTimerEntry->pNext != pTimerEntry)
+            /* reload timer, schedule the next period. The first segment
+             * is never longer than TIMER_MAX_SEGMENT, so restarting it
+             * from now always moves it past now and ends this loop.
+             */
+            timerSetExpiry(idx, timerPool[idx].expiry,
+                           timerTicks(timerPool[idx].period));
+            if(!TIMER_BEFORE(now, timerPool[idx].expiry))
             {
-                pPrevTimerEntry = pPrevTimerEntry->pNext;
+                timerSetExpiry(idx, now, timerTicks(timerPool[idx].period));
             }
-            pPrevTimerEntry->pNext = pTimerEntry->pNext;
-        }
-
-        // add the element in the removal list, to be freed
-        // outside of SWI context
-        TimerEntry_t *pDeleteTimerEntry = pDeleteTimerEntries;
-        pTimerEntry->pNext = NULL; // remove node from linked list above
-        if(pDeleteTimerEntry == NULL)
-        {
-            pDeleteTimerEntries = pTimerEntry;
+            timerHeapDown(0);
         }
         else
         {
-            while(pDeleteTimerEntry->pNext != NULL)
-            {
-                pDeleteTimerEntry = pDeleteTimerEntry->pNext;
-            }
-            pDeleteTimerEntry->pNext = pTimerEntry;
+            /* one shot timer, return the entry to the pool */
+            timerHeapRemove(idx);
+            timerRelease(idx);
         }
-        
-        OsalPort_setEvent( stackTaskID, stackEventID );
     }
+
+    timerArm();
+
+    OsalPort_leaveCS(key);
 }
 
 /*********************************************************************
@@ -338,7 +388,9 @@ static void timerCb(uintptr_t arg)
  *
  * @brief
  *
- *    This function is used to create a TIRTOS timer an timer entry.
+ *    This function is used to start a timer, reusing the timer entry
+ *    of (taskId, eventId) if it is already running. The entry pool is
+ *    grown when all entries are in use.
  *
  * @param   uint8_t    taskId - task ID to post event to when timer expires
  * @param   uint32_t   eventId - event to post
@@ -349,81 +401,68 @@ static void timerCb(uintptr_t arg)
  */
 static uint8_t createTimerEntry(uint8_t taskId, uint32_t eventId, uint32_t timeout, bool reload)
 {
-    ClockP_Params clkParams;
-    TimerEntry_t* pNewTimerEntry;
-    uint8_t status = OsalPort_NO_TIMER_AVAIL;
-    uint32_t timeoutTicks = (timeout * (1000 / ClockP_getSystemTickPeriod()));
+    uint8_t idx;
+    uint8_t bucket;
+    uint8_t status;
+    uint64_t timeoutTicks = timerTicks(timeout);
+    uint32_t now;
     uintptr_t key;
+    bool poolFull;
 
-    //Enter Critial Section
-    key = OsalPort_enterCS();
-
-    //check for existing timer
-    pNewTimerEntry = getTimerEntry(taskId, eventId);
-    
-    if(pNewTimerEntry)
-    {
-        //reset the time out
-        ClockP_stop(pNewTimerEntry->clockHandle);
-        ClockP_setTimeout(pNewTimerEntry->clockHandle, timeoutTicks);
-        ClockP_start(pNewTimerEntry->clockHandle);
-    }
-    else
+    do
     {
-        pNewTimerEntry = OsalPort_malloc(sizeof(TimerEntry_t));
+        status = OsalPort_NO_TIMER_AVAIL;
+        poolFull = false;
+
+        //Enter Critial Section
+        key = OsalPort_enterCS();
 
-        if(pNewTimerEntry != NULL)
+        if(timerInit())
         {
-            ClockP_Params_init(&clkParams);
-            if(reload)
+            now = ClockP_getSystemTicks();
+
+            //check for existing timer
+            idx = getTimerEntry(taskId, eventId);
+
+            if(idx != TIMER_IDX_NONE)
             {
-                clkParams.period = timeoutTicks;
+                //reset the time out
+                timerSetExpiry(idx, now, timeoutTicks);
+                timerHeapUp(timerPool[idx].heapPos);
+                timerHeapDown(timerPool[idx].heapPos);
+                timerArm();
+
+                status = OsalPort_SUCCESS;
             }
-            else
+            else if(timerFreeList != TIMER_IDX_NONE)
             {
-                clkParams.period = 0;
-            }
+                idx = timerFreeList;
+                timerFreeList = timerPool[idx].hashNext;
 
-            clkParams.startFlag = true;
-            clkParams.arg = (uintptr_t) pNewTimerEntry;
+                timerPool[idx].taskId = taskId;
+                timerPool[idx].eventId = eventId;
+                timerPool[idx].period = reload ? timeout : 0;
+                timerSetExpiry(idx, now, timeoutTicks);
 
-            pNewTimerEntry->clockHandle = ClockP_create(timerCb, timeoutTicks, &clkParams);
+                bucket = timerHashIdx(taskId, eventId);
+                timerPool[idx].hashNext = timerHash[bucket];
+                timerHash[bucket] = idx;
 
-            if(pNewTimerEntry->clockHandle != NULL)
-            {
-                pNewTimerEntry->taskId = taskId;
-                pNewTimerEntry->eventId = eventId;
-                pNewTimerEntry->reload = reload;
-                pNewTimerEntry->pNext = NULL;
-
-                if(pTimerEntries == NULL)
-                {
-                    pTimerEntries = pNewTimerEntry;
-                }
-                else
-                {
-                    TimerEntry_t* pLastTimerEntry = pTimerEntries;
-                    while(pLastTimerEntry->pNext != NULL)
-                    {
-                        pLastTimerEntry = pLastTimerEntry->pNext;
-                    }
-                    pLastTimerEntry->pNext = pNewTimerEntry;
-                }
-
-                ClockP_setTimeout(pNewTimerEntry->clockHandle, timeoutTicks);
-                ClockP_start(pNewTimerEntry->clockHandle);
+                timerHeapInsert(idx);
+                timerArm();
 
                 status = OsalPort_SUCCESS;
             }
             else
             {
-                OsalPort_free(pNewTimerEntry);
+                poolFull = true;
             }
         }
-    }
 
-    //Leave Critical Section
-    OsalPort_leaveCS(key);
+        //Leave Critical Section
+        OsalPort_leaveCS(key);
+
+    } while(poolFull && timerGrow());
 
     return status;
 }
@@ -434,26 +473,377 @@ static uint8_t createTimerEntry(uint8_t taskId, uint32_t eventId, uint32_t timeo
  *
  * @brief
  *
- *    This function is used to create a TIRTOS timer an timer entry.
+ *    This function is used to find the active timer entry of a task
+ *    event.
  *
  * @param   uint8_t    taskId - task ID to post event to when timer expires
  * @param   uint32_t   eventId - event to post
  *
- * @return  Timer entry
+ * @return  Timer entry index, TIMER_IDX_NONE if not found
  */
-static TimerEntry_t* getTimerEntry(uint8_t taskId, uint32_t eventId)
+static uint8_t getTimerEntry(uint8_t taskId, uint32_t eventId)
 {
-    TimerEntry_t* pTimerEntry;
+    uint8_t idx;
+
+    if(!timerPoolInit)
+    {
+        return TIMER_IDX_NONE;
+    }
+
+    idx = timerHash[timerHashIdx(taskId, eventId)];
+
+    /* iterate through the bucket and find one that matches taskId and eventId */
+    while( (idx != TIMER_IDX_NONE) &&
+           !((timerPool[idx].taskId == taskId) &&
+             (timerPool[idx].eventId == eventId)) )
+    {
+        idx = timerPool[idx].hashNext;
+    }
+
+    return idx;
+}
+
+/*********************************************************************
+ * @fn      timerInit
+ *
+ * @brief   Build the free list of timer entries and create the clock,
+ *          on first use. Must be called in a critical section.
+ *
+ * @return  true if timers can be started
+ */
+static bool timerInit(void)
+{
+    ClockP_Params clkParams;
+    uint8_t idx;
+
+    if(!timerPoolInit)
+    {
+        for(idx = 0; idx < OsalPortTimers_HASH_SIZE; idx++)
+        {
+            timerHash[idx] = TIMER_IDX_NONE;
+        }
 
-    pTimerEntry = pTimerEntries;
+        for(idx = 0; idx < timerPoolSize; idx++)
+        {
+            timerPool[idx].heapPos = TIMER_IDX_NONE;
+            timerPool[idx].hashNext = (idx + 1 < timerPoolSize) ?
+                                      (idx + 1) : TIMER_IDX_NONE;
+        }
+        timerFreeList = 0;
+        timerHeapCnt = 0;
+        timerPoolInit = true;
+    }
 
-    /* iterate through entries and find one that matches taskId and eventId */
-    while( (pTimerEntry != NULL) &&
-           !((pTimerEntry->taskId == taskId) &&
-             (pTimerEntry->eventId == eventId)) )
+    if(timerClockHandle == NULL)
     {
-        pTimerEntry = pTimerEntry->pNext;
+        ClockP_Params_init(&clkParams);
+        clkParams.period = 0;
+        clkParams.startFlag = false;
+        clkParams.arg = 0;
+
+        timerClockHandle = ClockP_create(timerCb, 0, &clkParams);
     }
 
-    return pTimerEntry;
+    return (timerClockHandle != NULL);
+}
+
+/*********************************************************************
+ * @fn      timerGrow
+ *
+ * @brief   Replace the timer entries by a larger heap allocated copy,
+ *          as the entries are referenced by index this moves them all.
+ *          Must not be called in a critical section. Entries are never
+ *          given back, the pool stays at the largest size needed.
+ *
+ * @return  true if a timer entry is free
+ */
+static bool timerGrow(void)
+{
+    TimerEntry_t* pNewPool;
+    uint8_t* pNewHeap;
+    TimerEntry_t* pOldPool = NULL;
+    uint8_t* pOldHeap = NULL;
+    uint8_t oldSize = timerPoolSize;
+    uint8_t newSize;
+    uint8_t idx;
+    uintptr_t key;
+    bool grown = false;
+
+    if(oldSize >= TIMER_IDX_NONE)
+    {
+        return false;
+    }
+
+    newSize = (oldSize > TIMER_IDX_NONE - OsalPortTimers_GROW_TIMERS) ?
+              TIMER_IDX_NONE : (oldSize + OsalPortTimers_GROW_TIMERS);
+
+    pNewPool = OsalPort_malloc(newSize * sizeof(TimerEntry_t));
+    pNewHeap = OsalPort_malloc(newSize);
+
+    if((pNewPool != NULL) && (pNewHeap != NULL))
+    {
+        key = OsalPort_enterCS();
+
+        if(timerPoolSize == oldSize)
+        {
+            memcpy(pNewPool, timerPool, oldSize * sizeof(TimerEntry_t));
+            memcpy(pNewHeap, timerHeap, oldSize);
+
+            for(idx = oldSize; idx < newSize; idx++)
+            {
+                pNewPool[idx].heapPos = TIMER_IDX_NONE;
+                pNewPool[idx].hashNext = (idx + 1 < newSize) ?
+                                         (idx + 1) : timerFreeList;
+            }
+            timerFreeList = oldSize;
+
+            if(timerPool != timerPoolStatic)
+            {
+                pOldPool = timerPool;
+                pOldHeap = timerHeap;
+            }
+            timerPool = pNewPool;
+            timerHeap = pNewHeap;
+            timerPoolSize = newSize;
+        }
+        else
+        {
+            /* another task has grown the pool meanwhile */
+            pOldPool = pNewPool;
+            pOldHeap = pNewHeap;
+        }
+        grown = true;
+
+        OsalPort_leaveCS(key);
+    }
+    else
+    {
+        pOldPool = pNewPool;
+        pOldHeap = pNewHeap;
+    }
+
+    if(pOldPool != NULL)
+    {
+        OsalPort_free(pOldPool);
+    }
+    if(pOldHeap != NULL)
+    {
+        OsalPort_free(pOldHeap);
+    }
+
+    return grown;
+}
+
+/*********************************************************************
+ * @fn      timerTicks
+ *
+ * @brief   Convert a timeout in ms to system ticks
+ *
+ * @param   uint32_t   timeout - timeout in ms
+ *
+ * @return  number of ticks
+ */
+static uint64_t timerTicks(uint32_t timeout)
+{
+    return ((uint64_t)timeout * (1000 / ClockP_getSystemTickPeriod()));
+}
+
+/*********************************************************************
+ * @fn      timerSetExpiry
+ *
+ * @brief   Set the expiry of a timer entry to its first segment, the
+ *          rest of the timeout is kept in remaining. Does not reorder
+ *          the heap.
+ *
+ * @param   uint8_t    idx - timer entry
+ * @param   uint32_t   start - system tick the timeout starts at
+ * @param   uint64_t   ticks - timeout in ticks
+ *
+ * @return  none
+ */
+static void timerSetExpiry(uint8_t idx, uint32_t start, uint64_t ticks)
+{
+    uint32_t segment = (ticks > TIMER_MAX_SEGMENT) ? TIMER_MAX_SEGMENT :
+                                                     (uint32_t)ticks;
+
+    timerPool[idx].expiry = start + segment;
+    timerPool[idx].remaining = ticks - segment;
+}
+
+/*********************************************************************
+ * @fn      timerHashIdx
+ *
+ * @brief   Hash bucket of a (taskId, eventId) pair
+ *
+ * @param   uint8_t    taskId - task ID
+ * @param   uint32_t   eventId - event
+ *
+ * @return  bucket index
+ */
+static uint8_t timerHashIdx(uint8_t taskId, uint32_t eventId)
+{
+    /* events are usually single bits, fold them before mixing in the task */
+    eventId ^= (eventId >> 16);
+    eventId ^= (eventId >> 8);
+    eventId ^= (eventId >> 4);
+
+    return (uint8_t)((eventId ^ (taskId * 7u)) & (OsalPortTimers_HASH_SIZE - 1));
+}
+
+/*********************************************************************
+ * @fn      timerHeapSwap
+ *
+ * @brief   Swap two heap positions and update the entries back index
+ */
+static void timerHeapSwap(uint8_t posA, uint8_t posB)
+{
+    uint8_t idx = timerHeap[posA];
+
+    timerHeap[posA] = timerHeap[posB];
+    timerHeap[posB] = idx;
+    timerPool[timerHeap[posA]].heapPos = posA;
+    timerPool[timerHeap[posB]].heapPos = posB;
+}
+
+/*********************************************************************
+ * @fn      timerHeapUp
+ *
+ * @brief   Move a heap entry towards the root while it expires earlier
+ *          than its parent
+ */
+static void timerHeapUp(uint8_t pos)
+{
+    uint8_t parent;
+
+    while(pos > 0)
+    {
+        parent = (pos - 1) / 2;
+        if(!TIMER_BEFORE(timerPool[timerHeap[pos]].expiry,
+                         timerPool[timerHeap[parent]].expiry))
+        {
+            break;
+        }
+        timerHeapSwap(pos, parent);
+        pos = parent;
+    }
+}
+
+/*********************************************************************
+ * @fn      timerHeapDown
+ *
+ * @brief   Move a heap entry towards the leaves while one of its
+ *          children expires earlier
+ */
+static void timerHeapDown(uint8_t pos)
+{
+    uint8_t child;
+    uint8_t smallest;
+
+    for(;;)
+    {
+        smallest = pos;
+        child = (uint8_t)(2 * pos + 1);
+        if( (child < timerHeapCnt) &&
+            TIMER_BEFORE(timerPool[timerHeap[child]].expiry,
+                         timerPool[timerHeap[smallest]].expiry) )
+        {
+            smallest = child;
+        }
+        child++;
+        if( (child < timerHeapCnt) &&
+            TIMER_BEFORE(timerPool[timerHeap[child]].expiry,
+                         timerPool[timerHeap[smallest]].expiry) )
+        {
+            smallest = child;
+        }
+        if(smallest == pos)
+        {
+            break;
+        }
+        timerHeapSwap(pos, smallest);
+        pos = smallest;
+    }
+}
+
+/*********************************************************************
+ * @fn      timerHeapInsert
+ *
+ * @brief   Add a timer entry to the expiry heap
+ */
+static void timerHeapInsert(uint8_t idx)
+{
+    timerHeap[timerHeapCnt] = idx;
+    timerPool[idx].heapPos = timerHeapCnt;
+    timerHeapCnt++;
+    timerHeapUp(timerPool[idx].heapPos);
+}
+
+/*********************************************************************
+ * @fn      timerHeapRemove
+ *
+ * @brief   Remove a timer entry from the expiry heap
+ */
+static void timerHeapRemove(uint8_t idx)
+{
+    uint8_t pos = timerPool[idx].heapPos;
+
+    timerHeapCnt--;
+    if(pos != timerHeapCnt)
+    {
+        timerHeapSwap(pos, timerHeapCnt);
+        timerHeapUp(pos);
+        timerHeapDown(pos);
+    }
+    timerPool[idx].heapPos = TIMER_IDX_NONE;
+}
+
+/*********************************************************************
+ * @fn      timerRelease
+ *
+ * @brief   Unlink a timer entry from its hash bucket and return it to
+ *          the free list
+ */
+static void timerRelease(uint8_t idx)
+{
+    uint8_t *pLink = &timerHash[timerHashIdx(timerPool[idx].taskId,
+                                             timerPool[idx].eventId)];
+
+    while(*pLink != idx)
+    {
+        pLink = &timerPool[*pLink].hashNext;
+    }
+    *pLink = timerPool[idx].hashNext;
+
+    timerPool[idx].hashNext = timerFreeList;
+    timerFreeList = idx;
+}
+
+/*********************************************************************
+ * @fn      timerArm
+ *
+ * @brief   (Re)start the clock for the earliest timer expiry, or stop
+ *          it when no timer is active
+ */
+static void timerArm(void)
+{
+    uint32_t now;
+    uint32_t ticks = 1;
+
+    if(timerClockHandle == NULL)
+    {
+        return;
+    }
+
+    ClockP_stop(timerClockHandle);
+
+    if(timerHeapCnt > 0)
+    {
+        now = ClockP_getSystemTicks();
+        if(TIMER_BEFORE(now, timerPool[timerHeap[0]].expiry))
+        {
+            ticks = timerPool[timerHeap[0]].expiry - now;
+        }
+        ClockP_setTimeout(timerClockHandle, ticks);
+        ClockP_start(timerClockHandle);
+    }
 }
@@ -3704,6 +3704,23 @@ typedef struct _zstack_pauseResumeDeviceReq_t
     bool pause;
 } zstack_pauseResumeDeviceReq_t;
 
+/**
+ * Structure to send a batch of requests, processed back to back by the
+ * ZStack Thread.
+ */
+typedef struct _zstack_batchreq_t
+{
+    //! Number of requests in pItems
+    uint8_t numItems;
+    //! Requests (zstackmsg_batchItem_t), processed in order
+    struct _zstackmsg_batchitem_t *pItems;
+    /*
+     * Set by the ZStack Thread: number of requests processed successfully,
+     * which is also the index of the failing request if the batch stopped
+     */
+    uint8_t numDone;
+} zstack_batchReq_t;
+
 
 #ifdef __cplusplus
 }
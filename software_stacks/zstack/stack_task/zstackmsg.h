@@ -247,6 +247,7 @@ typedef enum
     zstackmsg_CmdIDs_GP_SEND_DEV_ANNOUNCE = 0xEA,
     zstackmsg_CmdIDs_SYS_NWK_FRAME_FWD_NOTIFICATION_IND = 0xCC,
     zstackmsg_CmdIDs_PAUSE_DEVICE_REQ = 0xEB,
+    zstackmsg_CmdIDs_BATCH_REQ = 0xEC,
     zstackmsg_CmdIDs_RESERVED_1A = 0x1A,
     zstackmsg_CmdIDs_RESERVED_23 = 0x23,
     zstackmsg_CmdIDs_RESERVED_24 = 0x24,
@@ -960,6 +961,12 @@ typedef struct _zstackmsg_afincomingmsgind_t
     /** Message command fields */
     zstack_afIncomingMsgInd_t req;
 
+    /** AF packet holding req.pPayload when delivered without a payload
+     * copy (ZSTACK_AF_INCOMING_ZERO_COPY), NULL if req.pPayload was
+     * allocated on its own. Released by Zstackapi_freeIndMsg().
+     */
+    void *pAfPkt;
+
 } zstackmsg_afIncomingMsgInd_t;
 
 /**
@@ -3261,6 +3268,48 @@ typedef struct _zstackmsg_pauseResumeDeviceReq_t
 
 } zstackmsg_pauseResumeDeviceReq_t;
 
+/**
+ * One request of a batch. Has the layout of the request messages sent by
+ * Zstackapi: the header event field is set to the request's
+ * @ref zstack_CmdIDs, and the ZStack Thread returns the request status in
+ * the header status field.
+ */
+typedef struct _zstackmsg_batchitem_t
+{
+    /** message header<br>
+     * event field must be set to @ref zstack_CmdIDs
+     */
+    zstackmsg_HDR_t hdr;
+
+    /** Request structure */
+    void *pReq;
+
+    /** Response structure, NULL for requests without a response */
+    void *pRsp;
+
+} zstackmsg_batchItem_t;
+
+/**
+ * Send this message to the ZStack Thread to process several requests with
+ * a single message exchange. Batches can't be nested, and requests that
+ * don't answer with the request message (e.g. system reset) must not be
+ * batched.
+ * The batch stops at the first request that fails; the header status
+ * field returns its status and zstack_batchReq_t.numDone its index.
+ * The command ID for this message is zstackmsg_CmdIDs_BATCH_REQ.
+ */
+typedef struct _zstackmsg_batchreq_t
+{
+    /** message header<br>
+     * event field must be set to @ref zstack_CmdIDs
+     */
+    zstackmsg_HDR_t hdr;
+
+    /** Message command fields */
+    zstack_batchReq_t *pReq;
+
+} zstackmsg_batchReq_t;
+
 //*****************************************************************************
 //*****************************************************************************
 
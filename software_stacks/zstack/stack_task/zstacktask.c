@@ -117,6 +117,10 @@
 
 #include "ti_zstack_config.h"
 
+#ifdef NVOCMP_INCCOMPACT
+#include "nvocmp.h"
+#endif
+
 /* ------------------------------------------------------------------------------------------------
  * Constants
  * ------------------------------------------------------------------------------------------------
@@ -124,6 +128,24 @@
 
 #define ZS_START_EVENT     0x0001
 
+#ifdef NVOCMP_INCCOMPACT
+// Period in ms of the background NV compaction steps
+#ifndef ZS_NV_COMPACT_STEP_PERIOD
+#define ZS_NV_COMPACT_STEP_PERIOD           1000
+#endif
+// Free NV bytes below which a background compaction step is run
+#ifndef ZS_NV_COMPACT_MIN_FREE
+#define ZS_NV_COMPACT_MIN_FREE              1024
+#endif
+#endif // NVOCMP_INCCOMPACT
+
+#ifdef OSAL_NV_CACHE
+// Period in ms at which deferred NV writes are aged and committed
+#ifndef ZS_NV_CACHE_TICK_PERIOD
+#define ZS_NV_CACHE_TICK_PERIOD             1000
+#endif
+#endif // OSAL_NV_CACHE
+
 #define ZS_ZDO_SRC_RTG_IND_CBID             0x0001
 #define ZS_ZDO_CONCENTRATOR_IND_CBID        0x0002
 #define ZS_ZDO_NWK_DISCOVERY_CNF_CBID       0x0004
@@ -256,7 +278,7 @@ static void sendMsgToAllCBMsgs( uint32_t cbMask, uint16_t srcAddr, void *pBuf, p
 static void zsProcessZDOMsgs( zdoIncomingMsg_t *inMsg );
 
 static void processAfDataConfirm( afDataConfirm_t *pkt );
-static void processAfIncomingMsgInd( afIncomingMSGPacket_t *pkt );
+static bool processAfIncomingMsgInd( afIncomingMSGPacket_t *pkt );
 static void processAfReflectErrorInd( afReflectError_t *pkt );
 
 static uint8_t epTableAddNewEntry( epItem_t *newEntry );
@@ -643,6 +665,7 @@ static bool processGpAllowChannelChangeReq(uint8_t srcServiceTaskId, void *pMsg)
 static bool isDevicePartOfNetwork( void );
 static bool processGetZCLFrameCounterReq( uint8_t srcServiceTaskId, void *pMsg );
 static bool processPauseResumeDeviceReq(uint8_t srcServiceTaskId, void *pMsg);
+static bool processBatchReq( uint8_t srcServiceTaskId, void *pMsg );
 
 #endif // ZNP_NPI
 
@@ -719,6 +742,16 @@ void ZStackTaskInit( uint8_t taskId )
 #endif
 
 #endif // ZNP_NPI
+
+#ifdef NVOCMP_INCCOMPACT
+  // Compact NV in small steps from this task instead of stalling a write
+  OsalPortTimers_startReloadTimer( ZStackServiceTaskId, ZSTACK_NV_COMPACT_STEP_EVT, ZS_NV_COMPACT_STEP_PERIOD );
+#endif
+
+#ifdef OSAL_NV_CACHE
+  // Commit deferred NV writes once they reach their maximum latency
+  OsalPortTimers_startReloadTimer( ZStackServiceTaskId, ZSTACK_NV_CACHE_TICK_EVT, ZS_NV_CACHE_TICK_PERIOD );
+#endif
 }
 
 /**************************************************************************************************
@@ -752,6 +785,7 @@ uint32_t ZStackTaskProcessEvent( uint8_t taskId, uint32_t events )
     if ( ( pMsg = (zstackmsg_sysResetReq_t *)OsalPort_msgReceive( ZStackServiceTaskId ) ) != NULL )
     {
       bool send = FALSE;
+      bool keep = FALSE;
 
       switch ( pMsg->hdr.event )
       {
@@ -786,7 +820,7 @@ uint32_t ZStackTaskProcessEvent( uint8_t taskId, uint32_t events )
           break;
 
         case AF_INCOMING_MSG_CMD:
-          processAfIncomingMsgInd( (afIncomingMSGPacket_t *)pMsg );
+          keep = processAfIncomingMsgInd( (afIncomingMSGPacket_t *)pMsg );
           break;
 
         case ZDO_STATE_CHANGE:
@@ -839,9 +873,9 @@ uint32_t ZStackTaskProcessEvent( uint8_t taskId, uint32_t events )
            request has been processed */
         OsalPort_msgSend( pMsg->hdr.srcServiceTask, (uint8_t*) pMsg );
       }
-      else
+      else if ( !keep )
       {
-        // Release the memory
+        // Release the memory, unless ownership was handed to a subscriber
         OsalPort_msgDeallocate( (uint8_t *)pMsg );
       }
     }
@@ -856,6 +890,22 @@ uint32_t ZStackTaskProcessEvent( uint8_t taskId, uint32_t events )
     return (events ^ OSALPORT_CLEAN_UP_TIMERS_EVT);
   }
 
+#ifdef NVOCMP_INCCOMPACT
+  if(events & ZSTACK_NV_COMPACT_STEP_EVT)
+  {
+    (void)NVOCMP_compactStep( ZS_NV_COMPACT_MIN_FREE );
+    return (events ^ ZSTACK_NV_COMPACT_STEP_EVT);
+  }
+#endif
+
+#ifdef OSAL_NV_CACHE
+  if(events & ZSTACK_NV_CACHE_TICK_EVT)
+  {
+    osal_nv_cache_process( ZS_NV_CACHE_TICK_PERIOD );
+    return (events ^ ZSTACK_NV_CACHE_TICK_EVT);
+  }
+#endif
+
   // When reaching here, the events are unknown
   // Discard them or make more handlers
   return 0;
@@ -1603,6 +1653,11 @@ static bool appMsg( uint8_t* pMsg )
     case zstackmsg_CmdIDs_PAUSE_DEVICE_REQ:
       resend = processPauseResumeDeviceReq( srcServiceTaskId, pMsg );
     break;
+
+    case zstackmsg_CmdIDs_BATCH_REQ:
+      resend = processBatchReq( srcServiceTaskId, pMsg );
+      break;
+
     default:
       pReq->hdr.status = zstack_ZStatusValues_ZUnsupportedMode;
       break;
@@ -1714,20 +1769,34 @@ static void processAfReflectErrorInd( afReflectError_t *pkt )
  *          any incoming data - probably from other devices.  So, based
  *          on cluster ID, perform the intended action.
  *
+ *          With ZSTACK_AF_INCOMING_ZERO_COPY defined, the indication's
+ *          pPayload points into the AF packet itself, and ownership of the
+ *          packet is handed to the subscriber along with the indication
+ *          (released by Zstackapi_freeIndMsg()), instead of allocating and
+ *          copying the payload.
+ *
  * @param   pkt - pointer to incoming packet
  *
- * @return  none
+ * @return  TRUE if the subscriber now owns pkt, FALSE if the caller must
+ *          release it
  */
-static void processAfIncomingMsgInd( afIncomingMSGPacket_t *pkt )
+static bool processAfIncomingMsgInd( afIncomingMSGPacket_t *pkt )
 {
   zstackmsg_afIncomingMsgInd_t *pReq;
   epItem_t *pItem;
 
+  pItem = epTableFindEntryEP( pkt->endPoint );
+  if ( pItem == NULL )
+  {
+    // No subscriber for this endpoint
+    return ( FALSE );
+  }
+
   pReq = (zstackmsg_afIncomingMsgInd_t *)OsalPort_msgAllocate( sizeof(zstackmsg_afIncomingMsgInd_t) );
   if ( pReq == NULL )
   {
     // Ignore the message
-    return;
+    return ( FALSE );
   }
 
   memset( pReq, 0, sizeof(zstackmsg_afIncomingMsgInd_t) );
@@ -1764,28 +1833,30 @@ static void processAfIncomingMsgInd( afIncomingMSGPacket_t *pkt )
   pReq->req.macSrcAddr = pkt->macSrcAddr;
   pReq->req.radius = pkt->radius;
   pReq->req.n_payload = pkt->cmd.DataLength;
-  pReq->req.pPayload = OsalPort_malloc( pkt->cmd.DataLength );
-  if ( pReq->req.pPayload != NULL)
-  {
-    OsalPort_memcpy( pReq->req.pPayload, pkt->cmd.Data, pkt->cmd.DataLength );
 
-    pItem = epTableFindEntryEP( pkt->endPoint );
-    if ( pItem )
-    {
-      // Send to a subscriber
-      OsalPort_msgSend( pItem->connection,
-            (uint8_t*)pReq );
-    }
-    else
-    {
-      OsalPort_free(pReq->req.pPayload);
-      OsalPort_msgDeallocate((uint8_t*)pReq);
-    }
-  }
-  else
+#if defined ( ZSTACK_AF_INCOMING_ZERO_COPY )
+  // The payload is stored in the AF packet allocation, hand it over as is
+  pReq->req.pPayload = pkt->cmd.Data;
+  pReq->pAfPkt = pkt;
+#else
+  pReq->req.pPayload = OsalPort_malloc( pkt->cmd.DataLength );
+  if ( pReq->req.pPayload == NULL )
   {
-    // TODO: handle malloc error
+    OsalPort_msgDeallocate( (uint8_t*)pReq );
+    return ( FALSE );
   }
+
+  OsalPort_memcpy( pReq->req.pPayload, pkt->cmd.Data, pkt->cmd.DataLength );
+#endif
+
+  // Send to a subscriber
+  OsalPort_msgSend( pItem->connection, (uint8_t*)pReq );
+
+#if defined ( ZSTACK_AF_INCOMING_ZERO_COPY )
+  return ( TRUE );
+#else
+  return ( FALSE );
+#endif
 }
 
 
@@ -4688,6 +4759,9 @@ static bool processSysResetReq( uint8_t srcServiceTaskId, void *pMsg )
                          ZCD_STARTOPT_DEFAULT_NETWORK_STATE | ZCD_STARTOPT_DEFAULT_CONFIG_STATE);
 
     }
+#ifdef OSAL_NV_CACHE
+    (void)osal_nv_cache_flush();
+#endif
     SysCtrlSystemReset();
     pReq->hdr.status = zstack_ZStatusValues_ZSuccess;
   }
@@ -10062,6 +10136,67 @@ static bool processPauseResumeDeviceReq(uint8_t srcServiceTaskId, void *pMsg)
     return (TRUE);
 }
 
+/**************************************************************************************************
+ * @fn          processBatchReq
+ *
+ * @brief       Process a batch of requests back to back, each one as if it
+ *              had been received in its own message. The status of each
+ *              request is returned in its header. The batch stops at the
+ *              first failing request, its status is returned as the batch
+ *              status and its index in numDone.
+ *
+ * @param       srcServiceTaskId - Source Task ID
+ * @param       pMsg - pointer to message
+ *
+ * @return      TRUE to send the message back to the sender
+ */
+static bool processBatchReq( uint8_t srcServiceTaskId, void *pMsg )
+{
+  zstackmsg_batchReq_t *pReq = (zstackmsg_batchReq_t *)pMsg;
+  zstackmsg_batchItem_t *pItem = NULL;
+  uint8_t i;
+
+  if ( ( pReq->pReq == NULL ) || ( pReq->pReq->pItems == NULL ) )
+  {
+    pReq->hdr.status = zstack_ZStatusValues_ZInvalidParameter;
+    return ( TRUE );
+  }
+
+  for ( i = 0; i < pReq->pReq->numItems; i++ )
+  {
+    pItem = &pReq->pReq->pItems[i];
+
+    pItem->hdr.status = zstack_ZStatusValues_ZSuccess;
+    pItem->hdr.srcServiceTask = srcServiceTaskId;
+
+    if ( pItem->hdr.event == zstackmsg_CmdIDs_BATCH_REQ )
+    {
+      // Nested batches are not supported
+      pItem->hdr.status = zstack_ZStatusValues_ZUnsupportedMode;
+    }
+    else if ( appMsg( (uint8_t *)pItem ) == FALSE )
+    {
+      // The request doesn't answer with its message, it can't be batched
+      if ( pItem->hdr.status == zstack_ZStatusValues_ZSuccess )
+      {
+        pItem->hdr.status = zstack_ZStatusValues_ZUnsupportedMode;
+      }
+    }
+
+    if ( pItem->hdr.status != zstack_ZStatusValues_ZSuccess )
+    {
+      // Stop at the failing request, the following ones are not processed
+      break;
+    }
+  }
+
+  pReq->pReq->numDone = i;
+  pReq->hdr.status = ( i < pReq->pReq->numItems ) ? pItem->hdr.status
+                                                   : zstack_ZStatusValues_ZSuccess;
+
+  return ( TRUE );
+}
+
 #endif // ZNP_NPI
 
 uint8_t ZStackTask_getServiceTaskID(void)
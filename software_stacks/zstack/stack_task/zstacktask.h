@@ -74,6 +74,12 @@ extern uint32_t ZStackTaskProcessEvent( uint8_t taskId, uint32_t events );
 // TODO: put this in a better place?
 #define OSALPORT_CLEAN_UP_TIMERS_EVT      0x4000
 
+// Background NV compaction step (NVOCMP_INCCOMPACT)
+#define ZSTACK_NV_COMPACT_STEP_EVT        0x2000
+
+// Deferred NV write commit tick (OSAL_NV_CACHE)
+#define ZSTACK_NV_CACHE_TICK_EVT          0x1000
+
 #ifdef __cplusplus
 }
 ;
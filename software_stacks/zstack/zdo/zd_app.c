@@ -502,6 +502,15 @@ uint32_t ZDApp_event_loop( uint8_t task_id, uint32_t events )
     return (events ^ ZDO_NWK_UPDATE_NV);
   }
 
+  if ( events & ZDO_BIND_UPDATE_NV )
+  {
+    // Flush the binding records changed since the last NV update
+    BindWriteNV();
+
+    // Return unprocessed events
+    return (events ^ ZDO_BIND_UPDATE_NV);
+  }
+
   if ( events & ZDO_DEVICE_RESET )
   {
 #ifdef ZBA_FALLBACK_NWKKEY
@@ -517,6 +526,9 @@ uint32_t ZDApp_event_loop( uint8_t task_id, uint32_t events )
 
       // The device has been in the UNAUTH state, so reset
       // Note: there will be no return from this call
+#ifdef OSAL_NV_CACHE
+      (void)osal_nv_cache_flush();
+#endif
       SysCtrlSystemReset();
     }
   }